@@ -121,8 +121,8 @@ static void atConnectionEvent(int32_t shortRangeHandle,
                               uShortRangeConnectionEventType_t eventType,
                               uShortRangeConnectDataBt_t *pConnectData,
                               void *pCallbackParameter);
-static void dataCallback(int32_t handle, int32_t channel, int32_t length,
-                         char *pData, void *pParameters);
+static int32_t dataCallback(int32_t handle, int32_t channel, int32_t length,
+                            char *pData, void *pParameters);
 static void onBleDataEvent(void *pParam, size_t eventSize);
 static int32_t setBleConfig(const uAtClientHandle_t atHandle,
                             int32_t parameter, uint32_t value);
@@ -387,8 +387,8 @@ static void atConnectionEvent(int32_t shortRangeHandle,
     }
 }
 
-static void dataCallback(int32_t handle, int32_t channel, int32_t length,
-                         char *pData, void *pParameters)
+static int32_t dataCallback(int32_t handle, int32_t channel, int32_t length,
+                            char *pData, void *pParameters)
 {
     (void)handle;
     uShortRangePrivateInstance_t *pInstance = (uShortRangePrivateInstance_t *)pParameters;
@@ -415,6 +415,8 @@ static void dataCallback(int32_t handle, int32_t channel, int32_t length,
             }
         }
     }
+
+    return length;
 }
 
 static void onBleDataEvent(void *pParam, size_t eventSize)
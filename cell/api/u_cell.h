@@ -133,7 +133,10 @@ typedef enum {
     U_CELL_ERROR_VALUE_OUT_OF_RANGE = U_ERROR_CELL_MAX - 9,  /**< -265 if U_ERROR_BASE is 0. */
     U_CELL_ERROR_TEMPORARY_FAILURE = U_ERROR_CELL_MAX - 10,  /**< -266 if U_ERROR_BASE is 0. */
     U_CELL_ERROR_CELL_LOCATE = U_ERROR_CELL_MAX - 11,  /**< -267 if U_ERROR_BASE is 0. */
-    U_CELL_ERROR_NOT_ALLOWED = U_ERROR_CELL_MAX - 12  /**< -268 if U_ERROR_BASE is 0. */
+    U_CELL_ERROR_NOT_ALLOWED = U_ERROR_CELL_MAX - 12,  /**< -268 if U_ERROR_BASE is 0. */
+    U_CELL_ERROR_MUX_STATE_UNKNOWN = U_ERROR_CELL_MAX - 13  /**< -269 if U_ERROR_BASE is 0:
+                                                                 the module may have been
+                                                                 left in multiplexer mode. */
 } uCellErrorCode_t;
 
 /* ----------------------------------------------------------------
@@ -101,6 +101,12 @@ typedef enum {
     U_CELL_MQTT_QOS_MAX_NUM
 } uCellMqttQos_t;
 
+/** Forward declaration of an MQTT message, as handed to the
+ * callback of uCellMqttSetMessageReceiveCallback(); the
+ * definition is in u_mqtt_common.h.
+ */
+struct uMqttMessage_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -535,6 +541,36 @@ int32_t uCellMqttSetMessageCallback(int32_t cellHandle,
                                     void (*pCallback) (int32_t, void *),
                                     void *pCallbackParam);
 
+/** Set a callback to be called with each MQTT message as it is
+ * received, instead of the message being left in the module for
+ * uCellMqttMessageRead(); see uMqttClientSetMessageReceiveCallback()
+ * for the details.  The message is read from the module, in the AT
+ * client's callback task, as soon as the module indicates that it
+ * has arrived: the message itself is not buffered, pMessage in the
+ * message handed to the callback is NULL and the callback reads the
+ * message straight from the AT interface, in chunks of whatever
+ * size suits, by calling uMqttClientMessageReceiveRead().  Any
+ * messages already waiting in the module when the callback is set
+ * are handed to it first, in the same way.  Not supported by
+ * modules using the old-style SARA-R4 MQTT AT interface.
+ *
+ * @param cellHandle      the handle of the cellular instance to
+ *                        be used.
+ * @param pCallback       the callback. The first parameter to
+ *                        the callback is the received message,
+ *                        the second parameter is pCallbackParam.
+ *                        Use NULL to deregister a previous
+ *                        callback.
+ * @param pCallbackParam  this value will be passed to pCallback
+ *                        as the second parameter.
+ * @return                zero on success else negative error
+ *                        code.
+ */
+int32_t uCellMqttSetMessageReceiveCallback(int32_t cellHandle,
+                                           void (*pCallback) (struct uMqttMessage_t *,
+                                                              void *),
+                                           void *pCallbackParam);
+
 /** Get the current number of unread messages.
  *
  * @param cellHandle the handle of the cellular instance to be used.
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_MUX_H_
+#define _U_CELL_MUX_H_
+
+/* No #includes allowed here */
+
+/** @file
+ * @brief This header file defines the APIs that switch a cellular
+ * module into 3GPP 27.010 multiplexer (CMUX) mode, so that the one
+ * UART to the module carries several virtual channels, each with
+ * its own AT client and its own flow control.  For instance, URCs
+ * and socket reads can be handled on one channel while a long-running
+ * command is in progress on another.  These functions are thread-safe.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The multiplexer channel that the AT client of the cellular
+ * instance is moved to by uCellMuxEnable().
+ */
+#define U_CELL_MUX_CHANNEL_AT_CONTROL 1
+
+/** A suggested multiplexer channel for an AT client that deals
+ * with URCs.
+ */
+#define U_CELL_MUX_CHANNEL_AT_URC 2
+
+/** The multiplexer channel for an AT client that moves bulk data:
+ * once this channel has been opened with uCellMuxAddChannel() the
+ * cellular socket and MQTT APIs send and receive their data on it,
+ * leaving the AT client of the instance free for everything else.
+ */
+#define U_CELL_MUX_CHANNEL_DATA 3
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Switch the cellular module into multiplexer mode: the module
+ * is sent AT+CMUX, a multiplexer is opened on the UART that the
+ * AT client of the cellular instance was using and that AT client
+ * is moved onto channel U_CELL_MUX_CHANNEL_AT_CONTROL; it keeps
+ * its URC handlers and settings and carries on working as before.
+ * The AT client must be on a UART, not already on a multiplexer.
+ * If anything goes wrong the AT client is left on the UART; if
+ * that happens after the module has accepted AT+CMUX the module
+ * is asked to leave multiplexer mode and, should it not confirm
+ * that it has, U_CELL_ERROR_MUX_STATE_UNKNOWN is returned: the
+ * module may then be deaf to AT commands on the UART, a hard
+ * reset, e.g. with uCellPwrResetHard(), will recover it.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success, U_CELL_ERROR_MUX_STATE_UNKNOWN
+ *                    if the module may have been left in multiplexer
+ *                    mode, else negative error code.
+ */
+int32_t uCellMuxEnable(int32_t cellHandle);
+
+/** Determine whether multiplexer mode is enabled.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            true if uCellMuxEnable() has been called
+ *                    successfully and uCellMuxDisable() has not.
+ */
+bool uCellMuxIsEnabled(int32_t cellHandle);
+
+/** Open another multiplexer channel with its own AT client; the
+ * new AT client has the same timeout, delimiter, delay and debug
+ * settings as that of the cellular instance but no URC handlers.
+ * The AT client belongs to the multiplexer: it must not be removed
+ * with uAtClientRemove(), use uCellMuxRemoveChannel() instead.
+ * If the channel is U_CELL_MUX_CHANNEL_DATA the cellular socket and
+ * MQTT APIs will move their data on it from then on.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param channel     the channel to open, e.g. U_CELL_MUX_CHANNEL_AT_URC
+ *                    or U_CELL_MUX_CHANNEL_DATA; must not be
+ *                    U_CELL_MUX_CHANNEL_AT_CONTROL and must be
+ *                    supported by the module.
+ * @param pAtHandle   a place to put the handle of the AT client
+ *                    on the new channel; cannot be NULL.
+ * @return            zero on success else negative error code.
+ */
+int32_t uCellMuxAddChannel(int32_t cellHandle, int32_t channel,
+                           uAtClientHandle_t *pAtHandle);
+
+/** Close a multiplexer channel that was opened with
+ * uCellMuxAddChannel(), removing its AT client.  If the channel
+ * is U_CELL_MUX_CHANNEL_DATA, socket and MQTT data goes back to
+ * the AT client of the instance; a transfer already in progress
+ * is allowed to finish first.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param channel     the channel to close.
+ * @return            zero on success else negative error code.
+ */
+int32_t uCellMuxRemoveChannel(int32_t cellHandle, int32_t channel);
+
+/** Switch the cellular module out of multiplexer mode: all of the
+ * channels opened with uCellMuxAddChannel() are closed, the module
+ * is told to leave multiplexer mode and the AT client of the cellular
+ * instance is moved back onto the UART.  This is done automatically
+ * by uCellRemove() and uCellDeinit().
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @return            zero on success else negative error code.
+ */
+int32_t uCellMuxDisable(int32_t cellHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_MUX_H_
+
+// End of file
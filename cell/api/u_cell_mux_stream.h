@@ -0,0 +1,280 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_MUX_STREAM_H_
+#define _U_CELL_MUX_STREAM_H_
+
+/* No #includes allowed here */
+
+/** @file
+ * @brief 3GPP 27.010 (CMUX) multiplexer stream API: it runs the
+ * basic option of the multiplexer protocol over a UART and offers
+ * each of the virtual channels (DLCIs) as a stream in the same way
+ * that a UART is offered by the port layer, so that an AT client
+ * can be run on each of them with U_AT_CLIENT_STREAM_TYPE_CMUX.
+ * Most users will want the cellular API in u_cell_mux.h, which
+ * switches the module into multiplexer mode and does all of this.
+ * These functions are thread-safe.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_CELL_MUX_STREAM_MAX_NUM_CHANNELS
+/** The maximum number of channels that may be open on one
+ * multiplexer, not including the control channel, DLCI 0.
+ */
+# define U_CELL_MUX_STREAM_MAX_NUM_CHANNELS 4
+#endif
+
+#ifndef U_CELL_MUX_STREAM_MAX_CHANNEL
+/** The highest DLCI that may be opened; 27.010 permits up to 63
+ * but modules generally support far fewer.
+ */
+# define U_CELL_MUX_STREAM_MAX_CHANNEL 7
+#endif
+
+#ifndef U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES
+/** The maximum length of the information field of a frame, N1
+ * in 27.010; this must match the value given to the module in
+ * AT+CMUX.  Received frames longer than this are discarded.
+ */
+# define U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES 127
+#endif
+
+#ifndef U_CELL_MUX_STREAM_CHANNEL_BUFFER_LENGTH_BYTES
+/** The size of the receive buffer of each channel.  When a
+ * channel's buffer is half full the far end is asked to stop
+ * sending on that channel and, when it has been read down to
+ * a quarter full, the far end is allowed to send again.
+ */
+# define U_CELL_MUX_STREAM_CHANNEL_BUFFER_LENGTH_BYTES 1024
+#endif
+
+#ifndef U_CELL_MUX_STREAM_RESPONSE_TIMEOUT_MS
+/** How long to wait for the far end to respond to a request to
+ * open or close a channel.
+ */
+# define U_CELL_MUX_STREAM_RESPONSE_TIMEOUT_MS 3000
+#endif
+
+#ifndef U_CELL_MUX_STREAM_FLOW_CONTROL_TIMEOUT_MS
+/** How long uCellMuxStreamWrite() will wait for the far end to
+ * lift flow control on a channel before giving up.
+ */
+# define U_CELL_MUX_STREAM_FLOW_CONTROL_TIMEOUT_MS 10000
+#endif
+
+#ifndef U_CELL_MUX_STREAM_TASK_STACK_SIZE_BYTES
+/** The stack size of the task that reads from the UART and
+ * demultiplexes the received frames.
+ */
+# define U_CELL_MUX_STREAM_TASK_STACK_SIZE_BYTES 1536
+#endif
+
+#ifndef U_CELL_MUX_STREAM_TASK_PRIORITY
+/** The priority of the task that reads from the UART and
+ * demultiplexes the received frames.
+ */
+# define U_CELL_MUX_STREAM_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 4)
+#endif
+
+#ifndef U_CELL_MUX_STREAM_CHANNEL_TASK_STACK_SIZE_BYTES
+/** The stack size of the task of each channel that calls the
+ * callback set with uCellMuxStreamCallbackSet(); where an AT
+ * client is running on the channel this is where its URC handlers
+ * will run, hence this should be the same as
+ * U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES.
+ */
+# define U_CELL_MUX_STREAM_CHANNEL_TASK_STACK_SIZE_BYTES 2304
+#endif
+
+#ifndef U_CELL_MUX_STREAM_CHANNEL_TASK_PRIORITY
+/** The priority of the task of each channel that calls the
+ * callback set with uCellMuxStreamCallbackSet().
+ */
+# define U_CELL_MUX_STREAM_CHANNEL_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A callback for data received on a channel; eventBitmask will
+ * be U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED, just as for a UART.
+ */
+typedef void (*uCellMuxStreamEventCallback_t)(int32_t streamHandle,
+                                              uint32_t eventBitmask,
+                                              void *pCallbackParameter);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Initialise multiplexer stream handling.
+ *
+ * @return  zero on success else negative error code.
+ */
+int32_t uCellMuxStreamInit();
+
+/** Shut down multiplexer stream handling; any open multiplexers
+ * are closed.
+ */
+void uCellMuxStreamDeinit();
+
+/** Open a multiplexer on a UART; the far end must already be in
+ * multiplexer mode (e.g. AT+CMUX must have been sent to the
+ * module).  The UART must be open and must not be in use by anything
+ * else: the multiplexer takes its event callback.  This sends a
+ * request to open the control channel but does not wait for the
+ * response, that is done by uCellMuxStreamChannelOpen().  Should
+ * this fail for any reason other than an invalid parameter, a DISC
+ * is sent on the control channel to try to take the far end out of
+ * multiplexer mode, though whether it did so cannot be known.
+ *
+ * @param uartHandle the handle of the UART to use.
+ * @return           the handle of the multiplexer else negative
+ *                   error code.
+ */
+int32_t uCellMuxStreamOpen(int32_t uartHandle);
+
+/** Close a multiplexer: all of its channels are closed and the
+ * far end is told to leave multiplexer mode, with CLD or, if that
+ * gets no response, with a DISC on the control channel.  The event
+ * callback of the UART is released but the UART itself is not
+ * closed.  The multiplexer is closed whatever the return value.
+ *
+ * @param muxHandle the handle of the multiplexer.
+ * @return          zero if the far end confirmed that it has left
+ *                  multiplexer mode, U_ERROR_COMMON_NOT_RESPONDING
+ *                  if it did not, else negative error code.
+ */
+int32_t uCellMuxStreamClose(int32_t muxHandle);
+
+/** Open a channel on a multiplexer, waiting for the far end to
+ * agree.  If the far end has already opened the channel this
+ * returns immediately.
+ *
+ * @param muxHandle the handle of the multiplexer.
+ * @param channel   the DLCI of the channel, 1 to
+ *                  U_CELL_MUX_STREAM_MAX_CHANNEL.
+ * @return          the stream handle of the channel, for use with
+ *                  the functions below or as the stream handle of an
+ *                  AT client of type U_AT_CLIENT_STREAM_TYPE_CMUX,
+ *                  else negative error code.
+ */
+int32_t uCellMuxStreamChannelOpen(int32_t muxHandle, int32_t channel);
+
+/** Close a channel.  Any AT client on the channel must have been
+ * removed first.
+ *
+ * @param streamHandle the stream handle of the channel.
+ */
+void uCellMuxStreamChannelClose(int32_t streamHandle);
+
+/** Write to a channel, splitting the data into frames; this blocks
+ * until all of the data has been written unless the far end has
+ * switched flow control on for the channel, in which case it waits
+ * for up to U_CELL_MUX_STREAM_FLOW_CONTROL_TIMEOUT_MS.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @param pBuffer      the data to write.
+ * @param sizeBytes    the number of bytes at pBuffer.
+ * @return             the number of bytes written else negative
+ *                     error code.
+ */
+int32_t uCellMuxStreamWrite(int32_t streamHandle, const void *pBuffer,
+                            size_t sizeBytes);
+
+/** Read from a channel, non-blocking: up to sizeBytes of data
+ * already received will be returned.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @param pBuffer      a place to put the data.
+ * @param sizeBytes    the size of the storage at pBuffer.
+ * @return             the number of bytes read else negative
+ *                     error code.
+ */
+int32_t uCellMuxStreamRead(int32_t streamHandle, void *pBuffer,
+                           size_t sizeBytes);
+
+/** Get the number of bytes waiting to be read on a channel.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @return             the number of bytes waiting else negative
+ *                     error code.
+ */
+int32_t uCellMuxStreamGetReceiveSize(int32_t streamHandle);
+
+/** Set a callback to be called when data is received on a channel;
+ * it is called in the channel's own task so it may block without
+ * affecting the other channels.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @param pFunction    the function to call.
+ * @param pParam       a parameter which will be passed to pFunction
+ *                     as its last parameter.
+ * @return             zero on success else negative error code.
+ */
+int32_t uCellMuxStreamCallbackSet(int32_t streamHandle,
+                                  uCellMuxStreamEventCallback_t pFunction,
+                                  void *pParam);
+
+/** Remove the data callback of a channel.
+ *
+ * @param streamHandle the stream handle of the channel.
+ */
+void uCellMuxStreamCallbackRemove(int32_t streamHandle);
+
+/** Send an event to the data callback of a channel, e.g. to have
+ * data which is still waiting processed.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @param eventBitmask must be U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED.
+ * @return             zero on success else negative error code.
+ */
+int32_t uCellMuxStreamEventSend(int32_t streamHandle,
+                                uint32_t eventBitmask);
+
+/** Determine if the caller is running in the task which calls
+ * the data callback of a channel.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @return             true if the caller is in the callback task.
+ */
+bool uCellMuxStreamEventIsCallback(int32_t streamHandle);
+
+/** Get the minimum free stack of the task which calls the data
+ * callback of a channel.
+ *
+ * @param streamHandle the stream handle of the channel.
+ * @return             the minimum free stack in bytes else
+ *                     negative error code.
+ */
+int32_t uCellMuxStreamEventStackMinFree(int32_t streamHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_MUX_STREAM_H_
+
+// End of file
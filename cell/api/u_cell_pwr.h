@@ -428,6 +428,26 @@ int32_t uCellPwrSetDtrPowerSavingPin(int32_t cellHandle, int32_t pin);
  */
 int32_t uCellPwrGetDtrPowerSavingPin(int32_t cellHandle);
 
+/** Get the fingerprint of the configuration that was last applied
+ * to the cellular module during power-on, wake-up from sleep,
+ * reboot or reset: a hash of the module type and the configuration
+ * commands sent.  The configuration is applied in full every time,
+ * as a single chained AT command, since the module may have been
+ * restarted and have restored some settings from a stored profile
+ * without this MCU knowing; the fingerprint allows an application
+ * to tell whether the module has been configured and whether the
+ * configuration has changed, e.g. across a power saving setting
+ * change or an update of this code.
+ *
+ * @param cellHandle    the handle of the cellular instance.
+ * @param pFingerprint  a place to put the fingerprint; will be
+ *                      set to zero if the module is not known to
+ *                      have been configured.  Cannot be NULL.
+ * @return              zero on success or negative error code.
+ */
+int32_t uCellPwrGetConfigurationFingerprint(int32_t cellHandle,
+                                            uint32_t *pFingerprint);
+
 /** Set the parameters for 3GPP power saving, only valid when in
  * Cat-M1/NB1 mode and only effective when the module is connected
  * to the cellular network.
@@ -41,12 +41,38 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES
 /** The maximum size of a datagram and the maximum size of a
- * single TCP segment sent to the cellular module (defined by the
- * cellular module AT interface).  Note the if hex mode is
-  set (using uCellSockHexModeOn()) then the number is halved.
+ * single TCP segment sent to the cellular module.  The segment
+ * size actually used is the smaller of this and the size the
+ * module reports, through its AT interface, that it is able to
+ * handle.  Note the if hex mode is set (using uCellSockHexModeOn())
+ * then the number is halved.  If this is increased, note that
+ * chip to chip security (see u_cell_sec_c2c.h) is limited to
+ * receiving 1024 bytes at a time.
+ */
+# define U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES 1024
+#endif
+
+#ifndef U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES
+/** In hex mode socket data is converted to and from hex a chunk
+ * of this many bytes at a time as it is sent to or received from
+ * the module, using a buffer of twice this size on the stack.
+ */
+# define U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES 32
+#endif
+
+#ifndef U_CELL_SOCK_READ_CACHE_SIZE_BYTES
+/** The default size of the read-ahead cache of a TCP socket,
+ * zero for no cache.  Where there is a cache, data is read from
+ * the module into it as soon as a +UUSORD URC arrives and small
+ * uCellSockRead() calls are served from it without any AT
+ * traffic.  The size may be changed per socket with the
+ * U_SOCK_OPT_RCVBUF option; it is limited to
+ * U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES.
  */
-#define U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES 1024
+# define U_CELL_SOCK_READ_CACHE_SIZE_BYTES 0
+#endif
 
 #ifndef U_CELL_SOCK_TCP_RETRY_LIMIT
 /** The number of times to retry sending TCP data:
@@ -57,6 +83,22 @@ extern "C" {
 # define U_CELL_SOCK_TCP_RETRY_LIMIT 3
 #endif
 
+#ifndef U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS
+/** The period of silence required on the UART before and after
+ * the "+++" escape sequence that takes the module out of direct
+ * link mode (see uCellSockDirectLinkStop()); the module default
+ * is one second so allow a little more.
+ */
+# define U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS 1200
+#endif
+
+#ifndef U_CELL_SOCK_DIRECT_LINK_EXIT_RETRIES
+/** The number of times to check, with "AT", that the module has
+ * returned to command mode after the escape sequence.
+ */
+# define U_CELL_SOCK_DIRECT_LINK_EXIT_RETRIES 3
+#endif
+
 /** The maximum number of sockets that can be open at one time.
  */
 #define U_CELL_SOCK_MAX_NUM_SOCKETS 7
@@ -207,7 +249,15 @@ bool uCellSockBlockingGet(int32_t cellHandle,
  * the socket receive timeout one would pass in a level
  * of U_SOCK_OPT_LEVEL_SOCK, and option value of
  * U_SOCK_OPT_RCVTIMEO and then the option value would be
- * a pointer to a structure of type timeval.
+ * a pointer to a structure of type timeval.  U_SOCK_OPT_RCVBUF,
+ * an int32_t, is handled locally: it sets the size of the
+ * read-ahead cache used by uCellSockRead() (see
+ * U_CELL_SOCK_READ_CACHE_SIZE_BYTES), zero to switch it off;
+ * it cannot be made smaller than the amount of data currently
+ * in the cache.  U_SOCK_OPT_TCP_DIRECT_LINK calls
+ * uCellSockDirectLinkStart()/uCellSockDirectLinkStop() and
+ * U_SOCK_OPT_TCP_DIRECT_LINK_TIMER/U_SOCK_OPT_TCP_DIRECT_LINK_LENGTH
+ * call uCellSockDirectLinkTriggerSet().
  *
  * @param cellHandle        the handle of the cellular instance.
  * @param sockHandle        the handle of the socket.
@@ -404,6 +454,86 @@ int32_t uCellSockRead(int32_t cellHandle,
                       int32_t sockHandle,
                       void *pData, size_t dataSizeBytes);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: DIRECT LINK (TCP)
+ * -------------------------------------------------------------- */
+
+/** Set when the module should send the data written to a socket in
+ * direct link mode: by default the module waits for a while for more
+ * data before sending what it has, which suits a transfer of a
+ * steady stream of data; for low latency make the timer short or
+ * the data length small.  This must be called before
+ * uCellSockDirectLinkStart().
+ *
+ * @param cellHandle      the handle of the cellular instance.
+ * @param sockHandle      the handle of the socket.
+ * @param timerMs         send what has been written if no more data
+ *                        arrives for this many milliseconds (the
+ *                        module will have limits, e.g. 100 to 120000),
+ *                        zero to switch the timer trigger off, negative
+ *                        to leave it as it is.
+ * @param dataLengthBytes send when this many bytes have been
+ *                        written (the module will have limits, e.g.
+ *                        3 to 2048), zero to switch the data length
+ *                        trigger off, negative to leave it as it is.
+ * @return                zero on success else negated value of
+ *                        U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockDirectLinkTriggerSet(int32_t cellHandle,
+                                      int32_t sockHandle,
+                                      int32_t timerMs,
+                                      int32_t dataLengthBytes);
+
+/** Put a connected TCP socket into direct link mode (AT+USODL):
+ * the UART to the module is given over to that socket, uCellSockWrite()
+ * and uCellSockRead() on it move data straight to and from the UART
+ * with none of the overhead of an AT command per segment and the
+ * data callback of the socket, if there is one, is called when data
+ * arrives.  This is the fastest way to move bulk data but, until
+ * uCellSockDirectLinkStop() is called, the AT interface is not
+ * available: any other call into the cellular API, or on any other
+ * socket, will fail.  Only one socket can be in direct link mode at
+ * a time and chip-to-chip security is not supported.  If the AT
+ * client of the cellular instance is on a multiplexer channel (see
+ * u_cell_mux.h) it is only that channel that is given over to the
+ * socket.  Data that the module had waiting for the socket, which
+ * it sends straight after entering direct link mode, is kept for
+ * uCellSockRead().
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            zero on success else negated value
+ *                    of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockDirectLinkStart(int32_t cellHandle,
+                                 int32_t sockHandle);
+
+/** Take a socket out of direct link mode: after a guard time of
+ * silence the "+++" escape sequence is sent to the module and, after
+ * another guard time (see U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS), the
+ * AT interface is resumed.  Any received data that has not been read
+ * is lost.  If the far end closes the connection the module leaves
+ * direct link mode by itself; this function should still be called.
+ * uCellSockClose() calls this function if required.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            zero on success else negated value
+ *                    of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockDirectLinkStop(int32_t cellHandle,
+                                int32_t sockHandle);
+
+/** Determine whether a socket is in direct link mode.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            true if the socket is in direct link
+ *                    mode, else false.
+ */
+bool uCellSockDirectLinkIsOn(int32_t cellHandle,
+                             int32_t sockHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: ASYNC
  * -------------------------------------------------------------- */
@@ -557,6 +687,20 @@ int32_t uCellSockGetBytesSent(int32_t cellHandle,
 int32_t uCellSockGetBytesReceived(int32_t cellHandle,
                                   int32_t sockHandle);
 
+/** Get the number of bytes waiting to be read on the given socket,
+ * as last reported by the module in a +UUSORD/+UUSORF URC.  This
+ * does not involve any AT traffic and so may be called often, e.g.
+ * from a select()-type loop; it may under-report if the URC has
+ * not yet arrived.
+ *
+ * @param cellHandle  the handle of the cellular instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            the number of bytes waiting to be read, else
+ *                    negated value of U_SOCK_Exxx from u_sock_errno.h.
+ */
+int32_t uCellSockGetBytesPending(int32_t cellHandle,
+                                 int32_t sockHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,8 @@
 #include "u_cell.h"         // Order is
 #include "u_cell_net.h"     // important here
 #include "u_cell_private.h" // don't change it
+#include "u_cell_mux_stream.h"
+#include "u_cell_mux_private.h"
 
 #include "u_network_handle.h"
 
@@ -167,6 +169,8 @@ void uCellDeinit()
         while (gpUCellPrivateInstanceList != NULL) {
             pInstance = gpUCellPrivateInstanceList;
             removeCellInstance(pInstance);
+            // Leave multiplexer mode, if we were in it
+            uCellMuxPrivateRemoveContext(pInstance);
             // Free the wake-up callback
             uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
             // Free any scan results
@@ -180,6 +184,9 @@ void uCellDeinit()
             free(pInstance);
         }
 
+        // Shut down any multiplexers
+        uCellMuxStreamDeinit();
+
         // Unlock the mutex so that we can delete it
         U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
         uPortMutexDelete(gUCellPrivateMutex);
@@ -239,6 +246,8 @@ int32_t uCellAdd(uCellModuleType_t moduleType,
                 pInstance->pMqttContext = NULL;
                 pInstance->pLocContext = NULL;
                 pInstance->socketsHexMode = false;
+                pInstance->socketsWriteSegmentSizeBytes = 0;
+                pInstance->socketsReadSegmentSizeBytes = 0;
                 pInstance->pFileSystemTag = NULL;
                 pInstance->inWakeUpCallback = false;
                 pInstance->pSleepContext = NULL;
@@ -382,6 +391,8 @@ void uCellRemove(int32_t cellHandle)
         pInstance = pUCellPrivateGetInstance(cellHandle);
         if (pInstance != NULL) {
             removeCellInstance(pInstance);
+            // Leave multiplexer mode, if we were in it
+            uCellMuxPrivateRemoveContext(pInstance);
             // Free the wake-up callback
             uAtClientSetWakeUpHandler(pInstance->atHandle, NULL, NULL, 0);
             // Free any scan results
@@ -170,6 +170,17 @@ typedef struct {
     void *pDisconnectCallbackParam; /**< user parameter to be
                                          passed to the disconnect
                                          callback. */
+    void (*pMessageReceiveCallback) (uMqttMessage_t *, void *); /**< callback
+                                                                     to be called
+                                                                     with each
+                                                                     message as it
+                                                                     is received. */
+    void *pMessageReceiveCallbackParam; /**< user parameter to be passed
+                                             to the message receive
+                                             callback. */
+    char *pMessageReceiveTopicStr; /**< storage for the topic of a
+                                        message being handed to the
+                                        message receive callback. */
     bool keptAlive;  /**< keep track of whether "keep alive" is on or not. */
     bool connected;  /**< keep track of whether we are connected or not. */
     size_t numUnreadMessages; /**< keep track of the number of unread messages. */
@@ -210,6 +221,78 @@ static int32_t getLastMqttErrorCode(uAtClientHandle_t atHandle)
     return errorCode;
 }
 
+// Read the next part of a message for uMqttClientMessageReceiveRead(),
+// straight from the AT interface.
+static int32_t messageReceiveRead(uMqttMessage_t *pMessage, char *pBuffer,
+                                  size_t bufferSizeBytes)
+{
+    return uAtClientReadBytes((uAtClientHandle_t) pMessage->pReadContext,
+                              pBuffer, bufferSizeBytes, true);
+}
+
+// Read all of the unread messages, handing each of them to the
+// message receive callback, which can read the message
+// body directly from the AT client.  gUCellPrivateMutex must be
+// locked before this is called.
+static void messageReceive(uAtClientHandle_t atHandle,
+                           volatile uCellMqttContext_t *pContext)
+{
+    uMqttMessage_t message;
+    int32_t qos;
+    int32_t messageBytesAvailable;
+    int32_t errorCode = 0;
+
+    while ((errorCode == 0) && (pContext->numUnreadMessages > 0) &&
+           (pContext->pMessageReceiveCallback != NULL)) {
+        memset(&message, 0, sizeof(message));
+        message.pTopicNameStr = pContext->pMessageReceiveTopicStr;
+        message.pReadFunction = messageReceiveRead;
+        message.pReadContext = (void *) atHandle;
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+UMQTTC=");
+        // Read one message
+        uAtClientWriteInt(atHandle, 6);
+        uAtClientWriteInt(atHandle, 1);
+        uAtClientCommandStop(atHandle);
+        uAtClientResponseStart(atHandle, "+UMQTTC:");
+        // Skip the UMQTTC command number
+        uAtClientSkipParameters(atHandle, 1);
+        qos = uAtClientReadInt(atHandle);
+        // Skip the length of the topic and message added
+        // together and the topic length
+        uAtClientSkipParameters(atHandle, 2);
+        uAtClientReadString(atHandle, pContext->pMessageReceiveTopicStr,
+                            U_CELL_MQTT_READ_TOPIC_MAX_LENGTH_BYTES + 1,
+                            false);
+        messageBytesAvailable = uAtClientReadInt(atHandle);
+        if (messageBytesAvailable > 0) {
+            message.messageSizeBytes = (size_t) messageBytesAvailable;
+            // The message may be binary, don't look for stop tags
+            uAtClientIgnoreStopTag(atHandle);
+            // Get the leading quote mark out of the way
+            uAtClientReadBytes(atHandle, NULL, 1, true);
+        }
+        if ((uAtClientErrorGet(atHandle) == 0) && (qos >= 0) &&
+            (qos < (int32_t) U_CELL_MQTT_QOS_MAX_NUM)) {
+            message.qos = (uMqttQos_t) qos;
+            pContext->pMessageReceiveCallback(&message,
+                                              pContext->pMessageReceiveCallbackParam);
+            if (message.readOffset < message.messageSizeBytes) {
+                // Pour away whatever the callback didn't want
+                uAtClientReadBytes(atHandle, NULL,
+                                   message.messageSizeBytes - message.readOffset,
+                                   true);
+            }
+        }
+        uAtClientRestoreStopTag(atHandle);
+        uAtClientResponseStop(atHandle);
+        errorCode = uAtClientUnlock(atHandle);
+        if (errorCode == 0) {
+            pContext->numUnreadMessages--;
+        }
+    }
+}
+
 // A local "trampoline" for the message indication callback,
 // here so that it can call pMessageIndicationCallback
 // in a separate task.
@@ -221,15 +304,18 @@ static void messageIndicationCallback(uAtClientHandle_t atHandle,
 // is 64 bit.
     volatile uCellMqttContext_t *pContext = (volatile uCellMqttContext_t *) pParam;
 
-    (void) atHandle;
-
     // This task can lock the mutex to ensure we are thread-safe
     // for the call below
     U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
 
-    if ((pContext != NULL) && (pContext->pMessageIndicationCallback != NULL)) {
-        pContext->pMessageIndicationCallback((int32_t) pContext->numUnreadMessages,
-                                             pContext->pMessageIndicationCallbackParam);
+    if (pContext != NULL) {
+        if (pContext->pMessageReceiveCallback != NULL) {
+            // Read the messages and hand them over
+            messageReceive(atHandle, pContext);
+        } else if (pContext->pMessageIndicationCallback != NULL) {
+            pContext->pMessageIndicationCallback((int32_t) pContext->numUnreadMessages,
+                                                 pContext->pMessageIndicationCallbackParam);
+        }
     }
 
     U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
@@ -357,7 +443,8 @@ static void UUMQTTC_urc(uAtClientHandle_t atHandle,
         case 6: // Num unread messages
             if (urcParam1 >= 0) {
                 pContext->numUnreadMessages = urcParam1;
-                if (pContext->pMessageIndicationCallback != NULL) {
+                if ((pContext->pMessageIndicationCallback != NULL) ||
+                    (pContext->pMessageReceiveCallback != NULL)) {
                     // Launch our local callback via the AT
                     // parser's callback facility.
                     // GCC can complain here that
@@ -1206,6 +1293,9 @@ int32_t uCellMqttInit(int32_t cellHandle, const char *pBrokerNameStr,
                     pContext->pMessageIndicationCallbackParam = NULL;
                     pContext->pDisconnectCallback = NULL;
                     pContext->pDisconnectCallbackParam = NULL;
+                    pContext->pMessageReceiveCallback = NULL;
+                    pContext->pMessageReceiveCallbackParam = NULL;
+                    pContext->pMessageReceiveTopicStr = NULL;
                     pContext->keptAlive = false;
                     pContext->connected = false;
                     pContext->numUnreadMessages = 0;
@@ -1415,6 +1505,7 @@ void uCellMqttDeinit(int32_t cellHandle)
         //lint -e(605) Suppress complaints about
         // freeing a volatile pointer as well
         free(pContext->pUrcMessage);
+        free(pContext->pMessageReceiveTopicStr);
         //lint -e(605) Suppress complaints about
         // freeing this volatile pointer as well
         free(pContext);
@@ -2457,6 +2548,58 @@ int32_t uCellMqttSetMessageCallback(int32_t cellHandle,
     return errorCode;
 }
 
+// Set a callback to be called with each received message.
+int32_t uCellMqttSetMessageReceiveCallback(int32_t cellHandle,
+                                           void (*pCallback) (struct uMqttMessage_t *,
+                                                              void *),
+                                           void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance = NULL;
+    volatile uCellMqttContext_t *pContext;
+
+    U_CELL_MQTT_ENTRY_FUNCTION(cellHandle, &pInstance, &errorCode, true);
+
+    if ((errorCode == 0) && (pInstance != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        if (!U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+            pContext = (volatile uCellMqttContext_t *) pInstance->pMqttContext;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if ((pCallback != NULL) && (pContext->pMessageReceiveTopicStr == NULL)) {
+                errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                // +1 for the terminator
+                pContext->pMessageReceiveTopicStr = (char *) malloc(U_CELL_MQTT_READ_TOPIC_MAX_LENGTH_BYTES + 1);
+                if (pContext->pMessageReceiveTopicStr != NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+            }
+            if (errorCode == 0) {
+                pContext->pMessageReceiveCallback = pCallback;
+                pContext->pMessageReceiveCallbackParam = pCallbackParam;
+                if ((pCallback != NULL) && (pContext->numUnreadMessages > 0)) {
+                    // Deal with any messages that are already waiting
+#ifndef __cplusplus
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
+#endif
+                    //lint -e(1773) Suppress complaints about
+                    // passing the pointer as non-volatile
+                    uAtClientCallback(pInstance->atHandle, messageIndicationCallback,
+                                      (void *) pContext);
+#ifndef __cplusplus
+#pragma GCC diagnostic pop
+#endif
+                }
+            }
+        }
+    }
+
+    U_CELL_MQTT_EXIT_FUNCTION();
+
+    return errorCode;
+}
+
 // Get the number of unread messages.
 int32_t uCellMqttGetUnread(int32_t cellHandle)
 {
@@ -2519,6 +2662,12 @@ int32_t uCellMqttMessageRead(int32_t cellHandle, char *pTopicNameStr,
                 pUrcMessage->messageSizeBytes = (int32_t) messageSizeBytes;
             }
             atHandle = pInstance->atHandle;
+            if (!U_CELL_PRIVATE_HAS(pInstance->pModule,
+                                    U_CELL_PRIVATE_FEATURE_MQTT_SARA_R4_OLD_SYNTAX)) {
+                // The message comes back in the response, not
+                // in a URC, so it can go on the data channel
+                atHandle = uCellPrivateGetAtHandleData(pInstance);
+            }
             uAtClientLock(atHandle);
             uAtClientCommandStart(atHandle, "AT+UMQTTC=");
             // Read a message
@@ -0,0 +1,366 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the multiplexer API for cellular: this
+ * switches the module into 3GPP 27.010 mode with AT+CMUX and runs
+ * AT clients on the channels of a u_cell_mux_stream multiplexer.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stdlib.h"    // malloc() and free()
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset()
+
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_debug.h"
+#include "u_at_client.h"
+#include "u_cell_module_type.h"
+#include "u_cell.h"         // Order is
+#include "u_cell_net.h"     // important here
+#include "u_cell_private.h" // don't change it
+#include "u_cell_mux_stream.h"
+#include "u_cell_mux_private.h"
+#include "u_cell_mux.h"
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Find a channel in a multiplexer context, -1 to find a free entry.
+static uCellMuxPrivateChannel_t *pGetChannel(uCellMuxPrivateContext_t *pContext,
+                                             int32_t channel)
+{
+    uCellMuxPrivateChannel_t *pChannel = NULL;
+
+    for (size_t x = 0; (x < sizeof(pContext->channels) / sizeof(pContext->channels[0])) &&
+         (pChannel == NULL); x++) {
+        if (pContext->channels[x].channel == channel) {
+            pChannel = &(pContext->channels[x]);
+        }
+    }
+
+    return pChannel;
+}
+
+// Stop socket and MQTT data going to the AT client on the data
+// channel, letting any transfer already in progress on it finish,
+// so that the AT client can be removed.
+static void dataChannelDetach(uCellPrivateInstance_t *pInstance)
+{
+    uAtClientHandle_t atHandleData = pInstance->atHandleData;
+
+    if (atHandleData != NULL) {
+        pInstance->atHandleData = NULL;
+        uAtClientLock(atHandleData);
+        uAtClientUnlock(atHandleData);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO CELLULAR
+ * -------------------------------------------------------------- */
+
+// Remove the multiplexer context of an instance.
+void uCellMuxPrivateRemoveContext(uCellPrivateInstance_t *pInstance)
+{
+    uCellMuxPrivateContext_t *pContext;
+    uCellMuxPrivateChannel_t *pChannel;
+
+    if (pInstance != NULL) {
+        pContext = (uCellMuxPrivateContext_t *) pInstance->pMuxContext;
+        if (pContext != NULL) {
+            dataChannelDetach(pInstance);
+            for (size_t x = 0; x < sizeof(pContext->channels) / sizeof(pContext->channels[0]); x++) {
+                pChannel = &(pContext->channels[x]);
+                if (pChannel->channel >= 0) {
+                    if (pChannel->atHandle == pInstance->atHandle) {
+                        // Leave the AT client of the instance
+                        // unattached for now
+                        uAtClientStreamSet(pChannel->atHandle, -1,
+                                           U_AT_CLIENT_STREAM_TYPE_CMUX);
+                    } else {
+                        uAtClientRemove(pChannel->atHandle);
+                    }
+                    uCellMuxStreamChannelClose(pChannel->streamHandle);
+                }
+            }
+            // This tells the module to leave multiplexer mode
+            uCellMuxStreamClose(pContext->muxHandle);
+            // Back to the UART
+            uAtClientStreamSet(pInstance->atHandle, pContext->uartHandle,
+                               U_AT_CLIENT_STREAM_TYPE_UART);
+            free(pContext);
+            pInstance->pMuxContext = NULL;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Switch the module into multiplexer mode.
+int32_t uCellMuxEnable(int32_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxPrivateContext_t *pContext;
+    uAtClientHandle_t atHandle;
+    uAtClientStream_t streamType = U_AT_CLIENT_STREAM_TYPE_MAX;
+    int32_t uartHandle;
+    int32_t streamHandle;
+    bool closedDown = false;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pInstance->pMuxContext == NULL)) {
+            atHandle = pInstance->atHandle;
+            uartHandle = uAtClientStreamGet(atHandle, &streamType);
+            if (streamType == U_AT_CLIENT_STREAM_TYPE_UART) {
+                errorCode = uCellMuxStreamInit();
+                if (errorCode == 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pContext = (uCellMuxPrivateContext_t *) malloc(sizeof(uCellMuxPrivateContext_t));
+                    if (pContext != NULL) {
+                        memset(pContext, 0, sizeof(*pContext));
+                        for (size_t x = 0; x < sizeof(pContext->channels) /
+                             sizeof(pContext->channels[0]); x++) {
+                            pContext->channels[x].channel = -1;
+                        }
+                        pContext->uartHandle = uartHandle;
+                        // Basic option, UIH frames, our N1
+                        uAtClientLock(atHandle);
+                        uAtClientCommandStart(atHandle, "AT+CMUX=0,0,,");
+                        uAtClientWriteInt(atHandle,
+                                          U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES);
+                        uAtClientCommandStopReadResponse(atHandle);
+                        errorCode = uAtClientUnlock(atHandle);
+                        if (errorCode == 0) {
+                            // The UART now belongs to the multiplexer
+                            uAtClientStreamSet(atHandle, -1, U_AT_CLIENT_STREAM_TYPE_UART);
+                            errorCode = uCellMuxStreamOpen(uartHandle);
+                            if (errorCode >= 0) {
+                                pContext->muxHandle = errorCode;
+                                streamHandle = uCellMuxStreamChannelOpen(pContext->muxHandle,
+                                                                         U_CELL_MUX_CHANNEL_AT_CONTROL);
+                                errorCode = streamHandle;
+                                if (streamHandle >= 0) {
+                                    errorCode = uAtClientStreamSet(atHandle, streamHandle,
+                                                                   U_AT_CLIENT_STREAM_TYPE_CMUX);
+                                    if (errorCode == 0) {
+                                        pContext->channels[0].channel = U_CELL_MUX_CHANNEL_AT_CONTROL;
+                                        pContext->channels[0].streamHandle = streamHandle;
+                                        pContext->channels[0].atHandle = atHandle;
+                                        pInstance->pMuxContext = pContext;
+                                    } else {
+                                        uCellMuxStreamChannelClose(streamHandle);
+                                    }
+                                }
+                                if (errorCode != 0) {
+                                    closedDown = (uCellMuxStreamClose(pContext->muxHandle) == 0);
+                                }
+                            }
+                            if (errorCode != 0) {
+                                // Put the AT client back where it was
+                                uAtClientStreamSet(atHandle, uartHandle,
+                                                   U_AT_CLIENT_STREAM_TYPE_UART);
+                                uPortLog("U_CELL_MUX: unable to start multiplexer (%d).\n",
+                                         errorCode);
+                                if (!closedDown) {
+                                    // The module accepted AT+CMUX and has
+                                    // not confirmed leaving multiplexer mode
+                                    uPortLog("U_CELL_MUX: the module may still be in"
+                                             " multiplexer mode.\n");
+                                    errorCode = (int32_t) U_CELL_ERROR_MUX_STATE_UNKNOWN;
+                                }
+                            }
+                        }
+                        if (errorCode != 0) {
+                            free(pContext);
+                        }
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Determine whether multiplexer mode is enabled.
+bool uCellMuxIsEnabled(int32_t cellHandle)
+{
+    bool isEnabled = false;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        if (pInstance != NULL) {
+            isEnabled = (pInstance->pMuxContext != NULL);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return isEnabled;
+}
+
+// Open another multiplexer channel with its own AT client.
+int32_t uCellMuxAddChannel(int32_t cellHandle, int32_t channel,
+                           uAtClientHandle_t *pAtHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxPrivateContext_t *pContext = NULL;
+    uCellMuxPrivateChannel_t *pChannel = NULL;
+    uAtClientHandle_t atHandle;
+    int32_t streamHandle;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            pContext = (uCellMuxPrivateContext_t *) pInstance->pMuxContext;
+        }
+        if ((pContext != NULL) && (pAtHandle != NULL) &&
+            (channel != U_CELL_MUX_CHANNEL_AT_CONTROL) &&
+            (pGetChannel(pContext, channel) == NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pChannel = pGetChannel(pContext, -1);
+            if (pChannel != NULL) {
+                streamHandle = uCellMuxStreamChannelOpen(pContext->muxHandle, channel);
+                errorCode = streamHandle;
+                if (streamHandle >= 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    atHandle = uAtClientAdd(streamHandle, U_AT_CLIENT_STREAM_TYPE_CMUX,
+                                            NULL, U_CELL_AT_BUFFER_LENGTH_BYTES);
+                    if (atHandle != NULL) {
+                        // Behave like the AT client of the instance
+                        uAtClientTimeoutSet(atHandle, uAtClientTimeoutGet(pInstance->atHandle));
+                        uAtClientDelimiterSet(atHandle, uAtClientDelimiterGet(pInstance->atHandle));
+                        uAtClientDelaySet(atHandle, uAtClientDelayGet(pInstance->atHandle));
+                        uAtClientDebugSet(atHandle, uAtClientDebugGet(pInstance->atHandle));
+                        uAtClientPrintAtSet(atHandle, uAtClientPrintAtGet(pInstance->atHandle));
+                        pChannel->channel = channel;
+                        pChannel->streamHandle = streamHandle;
+                        pChannel->atHandle = atHandle;
+                        if (channel == U_CELL_MUX_CHANNEL_DATA) {
+                            pInstance->atHandleData = atHandle;
+                        }
+                        *pAtHandle = atHandle;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    } else {
+                        uCellMuxStreamChannelClose(streamHandle);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Close a multiplexer channel opened with uCellMuxAddChannel().
+int32_t uCellMuxRemoveChannel(int32_t cellHandle, int32_t channel)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+    uCellMuxPrivateContext_t *pContext = NULL;
+    uCellMuxPrivateChannel_t *pChannel = NULL;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            pContext = (uCellMuxPrivateContext_t *) pInstance->pMuxContext;
+        }
+        if ((pContext != NULL) && (channel >= 0) &&
+            (channel != U_CELL_MUX_CHANNEL_AT_CONTROL)) {
+            pChannel = pGetChannel(pContext, channel);
+        }
+        if (pChannel != NULL) {
+            if (pChannel->atHandle == pInstance->atHandleData) {
+                dataChannelDetach(pInstance);
+            }
+            uAtClientRemove(pChannel->atHandle);
+            uCellMuxStreamChannelClose(pChannel->streamHandle);
+            memset(pChannel, 0, sizeof(*pChannel));
+            pChannel->channel = -1;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Switch the module out of multiplexer mode.
+int32_t uCellMuxDisable(int32_t cellHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pInstance != NULL) {
+            uCellMuxPrivateRemoveContext(pInstance);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// End of file
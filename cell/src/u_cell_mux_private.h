@@ -0,0 +1,76 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CELL_MUX_PRIVATE_H_
+#define _U_CELL_MUX_PRIVATE_H_
+
+/* No #includes allowed here */
+
+/** @file
+ * @brief This header file defines the multiplexer context of a
+ * cellular instance and the function that removes it, which is
+ * needed by uCellRemove() and uCellDeinit(); it is kept out of
+ * u_cell_private.h so that the multiplexer stream header need
+ * not be dragged into the rest of the cellular API.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A multiplexer channel opened by the cellular API.
+ */
+typedef struct {
+    int32_t channel; /**< The channel, -1 if this entry is not in use. */
+    int32_t streamHandle; /**< The stream handle of the channel. */
+    uAtClientHandle_t atHandle; /**< The AT client on the channel; for
+                                     U_CELL_MUX_CHANNEL_AT_CONTROL this
+                                     is the AT client of the instance. */
+} uCellMuxPrivateChannel_t;
+
+/** The multiplexer context of a cellular instance.
+ */
+typedef struct {
+    int32_t muxHandle; /**< The handle of the multiplexer. */
+    int32_t uartHandle; /**< The UART the multiplexer is running on. */
+    uCellMuxPrivateChannel_t channels[U_CELL_MUX_STREAM_MAX_NUM_CHANNELS];
+} uCellMuxPrivateContext_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Remove the multiplexer context for the given instance, if there
+ * is one: all channels are closed, the module is taken out of
+ * multiplexer mode and the AT client of the instance is put back
+ * on the UART.
+ * Note: gUCellPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance   a pointer to the cellular instance.
+ */
+void uCellMuxPrivateRemoveContext(uCellPrivateInstance_t *pInstance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_CELL_MUX_PRIVATE_H_
+
+// End of file
@@ -0,0 +1,1293 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the 3GPP 27.010 (CMUX) multiplexer stream:
+ * the basic option with UIH frames only, as supported by u-blox
+ * cellular modules.
+ *
+ * Frames have the form:
+ *
+ * ```
+ * +------+---------+---------+-----------+-------------+-----+------+
+ * | 0xF9 | address | control | length    | information | FCS | 0xF9 |
+ * |      | 1 byte  | 1 byte  | 1/2 bytes | 0 to N1     |     |      |
+ * +------+---------+---------+-----------+-------------+-----+------+
+ * ```
+ *
+ * ...where the address contains the DLCI (the channel), the control
+ * field the frame type and, for UIH frames, the FCS covers only the
+ * address, control and length fields.  DLCI 0 is the control channel,
+ * which carries the messages that switch flow control on and off
+ * for a channel (MSC) or for the whole multiplexer (FCon/FCoff) and
+ * the message that closes the multiplexer down (CLD).
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // malloc() and free()
+#include "string.h"    // memset(), memcpy()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+#include "u_port_event_queue.h"
+
+#include "u_ringbuffer.h"
+
+#include "u_cell_mux_stream.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The flag that starts and ends a frame.
+ */
+#define U_CELL_MUX_STREAM_FLAG 0xF9
+
+/** The extension bit, set in the last octet of an address, length
+ * or control channel message type.
+ */
+#define U_CELL_MUX_STREAM_EA 0x01
+
+/** The command/response bit.
+ */
+#define U_CELL_MUX_STREAM_CR 0x02
+
+/** The poll/final bit of the control field.
+ */
+#define U_CELL_MUX_STREAM_PF 0x10
+
+/** The frame types, i.e. the control field without the P/F bit.
+ */
+#define U_CELL_MUX_STREAM_FRAME_TYPE_SABM 0x2F
+#define U_CELL_MUX_STREAM_FRAME_TYPE_UA   0x63
+#define U_CELL_MUX_STREAM_FRAME_TYPE_DM   0x0F
+#define U_CELL_MUX_STREAM_FRAME_TYPE_DISC 0x43
+#define U_CELL_MUX_STREAM_FRAME_TYPE_UIH  0xEF
+#define U_CELL_MUX_STREAM_FRAME_TYPE_UI   0x03
+
+/** The control channel message types, with the EA bit set and
+ * the C/R bit clear.
+ */
+#define U_CELL_MUX_STREAM_MSG_TYPE_PN    0x81
+#define U_CELL_MUX_STREAM_MSG_TYPE_CLD   0xC1
+#define U_CELL_MUX_STREAM_MSG_TYPE_TEST  0x21
+#define U_CELL_MUX_STREAM_MSG_TYPE_FCON  0xA1
+#define U_CELL_MUX_STREAM_MSG_TYPE_FCOFF 0x61
+#define U_CELL_MUX_STREAM_MSG_TYPE_MSC   0xE1
+#define U_CELL_MUX_STREAM_MSG_TYPE_NSC   0x11
+
+/** The V.24 signals sent in an MSC message: DV, RTR and RTC set.
+ */
+#define U_CELL_MUX_STREAM_V24_SIGNALS 0x8D
+
+/** The flow control bit in the V.24 signals of an MSC message.
+ */
+#define U_CELL_MUX_STREAM_V24_FC 0x02
+
+/** The maximum length of a frame header: flag, address, control
+ * and a two-byte length.
+ */
+#define U_CELL_MUX_STREAM_HEADER_MAX_LENGTH_BYTES 5
+
+/** The amount to read from the UART in one go.
+ */
+#define U_CELL_MUX_STREAM_UART_READ_LENGTH_BYTES 128
+
+/** The number of entries on the event queue of a channel; since
+ * an event is only sent when there isn't one already pending this
+ * need not be large.
+ */
+#define U_CELL_MUX_STREAM_CHANNEL_EVENT_QUEUE_SIZE 2
+
+/** The interval at which to check for a response from the far end.
+ */
+#define U_CELL_MUX_STREAM_POLL_INTERVAL_MS 10
+
+/** Make a stream handle from a multiplexer handle and a channel.
+ */
+#define U_CELL_MUX_STREAM_HANDLE(muxHandle, channel) (((muxHandle) * \
+                                                       (U_CELL_MUX_STREAM_MAX_CHANNEL + 1)) + (channel))
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The states of the frame parser.
+ */
+typedef enum {
+    U_CELL_MUX_STREAM_PARSER_STATE_FLAG,
+    U_CELL_MUX_STREAM_PARSER_STATE_ADDRESS,
+    U_CELL_MUX_STREAM_PARSER_STATE_CONTROL,
+    U_CELL_MUX_STREAM_PARSER_STATE_LENGTH,
+    U_CELL_MUX_STREAM_PARSER_STATE_INFORMATION,
+    U_CELL_MUX_STREAM_PARSER_STATE_FCS,
+    U_CELL_MUX_STREAM_PARSER_STATE_CLOSING_FLAG
+} uCellMuxStreamParserState_t;
+
+/** The frame parser.
+ */
+typedef struct {
+    uCellMuxStreamParserState_t state;
+    char header[U_CELL_MUX_STREAM_HEADER_MAX_LENGTH_BYTES - 1]; /** Address, control
+                                                                    and length. */
+    size_t headerLength;
+    size_t length; /** The length of the information field. */
+    size_t index; /** How much of the information field has been received. */
+    char fcs;
+    char information[U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES];
+} uCellMuxStreamParser_t;
+
+struct uCellMuxStreamInstance_t;
+
+/** A channel of a multiplexer.
+ */
+typedef struct {
+    int32_t channel; /** The DLCI. */
+    int32_t streamHandle;
+    struct uCellMuxStreamInstance_t *pMux;
+    uRingBuffer_t rxBuffer;
+    char *pRxLinearBuffer;
+    bool rxFlowStopped; /** True if we have asked the far end to stop sending. */
+    volatile bool txFlowStopped; /** True if the far end has asked us to stop sending. */
+    int32_t eventQueueHandle;
+    bool eventPending;
+    bool callbackRunning;
+    uCellMuxStreamEventCallback_t pCallback;
+    void *pCallbackParam;
+} uCellMuxStreamChannel_t;
+
+/** A multiplexer.
+ */
+typedef struct uCellMuxStreamInstance_t {
+    int32_t handle;
+    int32_t uartHandle;
+    uPortMutexHandle_t txMutex; /** Keeps the frames being written whole. */
+    uCellMuxStreamChannel_t *pChannels[U_CELL_MUX_STREAM_MAX_NUM_CHANNELS];
+    uint32_t establishedBitmap; /** Bit n is set if DLCI n is established. */
+    uint32_t sabmPendingBitmap; /** Bit n is set if we are waiting for a UA to a SABM. */
+    uint32_t discPendingBitmap; /** Bit n is set if we are waiting for a UA to a DISC. */
+    uint32_t refusedBitmap; /** Bit n is set if the far end responded DM. */
+    volatile bool txFlowStoppedAll; /** True if the far end has sent FCoff. */
+    bool closedDown; /** True once the far end has left multiplexer mode: it
+                         has responded to CLD, sent CLD itself or sent or
+                         acknowledged a DISC on the control channel. */
+    uCellMuxStreamParser_t parser;
+    char rxChunk[U_CELL_MUX_STREAM_UART_READ_LENGTH_BYTES];
+    struct uCellMuxStreamInstance_t *pNext;
+} uCellMuxStreamInstance_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect the multiplexers and their channels.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** Root of the linked list of multiplexers.
+ */
+static uCellMuxStreamInstance_t *gpMuxList = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HOUSEKEEPING
+ * -------------------------------------------------------------- */
+
+// Find a multiplexer by handle; gMutex must be locked.
+static uCellMuxStreamInstance_t *pGetMux(int32_t muxHandle)
+{
+    uCellMuxStreamInstance_t *pMux = gpMuxList;
+
+    while ((pMux != NULL) && (pMux->handle != muxHandle)) {
+        pMux = pMux->pNext;
+    }
+
+    return pMux;
+}
+
+// Find a channel of a multiplexer by DLCI; gMutex must be locked.
+static uCellMuxStreamChannel_t *pGetChannel(const uCellMuxStreamInstance_t *pMux,
+                                            int32_t channel)
+{
+    uCellMuxStreamChannel_t *pChannel = NULL;
+
+    for (size_t x = 0; (x < sizeof(pMux->pChannels) / sizeof(pMux->pChannels[0])) &&
+         (pChannel == NULL); x++) {
+        if ((pMux->pChannels[x] != NULL) && (pMux->pChannels[x]->channel == channel)) {
+            pChannel = pMux->pChannels[x];
+        }
+    }
+
+    return pChannel;
+}
+
+// Find a channel by stream handle; gMutex must be locked.
+static uCellMuxStreamChannel_t *pGetChannelStream(int32_t streamHandle)
+{
+    uCellMuxStreamChannel_t *pChannel = NULL;
+    uCellMuxStreamInstance_t *pMux;
+
+    if (streamHandle >= 0) {
+        pMux = pGetMux(streamHandle / (U_CELL_MUX_STREAM_MAX_CHANNEL + 1));
+        if (pMux != NULL) {
+            pChannel = pGetChannel(pMux, streamHandle % (U_CELL_MUX_STREAM_MAX_CHANNEL + 1));
+        }
+    }
+
+    return pChannel;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SENDING FRAMES
+ * -------------------------------------------------------------- */
+
+// Work out the FCS of a frame.
+static char fcs(const char *pData, size_t length)
+{
+    uint8_t crc = 0xFF;
+
+    for (size_t x = 0; x < length; x++) {
+        crc ^= (uint8_t) *pData;
+        pData++;
+        for (size_t y = 0; y < 8; y++) {
+            if (crc & 0x01) {
+                crc = (uint8_t) ((crc >> 1) ^ 0xE0);
+            } else {
+                crc >>= 1;
+            }
+        }
+    }
+
+    return (char) (0xFF - crc);
+}
+
+// Write a frame to a UART, returning zero on success else negative
+// error code; frameSend() should be used where there is a multiplexer.
+static int32_t frameWrite(int32_t uartHandle, int32_t channel,
+                          bool isCommand, char control,
+                          const char *pData, size_t length)
+{
+    int32_t errorCode;
+    char header[U_CELL_MUX_STREAM_HEADER_MAX_LENGTH_BYTES];
+    char tail[2];
+    size_t headerLength = 0;
+    uPortUartIoVec_t ioVec[3];
+
+    header[headerLength++] = (char) U_CELL_MUX_STREAM_FLAG;
+    header[headerLength++] = (char) ((channel << 2) | U_CELL_MUX_STREAM_EA |
+                                     (isCommand ? U_CELL_MUX_STREAM_CR : 0));
+    header[headerLength++] = control;
+    if (length > 0x7F) {
+        header[headerLength++] = (char) ((length & 0x7F) << 1);
+        header[headerLength++] = (char) (length >> 7);
+    } else {
+        header[headerLength++] = (char) ((length << 1) | U_CELL_MUX_STREAM_EA);
+    }
+    // We only send UIH frames with information, for which
+    // the FCS does not include the information field
+    tail[0] = fcs(header + 1, headerLength - 1);
+    tail[1] = (char) U_CELL_MUX_STREAM_FLAG;
+    ioVec[0].pBuffer = header;
+    ioVec[0].sizeBytes = headerLength;
+    ioVec[1].pBuffer = pData;
+    ioVec[1].sizeBytes = length;
+    ioVec[2].pBuffer = tail;
+    ioVec[2].sizeBytes = sizeof(tail);
+
+    errorCode = uPortUartWritev(uartHandle, ioVec,
+                                sizeof(ioVec) / sizeof(ioVec[0]));
+    if (errorCode >= 0) {
+        if ((size_t) errorCode == headerLength + length + sizeof(tail)) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        }
+    }
+
+    return errorCode;
+}
+
+// Send a frame, returning zero on success else negative error code.
+static int32_t frameSend(const uCellMuxStreamInstance_t *pMux,
+                         int32_t channel, bool isCommand, char control,
+                         const char *pData, size_t length)
+{
+    int32_t errorCode;
+
+    U_PORT_MUTEX_LOCK(pMux->txMutex);
+    errorCode = frameWrite(pMux->uartHandle, channel, isCommand,
+                           control, pData, length);
+    U_PORT_MUTEX_UNLOCK(pMux->txMutex);
+
+    return errorCode;
+}
+
+// Send a control channel message.
+static int32_t messageSend(const uCellMuxStreamInstance_t *pMux,
+                           char type, bool isCommand,
+                           const char *pValue, size_t length)
+{
+    char buffer[2 + U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES];
+
+    if (length > sizeof(buffer) - 2) {
+        length = sizeof(buffer) - 2;
+    }
+    buffer[0] = (char) (type | (isCommand ? U_CELL_MUX_STREAM_CR : 0));
+    buffer[1] = (char) ((length << 1) | U_CELL_MUX_STREAM_EA);
+    if (length > 0) {
+        memcpy(buffer + 2, pValue, length);
+    }
+
+    return frameSend(pMux, 0, true, (char) U_CELL_MUX_STREAM_FRAME_TYPE_UIH,
+                     buffer, length + 2);
+}
+
+// Send an MSC command for a channel, with flow control on or off.
+static int32_t mscSend(const uCellMuxStreamInstance_t *pMux,
+                       int32_t channel, bool flowStopped)
+{
+    char value[2];
+
+    value[0] = (char) ((channel << 2) | U_CELL_MUX_STREAM_CR | U_CELL_MUX_STREAM_EA);
+    value[1] = (char) U_CELL_MUX_STREAM_V24_SIGNALS;
+    if (flowStopped) {
+        value[1] |= U_CELL_MUX_STREAM_V24_FC;
+    }
+
+    return messageSend(pMux, (char) U_CELL_MUX_STREAM_MSG_TYPE_MSC,
+                       true, value, sizeof(value));
+}
+
+// Wait for a bit to be set in establishedBitmap (or cleared, if
+// waitForClear is true) or for the far end to refuse; gMutex must
+// be locked and will be released while waiting.
+static bool waitEstablished(uCellMuxStreamInstance_t *pMux,
+                            int32_t channel, bool waitForClear)
+{
+    int64_t startTimeMs = uPortGetTickTimeMs();
+    uint32_t bit = 1UL << channel;
+
+    while ((((pMux->establishedBitmap & bit) != 0) == waitForClear) &&
+           ((pMux->refusedBitmap & bit) == 0) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_STREAM_RESPONSE_TIMEOUT_MS)) {
+        uPortMutexUnlock(gMutex);
+        uPortTaskBlock(U_CELL_MUX_STREAM_POLL_INTERVAL_MS);
+        uPortMutexLock(gMutex);
+    }
+
+    return ((pMux->establishedBitmap & bit) != 0) != waitForClear;
+}
+
+// Establish a DLCI, if it is not already; gMutex must be locked.
+static bool establish(uCellMuxStreamInstance_t *pMux, int32_t channel)
+{
+    uint32_t bit = 1UL << channel;
+
+    if ((pMux->establishedBitmap & bit) == 0) {
+        pMux->refusedBitmap &= ~bit;
+        pMux->sabmPendingBitmap |= bit;
+        frameSend(pMux, channel, true,
+                  (char) (U_CELL_MUX_STREAM_FRAME_TYPE_SABM | U_CELL_MUX_STREAM_PF),
+                  NULL, 0);
+        waitEstablished(pMux, channel, false);
+        pMux->sabmPendingBitmap &= ~bit;
+    }
+
+    return (pMux->establishedBitmap & bit) != 0;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: RECEIVING FRAMES
+ * -------------------------------------------------------------- */
+
+// Send the data event for a channel if one is not already pending;
+// gMutex must be locked.
+static void channelEventSend(uCellMuxStreamChannel_t *pChannel)
+{
+    if (!pChannel->eventPending && (pChannel->eventQueueHandle >= 0)) {
+        pChannel->eventPending = true;
+        if (uPortEventQueueSend(pChannel->eventQueueHandle,
+                                &pChannel, sizeof(pChannel)) != 0) {
+            pChannel->eventPending = false;
+        }
+    }
+}
+
+// The event handler of a channel: calls the user's callback.
+static void channelEventHandler(void *pParam, size_t paramLength)
+{
+    uCellMuxStreamChannel_t *pChannel = *((uCellMuxStreamChannel_t **) pParam);
+    uCellMuxStreamEventCallback_t pCallback;
+    void *pCallbackParam;
+
+    (void) paramLength;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+    pChannel->eventPending = false;
+    pCallback = pChannel->pCallback;
+    pCallbackParam = pChannel->pCallbackParam;
+    // Flag that we're in the callback so that
+    // uCellMuxStreamCallbackRemove() can wait for it
+    pChannel->callbackRunning = (pCallback != NULL);
+    U_PORT_MUTEX_UNLOCK(gMutex);
+
+    if (pCallback != NULL) {
+        pCallback(pChannel->streamHandle, U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                  pCallbackParam);
+        U_PORT_MUTEX_LOCK(gMutex);
+        pChannel->callbackRunning = false;
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// Handle the messages of a UIH frame on the control channel;
+// gMutex must be locked.
+static void controlHandle(uCellMuxStreamInstance_t *pMux,
+                          const char *pData, size_t length)
+{
+    size_t x = 0;
+    char type;
+    size_t messageLength;
+    const char *pValue;
+    uCellMuxStreamChannel_t *pChannel;
+
+    while (x + 2 <= length) {
+        type = pData[x];
+        messageLength = ((uint8_t) pData[x + 1]) >> 1;
+        pValue = pData + x + 2;
+        x += 2 + messageLength;
+        if (x > length) {
+            break;
+        }
+        if (type & U_CELL_MUX_STREAM_CR) {
+            // A command: act on it and respond with the same message
+            type &= ~U_CELL_MUX_STREAM_CR;
+            switch ((uint8_t) type) {
+                case U_CELL_MUX_STREAM_MSG_TYPE_MSC:
+                    if (messageLength >= 2) {
+                        pChannel = pGetChannel(pMux, ((uint8_t) pValue[0]) >> 2);
+                        if (pChannel != NULL) {
+                            pChannel->txFlowStopped = (pValue[1] & U_CELL_MUX_STREAM_V24_FC) != 0;
+                        }
+                    }
+                    break;
+                case U_CELL_MUX_STREAM_MSG_TYPE_FCON:
+                    pMux->txFlowStoppedAll = false;
+                    break;
+                case U_CELL_MUX_STREAM_MSG_TYPE_FCOFF:
+                    pMux->txFlowStoppedAll = true;
+                    break;
+                case U_CELL_MUX_STREAM_MSG_TYPE_CLD:
+                    pMux->establishedBitmap = 0;
+                    pMux->closedDown = true;
+                    break;
+                case U_CELL_MUX_STREAM_MSG_TYPE_PN:
+                // Accept the parameters as proposed
+                case U_CELL_MUX_STREAM_MSG_TYPE_TEST:
+                    break;
+                default:
+                    // Not supported: tell the far end so
+                    pValue = &type;
+                    messageLength = 1;
+                    type = (char) U_CELL_MUX_STREAM_MSG_TYPE_NSC;
+                    break;
+            }
+            messageSend(pMux, type, false, pValue, messageLength);
+        } else if ((uint8_t) type == U_CELL_MUX_STREAM_MSG_TYPE_CLD) {
+            pMux->closedDown = true;
+        }
+    }
+}
+
+// Handle a received frame; gMutex must be locked.
+static void frameHandle(uCellMuxStreamInstance_t *pMux)
+{
+    uCellMuxStreamParser_t *pParser = &(pMux->parser);
+    int32_t channel = ((uint8_t) pParser->header[0]) >> 2;
+    uint32_t bit;
+    uCellMuxStreamChannel_t *pChannel;
+    size_t bufferSize = U_CELL_MUX_STREAM_CHANNEL_BUFFER_LENGTH_BYTES;
+
+    if (channel > U_CELL_MUX_STREAM_MAX_CHANNEL) {
+        return;
+    }
+    bit = 1UL << channel;
+
+    switch ((uint8_t) pParser->header[1] & ~U_CELL_MUX_STREAM_PF) {
+        case U_CELL_MUX_STREAM_FRAME_TYPE_SABM:
+            // Accept whatever the far end wants to open
+            pMux->establishedBitmap |= bit;
+            frameSend(pMux, channel, false,
+                      (char) (U_CELL_MUX_STREAM_FRAME_TYPE_UA | U_CELL_MUX_STREAM_PF),
+                      NULL, 0);
+            break;
+        case U_CELL_MUX_STREAM_FRAME_TYPE_UA:
+            if (pMux->discPendingBitmap & bit) {
+                pMux->discPendingBitmap &= ~bit;
+                pMux->establishedBitmap &= ~bit;
+                if (channel == 0) {
+                    pMux->closedDown = true;
+                }
+            } else if (pMux->sabmPendingBitmap & bit) {
+                pMux->sabmPendingBitmap &= ~bit;
+                pMux->establishedBitmap |= bit;
+            }
+            break;
+        case U_CELL_MUX_STREAM_FRAME_TYPE_DM:
+            pMux->refusedBitmap |= bit;
+            pMux->establishedBitmap &= ~bit;
+            break;
+        case U_CELL_MUX_STREAM_FRAME_TYPE_DISC:
+            frameSend(pMux, channel, false,
+                      (char) (U_CELL_MUX_STREAM_FRAME_TYPE_UA | U_CELL_MUX_STREAM_PF),
+                      NULL, 0);
+            if (channel == 0) {
+                pMux->establishedBitmap = 0;
+                pMux->closedDown = true;
+            } else {
+                pMux->establishedBitmap &= ~bit;
+            }
+            break;
+        case U_CELL_MUX_STREAM_FRAME_TYPE_UIH:
+        case U_CELL_MUX_STREAM_FRAME_TYPE_UI:
+            if (channel == 0) {
+                controlHandle(pMux, pParser->information, pParser->length);
+            } else {
+                pChannel = pGetChannel(pMux, channel);
+                if ((pChannel != NULL) && (pParser->length > 0)) {
+                    if (!uRingBufferAdd(&(pChannel->rxBuffer), pParser->information,
+                                        pParser->length)) {
+                        uPortLog("U_CELL_MUX_STREAM: %d byte(s) lost on channel %d.\n",
+                                 pParser->length, channel);
+                    }
+                    if (!pChannel->rxFlowStopped &&
+                        (uRingBufferAvailableSize(&(pChannel->rxBuffer)) < bufferSize / 2)) {
+                        // Ask the far end to hold off
+                        pChannel->rxFlowStopped = true;
+                        mscSend(pMux, channel, true);
+                    }
+                    channelEventSend(pChannel);
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+// Parse received data into frames; gMutex must be locked.
+static void parse(uCellMuxStreamInstance_t *pMux, const char *pData,
+                  size_t length)
+{
+    uCellMuxStreamParser_t *pParser = &(pMux->parser);
+    size_t x;
+    char c;
+
+    while (length > 0) {
+        c = *pData;
+        x = 1;
+        switch (pParser->state) {
+            case U_CELL_MUX_STREAM_PARSER_STATE_FLAG:
+                if (c == (char) U_CELL_MUX_STREAM_FLAG) {
+                    pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_ADDRESS;
+                }
+                break;
+            case U_CELL_MUX_STREAM_PARSER_STATE_ADDRESS:
+                // Repeated flags are allowed
+                if (c != (char) U_CELL_MUX_STREAM_FLAG) {
+                    pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_FLAG;
+                    if (c & U_CELL_MUX_STREAM_EA) {
+                        pParser->header[0] = c;
+                        pParser->headerLength = 1;
+                        pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_CONTROL;
+                    }
+                }
+                break;
+            case U_CELL_MUX_STREAM_PARSER_STATE_CONTROL:
+                pParser->header[pParser->headerLength++] = c;
+                pParser->length = 0;
+                pParser->index = 0;
+                pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_LENGTH;
+                break;
+            case U_CELL_MUX_STREAM_PARSER_STATE_LENGTH:
+                pParser->header[pParser->headerLength++] = c;
+                if (pParser->headerLength == 3) {
+                    pParser->length = ((uint8_t) c) >> 1;
+                } else {
+                    pParser->length |= ((size_t) (uint8_t) c) << 7;
+                }
+                if ((c & U_CELL_MUX_STREAM_EA) || (pParser->headerLength > 3)) {
+                    pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_INFORMATION;
+                    if (pParser->length == 0) {
+                        pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_FCS;
+                    } else if (pParser->length > sizeof(pParser->information)) {
+                        // Too long: start looking for a flag again
+                        pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_FLAG;
+                    }
+                }
+                break;
+            case U_CELL_MUX_STREAM_PARSER_STATE_INFORMATION:
+                // Take as much as we can in one go
+                x = pParser->length - pParser->index;
+                if (x > length) {
+                    x = length;
+                }
+                memcpy(pParser->information + pParser->index, pData, x);
+                pParser->index += x;
+                if (pParser->index >= pParser->length) {
+                    pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_FCS;
+                }
+                break;
+            case U_CELL_MUX_STREAM_PARSER_STATE_FCS:
+                pParser->fcs = c;
+                pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_CLOSING_FLAG;
+                break;
+            case U_CELL_MUX_STREAM_PARSER_STATE_CLOSING_FLAG:
+                pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_FLAG;
+                if (c == (char) U_CELL_MUX_STREAM_FLAG) {
+                    // The closing flag may also be the opening
+                    // flag of the next frame
+                    pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_ADDRESS;
+                    if (fcs(pParser->header, pParser->headerLength) == pParser->fcs) {
+                        frameHandle(pMux);
+                    }
+                }
+                break;
+            default:
+                pParser->state = U_CELL_MUX_STREAM_PARSER_STATE_FLAG;
+                break;
+        }
+        pData += x;
+        length -= x;
+    }
+}
+
+// Callback for data received on the UART.
+static void uartCallback(int32_t uartHandle, uint32_t eventBitmask,
+                         void *pParameters)
+{
+    uCellMuxStreamInstance_t *pMux = (uCellMuxStreamInstance_t *) pParameters;
+    int32_t sizeOrError = 1;
+
+    if ((gMutex != NULL) && (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+        // Release the mutex between reads so that reading
+        // from channels can continue while data is pouring in
+        while (sizeOrError > 0) {
+            U_PORT_MUTEX_LOCK(gMutex);
+            sizeOrError = uPortUartRead(uartHandle, pMux->rxChunk,
+                                        sizeof(pMux->rxChunk));
+            if (sizeOrError > 0) {
+                parse(pMux, pMux->rxChunk, sizeOrError);
+            }
+            U_PORT_MUTEX_UNLOCK(gMutex);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CLOSING
+ * -------------------------------------------------------------- */
+
+// Close a channel; gMutex must be locked and will be unlocked
+// while the event queue of the channel is closed.
+static void channelClose(uCellMuxStreamChannel_t *pChannel)
+{
+    uCellMuxStreamInstance_t *pMux = pChannel->pMux;
+    uint32_t bit = 1UL << pChannel->channel;
+
+    // Remove the channel from the multiplexer so that
+    // nothing more will be delivered to it
+    for (size_t x = 0; x < sizeof(pMux->pChannels) / sizeof(pMux->pChannels[0]); x++) {
+        if (pMux->pChannels[x] == pChannel) {
+            pMux->pChannels[x] = NULL;
+        }
+    }
+
+    if (pMux->establishedBitmap & bit) {
+        pMux->discPendingBitmap |= bit;
+        frameSend(pMux, pChannel->channel, true,
+                  (char) (U_CELL_MUX_STREAM_FRAME_TYPE_DISC | U_CELL_MUX_STREAM_PF),
+                  NULL, 0);
+        waitEstablished(pMux, pChannel->channel, true);
+        pMux->discPendingBitmap &= ~bit;
+        pMux->establishedBitmap &= ~bit;
+    }
+
+    if (pChannel->eventQueueHandle >= 0) {
+        // The event handler locks gMutex
+        uPortMutexUnlock(gMutex);
+        uPortEventQueueClose(pChannel->eventQueueHandle);
+        uPortMutexLock(gMutex);
+    }
+    uRingBufferDelete(&(pChannel->rxBuffer));
+    free(pChannel->pRxLinearBuffer);
+    free(pChannel);
+}
+
+// Wait for the far end to leave multiplexer mode; gMutex must be
+// locked and will be released while waiting.
+static bool waitClosedDown(uCellMuxStreamInstance_t *pMux)
+{
+    int64_t startTimeMs = uPortGetTickTimeMs();
+
+    while (!pMux->closedDown &&
+           (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_STREAM_RESPONSE_TIMEOUT_MS)) {
+        uPortMutexUnlock(gMutex);
+        uPortTaskBlock(U_CELL_MUX_STREAM_POLL_INTERVAL_MS);
+        uPortMutexLock(gMutex);
+    }
+
+    return pMux->closedDown;
+}
+
+// Close a multiplexer, returning true if the far end is known
+// to have left multiplexer mode; gMutex must be locked and will
+// be unlocked while the UART callback is removed.
+static bool muxClose(uCellMuxStreamInstance_t *pMux)
+{
+    uCellMuxStreamInstance_t *pCurrent;
+    uCellMuxStreamInstance_t *pPrev = NULL;
+    bool closedDown;
+    char dummy = 0;
+
+    for (size_t x = 0; x < sizeof(pMux->pChannels) / sizeof(pMux->pChannels[0]); x++) {
+        if (pMux->pChannels[x] != NULL) {
+            channelClose(pMux->pChannels[x]);
+        }
+    }
+
+    if (!pMux->closedDown && (pMux->establishedBitmap & 1)) {
+        // Tell the far end to leave multiplexer mode
+        messageSend(pMux, (char) U_CELL_MUX_STREAM_MSG_TYPE_CLD, true, &dummy, 0);
+        waitClosedDown(pMux);
+    }
+    if (!pMux->closedDown) {
+        // Either the control channel was never established or
+        // the far end did not respond to CLD: a DISC on the
+        // control channel also closes the multiplexer down
+        pMux->discPendingBitmap |= 1;
+        frameSend(pMux, 0, true,
+                  (char) (U_CELL_MUX_STREAM_FRAME_TYPE_DISC | U_CELL_MUX_STREAM_PF),
+                  NULL, 0);
+        waitClosedDown(pMux);
+        pMux->discPendingBitmap &= ~1;
+    }
+    closedDown = pMux->closedDown;
+
+    // The UART callback locks gMutex
+    uPortMutexUnlock(gMutex);
+    uPortUartEventCallbackRemove(pMux->uartHandle);
+    uPortMutexLock(gMutex);
+
+    // Remove it from the list
+    pCurrent = gpMuxList;
+    while (pCurrent != NULL) {
+        if (pCurrent == pMux) {
+            if (pPrev == NULL) {
+                gpMuxList = pCurrent->pNext;
+            } else {
+                pPrev->pNext = pCurrent->pNext;
+            }
+            pCurrent = NULL;
+        } else {
+            pPrev = pCurrent;
+            pCurrent = pPrev->pNext;
+        }
+    }
+
+    uPortMutexDelete(pMux->txMutex);
+    free(pMux);
+
+    return closedDown;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Initialise multiplexer stream handling.
+int32_t uCellMuxStreamInit()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+
+    if (gMutex == NULL) {
+        errorCode = uPortMutexCreate(&gMutex);
+    }
+
+    return errorCode;
+}
+
+// Shut down multiplexer stream handling.
+void uCellMuxStreamDeinit()
+{
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        while (gpMuxList != NULL) {
+            muxClose(gpMuxList);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+// Open a multiplexer on a UART.
+int32_t uCellMuxStreamOpen(int32_t uartHandle)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxStreamInstance_t *pMux;
+    int32_t handle = 0;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        // Don't allow two multiplexers on the same UART
+        for (pMux = gpMuxList; (pMux != NULL) && (pMux->uartHandle != uartHandle);
+             pMux = pMux->pNext) {}
+        if ((uartHandle >= 0) && (pMux == NULL)) {
+            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pMux = (uCellMuxStreamInstance_t *) malloc(sizeof(uCellMuxStreamInstance_t));
+            if (pMux != NULL) {
+                memset(pMux, 0, sizeof(*pMux));
+                // Use the lowest free handle
+                while (pGetMux(handle) != NULL) {
+                    handle++;
+                }
+                pMux->handle = handle;
+                pMux->uartHandle = uartHandle;
+                pMux->parser.state = U_CELL_MUX_STREAM_PARSER_STATE_FLAG;
+                errorCodeOrHandle = uPortMutexCreate(&(pMux->txMutex));
+                if (errorCodeOrHandle == 0) {
+                    // The callback can't do anything until we
+                    // release gMutex
+                    errorCodeOrHandle = uPortUartEventCallbackSet(uartHandle,
+                                                                  U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                                  uartCallback, pMux,
+                                                                  U_CELL_MUX_STREAM_TASK_STACK_SIZE_BYTES,
+                                                                  U_CELL_MUX_STREAM_TASK_PRIORITY);
+                    if (errorCodeOrHandle == 0) {
+                        pMux->pNext = gpMuxList;
+                        gpMuxList = pMux;
+                        // Ask for the control channel: the response
+                        // is waited for in uCellMuxStreamChannelOpen()
+                        pMux->sabmPendingBitmap |= 1;
+                        frameSend(pMux, 0, true,
+                                  (char) (U_CELL_MUX_STREAM_FRAME_TYPE_SABM | U_CELL_MUX_STREAM_PF),
+                                  NULL, 0);
+                        errorCodeOrHandle = pMux->handle;
+                    } else {
+                        uPortMutexDelete(pMux->txMutex);
+                    }
+                }
+                if (errorCodeOrHandle < 0) {
+                    free(pMux);
+                }
+            }
+            if (errorCodeOrHandle < 0) {
+                // The far end is in multiplexer mode with no
+                // multiplexer here: the best we can do is ask
+                // it to leave, there's no way to hear if it did
+                frameWrite(uartHandle, 0, true,
+                           (char) (U_CELL_MUX_STREAM_FRAME_TYPE_DISC | U_CELL_MUX_STREAM_PF),
+                           NULL, 0);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrHandle;
+}
+
+// Close a multiplexer.
+int32_t uCellMuxStreamClose(int32_t muxHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxStreamInstance_t *pMux;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pMux = pGetMux(muxHandle);
+        if (pMux != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+            if (muxClose(pMux)) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Open a channel.
+int32_t uCellMuxStreamChannelOpen(int32_t muxHandle, int32_t channel)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxStreamInstance_t *pMux;
+    uCellMuxStreamChannel_t *pChannel = NULL;
+    size_t index = 0;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pMux = pGetMux(muxHandle);
+        if ((pMux != NULL) && (channel > 0) && (channel <= U_CELL_MUX_STREAM_MAX_CHANNEL) &&
+            (pGetChannel(pMux, channel) == NULL)) {
+            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            while ((index < sizeof(pMux->pChannels) / sizeof(pMux->pChannels[0])) &&
+                   (pMux->pChannels[index] != NULL)) {
+                index++;
+            }
+            if (index < sizeof(pMux->pChannels) / sizeof(pMux->pChannels[0])) {
+                pChannel = (uCellMuxStreamChannel_t *) malloc(sizeof(uCellMuxStreamChannel_t));
+            }
+            if (pChannel != NULL) {
+                memset(pChannel, 0, sizeof(*pChannel));
+                pChannel->channel = channel;
+                pChannel->streamHandle = U_CELL_MUX_STREAM_HANDLE(pMux->handle, channel);
+                pChannel->pMux = pMux;
+                pChannel->eventQueueHandle = -1;
+                pChannel->pRxLinearBuffer = (char *) malloc(U_CELL_MUX_STREAM_CHANNEL_BUFFER_LENGTH_BYTES);
+                if (pChannel->pRxLinearBuffer != NULL) {
+                    // Only the UART callback adds and only the reader
+                    // reads, both with gMutex locked
+                    uRingBufferCreateLockFree(&(pChannel->rxBuffer), pChannel->pRxLinearBuffer,
+                                              U_CELL_MUX_STREAM_CHANNEL_BUFFER_LENGTH_BYTES);
+                    pChannel->eventQueueHandle = uPortEventQueueOpen(channelEventHandler,
+                                                                     "cellMuxChannel",
+                                                                     sizeof(pChannel),
+                                                                     U_CELL_MUX_STREAM_CHANNEL_TASK_STACK_SIZE_BYTES,
+                                                                     U_CELL_MUX_STREAM_CHANNEL_TASK_PRIORITY,
+                                                                     U_CELL_MUX_STREAM_CHANNEL_EVENT_QUEUE_SIZE);
+                    if (pChannel->eventQueueHandle >= 0) {
+                        // Add the channel now so that anything
+                        // arriving once it is open is not lost
+                        pMux->pChannels[index] = pChannel;
+                        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+                        if (establish(pMux, 0) && establish(pMux, channel)) {
+                            // Let the far end know that we're ready
+                            mscSend(pMux, channel, false);
+                            errorCodeOrHandle = pChannel->streamHandle;
+                        }
+                    }
+                }
+                if (errorCodeOrHandle < 0) {
+                    if (pMux->pChannels[index] == pChannel) {
+                        channelClose(pChannel);
+                    } else {
+                        if (pChannel->pRxLinearBuffer != NULL) {
+                            uRingBufferDelete(&(pChannel->rxBuffer));
+                        }
+                        free(pChannel->pRxLinearBuffer);
+                        free(pChannel);
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrHandle;
+}
+
+// Close a channel.
+void uCellMuxStreamChannelClose(int32_t streamHandle)
+{
+    uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannelStream(streamHandle);
+        if (pChannel != NULL) {
+            channelClose(pChannel);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// Write to a channel.
+int32_t uCellMuxStreamWrite(int32_t streamHandle, const void *pBuffer,
+                            size_t sizeBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uCellMuxStreamInstance_t *pMux = NULL;
+    uCellMuxStreamChannel_t *pChannel = NULL;
+    const char *pData = (const char *) pBuffer;
+    size_t length = 0;
+    size_t thisLength;
+    int64_t startTimeMs;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pChannel = pGetChannelStream(streamHandle);
+        if ((pChannel != NULL) && ((pBuffer != NULL) || (sizeBytes == 0))) {
+            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_RESPONDING;
+            pMux = pChannel->pMux;
+            if ((pMux->establishedBitmap & (1UL << pChannel->channel)) == 0) {
+                pMux = NULL;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        // Write without gMutex so that reception carries on
+        while ((pMux != NULL) && (length < sizeBytes)) {
+            startTimeMs = uPortGetTickTimeMs();
+            while ((pChannel->txFlowStopped || pMux->txFlowStoppedAll) &&
+                   (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_STREAM_FLOW_CONTROL_TIMEOUT_MS)) {
+                uPortTaskBlock(U_CELL_MUX_STREAM_POLL_INTERVAL_MS);
+            }
+            if (pChannel->txFlowStopped || pMux->txFlowStoppedAll) {
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                pMux = NULL;
+            } else {
+                thisLength = sizeBytes - length;
+                if (thisLength > U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES) {
+                    thisLength = U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES;
+                }
+                errorCodeOrLength = frameSend(pMux, pChannel->channel, true,
+                                              (char) U_CELL_MUX_STREAM_FRAME_TYPE_UIH,
+                                              pData + length, thisLength);
+                if (errorCodeOrLength == 0) {
+                    length += thisLength;
+                } else {
+                    pMux = NULL;
+                }
+            }
+        }
+        if ((length > 0) || (errorCodeOrLength == 0)) {
+            errorCodeOrLength = (int32_t) length;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+// Read from a channel.
+int32_t uCellMuxStreamRead(int32_t streamHandle, void *pBuffer,
+                           size_t sizeBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pChannel = pGetChannelStream(streamHandle);
+        if ((pChannel != NULL) && (pBuffer != NULL)) {
+            errorCodeOrLength = (int32_t) uRingBufferRead(&(pChannel->rxBuffer),
+                                                          (char *) pBuffer, sizeBytes);
+            if (pChannel->rxFlowStopped &&
+                (uRingBufferDataSize(&(pChannel->rxBuffer)) <
+                 U_CELL_MUX_STREAM_CHANNEL_BUFFER_LENGTH_BYTES / 4)) {
+                // Let the far end send again
+                pChannel->rxFlowStopped = false;
+                mscSend(pChannel->pMux, pChannel->channel, false);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Get the number of bytes waiting to be read on a channel.
+int32_t uCellMuxStreamGetReceiveSize(int32_t streamHandle)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pChannel = pGetChannelStream(streamHandle);
+        if (pChannel != NULL) {
+            errorCodeOrSize = (int32_t) uRingBufferDataSize(&(pChannel->rxBuffer));
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+// Set the data callback of a channel.
+//lint -esym(593, pParam) Suppress pParam not being freed here
+int32_t uCellMuxStreamCallbackSet(int32_t streamHandle,
+                                  uCellMuxStreamEventCallback_t pFunction,
+                                  void *pParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pChannel = pGetChannelStream(streamHandle);
+        if ((pChannel != NULL) && (pFunction != NULL)) {
+            pChannel->pCallback = pFunction;
+            pChannel->pCallbackParam = pParam;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Remove the data callback of a channel.
+void uCellMuxStreamCallbackRemove(int32_t streamHandle)
+{
+    uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannelStream(streamHandle);
+        if (pChannel != NULL) {
+            pChannel->pCallback = NULL;
+            pChannel->pCallbackParam = NULL;
+            // Wait for a callback that is already running to
+            // finish, unless this is being called from it
+            while ((pChannel != NULL) && pChannel->callbackRunning &&
+                   !uPortEventQueueIsTask(pChannel->eventQueueHandle)) {
+                uPortMutexUnlock(gMutex);
+                uPortTaskBlock(U_CELL_MUX_STREAM_POLL_INTERVAL_MS);
+                uPortMutexLock(gMutex);
+                pChannel = pGetChannelStream(streamHandle);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// Send an event to the data callback of a channel.
+int32_t uCellMuxStreamEventSend(int32_t streamHandle,
+                                uint32_t eventBitmask)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pChannel = pGetChannelStream(streamHandle);
+        // The only event we support
+        if ((pChannel != NULL) &&
+            (eventBitmask == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+            channelEventSend(pChannel);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Determine if we're in the callback task of a channel.
+bool uCellMuxStreamEventIsCallback(int32_t streamHandle)
+{
+    bool isEventCallback = false;
+    const uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pChannel = pGetChannelStream(streamHandle);
+        if ((pChannel != NULL) && (pChannel->eventQueueHandle >= 0)) {
+            isEventCallback = uPortEventQueueIsTask(pChannel->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return isEventCallback;
+}
+
+// Get the minimum free stack of the callback task of a channel.
+int32_t uCellMuxStreamEventStackMinFree(int32_t streamHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uCellMuxStreamChannel_t *pChannel;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pChannel = pGetChannelStream(streamHandle);
+        if ((pChannel != NULL) && (pChannel->eventQueueHandle >= 0)) {
+            sizeOrErrorCode = uPortEventQueueStackMinFree(pChannel->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// End of file
@@ -782,6 +782,18 @@ bool uCellPrivateIsDeepSleepActive(uCellPrivateInstance_t *pInstance)
     return sleepActive;
 }
 
+// Get the AT client to move data on.
+uAtClientHandle_t uCellPrivateGetAtHandleData(const uCellPrivateInstance_t *pInstance)
+{
+    uAtClientHandle_t atHandle = pInstance->atHandleData;
+
+    if (atHandle == NULL) {
+        atHandle = pInstance->atHandle;
+    }
+
+    return atHandle;
+}
+
 // Callback to wake up the cellular module from power saving.
 // IMPORTANT: nothing called from here should rely on callbacks
 // sent via the uAtClientCallback() mechanism or URCS; these will
@@ -341,6 +341,9 @@ typedef struct uCellPrivateInstance_t {
     bool rebootIsRequired;   /**< Set to true if a reboot of the module is
                                   required, e.g. as a result of a configuration
                                   change. */
+    uint32_t configurationFingerprint; /**< Fingerprint of the configuration
+                                            last applied to the module by
+                                            uCellPwr, zero if none. */
     bool (*pKeepGoingCallback) (int32_t);  /**< Used while connecting. */
     void (*pRegistrationStatusCallback) (uCellNetRegDomain_t, uCellNetStatus_t, void *);
     void *pRegistrationStatusCallbackParameter;
@@ -352,10 +355,20 @@ typedef struct uCellPrivateInstance_t {
                                       can be populared by a URC in a different thread. */
     uCellPrivateLocContext_t *pLocContext; /**< Hook for a location context. **/
     bool socketsHexMode; /**< Set to true for sockets to use hex mode. */
+    int32_t socketsWriteSegmentSizeBytes; /**< The largest amount of socket
+                                               data the module will accept
+                                               in one go, 0 if not yet known. */
+    int32_t socketsReadSegmentSizeBytes; /**< The largest amount of socket
+                                              data the module will return
+                                              in one go, 0 if not yet known. */
     const char *pFileSystemTag; /**< The tagged area of the file system currently being addressed. */
     uCellPrivateDeepSleepState_t deepSleepState; /**< The current deep sleep state. */
     bool inWakeUpCallback; /**< So that we can avoid recursion. */
     uCellPrivateSleep_t *pSleepContext; /**< Context for sleep stuff. */
+    void *pMuxContext; /**< Hook for a multiplexer context. */
+    uAtClientHandle_t atHandleData; /**< The AT client on multiplexer channel
+                                         U_CELL_MUX_CHANNEL_DATA, NULL if
+                                         data goes through atHandle. */
     struct uCellPrivateInstance_t *pNext;
 } uCellPrivateInstance_t;
 
@@ -575,6 +588,17 @@ int32_t uCellPrivateActivateProfile(const uCellPrivateInstance_t *pInstance,
  */
 bool uCellPrivateIsDeepSleepActive(uCellPrivateInstance_t *pInstance);
 
+/** Get the AT client that socket and MQTT data should be moved
+ * on: this is the AT client on multiplexer channel
+ * U_CELL_MUX_CHANNEL_DATA if one has been opened with
+ * uCellMuxAddChannel(), else the AT client of the instance.
+ * URCs are still only handled by the AT client of the instance.
+ *
+ * @param pInstance  a pointer to the cellular instance.
+ * @return           the AT client to use for data.
+ */
+uAtClientHandle_t uCellPrivateGetAtHandleData(const uCellPrivateInstance_t *pInstance);
+
 /** Callback to wake up the cellular module from power saving.
  *
  * @param atHandle   the handle of the AT client that is talking
@@ -34,7 +34,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // strlen()
+#include "string.h"    // strlen(), memset()
 
 #include "u_cfg_sw.h"
 
@@ -46,6 +46,8 @@
 #include "u_port_gpio.h"
 #include "u_port_uart.h"
 
+#include "u_hash.h"
+
 #include "u_at_client.h"
 
 #include "u_cell_module_type.h"
@@ -910,6 +912,36 @@ static bool moduleConfigureOne(uAtClientHandle_t atHandle,
     return success;
 }
 
+// Add a string, including its terminator, to a configuration
+// fingerprint.
+static uint32_t fingerprintAdd(uint32_t fingerprint, const char *pString)
+{
+    return uFnv1a32(pString, strlen(pString) + 1, fingerprint);
+}
+
+// Work out the fingerprint of a configuration: the module type
+// and the configuration commands.  Never zero, since that means
+// "not configured".
+static uint32_t configurationFingerprint(const uCellPrivateInstance_t *pInstance,
+                                         const uAtClientBatchCommand_t *pCommand,
+                                         size_t numCommands)
+{
+    uint32_t moduleType = (uint32_t) pInstance->pModule->moduleType;
+    // A 32-bit FNV-1a hash
+    uint32_t fingerprint = uFnv1a32((const char *) &moduleType,
+                                    sizeof(moduleType),
+                                    U_FNV1A32_INITIAL_VALUE);
+
+    for (size_t x = 0; x < numCommands; x++) {
+        fingerprint = fingerprintAdd(fingerprint, pCommand[x].pCommand);
+    }
+    if (fingerprint == 0) {
+        fingerprint = 1;
+    }
+
+    return fingerprint;
+}
+
 // Configure the cellular module.
 static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                                bool andRadioOff, bool returningFromSleep)
@@ -921,38 +953,41 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
     uCellPwrPsvMode_t uartPowerSavingMode = U_CELL_PWR_PSV_MODE_DISABLED; // Assume no UART power saving
     uAtClientStream_t atStreamType;
     char buffer[20]; // Enough room for AT+UPSV=2,1300
-
-    // First send all the commands that everyone gets
-    for (size_t x = 0;
-         (x < sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0])) &&
-         success; x++) {
-        success = moduleConfigureOne(atHandle, gpConfigCommand[x],
-                                     U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
-    }
-
-    if (success &&
-        U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
+    // Room for everything in gpConfigCommand plus AT+UCGED, AT&K,
+    // AT+UPSMR and AT+UPSV
+    uAtClientBatchCommand_t command[(sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0])) + 4];
+    size_t numCommands = 0;
+    size_t indexFailed = 0;
+    bool upsvSuccess = true;
+    uint32_t fingerprint;
+
+    // Assemble all the commands that everyone gets
+    memset(command, 0, sizeof(command));
+    for (size_t x = 0; x < sizeof(gpConfigCommand) / sizeof(gpConfigCommand[0]); x++) {
+        command[numCommands].pCommand = gpConfigCommand[x];
+        numCommands++;
+    }
+
+    if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
         // SARA-R4 only: switch on the right UCGED mode
         // (SARA-R5 and SARA-U201 have a single mode and require no setting)
         if (U_CELL_PRIVATE_HAS(pInstance->pModule, U_CELL_PRIVATE_FEATURE_UCGED5)) {
-            success = moduleConfigureOne(atHandle, "AT+UCGED=5",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            command[numCommands].pCommand = "AT+UCGED=5";
         } else {
-            success = moduleConfigureOne(atHandle, "AT+UCGED=2",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            command[numCommands].pCommand = "AT+UCGED=2";
         }
+        numCommands++;
     }
 
     atStreamHandle = uAtClientStreamGet(atHandle, &atStreamType);
-    if (success && (atStreamType == U_AT_CLIENT_STREAM_TYPE_UART)) {
+    if (atStreamType == U_AT_CLIENT_STREAM_TYPE_UART) {
         // Get the UART stream handle and set the flow
         // control and power saving mode correctly for it
         // TODO: check if AT&K3 requires both directions
         // of flow control to be on or just one of them
         if (uPortUartIsRtsFlowControlEnabled(atStreamHandle) &&
             uPortUartIsCtsFlowControlEnabled(atStreamHandle)) {
-            success = moduleConfigureOne(atHandle, "AT&K3",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            command[numCommands].pCommand = "AT&K3";
             if (uAtClientWakeUpHandlerIsSet(atHandle)) {
                 // The RTS/CTS handshaking lines are being used
                 // for flow control by the UART HW.  This complicates
@@ -972,8 +1007,7 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                 }
             }
         } else {
-            success = moduleConfigureOne(atHandle, "AT&K0",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+            command[numCommands].pCommand = "AT&K0";
             // RTS/CTS handshaking is not used by the UART HW, we
             // can use the wake-up on TX line feature without any
             // complications.
@@ -981,9 +1015,10 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                 uartPowerSavingMode = U_CELL_PWR_PSV_MODE_DATA;
             }
         }
+        numCommands++;
     }
 
-    if (success && uAtClientWakeUpHandlerIsSet(atHandle) &&
+    if (uAtClientWakeUpHandlerIsSet(atHandle) &&
         (pInstance->pinDtrPowerSaving >= 0)) {
         // Irrespective of all the above, we permit the user to define
         // and connect this MCU to the module's DTR pin which,
@@ -1007,37 +1042,71 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
         uartPowerSavingMode = U_CELL_PWR_PSV_MODE_DATA_SARA_R4;
     }
 
+    // Switch on the URC for deep sleep if the platform has it
+    if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+                           U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)) {
+        command[numCommands].pCommand = "AT+UPSMR=1";
+        numCommands++;
+    }
+
+    // Assemble the UART power saving mode AT command, which
+    // goes last as it may put the module to sleep
+    if (uartPowerSavingMode == U_CELL_PWR_PSV_MODE_DATA) {
+        snprintf(buffer, sizeof(buffer), "AT+UPSV=%d,%d",
+                 (int) uartPowerSavingMode,
+                 U_CELL_PWR_UART_POWER_SAVING_GSM_FRAMES);
+    } else {
+        snprintf(buffer, sizeof(buffer), "AT+UPSV=%d", (int) uartPowerSavingMode);
+    }
+    command[numCommands].pCommand = buffer;
+    numCommands++;
+
+    // The whole configuration is always sent: the module may have
+    // restarted, and restored any of these settings from a stored
+    // profile, without us knowing, so there is no query that would
+    // tell us reliably that it is all in place.  Send the lot chained
+    // together, which is a single round trip; should that fail, carry
+    // on from the command that failed one at a time, with retries, as
+    // the module may just not have been quite ready
+    fingerprint = configurationFingerprint(pInstance, command, numCommands);
+    pInstance->configurationFingerprint = 0;
+    if (uAtClientCommandBatch(atHandle, command, numCommands,
+                              true, &indexFailed) != 0) {
+        for (size_t x = indexFailed; (x < numCommands - 1) && success; x++) {
+            success = moduleConfigureOne(atHandle, command[x].pCommand,
+                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
+        }
+        // AT+UPSV is only ever tried once; if it has already failed
+        // in the batch there is no point in sending it again
+        upsvSuccess = success && (indexFailed < numCommands - 1) &&
+                      moduleConfigureOne(atHandle, buffer, 1);
+    }
+
     if (success) {
-        // Assemble the UART power saving mode AT command
-        if (uartPowerSavingMode == U_CELL_PWR_PSV_MODE_DATA) {
-            snprintf(buffer, sizeof(buffer), "AT+UPSV=%d,%d",
-                     (int) uartPowerSavingMode,
-                     U_CELL_PWR_UART_POWER_SAVING_GSM_FRAMES);
-        } else {
-            snprintf(buffer, sizeof(buffer), "AT+UPSV=%d", (int) uartPowerSavingMode);
-            if (!returningFromSleep &&
-                (uartPowerSavingMode == U_CELL_PWR_PSV_MODE_DISABLED) &&
-                uAtClientWakeUpHandlerIsSet(atHandle)) {
-                // Remove the wake-up handler if it turns out that power
-                // saving cannot be supported but leave well alone if
-                // we're actually just returning from sleep, this will
-                // have already been set up
+        if (!returningFromSleep &&
+            (uartPowerSavingMode == U_CELL_PWR_PSV_MODE_DISABLED) &&
+            uAtClientWakeUpHandlerIsSet(atHandle)) {
+            // Remove the wake-up handler if it turns out that power
+            // saving cannot be supported but leave well alone if
+            // we're actually just returning from sleep, this will
+            // have already been set up
+            uAtClientSetWakeUpHandler(atHandle, NULL, NULL, 0);
+        }
+        if (!upsvSuccess) {
+            // Don't remember this configuration as having
+            // been applied
+            fingerprint = 0;
+            if (uAtClientWakeUpHandlerIsSet(atHandle) &&
+                !returningFromSleep) {
+                // If AT+UPSV returns error and we're not already returning
+                // from sleep then power saving cannot be supported; this is
+                // true when the UART interface is actually a virtual UART
+                // interface being used from an application that is on-board
+                // the module; remove the wake-up handler in this case
                 uAtClientSetWakeUpHandler(atHandle, NULL, NULL, 0);
+                uPortLog("U_CELL_PWR: power saving not supported.\n");
             }
         }
-        // Use the UART power saving mode AT command to set the mode
-        // in the module
-        if (!moduleConfigureOne(atHandle, buffer, 1) &&
-            uAtClientWakeUpHandlerIsSet(atHandle) &&
-            !returningFromSleep) {
-            // If AT+UPSV returns error and we're not already returning
-            // from sleep then power saving cannot be supported; this is
-            // true when the UART interface is actually a virtual UART
-            // interface being used from an application that is on-board
-            // the module; remove the wake-up handler in this case
-            uAtClientSetWakeUpHandler(atHandle, NULL, NULL, 0);
-            uPortLog("U_CELL_PWR: power saving not supported.\n");
-        }
         // Now tell the AT Client that it should control the
         // DTR pin, if relevant
         if (!returningFromSleep && (uartPowerSavingMode == U_CELL_PWR_PSV_MODE_DTR)) {
@@ -1046,19 +1115,12 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
                                     U_CELL_PWR_UART_POWER_SAVING_DTR_HYSTERESIS_MS,
                                     U_CELL_DTR_PIN_ON_STATE == 1 ? true : false);
         }
-    }
-
-    if (success) {
-        // Switch on the URC for deep sleep if the platform has it
-        if (U_CELL_PRIVATE_HAS(pInstance->pModule,
+        if (!returningFromSleep &&
+            U_CELL_PRIVATE_HAS(pInstance->pModule,
                                U_CELL_PRIVATE_FEATURE_DEEP_SLEEP_URC)) {
-            success = moduleConfigureOne(atHandle, "AT+UPSMR=1",
-                                         U_CELL_PWR_CONFIGURATION_COMMAND_TRIES);
-            if (success && !returningFromSleep) {
-                // Add the URC handler if it wasn't there before
-                uAtClientSetUrcHandler(pInstance->atHandle, "+UUPSMR:",
-                                       UUPSMR_urc, pInstance);
-            }
+            // Add the URC handler if it wasn't there before
+            uAtClientSetUrcHandler(pInstance->atHandle, "+UUPSMR:",
+                                   UUPSMR_urc, pInstance);
         }
         // Update the sleep parameters; note that we ask for the
         // requested 3GPP power saving state here, rather than the
@@ -1066,12 +1128,14 @@ static int32_t moduleConfigure(uCellPrivateInstance_t *pInstance,
         // at this point but can come along later
         uCellPwrPrivateGet3gppPowerSaving(pInstance, false, NULL, NULL, NULL);
         uCellPrivateSetDeepSleepState(pInstance);
-        if (success &&
-            U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
+        if (U_CELL_PRIVATE_MODULE_IS_SARA_R4(pInstance->pModule->moduleType)) {
             // For SARA-R4, whether the E-DRX URC is on or not does not
             // survive a restart, so need to set it up again here
             success = (setEDrxUrc(pInstance) == 0);
         }
+        if (success) {
+            pInstance->configurationFingerprint = fingerprint;
+        }
     }
 
     if (success) {
@@ -1143,8 +1207,10 @@ static int32_t powerOff(uCellPrivateInstance_t *pInstance,
     uAtClientHandle_t atHandle = pInstance->atHandle;
 
     uPortLog("U_CELL_PWR: powering off with AT command.\n");
-    // Sleep is no longer available
+    // Sleep is no longer available and the module
+    // will lose its configuration
     pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
+    pInstance->configurationFingerprint = 0;
     if (uAtClientWakeUpHandlerIsSet(atHandle)) {
         // Switch off UART power saving first, as it seems to
         // affect the power off process.
@@ -1188,8 +1254,10 @@ static void quickPowerOff(uCellPrivateInstance_t *pInstance,
                           bool (*pKeepGoingCallback) (int32_t))
 {
     if (pInstance->pinPwrOn >= 0) {
-        // Sleep is no longer available
+        // Sleep is no longer available and the module
+        // will lose its configuration
         pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
+        pInstance->configurationFingerprint = 0;
         // Power off the module by pulling the PWR_ON pin
         // low for the correct number of milliseconds
         uPortGpioSet(pInstance->pinPwrOn, U_CELL_PWR_ON_PIN_TOGGLE_TO_STATE);
@@ -1778,8 +1846,9 @@ int32_t uCellPwrOffHard(int32_t cellHandle, bool trulyHard,
                 uPortGpioSet(pInstance->pinEnablePower,
                              (int32_t) !U_CELL_ENABLE_POWER_PIN_ON_STATE);
                 // Remove any security context as these disappear
-                // at power off
+                // at power off, as does the module configuration
                 uCellPrivateC2cRemoveContext(pInstance);
+                pInstance->configurationFingerprint = 0;
                 errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
             } else {
                 if (pInstance->pinPwrOn >= 0) {
@@ -1809,8 +1878,9 @@ int32_t uCellPwrOffHard(int32_t cellHandle, bool trulyHard,
                                      (int32_t) !U_CELL_ENABLE_POWER_PIN_ON_STATE);
                     }
                     // Remove any security context as these disappear
-                    // at power off
+                    // at power off, as does the module configuration
                     uCellPrivateC2cRemoveContext(pInstance);
+                    pInstance->configurationFingerprint = 0;
                     errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
             }
@@ -1868,8 +1938,10 @@ int32_t uCellPwrReboot(int32_t cellHandle,
                    (U_CELL_PRIVATE_AT_CFUN_FLIP_DELAY_SECONDS * 1000)) {
                 uPortTaskBlock(1000);
             }
-            // Sleep is no longer available
+            // Sleep is no longer available and the module
+            // will lose its configuration
             pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
+            pInstance->configurationFingerprint = 0;
             uAtClientLock(atHandle);
             uAtClientTimeoutSet(atHandle,
                                 U_CELL_PRIVATE_AT_CFUN_OFF_RESPONSE_TIME_SECONDS * 1000);
@@ -1986,8 +2058,10 @@ int32_t uCellPwrResetHard(int32_t cellHandle, int32_t pinReset)
             uPortLog("U_CELL_PWR: performing hard reset, this will take"
                      " at least %d milliseconds...\n", resetHoldMilliseconds +
                      (pInstance->pModule->rebootCommandWaitSeconds * 1000));
-            // Sleep is no longer available
+            // Sleep is no longer available and the module
+            // will lose its configuration
             pInstance->deepSleepState = U_CELL_PRIVATE_DEEP_SLEEP_STATE_UNAVAILABLE;
+            pInstance->configurationFingerprint = 0;
             // Set the RESET pin to the "reset" state
             platformError = uPortGpioSet(pinReset,
                                          (int32_t) U_CELL_RESET_PIN_TOGGLE_TO_STATE);
@@ -2116,6 +2190,30 @@ int32_t uCellPwrGetDtrPowerSavingPin(int32_t cellHandle)
     return errorCodeOrPin;
 }
 
+// Get the fingerprint of the module configuration.
+int32_t uCellPwrGetConfigurationFingerprint(int32_t cellHandle,
+                                            uint32_t *pFingerprint)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uCellPrivateInstance_t *pInstance;
+
+    if (gUCellPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUCellPrivateMutex);
+
+        pInstance = pUCellPrivateGetInstance(cellHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pInstance != NULL) && (pFingerprint != NULL)) {
+            *pFingerprint = pInstance->configurationFingerprint;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUCellPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // Set the requested 3GPP power saving parameters.
 int32_t  uCellPwrSetRequested3gppPowerSaving(int32_t cellHandle,
                                              uCellNetRat_t rat,
@@ -28,7 +28,7 @@
 # include "u_cfg_override.h" // For a customer's configuration override
 #endif
 
-#include "stdlib.h"    // malloc()/free()
+#include "stdlib.h"    // malloc()/free(), strtol()
 #include "stdio.h"     // snprintf()
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
@@ -36,10 +36,12 @@
 #include "string.h"    // memcpy(), memcmp(), strlen()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"  // For U_AT_CLIENT_URC_TASK_PRIORITY
 
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_uart.h"
 
 #include "u_at_client.h"
 
@@ -49,6 +51,7 @@
 #include "u_sock.h"
 
 #include "u_cell_module_type.h"
+#include "u_cell_mux_stream.h"
 #include "u_cell_net.h"
 #include "u_cell_private.h"
 #include "u_cell_sock.h"
@@ -112,7 +115,16 @@ typedef struct {
     int32_t sockHandleModule; /**< The handle that the cellular module
                                    uses for the socket instance.
                                    -1 if this socket is not in use. */
+    uSockProtocol_t protocol; /**< TCP or UDP. */
     volatile int32_t pendingBytes;
+    char *pReadCache; /**< Read-ahead cache for uCellSockRead(),
+                           NULL if there is none. */
+    size_t readCacheSizeBytes; /**< The size of pReadCache. */
+    size_t readCacheIndex; /**< Where to read from next in pReadCache. */
+    volatile size_t readCacheLength; /**< Bytes waiting in pReadCache. */
+    uPortMutexHandle_t readCacheMutex; /**< Protects the read-ahead
+                                            cache, NULL if there has
+                                            never been one. */
     void (*pAsyncClosedCallback) (int32_t, int32_t); /**< Set to NULL
                                                           if socket is
                                                           not in use. */
@@ -122,6 +134,19 @@ typedef struct {
     void (*pClosedCallback) (int32_t, int32_t); /**< Set to NULL
                                                      if socket is
                                                      not in use. */
+    int32_t directLinkStreamHandle; /**< The stream that the socket
+                                         has in direct link mode, -1
+                                         if it is not in direct link
+                                         mode. */
+    uAtClientStream_t directLinkStreamType; /**< The type of
+                                                 directLinkStreamHandle. */
+    char *pDirectLinkBuffer; /**< Data that arrived along with the
+                                  "CONNECT" on entering direct link
+                                  mode, to be read before anything
+                                  from the stream, NULL if none. */
+    size_t directLinkBufferLength; /**< Bytes at pDirectLinkBuffer. */
+    size_t directLinkBufferIndex; /**< Where to read from next in
+                                       pDirectLinkBuffer. */
 } uCellSockSocket_t;
 
 /** Definition of a URC handler.
@@ -184,6 +209,24 @@ static uCellSockSocket_t *pFindBySockHandleModule(const uAtClientHandle_t atHand
     return pSock;
 }
 
+// Find the socket, if any, that is in direct link mode on
+// the given cellular instance.
+static uCellSockSocket_t *pFindDirectLink(int32_t cellHandle)
+{
+    uCellSockSocket_t *pSock = NULL;
+
+    for (size_t x = 0; (x < sizeof(gSockets) / sizeof(gSockets[0])) &&
+         (pSock == NULL); x++) {
+        if ((gSockets[x].sockHandle >= 0) &&
+            (gSockets[x].cellHandle == cellHandle) &&
+            (gSockets[x].directLinkStreamHandle >= 0)) {
+            pSock = &(gSockets[x]);
+        }
+    }
+
+    return pSock;
+}
+
 // Do AT+USOER, for debug purposes.
 static void doUsoer(uAtClientHandle_t atHandle)
 {
@@ -217,14 +260,76 @@ static uCellSockSocket_t *pSockCreate(int32_t sockHandle,
         pSock->atHandle = atHandle;
         pSock->sockHandleModule = -1;
         pSock->pendingBytes = 0;
+        pSock->pReadCache = NULL;
+        pSock->readCacheSizeBytes = 0;
+        pSock->readCacheIndex = 0;
+        pSock->readCacheLength = 0;
+        pSock->readCacheMutex = NULL;
         pSock->pAsyncClosedCallback = NULL;
         pSock->pDataCallback = NULL;
         pSock->pClosedCallback = NULL;
+        pSock->directLinkStreamHandle = -1;
+        pSock->pDirectLinkBuffer = NULL;
+        pSock->directLinkBufferLength = 0;
+        pSock->directLinkBufferIndex = 0;
     }
 
     return pSock;
 }
 
+// Callback, run from the AT client callback queue, to delete the
+// mutex of a read-ahead cache that has been freed; being queued,
+// this runs after any readCacheFillCallback() that might still
+// be using the mutex.
+static void readCacheMutexDeleteCallback(const uAtClientHandle_t atHandle,
+                                         void *pParameter)
+{
+    (void) atHandle;
+
+    uPortMutexDelete((uPortMutexHandle_t) pParameter);
+}
+
+// Free the read-ahead cache of a socket, if it has one.
+static void readCacheFree(uCellSockSocket_t *pSock)
+{
+    uPortMutexHandle_t readCacheMutex = pSock->readCacheMutex;
+
+    if (readCacheMutex != NULL) {
+        // Wait for no-one to be using the cache, then detach the
+        // mutex so that readCacheFillCallback() knows the cache
+        // has gone
+        U_PORT_MUTEX_LOCK(readCacheMutex);
+        pSock->readCacheMutex = NULL;
+        free(pSock->pReadCache);
+        pSock->pReadCache = NULL;
+        U_PORT_MUTEX_UNLOCK(readCacheMutex);
+        // readCacheFillCallback() may already have picked up
+        // the mutex, so it can only be deleted from behind it
+        // in the AT client callback queue
+        if ((pSock->atHandle == NULL) ||
+            (uAtClientCallback(pSock->atHandle,
+                               readCacheMutexDeleteCallback,
+                               (void *) readCacheMutex) != 0)) {
+            uPortMutexDelete(readCacheMutex);
+        }
+    }
+    free(pSock->pReadCache);
+    pSock->pReadCache = NULL;
+    pSock->readCacheSizeBytes = 0;
+    pSock->readCacheIndex = 0;
+    pSock->readCacheLength = 0;
+}
+
+// Free the buffer of data that arrived on entering direct link
+// mode, if there is one.
+static void directLinkBufferFree(uCellSockSocket_t *pSock)
+{
+    free(pSock->pDirectLinkBuffer);
+    pSock->pDirectLinkBuffer = NULL;
+    pSock->directLinkBufferLength = 0;
+    pSock->directLinkBufferIndex = 0;
+}
+
 // Free an entry in the list.
 static void sockFree(int32_t sockHandle)
 {
@@ -235,6 +340,9 @@ static void sockFree(int32_t sockHandle)
         if (gSockets[x].sockHandle == sockHandle) {
             pSock = &(gSockets[x]);
             pSock->sockHandle = -1;
+            // Before atHandle is cleared, as that is needed
+            // to delete the read-ahead cache mutex
+            readCacheFree(pSock);
             pSock->cellHandle = -1;
             pSock->atHandle = NULL;
             pSock->sockHandleModule = -1;
@@ -242,6 +350,351 @@ static void sockFree(int32_t sockHandle)
             pSock->pAsyncClosedCallback = NULL;
             pSock->pDataCallback = NULL;
             pSock->pClosedCallback = NULL;
+            pSock->directLinkStreamHandle = -1;
+            directLinkBufferFree(pSock);
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SEGMENT SIZE AND DATA TRANSFER
+ * -------------------------------------------------------------- */
+
+// Ask the module for the largest length of data that a socket AT
+// command will handle, e.g. with "AT+USOWR=?", which returns
+// something like "+USOWR: (0-6),(0-1024)".  The answer is limited
+// to U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES, which is also returned
+// if the module has nothing useful to say.
+static int32_t segmentSizeQuery(uAtClientHandle_t atHandle,
+                                const char *pCommand,
+                                const char *pPrefix)
+{
+    int32_t sizeBytes = -1;
+    char buffer[16];
+    const char *pMax;
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, pCommand);
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, pPrefix);
+    // Skip the socket ID range
+    uAtClientSkipParameters(atHandle, 1);
+    // Read the length range
+    if (uAtClientReadString(atHandle, buffer, sizeof(buffer), false) > 0) {
+        pMax = strchr(buffer, '-');
+        if (pMax != NULL) {
+            sizeBytes = strtol(pMax + 1, NULL, 10);
+        }
+    }
+    uAtClientResponseStop(atHandle);
+    if ((uAtClientUnlock(atHandle) != 0) || (sizeBytes <= 0) ||
+        (sizeBytes > U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES)) {
+        sizeBytes = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    }
+
+    return sizeBytes;
+}
+
+// Get the maximum amount of data that can be written to or read
+// from the module in one go, asking the module the first time.
+static int32_t segmentSizeGet(uCellPrivateInstance_t *pInstance,
+                              bool readNotWrite)
+{
+    int32_t sizeBytes;
+
+    if (readNotWrite) {
+        if (pInstance->socketsReadSegmentSizeBytes <= 0) {
+            pInstance->socketsReadSegmentSizeBytes = segmentSizeQuery(pInstance->atHandle,
+                                                                      "AT+USORD=?",
+                                                                      "+USORD:");
+        }
+        sizeBytes = pInstance->socketsReadSegmentSizeBytes;
+    } else {
+        if (pInstance->socketsWriteSegmentSizeBytes <= 0) {
+            pInstance->socketsWriteSegmentSizeBytes = segmentSizeQuery(pInstance->atHandle,
+                                                                       "AT+USOWR=?",
+                                                                       "+USOWR:");
+        }
+        sizeBytes = pInstance->socketsWriteSegmentSizeBytes;
+    }
+    if (pInstance->socketsHexMode) {
+        sizeBytes /= 2;
+    }
+
+    return sizeBytes;
+}
+
+// Write sizeBytes of data as a quoted hex string parameter of
+// the AT command currently being sent, converting it to hex
+// a chunk at a time rather than all in one buffer.
+static void writeHex(uAtClientHandle_t atHandle,
+                     const char *pData, size_t sizeBytes)
+{
+    char buffer[(U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES * 2) + 1]; // +1 for terminator
+    size_t x;
+
+    uAtClientWritePartialString(atHandle, true, "\"");
+    while (sizeBytes > 0) {
+        x = sizeBytes;
+        if (x > U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES) {
+            x = U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES;
+        }
+        buffer[uBinToHex(pData, x, buffer)] = 0;
+        uAtClientWritePartialString(atHandle, false, buffer);
+        pData += x;
+        sizeBytes -= x;
+    }
+    uAtClientWritePartialString(atHandle, false, "\"");
+}
+
+// Read the quoted data of a +USORD/+USORF response, which the
+// module has said is sizeBytes long, straight from the AT
+// interface: in binary mode directly into pBuffer, in hex mode
+// a chunk at a time through a small buffer.  Up to wantedSize
+// bytes are stored at pBuffer, the rest are thrown away.
+static void readData(uAtClientHandle_t atHandle, bool hexMode,
+                     char *pBuffer, int32_t sizeBytes,
+                     int32_t wantedSize)
+{
+    char buffer[U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES * 2];
+    int32_t x;
+    int32_t y;
+
+    if (wantedSize > sizeBytes) {
+        wantedSize = sizeBytes;
+    }
+    // Don't stop for anything!
+    uAtClientIgnoreStopTag(atHandle);
+    // Get the leading quote mark out of the way
+    uAtClientReadBytes(atHandle, NULL, 1, true);
+    if (hexMode) {
+        while (sizeBytes > 0) {
+            x = sizeBytes;
+            if (x > U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES) {
+                x = U_CELL_SOCK_HEX_CHUNK_SIZE_BYTES;
+            }
+            uAtClientReadBytes(atHandle, buffer, x * 2, true);
+            y = x;
+            if (y > wantedSize) {
+                y = wantedSize;
+            }
+            if (y > 0) {
+                uHexToBin(buffer, y * 2, pBuffer);
+                pBuffer += y;
+                wantedSize -= y;
+            }
+            sizeBytes -= x;
+        }
+    } else {
+        // Read out the bit we want...
+        uAtClientReadBytes(atHandle, pBuffer, wantedSize, true);
+        if (sizeBytes > wantedSize) {
+            //...and then the rest poured away to NULL
+            uAtClientReadBytes(atHandle, NULL, sizeBytes - wantedSize, true);
+        }
+    }
+    // Make sure we wait for the stop tag before
+    // going around again
+    uAtClientRestoreStopTag(atHandle);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: READING AND THE READ-AHEAD CACHE
+ * -------------------------------------------------------------- */
+
+// Do a single AT+USORD for up to wantedSize bytes into pBuffer,
+// updating pendingBytes.  Returns the number of bytes read
+// or negated value of U_SOCK_Exxx.
+static int32_t readSegment(const uCellPrivateInstance_t *pInstance,
+                           uCellSockSocket_t *pSocket,
+                           char *pBuffer, int32_t wantedSize)
+{
+    int32_t negErrnoLocalOrSize = -U_SOCK_EIO;
+    uAtClientHandle_t atHandle = uCellPrivateGetAtHandleData(pInstance);
+    int32_t actualSize;
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+USORD=");
+    uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+    // Number of bytes to read
+    uAtClientWriteInt(atHandle, wantedSize);
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, "+USORD:");
+    // Skip the socket ID
+    uAtClientSkipParameters(atHandle, 1);
+    // Read the amount of data
+    actualSize = uAtClientReadInt(atHandle);
+    if (actualSize > wantedSize) {
+        actualSize = wantedSize;
+    }
+    if (actualSize > 0) {
+        // Read the data straight into the buffer
+        readData(atHandle, pInstance->socketsHexMode,
+                 pBuffer, actualSize, actualSize);
+    }
+    uAtClientResponseStop(atHandle);
+    // BEFORE unlocking, work out what's happened.
+    // This is to prevent a URC being processed that
+    // may indicate data left and over-write pendingBytes
+    // while we're also writing to it.
+    if ((uAtClientErrorGet(atHandle) == 0) && (actualSize >= 0)) {
+        // Must use what +USORD returns here as it may be less
+        // or more than we asked for and also may be
+        // more than pendingBytes, depending on how
+        // the URCs landed
+        // This update of pendingBytes will be overwritten
+        // by the URC but we have to do something here
+        // 'cos we don't get a URC to tell us when pendingBytes
+        // has gone to zero.
+        if ((actualSize == 0) || (actualSize > pSocket->pendingBytes)) {
+            pSocket->pendingBytes = 0;
+        } else {
+            pSocket->pendingBytes -= actualSize;
+        }
+        negErrnoLocalOrSize = actualSize;
+    }
+    uAtClientUnlock(atHandle);
+
+    return negErrnoLocalOrSize;
+}
+
+// Copy up to dataSizeBytes out of the read-ahead cache.
+// This does NOT lock the read cache mutex, you need to do that.
+static size_t readCacheRead(uCellSockSocket_t *pSocket,
+                            char *pData, size_t dataSizeBytes)
+{
+    size_t length = pSocket->readCacheLength;
+
+    if (length > dataSizeBytes) {
+        length = dataSizeBytes;
+    }
+    if (length > 0) {
+        memcpy(pData, pSocket->pReadCache + pSocket->readCacheIndex, length);
+        pSocket->readCacheIndex += length;
+        pSocket->readCacheLength -= length;
+    }
+
+    return length;
+}
+
+// If the read-ahead cache is empty and there is data
+// waiting in the module, read as much as will fit.
+// Returns the number of bytes read or negated value
+// of U_SOCK_Exxx.
+// This does NOT lock the read cache mutex, you need to do that.
+static int32_t readCacheFill(uCellPrivateInstance_t *pInstance,
+                             uCellSockSocket_t *pSocket)
+{
+    int32_t negErrnoLocalOrSize = 0;
+    int32_t wantedSize = (int32_t) pSocket->readCacheSizeBytes;
+    int32_t dataLengthMax = segmentSizeGet(pInstance, true);
+
+    if (wantedSize > dataLengthMax) {
+        wantedSize = dataLengthMax;
+    }
+    if ((pSocket->pReadCache != NULL) &&
+        (pSocket->readCacheLength == 0) &&
+        (pSocket->pendingBytes > 0)) {
+        negErrnoLocalOrSize = readSegment(pInstance, pSocket,
+                                          pSocket->pReadCache,
+                                          wantedSize);
+        pSocket->readCacheIndex = 0;
+        if (negErrnoLocalOrSize > 0) {
+            pSocket->readCacheLength = negErrnoLocalOrSize;
+        }
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Set the size of the read-ahead cache of a socket, zero
+// to remove it.  Returns zero on success else U_SOCK_Exxx
+// (NOT negated).
+static int32_t readCacheSet(uCellSockSocket_t *pSocket, size_t sizeBytes)
+{
+    int32_t errnoLocal = U_SOCK_EOPNOTSUPP;
+    char *pReadCache = NULL;
+
+    if (sizeBytes > U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES) {
+        sizeBytes = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    }
+    // Only TCP: UDP datagrams can't be read in pieces
+    if (pSocket->protocol == U_SOCK_PROTOCOL_TCP) {
+        errnoLocal = U_SOCK_ENOMEM;
+        if (pSocket->readCacheMutex == NULL) {
+            if ((sizeBytes == 0) ||
+                (uPortMutexCreate(&(pSocket->readCacheMutex)) != 0)) {
+                // Nothing to do or can't do it
+                pSocket->readCacheMutex = NULL;
+                if (sizeBytes == 0) {
+                    errnoLocal = U_SOCK_ENONE;
+                }
+            }
+        }
+        if (pSocket->readCacheMutex != NULL) {
+
+            U_PORT_MUTEX_LOCK(pSocket->readCacheMutex);
+
+            // Don't lose anything that is already in the cache
+            errnoLocal = U_SOCK_EBUSY;
+            if (pSocket->readCacheLength <= sizeBytes) {
+                errnoLocal = U_SOCK_ENOMEM;
+                if (sizeBytes > 0) {
+                    pReadCache = (char *) malloc(sizeBytes);
+                }
+                if ((sizeBytes == 0) || (pReadCache != NULL)) {
+                    if (pSocket->readCacheLength > 0) {
+                        memcpy(pReadCache,
+                               pSocket->pReadCache + pSocket->readCacheIndex,
+                               pSocket->readCacheLength);
+                    }
+                    free(pSocket->pReadCache);
+                    pSocket->pReadCache = pReadCache;
+                    pSocket->readCacheSizeBytes = sizeBytes;
+                    pSocket->readCacheIndex = 0;
+                    errnoLocal = U_SOCK_ENONE;
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(pSocket->readCacheMutex);
+        }
+    }
+
+    return errnoLocal;
+}
+
+// Callback, run from the AT client callback queue, to fill
+// the read-ahead cache when a +UUSORD URC has arrived.
+static void readCacheFillCallback(const uAtClientHandle_t atHandle,
+                                  void *pParameter)
+{
+    //lint -e(507) Suppress size incompatibility: the compiler
+    // we use for Lint checking is 64 bit so has 8 byte pointers
+    // and Lint doesn't like them being used to carry 4 byte integers
+    int32_t sockHandle = (int32_t) (intptr_t) pParameter;
+    uCellSockSocket_t *pSocket;
+    uCellPrivateInstance_t *pInstance;
+    uPortMutexHandle_t readCacheMutex;
+
+    (void) atHandle;
+
+    if (sockHandle >= 0) {
+        // Find the entry
+        pSocket = pFindBySockHandle(sockHandle);
+        if (pSocket != NULL) {
+            // The mutex is only ever deleted from this callback
+            // queue (see readCacheFree()) so, once we have it, it
+            // stays valid until we return; if it is no longer the
+            // socket's mutex once locked then the cache has gone
+            readCacheMutex = pSocket->readCacheMutex;
+            pInstance = pUCellPrivateGetInstance(pSocket->cellHandle);
+            if ((readCacheMutex != NULL) && (pInstance != NULL)) {
+                U_PORT_MUTEX_LOCK(readCacheMutex);
+                if (pSocket->readCacheMutex == readCacheMutex) {
+                    readCacheFill(pInstance, pSocket);
+                }
+                U_PORT_MUTEX_UNLOCK(readCacheMutex);
+            }
         }
     }
 }
@@ -257,7 +710,7 @@ static void dataCallback(const uAtClientHandle_t atHandle,
     //lint -e(507) Suppress size incompatibility: the compiler
     // we use for Lint checking is 64 bit so has 8 byte pointers
     // and Lint doesn't like them being used to carry 4 byte integers
-    int32_t sockHandle = (int32_t) pParameter;
+    int32_t sockHandle = (int32_t) (intptr_t) pParameter;
     uCellSockSocket_t *pSocket;
 
     (void) atHandle;
@@ -279,7 +732,7 @@ static void closedCallback(const uAtClientHandle_t atHandle,
     //lint -e(507) Suppress size incompatibility: the compiler
     // we use for Lint checking is 64 bit so has 8 byte pointers
     // and Lint doesn't like them being used to carry 4 byte integers
-    int32_t sockHandle = (int32_t) pParameter;
+    int32_t sockHandle = (int32_t) (intptr_t) pParameter;
     uCellSockSocket_t *pSocket;
 
     (void) atHandle;
@@ -327,14 +780,22 @@ static void UUSORD_UUSORF_urc(const uAtClientHandle_t atHandle,
         pSocket = pFindBySockHandleModule(atHandle,
                                           sockHandleModule);
         if (pSocket != NULL) {
-            // Call the user call-back via the trampoline
-            if ((dataSizeBytes > 0) &&
-                (pSocket->pDataCallback != NULL)) {
-                uAtClientCallback(atHandle,
-                                  dataCallback,
-                                  (void *) (pSocket->sockHandle));
-            }
             pSocket->pendingBytes = dataSizeBytes;
+            if (dataSizeBytes > 0) {
+                // If there's a read-ahead cache, fill it
+                // before the user is told there's data
+                if (pSocket->pReadCache != NULL) {
+                    uAtClientCallback(atHandle,
+                                      readCacheFillCallback,
+                                      (void *) (intptr_t) (pSocket->sockHandle));
+                }
+                // Call the user call-back via the trampoline
+                if (pSocket->pDataCallback != NULL) {
+                    uAtClientCallback(atHandle,
+                                      dataCallback,
+                                      (void *) (intptr_t) (pSocket->sockHandle));
+                }
+            }
         }
     }
 }
@@ -358,7 +819,7 @@ static void UUSOCL_urc(const uAtClientHandle_t atHandle,
             if (pSocket->pClosedCallback != NULL) {
                 uAtClientCallback(atHandle,
                                   closedCallback,
-                                  (void *) (pSocket->sockHandle));
+                                  (void *) (intptr_t) (pSocket->sockHandle));
             }
         }
     }
@@ -601,6 +1062,266 @@ int32_t setHexMode(int32_t cellHandle, bool hexModeOnNotOff)
     return -errnoLocal;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: DIRECT LINK
+ * -------------------------------------------------------------- */
+
+// Callback for data arriving on the stream of a socket in direct
+// link mode, where there is no +UUSORD URC to say so.
+static void directLinkCallback(int32_t streamHandle,
+                               uint32_t eventBitmask,
+                               void *pParameter)
+{
+    const uCellSockSocket_t *pSocket = (const uCellSockSocket_t *) pParameter;
+    void (*pDataCallback) (int32_t, int32_t) = pSocket->pDataCallback;
+
+    (void) streamHandle;
+
+    if (((eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) != 0) &&
+        (pDataCallback != NULL)) {
+        pDataCallback(pSocket->cellHandle, pSocket->sockHandle);
+    }
+}
+
+// Set the data callback on the stream of a socket in direct link
+// mode; if this fails reads still work, the user just isn't told
+// when there is something to read.
+static void directLinkCallbackSet(uCellSockSocket_t *pSocket)
+{
+    switch (pSocket->directLinkStreamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            uPortUartEventCallbackSet(pSocket->directLinkStreamHandle,
+                                      U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                      directLinkCallback, pSocket,
+                                      U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                      U_AT_CLIENT_URC_TASK_PRIORITY);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            uCellMuxStreamCallbackSet(pSocket->directLinkStreamHandle,
+                                      directLinkCallback, pSocket);
+            break;
+        default:
+            break;
+    }
+}
+
+// Remove the data callback from the stream of a socket in
+// direct link mode.
+static void directLinkCallbackRemove(const uCellSockSocket_t *pSocket)
+{
+    switch (pSocket->directLinkStreamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            uPortUartEventCallbackRemove(pSocket->directLinkStreamHandle);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            uCellMuxStreamCallbackRemove(pSocket->directLinkStreamHandle);
+            break;
+        default:
+            break;
+    }
+}
+
+// Send a data event to the stream of a socket in direct link
+// mode, so that directLinkCallback() is called.
+static void directLinkEventSend(const uCellSockSocket_t *pSocket)
+{
+    switch (pSocket->directLinkStreamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            uPortUartEventSend(pSocket->directLinkStreamHandle,
+                               U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            uCellMuxStreamEventSend(pSocket->directLinkStreamHandle,
+                                    U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+            break;
+        default:
+            break;
+    }
+}
+
+// Write to the stream of a socket in direct link mode, returning
+// the number of bytes written or negated errno.
+static int32_t directLinkWrite(const uCellSockSocket_t *pSocket,
+                               const char *pData, size_t dataSizeBytes)
+{
+    int32_t negErrnoLocalOrSize = -U_SOCK_EIO;
+
+    switch (pSocket->directLinkStreamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            negErrnoLocalOrSize = uPortUartWrite(pSocket->directLinkStreamHandle,
+                                                 pData, dataSizeBytes);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            negErrnoLocalOrSize = uCellMuxStreamWrite(pSocket->directLinkStreamHandle,
+                                                      pData, dataSizeBytes);
+            break;
+        default:
+            break;
+    }
+    if (negErrnoLocalOrSize < 0) {
+        negErrnoLocalOrSize = -U_SOCK_EIO;
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Read from a socket in direct link mode, first from whatever
+// arrived along with the "CONNECT" and then from the stream,
+// returning the number of bytes read or negated errno.
+static int32_t directLinkRead(uCellSockSocket_t *pSocket,
+                              char *pData, size_t dataSizeBytes)
+{
+    int32_t negErrnoLocalOrSize = 0;
+    size_t length = 0;
+
+    if (pSocket->pDirectLinkBuffer != NULL) {
+        length = pSocket->directLinkBufferLength - pSocket->directLinkBufferIndex;
+        if (length > dataSizeBytes) {
+            length = dataSizeBytes;
+        }
+        memcpy(pData, pSocket->pDirectLinkBuffer + pSocket->directLinkBufferIndex,
+               length);
+        pSocket->directLinkBufferIndex += length;
+        if (pSocket->directLinkBufferIndex >= pSocket->directLinkBufferLength) {
+            directLinkBufferFree(pSocket);
+        }
+        pData += length;
+        dataSizeBytes -= length;
+    }
+
+    if (dataSizeBytes > 0) {
+        switch (pSocket->directLinkStreamType) {
+            case U_AT_CLIENT_STREAM_TYPE_UART:
+                negErrnoLocalOrSize = uPortUartRead(pSocket->directLinkStreamHandle,
+                                                    pData, dataSizeBytes);
+                break;
+            case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                negErrnoLocalOrSize = uCellMuxStreamRead(pSocket->directLinkStreamHandle,
+                                                         pData, dataSizeBytes);
+                break;
+            default:
+                negErrnoLocalOrSize = -1;
+                break;
+        }
+    }
+    if (negErrnoLocalOrSize >= 0) {
+        negErrnoLocalOrSize += (int32_t) length;
+    } else if (length > 0) {
+        // Don't lose what came from the buffer
+        negErrnoLocalOrSize = (int32_t) length;
+    } else {
+        negErrnoLocalOrSize = -U_SOCK_EIO;
+    }
+
+    return negErrnoLocalOrSize;
+}
+
+// Put a socket into direct link mode, returning errno.
+static int32_t directLinkStart(const uCellPrivateInstance_t *pInstance,
+                               uCellSockSocket_t *pSocket)
+{
+    int32_t errnoLocal = U_SOCK_EOPNOTSUPP;
+    uAtClientHandle_t atHandle = pInstance->atHandle;
+    uAtClientStream_t streamType = U_AT_CLIENT_STREAM_TYPE_MAX;
+    int32_t streamHandle;
+    int32_t x;
+    char *pBuffer = NULL;
+
+    streamHandle = uAtClientStreamGet(atHandle, &streamType);
+    if ((pSocket->protocol == U_SOCK_PROTOCOL_TCP) &&
+        (pInstance->pSecurityC2cContext == NULL) &&
+        ((streamType == U_AT_CLIENT_STREAM_TYPE_UART) ||
+         (streamType == U_AT_CLIENT_STREAM_TYPE_CMUX))) {
+        errnoLocal = U_SOCK_EIO;
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT+USODL=");
+        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+        uAtClientCommandStop(atHandle);
+        // There is no "OK": the module says "CONNECT"
+        // and everything after that is socket data
+        uAtClientResponseStart(atHandle, "CONNECT");
+        uAtClientWaitCharacter(atHandle, '\n');
+        if (uAtClientErrorGet(atHandle) == 0) {
+            // Take the stream away from the AT client while it is
+            // still locked, so that the URC handler can't eat any
+            // socket data, along with whatever socket data the AT
+            // client has already read; the server may well have
+            // sent something straight away
+            x = uAtClientStreamDetachSize(atHandle);
+            if (x > 0) {
+                pBuffer = (char *) malloc(x);
+                if (pBuffer == NULL) {
+                    x = -1;
+                }
+            }
+            if (x >= 0) {
+                x = uAtClientStreamDetach(atHandle, pBuffer, x);
+            }
+            if (x >= 0) {
+                pSocket->directLinkStreamHandle = streamHandle;
+                pSocket->directLinkStreamType = streamType;
+                if (x > 0) {
+                    pSocket->pDirectLinkBuffer = pBuffer;
+                    pSocket->directLinkBufferLength = x;
+                    pSocket->directLinkBufferIndex = 0;
+                    pBuffer = NULL;
+                }
+                errnoLocal = U_SOCK_ENONE;
+            }
+        }
+        uAtClientUnlock(atHandle);
+        free(pBuffer);
+        if (errnoLocal == U_SOCK_ENONE) {
+            directLinkCallbackSet(pSocket);
+            if (pSocket->pDirectLinkBuffer != NULL) {
+                // There is data to read already: get the
+                // data callback called as it would be if the
+                // data had arrived on the stream
+                directLinkEventSend(pSocket);
+            }
+        }
+    }
+
+    return errnoLocal;
+}
+
+// Take a socket out of direct link mode and give the stream
+// back to the AT client, returning errno.
+static int32_t directLinkStop(uCellSockSocket_t *pSocket)
+{
+    int32_t errnoLocal = U_SOCK_EIO;
+    uAtClientHandle_t atHandle = pSocket->atHandle;
+
+    directLinkCallbackRemove(pSocket);
+    // The escape sequence only counts if there
+    // is silence either side of it
+    uPortTaskBlock(U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS);
+    directLinkWrite(pSocket, "+++", 3);
+    uPortTaskBlock(U_CELL_SOCK_DIRECT_LINK_GUARD_TIME_MS);
+    uAtClientStreamSet(atHandle, pSocket->directLinkStreamHandle,
+                       pSocket->directLinkStreamType);
+    pSocket->directLinkStreamHandle = -1;
+    directLinkBufferFree(pSocket);
+    // Throw away any unread socket data and whatever
+    // the module said on leaving direct link mode
+    uAtClientFlush(atHandle);
+    // Check that the module is back in command mode; if it
+    // had left direct link mode by itself, e.g. because the far
+    // end closed the connection, the "+++" will be in its command
+    // buffer and so the first attempt will fail
+    for (size_t x = 0; (x < U_CELL_SOCK_DIRECT_LINK_EXIT_RETRIES) &&
+         (errnoLocal != U_SOCK_ENONE); x++) {
+        uAtClientLock(atHandle);
+        uAtClientCommandStart(atHandle, "AT");
+        uAtClientCommandStopReadResponse(atHandle);
+        if (uAtClientUnlock(atHandle) == 0) {
+            errnoLocal = U_SOCK_ENONE;
+        }
+    }
+
+    return errnoLocal;
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: MISC
  * -------------------------------------------------------------- */
@@ -666,8 +1387,14 @@ int32_t uCellSockInit()
             pSock->sockHandle = -1;
             pSock->sockHandleModule = -1;
             pSock->pendingBytes = 0;
+            pSock->pReadCache = NULL;
+            pSock->readCacheSizeBytes = 0;
+            pSock->readCacheIndex = 0;
+            pSock->readCacheLength = 0;
+            pSock->readCacheMutex = NULL;
             pSock->pDataCallback = NULL;
             pSock->pClosedCallback = NULL;
+            pSock->directLinkStreamHandle = -1;
         }
 
         gInitialised = true;
@@ -707,8 +1434,17 @@ int32_t uCellSockInitInstance(int32_t cellHandle)
 void uCellSockDeinit()
 {
     if (gInitialised) {
-        // Nothing to do, URCs will have been
-        // removed on close
+        // URCs will have been removed on close,
+        // just need to give back the AT interface if
+        // a socket that was left open is in direct link
+        // mode and free any read-ahead caches
+        for (size_t x = 0; x < sizeof(gSockets) / sizeof(gSockets[0]); x++) {
+            if ((gSockets[x].sockHandle >= 0) &&
+                (gSockets[x].directLinkStreamHandle >= 0)) {
+                directLinkStop(&(gSockets[x]));
+            }
+            readCacheFree(&(gSockets[x]));
+        }
         gInitialised = false;
     }
 }
@@ -753,6 +1489,12 @@ int32_t uCellSockCreate(int32_t cellHandle,
             if (uAtClientUnlock(atHandle) == 0) {
                 // All good
                 negErrnoLocal = pSocket->sockHandle;
+                pSocket->protocol = protocol;
+                if (U_CELL_SOCK_READ_CACHE_SIZE_BYTES > 0) {
+                    // A read-ahead cache is just an optimisation,
+                    // carry on without one if it can't be had
+                    readCacheSet(pSocket, U_CELL_SOCK_READ_CACHE_SIZE_BYTES);
+                }
             } else {
                 // Free the socket again
                 sockFree(pSocket->sockHandle);
@@ -852,6 +1594,10 @@ int32_t uCellSockClose(int32_t cellHandle,
             pSocket = pFindBySockHandle(sockHandle);
             if (pSocket != NULL) {
                 errnoLocal = U_SOCK_EIO;
+                if (pSocket->directLinkStreamHandle >= 0) {
+                    // Need the AT interface back first
+                    directLinkStop(pSocket);
+                }
                 // Close the socket through the cellular module
                 // If have seen modules return ERROR to this
                 // immediately so try a few times
@@ -894,7 +1640,7 @@ int32_t uCellSockClose(int32_t cellHandle,
                         // doesn't support asynchronous closure,
                         // call the trampoline from here
                         uAtClientCallback(atHandle, closedCallback,
-                                          (void *) sockHandle);
+                                          (void *) (intptr_t) sockHandle);
                     }
                 } else {
                     // Got an AT interace error, see
@@ -981,6 +1727,16 @@ int32_t uCellSockOptionSet(int32_t cellHandle,
                                     errnoLocal = setOptionLinger(pSocket, pOptionValue,
                                                                  optionValueLength);
                                     break;
+                                // Handled locally: the size of
+                                // the read-ahead cache
+                                case U_SOCK_OPT_RCVBUF:
+                                    if ((pOptionValue != NULL) &&
+                                        (optionValueLength >= sizeof(int32_t)) &&
+                                        (*((const int32_t *) pOptionValue) >= 0)) {
+                                        errnoLocal = readCacheSet(pSocket,
+                                                                  (size_t) *((const int32_t *) pOptionValue));
+                                    }
+                                    break;
                                 default:
                                     break;
                             }
@@ -1011,6 +1767,40 @@ int32_t uCellSockOptionSet(int32_t cellHandle,
                                                               option, pOptionValue,
                                                               optionValueLength);
                                     break;
+                                // Handled locally: direct link mode
+                                // and its triggers, all of which
+                                // have an integer as a parameter
+                                case U_SOCK_OPT_TCP_DIRECT_LINK:
+                                    if ((pOptionValue != NULL) &&
+                                        (optionValueLength >= sizeof(int32_t))) {
+                                        if (*((const int32_t *) pOptionValue) != 0) {
+                                            errnoLocal = -uCellSockDirectLinkStart(cellHandle,
+                                                                                   sockHandle);
+                                        } else {
+                                            errnoLocal = -uCellSockDirectLinkStop(cellHandle,
+                                                                                  sockHandle);
+                                        }
+                                    }
+                                    break;
+                                case U_SOCK_OPT_TCP_DIRECT_LINK_TIMER:
+                                    if ((pOptionValue != NULL) &&
+                                        (optionValueLength >= sizeof(int32_t)) &&
+                                        (*((const int32_t *) pOptionValue) >= 0)) {
+                                        errnoLocal = -uCellSockDirectLinkTriggerSet(cellHandle,
+                                                                                    sockHandle,
+                                                                                    *((const int32_t *) pOptionValue),
+                                                                                    -1);
+                                    }
+                                    break;
+                                case U_SOCK_OPT_TCP_DIRECT_LINK_LENGTH:
+                                    if ((pOptionValue != NULL) &&
+                                        (optionValueLength >= sizeof(int32_t)) &&
+                                        (*((const int32_t *) pOptionValue) >= 0)) {
+                                        errnoLocal = -uCellSockDirectLinkTriggerSet(cellHandle,
+                                                                                    sockHandle, -1,
+                                                                                    *((const int32_t *) pOptionValue));
+                                    }
+                                    break;
                                 default:
                                     break;
                             }
@@ -1067,6 +1857,19 @@ int32_t uCellSockOptionGet(int32_t cellHandle,
                                     errnoLocal = getOptionLinger(pSocket, pOptionValue,
                                                                  pOptionValueLength);
                                     break;
+                                // Handled locally: the size of
+                                // the read-ahead cache
+                                case U_SOCK_OPT_RCVBUF:
+                                    if ((pOptionValueLength != NULL) &&
+                                        ((pOptionValue == NULL) ||
+                                         (*pOptionValueLength >= sizeof(int32_t)))) {
+                                        errnoLocal = U_SOCK_ENONE;
+                                        if (pOptionValue != NULL) {
+                                            *((int32_t *) pOptionValue) = (int32_t) pSocket->readCacheSizeBytes;
+                                        }
+                                        *pOptionValueLength = sizeof(int32_t);
+                                    }
+                                    break;
                                 default:
                                     break;
                             }
@@ -1097,6 +1900,19 @@ int32_t uCellSockOptionGet(int32_t cellHandle,
                                                               option, pOptionValue,
                                                               pOptionValueLength);
                                     break;
+                                // Handled locally: whether the socket
+                                // is in direct link mode
+                                case U_SOCK_OPT_TCP_DIRECT_LINK:
+                                    if ((pOptionValueLength != NULL) &&
+                                        ((pOptionValue == NULL) ||
+                                         (*pOptionValueLength >= sizeof(int32_t)))) {
+                                        errnoLocal = U_SOCK_ENONE;
+                                        if (pOptionValue != NULL) {
+                                            *((int32_t *) pOptionValue) = (int32_t) (pSocket->directLinkStreamHandle >= 0);
+                                        }
+                                        *pOptionValueLength = sizeof(int32_t);
+                                    }
+                                    break;
                                 default:
                                     break;
                             }
@@ -1199,19 +2015,14 @@ int32_t uCellSockSendTo(int32_t cellHandle,
     uCellSockSocket_t *pSocket;
     char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
     char *pRemoteIpAddress;
-    size_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    size_t dataLengthMax;
     int32_t sentSize = 0;
-    size_t x;
     bool written = false;
-    char *pHexBuffer = NULL;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
     if (pInstance != NULL) {
-        atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            dataLengthMax /= 2;
-        }
+        atHandle = uCellPrivateGetAtHandleData(pInstance);
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
@@ -1222,63 +2033,52 @@ int32_t uCellSockSendTo(int32_t cellHandle,
                     pRemoteIpAddress = pUSockDomainRemovePort(buffer);
                     if (pRemoteIpAddress != NULL) {
                         negErrnoLocalOrSize = -U_SOCK_EMSGSIZE;
+                        dataLengthMax = (size_t) segmentSizeGet(pInstance, false);
                         if (dataSizeBytes <= dataLengthMax) {
+                            negErrnoLocalOrSize = -U_SOCK_EIO;
+                            uAtClientLock(atHandle);
+                            uAtClientCommandStart(atHandle, "AT+USOST=");
+                            // Write module socket handle
+                            uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                            // Write IP address
+                            uAtClientWriteString(atHandle, pRemoteIpAddress, true);
+                            // Write port number
+                            uAtClientWriteInt(atHandle, pRemoteAddress->port);
+                            // Number of bytes to follow
+                            uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
                             if (pInstance->socketsHexMode) {
-                                negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                                pHexBuffer = (char *) malloc(dataSizeBytes * 2 + 1);  // +1 for terminator
-                                if (pHexBuffer != NULL) {
-                                    // Make the hex-coded null terminated string
-                                    x = uBinToHex((const char *) pData, dataSizeBytes, pHexBuffer);
-                                    *(pHexBuffer + x) = 0;
-                                }
-                            }
-                            if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                                negErrnoLocalOrSize = -U_SOCK_EIO;
-                                uAtClientLock(atHandle);
-                                uAtClientCommandStart(atHandle, "AT+USOST=");
-                                // Write module socket handle
-                                uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                                // Write IP address
-                                uAtClientWriteString(atHandle, pRemoteIpAddress, true);
-                                // Write port number
-                                uAtClientWriteInt(atHandle, pRemoteAddress->port);
-                                // Number of bytes to follow
-                                uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
-                                if (pHexBuffer) {
-                                    // Send the hex mode data as a string
-                                    uAtClientWriteString(atHandle, pHexBuffer, true);
-                                    uAtClientCommandStop(atHandle);
-                                    // Free the buffer
-                                    free(pHexBuffer);
+                                // Send the data as a hex string
+                                writeHex(atHandle, (const char *) pData, dataSizeBytes);
+                                uAtClientCommandStop(atHandle);
+                                written = true;
+                            } else {
+                                // Not in hex mode, wait for the prompt
+                                uAtClientCommandStop(atHandle);
+                                if (uAtClientWaitCharacter(atHandle, '@') == 0) {
+                                    // Wait for it...
+                                    uPortTaskBlock(50);
+                                    // Send the binary data straight from
+                                    // the caller's buffer
+                                    uAtClientWriteBytes(atHandle, (const char *) pData,
+                                                        dataSizeBytes, true);
                                     written = true;
-                                } else {
-                                    // Not in hex mode, wait for the prompt
-                                    uAtClientCommandStop(atHandle);
-                                    if (uAtClientWaitCharacter(atHandle, '@') == 0) {
-                                        // Wait for it...
-                                        uPortTaskBlock(50);
-                                        // Send the binary data
-                                        uAtClientWriteBytes(atHandle, (const char *) pData,
-                                                            dataSizeBytes, true);
-                                        written = true;
-                                    }
                                 }
-                                if (written) {
-                                    // Grab the response
-                                    uAtClientResponseStart(atHandle, "+USOST:");
-                                    // Skip the socket ID
-                                    uAtClientSkipParameters(atHandle, 1);
-                                    // Bytes sent
-                                    sentSize = uAtClientReadInt(atHandle);
-                                    uAtClientResponseStop(atHandle);
-                                    if ((uAtClientUnlock(atHandle) == 0) &&
-                                        (sentSize >= 0)) {
-                                        // All is good, probably
-                                        negErrnoLocalOrSize = sentSize;
-                                    }
-                                } else {
-                                    uAtClientUnlock(atHandle);
+                            }
+                            if (written) {
+                                // Grab the response
+                                uAtClientResponseStart(atHandle, "+USOST:");
+                                // Skip the socket ID
+                                uAtClientSkipParameters(atHandle, 1);
+                                // Bytes sent
+                                sentSize = uAtClientReadInt(atHandle);
+                                uAtClientResponseStop(atHandle);
+                                if ((uAtClientUnlock(atHandle) == 0) &&
+                                    (sentSize >= 0)) {
+                                    // All is good, probably
+                                    negErrnoLocalOrSize = sentSize;
                                 }
+                            } else {
+                                uAtClientUnlock(atHandle);
                             }
                         }
                     }
@@ -1300,13 +2100,11 @@ int32_t uCellSockReceiveFrom(int32_t cellHandle,
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
-    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    int32_t dataLengthMax;
     char buffer[U_SOCK_ADDRESS_STRING_MAX_LENGTH_BYTES];
     int32_t x;
     int32_t port = -1;
     int32_t receivedSize = -1;
-    int32_t readLength;
-    char *pHexBuffer = NULL;
 
     buffer[0] = 0;  // In case of slip-ups
 
@@ -1323,14 +2121,12 @@ int32_t uCellSockReceiveFrom(int32_t cellHandle,
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
     if (pInstance != NULL) {
-        atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            dataLengthMax /= 2;
-        }
+        atHandle = uCellPrivateGetAtHandleData(pInstance);
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
             if (pSocket != NULL) {
+                dataLengthMax = segmentSizeGet(pInstance, true);
                 negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
                 if (pSocket->pendingBytes == 0) {
                     // If the URC has not filled in pendingBytes,
@@ -1394,48 +2190,11 @@ int32_t uCellSockReceiveFrom(int32_t cellHandle,
                         dataSizeBytes = receivedSize;
                     }
                     if (receivedSize > 0) {
-                        if (pInstance->socketsHexMode) {
-                            // In hex mode we need a buffer to dump
-                            // the hex into and then we can decode it
-                            negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                            //lint -e{647} Suppress suspicious truncation
-                            pHexBuffer = (char *) malloc(receivedSize * 2 + 1);  // +1 for terminator
-                        }
-                        if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                            if (pHexBuffer != NULL) {
-                                // In hex mode we can read in the whole string
-                                //lint -e{647} Suppress suspicious truncation
-                                readLength = uAtClientReadString(atHandle, pHexBuffer,
-                                                                 receivedSize * 2 + 1, false);
-                                if (readLength > 0) {
-                                    x = (int32_t) dataSizeBytes * 2;
-                                    if (readLength > x) {
-                                        readLength = x;
-                                    }
-                                    uHexToBin(pHexBuffer, readLength, (char *) pData);
-                                }
-                                // Free memory
-                                free(pHexBuffer);
-                            } else {
-                                // Binary mode, don't stop for anything!
-                                uAtClientIgnoreStopTag(atHandle);
-                                // Get the leading quote mark out of the way
-                                uAtClientReadBytes(atHandle, NULL, 1, true);
-                                // Now read out all the actual data,
-                                // first the bit we want
-                                uAtClientReadBytes(atHandle, (char *) pData,
-                                                   dataSizeBytes, true);
-                                if (receivedSize > (int32_t) dataSizeBytes) {
-                                    //...and then the rest poured away to NULL
-                                    uAtClientReadBytes(atHandle, NULL,
-                                                       receivedSize -
-                                                       dataSizeBytes, true);
-                                }
-                                // Make sure to wait for the stop tag before
-                                // we finish
-                                uAtClientRestoreStopTag(atHandle);
-                            }
-                        }
+                        // Read the data straight into the user's
+                        // buffer, throwing away what won't fit
+                        readData(atHandle, pInstance->socketsHexMode,
+                                 (char *) pData, receivedSize,
+                                 (int32_t) dataSizeBytes);
                     }
                     uAtClientResponseStop(atHandle);
                     // BEFORE unlocking, work out what's happened.
@@ -1495,102 +2254,100 @@ int32_t uCellSockWrite(int32_t cellHandle,
     int32_t leftToSendSize = (int32_t) dataSizeBytes;
     int32_t sentSize = 0;
     int32_t dataOffset = 0;
-    int32_t thisSendSize = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    int32_t thisSendSize;
     size_t x = 0;
     bool written = true;
-    char *pHexBuffer = NULL;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
     if (pInstance != NULL) {
-        atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            thisSendSize /= 2;
-            negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-            pHexBuffer = (char *) malloc(dataSizeBytes * 2 + 1);  // +1 for terminator
-            if (pHexBuffer != NULL) {
-                // Make the hex-coded null terminated string
-                x = uBinToHex((const char *) pData, dataSizeBytes, pHexBuffer);
-                *(pHexBuffer + x) = 0;
-            }
-        }
+        atHandle = uCellPrivateGetAtHandleData(pInstance);
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
-            if (pSocket != NULL) {
-                if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
+            if ((pSocket != NULL) && (pSocket->directLinkStreamHandle >= 0)) {
+                // In direct link mode the data goes
+                // straight to the stream
+                negErrnoLocalOrSize = directLinkWrite(pSocket,
+                                                      (const char *) pData,
+                                                      dataSizeBytes);
+                if (negErrnoLocalOrSize >= 0) {
+                    leftToSendSize -= negErrnoLocalOrSize;
                     negErrnoLocalOrSize = U_SOCK_ENONE;
-                    x = 0;
-                    while ((leftToSendSize > 0) &&
-                           (negErrnoLocalOrSize == U_SOCK_ENONE) &&
-                           (x < U_CELL_SOCK_TCP_RETRY_LIMIT) &&
-                           written) {
-                        if (leftToSendSize < thisSendSize) {
-                            thisSendSize = leftToSendSize;
-                        }
-                        uAtClientLock(atHandle);
-                        uAtClientCommandStart(atHandle, "AT+USOWR=");
-                        // Write module socket handle
-                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                        // Number of bytes to follow
-                        uAtClientWriteInt(atHandle, (int32_t) dataSizeBytes);
-                        written = false;
-                        if (pHexBuffer) {
-                            // Send the hex mode data as a string
-                            //lint -e(679) Suppress suspicious truncation
-                            uAtClientWriteString(atHandle,
-                                                 pHexBuffer + (dataOffset * 2), true);
-                            uAtClientCommandStop(atHandle);
+                }
+            } else if ((pSocket != NULL) && (pFindDirectLink(cellHandle) != NULL)) {
+                // Another socket has the AT interface
+                negErrnoLocalOrSize = -U_SOCK_EBUSY;
+            } else if (pSocket != NULL) {
+                thisSendSize = segmentSizeGet(pInstance, false);
+                negErrnoLocalOrSize = U_SOCK_ENONE;
+                x = 0;
+                while ((leftToSendSize > 0) &&
+                       (negErrnoLocalOrSize == U_SOCK_ENONE) &&
+                       (x < U_CELL_SOCK_TCP_RETRY_LIMIT) &&
+                       written) {
+                    if (leftToSendSize < thisSendSize) {
+                        thisSendSize = leftToSendSize;
+                    }
+                    uAtClientLock(atHandle);
+                    uAtClientCommandStart(atHandle, "AT+USOWR=");
+                    // Write module socket handle
+                    uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                    // Number of bytes to follow
+                    uAtClientWriteInt(atHandle, thisSendSize);
+                    written = false;
+                    if (pInstance->socketsHexMode) {
+                        // Send the hex mode data as a string
+                        writeHex(atHandle, (const char *) pData + dataOffset,
+                                 thisSendSize);
+                        uAtClientCommandStop(atHandle);
+                        written = true;
+                    } else {
+                        uAtClientCommandStop(atHandle);
+                        // Wait for the prompt
+                        if (uAtClientWaitCharacter(atHandle, '@') == 0) {
+                            // Wait for it...
+                            uPortTaskBlock(50);
+                            // Go!
+                            uAtClientWriteBytes(atHandle,
+                                                (const char *) pData + dataOffset,
+                                                thisSendSize, true);
                             written = true;
-                        } else {
-                            uAtClientCommandStop(atHandle);
-                            // Wait for the prompt
-                            if (uAtClientWaitCharacter(atHandle, '@') == 0) {
-                                // Wait for it...
-                                uPortTaskBlock(50);
-                                // Go!
-                                uAtClientWriteBytes(atHandle,
-                                                    (const char *) pData + dataOffset,
-                                                    dataSizeBytes, true);
-                                written = true;
-                            }
                         }
-                        if (written) {
-                            // Grab the response
-                            uAtClientResponseStart(atHandle, "+USOWR:");
-                            // Skip the socket ID
-                            uAtClientSkipParameters(atHandle, 1);
-                            // Bytes sent
-                            sentSize = uAtClientReadInt(atHandle);
-                            uAtClientResponseStop(atHandle);
-                            if (uAtClientUnlock(atHandle) == 0) {
-                                dataOffset += sentSize;
-                                leftToSendSize -= sentSize;
-                                // Technically, it should be OK to
-                                // send fewer bytes than asked for,
-                                // however if this happens a lot we'll
-                                // get stuck, which isn't desirable,
-                                // so use the loop counter to avoid that
-                                if (sentSize < thisSendSize) {
-                                    x++;
-                                }
-                            } else {
-                                negErrnoLocalOrSize = -U_SOCK_EIO;
-                                // Got an AT interface error, see
-                                // what the module's socket error
-                                // number has to say for debug purposes
-                                doUsoer(atHandle);
+                    }
+                    if (written) {
+                        // Grab the response
+                        uAtClientResponseStart(atHandle, "+USOWR:");
+                        // Skip the socket ID
+                        uAtClientSkipParameters(atHandle, 1);
+                        // Bytes sent
+                        sentSize = uAtClientReadInt(atHandle);
+                        uAtClientResponseStop(atHandle);
+                        if (uAtClientUnlock(atHandle) == 0) {
+                            dataOffset += sentSize;
+                            leftToSendSize -= sentSize;
+                            // Technically, it should be OK to
+                            // send fewer bytes than asked for,
+                            // however if this happens a lot we'll
+                            // get stuck, which isn't desirable,
+                            // so use the loop counter to avoid that
+                            if (sentSize < thisSendSize) {
+                                x++;
                             }
                         } else {
                             negErrnoLocalOrSize = -U_SOCK_EIO;
-                            uAtClientUnlock(atHandle);
+                            // Got an AT interface error, see
+                            // what the module's socket error
+                            // number has to say for debug purposes
+                            doUsoer(atHandle);
                         }
+                    } else {
+                        negErrnoLocalOrSize = -U_SOCK_EIO;
+                        uAtClientUnlock(atHandle);
                     }
                 }
             }
         }
-        // Free the buffer
-        free(pHexBuffer);
     }
 
     if (negErrnoLocalOrSize == U_SOCK_ENONE) {
@@ -1610,27 +2367,53 @@ int32_t uCellSockRead(int32_t cellHandle,
     uCellPrivateInstance_t *pInstance;
     uAtClientHandle_t atHandle;
     uCellSockSocket_t *pSocket;
-    int32_t dataLengthMax = U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES;
+    uPortMutexHandle_t readCacheMutex;
+    int32_t dataLengthMax;
     int32_t x = -1;
     int32_t thisWantedReceiveSize;
-    int32_t thisActualReceiveSize;
     int32_t totalReceivedSize = 0;
-    int32_t readLength;
-    char *pHexBuffer = NULL;
+    bool atAvailable;
 
     // Find the instance
     pInstance = pUCellPrivateGetInstance(cellHandle);
     if (pInstance != NULL) {
-        atHandle = pInstance->atHandle;
-        if (pInstance->socketsHexMode) {
-            dataLengthMax /= 2;
-        }
+        atHandle = uCellPrivateGetAtHandleData(pInstance);
         // Find the entry
         if (sockHandle >= 0) {
             pSocket = pFindBySockHandle(sockHandle);
             if (pSocket != NULL) {
+                readCacheMutex = pSocket->readCacheMutex;
+                if (readCacheMutex != NULL) {
+                    // Not U_PORT_MUTEX_LOCK() as the unlock
+                    // is conditional too
+                    uPortMutexLock(readCacheMutex);
+                    // Serve what we can from the read-ahead cache
+                    totalReceivedSize = (int32_t) readCacheRead(pSocket,
+                                                                (char *) pData,
+                                                                dataSizeBytes);
+                    dataSizeBytes -= totalReceivedSize;
+                }
                 negErrnoLocalOrSize = -U_SOCK_EWOULDBLOCK;
-                if (pSocket->pendingBytes == 0) {
+                atAvailable = (pFindDirectLink(cellHandle) == NULL);
+                if (pSocket->directLinkStreamHandle >= 0) {
+                    // In direct link mode the data comes
+                    // straight from the stream
+                    if (dataSizeBytes > 0) {
+                        x = directLinkRead(pSocket,
+                                           (char *) pData + totalReceivedSize,
+                                           dataSizeBytes);
+                        if (x > 0) {
+                            totalReceivedSize += x;
+                        } else if (x < 0) {
+                            negErrnoLocalOrSize = x;
+                        }
+                    }
+                } else if (!atAvailable) {
+                    // Another socket has the AT interface
+                    negErrnoLocalOrSize = -U_SOCK_EBUSY;
+                }
+                if (atAvailable && (pSocket->pendingBytes == 0) &&
+                    (totalReceivedSize == 0)) {
                     // If the URC has not filled in pendingBytes,
                     // ask the module directly if there is anything
                     // to read
@@ -1664,101 +2447,45 @@ int32_t uCellSockRead(int32_t cellHandle,
                     }
                     uAtClientUnlock(atHandle);
                 }
-                if (pSocket->pendingBytes > 0) {
+                if (atAvailable && (pSocket->pendingBytes > 0)) {
+                    dataLengthMax = segmentSizeGet(pInstance, true);
                     negErrnoLocalOrSize = U_SOCK_ENONE;
                     // Run around the loop until we run out of
                     // pending data or room in the buffer
                     while ((dataSizeBytes > 0) &&
                            (pSocket->pendingBytes > 0) &&
                            (negErrnoLocalOrSize == U_SOCK_ENONE)) {
-                        thisWantedReceiveSize = dataLengthMax;
-                        if (thisWantedReceiveSize > (int32_t) dataSizeBytes) {
-                            thisWantedReceiveSize = (int32_t) dataSizeBytes;
-                        }
-                        uAtClientLock(atHandle);
-                        uAtClientCommandStart(atHandle, "AT+USORD=");
-                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
-                        // Number of bytes to read
-                        uAtClientWriteInt(atHandle, thisWantedReceiveSize);
-                        uAtClientCommandStop(atHandle);
-                        uAtClientResponseStart(atHandle, "+USORD:");
-                        // Skip the socket ID
-                        uAtClientSkipParameters(atHandle, 1);
-                        // Read the amount of data
-                        thisActualReceiveSize = uAtClientReadInt(atHandle);
-                        if (thisActualReceiveSize > (int32_t) dataSizeBytes) {
-                            thisActualReceiveSize = (int32_t) dataSizeBytes;
-                        }
-                        if (thisActualReceiveSize > 0) {
-                            if (pInstance->socketsHexMode) {
-                                // In hex mode we need a buffer to dump
-                                // the hex into and then we can decode it
-                                negErrnoLocalOrSize = -U_SOCK_ENOMEM;
-                                //lint -e{647} Suppress suspicious truncation
-                                pHexBuffer = (char *) malloc(thisActualReceiveSize * 2 + 1);  // +1 for terminator
+                        if (dataSizeBytes < pSocket->readCacheSizeBytes) {
+                            // A small read: read ahead into the
+                            // cache and serve it from there so that
+                            // the next small read costs nothing
+                            x = readCacheFill(pInstance, pSocket);
+                            if (x >= 0) {
+                                x = (int32_t) readCacheRead(pSocket,
+                                                            (char *) pData +
+                                                            totalReceivedSize,
+                                                            dataSizeBytes);
                             }
-                            if (!pInstance->socketsHexMode || (pHexBuffer != NULL)) {
-                                negErrnoLocalOrSize = U_SOCK_ENONE;
-                                if (pHexBuffer != NULL) {
-                                    // In hex mode we can read in the whole string
-                                    //lint -e{647} Suppress suspicious truncation
-                                    readLength = uAtClientReadString(atHandle, pHexBuffer,
-                                                                     thisActualReceiveSize * 2 + 1,
-                                                                     false);
-                                    if (readLength > 0) {
-                                        x = ((int32_t) dataSizeBytes - totalReceivedSize) * 2;
-                                        if (readLength > x) {
-                                            readLength = x;
-                                        }
-                                        uHexToBin(pHexBuffer, readLength,
-                                                  (char *) pData + totalReceivedSize);
-                                    }
-                                    // Free memory
-                                    free(pHexBuffer);
-                                } else {
-                                    // Binary mode, don't stop for anything!
-                                    uAtClientIgnoreStopTag(atHandle);
-                                    // Get the leading quote mark out of the way
-                                    uAtClientReadBytes(atHandle, NULL, 1, true);
-                                    // Now read out the available data
-                                    uAtClientReadBytes(atHandle,
-                                                       (char *) pData +
-                                                       totalReceivedSize,
-                                                       thisActualReceiveSize, true);
-                                    // Make sure we wait for the stop tag before
-                                    // going around again
-                                    uAtClientRestoreStopTag(atHandle);
-                                }
+                        } else {
+                            thisWantedReceiveSize = dataLengthMax;
+                            if (thisWantedReceiveSize > (int32_t) dataSizeBytes) {
+                                thisWantedReceiveSize = (int32_t) dataSizeBytes;
                             }
+                            x = readSegment(pInstance, pSocket,
+                                            (char *) pData + totalReceivedSize,
+                                            thisWantedReceiveSize);
                         }
-                        uAtClientResponseStop(atHandle);
-                        // BEFORE unlocking, work out what's happened.
-                        // This is to prevent a URC being processed that
-                        // may indicate data left and over-write pendingBytes
-                        // while we're also writing to it.
-                        if ((uAtClientErrorGet(atHandle) == 0) &&
-                            (thisActualReceiveSize >= 0)) {
-                            // Must use what +USORD returns here as it may be less
-                            // or more than we asked for and also may be
-                            // more than pendingBytes, depending on how
-                            // the URCs landed
-                            // This update of pendingBytes will be overwritten
-                            // by the URC but we have to do something here
-                            // 'cos we don't get a URC to tell us when pendingBytes
-                            // has gone to zero.
-                            if (thisActualReceiveSize > pSocket->pendingBytes) {
-                                pSocket->pendingBytes = 0;
-                            } else {
-                                pSocket->pendingBytes -= thisActualReceiveSize;
-                            }
-                            totalReceivedSize += thisActualReceiveSize;
-                            dataSizeBytes -= thisActualReceiveSize;
+                        if (x >= 0) {
+                            totalReceivedSize += x;
+                            dataSizeBytes -= x;
                         } else {
-                            negErrnoLocalOrSize = -U_SOCK_EIO;
+                            negErrnoLocalOrSize = x;
                         }
-                        uAtClientUnlock(atHandle);
                     }
                 }
+                if (readCacheMutex != NULL) {
+                    uPortMutexUnlock(readCacheMutex);
+                }
             }
         }
     }
@@ -1770,6 +2497,132 @@ int32_t uCellSockRead(int32_t cellHandle,
     return negErrnoLocalOrSize;
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: DIRECT LINK (TCP)
+ * -------------------------------------------------------------- */
+
+// Set when data written in direct link mode is sent.
+int32_t uCellSockDirectLinkTriggerSet(int32_t cellHandle,
+                                      int32_t sockHandle,
+                                      int32_t timerMs,
+                                      int32_t dataLengthBytes)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uAtClientHandle_t atHandle;
+    uCellSockSocket_t *pSocket;
+    // AT+UDCONF=5 is the timer trigger, AT+UDCONF=6
+    // the data length trigger
+    const int32_t triggers[][2] = {{5, timerMs}, {6, dataLengthBytes}};
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if (pInstance != NULL) {
+        atHandle = pInstance->atHandle;
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if ((pSocket != NULL) && (pSocket->directLinkStreamHandle < 0)) {
+                errnoLocal = U_SOCK_ENONE;
+                for (size_t x = 0; (x < sizeof(triggers) / sizeof(triggers[0])) &&
+                     (errnoLocal == U_SOCK_ENONE); x++) {
+                    if (triggers[x][1] >= 0) {
+                        uAtClientLock(atHandle);
+                        uAtClientCommandStart(atHandle, "AT+UDCONF=");
+                        uAtClientWriteInt(atHandle, triggers[x][0]);
+                        uAtClientWriteInt(atHandle, pSocket->sockHandleModule);
+                        uAtClientWriteInt(atHandle, triggers[x][1]);
+                        uAtClientCommandStopReadResponse(atHandle);
+                        if (uAtClientUnlock(atHandle) != 0) {
+                            errnoLocal = U_SOCK_EIO;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return -errnoLocal;
+}
+
+// Put a socket into direct link mode.
+int32_t uCellSockDirectLinkStart(int32_t cellHandle,
+                                 int32_t sockHandle)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    uCellPrivateInstance_t *pInstance;
+    uCellSockSocket_t *pSocket;
+    const uCellSockSocket_t *pSocketDirectLink;
+
+    // Find the instance
+    pInstance = pUCellPrivateGetInstance(cellHandle);
+    if (pInstance != NULL) {
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                pSocketDirectLink = pFindDirectLink(cellHandle);
+                if (pSocketDirectLink == pSocket) {
+                    // Nothing to do
+                    errnoLocal = U_SOCK_ENONE;
+                } else if (pSocketDirectLink != NULL) {
+                    // Another socket has the AT interface
+                    errnoLocal = U_SOCK_EBUSY;
+                } else {
+                    errnoLocal = directLinkStart(pInstance, pSocket);
+                }
+            }
+        }
+    }
+
+    return -errnoLocal;
+}
+
+// Take a socket out of direct link mode.
+int32_t uCellSockDirectLinkStop(int32_t cellHandle,
+                                int32_t sockHandle)
+{
+    int32_t errnoLocal = U_SOCK_EINVAL;
+    uCellSockSocket_t *pSocket;
+
+    // Find the instance
+    if (pUCellPrivateGetInstance(cellHandle) != NULL) {
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                errnoLocal = U_SOCK_ENONE;
+                if (pSocket->directLinkStreamHandle >= 0) {
+                    errnoLocal = directLinkStop(pSocket);
+                }
+            }
+        }
+    }
+
+    return -errnoLocal;
+}
+
+// Determine whether a socket is in direct link mode.
+bool uCellSockDirectLinkIsOn(int32_t cellHandle,
+                             int32_t sockHandle)
+{
+    bool directLinkIsOn = false;
+    const uCellSockSocket_t *pSocket;
+
+    // Find the instance
+    if (pUCellPrivateGetInstance(cellHandle) != NULL) {
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                directLinkIsOn = (pSocket->directLinkStreamHandle >= 0);
+            }
+        }
+    }
+
+    return directLinkIsOn;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: ASYNC
  * -------------------------------------------------------------- */
@@ -2027,4 +2880,29 @@ int32_t uCellSockGetBytesReceived(int32_t cellHandle,
     return doUsoctl(cellHandle, sockHandle, 3);
 }
 
+// Get the number of bytes waiting to be read on the given socket.
+int32_t uCellSockGetBytesPending(int32_t cellHandle,
+                                 int32_t sockHandle)
+{
+    int32_t negErrnoLocalOrSize = -U_SOCK_EINVAL;
+    uCellSockSocket_t *pSocket;
+
+    // Find the instance
+    if (pUCellPrivateGetInstance(cellHandle) != NULL) {
+        // Find the entry
+        if (sockHandle >= 0) {
+            pSocket = pFindBySockHandle(sockHandle);
+            if (pSocket != NULL) {
+                // No AT traffic here: this is whatever
+                // the last +UUSORD/+UUSORF URC or read
+                // left behind, plus the read-ahead cache
+                negErrnoLocalOrSize = pSocket->pendingBytes +
+                                      (int32_t) pSocket->readCacheLength;
+            }
+        }
+    }
+
+    return negErrnoLocalOrSize;
+}
+
 // End of file
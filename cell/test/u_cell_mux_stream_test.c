@@ -0,0 +1,408 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the 3GPP 27.010 multiplexer stream: these run
+ * a multiplexer on each of two UARTs which are cross-connected,
+ * hence no cellular module is required.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the
+ * U_PORT_TEST_FUNCTION() macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp(), memmove(), memset(), strchr(), strstr()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+
+#include "u_at_client.h"
+
+#include "u_cell_mux_stream.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The channel to run the AT client on.
+ */
+#define U_CELL_MUX_STREAM_TEST_CHANNEL_AT 1
+
+/** The channel to send bulk data on.
+ */
+#define U_CELL_MUX_STREAM_TEST_CHANNEL_DATA 3
+
+/** The amount of bulk data to send in one go: with the default
+ * settings this is more than half of a channel buffer, so that
+ * the receiving end switches flow control on, but only in the
+ * last frame, so that the write completes.
+ */
+#define U_CELL_MUX_STREAM_TEST_DATA_LENGTH_BYTES (U_CELL_MUX_STREAM_FRAME_INFORMATION_MAX_LENGTH_BYTES * 5)
+
+/** How long to wait for things to arrive.
+ */
+#define U_CELL_MUX_STREAM_TEST_WAIT_MS 2000
+
+/** The response of the AT server to AT+UTESTQ?.
+ */
+#define U_CELL_MUX_STREAM_TEST_RESPONSE "\r\n+UTESTQ: 42\r\n\r\nOK\r\n"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Handle for UART A, where the AT client will be.
+ */
+static int32_t gUartAHandle = -1;
+
+/** Handle for UART B, where the AT server will be.
+ */
+static int32_t gUartBHandle = -1;
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/** Storage for what the AT server has received.
+ */
+static char gServerBuffer[64];
+
+/** How much is in gServerBuffer.
+ */
+static size_t gServerLength = 0;
+
+/** Bulk data to send.
+ */
+static char gDataTx[U_CELL_MUX_STREAM_TEST_DATA_LENGTH_BYTES];
+
+/** Bulk data received.
+ */
+static char gDataRx[U_CELL_MUX_STREAM_TEST_DATA_LENGTH_BYTES];
+
+/** Count of URCs received.
+ */
+static volatile int32_t gUrcCount = 0;
+
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// A simple AT server on a multiplexer channel: it responds to
+// AT+UTESTQ? and OKs anything else.
+static void serverCallback(int32_t streamHandle, uint32_t eventBitmask,
+                           void *pParameters)
+{
+    int32_t sizeOrError;
+    char *pEnd;
+
+    (void) pParameters;
+
+    if (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+        do {
+            sizeOrError = uCellMuxStreamRead(streamHandle,
+                                             gServerBuffer + gServerLength,
+                                             sizeof(gServerBuffer) - gServerLength - 1);
+            if (sizeOrError > 0) {
+                gServerLength += sizeOrError;
+                gServerBuffer[gServerLength] = 0;
+                pEnd = strchr(gServerBuffer, '\r');
+                while (pEnd != NULL) {
+                    *pEnd = 0;
+                    if (strstr(gServerBuffer, "AT+UTESTQ?") != NULL) {
+                        uCellMuxStreamWrite(streamHandle, U_CELL_MUX_STREAM_TEST_RESPONSE,
+                                            sizeof(U_CELL_MUX_STREAM_TEST_RESPONSE) - 1);
+                    } else {
+                        uCellMuxStreamWrite(streamHandle, "\r\nOK\r\n", 6);
+                    }
+                    gServerLength -= (pEnd + 1) - gServerBuffer;
+                    memmove(gServerBuffer, pEnd + 1, gServerLength + 1);
+                    pEnd = strchr(gServerBuffer, '\r');
+                }
+                if (gServerLength >= sizeof(gServerBuffer) - 1) {
+                    gServerLength = 0;
+                }
+            }
+        } while (sizeOrError > 0);
+    }
+}
+
+// URC handler.
+static void urcHandler(uAtClientHandle_t atHandle, void *pParameter)
+{
+    (void) pParameter;
+
+    if (uAtClientReadInt(atHandle) == 1) {
+        gUrcCount++;
+    }
+}
+
+// Send AT+UTESTQ? and check the response.
+static bool atCommandIsOk(uAtClientHandle_t atHandle)
+{
+    int32_t value;
+
+    uAtClientLock(atHandle);
+    uAtClientCommandStart(atHandle, "AT+UTESTQ?");
+    uAtClientCommandStop(atHandle);
+    uAtClientResponseStart(atHandle, "+UTESTQ:");
+    value = uAtClientReadInt(atHandle);
+    uAtClientResponseStop(atHandle);
+
+    return (uAtClientUnlock(atHandle) == 0) && (value == 42);
+}
+
+// Read bulk data from a channel until the given amount has arrived.
+static size_t dataRead(int32_t streamHandle, char *pBuffer, size_t length)
+{
+    size_t received = 0;
+    int32_t sizeOrError;
+    int64_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((received < length) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_STREAM_TEST_WAIT_MS)) {
+        sizeOrError = uCellMuxStreamRead(streamHandle, pBuffer + received,
+                                         length - received);
+        if (sizeOrError > 0) {
+            received += sizeOrError;
+        } else {
+            uPortTaskBlock(10);
+        }
+    }
+
+    return received;
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/** Run a multiplexer on each of two cross-connected UARTs, an
+ * AT client on one channel and bulk data on another.
+ */
+U_PORT_TEST_FUNCTION("[cellMuxStream]", "cellMuxStreamLoopback")
+{
+    int32_t muxAHandle;
+    int32_t muxBHandle;
+    int32_t atStreamAHandle;
+    int32_t atStreamBHandle;
+    int32_t dataStreamAHandle;
+    int32_t dataStreamBHandle;
+    uAtClientHandle_t atHandle;
+    int64_t startTimeMs;
+    int32_t heapUsed;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A, U_CFG_TEST_BAUD_RATE, NULL,
+                                 U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B, U_CFG_TEST_BAUD_RATE, NULL,
+                                 U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+    uPortLog("U_CELL_MUX_STREAM_TEST: make sure UARTs %d and %d are"
+             " cross-connected.\n", U_CFG_TEST_UART_A, U_CFG_TEST_UART_B);
+
+    U_PORT_TEST_ASSERT(uCellMuxStreamInit() == 0);
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    muxAHandle = uCellMuxStreamOpen(gUartAHandle);
+    U_PORT_TEST_ASSERT(muxAHandle >= 0);
+    // Can't have two on the same UART
+    U_PORT_TEST_ASSERT(uCellMuxStreamOpen(gUartAHandle) < 0);
+    muxBHandle = uCellMuxStreamOpen(gUartBHandle);
+    U_PORT_TEST_ASSERT(muxBHandle >= 0);
+    U_PORT_TEST_ASSERT(muxBHandle != muxAHandle);
+
+    // Open the channels on B first so that it is ready to receive,
+    // then on A, which should find them already open
+    atStreamBHandle = uCellMuxStreamChannelOpen(muxBHandle,
+                                                U_CELL_MUX_STREAM_TEST_CHANNEL_AT);
+    U_PORT_TEST_ASSERT(atStreamBHandle >= 0);
+    dataStreamBHandle = uCellMuxStreamChannelOpen(muxBHandle,
+                                                  U_CELL_MUX_STREAM_TEST_CHANNEL_DATA);
+    U_PORT_TEST_ASSERT(dataStreamBHandle >= 0);
+    U_PORT_TEST_ASSERT(uCellMuxStreamCallbackSet(atStreamBHandle,
+                                                 serverCallback, NULL) == 0);
+    atStreamAHandle = uCellMuxStreamChannelOpen(muxAHandle,
+                                                U_CELL_MUX_STREAM_TEST_CHANNEL_AT);
+    U_PORT_TEST_ASSERT(atStreamAHandle >= 0);
+    dataStreamAHandle = uCellMuxStreamChannelOpen(muxAHandle,
+                                                  U_CELL_MUX_STREAM_TEST_CHANNEL_DATA);
+    U_PORT_TEST_ASSERT(dataStreamAHandle >= 0);
+    // Channel 0 is not a user channel
+    U_PORT_TEST_ASSERT(uCellMuxStreamChannelOpen(muxAHandle, 0) < 0);
+
+    uPortLog("U_CELL_MUX_STREAM_TEST: adding an AT client on channel %d...\n",
+             U_CELL_MUX_STREAM_TEST_CHANNEL_AT);
+    atHandle = uAtClientAdd(atStreamAHandle, U_AT_CLIENT_STREAM_TYPE_CMUX,
+                            NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atHandle != NULL);
+    gUrcCount = 0;
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atHandle, "+UTESTU:",
+                                              urcHandler, NULL) == 0);
+    U_PORT_TEST_ASSERT(atCommandIsOk(atHandle));
+
+    // Put bulk data into the data channel and leave it unread:
+    // this should not get in the way of the AT channel
+    for (size_t x = 0; x < sizeof(gDataTx); x++) {
+        gDataTx[x] = (char) x;
+    }
+    uPortLog("U_CELL_MUX_STREAM_TEST: sending %d byte(s) on channel %d...\n",
+             sizeof(gDataTx), U_CELL_MUX_STREAM_TEST_CHANNEL_DATA);
+    U_PORT_TEST_ASSERT(uCellMuxStreamWrite(dataStreamAHandle, gDataTx,
+                                           sizeof(gDataTx)) == sizeof(gDataTx));
+    startTimeMs = uPortGetTickTimeMs();
+    while ((uCellMuxStreamGetReceiveSize(dataStreamBHandle) < (int32_t) sizeof(gDataTx)) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_STREAM_TEST_WAIT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(uCellMuxStreamGetReceiveSize(dataStreamBHandle) == sizeof(gDataTx));
+    U_PORT_TEST_ASSERT(atCommandIsOk(atHandle));
+
+    // A URC from the far end on the AT channel
+    U_PORT_TEST_ASSERT(uCellMuxStreamWrite(atStreamBHandle, "\r\n+UTESTU: 1\r\n", 14) == 14);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((gUrcCount < 1) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_CELL_MUX_STREAM_TEST_WAIT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gUrcCount == 1);
+
+    // Now read the bulk data, which will lift flow control, and
+    // send it again
+    U_PORT_TEST_ASSERT(dataRead(dataStreamBHandle, gDataRx, sizeof(gDataRx)) == sizeof(gDataRx));
+    U_PORT_TEST_ASSERT(memcmp(gDataTx, gDataRx, sizeof(gDataTx)) == 0);
+    U_PORT_TEST_ASSERT(uCellMuxStreamWrite(dataStreamAHandle, gDataTx,
+                                           sizeof(gDataTx)) == sizeof(gDataTx));
+    memset(gDataRx, 0, sizeof(gDataRx));
+    U_PORT_TEST_ASSERT(dataRead(dataStreamBHandle, gDataRx, sizeof(gDataRx)) == sizeof(gDataRx));
+    U_PORT_TEST_ASSERT(memcmp(gDataTx, gDataRx, sizeof(gDataTx)) == 0);
+
+    // Detach the AT client from its channel and put it back again
+    U_PORT_TEST_ASSERT(uAtClientStreamSet(atHandle, -1, U_AT_CLIENT_STREAM_TYPE_CMUX) == 0);
+    U_PORT_TEST_ASSERT(uAtClientStreamSet(atHandle, atStreamAHandle,
+                                          U_AT_CLIENT_STREAM_TYPE_CMUX) == 0);
+    U_PORT_TEST_ASSERT(atCommandIsOk(atHandle));
+    uPortLog("U_CELL_MUX_STREAM_TEST: URC task stack had a minimum of %d byte(s) free.\n",
+             uAtClientUrcHandlerStackMinFree(atHandle));
+
+    uPortLog("U_CELL_MUX_STREAM_TEST: closing down...\n");
+    uAtClientRemove(atHandle);
+    uAtClientDeinit();
+    uCellMuxStreamChannelClose(dataStreamAHandle);
+    // The far end should see that
+    U_PORT_TEST_ASSERT(uCellMuxStreamWrite(dataStreamBHandle, gDataTx, 1) < 0);
+    // A sends CLD, which B responds to, so both should
+    // know that multiplexer mode has ended
+    U_PORT_TEST_ASSERT(uCellMuxStreamClose(muxAHandle) == 0);
+    U_PORT_TEST_ASSERT(uCellMuxStreamClose(muxBHandle) == 0);
+    uCellMuxStreamDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_CELL_MUX_STREAM_TEST: we have leaked %d byte(s).\n", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+#endif
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[cellMuxStream]", "cellMuxStreamCleanUp")
+{
+    int32_t x;
+
+    uAtClientDeinit();
+    uCellMuxStreamDeinit();
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+    }
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+    }
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        uPortLog("U_CELL_MUX_STREAM_TEST: main task stack had a minimum of %d"
+                 " byte(s) free at the end of these tests.\n", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        uPortLog("U_CELL_MUX_STREAM_TEST: heap had a minimum of %d"
+                 " byte(s) free at the end of these tests.\n", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+// End of file
@@ -245,6 +245,8 @@ static void testPowerAliveVInt(uCellTestPrivate_t *pHandles,
     int32_t cellHandle;
     bool trulyHardPowerOff = false;
     const uCellPrivateModule_t *pModule;
+    uint32_t fingerprint;
+    uint32_t fingerprintAgain;
 #  if U_CFG_APP_PIN_CELL_VINT < 0
     int64_t timeMs;
 #  endif
@@ -321,6 +323,17 @@ static void testPowerAliveVInt(uCellTestPrivate_t *pHandles,
                                       NULL) == 0);
         uPortLog("U_CELL_PWR_TEST: checking that module is alive...\n");
         U_PORT_TEST_ASSERT(uCellPwrIsAlive(cellHandle));
+        // The configuration should have been fingerprinted and
+        // powering on again, when the module is already on,
+        // should apply the same configuration
+        U_PORT_TEST_ASSERT(uCellPwrGetConfigurationFingerprint(cellHandle,
+                                                               &fingerprint) == 0);
+        U_PORT_TEST_ASSERT(fingerprint != 0);
+        U_PORT_TEST_ASSERT(uCellPwrOn(cellHandle, U_CELL_TEST_CFG_SIM_PIN,
+                                      NULL) == 0);
+        U_PORT_TEST_ASSERT(uCellPwrGetConfigurationFingerprint(cellHandle,
+                                                               &fingerprintAgain) == 0);
+        U_PORT_TEST_ASSERT(fingerprintAgain == fingerprint);
         // Give the module time to sort itself out
         uPortLog("U_CELL_PWR_TEST: waiting %d second(s) before powering off...\n",
                  pModule->minAwakeTimeSeconds);
@@ -347,6 +360,10 @@ static void testPowerAliveVInt(uCellTestPrivate_t *pHandles,
         uPortLog("U_CELL_PWR_TEST: powering off...\n");
         uCellPwrOff(cellHandle, pKeepGoingCallback);
         uPortLog("U_CELL_PWR_TEST: power off completed.\n");
+        // The module will have lost its configuration
+        U_PORT_TEST_ASSERT(uCellPwrGetConfigurationFingerprint(cellHandle,
+                                                               &fingerprint) == 0);
+        U_PORT_TEST_ASSERT(fingerprint == 0);
 #  if U_CFG_APP_PIN_CELL_VINT < 0
         timeMs = uPortGetTickTimeMs() - timeMs;
         if (timeMs < pModule->powerDownWaitSeconds * 1000) {
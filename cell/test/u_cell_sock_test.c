@@ -502,6 +502,7 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
     int32_t z;
     size_t count;
     char *pBuffer;
+    size_t length;
     int32_t heapUsed;
 
     // In case a previous test failed
@@ -703,14 +704,32 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
     U_PORT_TEST_ASSERT(uCellSockHexModeOff(cellHandle) == 0);
     U_PORT_TEST_ASSERT(!uCellSockHexModeIsOn(cellHandle));
 
-    // Do this twice: once with binary mode and once with hex mode
-    for (size_t a = 0; a < 2; a++) {
+    // Do this three times: once with binary mode, once with hex
+    // mode and once in binary mode with a read-ahead cache,
+    // reading in small chunks
+    for (size_t a = 0; a < 3; a++) {
         gDataCallbackCalledTcp = false;
         if (a == 0) {
             U_PORT_TEST_ASSERT(!uCellSockHexModeIsOn(cellHandle));
-        } else {
+        } else if (a == 1) {
             U_PORT_TEST_ASSERT(uCellSockHexModeOn(cellHandle) == 0);
             U_PORT_TEST_ASSERT(uCellSockHexModeIsOn(cellHandle));
+        } else {
+            U_PORT_TEST_ASSERT(uCellSockHexModeOff(cellHandle) == 0);
+            U_PORT_TEST_ASSERT(!uCellSockHexModeIsOn(cellHandle));
+            y = 128;
+            U_PORT_TEST_ASSERT(uCellSockOptionSet(cellHandle, gSockHandleTcp,
+                                                  U_SOCK_OPT_LEVEL_SOCK,
+                                                  U_SOCK_OPT_RCVBUF,
+                                                  &y, sizeof(y)) == 0);
+            y = 0;
+            length = sizeof(y);
+            U_PORT_TEST_ASSERT(uCellSockOptionGet(cellHandle, gSockHandleTcp,
+                                                  U_SOCK_OPT_LEVEL_SOCK,
+                                                  U_SOCK_OPT_RCVBUF,
+                                                  &y, &length) == 0);
+            U_PORT_TEST_ASSERT(y == 128);
+            U_PORT_TEST_ASSERT(length == sizeof(y));
         }
         // Send the TCP echo data in random sized chunks
         uPortLog("U_CELL_SOCK_TEST: sending %d byte(s) to %s:%d in"
@@ -751,9 +770,14 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockBasic")
         y = 0;
         count = 0;
         memset(pBuffer, 0, U_CELL_SOCK_MAX_SEGMENT_SIZE_BYTES);
-        while ((y < sizeof(gAllChars)) && (count < 100)) {
+        while ((y < sizeof(gAllChars)) &&
+               (count < ((a < 2) ? 100 : sizeof(gAllChars)))) {
             if ((sizeof(gAllChars) - y) > 1) {
                 w = rand() % (sizeof(gAllChars) - y);
+                if ((a == 2) && (w > 16)) {
+                    // Small reads to exercise the cache
+                    w = (w % 16) + 1;
+                }
             } else {
                 w = 1;
             }
@@ -1031,6 +1055,202 @@ U_PORT_TEST_FUNCTION("[cellSock]", "cellSockOptionSetGet")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test direct link mode on a TCP socket.
+ */
+U_PORT_TEST_FUNCTION("[cellSock]", "cellSockDirectLink")
+{
+    int32_t cellHandle;
+    uSockAddress_t echoServerAddressTcp;
+    char *pBuffer;
+    int32_t heapUsed;
+    int32_t y;
+    int32_t z;
+    size_t length;
+
+    // In case a previous test failed
+    uCellSockDeinit();
+    uCellTestPrivateCleanup(&gHandles);
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    memset(&echoServerAddressTcp, 0, sizeof(echoServerAddressTcp));
+
+    // Malloc a buffer to receive things into.
+    pBuffer = (char *) malloc(sizeof(gAllChars));
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Do the standard preamble
+    U_PORT_TEST_ASSERT(uCellTestPrivatePreamble(U_CFG_TEST_CELL_MODULE_TYPE,
+                                                &gHandles, true) == 0);
+    cellHandle = gHandles.cellHandle;
+
+    // Connect to the network
+    gStopTimeMs = uPortGetTickTimeMs() +
+                  (U_CELL_TEST_CFG_CONNECT_TIMEOUT_SECONDS * 1000);
+    y = uCellNetConnect(cellHandle, NULL,
+#ifdef U_CELL_TEST_CFG_APN
+                        U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_APN),
+#else
+                        NULL,
+#endif
+#ifdef U_CELL_TEST_CFG_USERNAME
+                        U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_USERNAME),
+#else
+                        NULL,
+#endif
+#ifdef U_CELL_TEST_CFG_PASSWORD
+                        U_PORT_STRINGIFY_QUOTED(U_CELL_TEST_CFG_PASSWORD),
+#else
+                        NULL,
+#endif
+                        keepGoingCallback);
+    U_PORT_TEST_ASSERT(y == 0);
+
+    // Init cell sockets
+    U_PORT_TEST_ASSERT(uCellSockInit() == 0);
+    U_PORT_TEST_ASSERT(uCellSockInitInstance(cellHandle) == 0);
+
+    // Look up the address of the server we use for TCP echo
+    U_PORT_TEST_ASSERT(uCellSockGetHostByName(cellHandle,
+                                              U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                              &(echoServerAddressTcp.ipAddress)) == 0);
+    echoServerAddressTcp.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+
+    // Create a TCP socket, add callbacks and connect it
+    gSockHandleTcp = uCellSockCreate(cellHandle, U_SOCK_TYPE_STREAM,
+                                     U_SOCK_PROTOCOL_TCP);
+    U_PORT_TEST_ASSERT(gSockHandleTcp >= 0);
+    gDataCallbackCalledTcp = false;
+    gClosedCallbackCalledTcp = false;
+    uCellSockRegisterCallbackData(cellHandle, gSockHandleTcp,
+                                  dataCallbackTcp);
+    uCellSockRegisterCallbackClosed(cellHandle, gSockHandleTcp,
+                                    closedCallbackTcp);
+    U_PORT_TEST_ASSERT(uCellSockConnect(cellHandle, gSockHandleTcp,
+                                        &echoServerAddressTcp) == 0);
+
+    // Send data written in direct link mode after 100 ms
+    // of quiet, no data length trigger
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkTriggerSet(cellHandle,
+                                                     gSockHandleTcp,
+                                                     100, 0) == 0);
+
+    // Enter direct link mode through the socket option
+    U_PORT_TEST_ASSERT(!uCellSockDirectLinkIsOn(cellHandle, gSockHandleTcp));
+    y = 1;
+    U_PORT_TEST_ASSERT(uCellSockOptionSet(cellHandle, gSockHandleTcp,
+                                          U_SOCK_OPT_LEVEL_TCP,
+                                          U_SOCK_OPT_TCP_DIRECT_LINK,
+                                          &y, sizeof(y)) == 0);
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkIsOn(cellHandle, gSockHandleTcp));
+    y = 0;
+    length = sizeof(y);
+    U_PORT_TEST_ASSERT(uCellSockOptionGet(cellHandle, gSockHandleTcp,
+                                          U_SOCK_OPT_LEVEL_TCP,
+                                          U_SOCK_OPT_TCP_DIRECT_LINK,
+                                          &y, &length) == 0);
+    U_PORT_TEST_ASSERT(y == 1);
+    U_PORT_TEST_ASSERT(length == sizeof(y));
+    // The triggers can't be changed while in direct link mode
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkTriggerSet(cellHandle,
+                                                     gSockHandleTcp,
+                                                     100, 0) < 0);
+
+    // Send the lot in one go and get it back
+    uPortLog("U_CELL_SOCK_TEST: sending %d byte(s) to %s:%d in direct"
+             " link mode...\n", sizeof(gAllChars),
+             U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+             U_SOCK_TEST_ECHO_TCP_SERVER_PORT);
+    U_PORT_TEST_ASSERT(uCellSockWrite(cellHandle, gSockHandleTcp, gAllChars,
+                                      sizeof(gAllChars)) == sizeof(gAllChars));
+    y = 0;
+    memset(pBuffer, 0, sizeof(gAllChars));
+    for (size_t x = 0; (x < 100) && (y < sizeof(gAllChars)); x++) {
+        z = uCellSockRead(cellHandle, gSockHandleTcp, pBuffer + y,
+                          sizeof(gAllChars) - y);
+        if (z > 0) {
+            y += z;
+        } else {
+            uPortTaskBlock(100);
+        }
+    }
+    uPortLog("U_CELL_SOCK_TEST: %d byte(s) echoed in direct link mode.\n", y);
+    U_PORT_TEST_ASSERT(y == sizeof(gAllChars));
+    U_PORT_TEST_ASSERT(memcmp(pBuffer, gAllChars, sizeof(gAllChars)) == 0);
+    // There are no URCs in direct link mode, the data
+    // callback is called from the stream
+    U_PORT_TEST_ASSERT(gDataCallbackCalledTcp);
+    U_PORT_TEST_ASSERT(gCallbackErrorNum == 0);
+
+    // Leave direct link mode: the AT interface should work again
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStop(cellHandle, gSockHandleTcp) == 0);
+    U_PORT_TEST_ASSERT(!uCellSockDirectLinkIsOn(cellHandle, gSockHandleTcp));
+    U_PORT_TEST_ASSERT(uCellSockGetBytesSent(cellHandle, gSockHandleTcp) > 0);
+    U_PORT_TEST_ASSERT(!gClosedCallbackCalledTcp);
+
+    // Now have the server send first: get the echo waiting in the
+    // module before entering direct link mode, in which case it
+    // arrives right behind the "CONNECT" and must not be lost
+    uPortLog("U_CELL_SOCK_TEST: entering direct link mode with %d byte(s)"
+             " waiting to be read...\n", sizeof(gAllChars));
+    gDataCallbackCalledTcp = false;
+    U_PORT_TEST_ASSERT(uCellSockWrite(cellHandle, gSockHandleTcp, gAllChars,
+                                      sizeof(gAllChars)) == sizeof(gAllChars));
+    for (size_t x = 0; (x < 100) && !gDataCallbackCalledTcp; x++) {
+        uPortTaskBlock(100);
+    }
+    U_PORT_TEST_ASSERT(gDataCallbackCalledTcp);
+    // Give the whole echo time to arrive
+    uPortTaskBlock(1000);
+    gDataCallbackCalledTcp = false;
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStart(cellHandle, gSockHandleTcp) == 0);
+    y = 0;
+    memset(pBuffer, 0, sizeof(gAllChars));
+    for (size_t x = 0; (x < 100) && (y < sizeof(gAllChars)); x++) {
+        z = uCellSockRead(cellHandle, gSockHandleTcp, pBuffer + y,
+                          sizeof(gAllChars) - y);
+        if (z > 0) {
+            y += z;
+        } else {
+            uPortTaskBlock(100);
+        }
+    }
+    uPortLog("U_CELL_SOCK_TEST: %d byte(s) read in direct link mode.\n", y);
+    U_PORT_TEST_ASSERT(y == sizeof(gAllChars));
+    U_PORT_TEST_ASSERT(memcmp(pBuffer, gAllChars, sizeof(gAllChars)) == 0);
+    U_PORT_TEST_ASSERT(gDataCallbackCalledTcp);
+    U_PORT_TEST_ASSERT(uCellSockDirectLinkStop(cellHandle, gSockHandleTcp) == 0);
+    U_PORT_TEST_ASSERT(gCallbackErrorNum == 0);
+
+    // Close the socket
+    U_PORT_TEST_ASSERT(uCellSockClose(cellHandle, gSockHandleTcp,
+                                      NULL) == 0);
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    U_PORT_TEST_ASSERT(gClosedCallbackCalledTcp);
+    U_PORT_TEST_ASSERT(gCallbackErrorNum == 0);
+
+    // Deinit cell sockets
+    uCellSockDeinit();
+
+    // Disconnect
+    U_PORT_TEST_ASSERT(uCellNetDisconnect(cellHandle, NULL) == 0);
+
+    // Do the standard postamble, leaving the module on for the next
+    // test to speed things up
+    uCellTestPrivatePostamble(&gHandles, false);
+
+    // Free memory
+    free(pBuffer);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_CELL_SOCK_TEST: we have leaked %d byte(s).\n", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
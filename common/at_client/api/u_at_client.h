@@ -239,7 +239,7 @@ extern "C" {
  * management items.
  */
 #define U_AT_CLIENT_BUFFER_OVERHEAD_BYTES (U_AT_CLIENT_MARKER_SIZE * 2 + \
-                                           (sizeof(size_t) * 5))
+                                           (sizeof(size_t) * 7))
 
 /** A suggested AT client buffer length.  The limiting factor is
  * the longest parameter of type string that will ever appear in an
@@ -355,6 +355,24 @@ extern "C" {
 # define U_AT_CLIENT_CALLBACK_TASK_PRIORITY U_CFG_OS_APP_TASK_PRIORITY
 #endif
 
+#ifndef U_AT_CLIENT_BATCH_LINE_MAX_LENGTH_BYTES
+/** The maximum length of a line of chained AT commands sent by
+ * uAtClientCommandBatch(), not including the command delimiter;
+ * where chaining would exceed this another line is begun.  This
+ * should be set well within the command line length of the
+ * AT servers in use.
+ */
+# define U_AT_CLIENT_BATCH_LINE_MAX_LENGTH_BYTES 128
+#endif
+
+#ifndef U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES
+/** The maximum length of the AT command or URC prefix by which
+ * statistics are collected, see uAtClientStatsOn(), not including
+ * the null terminator; longer prefixes are truncated.
+ */
+# define U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES 15
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -363,13 +381,15 @@ extern "C" {
  */
 typedef void *uAtClientHandle_t;
 
-/** The types of underlying stream APIs supported, currently
- * only UART.
+/** The types of underlying stream APIs supported: a UART, an
+ * EDM stream (short range modules) or a channel of a 3GPP 27.010
+ * multiplexer (cellular modules, see u_cell_mux_stream.h).
  */
 //lint -estring(788, uAtClientStream_t::U_AT_CLIENT_STREAM_TYPE_MAX) Suppress not used within defaulted switch
 typedef enum {
     U_AT_CLIENT_STREAM_TYPE_UART,
     U_AT_CLIENT_STREAM_TYPE_EDM,
+    U_AT_CLIENT_STREAM_TYPE_CMUX,
     U_AT_CLIENT_STREAM_TYPE_MAX
 } uAtClientStream_t;
 
@@ -390,6 +410,70 @@ typedef struct {
     int32_t code;
 } uAtClientDeviceError_t;
 
+/** A complete AT command for uAtClientCommandBatch().
+ */
+typedef struct {
+    const char *pCommand;        /**< the complete AT command,
+                                      including the "AT", e.g.
+                                      "AT+CMEE=2"; cannot be NULL. */
+    const char *pResponsePrefix; /**< the prefix of the information
+                                      response to the AT command,
+                                      e.g. "+CGATT:", or NULL if
+                                      the response has no prefix;
+                                      ignored if pResponseParser
+                                      is NULL. */
+    void (*pResponseParser) (uAtClientHandle_t atHandle,
+                             void *pParameter); /**< function to read
+                                                     the information
+                                                     response, called
+                                                     once the prefix
+                                                     has been found,
+                                                     using the
+                                                     uAtClientReadXxx()
+                                                     functions; may be
+                                                     NULL if the
+                                                     response is of no
+                                                     interest. */
+    void *pParameter;            /**< passed to pResponseParser as
+                                      its second parameter. */
+} uAtClientBatchCommand_t;
+
+/** The statistics for one AT command or URC prefix, as returned
+ * by uAtClientStatsGet().  AT commands are keyed by the command
+ * up to but not including any '=' or '?', e.g. "AT+CGATT", URCs
+ * by the prefix they were registered with, e.g. "+CREG:".
+ */
+typedef struct {
+    char prefix[U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES + 1]; /**< the
+                                 null-terminated prefix; empty
+                                 for the entry that collects
+                                 everything that did not fit
+                                 in the table. */
+    bool isUrc;               /**< true if this is a URC, else it
+                                   is an AT command. */
+    int32_t count;            /**< the number of times the AT
+                                   command was sent or the URC
+                                   was handled. */
+    int32_t totalTimeMs;      /**< for an AT command the total
+                                   time from the command being
+                                   started to the final response,
+                                   for a URC the total time spent
+                                   in its handler. */
+    int32_t maxTimeMs;        /**< the longest of the times that
+                                   make up totalTimeMs. */
+    int32_t txBytes;          /**< the number of bytes sent for
+                                   an AT command; always zero
+                                   for a URC. */
+    int32_t rxBytes;          /**< the number of bytes received
+                                   while an AT command was in
+                                   progress, which may include
+                                   interleaved URCs; always zero
+                                   for a URC. */
+    int32_t numTimeouts;      /**< the number of AT timeouts
+                                   suffered by an AT command;
+                                   always zero for a URC. */
+} uAtClientStatsEntry_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INITIALISATION AND CONFIGURATION
  * -------------------------------------------------------------- */
@@ -450,6 +534,61 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
  */
 void uAtClientRemove(uAtClientHandle_t atHandle);
 
+/** Move an AT client to a different stream, keeping its URC
+ * handlers and settings; for instance, when a cellular module
+ * has been switched into multiplexer mode the AT client that was
+ * on the UART can be moved onto one of the multiplexer channels.
+ * Anything buffered from the old stream is discarded.  The AT
+ * client must not be locked when this is called.
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param streamHandle the new stream handle; the stream must
+ *                     have already been opened by the caller.
+ *                     Use -1 to detach the AT client from its
+ *                     stream entirely, e.g. while the stream is
+ *                     used for something else; the AT client
+ *                     must not be used until it is given a
+ *                     stream once more.
+ * @param streamType   the type of stream that streamHandle is for.
+ * @return             zero on success else negative error code.
+ */
+int32_t uAtClientStreamSet(uAtClientHandle_t atHandle,
+                           int32_t streamHandle,
+                           uAtClientStream_t streamType);
+
+/** Detach a locked AT client from its stream, as
+ * uAtClientStreamSet() with a streamHandle of -1 would, where a
+ * response (e.g. "CONNECT") has just switched the stream into a
+ * data mode.  Since the AT client stays locked throughout, no URC
+ * handling can get at the data that follows the response, and
+ * anything the AT client has already read from the stream beyond
+ * where it has got to in the response is copied to pBuffer rather
+ * than being discarded; uAtClientStreamDetachSize() says how much
+ * that is.  Call uAtClientUnlock() as usual afterwards;
+ * uAtClientStreamSet() gives the AT client a stream once more.
+ *
+ * @param atHandle     the handle of the AT client, which must be
+ *                     locked.
+ * @param[out] pBuffer a place to put the data already read from
+ *                     the stream; may be NULL if bufferSize is 0.
+ * @param bufferSize   the number of bytes at pBuffer.
+ * @return             the number of bytes copied to pBuffer, else
+ *                     negative error code, in which case the AT
+ *                     client remains on its stream.
+ */
+int32_t uAtClientStreamDetach(uAtClientHandle_t atHandle,
+                              char *pBuffer, size_t bufferSize);
+
+/** Get the number of bytes that uAtClientStreamDetach() would
+ * copy out, i.e. what the AT client has read from its stream
+ * but not yet consumed.
+ *
+ * @param atHandle the handle of the AT client, which must be
+ *                 locked.
+ * @return         the number of bytes, else negative error code.
+ */
+int32_t uAtClientStreamDetachSize(uAtClientHandle_t atHandle);
+
 /** Get whether general debug prints are on or off.
  *
  * @param atHandle the handle of the AT client.
@@ -949,6 +1088,43 @@ void uAtClientSkipBytes(uAtClientHandle_t atHandle,
 int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
                                char character);
 
+/** Send a batch of complete AT commands, each of which gets an
+ * `OK` or `ERROR` response, stopping at the first failure.  The
+ * AT client is locked and unlocked by this function: do NOT call
+ * it with the AT client already locked.
+ *
+ * If chain is true the commands are concatenated into as few
+ * command lines as possible, as permitted by ITU-T V.250 (a ';'
+ * after each extended command, e.g. `ATE0+CMEE=2;&C1`), so that
+ * there is a single round-trip per line, rather than one per
+ * command, and the inter-command delay of uAtClientDelaySet() is
+ * only paid per line.  Commands that are to have their information
+ * response parsed but have no response prefix cannot be told apart
+ * from the rest of the line and so are always sent on their own.
+ * If a chained line gets `ERROR` the AT server will have stopped
+ * at the failing command, so the commands of that line are sent
+ * again, one at a time, in order to establish which one failed:
+ * hence only chain commands which may safely be repeated.
+ *
+ * If chain is false the commands are simply sent one after
+ * another, each waiting for the `OK` or `ERROR` of the one before,
+ * under a single lock of the AT client.
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param pCommands    the commands; cannot be NULL.
+ * @param numCommands  the number of commands at pCommands.
+ * @param chain        true to chain the commands together.
+ * @param pIndexFailed a place to put the index in pCommands of the
+ *                     command that failed, may be NULL; set to
+ *                     numCommands on success.
+ * @return             zero if all of the commands succeeded, else
+ *                     negative error code.
+ */
+int32_t uAtClientCommandBatch(uAtClientHandle_t atHandle,
+                              const uAtClientBatchCommand_t *pCommands,
+                              size_t numCommands, bool chain,
+                              size_t *pIndexFailed);
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: HANDLE UNSOLICITED RESPONSES
  * -------------------------------------------------------------- */
@@ -975,7 +1151,10 @@ int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
  *
  * @param atHandle        the handle of the AT client.
  * @param pPrefix         the prefix for the URC. A prefix might
- *                        for example be "+CEREG:".
+ *                        for example be "+CEREG:"; it cannot be
+ *                        empty.  Should more than one prefix
+ *                        match, e.g. "+UUSO" and "+UUSORD:",
+ *                        the handler set most recently is called.
  * @param pHandler        the function to be called if the prefix
  *                        is found at the start of an AT string
  *                        from the AT server.
@@ -1372,6 +1551,70 @@ int32_t uAtClientSetActivityPin(uAtClientHandle_t atHandle,
  */
 int32_t uAtClientGetActivityPin(const uAtClientHandle_t atHandle);
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: STATISTICS
+ * -------------------------------------------------------------- */
+
+/** Switch on collection of statistics for an AT client: for each
+ * AT command the number of times it was sent, the time taken to
+ * get the final response, the bytes sent and received and the
+ * number of timeouts are recorded and, for each URC, the number
+ * of times it was handled and the time spent in its handler.
+ * This is useful in finding out which AT commands are costing
+ * the most time on the link.  If statistics are already on they
+ * are reset.  None of the statistics functions may be called
+ * between uAtClientLock() and uAtClientUnlock().
+ *
+ * @param atHandle      the handle of the AT client.
+ * @param maxNumEntries the number of different AT commands and
+ *                      URCs to keep statistics for; anything
+ *                      beyond this is collected into one
+ *                      catch-all entry for AT commands and one
+ *                      for URCs.
+ * @return              zero on success else negative error code.
+ */
+int32_t uAtClientStatsOn(uAtClientHandle_t atHandle,
+                         size_t maxNumEntries);
+
+/** Switch off collection of statistics for an AT client, freeing
+ * the memory that was used to store them.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientStatsOff(uAtClientHandle_t atHandle);
+
+/** Get the statistics of an AT client, in the order in which
+ * the AT commands and URCs were first seen, followed by the
+ * catch-all entries if they have been used.
+ *
+ * @param atHandle      the handle of the AT client.
+ * @param pEntries      a place to put the entries; may be
+ *                      NULL, in which case the number of
+ *                      entries available is returned.
+ * @param maxNumEntries the number of entries that pEntries
+ *                      can hold.
+ * @return              the number of entries copied to pEntries
+ *                      (or available, if pEntries is NULL) else
+ *                      negative error code, e.g. if statistics
+ *                      are not on.
+ */
+int32_t uAtClientStatsGet(const uAtClientHandle_t atHandle,
+                          uAtClientStatsEntry_t *pEntries,
+                          size_t maxNumEntries);
+
+/** Reset the statistics of an AT client; they remain on.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientStatsReset(uAtClientHandle_t atHandle);
+
+/** Print the statistics of an AT client, one line per AT command
+ * or URC.
+ *
+ * @param atHandle the handle of the AT client.
+ */
+void uAtClientStatsPrint(const uAtClientHandle_t atHandle);
+
 #ifdef __cplusplus
 }
 #endif
@@ -60,6 +60,7 @@
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
 #include "u_short_range_edm_stream.h"
+#include "u_cell_mux_stream.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
@@ -157,6 +158,13 @@
 #define U_AT_CLIENT_DATA_BUFFER_PTR(pBufStruct) (((char *) (pBufStruct)) +          \
                                                  sizeof(uAtClientReceiveBuffer_t))
 
+/** Get a pointer to the start of the window in the data buffer
+ * of the given buffer/struct, the point from which readIndex,
+ * length, interceptIndex and lengthBuffered are measured.
+ */
+#define U_AT_CLIENT_DATA_WINDOW_PTR(pBufStruct) (U_AT_CLIENT_DATA_BUFFER_PTR(pBufStruct) + \
+                                                 (pBufStruct)->startIndex)
+
 /** Macro to lock the client mutex: as well as the normal case of
  * locking pClient->mutex this has to deal with the situation where
  * we're in the wake-up handler.  In that case we need to block
@@ -225,7 +233,8 @@
                                          pData, pDataIntercept,     \
                                          (int32_t) length,          \
                                          (int32_t) x, (int32_t) y,  \
-                                         (int32_t) z, readLength)
+                                         (int32_t) pReceiveBuffer->interceptIndex, \
+                                         readLength)
 
 /** Macros for detailed debugging of buffering behaviour.
  * This one for use in general.
@@ -273,14 +282,26 @@ typedef enum {
 
 /** The definition of a URC.
  */
-typedef struct uAtClientUrc_t {
+typedef struct {
     const char *pPrefix;       /** The prefix for this URC, e.g. "+CEREG:". */
     size_t prefixLength;       /** The length of pPrefix. */
     void (*pHandler) (uAtClientHandle_t, void *); /** The handler to call if pPrefix is matched. */
     void *pHandlerParam;       /** The parameter to pass to pHandler. */
-    struct uAtClientUrc_t *pNext;
+    size_t order;              /** When this URC was added, relative to the others. */
 } uAtClientUrc_t;
 
+/** A node in the trie of URC prefixes: there is one node per
+ * character of a prefix, prefixes with the same start sharing
+ * nodes.  The nodes at one level of the trie, the siblings,
+ * are kept in order of character value.
+ */
+typedef struct uAtClientUrcNode_t {
+    char character;  /** The character this node matches. */
+    uAtClientUrc_t *pUrc; /** The URC whose prefix ends here, NULL if there isn't one. */
+    struct uAtClientUrcNode_t *pChild; /** The first node of the next level down. */
+    struct uAtClientUrcNode_t *pSibling; /** The next node at this level. */
+} uAtClientUrcNode_t;
+
 /** The definition of a tag.
  */
 typedef struct {
@@ -307,15 +328,26 @@ typedef struct {
  * the size calculation the structure must be a multiple of 4 bytes
  * in size; the simplest way to do this is to only put items that
  * are 4 or 8 bytes in size into it.
+ * The buffered data occupies a window which slides along the data
+ * buffer as it is read: discarding data that has been read only
+ * moves startIndex, the window is moved back to the start of the
+ * data buffer for free when it becomes empty and the data in it
+ * is only moved down if it runs out of room at the end.
  */
 typedef struct {
     size_t isMalloced;  /** Set to 1 to indicate that data buffer was malloced. */
     size_t dataBufferSize; /** The size of the data buffer which follows this. */
+    size_t startIndex; /** The offset of the window in the data buffer; the
+                           indexes and lengths below are relative to this. */
     size_t length;     /** The number of characters that may be read from the buffer. */
     size_t lengthBuffered;  /** The number of bytes in the buffer: may be larger
                                 than length if there is an intercept function
                                 active and it hasn't yet pocessed the extra
                                 bytes into readable characters. */
+    size_t interceptIndex; /** The start of the bytes that the intercept function
+                               has yet to process; anything between length and
+                               this has already been consumed by the intercept
+                               function and is ignored. */
     size_t readIndex;  /** The read start position for characters in the buffer. */
     char mk0[U_AT_CLIENT_MARKER_SIZE]; /** Opening marker. */
 } uAtClientReceiveBuffer_t;
@@ -351,6 +383,17 @@ typedef struct {
     int32_t hysteresisMs;
 } uAtClientActivityPin_t;
 
+/** Struct holding the statistics of an AT client; the entries
+ * follow this structure in the same malloc()ed block, the last
+ * two being the catch-alls for AT commands and URCs respectively.
+ */
+typedef struct {
+    uAtClientStatsEntry_t *pCurrent; /** The entry of the AT command in progress, NULL if none. */
+    int64_t startTimeMs; /** The time the AT command in progress was started. */
+    size_t numEntries; /** The number of entries in use, not including the catch-alls. */
+    size_t maxNumEntries; /** The number of entries, not including the catch-alls. */
+} uAtClientStats_t;
+
 /** Struct defining a stack of mutexes.
  */
 typedef struct {
@@ -380,7 +423,8 @@ typedef struct uAtClientInstance_t {
     uAtClientDeviceError_t deviceError; /** The error reported by the AT server. */
     uAtClientScope_t scope; /** The scope, where we're at in the AT command. */
     uAtClientTag_t stopTag; /** The stop tag for the current scope. */
-    uAtClientUrc_t *pUrcList; /** Linked-list anchor for URC handlers. */
+    uAtClientUrcNode_t *pUrcTrie; /** The first level of the URC prefix trie. */
+    size_t urcOrderNext; /** The order value to give to the next URC added. */
     int64_t lastResponseStopMs; /** The time the last response ended in milliseconds. */
     int64_t lockTimeMs; /** The time when the stream was locked. */
     int64_t lastTxTimeMs; /** The time when the last transmit activity was carried out, set to -1 initially. */
@@ -403,6 +447,7 @@ typedef struct uAtClientInstance_t {
                                    as its fourth parameter. */
     uAtClientWakeUp_t *pWakeUp; /** Pointer to a wake-up handler structure. */
     uAtClientActivityPin_t *pActivityPin; /** Pointer to an activity pin structure. */
+    uAtClientStats_t *pStats; /** Pointer to the statistics, NULL if they are off. */
     struct uAtClientInstance_t *pNext;
 } uAtClientInstance_t;
 
@@ -517,7 +562,7 @@ static void logDebug(const uAtClientInstance_t *pClient,
         pDebug->pClient = pClient;
         pDebug->inUrc = inUrc;
 
-        pDebug->pDataBufferStart = U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer);
+        pDebug->pDataBufferStart = U_AT_CLIENT_DATA_WINDOW_PTR(pClient->pReceiveBuffer);
         pDebug->dataBufferSize = pClient->pReceiveBuffer->dataBufferSize;
         pDebug->dataBufferLength = pClient->pReceiveBuffer->length;
         pDebug->dataBufferLengthBuffered = pClient->pReceiveBuffer->lengthBuffered;
@@ -625,12 +670,160 @@ static void removeAtClientInstance(const uAtClientInstance_t *pClient)
     }
 }
 
+// Find the URC whose prefix matches the start of pData, returning
+// NULL if there is none; if more than one prefix matches, e.g.
+// "+UUSO" and "+UUSORD:", the URC added most recently wins.
+static uAtClientUrc_t *pUrcTrieMatch(const uAtClientUrcNode_t *pNode,
+                                     const char *pData, size_t length)
+{
+    uAtClientUrc_t *pUrc = NULL;
+
+    for (size_t x = 0; (pNode != NULL) && (x < length); x++) {
+        // Siblings are in character order so we can stop
+        // looking as soon as we have gone past the character
+        while ((pNode != NULL) &&
+               ((unsigned char) pNode->character < (unsigned char) * (pData + x))) {
+            pNode = pNode->pSibling;
+        }
+        if ((pNode != NULL) && (pNode->character == *(pData + x))) {
+            if ((pNode->pUrc != NULL) &&
+                ((pUrc == NULL) || (pNode->pUrc->order > pUrc->order))) {
+                pUrc = pNode->pUrc;
+            }
+            pNode = pNode->pChild;
+        } else {
+            pNode = NULL;
+        }
+    }
+
+    return pUrc;
+}
+
+// Find the node at the end of the given prefix, which must not
+// be empty, returning NULL if there is none.
+static uAtClientUrcNode_t *pUrcTrieNode(uAtClientUrcNode_t *pNode,
+                                        const char *pPrefix)
+{
+    uAtClientUrcNode_t *pFound = NULL;
+
+    while ((pNode != NULL) && (pFound == NULL)) {
+        while ((pNode != NULL) && (pNode->character != *pPrefix)) {
+            pNode = pNode->pSibling;
+        }
+        if (pNode != NULL) {
+            pPrefix++;
+            if (*pPrefix == 0) {
+                pFound = pNode;
+            }
+            pNode = pNode->pChild;
+        }
+    }
+
+    return pFound;
+}
+
+// Free any nodes along the given path through the trie, starting
+// at the level *ppLevel, that no longer lead to a URC.
+static void urcTriePrune(uAtClientUrcNode_t **ppLevel,
+                         const char *pPath, size_t length)
+{
+    uAtClientUrcNode_t *pNode;
+
+    if (length > 0) {
+        while ((*ppLevel != NULL) && ((*ppLevel)->character != *pPath)) {
+            ppLevel = &((*ppLevel)->pSibling);
+        }
+        pNode = *ppLevel;
+        if (pNode != NULL) {
+            urcTriePrune(&(pNode->pChild), pPath + 1, length - 1);
+            if ((pNode->pUrc == NULL) && (pNode->pChild == NULL)) {
+                *ppLevel = pNode->pSibling;
+                free(pNode);
+            }
+        }
+    }
+}
+
+// Add a URC, which must have a prefix that is not empty and
+// not already in the trie, to the trie whose first level is at
+// *ppLevel.  Returns false if there is not enough memory.
+static bool urcTrieAdd(uAtClientUrcNode_t **ppLevel,
+                       uAtClientUrc_t *pUrc)
+{
+    uAtClientUrcNode_t **ppFirst = ppLevel;
+    uAtClientUrcNode_t *pNode = NULL;
+    const char *pPrefix = pUrc->pPrefix;
+    size_t x;
+
+    for (x = 0; (ppLevel != NULL) && (x < pUrc->prefixLength); x++) {
+        // Find the node for this character, in order
+        while ((*ppLevel != NULL) &&
+               ((unsigned char) (*ppLevel)->character < (unsigned char) * (pPrefix + x))) {
+            ppLevel = &((*ppLevel)->pSibling);
+        }
+        pNode = *ppLevel;
+        if ((pNode == NULL) || (pNode->character != *(pPrefix + x))) {
+            // Not there, add it
+            pNode = (uAtClientUrcNode_t *) malloc(sizeof(uAtClientUrcNode_t));
+            if (pNode != NULL) {
+                memset(pNode, 0, sizeof(*pNode));
+                pNode->character = *(pPrefix + x);
+                pNode->pSibling = *ppLevel;
+                *ppLevel = pNode;
+            }
+        }
+        ppLevel = NULL;
+        if (pNode != NULL) {
+            ppLevel = &(pNode->pChild);
+        }
+    }
+
+    if (ppLevel != NULL) {
+        pNode->pUrc = pUrc;
+    } else {
+        // Out of memory: remove any nodes that were added
+        urcTriePrune(ppFirst, pPrefix, x);
+    }
+
+    return ppLevel != NULL;
+}
+
+// Free a level of the URC trie, everything below it and the URCs.
+static void urcTrieFree(uAtClientUrcNode_t *pNode)
+{
+    uAtClientUrcNode_t *pSibling;
+
+    while (pNode != NULL) {
+        pSibling = pNode->pSibling;
+        urcTrieFree(pNode->pChild);
+        free(pNode->pUrc);
+        free(pNode);
+        pNode = pSibling;
+    }
+}
+
+// Remove the callback that an AT client has on its stream.
+static void streamCallbackRemove(const uAtClientInstance_t *pClient)
+{
+    switch (pClient->streamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            uPortUartEventCallbackRemove(pClient->streamHandle);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_EDM:
+            uShortRangeEdmStreamAtCallbackRemove(pClient->streamHandle);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            uCellMuxStreamCallbackRemove(pClient->streamHandle);
+            break;
+        default:
+            break;
+    }
+}
+
 // Remove an AT client.
 // gMutex should be locked before this is called.
 static void removeClient(uAtClientInstance_t *pClient)
 {
-    uAtClientUrc_t *pUrc;
-
     // Must not be in a wake-up handler
     U_ASSERT((pClient->pWakeUp == NULL) ||
              ((uPortMutexTryLock(pClient->pWakeUp->inWakeUpHandlerMutex, 0) == 0) &&
@@ -651,27 +844,18 @@ static void removeClient(uAtClientInstance_t *pClient)
     // Remove the URC event handler, which may be running
     // asynchronous stuff and so has to be flushed and
     // closed before we mess with anything else
-    switch (pClient->streamType) {
-        case U_AT_CLIENT_STREAM_TYPE_UART:
-            uPortUartEventCallbackRemove(pClient->streamHandle);
-            break;
-        case U_AT_CLIENT_STREAM_TYPE_EDM:
-            uShortRangeEdmStreamAtCallbackRemove(pClient->streamHandle);
-            break;
-        default:
-            break;
-    }
+    streamCallbackRemove(pClient);
 
     // Free any URC handlers it had.
-    while (pClient->pUrcList != NULL) {
-        pUrc = pClient->pUrcList;
-        pClient->pUrcList = pUrc->pNext;
-        free(pUrc);
-    }
+    urcTrieFree(pClient->pUrcTrie);
+    pClient->pUrcTrie = NULL;
 
     // Remove any activity pin
     free(pClient->pActivityPin);
 
+    // Remove any statistics
+    free(pClient->pStats);
+
     // Free the receive buffer if it was malloc()ed.
     if (pClient->pReceiveBuffer->isMalloced) {
         free(pClient->pReceiveBuffer);
@@ -878,6 +1062,104 @@ static void printAt(const uAtClientInstance_t *pClient,
         }
     }
 }
+// Find the statistics entry for the given prefix, adding it if
+// there is room, else returning the relevant catch-all entry.
+// The stream mutex should be locked before this is called.
+static uAtClientStatsEntry_t *pStatsEntry(uAtClientStats_t *pStats,
+                                          const char *pPrefix,
+                                          size_t prefixLength,
+                                          bool isUrc)
+{
+    uAtClientStatsEntry_t *pEntries = (uAtClientStatsEntry_t *) (pStats + 1);
+    uAtClientStatsEntry_t *pEntry = NULL;
+
+    if (prefixLength > U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES) {
+        prefixLength = U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES;
+    }
+    for (size_t x = 0; (x < pStats->numEntries) && (pEntry == NULL); x++) {
+        if ((pEntries[x].isUrc == isUrc) &&
+            (strncmp(pEntries[x].prefix, pPrefix, prefixLength) == 0) &&
+            (pEntries[x].prefix[prefixLength] == 0)) {
+            pEntry = &(pEntries[x]);
+        }
+    }
+    if (pEntry == NULL) {
+        if (pStats->numEntries < pStats->maxNumEntries) {
+            pEntry = &(pEntries[pStats->numEntries]);
+            memset(pEntry, 0, sizeof(*pEntry));
+            memcpy(pEntry->prefix, pPrefix, prefixLength);
+            pEntry->isUrc = isUrc;
+            pStats->numEntries++;
+        } else {
+            pEntry = &(pEntries[pStats->maxNumEntries + (isUrc ? 1 : 0)]);
+        }
+    }
+
+    return pEntry;
+}
+
+// Clear the statistics, including the entries that follow them.
+static void statsClear(uAtClientStats_t *pStats, size_t maxNumEntries)
+{
+    memset(pStats, 0, sizeof(uAtClientStats_t) +
+           (sizeof(uAtClientStatsEntry_t) * (maxNumEntries + 2)));
+    pStats->maxNumEntries = maxNumEntries;
+    // The last entry is the catch-all for URCs
+    ((uAtClientStatsEntry_t *) (pStats + 1))[maxNumEntries + 1].isUrc = true;
+}
+
+// Add a time to a statistics entry.
+static void statsAddTime(uAtClientStatsEntry_t *pEntry, int64_t timeMs)
+{
+    if (timeMs < 0) {
+        timeMs = 0;
+    } else if (timeMs > INT_MAX) {
+        timeMs = INT_MAX;
+    }
+    pEntry->totalTimeMs += (int32_t) timeMs;
+    if (timeMs > pEntry->maxTimeMs) {
+        pEntry->maxTimeMs = (int32_t) timeMs;
+    }
+}
+
+// Finish the statistics for the AT command in progress, if there
+// is one, the end being the last response stop or, if there
+// hasn't been one since the command was started, now.
+// The stream mutex should be locked before this is called.
+static void statsCommandStop(uAtClientInstance_t *pClient)
+{
+    uAtClientStats_t *pStats = pClient->pStats;
+    int64_t stopTimeMs;
+
+    if ((pStats != NULL) && (pStats->pCurrent != NULL)) {
+        stopTimeMs = pClient->lastResponseStopMs;
+        if (stopTimeMs < pStats->startTimeMs) {
+            stopTimeMs = uPortGetTickTimeMs();
+        }
+        statsAddTime(pStats->pCurrent, stopTimeMs - pStats->startTimeMs);
+        pStats->pCurrent = NULL;
+    }
+}
+
+// Add the time spent in a URC handler to the statistics.
+// The stream mutex should be locked before this is called.
+static void statsUrc(const uAtClientInstance_t *pClient,
+                     const char *pPrefix, size_t prefixLength,
+                     int64_t timeMs)
+{
+    uAtClientStats_t *pStats = pClient->pStats;
+    uAtClientStatsEntry_t *pEntry;
+
+    if (pStats != NULL) {
+        pEntry = pStatsEntry(pStats, pPrefix, prefixLength, true);
+        pEntry->count++;
+        statsAddTime(pEntry, timeMs);
+        if (pStats->pCurrent != NULL) {
+            // Don't charge the AT command in progress for the URC
+            pStats->startTimeMs += timeMs;
+        }
+    }
+}
 
 // Set error.
 static void setError(uAtClientInstance_t *pClient,
@@ -911,6 +1193,9 @@ static void consecutiveTimeout(uAtClientInstance_t *pClient)
     U_PORT_MUTEX_LOCK(gMutexEventQueue);
 
     pClient->numConsecutiveAtTimeouts++;
+    if ((pClient->pStats != NULL) && (pClient->pStats->pCurrent != NULL)) {
+        pClient->pStats->pCurrent->numTimeouts++;
+    }
     if (pClient->pConsecutiveTimeoutsCallback != NULL) {
         // pConsecutiveTimeoutsCallback second parameter
         // is an int32_t pointer but of course the generic
@@ -965,34 +1250,43 @@ static void bufferReset(const uAtClientInstance_t *pClient,
     // the buffered data can be reset also
     if (totalReset || (pClient->pInterceptRx == NULL)) {
         pBuffer->lengthBuffered = 0;
+        pBuffer->interceptIndex = 0;
     }
 
     if (pBuffer->lengthBuffered > 0) {
         LOG_IF(!totalReset, 201);
-        if (pBuffer->length > pBuffer->lengthBuffered) {
+        if ((pBuffer->interceptIndex < pBuffer->length) ||
+            (pBuffer->interceptIndex > pBuffer->lengthBuffered)) {
             // This should never occur, but if it did
             // it would not be good so best be safe.
             if (pClient->debugOn) {
                 uPortLog("U_AT_CLIENT_%d-%d: *** WARNING ***"
-                         " lengthBuffered (%d) > length (%d).\n",
-                         pBuffer->lengthBuffered, pBuffer->length);
+                         " interceptIndex (%d) outside length (%d)"
+                         " to lengthBuffered (%d).\n",
+                         pClient->streamType, pClient->streamHandle,
+                         pBuffer->interceptIndex, pBuffer->length,
+                         pBuffer->lengthBuffered);
+            }
+            pBuffer->interceptIndex = pBuffer->length;
+            if (pBuffer->interceptIndex > pBuffer->lengthBuffered) {
+                pBuffer->interceptIndex = pBuffer->lengthBuffered;
             }
-            pBuffer->length = pBuffer->lengthBuffered;
         }
-        // If there is stuff buffered, which will be beyond
-        // length, need to move that down when we reset
-        memmove(((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t),
-                ((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t) + pBuffer->length,
-                pBuffer->lengthBuffered - pBuffer->length);
-        U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBuffer));
-        pBuffer->lengthBuffered -= pBuffer->length;
+        // If there is stuff buffered, which will be at
+        // interceptIndex, just move the window up to it
+        pBuffer->startIndex += pBuffer->interceptIndex;
+        pBuffer->lengthBuffered -= pBuffer->interceptIndex;
+    }
+    if (pBuffer->lengthBuffered == 0) {
+        pBuffer->startIndex = 0;
     }
     pBuffer->readIndex = 0;
     pBuffer->length = 0;
+    pBuffer->interceptIndex = 0;
 }
 
-// Set the read position to 0 and move the buffer's
-// unread content to the beginning.
+// Set the read position to 0 by moving the start of the
+// window up to the unread content.
 static void bufferRewind(const uAtClientInstance_t *pClient)
 {
     uAtClientReceiveBuffer_t *pBuffer = pClient->pReceiveBuffer;
@@ -1010,20 +1304,43 @@ static void bufferRewind(const uAtClientInstance_t *pClient)
             }
             pBuffer->lengthBuffered = pBuffer->readIndex;
         }
+        if (pBuffer->interceptIndex < pBuffer->readIndex) {
+            pBuffer->interceptIndex = pBuffer->readIndex;
+        }
         pBuffer->length -= pBuffer->readIndex;
         pBuffer->lengthBuffered -= pBuffer->readIndex;
+        pBuffer->interceptIndex -= pBuffer->readIndex;
         LOG(101);
-        // Move what has not been read to the
-        // beginning of the buffer
-        memmove(((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t),
-                ((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t) + pBuffer->readIndex,
-                pBuffer->lengthBuffered);
-        U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBuffer));
+        // Move the window up to what has not been read,
+        // or back to the start of the buffer if that's nothing
+        pBuffer->startIndex += pBuffer->readIndex;
+        if (pBuffer->lengthBuffered == 0) {
+            pBuffer->startIndex = 0;
+        }
         pBuffer->readIndex = 0;
         LOG(102);
     }
 }
 
+// Move the window down to the start of the data buffer,
+// closing up any gap between the readable data and the
+// data still to be processed by an intercept function.
+static void bufferCompact(const uAtClientInstance_t *pClient)
+{
+    uAtClientReceiveBuffer_t *pBuffer = pClient->pReceiveBuffer;
+    char *pStart = U_AT_CLIENT_DATA_BUFFER_PTR(pBuffer);
+
+    LOG(300);
+    memmove(pStart, pStart + pBuffer->startIndex, pBuffer->length);
+    memmove(pStart + pBuffer->length,
+            pStart + pBuffer->startIndex + pBuffer->interceptIndex,
+            pBuffer->lengthBuffered - pBuffer->interceptIndex);
+    U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBuffer));
+    pBuffer->lengthBuffered -= pBuffer->interceptIndex - pBuffer->length;
+    pBuffer->interceptIndex = pBuffer->length;
+    pBuffer->startIndex = 0;
+}
+
 // This is where data comes into the AT client.
 // Read from the stream into the receive buffer.
 // Returns true on a successful read or false on timeout.
@@ -1035,10 +1352,10 @@ static bool bufferFill(uAtClientInstance_t *pClient,
     int32_t readLength = 0;
     size_t x = 0;
     size_t y = 0;
-    size_t z = 0;
-    size_t length;
+    size_t length = 0;
     bool eventIsCallback = false;
     char *pData = NULL;
+    char *pWindow;
     //lint -esym(838, pDataIntercept) Suppress initial value not used: it
     // is if detailed debugging is on
     char *pDataIntercept = NULL;
@@ -1051,6 +1368,9 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             eventIsCallback = uShortRangeEdmStreamAtEventIsCallback(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            eventIsCallback = uCellMuxStreamEventIsCallback(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -1068,28 +1388,41 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
         pReceiveBuffer->lengthBuffered = pReceiveBuffer->length;
     }
+    if ((pReceiveBuffer->interceptIndex < pReceiveBuffer->length) ||
+        (pReceiveBuffer->interceptIndex > pReceiveBuffer->lengthBuffered)) {
+        // Same here
+        pReceiveBuffer->interceptIndex = pReceiveBuffer->length;
+    }
 
-    length = pReceiveBuffer->lengthBuffered - pReceiveBuffer->length;
-
-    // The receive buffer looks like this:
+    // The data buffer looks like this:
     //
-    // +--------+-------------+-------------------------------+
-    // |  read  |    unread   |            buffered           |
-    // +--------+-------------+-------------------------------+
-    //      readIndex       length                       lengthBuffered
+    //          |<-------------------------- window ----------------------------->|
+    // +--------+--------+-------------+---------+----------------------+----------+
+    // | unused |  read  |    unread   | consumed |        buffered      |  unused  |
+    // +--------+--------+-------------+---------+----------------------+----------+
+    //      startIndex readIndex     length  interceptIndex      lengthBuffered
     //
-    // Up to "length" is stuff that is AT command stuff or whatever
-    // received from the UART, readIndex is how far into that has
-    // been read off by the AT parsing code.  Normally "length" and
+    // The indexes are all relative to startIndex.  Up to "length"
+    // is stuff that is AT command stuff or whatever received from
+    // the UART, readIndex is how far into that has been read off by
+    // the AT parsing code.  Normally "length", interceptIndex and
     // "lengthBuffered" are the same, they only differ if there is
     // an active intercept function, e.g. for C2C security; stuff
-    // between "length" and lengthBuffered has not yet been
+    // between interceptIndex and lengthBuffered has not yet been
     // processed by the intercept function (e.g. it's just new or
     // there's not enough of it to form some sort of frame structure
     // that the intercept function needs).  The intercept function
-    // reads the stuff between "length" and lengthBuffered at which
-    // point it may make it available as normal stuff which this
-    // function then copies down into the unread part of "length".
+    // reads the stuff from interceptIndex onwards at which point it
+    // may make it available as normal stuff which this function then
+    // copies down into the unread part of "length", moving
+    // interceptIndex on past what was consumed; nothing
+    // else is moved.
+    //
+    // As stuff is read and discarded startIndex moves up; when
+    // the window is empty startIndex is put back to zero and
+    // otherwise, when there is more room to be gained at the
+    // start of the buffer (and between "length" and interceptIndex)
+    // than there is left at the end, the window is moved down.
 
     LOG_BUFFER_FILL(1);
 
@@ -1102,6 +1435,13 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
     }
 
+    // Move the window down if it is running out of room
+    if (pReceiveBuffer->dataBufferSize - pReceiveBuffer->startIndex -
+        pReceiveBuffer->lengthBuffered < pReceiveBuffer->startIndex +
+        (pReceiveBuffer->interceptIndex - pReceiveBuffer->length)) {
+        bufferCompact(pClient);
+    }
+
     // Reset buffer if it has become full
     if (pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) {
 #if U_CFG_OS_CLIB_LEAKS
@@ -1113,7 +1453,7 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                 uPortLog("U_AT_CLIENT_%d-%d: !!! overflow.\n",
                          pClient->streamType, pClient->streamHandle);
             }
-            printAt(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer),
+            printAt(pClient, U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer),
                     pReceiveBuffer->length);
 #if U_CFG_OS_CLIB_LEAKS
         }
@@ -1122,28 +1462,38 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         bufferReset(pClient, true);
     }
 
+    pWindow = U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer);
+    // length starts out as the amount of data that has not yet
+    // been successfully processed by the intercept function
+    length = pReceiveBuffer->lengthBuffered - pReceiveBuffer->interceptIndex;
     // Set up the pointer for the intercept function,
     // if there is one
-    pDataIntercept = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                     pReceiveBuffer->length;
+    pDataIntercept = pWindow + pReceiveBuffer->interceptIndex;
     LOG_BUFFER_FILL(3);
     // Do the read
     do {
         switch (pClient->streamType) {
             case U_AT_CLIENT_STREAM_TYPE_UART:
                 readLength = uPortUartRead(pClient->streamHandle,
-                                           U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                                           pReceiveBuffer->lengthBuffered,
+                                           pWindow + pReceiveBuffer->lengthBuffered,
                                            pReceiveBuffer->dataBufferSize -
+                                           pReceiveBuffer->startIndex -
                                            pReceiveBuffer->lengthBuffered);
                 break;
             case U_AT_CLIENT_STREAM_TYPE_EDM:
                 readLength = uShortRangeEdmStreamAtRead(pClient->streamHandle,
-                                                        U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                                                        pReceiveBuffer->length,
+                                                        pWindow + pReceiveBuffer->length,
                                                         pReceiveBuffer->dataBufferSize -
+                                                        pReceiveBuffer->startIndex -
                                                         pReceiveBuffer->length);
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                readLength = uCellMuxStreamRead(pClient->streamHandle,
+                                                pWindow + pReceiveBuffer->lengthBuffered,
+                                                pReceiveBuffer->dataBufferSize -
+                                                pReceiveBuffer->startIndex -
+                                                pReceiveBuffer->lengthBuffered);
+                break;
             default:
                 break;
         }
@@ -1155,9 +1505,10 @@ static bool bufferFill(uAtClientInstance_t *pClient,
             // available in the buffer for the AT client as
             // there may be an intercept function in the way
             pReceiveBuffer->lengthBuffered += readLength;
-            // length starts out as the amount of data that has not yet
-            // been successfully processed by the intercept function
             length += readLength;
+            if ((pClient->pStats != NULL) && (pClient->pStats->pCurrent != NULL)) {
+                pClient->pStats->pCurrent->rxBytes += readLength;
+            }
         }
         x = length;
         LOG_BUFFER_FILL(5);
@@ -1190,81 +1541,35 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                     LOG_BUFFER_FILL(8);
                     // length is the amount of usable data but it may
                     // be somewhere further on in the buffer (as
-                    // pointed to by pData) so copy everything down in
-                    // the buffer to make it contiguous.
+                    // pointed to by pData) so copy it down to join
+                    // the end of the "unread" section.  The intercept
+                    // function will have moved pDataIntercept on to
+                    // somewhere beyond the end of the processed data;
+                    // whatever is beyond pDataIntercept stays where it
+                    // is, what is between the two is just ignored.
                     //
-                    // In the picture of the buffer below, "read" is stuff
-                    // the AT client has dealt with, "unread" is stuff that
-                    // has been processed by the intercept function but the AT
-                    // client hasn't looked at yet and "buffered" is stuff
-                    // that the intercept function has yet to process. pData
-                    // is somewhere inside "buffered", pointing to our new
-                    // "length" of processed data.  The intercept function
-                    // will have moved pDataIntercept to somewhere beyond the
-                    // end of "length".
-                    //
-                    // +--------+-------------+-------------------------------+
-                    // |  read  |    unread   |            buffered           |
-                    // +--------+-------------+----------+--------------------+
-                    //       pRB->rI   pRB->l + readLength                pRB->lB
-                    //                        |----------------X--------------|
-                    //                        |----------|- length -|
-                    //                                 pData
-                    //                        |----------+--------------|
-                    //                                             pDataIntercept
-
-                    // First, move the processed stuff, "length" from pData onwards,
-                    // down to join the end of the "unread" section.
-                    memmove(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                            pReceiveBuffer->length + readLength,
+                    // +-----------+------------------------------------------+
+                    // |   unread  |                  buffered                |
+                    // +-----------+-----------+--------------+---------------+
+                    //      pRB->l + readLength                          pRB->lB
+                    //             |-------------------- X -------------------|
+                    //                         |-- length --|
+                    //                       pData
+                    //                                              |--- Y ---|
+                    //                                       pDataIntercept
+                    memmove(pWindow + pReceiveBuffer->length + readLength,
                             pData, length);
                     U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pReceiveBuffer));
-
-                    // We now have:
-                    //
-                    // +--------+-------------+-------------------------------+
-                    // |  read  |    unread   |            buffered           |
-                    // +--------+-------------+-------- ----------------------+
-                    //       pRB->rI   pRB->l + readLength                pRB->lB
-                    //                        |----------------X--------------|
-                    //                        |-length-|
-                    //                        |-------------------------|
-                    //                                             pDataIntercept
-                    //                                                  |- Y -|
-                    //                                 |------ Z -------|
-
-                    // Now we want to move the remaining unprocessed stuff,
-                    // from pDataIntercept up to lengthBuffered, down to join
-                    // the end of "length".
-                    // y is how much stuff there is to move.
-                    if (pDataIntercept > (U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                                          pReceiveBuffer->lengthBuffered)) {
+                    if (pDataIntercept > pWindow + pReceiveBuffer->lengthBuffered) {
                         // This should never occur, but if it did
                         // it would not be good so best be safe.
                         // No print here as it would likely overload
                         // things as we're in a loop
-                        pDataIntercept = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                                         pReceiveBuffer->lengthBuffered;
+                        pDataIntercept = pWindow + pReceiveBuffer->lengthBuffered;
                     }
-                    y = (U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                         pReceiveBuffer->lengthBuffered) - pDataIntercept;
+                    // y is how much stuff is left to be processed
+                    y = (pWindow + pReceiveBuffer->lengthBuffered) - pDataIntercept;
                     LOG_BUFFER_FILL(9);
-                    // Move it
-                    memmove(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                            pReceiveBuffer->length + readLength + length,
-                            pDataIntercept, y);
-                    U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pReceiveBuffer));
-                    // Lastly, we need to adjust the things that were at or
-                    // beyond pDataIntercept to take account of the move.
-                    // z is how far things were moved
-                    z = pDataIntercept -
-                        ((U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                          pReceiveBuffer->length + readLength + length));
-                    LOG_BUFFER_FILL(10);
-                    // Adjust pDataIntercept down by z.
-                    pDataIntercept -= z;
-                    // lengthBuffered is reduced by z
-                    pReceiveBuffer->lengthBuffered -= z;
                     // Add the length as determined by the
                     // intercept function to readLength
                     readLength += (int32_t) length;
@@ -1282,6 +1587,7 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                 }
                 LOG_BUFFER_FILL(13);
             } while (pData != NULL);
+            pReceiveBuffer->interceptIndex = pDataIntercept - pWindow;
         }
 
         LOG_BUFFER_FILL(14);
@@ -1300,15 +1606,16 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         // in a callback as it will leak
         if (!eventIsCallback) {
 #endif
-            printAt(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                    pReceiveBuffer->length + pReceiveBuffer->readIndex,
-                    readLength);
+            printAt(pClient, pWindow + pReceiveBuffer->length, readLength);
 #if U_CFG_OS_CLIB_LEAKS
         }
 #endif
         pReceiveBuffer->length += readLength;
         LOG_BUFFER_FILL(16);
     }
+    if (pClient->pInterceptRx == NULL) {
+        pReceiveBuffer->interceptIndex = pReceiveBuffer->lengthBuffered;
+    }
 
     U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pReceiveBuffer));
 
@@ -1327,7 +1634,7 @@ static int32_t bufferReadChar(uAtClientInstance_t *pClient)
 
     if (pReceiveBuffer->readIndex < pReceiveBuffer->length) {
         // Read from the buffer
-        character = *(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+        character = *(U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer) +
                       pReceiveBuffer->readIndex);
         pReceiveBuffer->readIndex++;
     } else {
@@ -1335,7 +1642,7 @@ static int32_t bufferReadChar(uAtClientInstance_t *pClient)
         bufferReset(pClient, false);
         if (bufferFill(pClient, true)) {
             // Read something, all good
-            character = *(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+            character = *(U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer) +
                           pReceiveBuffer->readIndex);
             pReceiveBuffer->readIndex++;
             pClient->numConsecutiveAtTimeouts = 0;
@@ -1353,6 +1660,64 @@ static int32_t bufferReadChar(uAtClientInstance_t *pClient)
     return character;
 }
 
+// Copy as many bytes as possible, up to maxLength, out of the
+// receive buffer, without bringing more data into it, stopping
+// short of any character that could be the start of the stop
+// tag; pBuffer may be NULL, in which case the bytes are just
+// consumed.  Returns the number of bytes copied.
+static size_t bufferReadRun(const uAtClientInstance_t *pClient,
+                            char *pBuffer, size_t maxLength)
+{
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    const uAtClientTagDef_t *pTagDef = pClient->stopTag.pTagDef;
+    const char *pData = U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer) +
+                        pReceiveBuffer->readIndex;
+    const char *pTagStart;
+    size_t length = 0;
+
+    if (pReceiveBuffer->length > pReceiveBuffer->readIndex) {
+        length = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+        if (length > maxLength) {
+            length = maxLength;
+        }
+        if (pTagDef->length > 0) {
+            // Anything up to the first character of the stop
+            // tag can't be part of the stop tag
+            pTagStart = (const char *) memchr(pData, *(pTagDef->pString), length);
+            if (pTagStart != NULL) {
+                length = pTagStart - pData;
+            }
+        }
+        if ((pBuffer != NULL) && (length > 0)) {
+            memcpy(pBuffer, pData, length);
+        }
+        pReceiveBuffer->readIndex += length;
+    }
+
+    return length;
+}
+
+// Move the stop tag match position, *pMatchPos, on by the
+// given character, returning true if the stop tag is now
+// complete; the stop tag must not be zero length.
+static bool stopTagMatch(const uAtClientTagDef_t *pTagDef,
+                         int32_t *pMatchPos, char character)
+{
+    if (character == *(pTagDef->pString + *pMatchPos)) {
+        (*pMatchPos)++;
+    } else {
+        // If it wasn't a stop tag, reset
+        // the match position and check again
+        // in case it is the start of a new stop tag
+        *pMatchPos = 0;
+        if (character == *(pTagDef->pString)) {
+            (*pMatchPos)++;
+        }
+    }
+
+    return *pMatchPos == (int32_t) pTagDef->length;
+}
+
 // Look for pString in the current receive buffer,
 // without bringing more data into it, and if the string
 // is there consume it.
@@ -1365,7 +1730,7 @@ static bool bufferMatch(const uAtClientInstance_t *pClient,
     bufferRewind(pClient);
 
     if ((pReceiveBuffer->length - pReceiveBuffer->readIndex) >= length) {
-        if (pString && (memcmp(U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer) +
+        if (pString && (memcmp(U_AT_CLIENT_DATA_WINDOW_PTR(pClient->pReceiveBuffer) +
                                pReceiveBuffer->readIndex,
                                pString, length) == 0)) {
             // Consume the matching part
@@ -1498,39 +1863,41 @@ static void informationResponseStop(uAtClientInstance_t *pClient)
 // up to CR/LF.
 static bool bufferMatchOneUrc(uAtClientInstance_t *pClient)
 {
-    size_t prefixLength = 0;
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    uAtClientUrc_t *pUrc;
     bool found = false;
     int64_t now;
     uErrorCode_t savedError;
 
     bufferRewind(pClient);
 
-    for (uAtClientUrc_t *pUrc = pClient->pUrcList;
-         !found && (pUrc != NULL);
-         pUrc = pUrc->pNext) {
-        prefixLength = pUrc->prefixLength;
-        if (pClient->pReceiveBuffer->length >= prefixLength) {
-            if (bufferMatch(pClient, pUrc->pPrefix, prefixLength)) {
-                setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
-                now = uPortGetTickTimeMs();
-                // Before heading off into URCness, save
-                // the current error state and reset
-                // it so that the URC doesn't suffer the error
-                savedError = pClient->error;
-                pClient->error = U_ERROR_COMMON_SUCCESS;
-                if (pUrc->pHandler) {
-                    pUrc->pHandler(pClient, pUrc->pHandlerParam);
-                }
-                informationResponseStop(pClient);
-                // Put the error state back again
-                pClient->error = savedError;
-                // Put the error state back again
-                // Add the amount of time spent in the URC
-                // world to the start time
-                pClient->lockTimeMs += uPortGetTickTimeMs() - now;
-                found = true;
-            }
+    // One pass through the trie finds the URC, if there is one
+    pUrc = pUrcTrieMatch(pClient->pUrcTrie,
+                         U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer) +
+                         pReceiveBuffer->readIndex,
+                         pReceiveBuffer->length - pReceiveBuffer->readIndex);
+    if (pUrc != NULL) {
+        // Consume the prefix
+        pReceiveBuffer->readIndex += pUrc->prefixLength;
+        setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
+        now = uPortGetTickTimeMs();
+        // Before heading off into URCness, save
+        // the current error state and reset
+        // it so that the URC doesn't suffer the error
+        savedError = pClient->error;
+        pClient->error = U_ERROR_COMMON_SUCCESS;
+        if (pUrc->pHandler) {
+            pUrc->pHandler(pClient, pUrc->pHandlerParam);
         }
+        informationResponseStop(pClient);
+        // Put the error state back again
+        pClient->error = savedError;
+        // Add the amount of time spent in the URC
+        // world to the start time
+        now = uPortGetTickTimeMs() - now;
+        pClient->lockTimeMs += now;
+        statsUrc(pClient, pUrc->pPrefix, pUrc->prefixLength, now);
+        found = true;
     }
 
     return found;
@@ -1618,20 +1985,8 @@ static int32_t readString(uAtClientInstance_t *pClient,
                          U_ERROR_COMMON_DEVICE_ERROR);
             } else if (pStopTag->pTagDef->length > 0) {
                 // It could be a stop tag
-                if (c == *(pStopTag->pTagDef->pString + matchPos)) {
-                    matchPos++;
-                } else {
-                    // If it wasn't a stop tag, reset
-                    // the match position and check again
-                    // in case it is the start of a new stop tag
-                    matchPos = 0;
-                    if (c == *(pStopTag->pTagDef->pString)) {
-                        matchPos++;
-                    }
-                }
-                if (matchPos == (int32_t) pStopTag->pTagDef->length) {
-                    pStopTag->found = true;
-                }
+                pStopTag->found = stopTagMatch(pStopTag->pTagDef,
+                                               &matchPos, (char) c);
             }
         }
     }
@@ -1761,12 +2116,14 @@ static bool processResponse(uAtClientInstance_t *pClient,
                         // If no matches were found, see if there's
                         // a CR/LF in the buffer with some characters
                         // between it and where we are now to read
-                        pTmp = pMemStr(U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer) +
+                        pTmp = pMemStr(U_AT_CLIENT_DATA_WINDOW_PTR(pClient->pReceiveBuffer) +
+                                       pClient->pReceiveBuffer->readIndex,
+                                       pClient->pReceiveBuffer->length -
                                        pClient->pReceiveBuffer->readIndex,
-                                       pClient->pReceiveBuffer->length,
                                        U_AT_CLIENT_CRLF, U_AT_CLIENT_CRLF_LENGTH_BYTES);
                         if ((pTmp != NULL) &&
-                            (pTmp - U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer)) > 0) {
+                            (pTmp - (U_AT_CLIENT_DATA_WINDOW_PTR(pClient->pReceiveBuffer) +
+                                     pClient->pReceiveBuffer->readIndex)) > 0) {
                             // There is a CR/LF after some stuff
                             // to read and there was no prefix,
                             // so return now so that the caller
@@ -1834,6 +2191,8 @@ static size_t write(uAtClientInstance_t *pClient,
     const char *pDataToWrite = pData;
     int64_t savedLockTimeMs;
     int64_t wakeUpDurationMs = 0;
+    uAtClientStatsEntry_t *pSavedStatsEntry = NULL;
+    int64_t savedStatsStartTimeMs = 0;
     uAtClientScope_t savedScope;
     uAtClientTag_t savedStopTag;
     bool savedDelimiterRequired;
@@ -1868,6 +2227,11 @@ static size_t write(uAtClientInstance_t *pClient,
             savedStopTag = pClient->stopTag;
             savedDelimiterRequired = pClient->delimiterRequired;
             savedDeviceError = pClient->deviceError;
+            if (pClient->pStats != NULL) {
+                pSavedStatsEntry = pClient->pStats->pCurrent;
+                savedStatsStartTimeMs = pClient->pStats->startTimeMs;
+                pClient->pStats->pCurrent = NULL;
+            }
             // Reset the scope, stopTag and delimiterRequired
             pClient->scope = U_AT_CLIENT_SCOPE_NONE;
             pClient->stopTag.pTagDef = &gNoStopTag;
@@ -1899,6 +2263,12 @@ static size_t write(uAtClientInstance_t *pClient,
                 pClient->lockTimeMs = savedLockTimeMs + wakeUpDurationMs;
             } else {
                 pClient->lockTimeMs = uPortGetTickTimeMs();
+                wakeUpDurationMs = 0;
+            }
+            if (pClient->pStats != NULL) {
+                // The wake-up AT commands have their own statistics
+                pClient->pStats->pCurrent = pSavedStatsEntry;
+                pClient->pStats->startTimeMs = savedStatsStartTimeMs + wakeUpDurationMs;
             }
             // We are no longer in the wake-up handler
             uPortMutexUnlock(pClient->pWakeUp->inWakeUpHandlerMutex);
@@ -1940,6 +2310,10 @@ static size_t write(uAtClientInstance_t *pClient,
                     // Write handled in intercept
                     case U_AT_CLIENT_STREAM_TYPE_EDM:
                         break;
+                    case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                        thisLengthWritten = uCellMuxStreamWrite(pClient->streamHandle,
+                                                                pDataToWrite, lengthToWrite);
+                        break;
                     default:
                         break;
                 }
@@ -1961,6 +2335,9 @@ static size_t write(uAtClientInstance_t *pClient,
     // if *everything* was written
     if (pClient->error == U_ERROR_COMMON_SUCCESS) {
         printAt(pClient, pDataStart, length);
+        if ((pClient->pStats != NULL) && (pClient->pStats->pCurrent != NULL)) {
+            pClient->pStats->pCurrent->txBytes += (int32_t) length;
+        }
     } else {
         length = 0;
     }
@@ -1997,17 +2374,9 @@ static bool writeCheckAndDelimit(uAtClientInstance_t *pClient)
 static bool findUrcHandler(const uAtClientInstance_t *pClient,
                            const char *pPrefix)
 {
-    uAtClientUrc_t *pUrc = pClient->pUrcList;
-    bool found = false;
+    uAtClientUrcNode_t *pNode = pUrcTrieNode(pClient->pUrcTrie, pPrefix);
 
-    while ((pUrc != NULL) && !found) {
-        if (strcmp(pPrefix, pUrc->pPrefix) == 0) {
-            found = true;
-        }
-        pUrc = pUrc->pNext;
-    }
-
-    return found;
+    return (pNode != NULL) && (pNode->pUrc != NULL);
 }
 
 // Try to lock the stream: this does NOT clear errors.
@@ -2154,6 +2523,9 @@ static int32_t getReceiveSize(const uAtClientInstance_t *pClient)
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             receiveSize = uShortRangeEdmStreamAtGetReceiveSize(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            receiveSize = uCellMuxStreamGetReceiveSize(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -2210,9 +2582,10 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
                             break;
                         }
                         // If no bufferMatch was found, look for CR/LF
-                    } else if (pMemStr(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                    } else if (pMemStr(U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer) +
+                                       pReceiveBuffer->readIndex,
+                                       pReceiveBuffer->length -
                                        pReceiveBuffer->readIndex,
-                                       pReceiveBuffer->length,
                                        U_AT_CLIENT_CRLF, U_AT_CLIENT_CRLF_LENGTH_BYTES) != NULL) {
                         // Consume everything up to the CR/LF
                         consumeToString(pClient, U_AT_CLIENT_CRLF);
@@ -2253,6 +2626,35 @@ static void urcCallback(int32_t streamHandle, uint32_t eventBitmask,
     }
 }
 
+// Set the callback that an AT client needs on its stream, returning
+// zero on success else negative error code.
+static int32_t streamCallbackSet(uAtClientInstance_t *pClient)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    switch (pClient->streamType) {
+        case U_AT_CLIENT_STREAM_TYPE_UART:
+            errorCode = uPortUartEventCallbackSet(pClient->streamHandle,
+                                                  U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                  urcCallback, pClient,
+                                                  U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                  U_AT_CLIENT_URC_TASK_PRIORITY);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_EDM:
+            errorCode = uShortRangeEdmStreamAtCallbackSet(pClient->streamHandle,
+                                                          urcCallback, pClient);
+            break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            errorCode = uCellMuxStreamCallbackSet(pClient->streamHandle,
+                                                  urcCallback, pClient);
+            break;
+        default:
+            break;
+    }
+
+    return errorCode;
+}
+
 // Callback for the event queue.
 static void eventQueueCallback(void *pParameters, size_t paramLength)
 {
@@ -2265,6 +2667,75 @@ static void eventQueueCallback(void *pParameters, size_t paramLength)
     }
 }
 
+// Return true if the given batch command can be chained onto
+// a line with others: it must be a proper "AT" command and, if
+// its information response is to be parsed, there must be a
+// prefix by which that response can be found.
+static bool batchCommandChainable(const uAtClientBatchCommand_t *pCommand)
+{
+    return (strlen(pCommand->pCommand) >= 2) &&
+           (toupper((int32_t) pCommand->pCommand[0]) == 'A') &&
+           (toupper((int32_t) pCommand->pCommand[1]) == 'T') &&
+           ((pCommand->pResponseParser == NULL) ||
+            (pCommand->pResponsePrefix != NULL));
+}
+
+// Return the number of characters a batch command adds to a
+// chained line, i.e. without the "AT" but with the ';' that
+// V.250 requires after an extended command; the ';' is
+// included even for the last command on a line, which is harmless.
+static size_t batchCommandChainLength(const uAtClientBatchCommand_t *pCommand)
+{
+    const char *pBody = pCommand->pCommand + 2;
+
+    return strlen(pBody) + ((*pBody == '+') ? 1 : 0);
+}
+
+// Send a line made up of numCommands batch commands, the first
+// sent with its "AT", the remainder with it removed, then
+// read the information responses and the final result.
+// The AT client must be locked.
+static int32_t batchSendLine(uAtClientHandle_t atHandle,
+                             const uAtClientBatchCommand_t *pCommands,
+                             size_t numCommands)
+{
+    const uAtClientBatchCommand_t *pCommand;
+    const char *pBody;
+    bool responseStarted = false;
+
+    for (size_t x = 0; x < numCommands; x++) {
+        pCommand = pCommands + x;
+        pBody = pCommand->pCommand;
+        if (x == 0) {
+            uAtClientCommandStart(atHandle, pBody);
+        } else {
+            // The previous command was extended, separate it
+            // from this one
+            if (*(pCommands[x - 1].pCommand + 2) == '+') {
+                uAtClientWritePartialString(atHandle, false, ";");
+            }
+            uAtClientWritePartialString(atHandle, false, pBody + 2);
+        }
+    }
+    uAtClientCommandStop(atHandle);
+    // The information responses come back in command order
+    for (size_t x = 0; x < numCommands; x++) {
+        pCommand = pCommands + x;
+        if (pCommand->pResponseParser != NULL) {
+            responseStarted = true;
+            if (uAtClientResponseStart(atHandle, pCommand->pResponsePrefix) == 0) {
+                pCommand->pResponseParser(atHandle, pCommand->pParameter);
+            }
+        }
+    }
+    if (!responseStarted) {
+        uAtClientResponseStart(atHandle, NULL);
+    }
+    uAtClientResponseStop(atHandle);
+
+    return uAtClientErrorGet(atHandle);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: DETAILED DEBUG ONLY
  * These functions are for detailed debug only, purely for internal
@@ -2427,21 +2898,7 @@ uAtClientHandle_t uAtClientAdd(int32_t streamHandle,
                                        U_AT_CLIENT_MARKER, U_AT_CLIENT_MARKER_SIZE);
                                 // Now add an event handler for characters
                                 // received on the stream
-                                switch (streamType) {
-                                    case U_AT_CLIENT_STREAM_TYPE_UART:
-                                        errorCode = uPortUartEventCallbackSet(streamHandle,
-                                                                              U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
-                                                                              urcCallback, pClient,
-                                                                              U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
-                                                                              U_AT_CLIENT_URC_TASK_PRIORITY);
-                                        break;
-                                    case U_AT_CLIENT_STREAM_TYPE_EDM:
-                                        errorCode = uShortRangeEdmStreamAtCallbackSet(streamHandle, urcCallback, pClient);
-                                        break;
-                                    default:
-                                        // streamType is checked on entry
-                                        break;
-                                }
+                                errorCode = streamCallbackSet(pClient);
                                 if (errorCode == 0) {
                                     // Add the instance to the list
                                     addAtClientInstance(pClient);
@@ -2492,6 +2949,104 @@ void uAtClientRemove(uAtClientHandle_t atHandle)
     }
 }
 
+// Move an AT client to a different stream.
+int32_t uAtClientStreamSet(uAtClientHandle_t atHandle,
+                           int32_t streamHandle,
+                           uAtClientStream_t streamType)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pClient != NULL) && (streamType < U_AT_CLIENT_STREAM_TYPE_MAX)) {
+
+        // Same locking order as removeClient()
+        U_PORT_MUTEX_LOCK(pClient->urcPermittedMutex);
+        U_PORT_MUTEX_LOCK(pClient->streamMutex);
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        if (pClient->streamHandle >= 0) {
+            streamCallbackRemove(pClient);
+        }
+        // Anything buffered belongs to the old stream
+        bufferReset(pClient, true);
+        pClient->streamHandle = streamHandle;
+        pClient->streamType = streamType;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (streamHandle >= 0) {
+            errorCode = streamCallbackSet(pClient);
+            if (errorCode != 0) {
+                pClient->streamHandle = -1;
+            }
+        }
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        U_PORT_MUTEX_UNLOCK(pClient->streamMutex);
+        U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
+    }
+
+    return errorCode;
+}
+
+// Detach a locked AT client from its stream, handing back
+// whatever it has already read.
+int32_t uAtClientStreamDetach(uAtClientHandle_t atHandle,
+                              char *pBuffer, size_t bufferSize)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientReceiveBuffer_t *pReceiveBuffer;
+    size_t length;
+
+    if ((pClient != NULL) && ((pBuffer != NULL) || (bufferSize == 0))) {
+
+        // No need for urcPermittedMutex or streamMutex as in
+        // uAtClientStreamSet(): the caller has the stream locked,
+        // hence the URC callback can't get in
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+
+        pReceiveBuffer = pClient->pReceiveBuffer;
+        length = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+        if (pReceiveBuffer->lengthBuffered > pReceiveBuffer->length) {
+            // There are bytes the intercept function has not yet
+            // processed, which can't be handed back as they are
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+        } else if (length > bufferSize) {
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        } else {
+            if (length > 0) {
+                memcpy(pBuffer, U_AT_CLIENT_DATA_WINDOW_PTR(pReceiveBuffer) +
+                       pReceiveBuffer->readIndex, length);
+            }
+            if (pClient->streamHandle >= 0) {
+                streamCallbackRemove(pClient);
+            }
+            bufferReset(pClient, true);
+            pClient->streamHandle = -1;
+            sizeOrErrorCode = (int32_t) length;
+        }
+
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Get the amount of data uAtClientStreamDetach() would hand back.
+int32_t uAtClientStreamDetachSize(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pClient != NULL) {
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+        sizeOrErrorCode = (int32_t) (pClient->pReceiveBuffer->length -
+                                     pClient->pReceiveBuffer->readIndex);
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Return whether general debug is on or not.
 //lint -e{818} suppress "could be declared as pointing to const": it is!
 bool uAtClientDebugGet(const uAtClientHandle_t atHandle)
@@ -2667,6 +3222,7 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
 
     streamMutex = mutexStackPop(&(pClient->lockedStreamMutexStack));
     if (streamMutex != NULL) {
+        statsCommandStop(pClient);
         unlockNoDataCheck(pClient, streamMutex);
 
         switch (pClient->streamType) {
@@ -2686,6 +3242,14 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
                                                     U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
                 }
                 break;
+            case U_AT_CLIENT_STREAM_TYPE_CMUX:
+                sizeBytes = uCellMuxStreamGetReceiveSize(pClient->streamHandle);
+                if ((sizeBytes > 0) ||
+                    (pClient->pReceiveBuffer->readIndex < pClient->pReceiveBuffer->length)) {
+                    uCellMuxStreamEventSend(pClient->streamHandle,
+                                            U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+                }
+                break;
             default:
                 break;
         }
@@ -2717,6 +3281,19 @@ void uAtClientCommandStart(uAtClientHandle_t atHandle,
             }
         }
 
+        if (pClient->pStats != NULL) {
+            // Finish off any previous AT command sent under
+            // this lock and start on this one
+            statsCommandStop(pClient);
+            if (pCommand != NULL) {
+                pClient->pStats->pCurrent = pStatsEntry(pClient->pStats, pCommand,
+                                                        strcspn(pCommand, "=?"),
+                                                        false);
+                pClient->pStats->pCurrent->count++;
+                pClient->pStats->startTimeMs = uPortGetTickTimeMs();
+            }
+        }
+
         // Send the command, no delimiter at first
         pClient->delimiterRequired = false;
         // Note: allow pCommand to be NULL here only
@@ -2975,6 +3552,7 @@ int32_t uAtClientReadBytes(uAtClientHandle_t atHandle,
     uAtClientTag_t *pStopTag = &(pClient->stopTag);
     int32_t lengthRead = 0;
     int32_t matchPos = 0;
+    char *pData;
     int32_t c;
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
@@ -2982,39 +3560,44 @@ int32_t uAtClientReadBytes(uAtClientHandle_t atHandle,
     while ((lengthRead < ((int32_t) lengthBytes + matchPos)) &&
            (pClient->error == U_ERROR_COMMON_SUCCESS) &&
            !pStopTag->found) {
-        c = bufferReadChar(pClient);
-        if (c == -1) {
-            // Error
-            setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
-        } else {
-            if (pStopTag->pTagDef->length > 0) {
-                // It could be a stop tag
-                if (c == *(pStopTag->pTagDef->pString + matchPos)) {
-                    matchPos++;
+        if (matchPos == 0) {
+            // Not part-way through a stop tag so copy across, in
+            // one go, whatever is already in the receive buffer
+            // up to the next possible start of a stop tag
+            pData = NULL;
+            if (pBuffer != NULL) {
+                pData = pBuffer + lengthRead;
+            }
+            lengthRead += (int32_t) bufferReadRun(pClient, pData,
+                                                  lengthBytes - lengthRead);
+        }
+        if (lengthRead < ((int32_t) lengthBytes + matchPos)) {
+            // The receive buffer is empty or the next character
+            // could be part of a stop tag: deal with it on its own,
+            // the match position carrying across any buffer refill
+            c = bufferReadChar(pClient);
+            if (c == -1) {
+                // Error
+                setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
+            } else {
+                if (pStopTag->pTagDef->length > 0) {
+                    // It could be a stop tag
+                    if (stopTagMatch(pStopTag->pTagDef, &matchPos, (char) c)) {
+                        pStopTag->found = true;
+                        // Remove tag from string if it was matched
+                        lengthRead -= (int32_t) pStopTag->pTagDef->length - 1;
+                    }
                 } else {
-                    // If it wasn't a stop tag, reset
-                    // the match position and check again
-                    // in case it is the start of a new stop tag
+                    // Not anything
                     matchPos = 0;
-                    if (c == *(pStopTag->pTagDef->pString)) {
-                        matchPos++;
-                    }
-                }
-                if (matchPos == (int32_t) pStopTag->pTagDef->length) {
-                    pStopTag->found = true;
-                    // Remove tag from string if it was matched
-                    lengthRead -= (int32_t) pStopTag->pTagDef->length - 1;
                 }
-            } else {
-                // Not anything
-                matchPos = 0;
-            }
-            if (!pStopTag->found) {
-                if (pBuffer != NULL) {
-                    // Add the byte to the buffer
-                    *(pBuffer + lengthRead) = (char) c;
+                if (!pStopTag->found) {
+                    if (pBuffer != NULL) {
+                        // Add the byte to the buffer
+                        *(pBuffer + lengthRead) = (char) c;
+                    }
+                    lengthRead++;
                 }
-                lengthRead++;
             }
         }
     }
@@ -3223,6 +3806,64 @@ int32_t uAtClientWaitCharacter(uAtClientHandle_t atHandle,
     return (int32_t) errorCode;
 }
 
+// Send a batch of AT commands.
+int32_t uAtClientCommandBatch(uAtClientHandle_t atHandle,
+                              const uAtClientBatchCommand_t *pCommands,
+                              size_t numCommands, bool chain,
+                              size_t *pIndexFailed)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    size_t index = 0;
+    size_t lineNumCommands;
+    size_t lineLength;
+    size_t length;
+
+    if ((atHandle != NULL) && ((pCommands != NULL) || (numCommands == 0))) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        uAtClientLock(atHandle);
+        while ((index < numCommands) && (errorCode == 0)) {
+            // Work out how many commands will fit on this line
+            lineNumCommands = 1;
+            if (chain && batchCommandChainable(pCommands + index)) {
+                lineLength = 2 + batchCommandChainLength(pCommands + index);
+                while ((index + lineNumCommands < numCommands) &&
+                       batchCommandChainable(pCommands + index + lineNumCommands)) {
+                    length = batchCommandChainLength(pCommands + index + lineNumCommands);
+                    if (lineLength + length > U_AT_CLIENT_BATCH_LINE_MAX_LENGTH_BYTES) {
+                        break;
+                    }
+                    lineLength += length;
+                    lineNumCommands++;
+                }
+            }
+            errorCode = batchSendLine(atHandle, pCommands + index,
+                                      lineNumCommands);
+            if ((errorCode != 0) && (lineNumCommands > 1)) {
+                // The AT server will have stopped executing the
+                // line at the command that failed but there's no
+                // telling which that was: go through the commands
+                // of the line again one at a time to find out
+                uAtClientClearError(atHandle);
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                for (size_t x = 0; (x < lineNumCommands) && (errorCode == 0); x++) {
+                    errorCode = batchSendLine(atHandle, pCommands + index, 1);
+                    if (errorCode == 0) {
+                        index++;
+                    }
+                }
+            } else if (errorCode == 0) {
+                index += lineNumCommands;
+            }
+        }
+        errorCode = uAtClientUnlock(atHandle);
+        if (pIndexFailed != NULL) {
+            *pIndexFailed = index;
+        }
+    }
+
+    return errorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: HANDLE UNSOLICITED RESPONSES
  * -------------------------------------------------------------- */
@@ -3241,7 +3882,7 @@ int32_t uAtClientSetUrcHandler(uAtClientHandle_t atHandle,
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
-    if ((pPrefix != NULL) && (pHandler != NULL)) {
+    if ((pPrefix != NULL) && (*pPrefix != 0) && (pHandler != NULL)) {
         errorCode = U_ERROR_COMMON_NO_MEMORY;
         if (!findUrcHandler(pClient, pPrefix)) {
             pUrc = (uAtClientUrc_t *) malloc(sizeof(uAtClientUrc_t));
@@ -3257,9 +3898,13 @@ int32_t uAtClientSetUrcHandler(uAtClientHandle_t atHandle,
                 pUrc->prefixLength = prefixLength;
                 pUrc->pHandler = pHandler;
                 pUrc->pHandlerParam = pHandlerParam;
-                pUrc->pNext = pClient->pUrcList;
-                pClient->pUrcList = pUrc;
-                errorCode = U_ERROR_COMMON_SUCCESS;
+                pUrc->order = pClient->urcOrderNext;
+                if (urcTrieAdd(&(pClient->pUrcTrie), pUrc)) {
+                    pClient->urcOrderNext++;
+                    errorCode = U_ERROR_COMMON_SUCCESS;
+                } else {
+                    free(pUrc);
+                }
             }
         } else {
             errorCode = U_ERROR_COMMON_SUCCESS;
@@ -3281,23 +3926,16 @@ void uAtClientRemoveUrcHandler(uAtClientHandle_t atHandle,
                                const char *pPrefix)
 {
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
-    uAtClientUrc_t *pCurrent = pClient->pUrcList;
-    uAtClientUrc_t *pPrev = NULL;
+    uAtClientUrcNode_t *pNode;
 
     U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
 
-    while (pCurrent != NULL) {
-        if (strcmp(pPrefix, pCurrent->pPrefix) == 0) {
-            if (pPrev != NULL) {
-                pPrev->pNext = pCurrent->pNext;
-            } else {
-                pClient->pUrcList = pCurrent->pNext;
-            }
-            free(pCurrent);
-            pCurrent = NULL;
-        } else {
-            pPrev = pCurrent;
-            pCurrent = pPrev->pNext;
+    if ((pPrefix != NULL) && (*pPrefix != 0)) {
+        pNode = pUrcTrieNode(pClient->pUrcTrie, pPrefix);
+        if ((pNode != NULL) && (pNode->pUrc != NULL)) {
+            free(pNode->pUrc);
+            pNode->pUrc = NULL;
+            urcTriePrune(&(pClient->pUrcTrie), pPrefix, strlen(pPrefix));
         }
     }
 
@@ -3317,6 +3955,9 @@ int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle)
         case U_AT_CLIENT_STREAM_TYPE_EDM:
             stackMinFree = uPortShortRangeEdmStremAtEventStackMinFree(pClient->streamHandle);
             break;
+        case U_AT_CLIENT_STREAM_TYPE_CMUX:
+            stackMinFree = uCellMuxStreamEventStackMinFree(pClient->streamHandle);
+            break;
         default:
             break;
     }
@@ -3374,6 +4015,7 @@ int32_t uAtClientUrcDirect(uAtClientHandle_t atHandle,
     uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
     size_t strlenPrefix;
     bool prefixFound = false;
+    int64_t now;
 
     // IMPORTANT: this can't lock pClient->mutex as it
     // checks for URCs asynchronously (as well as directly)
@@ -3414,7 +4056,10 @@ int32_t uAtClientUrcDirect(uAtClientHandle_t atHandle,
 
             if (prefixFound) {
                 // Found it, call the handler
+                now = uPortGetTickTimeMs();
                 pHandler(pClient, pHandlerParam);
+                statsUrc(pClient, pPrefix, strlenPrefix,
+                         uPortGetTickTimeMs() - now);
                 // Consume up to the CR/LF stop tag
                 if (consumeToStopTag(pClient)) {
                     setScope(pClient, U_AT_CLIENT_SCOPE_NONE);
@@ -3697,4 +4342,144 @@ int32_t uAtClientGetActivityPin(const uAtClientHandle_t atHandle)
 
     return activityPin;
 }
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: STATISTICS
+ * -------------------------------------------------------------- */
+
+// Switch statistics on.
+int32_t uAtClientStatsOn(uAtClientHandle_t atHandle,
+                         size_t maxNumEntries)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientStats_t *pStats;
+    uPortMutexHandle_t streamMutex;
+
+    // The stream mutex, rather than the client mutex, protects
+    // the statistics since they are also updated by the URC task
+    streamMutex = streamLock(pClient);
+
+    pStats = pClient->pStats;
+    if ((pStats != NULL) && (pStats->maxNumEntries != maxNumEntries)) {
+        free(pStats);
+        pStats = NULL;
+    }
+    if (pStats == NULL) {
+        pStats = (uAtClientStats_t *) malloc(sizeof(uAtClientStats_t) +
+                                             (sizeof(uAtClientStatsEntry_t) *
+                                              (maxNumEntries + 2)));
+    }
+    pClient->pStats = pStats;
+    if (pStats != NULL) {
+        statsClear(pStats, maxNumEntries);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    uPortMutexUnlock(streamMutex);
+
+    return errorCode;
+}
+
+// Switch statistics off.
+void uAtClientStatsOff(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uPortMutexHandle_t streamMutex;
+
+    streamMutex = streamLock(pClient);
+
+    free(pClient->pStats);
+    pClient->pStats = NULL;
+
+    uPortMutexUnlock(streamMutex);
+}
+
+// Get the statistics.
+int32_t uAtClientStatsGet(const uAtClientHandle_t atHandle,
+                          uAtClientStatsEntry_t *pEntries,
+                          size_t maxNumEntries)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    const uAtClientInstance_t *pClient = (const uAtClientInstance_t *) atHandle;
+    const uAtClientStatsEntry_t *pEntry;
+    uPortMutexHandle_t streamMutex;
+
+    streamMutex = streamLock(pClient);
+
+    if (pClient->pStats != NULL) {
+        errorCodeOrCount = 0;
+        pEntry = (const uAtClientStatsEntry_t *) (pClient->pStats + 1);
+        for (size_t x = 0; (x < pClient->pStats->maxNumEntries + 2) &&
+             ((pEntries == NULL) || ((size_t) errorCodeOrCount < maxNumEntries)); x++, pEntry++) {
+            // Skip the catch-alls if they have not been used
+            if ((x < pClient->pStats->numEntries) ||
+                ((x >= pClient->pStats->maxNumEntries) && (pEntry->count > 0))) {
+                if (pEntries != NULL) {
+                    *(pEntries + errorCodeOrCount) = *pEntry;
+                }
+                errorCodeOrCount++;
+            }
+        }
+    }
+
+    uPortMutexUnlock(streamMutex);
+
+    return errorCodeOrCount;
+}
+
+// Reset the statistics.
+void uAtClientStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uPortMutexHandle_t streamMutex;
+
+    streamMutex = streamLock(pClient);
+
+    if (pClient->pStats != NULL) {
+        statsClear(pClient->pStats, pClient->pStats->maxNumEntries);
+    }
+
+    uPortMutexUnlock(streamMutex);
+}
+
+// Print the statistics.
+void uAtClientStatsPrint(const uAtClientHandle_t atHandle)
+{
+    const uAtClientInstance_t *pClient = (const uAtClientInstance_t *) atHandle;
+    const uAtClientStatsEntry_t *pEntry;
+    uPortMutexHandle_t streamMutex;
+
+    streamMutex = streamLock(pClient);
+
+    if (pClient->pStats != NULL) {
+        pEntry = (const uAtClientStatsEntry_t *) (pClient->pStats + 1);
+        for (size_t x = 0; x < pClient->pStats->maxNumEntries + 2; x++, pEntry++) {
+            if ((x < pClient->pStats->numEntries) ||
+                ((x >= pClient->pStats->maxNumEntries) && (pEntry->count > 0))) {
+                if (pEntry->isUrc) {
+                    uPortLog("U_AT_CLIENT_%d-%d: URC \"%s\" x%d, handler"
+                             " total %d ms, max %d ms.\n",
+                             pClient->streamType, pClient->streamHandle,
+                             pEntry->prefix[0] != 0 ? pEntry->prefix : "(other)",
+                             pEntry->count, pEntry->totalTimeMs,
+                             pEntry->maxTimeMs);
+                } else {
+                    uPortLog("U_AT_CLIENT_%d-%d: \"%s\" x%d, total %d ms,"
+                             " max %d ms, tx %d, rx %d, timeouts %d.\n",
+                             pClient->streamType, pClient->streamHandle,
+                             pEntry->prefix[0] != 0 ? pEntry->prefix : "(other)",
+                             pEntry->count, pEntry->totalTimeMs,
+                             pEntry->maxTimeMs, pEntry->txBytes,
+                             pEntry->rxBytes, pEntry->numTimeouts);
+                }
+            }
+        }
+    } else {
+        uPortLog("U_AT_CLIENT_%d-%d: statistics are off.\n",
+                 pClient->streamType, pClient->streamHandle);
+    }
+
+    uPortMutexUnlock(streamMutex);
+}
+
 // End of file
@@ -135,6 +135,10 @@ static size_t gSystemHeapLost = 0;
 
 # if (U_CFG_TEST_UART_B >= 0)
 
+/** Counts of the calls to each URC handler in atClientUrcPrefix.
+ */
+static volatile int32_t gUrcPrefixCount[2];
+
 /** AT server buffer used by atServerCallback() and atEchoServerCallback().
  */
 static char gAtServerBuffer[1024];
@@ -143,6 +147,20 @@ static char gAtServerBuffer[1024];
  */
 static const char *gpInterceptTxDataLast = NULL;
 
+/** The command lines received by batchServerCallback(), each
+ * terminated with a '\n'.
+ */
+static char gBatchServerLines[256];
+
+/** The length of the contents of gBatchServerLines.
+ */
+static size_t gBatchServerLinesLength = 0;
+
+/** The number of complete command lines received by
+ * batchServerCallback().
+ */
+static volatile int32_t gBatchServerNumLines = 0;
+
 # endif
 #endif
 
@@ -198,6 +216,21 @@ static void checkStackExtents(uAtClientHandle_t atHandle)
 
 # if (U_CFG_TEST_UART_B >= 0)
 
+// URC handler for atClientUrcPrefix: counts its calls, reading
+// the integer parameter if there is one.
+static void urcPrefixHandler(uAtClientHandle_t atHandle, void *pParameter)
+{
+    volatile int32_t *pCount = (volatile int32_t *) pParameter;
+
+    if (pCount == &(gUrcPrefixCount[1])) {
+        if (uAtClientReadInt(atHandle) >= 0) {
+            (*pCount)++;
+        }
+    } else {
+        (*pCount)++;
+    }
+}
+
 // The preamble for tests involving two UARTs.
 static void twoUartsPreamble()
 {
@@ -765,6 +798,57 @@ static void atEchoServerCallback(int32_t uartHandle, uint32_t eventBitmask,
     }
 }
 
+// Callback for atClientCommandBatch: stores what it receives
+// in gBatchServerLines and, on the end of each command line,
+// responds with "ERROR" if the line contains "+UFAIL", else
+// with "+UTESTQ: 42" for each "+UTESTQ" in the line and then "OK".
+static void batchServerCallback(int32_t uartHandle, uint32_t eventBitmask,
+                                void *pParameters)
+{
+    char c;
+    const char *pLine;
+    const char *pResponse;
+
+    (void) pParameters;
+
+    if (eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
+        while (uPortUartRead(uartHandle, &c, 1) == 1) {
+            if (gBatchServerLinesLength < sizeof(gBatchServerLines) - 1) {
+                if (c == '\r') {
+                    c = '\n';
+                }
+                gBatchServerLines[gBatchServerLinesLength] = c;
+                gBatchServerLinesLength++;
+                gBatchServerLines[gBatchServerLinesLength] = 0;
+            }
+            if (c == '\n') {
+                // Find the start of the line just received
+                pLine = gBatchServerLines + gBatchServerLinesLength - 1;
+                while ((pLine > gBatchServerLines) && (*(pLine - 1) != '\n')) {
+                    pLine--;
+                }
+                pResponse = "\r\nOK\r\n";
+                if (strstr(pLine, "+UFAIL") != NULL) {
+                    pResponse = "\r\nERROR\r\n";
+                } else {
+                    for (pLine = strstr(pLine, "+UTESTQ"); pLine != NULL;
+                         pLine = strstr(pLine + 1, "+UTESTQ")) {
+                        uPortUartWrite(uartHandle, "\r\n+UTESTQ: 42\r\n", 15);
+                    }
+                }
+                uPortUartWrite(uartHandle, pResponse, strlen(pResponse));
+                gBatchServerNumLines++;
+            }
+        }
+    }
+}
+
+// Response parser for atClientCommandBatch.
+static void batchResponseParser(uAtClientHandle_t atHandle, void *pParameter)
+{
+    *((int32_t *) pParameter) = uAtClientReadInt(atHandle);
+}
+
 // A transmit intercept function.
 //lint -e{818} Suppress 'pContext' could be declared as const:
 // need to follow function signature
@@ -823,6 +907,53 @@ static char *pInterceptRx(uAtClientHandle_t atHandle,
     return pData;
 }
 
+#  ifdef U_RUNNER_BENCHMARK
+
+// Set-up for atClientBenchmarkCommand: an AT client on UART A
+// with batchServerCallback() answering on UART B.
+static int32_t benchmarkCommandSetUp(void **ppContext)
+{
+    int32_t errorCode;
+    uAtClientHandle_t atClientHandle = NULL;
+
+    errorCode = uPortInit();
+    if (errorCode == 0) {
+        twoUartsPreamble();
+        errorCode = uAtClientInit();
+    }
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                      NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    }
+    if (atClientHandle != NULL) {
+        *ppContext = atClientHandle;
+        errorCode = uPortUartEventCallbackSet(gUartBHandle,
+                                              U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                              batchServerCallback, NULL,
+                                              U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                              U_AT_CLIENT_URC_TASK_PRIORITY);
+    }
+
+    return errorCode;
+}
+
+// Tear-down for atClientBenchmarkCommand.
+static void benchmarkCommandTearDown(void *pContext)
+{
+    if (pContext != NULL) {
+        uAtClientRemove((uAtClientHandle_t) pContext);
+    }
+    uAtClientDeinit();
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+}
+
+#  endif // #ifdef U_RUNNER_BENCHMARK
+
 # endif
 #endif
 
@@ -1720,6 +1851,363 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet2")
                        (heapUsed <= ((int32_t) gSystemHeapLost) - heapClibLossOffset));
 }
 
+/** Add an AT client and send it URCs with overlapping prefixes
+ * from the second UART, checking that the most recently set
+ * matching handler is called and that removing a handler
+ * hands the URC back to the shorter prefix.  Requires two UARTs
+ * wired back-to-back.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientUrcPrefix")
+{
+    uAtClientHandle_t atClientHandle;
+    const char *pUrcs[] = {"+UTESTX: 1\r\n", "+UTEST7\r\n"};
+    int32_t expected[][2] = {{1, 1}, {3, 1}, {3, 1}};
+    int32_t lastError = 0;
+    int32_t heapUsed;
+    int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    uPortLog("U_AT_CLIENT_TEST: adding an AT client on UART %d...\n",
+             U_CFG_TEST_UART_A);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+
+    gUrcPrefixCount[0] = 0;
+    gUrcPrefixCount[1] = 0;
+    // An empty prefix is not allowed
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "",
+                                              urcPrefixHandler,
+                                              (void *) &(gUrcPrefixCount[0])) < 0);
+    // "+UTEST" also matches "+UTESTX:" but, since "+UTESTX:" is
+    // set later, it should win for "+UTESTX:" URCs
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UTEST",
+                                              urcPrefixHandler,
+                                              (void *) &(gUrcPrefixCount[0])) == 0);
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UTESTX:",
+                                              urcPrefixHandler,
+                                              (void *) &(gUrcPrefixCount[1])) == 0);
+
+    for (size_t x = 0; (x < sizeof(expected) / sizeof(expected[0])) &&
+         (lastError == 0); x++) {
+        if (x == 1) {
+            // Remove the longer prefix: "+UTESTX:" should now
+            // go to the "+UTEST" handler
+            uAtClientRemoveUrcHandler(atClientHandle, "+UTESTX:");
+        } else if (x == 2) {
+            // Remove the shorter prefix: neither URC should
+            // now be handled
+            uAtClientRemoveUrcHandler(atClientHandle, "+UTEST");
+        }
+        for (size_t y = 0; y < sizeof(pUrcs) / sizeof(pUrcs[0]); y++) {
+            uPortUartWrite(gUartBHandle, pUrcs[y], strlen(pUrcs[y]));
+        }
+        startTimeMs = uPortGetTickTimeMs();
+        while (((gUrcPrefixCount[0] != expected[x][0]) ||
+                (gUrcPrefixCount[1] != expected[x][1])) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_AT_TIMEOUT_MS)) {
+            uPortTaskBlock(10);
+        }
+        // Give any unexpected handler calls a chance to happen
+        uPortTaskBlock(100);
+        uPortLog("U_AT_CLIENT_TEST: URC prefix step %d, handler counts"
+                 " %d and %d (expected %d and %d).\n", x + 1,
+                 gUrcPrefixCount[0], gUrcPrefixCount[1],
+                 expected[x][0], expected[x][1]);
+        if ((gUrcPrefixCount[0] != expected[x][0]) ||
+            (gUrcPrefixCount[1] != expected[x][1])) {
+            lastError = -1;
+        }
+    }
+
+    uPortLog("U_AT_CLIENT_TEST: removing AT client...\n");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Fail the test if an error occurred: doing this here
+    // rather than asserting above so that clean-up happens
+    // and hence we don't end up with mutexes left locked
+    U_PORT_TEST_ASSERT(lastError == 0);
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_AT_CLIENT_TEST: %d byte(s) of heap were lost to"
+             " the C library during this test and we have"
+             " leaked %d byte(s).\n",
+             gSystemHeapLost - heapClibLossOffset,
+             heapUsed - (gSystemHeapLost - heapClibLossOffset));
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed < 0) ||
+                       (heapUsed <= ((int32_t) gSystemHeapLost) - heapClibLossOffset));
+}
+
+/** Send batches of AT commands, chained and not, to an AT server
+ * on the second UART, checking what arrives at the server, that the
+ * information response of a command in the batch is parsed and that
+ * the index of a failing command is reported.  Requires two UARTs
+ * wired back-to-back.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandBatch")
+{
+    uAtClientHandle_t atClientHandle;
+    int32_t value = 0;
+    size_t indexFailed = 0;
+    uAtClientBatchCommand_t commands[] = {{"ATE0", NULL, NULL, NULL},
+        {"AT+UTESTA=1", NULL, NULL, NULL},
+        {"AT+UTESTQ?", "+UTESTQ:", batchResponseParser, NULL},
+        {"AT&C1", NULL, NULL, NULL}
+    };
+    int32_t heapUsed;
+    int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+
+    commands[2].pParameter = &value;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    uPortLog("U_AT_CLIENT_TEST: adding an AT client on UART %d...\n",
+             U_CFG_TEST_UART_A);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 batchServerCallback, NULL,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    // Chained: one line, one round trip
+    gBatchServerLinesLength = 0;
+    gBatchServerNumLines = 0;
+    U_PORT_TEST_ASSERT(uAtClientCommandBatch(atClientHandle, commands,
+                                             sizeof(commands) / sizeof(commands[0]),
+                                             true, &indexFailed) == 0);
+    uPortLog("U_AT_CLIENT_TEST: chained batch sent \"%s\".\n", gBatchServerLines);
+    U_PORT_TEST_ASSERT(indexFailed == sizeof(commands) / sizeof(commands[0]));
+    U_PORT_TEST_ASSERT(gBatchServerNumLines == 1);
+    U_PORT_TEST_ASSERT(strcmp(gBatchServerLines, "ATE0+UTESTA=1;+UTESTQ?;&C1\n") == 0);
+    U_PORT_TEST_ASSERT(value == 42);
+
+    // Not chained: a line per command
+    gBatchServerLinesLength = 0;
+    gBatchServerNumLines = 0;
+    value = 0;
+    U_PORT_TEST_ASSERT(uAtClientCommandBatch(atClientHandle, commands,
+                                             sizeof(commands) / sizeof(commands[0]),
+                                             false, &indexFailed) == 0);
+    U_PORT_TEST_ASSERT(indexFailed == sizeof(commands) / sizeof(commands[0]));
+    U_PORT_TEST_ASSERT(gBatchServerNumLines == 4);
+    U_PORT_TEST_ASSERT(strcmp(gBatchServerLines,
+                              "ATE0\nAT+UTESTA=1\nAT+UTESTQ?\nAT&C1\n") == 0);
+    U_PORT_TEST_ASSERT(value == 42);
+
+    // Chained with a failure: the chained line, then the commands
+    // one at a time up to and including the one that fails
+    commands[2].pCommand = "AT+UFAIL";
+    commands[2].pResponseParser = NULL;
+    gBatchServerLinesLength = 0;
+    gBatchServerNumLines = 0;
+    U_PORT_TEST_ASSERT(uAtClientCommandBatch(atClientHandle, commands,
+                                             sizeof(commands) / sizeof(commands[0]),
+                                             true, &indexFailed) < 0);
+    uPortLog("U_AT_CLIENT_TEST: failed batch sent \"%s\".\n", gBatchServerLines);
+    U_PORT_TEST_ASSERT(indexFailed == 2);
+    U_PORT_TEST_ASSERT(gBatchServerNumLines == 4);
+
+    // The AT client should be fine after all that
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT");
+    uAtClientCommandStopReadResponse(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    uPortLog("U_AT_CLIENT_TEST: removing AT client...\n");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_AT_CLIENT_TEST: %d byte(s) of heap were lost to"
+             " the C library during this test and we have"
+             " leaked %d byte(s).\n",
+             gSystemHeapLost - heapClibLossOffset,
+             heapUsed - (gSystemHeapLost - heapClibLossOffset));
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed < 0) ||
+                       (heapUsed <= ((int32_t) gSystemHeapLost) - heapClibLossOffset));
+}
+
+/** Switch on statistics for an AT client talking to an AT server
+ * on the second UART and check that AT commands, URCs and the
+ * catch-all entry are counted.  Requires two UARTs wired
+ * back-to-back.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientStats")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientStatsEntry_t entries[5];
+    int32_t value;
+    int32_t startTimeMs;
+    int32_t heapUsed;
+    int32_t heapClibLossOffset = (int32_t) gSystemHeapLost;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    uPortLog("U_AT_CLIENT_TEST: adding an AT client on UART %d...\n",
+             U_CFG_TEST_UART_A);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 batchServerCallback, NULL,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+    gUrcPrefixCount[1] = 0;
+    U_PORT_TEST_ASSERT(uAtClientSetUrcHandler(atClientHandle, "+UTESTX:",
+                                              urcPrefixHandler,
+                                              (void *) &(gUrcPrefixCount[1])) == 0);
+
+    // Statistics are off to begin with
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, entries,
+                                         sizeof(entries) / sizeof(entries[0])) < 0);
+    // Room for three entries
+    U_PORT_TEST_ASSERT(uAtClientStatsOn(atClientHandle, 3) == 0);
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, NULL, 0) == 0);
+
+    // Three of one AT command, one of another
+    for (size_t x = 0; x < 3; x++) {
+        value = 0;
+        uAtClientLock(atClientHandle);
+        uAtClientCommandStart(atClientHandle, "AT+UTESTQ?");
+        uAtClientCommandStop(atClientHandle);
+        uAtClientResponseStart(atClientHandle, "+UTESTQ:");
+        value = uAtClientReadInt(atClientHandle);
+        uAtClientResponseStop(atClientHandle);
+        U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+        U_PORT_TEST_ASSERT(value == 42);
+    }
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "ATE0");
+    uAtClientCommandStopReadResponse(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    // Two URCs
+    uPortUartWrite(gUartBHandle, "\r\n+UTESTX: 1\r\n\r\n+UTESTX: 2\r\n", 28);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((gUrcPrefixCount[1] < 2) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_AT_CLIENT_TEST_AT_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gUrcPrefixCount[1] == 2);
+
+    // The table is now full so this should go to the catch-all
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT&C1");
+    uAtClientCommandStopReadResponse(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientUnlock(atClientHandle) == 0);
+
+    uAtClientStatsPrint(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, NULL, 0) == 4);
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, entries,
+                                         sizeof(entries) / sizeof(entries[0])) == 4);
+    U_PORT_TEST_ASSERT(strcmp(entries[0].prefix, "AT+UTESTQ") == 0);
+    U_PORT_TEST_ASSERT(!entries[0].isUrc);
+    U_PORT_TEST_ASSERT(entries[0].count == 3);
+    // Each command is "AT+UTESTQ?\r"
+    U_PORT_TEST_ASSERT(entries[0].txBytes == 3 * 11);
+    // Each response is "\r\n+UTESTQ: 42\r\n\r\nOK\r\n"
+    U_PORT_TEST_ASSERT(entries[0].rxBytes == 3 * 21);
+    U_PORT_TEST_ASSERT(entries[0].maxTimeMs <= entries[0].totalTimeMs);
+    U_PORT_TEST_ASSERT(entries[0].numTimeouts == 0);
+    U_PORT_TEST_ASSERT(strcmp(entries[1].prefix, "ATE0") == 0);
+    U_PORT_TEST_ASSERT(entries[1].count == 1);
+    U_PORT_TEST_ASSERT(entries[1].txBytes == 5);
+    U_PORT_TEST_ASSERT(strcmp(entries[2].prefix, "+UTESTX:") == 0);
+    U_PORT_TEST_ASSERT(entries[2].isUrc);
+    U_PORT_TEST_ASSERT(entries[2].count == 2);
+    U_PORT_TEST_ASSERT(entries[2].txBytes == 0);
+    U_PORT_TEST_ASSERT(entries[3].prefix[0] == 0);
+    U_PORT_TEST_ASSERT(!entries[3].isUrc);
+    U_PORT_TEST_ASSERT(entries[3].count == 1);
+    // Asking for fewer should get fewer
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, entries, 2) == 2);
+
+    // Reset and switch off
+    uAtClientStatsReset(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, entries,
+                                         sizeof(entries) / sizeof(entries[0])) == 0);
+    uAtClientStatsOff(atClientHandle);
+    U_PORT_TEST_ASSERT(uAtClientStatsGet(atClientHandle, entries,
+                                         sizeof(entries) / sizeof(entries[0])) < 0);
+
+    uPortLog("U_AT_CLIENT_TEST: removing AT client...\n");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_AT_CLIENT_TEST: %d byte(s) of heap were lost to"
+             " the C library during this test and we have"
+             " leaked %d byte(s).\n",
+             gSystemHeapLost - heapClibLossOffset,
+             heapUsed - (gSystemHeapLost - heapClibLossOffset));
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT((heapUsed < 0) ||
+                       (heapUsed <= ((int32_t) gSystemHeapLost) - heapClibLossOffset));
+}
+
 # endif
 #endif
 
@@ -1756,4 +2244,40 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCleanUp")
     }
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BENCHMARKS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0) && \
+    defined(U_RUNNER_BENCHMARK)
+
+/** Time the round trip of an AT command with an information
+ * response, i.e. the write, the read and the parsing of the
+ * response by the AT client, against an AT server on the second
+ * UART; requires two UARTs wired back-to-back.
+ */
+U_RUNNER_BENCHMARK("[atClient]", "atClientBenchmarkCommand", 50,
+                   benchmarkCommandSetUp, benchmarkCommandTearDown)
+{
+    uAtClientHandle_t atClientHandle = (uAtClientHandle_t) pContext;
+    int32_t value;
+    int32_t errorCode;
+
+    gBatchServerLinesLength = 0;
+    uAtClientLock(atClientHandle);
+    uAtClientCommandStart(atClientHandle, "AT+UTESTQ?");
+    uAtClientCommandStop(atClientHandle);
+    uAtClientResponseStart(atClientHandle, "+UTESTQ:");
+    value = uAtClientReadInt(atClientHandle);
+    uAtClientResponseStop(atClientHandle);
+    errorCode = uAtClientUnlock(atClientHandle);
+    if ((errorCode == 0) && (value != 42)) {
+        errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    }
+
+    return errorCode;
+}
+
+#endif
+
 // End of file
@@ -22,6 +22,10 @@ extern "C" {
 #define U_LIB_HDR_FLAG_VALIDATION           (1<<1)
 /** Indicates that the library uses malloc and free */
 #define U_LIB_HDR_FLAG_NEEDS_MALLOC         (1<<2)
+/** Indicates that the function descriptors of the library carry
+ * a hash of their name and are sorted by it, see
+ * U_LIB_I_FDESC_HASH_BITPOS; set by genlibhdr.py */
+#define U_LIB_HDR_FLAG_SYMBOL_INDEX         (1<<3)
 
 /** On what bit position in flags the arch resides */
 #define U_LIB_HDR_FLAG_ARCH_BITPOS          (4)
@@ -189,6 +193,24 @@ int uLibClose(uLibHdl_t *pHdl);
  */
 void *uLibSym(uLibHdl_t *pHdl, const char *sym);
 
+/**
+ * Looks up the call addresses of a whole table of symbols in one go,
+ * e.g. to populate a structure of function pointers when a library is
+ * opened or relocated. Each symbol is resolved as by uLibSym, but with
+ * the library checked only once. Where a symbol is not found the
+ * corresponding entry of pAddresses is set to NULL, the remaining
+ * symbols are still resolved and U_ERROR_COMMON_NOT_FOUND is returned
+ * (and may also be read with uLibError).
+ * @param pHdl Pointer to library handle struct.
+ * @param pSyms Array of count function symbol names to find.
+ * @param pAddresses Array of count entries to populate with the
+ * addresses of the functions.
+ * @param count Number of entries in pSyms and pAddresses.
+ * @return U_ERROR_COMMON_SUCCESS if all symbols were found, else error code
+ */
+int uLibSymTable(uLibHdl_t *pHdl, const char *const *pSyms,
+                 void **pAddresses, uint32_t count);
+
 /**
  * Returns and clears last error for given library.
  * @param pHdl Pointer to library handle struct.
@@ -22,10 +22,25 @@ extern "C" {
 /** Library finaliser function */
 #define U_LIB_I_FDESC_FLAG_FINI            (1<<2)
 
+/** Position of the symbol name hash in the function descriptor flags
+ * of a library with U_LIB_HDR_FLAG_SYMBOL_INDEX set: the hash is the
+ * upper 16 bits of the 32-bit FNV-1a hash of the symbol name and the
+ * function descriptors are sorted in ascending order of it */
+#define U_LIB_I_FDESC_HASH_BITPOS          (16)
+/** Mask for the symbol name hash in the function descriptor flags */
+#define U_LIB_I_FDESC_HASH_MASK            (0xffff)
+
+/** Return the symbol name hash from function descriptor flags */
+#define U_LIB_I_FDESC_FLAG_GET_HASH(flags) (((flags) >> U_LIB_I_FDESC_HASH_BITPOS) & U_LIB_I_FDESC_HASH_MASK)
+
 /** ubxlib initialiser function name, recognised by python script genlibhdr.py */
 #define U_LIB_I_OPEN_FUNC                  ___libOpen
 /** ubxlib finaliser function name, recognised by python script genlibhdr.py */
 #define U_LIB_I_CLOSE_FUNC                 ___libClose
+/** ubxlib initialiser function name as a string */
+#define U_LIB_I_OPEN_FUNC_NAME             "___libOpen"
+/** ubxlib finaliser function name as a string */
+#define U_LIB_I_CLOSE_FUNC_NAME            "___libClose"
 
 /**
  * Library open function prototype.
@@ -15,11 +15,28 @@ import sys
 import os
 import re
 
+# Library flag indicating that the function descriptors carry a hash
+# of their name and are sorted by it, see u_lib.h
+U_LIB_HDR_FLAG_SYMBOL_INDEX = (1<<3)
+# Position of the hash in the function descriptor flags, see u_lib_internal.h
+U_LIB_I_FDESC_HASH_BITPOS = 16
+
+def symHash(symName):
+  """ The upper 16 bits of the 32-bit FNV-1a hash of a symbol name,
+      must match symbolHash() in u_lib_handler.c, which uses
+      uFnv1a32() from common/utils/src/u_hash.c """
+  h = 2166136261
+  for b in symName.encode():
+    h = ((h ^ b) * 16777619) & 0xffffffff
+  return h >> 16
+
 def emit(name, version, flags, length, syms):
-  """ Emit source code for symbols """
+  """ Emit source code for symbols, sorted by the hash of
+      their name so that the library handler can search them """
   print("/* autogenerated C file */")
+  flags = flags | U_LIB_HDR_FLAG_SYMBOL_INDEX
   emitBegin(name, version, flags, length, syms)
-  for symName in syms:
+  for symName in sorted(syms, key=lambda s: (symHash(s), s)):
     emitEntry(symName, syms[symName])
   emitEnd(name, version, flags, length, syms)
 
@@ -46,7 +63,8 @@ def emitEntry(symName, symProps):
     flags = flags | (1<<1) # library initialiser
   if symName == "___libClose":
     flags = flags | (1<<2) # library finaliser
-  print('    {} .name = "{}", .offset = {}, .flags = {} {},'.format("{", symName, symProps["offset"], flags, "}"))
+  flags = flags | (symHash(symName) << U_LIB_I_FDESC_HASH_BITPOS)
+  print('    {} .name = "{}", .offset = {}, .flags = 0x{:08x} {},'.format("{", symName, symProps["offset"], flags, "}"))
 
 def emitEnd(name, version, flags, length, syms):
   """ Emit source code for symbols: end """
@@ -26,6 +26,7 @@
 #include "u_lib_internal.h"
 #include "u_error_common.h"
 #include "string.h"
+#include "u_hash.h"
 
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
@@ -43,6 +44,59 @@ static uint8_t *getCallAddress(uLibHdl_t *pHdl, uint32_t funcIx)
     return pFunc;
 }
 
+// Hash a symbol name as genlibhdr.py does: the upper 16 bits
+// of the 32-bit FNV-1a hash of the name.
+static uint32_t symbolHash(const char *sym)
+{
+    return (uFnv1a32(sym, strlen(sym), U_FNV1A32_INITIAL_VALUE) >> 16) &
+           U_LIB_I_FDESC_HASH_MASK;
+}
+
+// Find the index of the function descriptor with the given name
+// whose flags, masked with flagsMask, are flagsValue; returns
+// pDescr->hdr.count if there is none.
+static uint32_t findSymbol(const uLibDescriptor_t *pDescr, const char *sym,
+                           uint32_t flagsMask, uint32_t flagsValue)
+{
+    uint32_t i = 0;
+    uint32_t end = pDescr->hdr.count;
+    uint32_t hash;
+    uint32_t mid;
+
+    if (pDescr->hdr.flags & U_LIB_HDR_FLAG_SYMBOL_INDEX) {
+        // The descriptors are sorted by hash: binary search for
+        // the first with a matching hash, then only those with
+        // the same hash need be compared
+        hash = symbolHash(sym);
+        while (i < end) {
+            mid = i + ((end - i) / 2);
+            if (U_LIB_I_FDESC_FLAG_GET_HASH(pDescr->funcs[mid].flags) < hash) {
+                i = mid + 1;
+            } else {
+                end = mid;
+            }
+        }
+        end = pDescr->hdr.count;
+        while ((i < end) && (U_LIB_I_FDESC_FLAG_GET_HASH(pDescr->funcs[i].flags) == hash)) {
+            if (((pDescr->funcs[i].flags & flagsMask) == flagsValue) &&
+                strcmp(sym, pDescr->funcs[i].name) == 0) {
+                return i;
+            }
+            i++;
+        }
+        return end;
+    }
+
+    // No index, e.g. an older library: search the lot
+    for (; i < end; i++) {
+        if (((pDescr->funcs[i].flags & flagsMask) == flagsValue) &&
+            strcmp(sym, pDescr->funcs[i].name) == 0) {
+            break;
+        }
+    }
+    return i;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -83,12 +137,22 @@ int uLibOpen(uLibHdl_t *pHdl, const void *puLib,
     } else {
         pHdl->puLibCode = (void *)(&pDescr->funcs[pDescr->hdr.count]);
     }
-    for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
-        if ((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION))
-            == (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION)) {
+    if (pDescr->hdr.flags & U_LIB_HDR_FLAG_SYMBOL_INDEX) {
+        // genlibhdr.py only marks the initialiser as such, look it up
+        uint32_t i = findSymbol(pDescr, U_LIB_I_OPEN_FUNC_NAME,
+                                U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION,
+                                U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION);
+        if (i < pDescr->hdr.count) {
             res = ((ulibOpenFn_t)getCallAddress(pHdl, i))(pLibc, flags, &pHdl->ictx);
-            if (res != U_ERROR_COMMON_SUCCESS) {
-                break;
+        }
+    } else {
+        for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
+            if ((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION))
+                == (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FUNCTION)) {
+                res = ((ulibOpenFn_t)getCallAddress(pHdl, i))(pLibc, flags, &pHdl->ictx);
+                if (res != U_ERROR_COMMON_SUCCESS) {
+                    break;
+                }
             }
         }
     }
@@ -137,11 +201,21 @@ int uLibClose(uLibHdl_t *pHdl)
     }
 
     uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
-    for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
-        if ((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_FINI | U_LIB_I_FDESC_FLAG_FUNCTION))
-            == (U_LIB_I_FDESC_FLAG_FINI | U_LIB_I_FDESC_FLAG_FUNCTION)) {
+    if (pDescr->hdr.flags & U_LIB_HDR_FLAG_SYMBOL_INDEX) {
+        // genlibhdr.py only marks the finaliser as such, look it up
+        uint32_t i = findSymbol(pDescr, U_LIB_I_CLOSE_FUNC_NAME,
+                                U_LIB_I_FDESC_FLAG_FINI | U_LIB_I_FDESC_FLAG_FUNCTION,
+                                U_LIB_I_FDESC_FLAG_FINI | U_LIB_I_FDESC_FLAG_FUNCTION);
+        if (i < pDescr->hdr.count) {
             ((ulibCloseFn_t)getCallAddress(pHdl, i))(pHdl->ictx);
         }
+    } else {
+        for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
+            if ((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_FINI | U_LIB_I_FDESC_FLAG_FUNCTION))
+                == (U_LIB_I_FDESC_FLAG_FINI | U_LIB_I_FDESC_FLAG_FUNCTION)) {
+                ((ulibCloseFn_t)getCallAddress(pHdl, i))(pHdl->ictx);
+            }
+        }
     }
 
     pHdl->puLibDescr = 0; // indicate closed by nulling library descriptor pointer
@@ -164,18 +238,55 @@ void *uLibSym(uLibHdl_t *pHdl, const char *sym)
     }
 
     uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
-    for (uint32_t i = 0; i < pDescr->hdr.count; i++) {
-        if (((pDescr->funcs[i].flags & (U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FINI |
-                                        U_LIB_I_FDESC_FLAG_FUNCTION))
-             == U_LIB_I_FDESC_FLAG_FUNCTION) &&
-            strcmp(sym, pDescr->funcs[i].name) == 0) {
-            return (void *)getCallAddress(pHdl, i);
-        }
+    uint32_t i = findSymbol(pDescr, sym,
+                            U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FINI |
+                            U_LIB_I_FDESC_FLAG_FUNCTION,
+                            U_LIB_I_FDESC_FLAG_FUNCTION);
+    if (i < pDescr->hdr.count) {
+        return (void *)getCallAddress(pHdl, i);
     }
     pHdl->error = U_ERROR_COMMON_NOT_FOUND;
     return 0;
 }
 
+int uLibSymTable(uLibHdl_t *pHdl, const char *const *pSyms,
+                 void **pAddresses, uint32_t count)
+{
+    if (pHdl == 0) {
+        return U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+    if (pHdl->puLibDescr == 0) {
+        pHdl->error = U_ERROR_COMMON_NOT_INITIALISED;
+        return U_ERROR_COMMON_NOT_INITIALISED;
+    }
+    if ((pSyms == 0 || pAddresses == 0) && count > 0) {
+        pHdl->error = U_ERROR_COMMON_INVALID_PARAMETER;
+        return U_ERROR_COMMON_INVALID_PARAMETER;
+    }
+
+    int res = U_ERROR_COMMON_SUCCESS;
+    uLibDescriptor_t *pDescr = (uLibDescriptor_t *)pHdl->puLibDescr;
+    for (uint32_t x = 0; x < count; x++) {
+        uint32_t i = pDescr->hdr.count;
+        if (pSyms[x] != 0) {
+            i = findSymbol(pDescr, pSyms[x],
+                           U_LIB_I_FDESC_FLAG_INIT | U_LIB_I_FDESC_FLAG_FINI |
+                           U_LIB_I_FDESC_FLAG_FUNCTION,
+                           U_LIB_I_FDESC_FLAG_FUNCTION);
+        }
+        if (i < pDescr->hdr.count) {
+            pAddresses[x] = (void *)getCallAddress(pHdl, i);
+        } else {
+            pAddresses[x] = 0;
+            res = U_ERROR_COMMON_NOT_FOUND;
+        }
+    }
+    if (res != U_ERROR_COMMON_SUCCESS) {
+        pHdl->error = res;
+    }
+    return res;
+}
+
 int uLibError(uLibHdl_t *pHdl)
 {
     if (pHdl == 0) {
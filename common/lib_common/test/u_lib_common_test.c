@@ -160,6 +160,21 @@ static int32_t runLibTest(void)
     uPortLogF("@libFibTestLastRes:   %p\n", libFibTestLastRes);
     uPortLogF("@libFibTestHelloWorld:%p\n\n", libFibTestHelloWorld);
 
+    // look up the same functions in one go, plus one that isn't there
+    const char *const syms[] = {"libFibTestCalc", "libFibTestLastRes",
+                                "libFibTestHelloWorld", "libFibTestNotThere"
+                               };
+    void *addresses[sizeof(syms) / sizeof(syms[0])];
+    res = uLibSymTable(&libHdl, syms, addresses, sizeof(syms) / sizeof(syms[0]));
+    U_PORT_TEST_ASSERT(res == U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uLibError(&libHdl) == U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(addresses[0] == (void *) libFibTestCalc);
+    U_PORT_TEST_ASSERT(addresses[1] == (void *) libFibTestLastRes);
+    U_PORT_TEST_ASSERT(addresses[2] == (void *) libFibTestHelloWorld);
+    U_PORT_TEST_ASSERT(addresses[3] == NULL);
+    res = uLibSymTable(&libHdl, syms, addresses, 3);
+    U_PORT_TEST_ASSERT(res == U_ERROR_COMMON_SUCCESS);
+
     // start calling the library
     int libFibTestResult = libFibTestCalc(libHdl.ictx, 102);
     U_PORT_TEST_ASSERT(libFibTestResult == FIB_102);
@@ -169,6 +169,9 @@ typedef struct {
     uSecurityTlsContext_t *pSecurityContext;
     int32_t totalMessagesSent;      /* Total messages sent from MQTT client */
     int32_t totalMessagesReceived;  /* Total messages received by MQTT client */
+    void (*pMessageReceiveCallback) (uMqttMessage_t *, void *); /* Set by
+                                                                   uMqttClientSetMessageReceiveCallback() */
+    void *pMessageReceiveCallbackParam;
 } uMqttClientContext_t;
 
 /* ----------------------------------------------------------------
@@ -387,6 +390,77 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
                                size_t *pMessageSizeBytes,
                                uMqttQos_t *pQos);
 
+/** Set a callback to be called with each MQTT message as it is
+ * received, rather than having the message stored for a later call
+ * to uMqttClientMessageRead().  The callback is handed a view of
+ * the topic string and the message which is valid only for the
+ * duration of the callback: where the underlying module delivers
+ * the message in one piece (e.g. short-range modules) pMessage
+ * will point at it where it was received, else (e.g. cellular
+ * modules) pMessage will be NULL and the message may be read out,
+ * in chunks of whatever size suits, with
+ * uMqttClientMessageReceiveRead(), so that a large message need
+ * never be held in one place.  Any part of the message which the
+ * callback does not read is discarded when the callback returns.
+ * The callback is called from the task that receives data from the
+ * module, with that module locked: it must be quick and must NOT
+ * call any other ubxlib API functions apart from
+ * uMqttClientMessageReceiveRead().
+ *
+ * While a message receive callback is set, messages are not stored
+ * and the callback set with uMqttClientSetMessageCallback() is not
+ * called for them.  Any messages that were received, and not yet
+ * read with uMqttClientMessageRead(), before the message receive
+ * callback was set are handed to it first, in the order they were
+ * received (on cellular modules, where such messages are still in
+ * the module, they can only be read in that order); for short-range
+ * modules this is done before this function returns, for cellular
+ * modules it is done from the AT client callback task, just as for
+ * a newly received message.  Once they have been handed over,
+ * uMqttClientGetUnread() will return zero.  The number of messages
+ * handed to the callback is included in the count returned by
+ * uMqttClientGetTotalMessagesReceived().
+ *
+ * Note that SARA-R4 cellular modules using the old-style MQTT AT
+ * interface (SARA-R410M-02B) do not support this.
+ *
+ * @param pContext        a pointer to the internal MQTT context
+ *                        structure that was originally returned
+ *                        by pUMqttClientOpen().
+ * @param pCallback       the callback. The first parameter to
+ *                        the callback is the received message,
+ *                        the second parameter is pCallbackParam.
+ *                        Use NULL to deregister a previous
+ *                        callback and go back to storing messages
+ *                        for uMqttClientMessageRead().
+ * @param pCallbackParam  this value will be passed to pCallback
+ *                        as the second parameter.
+ * @return                zero on success else negative error
+ *                        code.
+ */
+int32_t uMqttClientSetMessageReceiveCallback(uMqttClientContext_t *pContext,
+                                             void (*pCallback) (uMqttMessage_t *,
+                                                                void *),
+                                             void *pCallbackParam);
+
+/** Read the next chunk of a message that has been handed to the
+ * callback set with uMqttClientSetMessageReceiveCallback(); may
+ * only be called from within that callback.  This works whether
+ * or not pMessage->pMessage is NULL.
+ *
+ * @param pMessage         the message, as passed to the callback.
+ * @param pBuffer          a place to put the message data; may be
+ *                         NULL, in which case up to bufferSizeBytes
+ *                         of message data are discarded.
+ * @param bufferSizeBytes  the amount of storage at pBuffer.
+ * @return                 the number of bytes read, zero when there
+ *                         is no more of the message to read, else
+ *                         negative error code.
+ */
+int32_t uMqttClientMessageReceiveRead(uMqttMessage_t *pMessage,
+                                      char *pBuffer,
+                                      size_t bufferSizeBytes);
+
 /** Get the last MQTT client error code.
  *
  * @param pContext      a pointer to the internal MQTT context
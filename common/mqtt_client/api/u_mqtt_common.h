@@ -72,6 +72,34 @@ typedef struct {
                                     it will be cleared. */
 } uMqttWill_t;
 
+/** An MQTT message as handed to a message receive callback, see
+ * uMqttClientSetMessageReceiveCallback().  The message is only
+ * valid for the duration of the callback.  The fields marked
+ * "internal" should not be touched by the callback.
+ */
+typedef struct uMqttMessage_t {
+    const char *pTopicNameStr; /**< the null-terminated topic string
+                                    of the message. */
+    const char *pMessage;      /**< the message, which is not
+                                    restricted to ASCII values, if
+                                    it is available in one piece;
+                                    if this is NULL the message must
+                                    be read, in chunks of any size,
+                                    with uMqttClientMessageReceiveRead(). */
+    size_t messageSizeBytes;   /**< the length of the message. */
+    uMqttQos_t qos;            /**< the QoS of the message. */
+    size_t readOffset;         /**< internal: how much of the message
+                                    has been read with
+                                    uMqttClientMessageReceiveRead(). */
+    int32_t (*pReadFunction) (struct uMqttMessage_t *pMessage,
+                              char *pBuffer,
+                              size_t bufferSizeBytes); /**< internal: how
+                                                            to read a message
+                                                            that is not at
+                                                            pMessage. */
+    void *pReadContext;        /**< internal: for pReadFunction. */
+} uMqttMessage_t;
+
 #endif // _U_MQTT_COMMON_H_
 
 // End of file
@@ -48,9 +48,11 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memcpy()
 
 #include "u_error_common.h"
 
+#include "u_port.h"
 #include "u_port_os.h"
 
 #include "u_mqtt_common.h"
@@ -65,6 +67,20 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#if defined(__GNUC__) || defined(__clang__)
+/** The message counts are updated both by API calls, under the
+ * context mutex, and by messageReceiveCallback(), which is called
+ * from the underlying module's receive task and can't take the
+ * context mutex without risking a deadlock with an API call that
+ * is waiting on that module; the updates must hence be atomic.
+ */
+# define U_MQTT_CLIENT_COUNT_INCREMENT(x) (void) __atomic_add_fetch(&(x), 1, __ATOMIC_RELAXED)
+# define U_MQTT_CLIENT_COUNT_LOAD(x) __atomic_load_n(&(x), __ATOMIC_RELAXED)
+#else
+# define U_MQTT_CLIENT_COUNT_INCREMENT(x) countIncrement(&(x))
+# define U_MQTT_CLIENT_COUNT_LOAD(x) (x)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -145,6 +161,36 @@ int32_t cellConnect(int32_t networkHandle,
     return errorCode;
 }
 
+#if !defined(__GNUC__) && !defined(__clang__)
+/** Increment a message count where the compiler offers no atomic
+ * operations.
+ */
+static void countIncrement(volatile int32_t *pCount)
+{
+    bool critical = (uPortEnterCritical() == 0);
+
+    (*pCount)++;
+    if (critical) {
+        uPortExitCritical();
+    }
+}
+#endif
+
+/** A local "trampoline" for the message receive callback, here so
+ * that the received message can be counted.
+ */
+static void messageReceiveCallback(uMqttMessage_t *pMessage, void *pParam)
+{
+    uMqttClientContext_t *pContext = (uMqttClientContext_t *) pParam;
+    void (*pCallback) (uMqttMessage_t *, void *) = pContext->pMessageReceiveCallback;
+
+    // Not under the context mutex: see U_MQTT_CLIENT_COUNT_INCREMENT()
+    U_MQTT_CLIENT_COUNT_INCREMENT(pContext->totalMessagesReceived);
+    if (pCallback != NULL) {
+        pCallback(pMessage, pContext->pMessageReceiveCallbackParam);
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -185,6 +231,8 @@ uMqttClientContext_t *pUMqttClientOpen(int32_t networkHandle,
             pContext->pSecurityContext = NULL;
             pContext->totalMessagesSent = 0;
             pContext->totalMessagesReceived = 0;
+            pContext->pMessageReceiveCallback = NULL;
+            pContext->pMessageReceiveCallbackParam = NULL;
             pContext->pPriv = pPriv;
             if (uPortMutexCreate((uPortMutexHandle_t *) & (pContext->mutexHandle)) == 0) {
                 gLastOpenError = U_ERROR_COMMON_SUCCESS;
@@ -496,7 +544,7 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
                                              (uMqttQos_t *) pQos);
         }
         if (errorCode == 0) {
-            pContext->totalMessagesReceived++;
+            U_MQTT_CLIENT_COUNT_INCREMENT(pContext->totalMessagesReceived);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
@@ -505,6 +553,78 @@ int32_t uMqttClientMessageRead(uMqttClientContext_t *pContext,
     return errorCode;
 }
 
+// Set a callback to be called with each received message.
+int32_t uMqttClientSetMessageReceiveCallback(uMqttClientContext_t *pContext,
+                                             void (*pCallback) (uMqttMessage_t *,
+                                                                void *),
+                                             void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    void (*pLocalCallback) (uMqttMessage_t *, void *) = NULL;
+
+    if (pContext != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+
+        if (pCallback != NULL) {
+            pLocalCallback = messageReceiveCallback;
+            pContext->pMessageReceiveCallbackParam = pCallbackParam;
+            pContext->pMessageReceiveCallback = pCallback;
+        }
+        if (U_NETWORK_HANDLE_IS_CELL(pContext->networkHandle)) {
+            errorCode = uCellMqttSetMessageReceiveCallback(pContext->networkHandle,
+                                                           pLocalCallback,
+                                                           pContext);
+        } else if (U_NETWORK_HANDLE_IS_WIFI(pContext->networkHandle)) {
+            errorCode = uWifiMqttSetMessageReceiveCallback(pContext,
+                                                           pLocalCallback,
+                                                           pContext);
+        }
+        if ((errorCode != 0) || (pCallback == NULL)) {
+            pContext->pMessageReceiveCallback = NULL;
+            pContext->pMessageReceiveCallbackParam = NULL;
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) (pContext->mutexHandle));
+    }
+
+    return errorCode;
+}
+
+// Read the next chunk of a message in a message receive callback.
+int32_t uMqttClientMessageReceiveRead(uMqttMessage_t *pMessage,
+                                      char *pBuffer,
+                                      size_t bufferSizeBytes)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pMessage != NULL) &&
+        ((pMessage->pMessage != NULL) || (pMessage->pReadFunction != NULL))) {
+        if (bufferSizeBytes > pMessage->messageSizeBytes - pMessage->readOffset) {
+            bufferSizeBytes = pMessage->messageSizeBytes - pMessage->readOffset;
+        }
+        errorCodeOrLength = 0;
+        if (bufferSizeBytes > 0) {
+            if (pMessage->pMessage != NULL) {
+                if (pBuffer != NULL) {
+                    memcpy(pBuffer, pMessage->pMessage + pMessage->readOffset,
+                           bufferSizeBytes);
+                }
+                errorCodeOrLength = (int32_t) bufferSizeBytes;
+            } else {
+                errorCodeOrLength = pMessage->pReadFunction(pMessage, pBuffer,
+                                                            bufferSizeBytes);
+            }
+            if (errorCodeOrLength > 0) {
+                pMessage->readOffset += errorCodeOrLength;
+            }
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
 // Get the last MQTT error code.
 int32_t uMqttClientGetLastErrorCode(const uMqttClientContext_t *pContext)
 {
@@ -543,7 +663,7 @@ int32_t uMqttClientGetTotalMessagesReceived(const uMqttClientContext_t *pContext
     int32_t errorCodeOrReceivedMessages = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
 
     if (pContext != NULL) {
-        errorCodeOrReceivedMessages = pContext->totalMessagesReceived;
+        errorCodeOrReceivedMessages = U_MQTT_CLIENT_COUNT_LOAD(pContext->totalMessagesReceived);
     }
 
     return errorCodeOrReceivedMessages;
@@ -137,6 +137,19 @@ static const char gSendData[] =  "______000:012345678901234567890123456789012345
  */
 static bool gDisconnectCallbackCalled;
 
+/** The number of messages delivered to messageReceiveCallback().
+ */
+static volatile int32_t gMessageReceiveCount;
+
+/** The number of message bytes read by messageReceiveCallback().
+ */
+static volatile size_t gMessageReceiveSizeBytes;
+
+/** The topic expected by messageReceiveCallback(), which sets
+ * this to NULL if the topic doesn't match.
+ */
+static const char *volatile gpMessageReceiveTopic;
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -232,6 +245,31 @@ static void disconnectCallback(int32_t errorCode, void *pParam)
 
     gDisconnectCallbackCalled = true;
 }
+// Callback for received messages: reads the message, in small
+// chunks, into the buffer pointed to by pParam.
+static void messageReceiveCallback(uMqttMessage_t *pMessage, void *pParam)
+{
+    char *pBuffer = (char *) pParam;
+    int32_t x;
+
+    if ((gpMessageReceiveTopic != NULL) &&
+        (strcmp(pMessage->pTopicNameStr, gpMessageReceiveTopic) != 0)) {
+        gpMessageReceiveTopic = NULL;
+    }
+    gMessageReceiveSizeBytes = 0;
+    do {
+        x = uMqttClientMessageReceiveRead(pMessage,
+                                          pBuffer + gMessageReceiveSizeBytes,
+                                          10);
+        if (x > 0) {
+            gMessageReceiveSizeBytes += x;
+        }
+    } while ((x > 0) &&
+             (gMessageReceiveSizeBytes + 10 <= U_MQTT_CLIENT_TEST_READ_MESSAGE_MAX_LENGTH_BYTES));
+
+    gMessageReceiveCount++;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -249,6 +287,7 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClient")
     int32_t heapXxxSecurityInitLoss = 0;
     uMqttClientConnection_t connection = U_MQTT_CLIENT_CONNECTION_DEFAULT;
     uSecurityTlsSettings_t tlsSettings = U_SECURITY_TLS_SETTINGS_DEFAULT;
+    int32_t totalReceived;
     int32_t y;
     int32_t z;
     size_t s;
@@ -485,6 +524,92 @@ U_PORT_TEST_FUNCTION("[mqttClient]", "mqttClient")
 
                         U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 0);
 
+                        // Leave a message unread: it should be handed to
+                        // the message receive callback when that is set
+                        uPortLog("U_MQTT_CLIENT_TEST: publishing again, leaving the"
+                                 " message unread...\n");
+                        gStopTimeMs = uPortGetTickTimeMs() +
+                                      (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
+                        U_PORT_TEST_ASSERT(uMqttClientPublish(gpMqttContextA, pTopicOut,
+                                                              pMessageOut,
+                                                              U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                                              U_MQTT_QOS_EXACTLY_ONCE,
+                                                              false) == 0);
+                        startTimeMs = uPortGetTickTimeMs();
+                        while ((uMqttClientGetUnread(gpMqttContextA) == 0) &&
+                               (uPortGetTickTimeMs() < startTimeMs +
+                                (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000))) {
+                            uPortTaskBlock(100);
+                        }
+                        U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 1);
+                        totalReceived = uMqttClientGetTotalMessagesReceived(gpMqttContextA);
+
+                        // Now have messages delivered to a callback instead
+                        gMessageReceiveCount = 0;
+                        gMessageReceiveSizeBytes = 0;
+                        gpMessageReceiveTopic = pTopicOut;
+                        //lint -e(668) Suppress possible use of NULL pointer,
+                        // it is checked above
+                        memset(pMessageIn, 0, U_MQTT_CLIENT_TEST_READ_MESSAGE_MAX_LENGTH_BYTES);
+                        y = uMqttClientSetMessageReceiveCallback(gpMqttContextA,
+                                                                 messageReceiveCallback,
+                                                                 pMessageIn);
+                        if (y == 0) {
+                            startTimeMs = uPortGetTickTimeMs();
+                            while ((gMessageReceiveCount == 0) &&
+                                   (uPortGetTickTimeMs() < startTimeMs +
+                                    (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000))) {
+                                uPortTaskBlock(100);
+                            }
+                            uPortLog("U_MQTT_CLIENT_TEST: %d waiting message(s) handed to"
+                                     " the callback, %d byte(s).\n", gMessageReceiveCount,
+                                     gMessageReceiveSizeBytes);
+                            U_PORT_TEST_ASSERT(gMessageReceiveCount == 1);
+                            U_PORT_TEST_ASSERT(gpMessageReceiveTopic != NULL);
+                            U_PORT_TEST_ASSERT(gMessageReceiveSizeBytes ==
+                                               U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES);
+                            U_PORT_TEST_ASSERT(memcmp(pMessageIn, pMessageOut,
+                                                      gMessageReceiveSizeBytes) == 0);
+                            U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 0);
+                            U_PORT_TEST_ASSERT(uMqttClientGetTotalMessagesReceived(gpMqttContextA) == totalReceived + 1);
+
+                            uPortLog("U_MQTT_CLIENT_TEST: publishing again, this time"
+                                     " for the message receive callback...\n");
+                            gMessageReceiveSizeBytes = 0;
+                            memset(pMessageIn, 0, U_MQTT_CLIENT_TEST_READ_MESSAGE_MAX_LENGTH_BYTES);
+                            gStopTimeMs = uPortGetTickTimeMs() +
+                                          (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000);
+                            U_PORT_TEST_ASSERT(uMqttClientPublish(gpMqttContextA, pTopicOut,
+                                                                  pMessageOut,
+                                                                  U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES,
+                                                                  U_MQTT_QOS_EXACTLY_ONCE,
+                                                                  false) == 0);
+                            startTimeMs = uPortGetTickTimeMs();
+                            while ((gMessageReceiveCount == 1) &&
+                                   (uPortGetTickTimeMs() < startTimeMs +
+                                    (U_MQTT_CLIENT_RESPONSE_WAIT_SECONDS * 1000))) {
+                                uPortTaskBlock(100);
+                            }
+                            uPortLog("U_MQTT_CLIENT_TEST: %d message(s) received by the"
+                                     " callback, %d byte(s).\n", gMessageReceiveCount,
+                                     gMessageReceiveSizeBytes);
+                            U_PORT_TEST_ASSERT(gMessageReceiveCount == 2);
+                            U_PORT_TEST_ASSERT(gpMessageReceiveTopic != NULL);
+                            U_PORT_TEST_ASSERT(gMessageReceiveSizeBytes ==
+                                               U_MQTT_CLIENT_TEST_PUBLISH_MAX_LENGTH_BYTES);
+                            U_PORT_TEST_ASSERT(memcmp(pMessageIn, pMessageOut,
+                                                      gMessageReceiveSizeBytes) == 0);
+                            // Nothing should be left behind for uMqttClientMessageRead()
+                            U_PORT_TEST_ASSERT(uMqttClientGetUnread(gpMqttContextA) == 0);
+                            U_PORT_TEST_ASSERT(uMqttClientSetMessageReceiveCallback(gpMqttContextA,
+                                                                                    NULL,
+                                                                                    NULL) == 0);
+                        } else {
+                            uPortLog("U_MQTT_CLIENT_TEST: message receive callback not"
+                                     " supported.\n");
+                            U_PORT_TEST_ASSERT(y == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+                        }
+
                         // Cancel the subscribe
                         uPortLog("U_MQTT_CLIENT_TEST: unsubscribing from topic \"%s\"...\n",
                                  pTopicOut);
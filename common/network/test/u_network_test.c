@@ -40,6 +40,7 @@
 #include "stdbool.h"
 #include "string.h"    // memset(), strcmp()
 #include "ctype.h"     // isprint()
+#include "limits.h"    // INT_MIN
 
 #include "u_cfg_sw.h"
 //lint -efile(766, u_cfg_os_platform_specific.h)
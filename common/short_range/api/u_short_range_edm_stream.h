@@ -39,6 +39,16 @@ extern "C" {
 #define U_EDM_STREAM_EVENT_QUEUE_SIZE 3
 #endif
 
+#ifndef U_EDM_STREAM_PAYLOAD_SLAB_SIZE_BYTES
+/** The size of the buffer that received EDM payloads are
+ * parsed into; it is allocated when the EDM stream is opened.
+ * A payload larger than this is allocated separately; otherwise,
+ * if there is no room, parsing waits until earlier events have
+ * been processed.
+ */
+# define U_EDM_STREAM_PAYLOAD_SLAB_SIZE_BYTES 2048
+#endif
+
 #ifndef U_EDM_STREAM_TASK_PRIORITY
 # define U_EDM_STREAM_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 4)
 #endif
@@ -63,11 +73,22 @@ typedef void (*uEdmBtConnectionStatusCallback_t)(int32_t edmStreamHandle,
                                                  const uShortRangeConnectDataBt_t *pConnectData,
                                                  void *pCallbackParameter);
 
-typedef void (*uEdmDataEventCallback_t)(int32_t edmStreamHandle,
-                                        int32_t edmChannel,
-                                        int32_t length,
-                                        char *pData,
-                                        void *pCallbackParameter);
+/** A data event callback: it must return the number of bytes
+ * of pData that it has taken.  If that is less than length the
+ * remainder is held by the EDM stream and the channel is paused:
+ * the callback will not be called for that channel again, the
+ * data that follows being held behind it, until
+ * uShortRangeEdmStreamDataResume() is called, at which point the
+ * held data is offered to the callback once more.  Note that the
+ * held data occupies space in the EDM stream which is shared by
+ * all channels, so if the channel is not resumed the EDM stream
+ * will eventually stop reading from the module entirely.
+ */
+typedef int32_t (*uEdmDataEventCallback_t)(int32_t edmStreamHandle,
+                                           int32_t edmChannel,
+                                           int32_t length,
+                                           char *pData,
+                                           void *pCallbackParameter);
 
 /* ----------------------------------------------------------------
  * FUNCTIONS
@@ -282,6 +303,22 @@ int32_t uShortRangeEdmStreamDataEventCallbackSet(int32_t handle,
 void uShortRangeEdmStreamDataEventCallbackRemove(int32_t handle,
                                                  uShortRangeConnectionType_t type);
 
+/** Resume a channel that was paused by its data event callback
+ * taking less than all of the data it was offered, see
+ * uEdmDataEventCallback_t; the held data will be offered to the
+ * callback again, asynchronously, from the task that reads the
+ * UART rather than from the EDM event task: this uses no space
+ * in the EDM event queue.  This function may be called
+ * from a connection event callback but not from a data event
+ * callback, nor while holding a lock that the data event callback
+ * itself takes.
+ *
+ * @param handle   the handle of the stream instance.
+ * @param channel  the EDM channel to resume.
+ * @return         zero on success else negative error code.
+ */
+int32_t uShortRangeEdmStreamDataResume(int32_t handle, int32_t channel);
+
 
 /** Send an event to the callback.  This allows the user to
  * re-trigger events: for instance, if a data event has only
@@ -52,8 +52,6 @@
 #define U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv4    0x02
 #define U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv6    0x03
 
-#define U_SHORT_RANGE_EDM_SHORT_BUFFER_LENGTH     256
-
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -62,7 +60,8 @@ typedef enum {
     EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH,
     EDM_PARSER_STATE_ACCUMULATE_PAYLOAD,
     EDM_PARSER_STATE_PARSE_TAIL_BYTE,
-    EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING
+    EDM_PARSER_STATE_WAIT_FOR_ROOM,
+    EDM_PARSER_STATE_SKIP_PAYLOAD
 } edmParserState_t;
 
 /* ----------------------------------------------------------------
@@ -70,23 +69,26 @@ typedef enum {
  * -------------------------------------------------------------- */
 static int32_t getBtProfile(char value, uShortRangeBtProfile_t *profile);
 static int32_t getIpProtocol(char value, uShortRangeIpProtocol_t *protocol);
-static uShortRangeEdmEvent_t *allocateEdmEvent(void);
-static uShortRangeEdmEvent_t *parseConnectBtEvent(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseConnectIpv4Event(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseConnectIpv6Event(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseConnectEvent(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseDisconnectEvent(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseDataEvent(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseAtResponseOrEvent(char *buffer, uint16_t payloadLength);
-static uShortRangeEdmEvent_t *parseEdmPayload(char *buffer, uint16_t payloadLength);
-static void resetPayload(void);
-
-/* ----------------------------------------------------------------
- * STATIC VARIABLES
- * -------------------------------------------------------------- */
-static edmParserState_t gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
-static char gShortPayloadBuffer[U_SHORT_RANGE_EDM_SHORT_BUFFER_LENGTH];
-static char *gpPayload = gShortPayloadBuffer;
+static uShortRangeEdmEvent_t *parseConnectBtEvent(char *buffer, uint16_t payloadLength,
+                                                  uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseConnectIpv4Event(char *buffer, uint16_t payloadLength,
+                                                    uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseConnectIpv6Event(char *buffer, uint16_t payloadLength,
+                                                    uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseConnectEvent(char *buffer, uint16_t payloadLength,
+                                                uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseDisconnectEvent(char *buffer, uint16_t payloadLength,
+                                                   uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseDataEvent(char *buffer, uint16_t payloadLength,
+                                             uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseAtResponseOrEvent(char *buffer, uint16_t payloadLength,
+                                                     uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmEvent_t *parseEdmPayload(char *buffer, uint16_t payloadLength,
+                                              uShortRangeEdmEvent_t *pEventBuffer);
+static uShortRangeEdmParserSlot_t *pSlotAllocate(uShortRangeEdmParser_t *pParser,
+                                                 size_t length);
+static void slotFree(uShortRangeEdmParser_t *pParser,
+                     uShortRangeEdmParserSlot_t *pSlot);
 
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
@@ -129,14 +131,8 @@ static int32_t getIpProtocol(char value, uShortRangeIpProtocol_t *pProtocol)
     return U_SHORT_RANGE_EDM_OK;
 }
 
-static uShortRangeEdmEvent_t *allocateEdmEvent(void)
-{
-    static uShortRangeEdmEvent_t gEdmEvent;
-
-    return &gEdmEvent;
-}
-
-static uShortRangeEdmEvent_t *parseConnectBtEvent(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseConnectBtEvent(char *pBuffer, uint16_t payloadLength,
+                                                  uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
     uShortRangeBtProfile_t profile;
@@ -144,7 +140,7 @@ static uShortRangeEdmEvent_t *parseConnectBtEvent(char *pBuffer, uint16_t payloa
 
     if ((payloadLength == 11) && (result == U_SHORT_RANGE_EDM_OK)) {
         uShortRangeEdmConnectionEventBt_t *pEvtData;
-        pEvent = allocateEdmEvent();
+        pEvent = pEventBuffer;
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_CONNECT_BT;
         pEvtData = &pEvent->params.btConnectEvent;
         pEvtData->channel = pBuffer[0];
@@ -157,7 +153,8 @@ static uShortRangeEdmEvent_t *parseConnectBtEvent(char *pBuffer, uint16_t payloa
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseConnectIpv4Event(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseConnectIpv4Event(char *pBuffer, uint16_t payloadLength,
+                                                    uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
     uShortRangeIpProtocol_t protocol;
@@ -165,7 +162,7 @@ static uShortRangeEdmEvent_t *parseConnectIpv4Event(char *pBuffer, uint16_t payl
 
     if ((payloadLength == 15) && (result == U_SHORT_RANGE_EDM_OK)) {
         uShortRangeEdmConnectionEventIpv4_t *pEvtData;
-        pEvent = allocateEdmEvent();
+        pEvent = pEventBuffer;
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv4;
         pEvtData = &pEvent->params.ipv4ConnectEvent;
         pEvtData->channel = pBuffer[0];
@@ -183,7 +180,8 @@ static uShortRangeEdmEvent_t *parseConnectIpv4Event(char *pBuffer, uint16_t payl
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseConnectIpv6Event(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseConnectIpv6Event(char *pBuffer, uint16_t payloadLength,
+                                                    uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
     uShortRangeIpProtocol_t protocol;
@@ -191,7 +189,7 @@ static uShortRangeEdmEvent_t *parseConnectIpv6Event(char *pBuffer, uint16_t payl
 
     if ((payloadLength == 39) && (result == U_SHORT_RANGE_EDM_OK)) {
         uShortRangeEdmConnectionEventIpv6_t *pEvtData;
-        pEvent = allocateEdmEvent();
+        pEvent = pEventBuffer;
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_CONNECT_IPv6;
         pEvtData = &pEvent->params.ipv6ConnectEvent;
         pEvtData->channel = pBuffer[0];
@@ -209,7 +207,8 @@ static uShortRangeEdmEvent_t *parseConnectIpv6Event(char *pBuffer, uint16_t payl
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseConnectEvent(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseConnectEvent(char *pBuffer, uint16_t payloadLength,
+                                                uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
 
@@ -219,15 +218,15 @@ static uShortRangeEdmEvent_t *parseConnectEvent(char *pBuffer, uint16_t payloadL
         switch (type) {
 
             case U_SHORT_RANGE_EDM_CONNECTION_TYPE_BT:
-                pEvent = parseConnectBtEvent(pBuffer, payloadLength);
+                pEvent = parseConnectBtEvent(pBuffer, payloadLength, pEventBuffer);
                 break;
 
             case U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv4:
-                pEvent = parseConnectIpv4Event(pBuffer, payloadLength);
+                pEvent = parseConnectIpv4Event(pBuffer, payloadLength, pEventBuffer);
                 break;
 
             case U_SHORT_RANGE_EDM_CONNECTION_TYPE_IPv6:
-                pEvent = parseConnectIpv6Event(pBuffer, payloadLength);
+                pEvent = parseConnectIpv6Event(pBuffer, payloadLength, pEventBuffer);
                 break;
 
             default:
@@ -238,12 +237,13 @@ static uShortRangeEdmEvent_t *parseConnectEvent(char *pBuffer, uint16_t payloadL
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseDisconnectEvent(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseDisconnectEvent(char *pBuffer, uint16_t payloadLength,
+                                                   uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
 
     if (payloadLength == 1) {
-        pEvent = allocateEdmEvent();
+        pEvent = pEventBuffer;
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_DISCONNECT;
         pEvent->params.disconnectEvent.channel = (uint8_t)pBuffer[0];
     }
@@ -251,12 +251,13 @@ static uShortRangeEdmEvent_t *parseDisconnectEvent(char *pBuffer, uint16_t paylo
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseDataEvent(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseDataEvent(char *pBuffer, uint16_t payloadLength,
+                                             uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
 
     if (payloadLength > 1) {
-        pEvent = allocateEdmEvent();
+        pEvent = pEventBuffer;
         pEvent->type = U_SHORT_RANGE_EDM_EVENT_DATA;
         pEvent->params.dataEvent.channel = (uint8_t)pBuffer[0];
         pEvent->params.dataEvent.pData = &pBuffer[1];
@@ -266,16 +267,18 @@ static uShortRangeEdmEvent_t *parseDataEvent(char *pBuffer, uint16_t payloadLeng
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseAtResponseOrEvent(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseAtResponseOrEvent(char *pBuffer, uint16_t payloadLength,
+                                                     uShortRangeEdmEvent_t *pEventBuffer)
 {
-    uShortRangeEdmEvent_t *pEvent = allocateEdmEvent();
+    uShortRangeEdmEvent_t *pEvent = pEventBuffer;
     pEvent->type = U_SHORT_RANGE_EDM_EVENT_AT;
     pEvent->params.atEvent.pData = pBuffer;
     pEvent->params.atEvent.length = payloadLength;
     return pEvent;
 }
 
-static uShortRangeEdmEvent_t *parseEdmPayload(char *pBuffer, uint16_t payloadLength)
+static uShortRangeEdmEvent_t *parseEdmPayload(char *pBuffer, uint16_t payloadLength,
+                                              uShortRangeEdmEvent_t *pEventBuffer)
 {
     uShortRangeEdmEvent_t *pEvent = NULL;
     uint16_t idAndType = ((uint16_t)(uint8_t)pBuffer[0] << 8) | (uint16_t)(uint8_t)pBuffer[1];
@@ -284,25 +287,25 @@ static uShortRangeEdmEvent_t *parseEdmPayload(char *pBuffer, uint16_t payloadLen
 
     switch (idAndType) {
         case U_SHORT_RANGE_EDM_TYPE_CONNECT_EVENT:
-            pEvent = parseConnectEvent(pSubPayload, subPayloadLength);
+            pEvent = parseConnectEvent(pSubPayload, subPayloadLength, pEventBuffer);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_DISCONNECT_EVENT:
-            pEvent = parseDisconnectEvent(pSubPayload, subPayloadLength);
+            pEvent = parseDisconnectEvent(pSubPayload, subPayloadLength, pEventBuffer);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_DATA_EVENT:
-            pEvent = parseDataEvent(pSubPayload, subPayloadLength);
+            pEvent = parseDataEvent(pSubPayload, subPayloadLength, pEventBuffer);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_AT_RESPONSE:
         case U_SHORT_RANGE_EDM_TYPE_AT_EVENT:
-            pEvent = parseAtResponseOrEvent(pSubPayload, subPayloadLength);
+            pEvent = parseAtResponseOrEvent(pSubPayload, subPayloadLength, pEventBuffer);
             break;
 
         case U_SHORT_RANGE_EDM_TYPE_START_EVENT:
             if (subPayloadLength == 0) {
-                pEvent = allocateEdmEvent();
+                pEvent = pEventBuffer;
                 pEvent->type = U_SHORT_RANGE_EDM_EVENT_STARTUP;
             }
             break;
@@ -321,110 +324,290 @@ static uShortRangeEdmEvent_t *parseEdmPayload(char *pBuffer, uint16_t payloadLen
     return pEvent;
 }
 
-static void resetPayload(void)
+// Hand out the next slot from the pool along with length bytes of
+// payload memory, taken from the slab if it will ever fit there,
+// else malloc()ed; returns NULL if there is no free slot or not
+// enough room in the slab yet.
+static uShortRangeEdmParserSlot_t *pSlotAllocate(uShortRangeEdmParser_t *pParser,
+                                                 size_t length)
+{
+    uShortRangeEdmParserSlot_t *pSlot = NULL;
+    size_t slabTail = 0;
+    char *pPayload = NULL;
+    size_t offset = pParser->slabHead;
+    bool wrap = false;
+
+    if (pParser->slotCount < pParser->numSlots) {
+        if (length > pParser->slabSize) {
+            // Will never fit, have to malloc() it
+            pPayload = (char *) pParser->pMalloc(length);
+        } else {
+            if (pParser->slotCount > 0) {
+                slabTail = pParser->pSlots[pParser->slotTail].offset;
+            }
+            if (!pParser->slabWrapped) {
+                if (pParser->slabHead + length <= pParser->slabSize) {
+                    pPayload = pParser->pSlab + pParser->slabHead;
+                } else if (length <= slabTail) {
+                    // No room at the end but there is room
+                    // at the start of the slab
+                    pPayload = pParser->pSlab;
+                    offset = 0;
+                    wrap = true;
+                }
+            } else if (pParser->slabHead + length <= slabTail) {
+                pPayload = pParser->pSlab + pParser->slabHead;
+            }
+            if (pPayload != NULL) {
+                pParser->slabHead = offset + length;
+                if (wrap) {
+                    pParser->slabWrapped = true;
+                }
+            }
+        }
+        if (pPayload != NULL) {
+            pSlot = &(pParser->pSlots[pParser->slotHead]);
+            pSlot->pPayload = pPayload;
+            pSlot->offset = offset;
+            pSlot->length = 0;
+            if (length <= pParser->slabSize) {
+                pSlot->length = length;
+            }
+            pSlot->inUse = true;
+            pParser->slotHead++;
+            if (pParser->slotHead >= pParser->numSlots) {
+                pParser->slotHead = 0;
+            }
+            pParser->slotCount++;
+        }
+    }
+
+    return pSlot;
+}
+
+// Find somewhere to put the payload of the current packet and
+// set the parser state accordingly: if there is nowhere yet, wait
+// until an event is freed, unless no events are in use, in which
+// case nothing will ever be freed and the packet must be skipped.
+static void payloadRoomFind(uShortRangeEdmParser_t *pParser)
 {
-    if (gpPayload != gShortPayloadBuffer) {
-        free(gpPayload);
-        gpPayload = gShortPayloadBuffer;
+    pParser->byteIndex = 0;
+    if (pSlotAllocate(pParser, pParser->payloadLength) != NULL) {
+        pParser->state = (int32_t) EDM_PARSER_STATE_ACCUMULATE_PAYLOAD;
+    } else if (pParser->slotCount == 0) {
+        pParser->numDropped++;
+        pParser->state = (int32_t) EDM_PARSER_STATE_SKIP_PAYLOAD;
+    } else {
+        pParser->state = (int32_t) EDM_PARSER_STATE_WAIT_FOR_ROOM;
+    }
+}
+
+// Give a slot back and reclaim, in order, the slots, and the
+// slab memory, that are no longer in use.
+static void slotFree(uShortRangeEdmParser_t *pParser,
+                     uShortRangeEdmParserSlot_t *pSlot)
+{
+    size_t slabTail;
+
+    if (pSlot->inUse) {
+        pSlot->inUse = false;
+        if (pSlot->length == 0) {
+            free(pSlot->pPayload);
+        }
+        pSlot->pPayload = NULL;
+        while ((pParser->slotCount > 0) &&
+               !pParser->pSlots[pParser->slotTail].inUse) {
+            slabTail = pParser->pSlots[pParser->slotTail].offset;
+            pParser->slotTail++;
+            if (pParser->slotTail >= pParser->numSlots) {
+                pParser->slotTail = 0;
+            }
+            pParser->slotCount--;
+            if (pParser->slotCount == 0) {
+                // Empty: start again from the beginning of the slab
+                pParser->slabHead = 0;
+                pParser->slabWrapped = false;
+            } else if (pParser->pSlots[pParser->slotTail].offset < slabTail) {
+                // The oldest payload is now the one that wrapped
+                pParser->slabWrapped = false;
+            }
+        }
     }
 }
 
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
-bool uShortRangeEdmParserReady(void)
+int32_t uShortRangeEdmParserInit(uShortRangeEdmParser_t *pParser,
+                                 size_t maxNumEvents, size_t slabSizeBytes)
 {
-    return (gEdmParserState != EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING);
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pParser != NULL) && (maxNumEvents > 0)) {
+        memset(pParser, 0, sizeof(*pParser));
+        pParser->state = (int32_t) EDM_PARSER_STATE_PARSE_START_BYTE;
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pParser->pSlots = (uShortRangeEdmParserSlot_t *) malloc(maxNumEvents *
+                                                                 sizeof(uShortRangeEdmParserSlot_t));
+        if (slabSizeBytes > 0) {
+            pParser->pSlab = (char *) malloc(slabSizeBytes);
+        }
+        if ((pParser->pSlots != NULL) &&
+            ((pParser->pSlab != NULL) || (slabSizeBytes == 0))) {
+            memset(pParser->pSlots, 0, maxNumEvents * sizeof(uShortRangeEdmParserSlot_t));
+            pParser->numSlots = maxNumEvents;
+            pParser->slabSize = slabSizeBytes;
+            pParser->pMalloc = malloc;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        } else {
+            free(pParser->pSlots);
+            free(pParser->pSlab);
+            memset(pParser, 0, sizeof(*pParser));
+        }
+    }
+
+    return errorCode;
 }
 
-void uShortRangeEdmResetParser(void)
+void uShortRangeEdmParserDeinit(uShortRangeEdmParser_t *pParser)
 {
-    resetPayload();
-    gEdmParserState = EDM_PARSER_STATE_PARSE_START_BYTE;
+    if ((pParser != NULL) && (pParser->pSlots != NULL)) {
+        for (size_t x = 0; x < pParser->numSlots; x++) {
+            slotFree(pParser, &(pParser->pSlots[x]));
+        }
+        free(pParser->pSlots);
+        free(pParser->pSlab);
+        memset(pParser, 0, sizeof(*pParser));
+    }
 }
 
-uShortRangeEdmEvent_t *uShortRangeEdmParse(char c)
+bool uShortRangeEdmParserReady(const uShortRangeEdmParser_t *pParser)
 {
-    uShortRangeEdmEvent_t *pResultEvent = NULL;
-    edmParserState_t newState = gEdmParserState;
-    static uint32_t byteIndex;
-    static uint16_t payloadLength;
-
-    switch (gEdmParserState) {
-
-        case EDM_PARSER_STATE_PARSE_START_BYTE:
-            if (c == U_SHORT_RANGE_EDM_HEAD) {
-                newState = EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH;
-                byteIndex = 0;
-            }
-            break;
+    return (pParser != NULL) && (pParser->pSlots != NULL) &&
+           (pParser->state != (int32_t) EDM_PARSER_STATE_WAIT_FOR_ROOM);
+}
 
-        case EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH:
-            if (byteIndex == 0) {
-                payloadLength = (uint16_t)(uint8_t)c << 8;
-                byteIndex++;
-            } else {
-                payloadLength |= (uint16_t)(uint8_t)c;
-                if (payloadLength < 2) {
-                    // Something is wrong, start over
-                    newState = EDM_PARSER_STATE_PARSE_START_BYTE;
-                } else {
-                    newState = EDM_PARSER_STATE_ACCUMULATE_PAYLOAD;
-                    byteIndex = 0;
-                    if (payloadLength > U_SHORT_RANGE_EDM_SHORT_BUFFER_LENGTH) {
-                        // Payload is too large to fit in the normal short buffer
-                        // malloc a larger buffer and free it later when the event
-                        // has been processed
-                        if (payloadLength <= U_SHORT_RANGE_EDM_MAX_SIZE) {
-                            gpPayload = (char *)malloc(payloadLength);
+size_t uShortRangeEdmParse(uShortRangeEdmParser_t *pParser,
+                           const char *pBuffer, size_t length,
+                           uShortRangeEdmEvent_t **ppEvent)
+{
+    uShortRangeEdmEvent_t *pResultEvent = NULL;
+    uShortRangeEdmParserSlot_t *pSlot;
+    const char *pTmp;
+    size_t consumed = 0;
+    size_t x;
+    char c;
+
+    if (uShortRangeEdmParserReady(pParser) && (pBuffer != NULL)) {
+        while ((consumed < length) && (pResultEvent == NULL) &&
+               (pParser->state != (int32_t) EDM_PARSER_STATE_WAIT_FOR_ROOM)) {
+            switch (pParser->state) {
+                case EDM_PARSER_STATE_PARSE_START_BYTE:
+                    // Skip to the start of the next packet
+                    pTmp = (const char *) memchr(pBuffer + consumed, U_SHORT_RANGE_EDM_HEAD,
+                                                 length - consumed);
+                    if (pTmp != NULL) {
+                        consumed = (pTmp - pBuffer) + 1;
+                        pParser->state = (int32_t) EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH;
+                        pParser->byteIndex = 0;
+                    } else {
+                        consumed = length;
+                    }
+                    break;
+
+                case EDM_PARSER_STATE_PARSE_PAYLOAD_LENGTH:
+                    c = pBuffer[consumed];
+                    consumed++;
+                    if (pParser->byteIndex == 0) {
+                        pParser->payloadLength = (uint16_t)(uint8_t)c << 8;
+                        pParser->byteIndex++;
+                    } else {
+                        pParser->payloadLength |= (uint16_t)(uint8_t)c;
+                        if ((pParser->payloadLength < 2) ||
+                            (pParser->payloadLength > U_SHORT_RANGE_EDM_MAX_SIZE)) {
+                            // Something is wrong, start over
+                            pParser->state = (int32_t) EDM_PARSER_STATE_PARSE_START_BYTE;
                         } else {
-                            gpPayload = NULL;
+                            payloadRoomFind(pParser);
                         }
-                        if (gpPayload == NULL) {
-                            // We could not allocate a buffer
-                            // Reset parser
-                            gpPayload = gShortPayloadBuffer;
-                            newState = EDM_PARSER_STATE_PARSE_START_BYTE;
-                        }
-                    } else {
-                        gpPayload = gShortPayloadBuffer;
                     }
-                }
-            }
-            break;
+                    break;
+
+                case EDM_PARSER_STATE_ACCUMULATE_PAYLOAD:
+                    // The slot being filled is the last one handed out
+                    pSlot = &(pParser->pSlots[(pParser->slotHead + pParser->numSlots - 1) %
+                                                                                  pParser->numSlots]);
+                    x = pParser->payloadLength - pParser->byteIndex;
+                    if (x > length - consumed) {
+                        x = length - consumed;
+                    }
+                    memcpy(pSlot->pPayload + pParser->byteIndex, pBuffer + consumed, x);
+                    consumed += x;
+                    pParser->byteIndex += x;
+                    if (pParser->byteIndex == pParser->payloadLength) {
+                        pParser->state = (int32_t) EDM_PARSER_STATE_PARSE_TAIL_BYTE;
+                    }
+                    break;
 
-        case EDM_PARSER_STATE_ACCUMULATE_PAYLOAD:
-            gpPayload[byteIndex++] = c;
-            if (byteIndex == payloadLength) {
-                newState = EDM_PARSER_STATE_PARSE_TAIL_BYTE;
-            }
-            break;
+                case EDM_PARSER_STATE_SKIP_PAYLOAD:
+                    // Throw away the payload and the tail byte
+                    x = pParser->payloadLength + 1 - pParser->byteIndex;
+                    if (x > length - consumed) {
+                        x = length - consumed;
+                    }
+                    consumed += x;
+                    pParser->byteIndex += x;
+                    if (pParser->byteIndex > pParser->payloadLength) {
+                        pParser->state = (int32_t) EDM_PARSER_STATE_PARSE_START_BYTE;
+                    }
+                    break;
+
+                case EDM_PARSER_STATE_PARSE_TAIL_BYTE:
+                    pSlot = &(pParser->pSlots[(pParser->slotHead + pParser->numSlots - 1) %
+                                                                                  pParser->numSlots]);
+                    if (pBuffer[consumed] == U_SHORT_RANGE_EDM_TAIL) {
+                        pResultEvent = parseEdmPayload(pSlot->pPayload,
+                                                       pParser->payloadLength,
+                                                       &(pSlot->event));
+                    }
+                    consumed++;
+                    if (pResultEvent == NULL) {
+                        // No event was generated, give the slot back
+                        slotFree(pParser, pSlot);
+                    }
+                    pParser->state = (int32_t) EDM_PARSER_STATE_PARSE_START_BYTE;
+                    break;
 
-        case EDM_PARSER_STATE_PARSE_TAIL_BYTE:
-            if (c == U_SHORT_RANGE_EDM_TAIL) {
-                pResultEvent = parseEdmPayload(gpPayload, payloadLength);
+                default:
+                    break;
             }
-            if (pResultEvent == NULL) {
-                // No event was generated
-                // Reset parser
-                resetPayload();
-                newState = EDM_PARSER_STATE_PARSE_START_BYTE;
-            } else {
-                newState = EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING;
-            }
-            break;
+        }
+    }
 
-        case EDM_PARSER_STATE_WAIT_FOR_EVENT_PROCESSING:
-            // Parser will stay in this state until parser is reset.
-            // This to avoid the parser overwriting data in an unprocessed event
-            // Any user of the parser thus have to reset the parser when it has
-            // processed a generated event, to make it ready for parsing
-            break;
+    if (ppEvent != NULL) {
+        *ppEvent = pResultEvent;
     }
 
-    gEdmParserState = newState;
+    return consumed;
+}
 
-    return pResultEvent;
+void uShortRangeEdmParserEventFree(uShortRangeEdmParser_t *pParser,
+                                   uShortRangeEdmEvent_t *pEvent)
+{
+    // The event is the first member of the slot
+    uShortRangeEdmParserSlot_t *pSlot = (uShortRangeEdmParserSlot_t *) pEvent;
+
+    if ((pParser != NULL) && (pParser->pSlots != NULL) &&
+        (pSlot >= pParser->pSlots) &&
+        (pSlot < pParser->pSlots + pParser->numSlots)) {
+        slotFree(pParser, pSlot);
+        if (pParser->state == (int32_t) EDM_PARSER_STATE_WAIT_FOR_ROOM) {
+            // See if we can now carry on with the packet that was
+            // waiting (or, if this was the last event in use and
+            // there is still no room, skip it)
+            payloadRoomFind(pParser);
+        }
+    }
 }
 
 int32_t uShortRangeEdmZeroCopyHeadData(uint8_t channel, uint32_t size, char *pHead)
@@ -445,6 +628,23 @@ int32_t uShortRangeEdmZeroCopyHeadData(uint8_t channel, uint32_t size, char *pHe
     return 6;
 }
 
+int32_t uShortRangeEdmZeroCopyHeadRequest(uint32_t size, char *pHead)
+{
+    if (pHead == NULL || size > U_SHORT_RANGE_EDM_MAX_SIZE) {
+        return U_SHORT_RANGE_EDM_ERROR_PARAM;
+    }
+
+    uint32_t edmSize = size + 2;
+
+    *pHead = U_SHORT_RANGE_EDM_HEAD;
+    *(pHead + 1) = (char)(edmSize >> 8);
+    *(pHead + 2) = (char)(edmSize & 0xFF);
+    *(pHead + 3) = 0x00;
+    *(pHead + 4) = U_SHORT_RANGE_EDM_TYPE_AT_REQUEST;
+
+    return U_SHORT_RANGE_EDM_REQUEST_HEAD_SIZE;
+}
+
 //lint -e759 suppress "could be moved from header to module"
 //lint -e765 suppress "could be made static"
 //lint -e714 suppress "not referenced"
@@ -93,39 +93,133 @@ typedef struct {
     } params;
 } uShortRangeEdmEvent_t;
 
+/** A slot in the event pool of an EDM parser.
+ */
+typedef struct {
+    uShortRangeEdmEvent_t event; /**< must be first. */
+    char *pPayload; /**< where the payload of the EDM packet is stored. */
+    size_t offset; /**< the offset of pPayload in the slab. */
+    size_t length; /**< the number of bytes of the slab that are held,
+                        zero if pPayload was malloc()ed. */
+    bool inUse; /**< false once the event has been freed. */
+} uShortRangeEdmParserSlot_t;
+
+/** An EDM parser; there should be one of these per EDM stream.
+ * Each EDM packet, as it arrives, is given a slot from a pool of
+ * events and its payload is placed in a slab of memory, so that
+ * the pointers in the event (e.g. pData of a data event) refer
+ * directly to the slab rather than to a copy.  Slots and slab are
+ * handed out in order and are reclaimed in the same order once
+ * the events using them have been freed; if an event is freed
+ * out of order its slot is reclaimed when the events before it
+ * have been freed.  The parser stalls only when there is no slot
+ * or no room in the slab for the next packet.
+ */
+typedef struct {
+    int32_t state; /**< the state of the parser. */
+    size_t byteIndex; /**< position in the current part of the packet. */
+    uint16_t payloadLength; /**< the payload length of the current packet. */
+    uShortRangeEdmParserSlot_t *pSlots; /**< the event pool. */
+    size_t numSlots; /**< the number of slots at pSlots. */
+    size_t slotHead; /**< the next slot to be handed out. */
+    size_t slotTail; /**< the oldest slot not yet reclaimed. */
+    size_t slotCount; /**< the number of slots not yet reclaimed. */
+    char *pSlab; /**< the slab from which payloads are taken. */
+    size_t slabSize; /**< the size of the slab in bytes. */
+    size_t slabHead; /**< where the next payload goes in the slab. */
+    bool slabWrapped; /**< true if slabHead has wrapped around to
+                           behind the oldest payload in the slab. */
+    void *(*pMalloc) (size_t); /**< used for a payload which is larger
+                                    than the slab: malloc() unless
+                                    replaced after initialisation,
+                                    e.g. by a test. */
+    size_t numDropped; /**< the number of packets dropped because
+                            there was nowhere to put them. */
+} uShortRangeEdmParser_t;
+
 /**
  *
- * @brief Check if EDM parser is available
+ * @brief Initialise an EDM parser, allocating its event pool
+ *        and payload slab.
+ *
+ * @param[out] pParser     a pointer to the parser.
+ * @param maxNumEvents     the number of EDM events that may be
+ *                         in flight at any one time, including
+ *                         the one being parsed; must be at least 1.
+ * @param slabSizeBytes    the size of the slab from which payloads
+ *                         are taken.  A payload which is larger than
+ *                         this is malloc()ed instead; if that fails
+ *                         while no events are in use, when there is
+ *                         no prospect of memory being freed, the
+ *                         packet is dropped.
  *
- * @note  Do not call the uShortRangeEdmParse function if this function
- *        returns false.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uShortRangeEdmParserInit(uShortRangeEdmParser_t *pParser,
+                                 size_t maxNumEvents, size_t slabSizeBytes);
+
+/**
+ *
+ * @brief Deinitialise an EDM parser, freeing all of its events
+ *        and memory.  Any events obtained from the parser must
+ *        no longer be used.
  *
- * @return True if EDM parser is available
+ * @param[in] pParser  a pointer to the parser.
  */
-bool uShortRangeEdmParserReady(void);
+void uShortRangeEdmParserDeinit(uShortRangeEdmParser_t *pParser);
 
 /**
  *
- * @brief Reset the parser. Do this every time the latest EDM event
- *        has been processed to make the parser available again.
+ * @brief Check if an EDM parser is able to accept more data.
+ *
+ * @note  There is no point in calling uShortRangeEdmParse() if
+ *        this function returns false: no data will be consumed.
+ *        The parser becomes available again when an event is
+ *        freed with uShortRangeEdmParserEventFree().
+ *
+ * @param[in] pParser  a pointer to the parser.
+ *
+ * @return             true if the EDM parser is available.
  */
-void uShortRangeEdmResetParser(void);
+bool uShortRangeEdmParserReady(const uShortRangeEdmParser_t *pParser);
 
 /**
  *
- * @brief Function for parsing binary EDM data
+ * @brief Parse a buffer of binary EDM data.  Parsing stops at the
+ *        end of the buffer, when an event is generated or when the
+ *        parser stalls for lack of an event or slab space; the
+ *        caller should call this function again with the remainder
+ *        of the buffer.
  *
- * @note  Do not call this function if parser is not available,
- *        Check if parser is available with uShortRangeEdmParserAvailable
- *        If a packet is invalid it will be silently dropped
+ * @note  If a packet is invalid it will be silently dropped.
  *
- * @param  c Input character
+ * @param[in] pParser  a pointer to the parser.
+ * @param[in] pBuffer  the received data.
+ * @param length       the number of bytes at pBuffer.
+ * @param[out] ppEvent set to point to the event generated or
+ *                     NULL if no event was generated.  An event
+ *                     is generated when the last byte of a valid
+ *                     EDM packet is parsed; it must be freed
+ *                     with uShortRangeEdmParserEventFree() once
+ *                     it, and any data it points to, has been
+ *                     processed.
  *
- * @return Pointer to event, NULL if no event was generated.
- *         An event is created when the last character in a EDM packet
- *         is parsed and the packet is valid
+ * @return             the number of bytes consumed from pBuffer.
  */
-uShortRangeEdmEvent_t *uShortRangeEdmParse(char c);
+size_t uShortRangeEdmParse(uShortRangeEdmParser_t *pParser,
+                           const char *pBuffer, size_t length,
+                           uShortRangeEdmEvent_t **ppEvent);
+
+/**
+ *
+ * @brief Free an event returned by uShortRangeEdmParse().  Events
+ *        may be freed in any order.
+ *
+ * @param[in] pParser  a pointer to the parser.
+ * @param[in] pEvent   the event to free.
+ */
+void uShortRangeEdmParserEventFree(uShortRangeEdmParser_t *pParser,
+                                   uShortRangeEdmEvent_t *pEvent);
 
 /**
  *
@@ -182,6 +276,22 @@ int32_t uShortRangeEdmData(uint8_t channel, const char *pData, int32_t size, cha
  */
 int32_t uShortRangeEdmZeroCopyHeadData(uint8_t channel, uint32_t size, char *pHead);
 
+/**
+ *
+ * @brief Creates an EDM AT request packet header
+ *
+ * @details As uShortRangeEdmZeroCopyHeadData() but for an AT request.<br>
+ *          Valid EDM packet: head + AT command + tail.
+ *
+ * @param[in] size Size of the AT command.
+ * @param[out] pHead Pointer to a memory where the EDM packet head is created. This need
+ *             to be an allocated memory area of U_SHORT_RANGE_EDM_REQUEST_HEAD_SIZE.
+ *
+ * @retval Number of bytes used in the head memory.
+ * @retval U_SHORT_RANGE_EDM_ERROR_PARAM Input pointer and null or size is to large.
+ */
+int32_t uShortRangeEdmZeroCopyHeadRequest(uint32_t size, char *pHead);
+
 /**
  *
  * @brief Creates an EDM data packet tail. Valid for both AT request and data.
@@ -61,9 +61,24 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 #define U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH  200
-// TODO: is this value correc?
-#define U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH 500
 #define U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS    9
+#define U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH   128
+
+// The maximum number of EDM data frames that
+// uShortRangeEdmStreamWrite() gathers into one UART write.
+#ifndef U_SHORT_RANGE_EDM_STREAM_WRITEV_MAX_FRAMES
+# define U_SHORT_RANGE_EDM_STREAM_WRITEV_MAX_FRAMES 4
+#endif
+
+// The number of EDM events the parser may have in flight: each
+// one may be sitting in the event queue, and one place in the
+// queue is kept free for uShortRangeEdmStreamAtEventSend(), so
+// that the uart callback never blocks on a full queue.
+#if U_EDM_STREAM_EVENT_QUEUE_SIZE > 1
+# define U_SHORT_RANGE_EDM_STREAM_NUM_EDM_EVENTS (U_EDM_STREAM_EVENT_QUEUE_SIZE - 1)
+#else
+# define U_SHORT_RANGE_EDM_STREAM_NUM_EDM_EVENTS 1
+#endif
 
 // Debug logging for EDM activity
 // You can activate debug log output for EDM activity with the defines below
@@ -141,10 +156,14 @@ typedef struct {
     int32_t channel;
     char *pData;
     int32_t length;
+    // Looked up on arrival, in order with any disconnect,
+    // since a disconnect forgets the connection
+    uShortRangeConnectionType_t connectionType;
 } uShortRangeEdmStreamDataEvent_t;
 
 typedef struct {
     uShortRangeEdmStreamEventType_t type;
+    uShortRangeEdmEvent_t *pEdmEvent; // To be freed once processed, NULL for AT
     union {
         // no content in at event       at;
         uShortRangeEdmStreamBtEvent_t   bt;
@@ -158,6 +177,14 @@ typedef struct {
     int32_t frameSize;
 } uBtConnectionParams_t;
 
+// Data which a data event callback has not yet taken.
+typedef struct {
+    uShortRangeEdmEvent_t *pEdmEvent;
+    uShortRangeConnectionType_t type;
+    int32_t offset; // The amount the callback has already taken
+    bool paused;
+} uShortRangeEdmStreamHeldData_t;
+
 typedef struct {
     int32_t channel;
     uShortRangeConnectionType_t type;
@@ -187,10 +214,24 @@ typedef struct uEdmStreamInstance_t {
     void *pMqttDataCallbackParam;
     char *pAtCommandBuffer;
     int32_t atCommandCurrent;
-    char *pAtResponseBuffer;
-    int32_t atResponseLength;
+    // AT events waiting to be read, oldest first
+    uShortRangeEdmEvent_t *pAtEvents[U_SHORT_RANGE_EDM_STREAM_NUM_EDM_EVENTS];
+    size_t atEventFirst;
+    size_t atEventCount;
     int32_t atResponseRead;
+    // Data events not yet taken by their callback, oldest first;
+    // can't overflow since the parser has no more EDM events
+    // than there are entries
+    uShortRangeEdmStreamHeldData_t heldData[U_SHORT_RANGE_EDM_STREAM_NUM_EDM_EVENTS];
+    size_t heldDataCount;
+    // Set by uShortRangeEdmStreamDataResume() to have the uart
+    // callback deliver held data
+    bool dataResumed;
     uShortRangeEdmStreamConnections_t connections[U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS];
+    uShortRangeEdmParser_t parser;
+    char rxBuffer[U_SHORT_RANGE_EDM_STREAM_RX_BUFFER_LENGTH];
+    size_t rxBufferRead;
+    size_t rxBufferLength;
 } uShortRangeEdmStreamInstance_t;
 
 /* ----------------------------------------------------------------
@@ -270,12 +311,18 @@ static uShortRangeEdmStreamConnections_t *findConnection(int32_t channel)
     return pConnection;
 }
 
-static void processedEvent(void)
+// Give an EDM event back to the parser; gMutex must be locked.
+static void processedEvent(uShortRangeEdmEvent_t *pEdmEvent)
 {
-    uShortRangeEdmResetParser();
-    // Trigger an event from the uart to get parsing going again
-    uPortUartEventSend(gEdmStream.uartHandle,
-                       U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+    bool parserReady = uShortRangeEdmParserReady(&gEdmStream.parser);
+
+    uShortRangeEdmParserEventFree(&gEdmStream.parser, pEdmEvent);
+    if (!parserReady && uShortRangeEdmParserReady(&gEdmStream.parser)) {
+        // The parser had stalled waiting for this, trigger
+        // an event from the uart to get parsing going again
+        uPortUartEventSend(gEdmStream.uartHandle,
+                           U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+    }
 }
 
 static void atEventHandler(void)
@@ -297,7 +344,6 @@ static void btEventHandler(uShortRangeEdmStreamBtEvent_t *pBtEvent)
                                     &pBtEvent->conData, gEdmStream.pBtEventCallbackParam);
     }
     uEdmChLogLine(LOG_CH_BT, "processed");
-    processedEvent();
 }
 
 // Event handler, calls the user's event callback.
@@ -309,7 +355,6 @@ static void ipEventHandler(uShortRangeEdmStreamIpEvent_t *pIpEvent)
     }
 
     uEdmChLogLine(LOG_CH_IP, "processed");
-    processedEvent();
 }
 
 // Event handler, calls the user's event callback.
@@ -320,48 +365,114 @@ static void mqttEventHandler(uShortRangeEdmStreamIpEvent_t *pMqttEvent)
                                       &pMqttEvent->conData, gEdmStream.pMqttEventCallbackParam);
     }
     uEdmChLogLine(LOG_CH_IP, "processed");
-    processedEvent();
 }
 
-static void dataEventHandler(uShortRangeEdmStreamDataEvent_t *pDataEvent)
+// Call the data callback for the given connection type, returning
+// the amount of data it has taken; gMutex must be locked.
+static int32_t dataCallback(uShortRangeConnectionType_t type, int32_t channel,
+                            int32_t length, char *pData)
 {
-    uShortRangeEdmStreamConnections_t *pConnection;
+    int32_t taken = length;
 
-    U_PORT_MUTEX_LOCK(gMutex);
-    pConnection = findConnection(pDataEvent->channel);
+    switch (type) {
 
-    if (pConnection != NULL) {
-        switch (pConnection->type) {
+        case U_SHORT_RANGE_CONNECTION_TYPE_BT:
+            if (gEdmStream.pBtDataCallback != NULL) {
+                taken = gEdmStream.pBtDataCallback(gEdmStream.handle, channel, length,
+                                                   pData, gEdmStream.pBtDataCallbackParam);
+            }
+            break;
 
-            case U_SHORT_RANGE_CONNECTION_TYPE_BT:
-                if (gEdmStream.pBtDataCallback != NULL) {
-                    gEdmStream.pBtDataCallback(gEdmStream.handle, pDataEvent->channel, pDataEvent->length,
-                                               pDataEvent->pData, gEdmStream.pBtDataCallbackParam);
-                }
-                break;
+        case U_SHORT_RANGE_CONNECTION_TYPE_IP:
+            if (gEdmStream.pIpDataCallback != NULL) {
+                taken = gEdmStream.pIpDataCallback(gEdmStream.handle, channel, length,
+                                                   pData, gEdmStream.pIpDataCallbackParam);
+            }
+            break;
 
-            case U_SHORT_RANGE_CONNECTION_TYPE_IP:
-                if (gEdmStream.pIpDataCallback != NULL) {
-                    gEdmStream.pIpDataCallback(gEdmStream.handle, pDataEvent->channel, pDataEvent->length,
-                                               pDataEvent->pData, gEdmStream.pIpDataCallbackParam);
-                }
-                break;
+        case U_SHORT_RANGE_CONNECTION_TYPE_MQTT:
+            if (gEdmStream.pMqttDataCallback != NULL) {
+                taken = gEdmStream.pMqttDataCallback(gEdmStream.handle, channel, length,
+                                                     pData, gEdmStream.pMqttDataCallbackParam);
+            }
+            break;
 
-            case U_SHORT_RANGE_CONNECTION_TYPE_MQTT:
-                if (gEdmStream.pMqttDataCallback != NULL) {
-                    gEdmStream.pMqttDataCallback(gEdmStream.handle, pDataEvent->channel, pDataEvent->length,
-                                                 pDataEvent->pData, gEdmStream.pMqttDataCallbackParam);
-                }
-                break;
+        case U_SHORT_RANGE_CONNECTION_TYPE_INVALID:
+        default:
+            break;
+    }
 
-            case U_SHORT_RANGE_CONNECTION_TYPE_INVALID:
-            default:
-                break;
+    return taken;
+}
+
+// Offer held data to the data callbacks, oldest first, skipping
+// paused channels and anything behind them; gMutex must be locked.
+static void heldDataDeliver(void)
+{
+    uShortRangeEdmStreamHeldData_t *pHeld;
+    int32_t channel;
+    int32_t length;
+    int32_t taken;
+    bool blocked;
+    size_t x = 0;
+
+    while (x < gEdmStream.heldDataCount) {
+        pHeld = &(gEdmStream.heldData[x]);
+        channel = pHeld->pEdmEvent->params.dataEvent.channel;
+        blocked = pHeld->paused;
+        for (size_t y = 0; !blocked && (y < x); y++) {
+            // Stay behind earlier data for the same channel
+            blocked = (gEdmStream.heldData[y].pEdmEvent->params.dataEvent.channel == channel);
         }
+        if (!blocked) {
+            length = pHeld->pEdmEvent->params.dataEvent.length - pHeld->offset;
+            taken = dataCallback(pHeld->type, channel, length,
+                                 pHeld->pEdmEvent->params.dataEvent.pData + pHeld->offset);
+            if ((taken < 0) || (taken >= length)) {
+                // All gone: give the EDM event back to the parser
+                processedEvent(pHeld->pEdmEvent);
+                gEdmStream.heldDataCount--;
+                memmove(pHeld, pHeld + 1,
+                        (gEdmStream.heldDataCount - x) * sizeof(*pHeld));
+                uEdmChLogLine(LOG_CH_DATA, "processed");
+            } else {
+                // The callback has had enough, pause the channel
+                pHeld->offset += taken;
+                pHeld->paused = true;
+                uEdmChLogLine(LOG_CH_DATA, "ch: %d, paused", channel);
+                x++;
+            }
+        } else {
+            x++;
+        }
+    }
+}
+
+// Handle a data event, which just adds it to the held data for
+// delivery.
+static void dataEventHandler(uShortRangeEdmEvent_t *pEdmEvent,
+                             uShortRangeConnectionType_t connectionType)
+{
+    uShortRangeEdmStreamHeldData_t *pHeld;
+
+    U_PORT_MUTEX_LOCK(gMutex);
+
+    if ((pEdmEvent != NULL) &&
+        (gEdmStream.heldDataCount < sizeof(gEdmStream.heldData) / sizeof(gEdmStream.heldData[0]))) {
+        // Put it on the end of the list and deliver from there
+        pHeld = &(gEdmStream.heldData[gEdmStream.heldDataCount]);
+        pHeld->pEdmEvent = pEdmEvent;
+        pHeld->type = connectionType;
+        pHeld->offset = 0;
+        pHeld->paused = false;
+        gEdmStream.heldDataCount++;
+    } else if (pEdmEvent != NULL) {
+        // Shouldn't happen, see heldData
+        uPortLog("U_SHO_EDM_STREAM: no room to hold data, dropping %d byte(s)!\n",
+                 pEdmEvent->params.dataEvent.length);
+        processedEvent(pEdmEvent);
     }
 
-    uEdmChLogLine(LOG_CH_DATA, "processed");
-    processedEvent();
     U_PORT_MUTEX_UNLOCK(gMutex);
 }
 
@@ -393,36 +504,58 @@ static void eventHandler(void *pParam, size_t paramLength)
             break;
 
         case U_SHORT_RANGE_EDM_STREAM_EVENT_DATA:
-            dataEventHandler(&(pEvent->data));
+            // The data may be held on to by the stream,
+            // which will give back the EDM event itself
+            dataEventHandler(pEvent->pEdmEvent, pEvent->data.connectionType);
+            pEvent->pEdmEvent = NULL;
             break;
 
         default:
             break;
     }
+
+    U_PORT_MUTEX_LOCK(gMutex);
+    if (pEvent->pEdmEvent != NULL) {
+        // Done with the EDM event, and hence its data
+        processedEvent(pEvent->pEdmEvent);
+    }
+    // Whatever the event, take the opportunity to deliver
+    // data, e.g. for a channel that has been resumed
+    heldDataDeliver();
+    U_PORT_MUTEX_UNLOCK(gMutex);
 }
 
+// Add an AT event to the list of those waiting to be read by
+// uShortRangeEdmStreamAtRead(), which will free it, and let
+// the AT client know.
 static bool enqueueEdmAtEvent(uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
-
     uShortRangeEdmStreamEvent_t event;
-
-    gEdmStream.atResponseLength = pEvent->params.atEvent.length;
-    gEdmStream.atResponseRead = 0;
-    memcpy(gEdmStream.pAtResponseBuffer, pEvent->params.atEvent.pData, gEdmStream.atResponseLength);
+    size_t x;
+
+    // Can't overflow since the parser has no more EDM
+    // events than there are entries in pAtEvents
+    if (gEdmStream.atEventCount < sizeof(gEdmStream.pAtEvents) / sizeof(gEdmStream.pAtEvents[0])) {
+        x = (gEdmStream.atEventFirst + gEdmStream.atEventCount) %
+            (sizeof(gEdmStream.pAtEvents) / sizeof(gEdmStream.pAtEvents[0]));
+        gEdmStream.pAtEvents[x] = pEvent;
+        gEdmStream.atEventCount++;
+        success = true;
 
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
-    uEdmChLogStart(LOG_CH_AT_RX, "\"");
-    dumpAtData(gEdmStream.pAtResponseBuffer, gEdmStream.atResponseLength);
-    uEdmChLogEnd("\"");
+        uEdmChLogStart(LOG_CH_AT_RX, "\"");
+        dumpAtData(pEvent->params.atEvent.pData, pEvent->params.atEvent.length);
+        uEdmChLogEnd("\"");
 #endif
 
-    event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_AT;
-    if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
-                            &event, sizeof(uShortRangeEdmStreamEvent_t)) == 0) {
-        success = true;
-    } else {
-        uPortLog("U_SHO_EDM_STREAM: Failed to enqueue message\n");
+        event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_AT;
+        event.pEdmEvent = NULL;
+        if (uPortEventQueueSend(gEdmStream.eventQueueHandle,
+                                &event, sizeof(uShortRangeEdmStreamEvent_t)) != 0) {
+            // The data is still there to be read
+            uPortLog("U_SHO_EDM_STREAM: Failed to enqueue message\n");
+        }
     }
 
     return success;
@@ -440,6 +573,7 @@ static bool enqueueEdmConnectBtEvent(uShortRangeEdmEvent_t *pEvent)
     }
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
+        event.pEdmEvent = pEvent;
         pConnection->channel = pEvent->params.btConnectEvent.channel;
         pConnection->type = U_SHORT_RANGE_CONNECTION_TYPE_BT;
         pConnection->bt.frameSize = pEvent->params.btConnectEvent.connection.framesize;
@@ -479,6 +613,7 @@ static bool enqueueEdmConnectIpv4Event(uShortRangeEdmEvent_t *pEvent)
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
         uShortRangeEdmConnectionEventIpv4_t *ipv4Evt = &pEvent->params.ipv4ConnectEvent;
+        event.pEdmEvent = pEvent;
         uShortRangeIpProtocol_t protocol = ipv4Evt->connection.protocol;
         // IPv4 events are generated by TCP, UDP and MQTT connections
         // Since MQTT and TCP/UDP have separate callbacks we need to
@@ -540,6 +675,7 @@ static bool enqueueEdmConnectIpv6Event(uShortRangeEdmEvent_t *pEvent)
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
         uShortRangeEdmConnectionEventIpv6_t *ipv6Evt = &pEvent->params.ipv6ConnectEvent;
+        event.pEdmEvent = pEvent;
         uShortRangeIpProtocol_t protocol = ipv6Evt->connection.protocol;
         // IPv4 events are generated by TCP, UDP and MQTT connections
         // Since MQTT and TCP/UDP have separate callbacks we need to
@@ -592,6 +728,7 @@ static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
 
     if (pConnection != NULL) {
         uShortRangeEdmStreamEvent_t event;
+        event.pEdmEvent = pEvent;
         switch (pConnection->type) {
             case U_SHORT_RANGE_CONNECTION_TYPE_BT:
                 event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_BT;
@@ -651,12 +788,19 @@ static bool enqueueEdmDisconnectEvent(uShortRangeEdmEvent_t *pEvent)
 static bool enqueueEdmDataEvent(uShortRangeEdmEvent_t *pEvent)
 {
     bool success = false;
+    uShortRangeEdmStreamConnections_t *pConnection;
 
     uShortRangeEdmStreamEvent_t event;
     event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_DATA;
+    event.pEdmEvent = pEvent;
     event.data.channel = pEvent->params.dataEvent.channel;
     event.data.pData = pEvent->params.dataEvent.pData;
     event.data.length = pEvent->params.dataEvent.length;
+    event.data.connectionType = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
+    pConnection = findConnection(event.data.channel);
+    if (pConnection != NULL) {
+        event.data.connectionType = pConnection->type;
+    }
 
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
 # ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG_DUMP_DATA
@@ -717,7 +861,7 @@ static void processEdmEvent(uShortRangeEdmEvent_t *pEvent)
 
     if (!enqueued) {
         /* No event was enqueued to the event queue so we simply consume the event */
-        processedEvent();
+        processedEvent(pEvent);
     }
 }
 
@@ -728,42 +872,47 @@ static void uartCallback(int32_t uartHandle, uint32_t eventBitmask,
     if (gEdmStream.uartHandle == uartHandle &&
         eventBitmask == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) {
         bool uartEmpty = false;
+        uShortRangeEdmEvent_t *pEvent;
         // We don't want to read one character at the time from the uart driver since that will be
         // quite an overhead when pumping a lot of data. Instead we read into a buffer
-        // and then comsume characters from that. But we might not consume all read characters
-        // before an EDM-event is generated by the parser which makes the parser unavailable
-        // and we have to leave this callback. When the parser later is available this
-        // uart-event will be placed on the queue again so that we come back here.
-        // We thus need a static buffer, and if there are unparsed characters left in it we move
-        // them to the beginning of the buffer befor leaving (instead of using a ring buffer).
+        // and hand that to the parser. The parser only becomes unavailable when all of its
+        // events are in use, in which case we have to leave this callback with data still in
+        // the buffer; when an event has been processed and the parser is available again
+        // this uart-event will be placed on the queue again so that we come back here.
         U_PORT_MUTEX_LOCK(gMutex);
-        while (!uartEmpty && uShortRangeEdmParserReady()) {
+        if (gEdmStream.dataResumed) {
+            // A channel has been resumed: deliver what we can of the
+            // held data from here since there's no room in the event
+            // queue to ask the event task to do it
+            gEdmStream.dataResumed = false;
+            heldDataDeliver();
+        }
+        while (!uartEmpty && uShortRangeEdmParserReady(&gEdmStream.parser)) {
             // Loop until we couldn't read any more characters from uart
             // or EDM parser is unavailable
-            static char buffer[128];
-            static size_t charsInBuffer = 0;
-            size_t consumed = 0;
 
             // Check if there are any existing characters in the buffer and parse them
-            while (uShortRangeEdmParserReady() && (consumed < charsInBuffer)) {
-                //lint -esym(727, buffer)
-                uShortRangeEdmEvent_t *pEvent = uShortRangeEdmParse(buffer[consumed++]);
+            while (uShortRangeEdmParserReady(&gEdmStream.parser) &&
+                   (gEdmStream.rxBufferRead < gEdmStream.rxBufferLength)) {
+                gEdmStream.rxBufferRead += uShortRangeEdmParse(&gEdmStream.parser,
+                                                               gEdmStream.rxBuffer +
+                                                               gEdmStream.rxBufferRead,
+                                                               gEdmStream.rxBufferLength -
+                                                               gEdmStream.rxBufferRead,
+                                                               &pEvent);
                 if (pEvent != NULL) {
                     processEdmEvent(pEvent);
                 }
             }
-            // Move unparsed data to beginning of buffer
-            if ((consumed > 0) && (charsInBuffer - consumed) > 0) {
-                memmove(buffer, buffer + consumed, charsInBuffer - consumed);
-            }
-            charsInBuffer -= consumed;
 
-            // Read as much as possible from uart into rest of buffer
-            if (charsInBuffer < sizeof buffer) {
-                int32_t sizeOrError = uPortUartRead(gEdmStream.uartHandle, buffer + charsInBuffer,
-                                                    sizeof buffer - charsInBuffer);
+            // Read as much as possible from uart into the buffer once it is empty
+            if (gEdmStream.rxBufferRead >= gEdmStream.rxBufferLength) {
+                gEdmStream.rxBufferRead = 0;
+                gEdmStream.rxBufferLength = 0;
+                int32_t sizeOrError = uPortUartRead(gEdmStream.uartHandle, gEdmStream.rxBuffer,
+                                                    sizeof(gEdmStream.rxBuffer));
                 if (sizeOrError > 0) {
-                    charsInBuffer += sizeOrError;
+                    gEdmStream.rxBufferLength = sizeOrError;
                 } else {
                     uartEmpty = true;
                 }
@@ -794,28 +943,32 @@ static int32_t uartWrite(const void *pData, size_t length)
 // EDM packet overhead.
 static int32_t edmSend(const uShortRangeEdmStreamInstance_t *pEdmStream)
 {
-    char *pPacket;
-    size_t written = 0;
-    int32_t sizeOrError = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-
-    pPacket = (char *) malloc(U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH +
-                              U_SHORT_RANGE_EDM_REQUEST_OVERHEAD);
-    if (pPacket != NULL) {
-        sizeOrError = uShortRangeEdmRequest(pEdmStream->pAtCommandBuffer,
-                                            pEdmStream->atCommandCurrent,
-                                            pPacket);
-        if (sizeOrError > 0) {
+    char head[U_SHORT_RANGE_EDM_REQUEST_HEAD_SIZE];
+    char tail[U_SHORT_RANGE_EDM_TAIL_SIZE];
+    uPortUartIoVec_t ioVec[3];
+    int32_t sizeOrError;
+
+    // Send head, AT command and tail in one go, straight
+    // from the AT command buffer
+    sizeOrError = uShortRangeEdmZeroCopyHeadRequest((uint32_t) pEdmStream->atCommandCurrent,
+                                                    head);
+    if (sizeOrError > 0) {
+        (void) uShortRangeEdmZeroCopyTail(tail);
+        ioVec[0].pBuffer = head;
+        ioVec[0].sizeBytes = sizeof(head);
+        ioVec[1].pBuffer = pEdmStream->pAtCommandBuffer;
+        ioVec[1].sizeBytes = pEdmStream->atCommandCurrent;
+        ioVec[2].pBuffer = tail;
+        ioVec[2].sizeBytes = sizeof(tail);
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
-            uEdmChLogStart(LOG_CH_AT_TX, "\"");
-            dumpAtData(pEdmStream->pAtCommandBuffer, pEdmStream->atCommandCurrent);
-            uEdmChLogEnd("\"");
+        uEdmChLogStart(LOG_CH_AT_TX, "\"");
+        dumpAtData(pEdmStream->pAtCommandBuffer, pEdmStream->atCommandCurrent);
+        uEdmChLogEnd("\"");
 #endif
-            while (written < (uint32_t) sizeOrError) {
-                written += uartWrite((void *) (pPacket + written),
-                                     (uint32_t) sizeOrError - written);
-            }
-        }
-        free(pPacket);
+        sizeOrError = uPortUartWritev(pEdmStream->uartHandle, ioVec,
+                                      sizeof(ioVec) / sizeof(ioVec[0]));
+    } else {
+        sizeOrError = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     }
 
     return sizeOrError;
@@ -886,15 +1039,11 @@ int32_t uShortRangeEdmStreamInit()
         gEdmStream.handle = -1;
     }
 
-    uShortRangeEdmResetParser();
-
     return (int32_t) errorCodeOrHandle;
 }
 
 void uShortRangeEdmStreamDeinit()
 {
-    uShortRangeEdmResetParser();
-
     if (gMutex != NULL) {
 
         U_PORT_MUTEX_LOCK(gMutex);
@@ -930,11 +1079,13 @@ int32_t uShortRangeEdmStreamOpen(int32_t uartHandle)
             if (errorCode == 0) {
                 gEdmStream.pAtCommandBuffer = (char *)malloc(U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH);
                 memset(gEdmStream.pAtCommandBuffer, 0, U_SHORT_RANGE_EDM_STREAM_AT_COMMAND_LENGTH);
-                gEdmStream.pAtResponseBuffer = (char *)malloc(U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
-                memset(gEdmStream.pAtResponseBuffer, 0, U_SHORT_RANGE_EDM_STREAM_AT_RESPONSE_LENGTH);
                 if (gEdmStream.pAtCommandBuffer == NULL ||
-                    gEdmStream.pAtResponseBuffer == NULL) {
+                    uShortRangeEdmParserInit(&gEdmStream.parser,
+                                             U_SHORT_RANGE_EDM_STREAM_NUM_EDM_EVENTS,
+                                             U_EDM_STREAM_PAYLOAD_SLAB_SIZE_BYTES) != 0) {
                     handleOrErrorCode = U_ERROR_COMMON_NO_MEMORY;
+                    free(gEdmStream.pAtCommandBuffer);
+                    gEdmStream.pAtCommandBuffer = NULL;
                     uPortUartEventCallbackRemove(uartHandle);
                 } else {
                     gEdmStream.eventQueueHandle
@@ -965,6 +1116,11 @@ int32_t uShortRangeEdmStreamOpen(int32_t uartHandle)
                     gEdmStream.pMqttDataCallback = NULL;
                     gEdmStream.pMqttDataCallbackParam = NULL;
                     gEdmStream.atCommandCurrent = 0;
+                    gEdmStream.atEventFirst = 0;
+                    gEdmStream.atEventCount = 0;
+                    gEdmStream.atResponseRead = 0;
+                    gEdmStream.rxBufferRead = 0;
+                    gEdmStream.rxBufferLength = 0;
 
                     for (uint32_t i = 0; i < U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS; i++) {
                         gEdmStream.connections[i].channel = -1;
@@ -976,7 +1132,6 @@ int32_t uShortRangeEdmStreamOpen(int32_t uartHandle)
                 }
             }
         }
-        uShortRangeEdmResetParser();
         U_PORT_MUTEX_UNLOCK(gMutex);
     }
 
@@ -1026,15 +1181,22 @@ void uShortRangeEdmStreamClose(int32_t handle)
             gEdmStream.pMqttDataCallbackParam = NULL;
             free(gEdmStream.pAtCommandBuffer);
             gEdmStream.pAtCommandBuffer = NULL;
-            free(gEdmStream.pAtResponseBuffer);
-            gEdmStream.pAtResponseBuffer = NULL;
+            // The event queue is closed so nothing else can be
+            // holding an EDM event: free the lot
+            uShortRangeEdmParserDeinit(&gEdmStream.parser);
+            gEdmStream.atEventFirst = 0;
+            gEdmStream.atEventCount = 0;
+            gEdmStream.atResponseRead = 0;
+            gEdmStream.heldDataCount = 0;
+            gEdmStream.dataResumed = false;
+            gEdmStream.rxBufferRead = 0;
+            gEdmStream.rxBufferLength = 0;
             for (uint32_t i = 0; i < U_SHORT_RANGE_EDM_STREAM_MAX_CONNECTIONS; i++) {
                 gEdmStream.connections[i].channel = -1;
                 gEdmStream.connections[i].type = U_SHORT_RANGE_CONNECTION_TYPE_INVALID;
             }
         }
 
-        uShortRangeEdmResetParser();
         U_PORT_MUTEX_UNLOCK(gMutex);
     }
 }
@@ -1244,6 +1406,42 @@ void uShortRangeEdmStreamDataEventCallbackRemove(int32_t handle,
                                              NULL);
 }
 
+int32_t uShortRangeEdmStreamDataResume(int32_t handle, int32_t channel)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t uartHandle = -1;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((handle == gEdmStream.handle) && (channel >= 0)) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            for (size_t x = 0; x < gEdmStream.heldDataCount; x++) {
+                if (gEdmStream.heldData[x].paused &&
+                    (gEdmStream.heldData[x].pEdmEvent->params.dataEvent.channel == channel)) {
+                    gEdmStream.heldData[x].paused = false;
+                    gEdmStream.dataResumed = true;
+                    uartHandle = gEdmStream.uartHandle;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (uartHandle >= 0) {
+            // Wake up the uart callback to deliver the held data;
+            // this uses the uart event queue, not ours, so it is fine
+            // to be called from our event task, and if the uart event
+            // queue is full then the uart callback is going to run anyway
+            uPortUartEventSend(uartHandle, U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED);
+        }
+    }
+
+    return errorCode;
+}
+
 void uShortRangeEdmStreamSetAtHandle(int32_t handle, void *atHandle)
 {
     if (handle == gEdmStream.handle) {
@@ -1295,19 +1493,28 @@ int32_t uShortRangeEdmStreamAtRead(int32_t handle, void *pBuffer,
         U_PORT_MUTEX_LOCK(gMutex);
         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
         if (gEdmStream.handle == handle && pBuffer != NULL && sizeBytes != 0) {
-            sizeOrErrorCode = (int32_t)(gEdmStream.atResponseLength - gEdmStream.atResponseRead);
-            if (sizeOrErrorCode > 0) {
-                if (sizeBytes < (uint32_t)sizeOrErrorCode) {
-                    sizeOrErrorCode = (int32_t)sizeBytes;
+            sizeOrErrorCode = 0;
+            // Copy out of as many AT events as will fit, freeing
+            // each one once it has been completely read
+            while ((gEdmStream.atEventCount > 0) &&
+                   ((size_t)sizeOrErrorCode < sizeBytes)) {
+                uShortRangeEdmEvent_t *pEvent = gEdmStream.pAtEvents[gEdmStream.atEventFirst];
+                int32_t length = pEvent->params.atEvent.length - gEdmStream.atResponseRead;
+                if (length > (int32_t)(sizeBytes - sizeOrErrorCode)) {
+                    length = (int32_t)(sizeBytes - sizeOrErrorCode);
                 }
-                memcpy(pBuffer, gEdmStream.pAtResponseBuffer + gEdmStream.atResponseRead, sizeOrErrorCode);
-                gEdmStream.atResponseRead += sizeOrErrorCode;
+                memcpy((char *)pBuffer + sizeOrErrorCode,
+                       pEvent->params.atEvent.pData + gEdmStream.atResponseRead, length);
+                gEdmStream.atResponseRead += length;
+                sizeOrErrorCode += length;
 
-                if (gEdmStream.atResponseRead >= gEdmStream.atResponseLength) {
-                    gEdmStream.atResponseLength = 0;
+                if (gEdmStream.atResponseRead >= pEvent->params.atEvent.length) {
                     gEdmStream.atResponseRead = 0;
+                    gEdmStream.atEventFirst = (gEdmStream.atEventFirst + 1) %
+                                              (sizeof(gEdmStream.pAtEvents) / sizeof(gEdmStream.pAtEvents[0]));
+                    gEdmStream.atEventCount--;
                     uEdmChLogLine(LOG_CH_AT_RX, "processed");
-                    processedEvent();
+                    processedEvent(pEvent);
                 }
             }
         }
@@ -1333,41 +1540,59 @@ int32_t uShortRangeEdmStreamWrite(int32_t handle, int32_t channel,
             if (pConnection != NULL) {
                 int32_t sent;
                 int32_t send;
-                char head[U_SHORT_RANGE_EDM_DATA_HEAD_SIZE];
+                int32_t batch;
+                size_t numFrames;
+                char head[U_SHORT_RANGE_EDM_STREAM_WRITEV_MAX_FRAMES][U_SHORT_RANGE_EDM_DATA_HEAD_SIZE];
                 char tail[U_SHORT_RANGE_EDM_TAIL_SIZE];
+                uPortUartIoVec_t ioVec[U_SHORT_RANGE_EDM_STREAM_WRITEV_MAX_FRAMES * 3];
                 sizeOrErrorCode = 0;
                 int64_t startTime = uPortGetTickTimeMs();
                 int64_t endTime;
 
+                (void)uShortRangeEdmZeroCopyTail((char *)&tail[0]);
                 do {
-                    send = ((int32_t)sizeBytes - sizeOrErrorCode);
-                    if (pConnection->type == U_SHORT_RANGE_CONNECTION_TYPE_BT) {
-                        if (((int32_t)sizeBytes - sizeOrErrorCode) > pConnection->bt.frameSize) {
-                            send = pConnection->bt.frameSize;
+                    // Assemble as many frames as we can into one
+                    // write: the tail is the same for all of them
+                    batch = 0;
+                    numFrames = 0;
+                    while ((numFrames < U_SHORT_RANGE_EDM_STREAM_WRITEV_MAX_FRAMES) &&
+                           ((int32_t)sizeBytes > sizeOrErrorCode + batch)) {
+                        send = ((int32_t)sizeBytes - sizeOrErrorCode - batch);
+                        if (pConnection->type == U_SHORT_RANGE_CONNECTION_TYPE_BT) {
+                            if (send > pConnection->bt.frameSize) {
+                                send = pConnection->bt.frameSize;
+                            }
                         }
-                    }
 
 #ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG
 # ifdef U_CFG_SHORT_RANGE_EDM_STREAM_DEBUG_DUMP_DATA
-                    uEdmChLogStart(LOG_CH_DATA, "TX (%d bytes): ", send);
-                    dumpHexData(((const char *)pBuffer + sizeOrErrorCode), send);
-                    uEdmChLogEnd("");
+                        uEdmChLogStart(LOG_CH_DATA, "TX (%d bytes): ", send);
+                        dumpHexData(((const char *)pBuffer + sizeOrErrorCode + batch), send);
+                        uEdmChLogEnd("");
 # else
-                    uEdmChLogLine(LOG_CH_DATA, "TX (%d bytes)", send);
+                        uEdmChLogLine(LOG_CH_DATA, "TX (%d bytes)", send);
 # endif
 #endif
 
-                    (void)uShortRangeEdmZeroCopyHeadData((uint8_t)channel, send, (char *)&head[0]);
-                    sent = uartWrite((void *)&head[0], U_SHORT_RANGE_EDM_DATA_HEAD_SIZE);
-                    sent += uartWrite((const void *)((const char *)pBuffer + sizeOrErrorCode), send);
-                    (void)uShortRangeEdmZeroCopyTail((char *)&tail[0]);
-                    sent += uartWrite((void *)&tail[0], U_SHORT_RANGE_EDM_TAIL_SIZE);
+                        (void)uShortRangeEdmZeroCopyHeadData((uint8_t)channel, send,
+                                                             (char *)&head[numFrames][0]);
+                        ioVec[numFrames * 3].pBuffer = &head[numFrames][0];
+                        ioVec[numFrames * 3].sizeBytes = U_SHORT_RANGE_EDM_DATA_HEAD_SIZE;
+                        ioVec[(numFrames * 3) + 1].pBuffer = (const char *)pBuffer + sizeOrErrorCode + batch;
+                        ioVec[(numFrames * 3) + 1].sizeBytes = send;
+                        ioVec[(numFrames * 3) + 2].pBuffer = &tail[0];
+                        ioVec[(numFrames * 3) + 2].sizeBytes = U_SHORT_RANGE_EDM_TAIL_SIZE;
+                        batch += send;
+                        numFrames++;
+                    }
 
-                    if (sent != (send + U_SHORT_RANGE_EDM_DATA_HEAD_SIZE + U_SHORT_RANGE_EDM_TAIL_SIZE)) {
+                    sent = uPortUartWritev(gEdmStream.uartHandle, ioVec, numFrames * 3);
+                    if (sent != (batch + (int32_t)numFrames * (U_SHORT_RANGE_EDM_DATA_HEAD_SIZE +
+                                                               U_SHORT_RANGE_EDM_TAIL_SIZE))) {
                         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_DEVICE_ERROR;
                         break;
                     } else {
-                        sizeOrErrorCode += send;
+                        sizeOrErrorCode += batch;
                     }
                     endTime = uPortGetTickTimeMs();
                 } while (((int32_t)sizeBytes > sizeOrErrorCode) &&
@@ -1395,6 +1620,7 @@ int32_t uShortRangeEdmStreamAtEventSend(int32_t handle, uint32_t eventBitMap)
             (eventBitMap == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
             uShortRangeEdmStreamEvent_t event;
             event.type = U_SHORT_RANGE_EDM_STREAM_EVENT_AT;
+            event.pEdmEvent = NULL;
             errorCode = uPortEventQueueSend(gEdmStream.eventQueueHandle,
                                             &event, sizeof(uShortRangeEdmStreamEvent_t));
             if (errorCode != 0) {
@@ -1472,7 +1698,12 @@ int32_t uShortRangeEdmStreamAtGetReceiveSize(int32_t handle)
 
         sizeOrErrorCode = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
         if (handle == gEdmStream.handle) {
-            sizeOrErrorCode = gEdmStream.atResponseLength - gEdmStream.atResponseRead;
+            size_t x = gEdmStream.atEventFirst;
+            sizeOrErrorCode = -gEdmStream.atResponseRead;
+            for (size_t y = 0; y < gEdmStream.atEventCount; y++) {
+                sizeOrErrorCode += gEdmStream.pAtEvents[x]->params.atEvent.length;
+                x = (x + 1) % (sizeof(gEdmStream.pAtEvents) / sizeof(gEdmStream.pAtEvents[0]));
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gMutex);
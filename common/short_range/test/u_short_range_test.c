@@ -35,6 +35,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
+#include "string.h"    // memcpy(), memcmp()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_app_platform_specific.h"
@@ -42,15 +43,17 @@
 #include "u_error_common.h"
 
 #include "u_port.h"
-#if defined U_CFG_TEST_SHORT_RANGE_MODULE_TYPE
+#include "u_port_debug.h"
+#if defined(U_CFG_TEST_SHORT_RANGE_MODULE_TYPE) || \
+    ((U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0))
 #include "u_port_os.h"
 #endif
 #include "u_at_client.h"
 #include "u_short_range_module_type.h"
 #include "u_short_range.h"
+#include "u_short_range_edm.h"
 #if (U_CFG_TEST_UART_A >= 0) || defined(U_CFG_TEST_SHORT_RANGE_MODULE_TYPE)
 #include "u_port_uart.h"
-#include "u_port_debug.h"
 #include "u_short_range_edm_stream.h"
 #endif
 
@@ -64,6 +67,16 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The size of the data payload of each EDM packet in the
+ * EDM parser benchmark.
+ */
+#define U_SHORT_RANGE_TEST_BENCHMARK_PAYLOAD_SIZE 512
+
+/** The number of EDM packets parsed in each sample of the EDM
+ * parser benchmark.
+ */
+#define U_SHORT_RANGE_TEST_BENCHMARK_NUM_PACKETS 16
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -74,6 +87,47 @@
 
 static uShortRangeTestPrivate_t gHandles = {-1, -1, NULL, -1};
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Handle of the UART playing the part of the module.
+ */
+static int32_t gUartBHandle = -1;
+
+/** The most that edmIpDataCallback() will take in one go.
+ */
+static volatile int32_t gIpDataTakeLimit = 0;
+
+/** The number of times edmIpDataCallback() has been called.
+ */
+static volatile int32_t gIpDataCallbackCount = 0;
+
+/** The data taken by edmIpDataCallback().
+ */
+static char gIpData[64];
+
+/** The number of bytes in gIpData.
+ */
+static volatile size_t gIpDataLength = 0;
+
+/** The number of disconnects seen by edmIpConnectionCallback().
+ */
+static volatile int32_t gIpDisconnectCount = 0;
+#endif
+
+#ifdef U_RUNNER_BENCHMARK
+/** The EDM parser used in the EDM parser benchmark.
+ */
+static uShortRangeEdmParser_t gBenchmarkParser;
+
+/** The stream of EDM packets parsed in the EDM parser benchmark.
+ */
+static char gBenchmarkStream[(U_SHORT_RANGE_TEST_BENCHMARK_PAYLOAD_SIZE + 7) *
+                             U_SHORT_RANGE_TEST_BENCHMARK_NUM_PACKETS];
+
+/** The length of the contents of gBenchmarkStream.
+ */
+static size_t gBenchmarkStreamLength = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -85,6 +139,167 @@ static void resetGlobals()
     gHandles.shortRangeHandle = -1;
 }
 
+// Write an EDM packet of the given type into pBuffer, returning
+// the number of bytes written.
+static size_t edmPacketWrite(char *pBuffer, char type,
+                             const char *pPayload, size_t length)
+{
+    size_t x = 0;
+
+    pBuffer[x++] = (char) 0xAA;
+    pBuffer[x++] = (char) (((length + 2) >> 8) & 0x0F);
+    pBuffer[x++] = (char) ((length + 2) & 0xFF);
+    pBuffer[x++] = 0;
+    pBuffer[x++] = type;
+    memcpy(pBuffer + x, pPayload, length);
+    x += length;
+    pBuffer[x++] = (char) 0x55;
+
+    return x;
+}
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+// Read length bytes from UART B into pBuffer, giving up after
+// a second or so, and return the number of bytes read.
+static size_t uartBRead(char *pBuffer, size_t length)
+{
+    size_t received = 0;
+    int32_t x;
+    int64_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((received < length) &&
+           (uPortGetTickTimeMs() - startTimeMs < 1000)) {
+        x = uPortUartRead(gUartBHandle, pBuffer + received, length - received);
+        if (x > 0) {
+            received += x;
+        } else {
+            uPortTaskBlock(10);
+        }
+    }
+
+    return received;
+}
+
+// IP data callback for the edm stream that takes up to
+// gIpDataTakeLimit bytes each time it is called.
+static int32_t edmIpDataCallback(int32_t edmStreamHandle,
+                                 int32_t edmChannel,
+                                 int32_t length, char *pData,
+                                 void *pCallbackParameter)
+{
+    int32_t taken = length;
+
+    (void) edmStreamHandle;
+    (void) edmChannel;
+    (void) pCallbackParameter;
+
+    gIpDataCallbackCount++;
+    if (taken > gIpDataTakeLimit) {
+        taken = gIpDataTakeLimit;
+    }
+    if (taken > (int32_t) (sizeof(gIpData) - gIpDataLength)) {
+        taken = (int32_t) (sizeof(gIpData) - gIpDataLength);
+    }
+    memcpy(gIpData + gIpDataLength, pData, taken);
+    gIpDataLength += taken;
+
+    return taken;
+}
+
+// IP connection callback for the edm stream that, like a Wi-Fi
+// socket being closed, lifts the data take limit and resumes the
+// channel on disconnect, all from the edm event task.
+static void edmIpConnectionCallback(int32_t edmStreamHandle,
+                                    int32_t edmChannel,
+                                    uShortRangeConnectionEventType_t eventType,
+                                    const uShortRangeConnectDataIp_t *pConnectData,
+                                    void *pCallbackParameter)
+{
+    (void) pConnectData;
+    (void) pCallbackParameter;
+
+    if (eventType == U_SHORT_RANGE_EVENT_DISCONNECTED) {
+        gIpDisconnectCount++;
+        gIpDataTakeLimit = sizeof(gIpData);
+        uShortRangeEdmStreamDataResume(edmStreamHandle, edmChannel);
+    }
+}
+#endif
+
+// Feed pBuffer to the parser until it is all consumed or the
+// parser stalls, returning the number of events obtained and
+// storing them in ppEvents (which must be big enough);
+// pConsumed may be NULL.
+static size_t edmParseAll(uShortRangeEdmParser_t *pParser,
+                          const char *pBuffer, size_t length,
+                          uShortRangeEdmEvent_t **ppEvents,
+                          size_t *pConsumed)
+{
+    size_t numEvents = 0;
+    size_t consumed = 0;
+    uShortRangeEdmEvent_t *pEvent;
+
+    while ((consumed < length) && uShortRangeEdmParserReady(pParser)) {
+        consumed += uShortRangeEdmParse(pParser, pBuffer + consumed,
+                                        length - consumed, &pEvent);
+        if (pEvent != NULL) {
+            ppEvents[numEvents] = pEvent;
+            numEvents++;
+        }
+    }
+    if (pConsumed != NULL) {
+        *pConsumed = consumed;
+    }
+
+    return numEvents;
+}
+
+// A malloc() that always fails, to check what the EDM parser does
+// when it can't find room for a large payload.
+static void *mallocFail(size_t size)
+{
+    (void) size;
+    return NULL;
+}
+
+#ifdef U_RUNNER_BENCHMARK
+
+// Set-up for the EDM parser benchmark: create the parser and
+// fill the stream with data packets for channel 1.
+static int32_t benchmarkEdmParserSetUp(void **ppContext)
+{
+    char payload[U_SHORT_RANGE_TEST_BENCHMARK_PAYLOAD_SIZE + 1];
+    int32_t errorCode = uPortInit();
+
+    if (errorCode == 0) {
+        errorCode = uShortRangeEdmParserInit(&gBenchmarkParser, 4,
+                                             sizeof(payload) * 4);
+    }
+    if (errorCode == 0) {
+        payload[0] = 1;
+        for (size_t x = 1; x < sizeof(payload); x++) {
+            payload[x] = (char) x;
+        }
+        gBenchmarkStreamLength = 0;
+        for (size_t x = 0; x < U_SHORT_RANGE_TEST_BENCHMARK_NUM_PACKETS; x++) {
+            gBenchmarkStreamLength += edmPacketWrite(gBenchmarkStream + gBenchmarkStreamLength,
+                                                     0x31, payload, sizeof(payload));
+        }
+        *ppContext = &gBenchmarkParser;
+    }
+
+    return errorCode;
+}
+
+// Tear-down for the EDM parser benchmark.
+static void benchmarkEdmParserTearDown(void *pContext)
+{
+    uShortRangeEdmParserDeinit((uShortRangeEdmParser_t *) pContext);
+    uPortDeinit();
+}
+
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -106,6 +321,123 @@ U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeInitialisation")
     resetGlobals();
 }
 
+/** Test the EDM parser on its own: several events in one buffer,
+ * garbage between packets, an invalid packet, a payload too large
+ * for the slab, stalling when all events are in use and dropping
+ * a packet for which there will never be room.
+ */
+U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeEdmParser")
+{
+    uShortRangeEdmParser_t parser;
+    uShortRangeEdmEvent_t *events[4];
+    char buffer[300];
+    char payload[200];
+    size_t length = 0;
+    size_t consumed;
+    size_t x;
+    int32_t heapUsed;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    heapUsed = uPortGetHeapFree();
+
+    for (x = 0; x < sizeof(payload); x++) {
+        payload[x] = (char) x;
+    }
+
+    U_PORT_TEST_ASSERT(uShortRangeEdmParserInit(&parser, 3, 128) == 0);
+    U_PORT_TEST_ASSERT(uShortRangeEdmParserReady(&parser));
+
+    // An AT response, some rubbish, a data event on channel 2
+    // and a packet of unknown type, all in one go
+    length += edmPacketWrite(buffer + length, 0x45, "\r\nOK\r\n", 6);
+    buffer[length++] = 'x';
+    payload[0] = 2;
+    length += edmPacketWrite(buffer + length, 0x31, payload, 10);
+    length += edmPacketWrite(buffer + length, 0x7F, "??", 2);
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer, length, events, NULL) == 2);
+    U_PORT_TEST_ASSERT(events[0]->type == U_SHORT_RANGE_EDM_EVENT_AT);
+    U_PORT_TEST_ASSERT(events[0]->params.atEvent.length == 6);
+    U_PORT_TEST_ASSERT(memcmp(events[0]->params.atEvent.pData, "\r\nOK\r\n", 6) == 0);
+    U_PORT_TEST_ASSERT(events[1]->type == U_SHORT_RANGE_EDM_EVENT_DATA);
+    U_PORT_TEST_ASSERT(events[1]->params.dataEvent.channel == 2);
+    U_PORT_TEST_ASSERT(events[1]->params.dataEvent.length == 9);
+    U_PORT_TEST_ASSERT(memcmp(events[1]->params.dataEvent.pData, payload + 1, 9) == 0);
+    // Free them out of order
+    uShortRangeEdmParserEventFree(&parser, events[1]);
+    uShortRangeEdmParserEventFree(&parser, events[0]);
+
+    // A payload bigger than the slab, delivered a byte at a time
+    length = edmPacketWrite(buffer, 0x31, payload, sizeof(payload));
+    for (x = 0; x < length - 1; x++) {
+        U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer + x, 1, events, NULL) == 0);
+    }
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer + x, 1, events, NULL) == 1);
+    U_PORT_TEST_ASSERT(events[0]->params.dataEvent.length == sizeof(payload) - 1);
+    U_PORT_TEST_ASSERT(memcmp(events[0]->params.dataEvent.pData, payload + 1,
+                              sizeof(payload) - 1) == 0);
+    uShortRangeEdmParserEventFree(&parser, events[0]);
+
+    // Four AT events: the parser should stall after three and
+    // only resume once the oldest has been freed
+    length = 0;
+    for (x = 0; x < 4; x++) {
+        payload[0] = (char) x;
+        length += edmPacketWrite(buffer + length, 0x41, payload, 20);
+    }
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer, length, events, &consumed) == 3);
+    U_PORT_TEST_ASSERT(consumed < length);
+    U_PORT_TEST_ASSERT(!uShortRangeEdmParserReady(&parser));
+    uShortRangeEdmParserEventFree(&parser, events[1]);
+    U_PORT_TEST_ASSERT(!uShortRangeEdmParserReady(&parser));
+    uShortRangeEdmParserEventFree(&parser, events[0]);
+    U_PORT_TEST_ASSERT(uShortRangeEdmParserReady(&parser));
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer + consumed, length - consumed,
+                                   events, NULL) == 1);
+    U_PORT_TEST_ASSERT(events[0]->params.atEvent.length == 20);
+    U_PORT_TEST_ASSERT(events[0]->params.atEvent.pData[0] == 3);
+    U_PORT_TEST_ASSERT(memcmp(events[0]->params.atEvent.pData + 1, payload + 1, 19) == 0);
+
+    // Deinit with events outstanding should free everything
+    uShortRangeEdmParserDeinit(&parser);
+
+    // A tiny slab and no memory for a payload too large for it:
+    // with no events in use the packet must be skipped rather
+    // than the parser waiting forever for room
+    U_PORT_TEST_ASSERT(uShortRangeEdmParserInit(&parser, 2, 16) == 0);
+    parser.pMalloc = mallocFail;
+    payload[0] = 1;
+    length = edmPacketWrite(buffer, 0x31, payload, 40);
+    length += edmPacketWrite(buffer + length, 0x45, "\r\nOK\r\n", 6);
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer, length, events, &consumed) == 1);
+    U_PORT_TEST_ASSERT(consumed == length);
+    U_PORT_TEST_ASSERT(parser.numDropped == 1);
+    U_PORT_TEST_ASSERT(uShortRangeEdmParserReady(&parser));
+    U_PORT_TEST_ASSERT(events[0]->type == U_SHORT_RANGE_EDM_EVENT_AT);
+    U_PORT_TEST_ASSERT(events[0]->params.atEvent.length == 6);
+    // Now with that event still in use the large packet has to wait,
+    // then be skipped when the event is freed
+    length = edmPacketWrite(buffer, 0x31, payload, 40);
+    length += edmPacketWrite(buffer + length, 0x45, "\r\nOK\r\n", 6);
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer, length, events + 1, &consumed) == 0);
+    U_PORT_TEST_ASSERT(!uShortRangeEdmParserReady(&parser));
+    uShortRangeEdmParserEventFree(&parser, events[0]);
+    U_PORT_TEST_ASSERT(uShortRangeEdmParserReady(&parser));
+    U_PORT_TEST_ASSERT(edmParseAll(&parser, buffer + consumed, length - consumed,
+                                   events, NULL) == 1);
+    U_PORT_TEST_ASSERT(parser.numDropped == 2);
+    U_PORT_TEST_ASSERT(events[0]->type == U_SHORT_RANGE_EDM_EVENT_AT);
+    U_PORT_TEST_ASSERT(memcmp(events[0]->params.atEvent.pData, "\r\nOK\r\n", 6) == 0);
+    uShortRangeEdmParserDeinit(&parser);
+
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_SHORT_RANGE_TEST: we have leaked %d byte(s).\n", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+
+    uPortDeinit();
+}
+
 #if (U_CFG_TEST_UART_A >= 0)
 /** Add a ShortRange instance and remove it again using an uart stream.
  * Note: no short range operations are actually carried out and
@@ -237,6 +569,235 @@ U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeAddEdm")
 }
 #endif
 
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Check what an edm stream puts on the wire, with the second UART
+ * playing the part of the module: an AT command must go out as a
+ * single EDM AT request and data written to a Bluetooth channel
+ * must be split into EDM data packets of the frame size of the
+ * connection.  No short range module is required, only two UARTs
+ * cross-wired.
+ */
+U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeEdmStreamWrite")
+{
+    size_t frameSize = 100;
+    char buffer[100 + 1];
+    char data[450];
+    char payload[11];
+    size_t length;
+    size_t x;
+    size_t y;
+
+    uPortDeinit();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    gHandles.uartHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                        U_CFG_TEST_BAUD_RATE,
+                                        NULL,
+                                        U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                                        U_CFG_TEST_PIN_UART_A_TXD,
+                                        U_CFG_TEST_PIN_UART_A_RXD,
+                                        U_CFG_TEST_PIN_UART_A_CTS,
+                                        U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gHandles.uartHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamInit() == 0);
+    gHandles.edmStreamHandle = uShortRangeEdmStreamOpen(gHandles.uartHandle);
+    U_PORT_TEST_ASSERT(gHandles.edmStreamHandle >= 0);
+    gHandles.atClientHandle = uAtClientAdd(gHandles.edmStreamHandle, U_AT_CLIENT_STREAM_TYPE_EDM,
+                                           NULL, U_SHORT_RANGE_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(gHandles.atClientHandle != NULL);
+    uShortRangeEdmStreamSetAtHandle(gHandles.edmStreamHandle, gHandles.atClientHandle);
+
+    uPortLog("U_SHORT_RANGE_TEST: sending an AT command...\n");
+    uAtClientLock(gHandles.atClientHandle);
+    uAtClientCommandStart(gHandles.atClientHandle, "AT+UMLA=");
+    uAtClientWriteInt(gHandles.atClientHandle, 1);
+    uAtClientCommandStop(gHandles.atClientHandle);
+    uAtClientUnlock(gHandles.atClientHandle);
+    // Head, "AT+UMLA=1\r" and tail
+    length = uartBRead(buffer, 5 + 10 + 1);
+    U_PORT_TEST_ASSERT(length == 5 + 10 + 1);
+    U_PORT_TEST_ASSERT(buffer[0] == (char) 0xAA);
+    U_PORT_TEST_ASSERT(buffer[1] == 0);
+    U_PORT_TEST_ASSERT(buffer[2] == 10 + 2);
+    U_PORT_TEST_ASSERT(buffer[3] == 0);
+    U_PORT_TEST_ASSERT(buffer[4] == 0x44);
+    U_PORT_TEST_ASSERT(memcmp(buffer + 5, "AT+UMLA=1\r", 10) == 0);
+    U_PORT_TEST_ASSERT(buffer[15] == (char) 0x55);
+
+    uPortLog("U_SHORT_RANGE_TEST: connecting a Bluetooth channel...\n");
+    // Channel 3, Bluetooth, SPS, address, frame size
+    memset(payload, 0, sizeof(payload));
+    payload[0] = 3;
+    payload[1] = 0x01;
+    payload[2] = 14;
+    payload[9] = (char) (frameSize >> 8);
+    payload[10] = (char) frameSize;
+    length = edmPacketWrite(buffer, 0x11, payload, sizeof(payload));
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    uPortTaskBlock(500);
+
+    uPortLog("U_SHORT_RANGE_TEST: writing %d byte(s) of data...\n", sizeof(data));
+    for (x = 0; x < sizeof(data); x++) {
+        data[x] = (char) x;
+    }
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamWrite(gHandles.edmStreamHandle, 3,
+                                                 data, sizeof(data), 1000) == sizeof(data));
+    for (x = 0; x < sizeof(data); x += y) {
+        y = sizeof(data) - x;
+        if (y > frameSize) {
+            y = frameSize;
+        }
+        length = uartBRead(buffer, 6);
+        U_PORT_TEST_ASSERT(length == 6);
+        U_PORT_TEST_ASSERT(buffer[0] == (char) 0xAA);
+        U_PORT_TEST_ASSERT(((((size_t) (uint8_t) buffer[1]) << 8) + (uint8_t) buffer[2]) == y + 3);
+        U_PORT_TEST_ASSERT(buffer[4] == 0x36);
+        U_PORT_TEST_ASSERT(buffer[5] == 3);
+        length = uartBRead(buffer, y + 1);
+        U_PORT_TEST_ASSERT(length == y + 1);
+        U_PORT_TEST_ASSERT(memcmp(buffer, data + x, y) == 0);
+        U_PORT_TEST_ASSERT(buffer[y] == (char) 0x55);
+    }
+    U_PORT_TEST_ASSERT(uPortUartGetReceiveSize(gUartBHandle) == 0);
+
+    uShortRangeEdmStreamClose(gHandles.edmStreamHandle);
+    uShortRangeEdmStreamDeinit();
+    uAtClientRemove(gHandles.atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gHandles.uartHandle);
+    gHandles.uartHandle = -1;
+
+    uPortDeinit();
+    resetGlobals();
+}
+
+/** Check that data which a data event callback doesn't take is
+ * held by the edm stream, pausing the channel, and is offered
+ * again, in order, when the channel is resumed.  No short range
+ * module is required, only two UARTs cross-wired.
+ */
+U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeEdmStreamDataResume")
+{
+    char buffer[32];
+    char payload[15];
+    size_t length;
+
+    uPortDeinit();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    gHandles.uartHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                        U_CFG_TEST_BAUD_RATE,
+                                        NULL,
+                                        U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                                        U_CFG_TEST_PIN_UART_A_TXD,
+                                        U_CFG_TEST_PIN_UART_A_RXD,
+                                        U_CFG_TEST_PIN_UART_A_CTS,
+                                        U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gHandles.uartHandle >= 0);
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_CFG_TEST_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamInit() == 0);
+    gHandles.edmStreamHandle = uShortRangeEdmStreamOpen(gHandles.uartHandle);
+    U_PORT_TEST_ASSERT(gHandles.edmStreamHandle >= 0);
+    gIpDataTakeLimit = 4;
+    gIpDataCallbackCount = 0;
+    gIpDataLength = 0;
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamDataEventCallbackSet(gHandles.edmStreamHandle,
+                                                                U_SHORT_RANGE_CONNECTION_TYPE_IP,
+                                                                edmIpDataCallback,
+                                                                NULL) == 0);
+
+    uPortLog("U_SHORT_RANGE_TEST: connecting an IP channel...\n");
+    // Channel 5, IPv4, TCP, remote address/port, local address/port
+    memset(payload, 0, sizeof(payload));
+    payload[0] = 5;
+    payload[1] = 0x02;
+    payload[2] = 0x00;
+    length = edmPacketWrite(buffer, 0x11, payload, sizeof(payload));
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    uPortTaskBlock(500);
+
+    uPortLog("U_SHORT_RANGE_TEST: sending two data packets, taking only"
+             " %d byte(s)...\n", gIpDataTakeLimit);
+    length = edmPacketWrite(buffer, 0x31, "\x05" "0123456789", 11);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    length = edmPacketWrite(buffer, 0x31, "\x05" "abcdef", 7);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    uPortTaskBlock(500);
+    // The channel is now paused: the rest of the first packet and
+    // all of the second must have been held back
+    U_PORT_TEST_ASSERT(gIpDataCallbackCount == 1);
+    U_PORT_TEST_ASSERT(gIpDataLength == 4);
+    U_PORT_TEST_ASSERT(memcmp(gIpData, "0123", 4) == 0);
+
+    uPortLog("U_SHORT_RANGE_TEST: resuming the channel...\n");
+    gIpDataTakeLimit = sizeof(gIpData);
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamDataResume(gHandles.edmStreamHandle, 5) == 0);
+    uPortTaskBlock(500);
+    U_PORT_TEST_ASSERT(gIpDataCallbackCount == 3);
+    U_PORT_TEST_ASSERT(gIpDataLength == 16);
+    U_PORT_TEST_ASSERT(memcmp(gIpData, "0123456789abcdef", 16) == 0);
+
+    uPortLog("U_SHORT_RANGE_TEST: pausing the channel again and resuming"
+             " it from the edm event task on disconnect...\n");
+    gIpDataTakeLimit = 0;
+    gIpDisconnectCount = 0;
+    U_PORT_TEST_ASSERT(uShortRangeEdmStreamIpEventCallbackSet(gHandles.edmStreamHandle,
+                                                              edmIpConnectionCallback,
+                                                              NULL) == 0);
+    length = edmPacketWrite(buffer, 0x31, "\x05" "ghij", 5);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    length = edmPacketWrite(buffer, 0x21, "\x05", 1);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    uPortTaskBlock(500);
+    U_PORT_TEST_ASSERT(gIpDisconnectCount == 1);
+    U_PORT_TEST_ASSERT(gIpDataLength == 20);
+    U_PORT_TEST_ASSERT(memcmp(gIpData, "0123456789abcdefghij", 20) == 0);
+    // The edm stream must still be working
+    length = edmPacketWrite(buffer, 0x11, payload, sizeof(payload));
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    length = edmPacketWrite(buffer, 0x31, "\x05" "kl", 3);
+    U_PORT_TEST_ASSERT(uPortUartWrite(gUartBHandle, buffer, length) == (int32_t) length);
+    uPortTaskBlock(500);
+    U_PORT_TEST_ASSERT(gIpDataLength == 22);
+    U_PORT_TEST_ASSERT(memcmp(gIpData + 20, "kl", 2) == 0);
+
+    uShortRangeEdmStreamIpEventCallbackRemove(gHandles.edmStreamHandle);
+    uShortRangeEdmStreamDataEventCallbackRemove(gHandles.edmStreamHandle,
+                                                U_SHORT_RANGE_CONNECTION_TYPE_IP);
+    uShortRangeEdmStreamClose(gHandles.edmStreamHandle);
+    uShortRangeEdmStreamDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gHandles.uartHandle);
+    gHandles.uartHandle = -1;
+
+    uPortDeinit();
+    resetGlobals();
+}
+#endif
+
 #ifdef U_CFG_TEST_SHORT_RANGE_MODULE_TYPE
 
 /** Short range edm stream add and sent attention command.
@@ -326,7 +887,48 @@ U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeRecover")
  */
 U_PORT_TEST_FUNCTION("[shortRange]", "shortRangeCleanUp")
 {
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+    if (gUartBHandle >= 0) {
+        uPortUartClose(gUartBHandle);
+        gUartBHandle = -1;
+    }
+#endif
     uShortRangeTestPrivateCleanup(&gHandles);
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BENCHMARKS
+ * -------------------------------------------------------------- */
+
+#ifdef U_RUNNER_BENCHMARK
+
+/** Time the EDM parser on a stream of data packets, each event
+ * being freed as soon as it is obtained, as the EDM stream does.
+ */
+U_RUNNER_BENCHMARK("[shortRange]", "shortRangeBenchmarkEdmParser", 50,
+                   benchmarkEdmParserSetUp, benchmarkEdmParserTearDown)
+{
+    uShortRangeEdmParser_t *pParser = (uShortRangeEdmParser_t *) pContext;
+    uShortRangeEdmEvent_t *pEvent;
+    size_t consumed = 0;
+    size_t count = 0;
+
+    while ((consumed < gBenchmarkStreamLength) && uShortRangeEdmParserReady(pParser)) {
+        consumed += uShortRangeEdmParse(pParser, gBenchmarkStream + consumed,
+                                        gBenchmarkStreamLength - consumed, &pEvent);
+        if (pEvent != NULL) {
+            if ((pEvent->type == U_SHORT_RANGE_EDM_EVENT_DATA) &&
+                (pEvent->params.dataEvent.length == U_SHORT_RANGE_TEST_BENCHMARK_PAYLOAD_SIZE)) {
+                count++;
+            }
+            uShortRangeEdmParserEventFree(pParser, pEvent);
+        }
+    }
+
+    return (count == U_SHORT_RANGE_TEST_BENCHMARK_NUM_PACKETS) ?
+           (int32_t) gBenchmarkStreamLength : (int32_t) U_ERROR_COMMON_UNKNOWN;
+}
+
+#endif
+
 // End of file
@@ -48,13 +48,13 @@ extern "C" {
 #endif
 
 #ifndef U_SOCK_RECEIVE_POLL_INTERVAL_MS
-/** The interval at which this layer hits the underlying
- * network layer with a request for incoming data while
- * waiting for the uSockReceiveFrom() or uSockRead().
- * This also represents the minimum time these calls will
- * take in the non-blocking case.
+/** A blocking uSockReceiveFrom()/uSockRead(), uSockSelect()
+ * or uSockPoll() waits to be woken by the underlying network
+ * layer when data arrives or a socket is closed; this is the
+ * interval at which it will check again anyway, in case such
+ * a notification was not forthcoming.
  */
-# define U_SOCK_RECEIVE_POLL_INTERVAL_MS 100
+# define U_SOCK_RECEIVE_POLL_INTERVAL_MS 1000
 #endif
 
 #ifndef U_SOCK_CLOSE_TIMEOUT_SECONDS
@@ -235,6 +235,30 @@ extern "C" {
  */
 #define U_SOCK_OPT_TCP_KEEPCNT  0x0005
 
+/** TCP socket option, u-blox specific, cellular only: an int32_t,
+ * non-zero to put a connected socket into direct link mode, where
+ * the UART to the module carries only the data of that socket and
+ * uSockWrite()/uSockRead() run at close to the UART line rate,
+ * zero to return to normal; while a socket is in direct link mode
+ * nothing else may be done with the module.  See
+ * uCellSockDirectLinkStart() in u_cell_sock.h for the details.
+ */
+#define U_SOCK_OPT_TCP_DIRECT_LINK 0x7001
+
+/** TCP socket option, u-blox specific, cellular only: an int32_t,
+ * the time in milliseconds after which data written in direct link
+ * mode is sent if no more arrives, zero for no timer trigger; must
+ * be set before U_SOCK_OPT_TCP_DIRECT_LINK.  Cannot be read.
+ */
+#define U_SOCK_OPT_TCP_DIRECT_LINK_TIMER 0x7002
+
+/** TCP socket option, u-blox specific, cellular only: an int32_t,
+ * the amount of data written in direct link mode at which it is
+ * sent, zero for no data length trigger; must be set before
+ * U_SOCK_OPT_TCP_DIRECT_LINK.  Cannot be read.
+ */
+#define U_SOCK_OPT_TCP_DIRECT_LINK_LENGTH 0x7003
+
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS: MISC
  * -------------------------------------------------------------- */
@@ -276,10 +300,29 @@ extern "C" {
 
 /** Determine if the bit corresponding to a given file descriptor is set.
  */
-#define U_SOCK_FD_ISSET(d, pSet) if (((d) >= 0) &&                           \
-                                     ((d) < U_SOCK_DESCRIPTOR_SET_SIZE)) {   \
-                                     (*(pSet))[(d) / 8] & (1 << ((d) & 7));  \
-                                 }
+#define U_SOCK_FD_ISSET(d, pSet) (((d) >= 0) &&                            \
+                                  ((d) < U_SOCK_DESCRIPTOR_SET_SIZE) &&     \
+                                  (((*(pSet))[(d) / 8] & (1 << ((d) & 7))) != 0))
+
+/** Flag for uSockPollDescriptor_t: there is data to read.
+ */
+#define U_SOCK_POLL_IN  0x01
+
+/** Flag for uSockPollDescriptor_t: the socket may be written to.
+ */
+#define U_SOCK_POLL_OUT 0x02
+
+/** Flag for uSockPollDescriptor_t: the socket has been shut down
+ * for reading, is closing or is closed; always reported in revents,
+ * need not be requested in events.
+ */
+#define U_SOCK_POLL_ERR 0x04
+
+/** Flag for uSockPollDescriptor_t: the descriptor is not that of
+ * an open socket; always reported in revents, need not be requested
+ * in events.
+ */
+#define U_SOCK_POLL_NVAL 0x08
 
 /* ----------------------------------------------------------------
  * TYPES
@@ -293,6 +336,17 @@ typedef int32_t uSockDescriptor_t;
  */
 typedef uint8_t uSockDescriptorSet_t[(U_SOCK_DESCRIPTOR_SET_SIZE + 7) / 8];
 
+/** An entry in the array passed to uSockPoll().
+ */
+typedef struct {
+    uSockDescriptor_t descriptor; /**< the socket to poll; entries
+                                       with a negative descriptor
+                                       are ignored. */
+    uint8_t events;  /**< the U_SOCK_POLL_xxx flags of interest. */
+    uint8_t revents; /**< filled in by uSockPoll() with the
+                          U_SOCK_POLL_xxx flags that are set. */
+} uSockPollDescriptor_t;
+
 /** Supported socket types: the numbers match those of LWIP.
  */
 typedef enum {
@@ -670,6 +724,12 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
                     uSockAddress_t *pRemoteAddress);
 
 /** Select: wait for one of a set of sockets to become unblocked.
+ * This does not poll the module: it is woken by the underlying
+ * network layer when data arrives or a socket is closed.  A socket
+ * is unblocked for reading if there is data to read or it has been
+ * shut down for reading or closed, for writing if it is connected
+ * (or, for UDP, not shut down for writing) and has an exceptional
+ * condition if it has been shut down for reading or closed.
  *
  * @param maxDescriptor         the highest numbered descriptor in the
  *                              sets that follow to select on + 1.
@@ -682,12 +742,15 @@ int32_t uSockAccept(uSockDescriptor_t descriptor,
  * @param pExceptDescriptorSet  the set of descriptors to check for
  *                              exceptional conditions. May be NULL.
  * @param timeMs                the timeout for the select operation
- *                              in milliseconds.
- * @return                      a positive value if an unblock
- *                              occurred, zero on timeout, negative
- *                              on any other error.  Use
- *                              U_SOCK_FD_ISSET() to determine
- *                              which descriptor(s) were unblocked.
+ *                              in milliseconds; use a negative value
+ *                              to wait indefinitely.
+ * @return                      the number of unblocked descriptors,
+ *                              zero on timeout, negative on any other
+ *                              error (e.g. a descriptor in one of the
+ *                              sets is not that of an open socket).
+ *                              On return the sets contain only the
+ *                              descriptors that were unblocked: use
+ *                              U_SOCK_FD_ISSET() to find them.
  */
 int32_t uSockSelect(int32_t maxDescriptor,
                     uSockDescriptorSet_t *pReadDescriptorSet,
@@ -695,6 +758,25 @@ int32_t uSockSelect(int32_t maxDescriptor,
                     uSockDescriptorSet_t *pExceptDescriptorSet,
                     int32_t timeMs);
 
+/** Poll: like uSockSelect() but taking an array of descriptors,
+ * each with the U_SOCK_POLL_xxx flags of interest, so that the
+ * caller need not scan a set to find the sockets that are ready.
+ *
+ * @param pPollDescriptors    an array of poll descriptors; the
+ *                            revents field of each entry will be
+ *                            populated on return.
+ * @param numPollDescriptors  the number of entries in the array
+ *                            pointed to by pPollDescriptors.
+ * @param timeMs              the timeout in milliseconds; use a
+ *                            negative value to wait indefinitely.
+ * @return                    the number of entries with a non-zero
+ *                            revents field, zero on timeout,
+ *                            negative on any other error.
+ */
+int32_t uSockPoll(uSockPollDescriptor_t *pPollDescriptors,
+                  size_t numPollDescriptors,
+                  int32_t timeMs);
+
 
 /** Get the number of bytes sent by the socket
  * @param descriptor    the descriptor of the socket to get the sent bytes
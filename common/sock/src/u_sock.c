@@ -264,7 +264,21 @@
  * When new data is received pCallback should be called
  * with the first parameter being networkHandle and the
  * second parameter sockHandle.  pCallback will be
- * set to NULL to remove an existing callback.
+ * set to NULL to remove an existing callback.  This
+ * layer always registers a callback of its own, which it
+ * uses to wake any blocking receive, uSockSelect() or
+ * uSockPoll() waiting on the socket.
+ *
+ * Get the number of bytes waiting to be read (recommended):
+ *
+ * int32_t uXxxSockGetBytesPending(int32_t networkHandle,
+ *                                 int32_t sockHandle);
+ *
+ * Returns the number of bytes that could be read from the
+ * socket right now or negative errno in the usual way.  This
+ * should be cheap (i.e. involve no traffic with the module) as
+ * it is called by uSockSelect() and uSockPoll() each time they
+ * are woken; any non-zero value will do for UDP.
  *
  * Register a callback on a socket being closed, either
  * locally or by the remote host (optional):
@@ -355,11 +369,13 @@
 # define U_SOCK_NUM_STATIC_SOCKETS     7
 #endif
 
-/** Increment a socket descriptor.
+/** Increment a socket descriptor, wrapping so that all
+ * descriptors fit in a uSockDescriptorSet_t.
  */
-#define U_SOCK_INC_DESCRIPTOR(d)  (d)++;         \
-                                  if ((d) < 0) { \
-                                      d = 0;     \
+#define U_SOCK_INC_DESCRIPTOR(d)  (d)++;                                      \
+                                  if (((d) < 0) ||                            \
+                                      ((d) >= U_SOCK_DESCRIPTOR_SET_SIZE)) {  \
+                                      d = 0;                                  \
                                   }
 
 /* ----------------------------------------------------------------
@@ -415,6 +431,15 @@ typedef struct uSockContainer_t {
     bool isStatic; // At end to optimise structure packing
 } uSockContainer_t;
 
+/** Something waiting for a socket to become readable or
+ * closed: placed on the stack of the waiting task and
+ * linked into the list while it waits.
+ */
+typedef struct uSockWaiter_t {
+    uPortSemaphoreHandle_t semaphore; /**< given on any socket event. */
+    struct uSockWaiter_t *pNext;
+} uSockWaiter_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -435,6 +460,10 @@ static uPortMutexHandle_t gMutexCallbacks = NULL;
  */
 static uSockContainer_t *gpContainerListHead = NULL;
 
+/** Root of the list of waiters, protected by gMutexCallbacks.
+ */
+static uSockWaiter_t *gpWaiterListHead = NULL;
+
 /** The next descriptor to use.
  */
 static uSockDescriptor_t gNextDescriptor = 0;
@@ -481,6 +510,7 @@ static int32_t init()
                     *ppContainer = &gStaticContainers[x];
                     (*ppContainer)->isStatic = true;
                     (*ppContainer)->socket.state = U_SOCK_STATE_CLOSED;
+                    (*ppContainer)->socket.sockHandle = -1;
                     (*ppContainer)->pNext = NULL;
                     if (ppPreviousNext != NULL) {
                         *ppPreviousNext = *ppContainer;
@@ -641,11 +671,15 @@ static bool containerFree(uSockDescriptor_t descriptor)
 {
     uSockContainer_t **ppContainer = NULL;
     uSockContainer_t **ppContainerThis = &gpContainerListHead;
+    uSockContainer_t *pTmp;
     bool success = false;
 
+    // Descriptors are re-used so there may be a closed
+    // container with the same descriptor, hence skip those
     while ((*ppContainerThis != NULL) &&
            (ppContainer == NULL)) {
-        if ((*ppContainerThis)->descriptor == descriptor) {
+        if (((*ppContainerThis)->descriptor == descriptor) &&
+            ((*ppContainerThis)->socket.state != U_SOCK_STATE_CLOSED)) {
             ppContainer = ppContainerThis;
         } else {
             ppContainerThis = &((*ppContainerThis)->pNext);
@@ -655,20 +689,20 @@ static bool containerFree(uSockDescriptor_t descriptor)
     if ((ppContainer != NULL) && (*ppContainer != NULL)) {
         if (!(*ppContainer)->isStatic) {
             // If we found it, and it wasn't static, free it
-            // If there is a previous container, move its pNext
-            if ((*ppContainer)->pPrevious != NULL) {
-                (*ppContainer)->pPrevious->pNext = (*ppContainer)->pNext;
-            }
+            pTmp = *ppContainer;
             // If there is a next container, move its pPrevious
-            if ((*ppContainer)->pNext != NULL) {
-                (*ppContainer)->pNext->pPrevious = (*ppContainer)->pPrevious;
+            if (pTmp->pNext != NULL) {
+                pTmp->pNext->pPrevious = pTmp->pPrevious;
             }
-
-            // Free the memory and NULL the pointer
-            free(*ppContainer);
-            *ppContainer = NULL;
+            // Point whatever pointed to this container
+            // (the previous pNext or the list head) at the next
+            *ppContainer = pTmp->pNext;
+            // Free the memory
+            free(pTmp);
         } else {
-            // Nothing to do for a static container,
+            // Nothing to free for a static container,
+            // just mark it as re-usable
+            (*ppContainer)->socket.state = U_SOCK_STATE_CLOSED;
         }
 
         success = true;
@@ -677,6 +711,66 @@ static bool containerFree(uSockDescriptor_t descriptor)
     return success;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: WAITERS
+ * -------------------------------------------------------------- */
+
+// Add a waiter to the list, creating its semaphore.
+static int32_t waiterAdd(uSockWaiter_t *pWaiter)
+{
+    int32_t errorCode;
+
+    errorCode = uPortSemaphoreCreate(&(pWaiter->semaphore), 0, 1);
+    if (errorCode == 0) {
+        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+        pWaiter->pNext = gpWaiterListHead;
+        gpWaiterListHead = pWaiter;
+        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+    }
+
+    return errorCode;
+}
+
+// Remove a waiter from the list and delete its semaphore.
+static void waiterRemove(uSockWaiter_t *pWaiter)
+{
+    uSockWaiter_t **ppWaiter = &gpWaiterListHead;
+
+    U_PORT_MUTEX_LOCK(gMutexCallbacks);
+    while ((*ppWaiter != NULL) && (*ppWaiter != pWaiter)) {
+        ppWaiter = &((*ppWaiter)->pNext);
+    }
+    if (*ppWaiter != NULL) {
+        *ppWaiter = pWaiter->pNext;
+    }
+    U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+
+    uPortSemaphoreDelete(pWaiter->semaphore);
+    pWaiter->semaphore = NULL;
+}
+
+// Wake all waiters: they each re-check the sockets
+// they are interested in.
+// This does NOT lock gMutexCallbacks, you need to do that.
+static void waitersNotify()
+{
+    for (uSockWaiter_t *pWaiter = gpWaiterListHead; pWaiter != NULL;
+         pWaiter = pWaiter->pNext) {
+        uPortSemaphoreGive(pWaiter->semaphore);
+    }
+}
+
+// Wait for waitersNotify() or for timeMs to pass, whichever
+// is the sooner, limited to U_SOCK_RECEIVE_POLL_INTERVAL_MS
+// in case a notification is missed.
+static void waiterWait(const uSockWaiter_t *pWaiter, int64_t timeMs)
+{
+    if ((timeMs < 0) || (timeMs > U_SOCK_RECEIVE_POLL_INTERVAL_MS)) {
+        timeMs = U_SOCK_RECEIVE_POLL_INTERVAL_MS;
+    }
+    uPortSemaphoreTryTake(pWaiter->semaphore, (int32_t) timeMs);
+}
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS: CALLBACKS
  * -------------------------------------------------------------- */
@@ -706,6 +800,7 @@ static void closedCallback(int32_t networkHandle,
         // context
         uSecurityTlsRemove(pContainer->socket.pSecurityContext);
         pContainer->socket.pSecurityContext = NULL;
+        waitersNotify();
         U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
     }
 }
@@ -727,6 +822,7 @@ static void dataCallback(int32_t networkHandle,
         if (pContainer->socket.pDataCallback != NULL) {
             pContainer->socket.pDataCallback(pContainer->socket.pDataCallbackParameter);
         }
+        waitersNotify();
         U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
     }
 }
@@ -1061,6 +1157,8 @@ static int32_t receive(const uSockContainer_t *pContainer,
     int32_t sockHandle = pContainer->socket.sockHandle;
     int32_t negErrnoOrSize = -U_SOCK_ENOSYS;
     int64_t startTimeMs = uPortGetTickTimeMs();
+    uSockWaiter_t waiter = {0};
+    bool waiting = false;
 
     // Run around the loop until a packet of data turns up
     // or we time out or just once if we're non-blocking.
@@ -1094,18 +1192,168 @@ static int32_t receive(const uSockContainer_t *pContainer,
                                                dataSizeBytes);
             }
         }
-        if (negErrnoOrSize < 0) {
-            // Yield for the poll interval
-            uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS);
+        if ((negErrnoOrSize < 0) && (pContainer->socket.blocking)) {
+            if (waiting) {
+                // Wait to be told that something has happened
+                waiterWait(&waiter, startTimeMs +
+                           pContainer->socket.receiveTimeoutMs -
+                           uPortGetTickTimeMs());
+            } else {
+                // First time: start listening for data
+                // callbacks and then go straight around
+                // again in case data arrived in between
+                waiting = (waiterAdd(&waiter) == 0);
+                if (!waiting) {
+                    uPortTaskBlock(U_SOCK_RECEIVE_POLL_INTERVAL_MS);
+                }
+            }
         }
     } while ((negErrnoOrSize < 0) &&
              (pContainer->socket.blocking) &&
              (uPortGetTickTimeMs() < startTimeMs +
               pContainer->socket.receiveTimeoutMs));
 
+    if (waiting) {
+        waiterRemove(&waiter);
+    }
+
     return negErrnoOrSize;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SELECT/POLL
+ * -------------------------------------------------------------- */
+
+// Find the socket container for the given descriptor for the
+// purposes of polling: as pContainerFindByDescriptor() but,
+// if there is no open socket with that descriptor, will find
+// a closed one, so that a socket closed under the feet of
+// a waiter is reported as closed rather than as invalid.
+// This does NOT lock the mutex, you need to do that.
+static uSockContainer_t *pContainerFindForPoll(uSockDescriptor_t descriptor)
+{
+    uSockContainer_t *pContainer = pContainerFindByDescriptor(descriptor);
+    uSockContainer_t *pContainerThis = gpContainerListHead;
+
+    while ((pContainerThis != NULL) &&
+           (pContainer == NULL)) {
+        if ((pContainerThis->descriptor == descriptor) &&
+            (pContainerThis->socket.sockHandle >= 0)) {
+            pContainer = pContainerThis;
+        }
+        pContainerThis = pContainerThis->pNext;
+    }
+
+    return pContainer;
+}
+
+// Work out the U_SOCK_POLL_xxx flags for a socket without
+// any traffic to the module.
+// This does NOT lock the mutex, you need to do that.
+static uint8_t pollSocket(const uSockContainer_t *pContainer,
+                          uint8_t events)
+{
+    uint8_t revents = 0;
+    int32_t networkHandle = pContainer->socket.networkHandle;
+    int32_t sockHandle = pContainer->socket.sockHandle;
+    uSockState_t state = pContainer->socket.state;
+    int32_t negErrnoOrSize = -U_SOCK_ENOSYS;
+
+    switch (state) {
+        case U_SOCK_STATE_SHUTDOWN_FOR_READ:
+        case U_SOCK_STATE_SHUTDOWN_FOR_READ_WRITE:
+        case U_SOCK_STATE_CLOSING:
+        case U_SOCK_STATE_CLOSED:
+            revents |= U_SOCK_POLL_ERR;
+            break;
+        default:
+            if ((events & U_SOCK_POLL_IN) != 0) {
+                if (U_NETWORK_HANDLE_IS_CELL(networkHandle)) {
+                    negErrnoOrSize = uCellSockGetBytesPending(networkHandle,
+                                                              sockHandle);
+                } else if (U_NETWORK_HANDLE_IS_WIFI(networkHandle)) {
+                    negErrnoOrSize = uWifiSockGetBytesPending(networkHandle,
+                                                              sockHandle);
+                }
+                if (negErrnoOrSize > 0) {
+                    revents |= U_SOCK_POLL_IN;
+                } else if (negErrnoOrSize < 0) {
+                    revents |= U_SOCK_POLL_ERR;
+                }
+            }
+            break;
+    }
+
+    if ((events & U_SOCK_POLL_OUT) != 0) {
+        if (((state == U_SOCK_STATE_CONNECTED) ||
+             (state == U_SOCK_STATE_SHUTDOWN_FOR_READ)) ||
+            ((pContainer->socket.protocol == U_SOCK_PROTOCOL_UDP) &&
+             (state == U_SOCK_STATE_CREATED))) {
+            revents |= U_SOCK_POLL_OUT;
+        }
+    }
+
+    return revents;
+}
+
+// Check and, if nothing is ready, wait on an array of poll
+// descriptors; the guts of uSockPoll() and uSockSelect().
+// Returns the number of entries with non-zero revents,
+// which may be zero on timeout, or negated errno.
+static int32_t pollWait(uSockPollDescriptor_t *pPollDescriptors,
+                        size_t numPollDescriptors, int32_t timeMs)
+{
+    int32_t negErrnoOrNumReady;
+    int64_t startTimeMs = uPortGetTickTimeMs();
+    uSockWaiter_t waiter = {0};
+    bool done = false;
+    uSockPollDescriptor_t *pPollDescriptor;
+    const uSockContainer_t *pContainer;
+
+    negErrnoOrNumReady = -U_SOCK_ENOMEM;
+    // Get on the waiter list before checking anything
+    // so that no event can be missed
+    if (waiterAdd(&waiter) == 0) {
+        while (!done) {
+            negErrnoOrNumReady = 0;
+
+            U_PORT_MUTEX_LOCK(gMutexContainer);
+
+            for (size_t x = 0; x < numPollDescriptors; x++) {
+                pPollDescriptor = pPollDescriptors + x;
+                pPollDescriptor->revents = 0;
+                if (pPollDescriptor->descriptor >= 0) {
+                    pContainer = pContainerFindForPoll(pPollDescriptor->descriptor);
+                    if (pContainer != NULL) {
+                        pPollDescriptor->revents = pollSocket(pContainer,
+                                                              pPollDescriptor->events);
+                    } else {
+                        pPollDescriptor->revents = U_SOCK_POLL_NVAL;
+                    }
+                    if (pPollDescriptor->revents != 0) {
+                        negErrnoOrNumReady++;
+                    }
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(gMutexContainer);
+
+            if ((negErrnoOrNumReady == 0) &&
+                ((timeMs < 0) ||
+                 (uPortGetTickTimeMs() < startTimeMs + timeMs))) {
+                waiterWait(&waiter, (timeMs < 0) ? -1 :
+                           startTimeMs + timeMs - uPortGetTickTimeMs());
+            } else {
+                done = true;
+            }
+        }
+
+        waiterRemove(&waiter);
+    }
+
+    return negErrnoOrNumReady;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: CREATE/OPEN/CLOSE/CLEAN-UP
  * -------------------------------------------------------------- */
@@ -1191,10 +1439,20 @@ int32_t uSockCreate(int32_t networkHandle, uSockType_t type,
                         // we can do it at the same time
                         uCellSockBlockingSet(networkHandle,
                                              sockHandle, false);
+                        // Always have data callbacks, so that we
+                        // can wake anyone waiting on the socket
+                        uCellSockRegisterCallbackData(networkHandle,
+                                                      sockHandle,
+                                                      dataCallback);
                     } else if (U_NETWORK_HANDLE_IS_WIFI(networkHandle)) {
                         sockHandle = uWifiSockCreate(networkHandle,
                                                      type, protocol);
                         // TODO: Set blocking stuff
+                        if (sockHandle >= 0) {
+                            uWifiSockRegisterCallbackData(networkHandle,
+                                                          sockHandle,
+                                                          dataCallback);
+                        }
                     }
 
                     if (sockHandle >= 0) {
@@ -1392,6 +1650,9 @@ int32_t uSockClose(uSockDescriptor_t descriptor)
                         // Just set the state and the callback
                         // will sort actual closing out later
                         pContainer->socket.state = finalState;
+                        U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                        waitersNotify();
+                        U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
                     }
                 }
             } else {
@@ -1461,6 +1722,8 @@ void uSockCleanUp()
                     // Remember the network handle
                     networkHandle = pContainer->socket.networkHandle;
                     pContainer->socket.state = U_SOCK_STATE_CLOSED;
+                    // No longer of interest to uSockSelect()/uSockPoll()
+                    pContainer->socket.sockHandle = -1;
                     // Move on
                     pContainer = pContainer->pNext;
                 }
@@ -2283,6 +2546,12 @@ int32_t uSockShutdown(uSockDescriptor_t descriptor,
                 default:
                     break;
             }
+            if (errnoLocal == U_SOCK_ENONE) {
+                // Let anyone in uSockSelect()/uSockPoll() know
+                U_PORT_MUTEX_LOCK(gMutexCallbacks);
+                waitersNotify();
+                U_PORT_MUTEX_UNLOCK(gMutexCallbacks);
+            }
         }
 
         U_PORT_MUTEX_UNLOCK(gMutexContainer);
@@ -2455,14 +2724,116 @@ int32_t uSockSelect(int32_t maxDescriptor,
                     uSockDescriptorSet_t *pExceptDescriptorSet,
                     int32_t timeMs)
 {
-    // TODO
-    (void) maxDescriptor;
-    (void) pReadDescriptorSet;
-    (void) pWriteDescriptoreSet;
-    (void) pExceptDescriptorSet;
-    (void) timeMs;
-    errno = U_SOCK_ENOSYS;
-    return (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED;
+    int32_t numReadyOrError = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+    uSockPollDescriptor_t pollDescriptors[U_SOCK_DESCRIPTOR_SET_SIZE];
+    size_t numPollDescriptors = 0;
+    uint8_t events;
+    uint8_t revents;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        if (maxDescriptor > U_SOCK_DESCRIPTOR_SET_SIZE) {
+            maxDescriptor = U_SOCK_DESCRIPTOR_SET_SIZE;
+        }
+        // Turn the sets into an array of poll descriptors
+        for (int32_t d = 0; d < maxDescriptor; d++) {
+            events = 0;
+            if ((pReadDescriptorSet != NULL) &&
+                U_SOCK_FD_ISSET(d, pReadDescriptorSet)) {
+                events |= U_SOCK_POLL_IN;
+            }
+            if ((pWriteDescriptoreSet != NULL) &&
+                U_SOCK_FD_ISSET(d, pWriteDescriptoreSet)) {
+                events |= U_SOCK_POLL_OUT;
+            }
+            if ((pExceptDescriptorSet != NULL) &&
+                U_SOCK_FD_ISSET(d, pExceptDescriptorSet)) {
+                events |= U_SOCK_POLL_ERR;
+            }
+            if (events != 0) {
+                pollDescriptors[numPollDescriptors].descriptor = d;
+                pollDescriptors[numPollDescriptors].events = events;
+                numPollDescriptors++;
+            }
+        }
+
+        numReadyOrError = pollWait(pollDescriptors, numPollDescriptors,
+                                   timeMs);
+        if (numReadyOrError >= 0) {
+            // Write the results back into the sets, select()
+            // counting a socket once for each set it is in
+            numReadyOrError = 0;
+            for (size_t x = 0; x < numPollDescriptors; x++) {
+                events = pollDescriptors[x].events;
+                revents = pollDescriptors[x].revents;
+                if ((revents & U_SOCK_POLL_NVAL) != 0) {
+                    errnoLocal = U_SOCK_EBADF;
+                }
+                if ((events & U_SOCK_POLL_IN) != 0) {
+                    if ((revents & (U_SOCK_POLL_IN | U_SOCK_POLL_ERR)) != 0) {
+                        numReadyOrError++;
+                    } else {
+                        U_SOCK_FD_CLR(pollDescriptors[x].descriptor, pReadDescriptorSet);
+                    }
+                }
+                if ((events & U_SOCK_POLL_OUT) != 0) {
+                    if ((revents & U_SOCK_POLL_OUT) != 0) {
+                        numReadyOrError++;
+                    } else {
+                        U_SOCK_FD_CLR(pollDescriptors[x].descriptor, pWriteDescriptoreSet);
+                    }
+                }
+                if ((events & U_SOCK_POLL_ERR) != 0) {
+                    if ((revents & U_SOCK_POLL_ERR) != 0) {
+                        numReadyOrError++;
+                    } else {
+                        U_SOCK_FD_CLR(pollDescriptors[x].descriptor, pExceptDescriptorSet);
+                    }
+                }
+            }
+        } else {
+            errnoLocal = -numReadyOrError;
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        numReadyOrError = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return numReadyOrError;
+}
+
+// Poll: wait for one of an array of sockets to become ready.
+int32_t uSockPoll(uSockPollDescriptor_t *pPollDescriptors,
+                  size_t numPollDescriptors,
+                  int32_t timeMs)
+{
+    int32_t numReadyOrError = (int32_t) U_ERROR_COMMON_SUCCESS;
+    int32_t errnoLocal;
+
+    errnoLocal = init();
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = U_SOCK_EINVAL;
+        if ((pPollDescriptors != NULL) || (numPollDescriptors == 0)) {
+            errnoLocal = U_SOCK_ENONE;
+            numReadyOrError = pollWait(pPollDescriptors, numPollDescriptors,
+                                       timeMs);
+            if (numReadyOrError < 0) {
+                errnoLocal = -numReadyOrError;
+            }
+        }
+    }
+
+    if (errnoLocal != U_SOCK_ENONE) {
+        // Write the errno
+        errno = errnoLocal;
+        numReadyOrError = (int32_t) U_ERROR_COMMON_BSD_ERROR;
+    }
+
+    return numReadyOrError;
 }
 
 /* ----------------------------------------------------------------
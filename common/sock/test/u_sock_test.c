@@ -128,7 +128,7 @@
 /** Expected return time for non-blocking operation
  *in ms during testing.
  */
-# define U_SOCK_TEST_NON_BLOCKING_TIME_MS (U_SOCK_RECEIVE_POLL_INTERVAL_MS + 250)
+# define U_SOCK_TEST_NON_BLOCKING_TIME_MS 350
 #endif
 
 #ifndef U_SOCK_TEST_TIME_MARGIN_PLUS_MS
@@ -160,6 +160,18 @@
 # error U_SOCK_TEST_TIME_MARGIN_PLUS_MS cannot be larger than U_SOCK_RECEIVE_TIMEOUT_DEFAULT_MS
 #endif
 
+/** The number of bytes echoed in each sample of the TCP echo
+ * benchmark.
+ */
+#ifndef U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE
+# define U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE 1024
+#endif
+
+/** How long to wait for the echo in each sample of the TCP echo
+ * benchmark.
+ */
+#define U_SOCK_TEST_BENCHMARK_TCP_ECHO_TIMEOUT_MS 20000
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -302,6 +314,16 @@ static const char gSendData[] =  "_____0000:012345678901234567890123456789012345
                                  "_____2000:0123456789012345678901234567890123456789"
                                  "01234567890123456789012345678901234567890123456789";
 
+#ifdef U_RUNNER_BENCHMARK
+/** The socket used by the TCP echo benchmark.
+ */
+static uSockDescriptor_t gBenchmarkDescriptor = -1;
+
+/** Buffer for the data echoed back in the TCP echo benchmark.
+ */
+static char gBenchmarkReceived[U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE];
+#endif
+
 /** A string of all possible characters, including strings
  * that might appear as terminators in an AT interface.
  */
@@ -772,6 +794,70 @@ static void osCleanup()
         gTestConfig.eventQueueHandle = -1;
     }
 }
+
+#ifdef U_RUNNER_BENCHMARK
+
+// Set-up for the TCP echo benchmark: connect a TCP socket to the
+// echo server on the first network that supports sockets.  If there
+// is no such network pContext is left as NULL and the benchmark
+// does nothing.
+static int32_t benchmarkTcpEchoSetUp(void **ppContext)
+{
+    int32_t errorCode = 0;
+    int32_t networkHandle = -1;
+    uSockAddress_t remoteAddress;
+
+    osCleanup();
+    stdPreamble();
+
+    for (size_t x = 0; (x < gUNetworkTestCfgSize) && (networkHandle < 0); x++) {
+        if ((gUNetworkTestCfg[x].handle >= 0) &&
+            U_NETWORK_TEST_TYPE_HAS_SOCK(gUNetworkTestCfg[x].type)) {
+            networkHandle = gUNetworkTestCfg[x].handle;
+        }
+    }
+
+    if (networkHandle >= 0) {
+        errorCode = uSockGetHostByName(networkHandle,
+                                       U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                       &(remoteAddress.ipAddress));
+        remoteAddress.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+        if (errorCode == 0) {
+            gBenchmarkDescriptor = uSockCreate(networkHandle, U_SOCK_TYPE_STREAM,
+                                               U_SOCK_PROTOCOL_TCP);
+            errorCode = gBenchmarkDescriptor;
+        }
+        if (errorCode >= 0) {
+            errorCode = uSockConnect(gBenchmarkDescriptor, &remoteAddress);
+        }
+        if (errorCode >= 0) {
+            *ppContext = &gBenchmarkDescriptor;
+        }
+    }
+
+    return errorCode;
+}
+
+// Tear-down for the TCP echo benchmark.
+static void benchmarkTcpEchoTearDown(void *pContext)
+{
+    (void) pContext;
+
+    if (gBenchmarkDescriptor >= 0) {
+        uSockClose(gBenchmarkDescriptor);
+        gBenchmarkDescriptor = -1;
+    }
+    uSockCleanUp();
+    // Reset the shared network handles, as sockCleanUp does
+    for (size_t x = 0; x < gUNetworkTestCfgSize; x++) {
+        gUNetworkTestCfg[x].handle = -1;
+    }
+    uNetworkDeinit();
+    uPortDeinit();
+    errno = 0;
+}
+
+#endif
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -906,6 +992,91 @@ U_PORT_TEST_FUNCTION("[sock]", "sockAddressStrings")
     U_PORT_TEST_ASSERT(heapUsed <= 0);
 }
 
+/** Test select/poll on their own, i.e. without a network:
+ * timeout with nothing to wait for, bad descriptors and the
+ * descriptor set macros.
+ */
+U_PORT_TEST_FUNCTION("[sock]", "sockSelectPoll")
+{
+    uSockDescriptorSet_t set;
+    uSockPollDescriptor_t pollDescriptors[2];
+    int32_t heapUsed;
+    int32_t heapSockInitLoss;
+    int64_t startTimeMs;
+    int32_t elapsedMs;
+
+    // No network need be brought up but the network
+    // layers must be initialised for sockets to initialise
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uNetworkInit() == 0);
+    heapUsed = uPortGetHeapFree();
+
+    // Check the descriptor set macros
+    U_SOCK_FD_ZERO(&set);
+    for (int32_t x = -1; x <= U_SOCK_DESCRIPTOR_SET_SIZE; x++) {
+        U_PORT_TEST_ASSERT(!U_SOCK_FD_ISSET(x, &set));
+    }
+    U_SOCK_FD_SET(U_SOCK_DESCRIPTOR_SET_SIZE - 1, &set);
+    U_SOCK_FD_SET(U_SOCK_DESCRIPTOR_SET_SIZE, &set);
+    U_SOCK_FD_SET(-1, &set);
+    for (int32_t x = -1; x <= U_SOCK_DESCRIPTOR_SET_SIZE; x++) {
+        U_PORT_TEST_ASSERT(U_SOCK_FD_ISSET(x, &set) ==
+                           (x == U_SOCK_DESCRIPTOR_SET_SIZE - 1));
+    }
+    U_SOCK_FD_CLR(U_SOCK_DESCRIPTOR_SET_SIZE - 1, &set);
+    U_PORT_TEST_ASSERT(!U_SOCK_FD_ISSET(U_SOCK_DESCRIPTOR_SET_SIZE - 1, &set));
+
+    // Selecting on nothing should just time out; the first call
+    // to a sockets API initialises the sockets layer, take account
+    // of that heap cost here
+    uPortLog("U_SOCK_TEST: select on nothing...\n");
+    heapSockInitLoss = uPortGetHeapFree();
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uSockSelect(U_SOCK_DESCRIPTOR_SET_SIZE, &set,
+                                   NULL, NULL, 500) == 0);
+    elapsedMs = (int32_t) (uPortGetTickTimeMs() - startTimeMs);
+    heapSockInitLoss -= uPortGetHeapFree();
+    uPortLog("U_SOCK_TEST: uSockSelect() took %d ms.\n", elapsedMs);
+    U_PORT_TEST_ASSERT(elapsedMs >= 500 - U_SOCK_TEST_TIME_MARGIN_MINUS_MS);
+    U_PORT_TEST_ASSERT(elapsedMs < 500 + U_SOCK_TEST_TIME_MARGIN_PLUS_MS);
+
+    // Selecting on a descriptor that isn't open should fail at once
+    uPortLog("U_SOCK_TEST: select on a descriptor that isn't open...\n");
+    U_SOCK_FD_SET(0, &set);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uSockSelect(U_SOCK_DESCRIPTOR_SET_SIZE, &set,
+                                   NULL, NULL, 5000) < 0);
+    U_PORT_TEST_ASSERT(errno == U_SOCK_EBADF);
+    errno = 0;
+    U_PORT_TEST_ASSERT(uPortGetTickTimeMs() - startTimeMs < 5000);
+
+    // Poll should ignore negative descriptors and flag bad ones
+    uPortLog("U_SOCK_TEST: poll...\n");
+    pollDescriptors[0].descriptor = -1;
+    pollDescriptors[0].events = U_SOCK_POLL_IN;
+    pollDescriptors[0].revents = 0xFF;
+    pollDescriptors[1].descriptor = U_SOCK_DESCRIPTOR_SET_SIZE - 1;
+    pollDescriptors[1].events = U_SOCK_POLL_IN | U_SOCK_POLL_OUT;
+    pollDescriptors[1].revents = 0;
+    U_PORT_TEST_ASSERT(uSockPoll(pollDescriptors, 2, 5000) == 1);
+    U_PORT_TEST_ASSERT(pollDescriptors[0].revents == 0);
+    U_PORT_TEST_ASSERT(pollDescriptors[1].revents == U_SOCK_POLL_NVAL);
+    U_PORT_TEST_ASSERT(uSockPoll(pollDescriptors, 1, 100) == 0);
+    U_PORT_TEST_ASSERT(errno == 0);
+
+    uSockDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_SOCK_TEST: %d byte(s) were lost to sockets"
+             " initialisation; we have leaked %d byte(s).\n",
+             heapSockInitLoss, heapUsed - heapSockInitLoss);
+    U_PORT_TEST_ASSERT(heapUsed <= heapSockInitLoss);
+
+    uNetworkDeinit();
+    uPortDeinit();
+}
+
 /** Basic UDP test.
  */
 U_PORT_TEST_FUNCTION("[sock]", "sockBasicUdp")
@@ -2553,4 +2724,60 @@ U_PORT_TEST_FUNCTION("[sock]", "sockCleanUp")
     }
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BENCHMARKS
+ * -------------------------------------------------------------- */
+
+#ifdef U_RUNNER_BENCHMARK
+
+/** Time echoing a block of data through a TCP socket to the echo
+ * server on the first network which supports sockets, i.e. the
+ * write, the round trip and the read; the bytes reported are those
+ * sent.
+ */
+U_RUNNER_BENCHMARK("[sock]", "sockBenchmarkTcpEcho", 20,
+                   benchmarkTcpEchoSetUp, benchmarkTcpEchoTearDown)
+{
+    int32_t errorCode = 0;
+    uSockDescriptor_t descriptor;
+    size_t sent = 0;
+    size_t received = 0;
+    int64_t startTimeMs;
+
+    if (pContext != NULL) {
+        descriptor = *((uSockDescriptor_t *) pContext);
+        startTimeMs = uPortGetTickTimeMs();
+        while ((errorCode >= 0) && (received < U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE) &&
+               (uPortGetTickTimeMs() - startTimeMs < U_SOCK_TEST_BENCHMARK_TCP_ECHO_TIMEOUT_MS)) {
+            if (sent < U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE) {
+                errorCode = uSockWrite(descriptor, gSendData + sent,
+                                       U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE - sent);
+                if (errorCode > 0) {
+                    sent += errorCode;
+                }
+            }
+            if (errorCode >= 0) {
+                errorCode = uSockRead(descriptor, gBenchmarkReceived + received,
+                                      sizeof(gBenchmarkReceived) - received);
+                if (errorCode > 0) {
+                    received += errorCode;
+                } else if (errno == U_SOCK_EWOULDBLOCK) {
+                    // Nothing has come back yet
+                    errno = 0;
+                    errorCode = 0;
+                }
+            }
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        if ((received == U_SOCK_TEST_BENCHMARK_TCP_ECHO_SIZE) &&
+            (memcmp(gSendData, gBenchmarkReceived, received) == 0)) {
+            errorCode = (int32_t) sent;
+        }
+    }
+
+    return errorCode;
+}
+
+#endif
+
 // End of file
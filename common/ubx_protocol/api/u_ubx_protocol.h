@@ -44,6 +44,25 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The context of an incremental ubx protocol decoder, see
+ * uUbxProtocolDecoderInit() and uUbxProtocolDecoderFeed().  The
+ * fields marked "internal" should not be touched by the caller.
+ */
+typedef struct {
+    int32_t state; /**< internal: how far through a message we are. */
+    size_t bodyCountBytes; /**< internal: the number of body bytes received so far. */
+    uint8_t ca; /**< internal: first byte of the running CRC. */
+    uint8_t cb; /**< internal: second byte of the running CRC. */
+    char *pBody; /**< storage for the decoded message body. */
+    size_t maxBodyLengthBytes; /**< the amount of storage at pBody. */
+    int32_t messageClass; /**< the message class of the message
+                               most recently decoded. */
+    int32_t messageId; /**< the message ID of the message most
+                            recently decoded. */
+    size_t bodyLengthBytes; /**< the body length of the message most
+                                 recently decoded. */
+} uUbxProtocolDecoder_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -212,6 +231,90 @@ int32_t uUbxProtocolDecode(const char *pBufferIn, size_t bufferLengthBytes,
                            char *pMessageBody, size_t maxMessageBodyLengthBytes,
                            const char **ppBufferOut);
 
+/** Initialise an incremental ubx protocol decoder.  Where
+ * uUbxProtocolDecode() needs the whole of a message to be in the
+ * buffer it is given, and so must be given the same data again and
+ * again while a message is arriving, an incremental decoder can be
+ * fed a stream in chunks of any size, each byte being looked at only
+ * once: the sync, header, length and CRC state is kept in the decoder
+ * between calls and the message body is written straight to pBody.
+ * This makes it suitable for picking ubx messages out of a stream
+ * which may also contain NMEA sentences, using a bounded amount of
+ * storage.
+ *
+ * @param pDecoder           a pointer to the decoder context to
+ *                           initialise; cannot be NULL.
+ * @param pBody              storage for the body of a decoded
+ *                           message; may be NULL only if
+ *                           maxBodyLengthBytes is zero.
+ * @param maxBodyLengthBytes the amount of storage at pBody.  A
+ *                           message with a body longer than this is
+ *                           treated as corrupt and skipped, since
+ *                           waiting for its body would hold up the
+ *                           messages behind it, so pBody must be
+ *                           large enough for the largest message
+ *                           you want to receive.
+ */
+void uUbxProtocolDecoderInit(uUbxProtocolDecoder_t *pDecoder,
+                             char *pBody, size_t maxBodyLengthBytes);
+
+/** Feed data to an incremental ubx protocol decoder; the decoder
+ * must have been initialised with uUbxProtocolDecoderInit().  The
+ * data is consumed until the end of a complete message is reached,
+ * in which case the length of the message body is returned, the
+ * message class, message ID and body length are in the messageClass,
+ * messageId and bodyLengthBytes fields of the decoder context and
+ * the message body is at pBody, valid until the decoder is next fed.
+ * ppBufferOut will be set to the first position in pBufferIn after
+ * the message (or one byte beyond the end if nothing was found),
+ * hence a good pattern for use of this function could be:
+ *
+ * uUbxProtocolDecoder_t decoder;
+ * char messageBody[128];
+ * const char *pBufferStart;
+ * const char *pBufferEnd;
+ * size_t bufferLength;
+ *
+ * uUbxProtocolDecoderInit(&decoder, messageBody, sizeof(messageBody));
+ *
+ * // Each time some data arrives in dataIn
+ * pBufferStart = &(dataIn[0]);
+ * bufferLength = dataInLength;
+ * while (bufferLength > 0) {
+ *     x = uUbxProtocolDecoderFeed(&decoder, pBufferStart, bufferLength,
+ *                                 &pBufferEnd);
+ *     if (x >= 0) {
+ *         // Handle the message here
+ *     }
+ *     bufferLength -= pBufferEnd - pBufferStart;
+ *     pBufferStart = pBufferEnd;
+ * }
+ *
+ * A message which fails its CRC check is dropped and the search for
+ * the next message carries on from the byte where the check failed.
+ *
+ * @param pDecoder           a pointer to the decoder context; cannot
+ *                           be NULL.
+ * @param pBufferIn          a pointer to the data to decode.
+ * @param bufferLengthBytes  the amount of data at pBufferIn.
+ * @param ppBufferOut        a pointer to somewhere to store the
+ *                           buffer pointer after decoding; may be
+ *                           NULL, in which case the caller has no
+ *                           way of knowing how much of pBufferIn was
+ *                           consumed when a message is returned.
+ * @return                   the length of the body of a complete
+ *                           message, else U_ERROR_COMMON_TIMEOUT if
+ *                           all of pBufferIn was consumed and the
+ *                           decoder is part way through a message or
+ *                           U_ERROR_COMMON_NOT_FOUND if all of
+ *                           pBufferIn was consumed and the decoder is
+ *                           not part way through a message.
+ */
+int32_t uUbxProtocolDecoderFeed(uUbxProtocolDecoder_t *pDecoder,
+                                const char *pBufferIn,
+                                size_t bufferLengthBytes,
+                                const char **ppBufferOut);
+
 #ifdef __cplusplus
 }
 #endif
@@ -32,7 +32,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcpy()
+#include "string.h"    // memcpy(), memset()
 
 #include "u_error_common.h"
 
@@ -46,6 +46,21 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The states of an incremental decoder, stored in the state
+ * field of uUbxProtocolDecoder_t.
+ */
+typedef enum {
+    U_UBX_PROTOCOL_DECODER_STATE_SYNC_1 = 0, /**< looking for 0xb5. */
+    U_UBX_PROTOCOL_DECODER_STATE_SYNC_2,     /**< looking for 0x62. */
+    U_UBX_PROTOCOL_DECODER_STATE_CLASS,
+    U_UBX_PROTOCOL_DECODER_STATE_ID,
+    U_UBX_PROTOCOL_DECODER_STATE_LENGTH_1,
+    U_UBX_PROTOCOL_DECODER_STATE_LENGTH_2,
+    U_UBX_PROTOCOL_DECODER_STATE_BODY,
+    U_UBX_PROTOCOL_DECODER_STATE_CRC_1,
+    U_UBX_PROTOCOL_DECODER_STATE_CRC_2
+} uUbxProtocolDecoderState_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -54,6 +69,28 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Add a byte to the running CRC of an incremental decoder.
+static void decoderCrcUpdate(uUbxProtocolDecoder_t *pDecoder, uint8_t byte)
+{
+    pDecoder->ca += byte;
+    pDecoder->cb += pDecoder->ca;
+}
+
+// The state an incremental decoder should go to when the byte it
+// has just been given means the message it was decoding is not
+// valid: the byte could itself be the start of the next message.
+static int32_t decoderStateResync(uint8_t byte)
+{
+    int32_t state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+
+    //lint -e{650} Suppress warning about 0xb5 being out of range for char
+    if (byte == 0xb5) {
+        state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_2;
+    }
+
+    return state;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -344,4 +381,137 @@ int32_t uUbxProtocolDecode(const char *pBufferIn, size_t bufferLengthBytes,
     return sizeOrErrorCode;
 }
 
+// Initialise an incremental decoder.
+void uUbxProtocolDecoderInit(uUbxProtocolDecoder_t *pDecoder,
+                             char *pBody, size_t maxBodyLengthBytes)
+{
+    if (pDecoder != NULL) {
+        memset(pDecoder, 0, sizeof(*pDecoder));
+        pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+        pDecoder->pBody = pBody;
+        if (pBody != NULL) {
+            pDecoder->maxBodyLengthBytes = maxBodyLengthBytes;
+        }
+        pDecoder->messageClass = -1;
+        pDecoder->messageId = -1;
+    }
+}
+
+// Feed data to an incremental decoder.
+int32_t uUbxProtocolDecoderFeed(uUbxProtocolDecoder_t *pDecoder,
+                                const char *pBufferIn,
+                                size_t bufferLengthBytes,
+                                const char **ppBufferOut)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    // Use a uint8_t pointer for maths, more certain of its behaviour than char
+    const uint8_t *pInput = (const uint8_t *) pBufferIn;
+    const uint8_t *pInputEnd = pInput + bufferLengthBytes;
+    size_t length;
+    uint8_t byte;
+
+    if ((pDecoder != NULL) && ((pBufferIn != NULL) || (bufferLengthBytes == 0))) {
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        while ((sizeOrErrorCode < 0) && (pInput < pInputEnd)) {
+            if (pDecoder->state == (int32_t) U_UBX_PROTOCOL_DECODER_STATE_BODY) {
+                // Take as much of the body as we have in one go
+                length = pDecoder->bodyLengthBytes - pDecoder->bodyCountBytes;
+                if (length > (size_t) (pInputEnd - pInput)) {
+                    length = pInputEnd - pInput;
+                }
+                // The length was checked against maxBodyLengthBytes
+                // when the header arrived so this can't overrun
+                memcpy(pDecoder->pBody + pDecoder->bodyCountBytes, pInput, length);
+                pDecoder->bodyCountBytes += length;
+                for (size_t x = 0; x < length; x++) {
+                    decoderCrcUpdate(pDecoder, *pInput);
+                    pInput++;
+                }
+                if (pDecoder->bodyCountBytes == pDecoder->bodyLengthBytes) {
+                    pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_CRC_1;
+                }
+            } else {
+                byte = *pInput;
+                pInput++;
+                switch (pDecoder->state) {
+                    case U_UBX_PROTOCOL_DECODER_STATE_SYNC_1:
+                        pDecoder->state = decoderStateResync(byte);
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_SYNC_2:
+                        if (byte == 0x62) {
+                            pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_CLASS;
+                        } else {
+                            pDecoder->state = decoderStateResync(byte);
+                        }
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_CLASS:
+                        // Start of the CRC calculation
+                        pDecoder->ca = 0;
+                        pDecoder->cb = 0;
+                        decoderCrcUpdate(pDecoder, byte);
+                        pDecoder->messageClass = byte;
+                        pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_ID;
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_ID:
+                        decoderCrcUpdate(pDecoder, byte);
+                        pDecoder->messageId = byte;
+                        pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_LENGTH_1;
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_LENGTH_1:
+                        decoderCrcUpdate(pDecoder, byte);
+                        pDecoder->bodyLengthBytes = byte;
+                        pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_LENGTH_2;
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_LENGTH_2:
+                        decoderCrcUpdate(pDecoder, byte);
+                        // Cast twice to keep Lint happy
+                        pDecoder->bodyLengthBytes += ((size_t) byte) << 8; // *NOPAD*
+                        pDecoder->bodyCountBytes = 0;
+                        if (pDecoder->bodyLengthBytes > pDecoder->maxBodyLengthBytes) {
+                            // Either not a message or one we can't
+                            // store: either way, skip it
+                            pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                        } else if (pDecoder->bodyLengthBytes == 0) {
+                            pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_CRC_1;
+                        } else {
+                            pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_BODY;
+                        }
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_CRC_1:
+                        if (byte == pDecoder->ca) {
+                            pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_CRC_2;
+                        } else {
+                            pDecoder->state = decoderStateResync(byte);
+                        }
+                        break;
+                    case U_UBX_PROTOCOL_DECODER_STATE_CRC_2:
+                        if (byte == pDecoder->cb) {
+                            // Got a complete message
+                            sizeOrErrorCode = (int32_t) pDecoder->bodyLengthBytes;
+                            pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                        } else {
+                            pDecoder->state = decoderStateResync(byte);
+                        }
+                        break;
+                    default:
+                        pDecoder->state = (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_1;
+                        break;
+                }
+            }
+        }
+
+        if ((sizeOrErrorCode < 0) &&
+            (pDecoder->state != (int32_t) U_UBX_PROTOCOL_DECODER_STATE_SYNC_1)) {
+            // Part way through a message
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        }
+
+        if (ppBufferOut != NULL) {
+            *ppBufferOut = (const char *) pInput;
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
 // End of file
@@ -35,7 +35,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memcmp()/memset()
+#include "string.h"    // memcmp()/memset()/memcpy()/strlen()
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -60,6 +60,16 @@
 # define U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE 1024
 #endif
 
+/** The size of message body used in the benchmarks, that of a
+ * UBX-NAV-PVT message.
+ */
+#define U_UBX_PROTOCOL_TEST_BENCHMARK_BODY_SIZE 92
+
+/** The number of messages encoded and decoded in each sample of
+ * a benchmark.
+ */
+#define U_UBX_PROTOCOL_TEST_BENCHMARK_NUM_MESSAGES 20
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -68,10 +78,86 @@
  * VARIABLES
  * -------------------------------------------------------------- */
 
+#ifdef U_RUNNER_BENCHMARK
+/** The message body used in the benchmarks.
+ */
+static char gBenchmarkBody[U_UBX_PROTOCOL_TEST_BENCHMARK_BODY_SIZE];
+
+/** The stream of encoded messages used in the benchmarks.
+ */
+static char gBenchmarkStream[(U_UBX_PROTOCOL_TEST_BENCHMARK_BODY_SIZE +
+                              U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) *
+                             U_UBX_PROTOCOL_TEST_BENCHMARK_NUM_MESSAGES];
+
+/** The length of the contents of gBenchmarkStream.
+ */
+static int32_t gBenchmarkStreamLength = 0;
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+#ifdef U_RUNNER_BENCHMARK
+
+// Set-up for the benchmarks: fill the message body.
+static int32_t benchmarkSetUp(void **ppContext)
+{
+    (void) ppContext;
+
+    for (size_t x = 0; x < sizeof(gBenchmarkBody); x++) {
+        gBenchmarkBody[x] = (char) x;
+    }
+
+    return uPortInit();
+}
+
+// Tear-down for the benchmarks.
+static void benchmarkTearDown(void *pContext)
+{
+    (void) pContext;
+
+    uPortDeinit();
+}
+
+// Encode U_UBX_PROTOCOL_TEST_BENCHMARK_NUM_MESSAGES messages into
+// gBenchmarkStream, returning the length of the stream.
+static int32_t benchmarkEncode()
+{
+    int32_t length = 0;
+    int32_t x = 0;
+
+    for (size_t y = 0; (y < U_UBX_PROTOCOL_TEST_BENCHMARK_NUM_MESSAGES) &&
+         (x >= 0); y++) {
+        x = uUbxProtocolEncode(0x01, 0x07, gBenchmarkBody,
+                               sizeof(gBenchmarkBody),
+                               gBenchmarkStream + length);
+        length += x;
+    }
+    if (x < 0) {
+        length = x;
+    }
+
+    return length;
+}
+
+// Set-up for the decode benchmark: fill the stream.
+static int32_t benchmarkSetUpDecode(void **ppContext)
+{
+    int32_t errorCode = benchmarkSetUp(ppContext);
+
+    if (errorCode == 0) {
+        gBenchmarkStreamLength = benchmarkEncode();
+        if (gBenchmarkStreamLength < 0) {
+            errorCode = gBenchmarkStreamLength;
+        }
+    }
+
+    return errorCode;
+}
+
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -163,6 +249,136 @@ U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolBackToBack")
     free(pBuffer);
 }
 
+/** Test of the incremental decoder: a stream of ubx messages mixed
+ * with NMEA, a message with a bad CRC and a header with a length
+ * that is too big, fed to the decoder in chunks of various sizes.
+ */
+U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolDecoder")
+{
+    uUbxProtocolDecoder_t decoder;
+    const char *pNmea = "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n";
+    // A ubx header with a length bigger than we will allow
+    const char oversize[] = {(char) 0xb5, 0x62, 0x01, 0x02, (char) 0xff, (char) 0xff};
+    // Message lengths, the second one being sent with a bad CRC
+    const size_t lengths[] = {20, 30, 0, U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE};
+    const size_t chunkSizes[] = {1, 7, 64, 0};
+    char *pBody;
+    char *pBuffer;
+    size_t bufferLength = 0;
+    const char *pTmpStart;
+    const char *pTmpEnd;
+    size_t length;
+    size_t chunkSize;
+    size_t count;
+    int32_t x;
+
+    pBody = (char *) malloc(U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE);
+    U_PORT_TEST_ASSERT(pBody != NULL);
+    pBuffer = (char *) malloc((U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE + 256) * 2);
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Assemble the stream
+    for (size_t y = 0; y < sizeof(lengths) / sizeof(lengths[0]); y++) {
+        memcpy(pBuffer + bufferLength, pNmea, strlen(pNmea));
+        bufferLength += strlen(pNmea);
+        if (y == 2) {
+            memcpy(pBuffer + bufferLength, oversize, sizeof(oversize));
+            bufferLength += sizeof(oversize);
+            // An extra sync byte, to check that the decoder resyncs
+            *(pBuffer + bufferLength) = (char) 0xb5;
+            bufferLength++;
+        }
+        for (size_t z = 0; z < lengths[y]; z++) {
+            *(pBody + z) = (char) (y + z);
+        }
+        x = uUbxProtocolEncode(0x10 + y, 0x20 + y, pBody, lengths[y],
+                               pBuffer + bufferLength);
+        U_PORT_TEST_ASSERT(x == lengths[y] + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+        if (y == 1) {
+            (*(pBuffer + bufferLength + x - 2))++;
+        }
+        bufferLength += x;
+    }
+
+    for (size_t y = 0; y < sizeof(chunkSizes) / sizeof(chunkSizes[0]); y++) {
+        chunkSize = chunkSizes[y];
+        if (chunkSize == 0) {
+            chunkSize = bufferLength;
+        }
+        uPortLog("U_UBX_PROTOCOL_TEST: decoding %d byte(s) in chunks of %d byte(s).\n",
+                 bufferLength, chunkSize);
+        uUbxProtocolDecoderInit(&decoder, pBody, U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE);
+        count = 0;
+        for (size_t z = 0; z < bufferLength; z += chunkSize) {
+            pTmpStart = pBuffer + z;
+            length = bufferLength - z;
+            if (length > chunkSize) {
+                length = chunkSize;
+            }
+            while (length > 0) {
+                x = uUbxProtocolDecoderFeed(&decoder, pTmpStart, length, &pTmpEnd);
+                U_PORT_TEST_ASSERT((pTmpEnd > pTmpStart) && (pTmpEnd <= pTmpStart + length));
+                if (x >= 0) {
+                    // The message with the bad CRC should be skipped
+                    if (count == 1) {
+                        count++;
+                    }
+                    U_PORT_TEST_ASSERT(count < sizeof(lengths) / sizeof(lengths[0]));
+                    U_PORT_TEST_ASSERT(x == lengths[count]);
+                    U_PORT_TEST_ASSERT(decoder.messageClass == 0x10 + count);
+                    U_PORT_TEST_ASSERT(decoder.messageId == 0x20 + count);
+                    U_PORT_TEST_ASSERT(decoder.bodyLengthBytes == lengths[count]);
+                    for (int32_t w = 0; w < x; w++) {
+                        U_PORT_TEST_ASSERT(*(pBody + w) == (char) (count + w));
+                    }
+                    count++;
+                } else {
+                    // Anything else must have consumed the lot
+                    U_PORT_TEST_ASSERT(pTmpEnd == pTmpStart + length);
+                }
+                length -= pTmpEnd - pTmpStart;
+                pTmpStart = pTmpEnd;
+            }
+        }
+        U_PORT_TEST_ASSERT(count == sizeof(lengths) / sizeof(lengths[0]));
+        // Nothing should be left part-decoded
+        U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pNmea, strlen(pNmea),
+                                                   NULL) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    }
+
+    // With less body storage the last message should be skipped
+    uUbxProtocolDecoderInit(&decoder, pBody, U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE - 1);
+    count = 0;
+    pTmpStart = pBuffer;
+    length = bufferLength;
+    while (length > 0) {
+        if (uUbxProtocolDecoderFeed(&decoder, pTmpStart, length, &pTmpEnd) >= 0) {
+            count++;
+        }
+        length -= pTmpEnd - pTmpStart;
+        pTmpStart = pTmpEnd;
+    }
+    U_PORT_TEST_ASSERT(count == 2);
+
+    // Half a message should leave the decoder waiting for more
+    x = uUbxProtocolEncode(0x01, 0x02, pBody, 10, pBuffer);
+    uUbxProtocolDecoderInit(&decoder, pBody, U_UBX_PROTOCOL_TEST_MAX_BODY_SIZE);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pBuffer, x / 2,
+                                               NULL) == (int32_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pBuffer + (x / 2), x - (x / 2),
+                                               NULL) == 10);
+
+    // No storage: only messages without a body can be decoded
+    uUbxProtocolDecoderInit(&decoder, NULL, 100);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pBuffer, x, NULL) < 0);
+    x = uUbxProtocolEncode(0x01, 0x02, NULL, 0, pBuffer);
+    U_PORT_TEST_ASSERT(uUbxProtocolDecoderFeed(&decoder, pBuffer, x, NULL) == 0);
+
+    // Free memory
+    free(pBody);
+    free(pBuffer);
+}
+
 /** Clean-up to be run at the end of this round of tests, just
  * in case there were test failures which would have resulted
  * in the deinitialisation being skipped.
@@ -188,4 +404,50 @@ U_PORT_TEST_FUNCTION("[ubxProtocol]", "ubxProtocolCleanUp")
     }
 }
 
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BENCHMARKS
+ * -------------------------------------------------------------- */
+
+#ifdef U_RUNNER_BENCHMARK
+
+/** Time encoding a stream of UBX-NAV-PVT-sized messages.
+ */
+U_RUNNER_BENCHMARK("[ubxProtocol]", "ubxProtocolBenchmarkEncode", 50,
+                   benchmarkSetUp, benchmarkTearDown)
+{
+    (void) pContext;
+
+    return benchmarkEncode();
+}
+
+/** Time decoding a stream of UBX-NAV-PVT-sized messages, fed in
+ * one go to the incremental decoder.
+ */
+U_RUNNER_BENCHMARK("[ubxProtocol]", "ubxProtocolBenchmarkDecode", 50,
+                   benchmarkSetUpDecode, benchmarkTearDown)
+{
+    uUbxProtocolDecoder_t decoder;
+    char body[U_UBX_PROTOCOL_TEST_BENCHMARK_BODY_SIZE];
+    const char *pStart = gBenchmarkStream;
+    const char *pStreamEnd = gBenchmarkStream + gBenchmarkStreamLength;
+    const char *pEnd;
+    size_t count = 0;
+
+    (void) pContext;
+
+    uUbxProtocolDecoderInit(&decoder, body, sizeof(body));
+    while (pStart < pStreamEnd) {
+        if (uUbxProtocolDecoderFeed(&decoder, pStart, pStreamEnd - pStart,
+                                    &pEnd) == sizeof(body)) {
+            count++;
+        }
+        pStart = pEnd;
+    }
+
+    return (count == U_UBX_PROTOCOL_TEST_BENCHMARK_NUM_MESSAGES) ?
+           gBenchmarkStreamLength : (int32_t) U_ERROR_COMMON_UNKNOWN;
+}
+
+#endif
+
 // End of file
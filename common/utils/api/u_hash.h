@@ -0,0 +1,72 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_HASH_H_
+#define _U_HASH_H_
+
+/* No #includes allowed here */
+
+/** @file
+ * @brief This header file defines a function that computes the
+ * 32-bit FNV-1a hash of a buffer.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The value to pass to uFnv1a32() to start a new hash (the FNV
+ * offset basis).
+ */
+#define U_FNV1A32_INITIAL_VALUE 2166136261UL
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Add a buffer to a 32-bit FNV-1a hash.  Note that
+ * common/lib_common/genlibhdr.py computes the same hash in Python
+ * for symbol names: the two must match.
+ *
+ * @param pData   a pointer to the data to hash; may be NULL
+ *                if length is zero.
+ * @param length  the number of bytes at pData.
+ * @param hash    U_FNV1A32_INITIAL_VALUE to start a new hash,
+ *                else the value returned by a previous call,
+ *                to continue that hash with pData.
+ * @return        the hash.
+ */
+uint32_t uFnv1a32(const char *pData, size_t length, uint32_t hash);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_HASH_H_
+
+// End of file
@@ -21,8 +21,29 @@
 
 /** @file
  * @brief Ring buffer wrapper API for linear buffer.
- * All functions except uRingBufferCreate() and uRingBufferDelete()
- * are thread-safe.
+ *
+ * A ring buffer created with uRingBufferCreate() is protected by a
+ * mutex and all functions except uRingBufferCreate() and
+ * uRingBufferDelete() are thread-safe.
+ *
+ * A ring buffer created with uRingBufferCreateLockFree() has no
+ * mutex: it may be written by one task (the producer: the
+ * functions uRingBufferAdd() and uRingBufferAvailableSize()) and,
+ * at the same time, read by one other task (the consumer: all of
+ * the other functions) without any locking at all, which is the
+ * usual case where data arrives in a callback and is read by the
+ * application.  If there is more than one producer or more than
+ * one consumer then the caller must provide the locking.
+ *
+ * A ring buffer created with uRingBufferCreateWithReadHandle()
+ * may be read by several consumers, each reading all of the data
+ * at its own pace, without the data being copied for each of them:
+ * a consumer calls uRingBufferTakeReadHandle() to obtain a read
+ * handle and then uses the uRingBufferHandleXxx() functions.  The
+ * space available to the producer is limited by the slowest
+ * consumer or, if uRingBufferSetDropIfFull() is used, data is
+ * instead dropped from the slowest consumer(s) to make room.  Such
+ * a ring buffer is always protected by a mutex.
  */
 
 #ifdef __cplusplus
@@ -37,12 +58,22 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** A ring buffer: treat the contents as private.  The read and
+ * write indexes run from 0 to (size * 2) - 1 so that a full
+ * buffer can be told apart from an empty one without a separate
+ * count, which would have to be written by both the producer and
+ * the consumer.
+ */
 typedef struct {
     char *pBuffer;
-    size_t dataIndex;
-    size_t dataSize;
     size_t size;
-    uPortMutexHandle_t mutex;
+    volatile size_t writeIndex; /**< only ever written by the producer. */
+    volatile size_t readIndex;  /**< only ever written by the consumer. */
+    uPortMutexHandle_t mutex;   /**< NULL if the buffer is lock-free. */
+    struct uRingBufferReader_t *pReaders; /**< NULL unless created with
+                                               read handles. */
+    size_t maxNumReadHandles;
+    bool dropIfFull;
 } uRingBuffer_t;
 
 /* ----------------------------------------------------------------
@@ -61,6 +92,40 @@ typedef struct {
  */
 void uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_t size);
 
+/** Create new lock-free ring buffer from linear buffer; such a
+ * ring buffer may only have a single producer and a single
+ * consumer, see the description at the top of this file.  Where
+ * the compiler does not offer atomic operations (it is not GCC
+ * or clang compatible) this is the same as uRingBufferCreate().
+ *
+ * @param pRingBuffer   pointer to ring buffer.
+ * @param pLinearBuffer pointer to linear buffer.
+ * @param size          size of linear buffer in bytes.
+ */
+void uRingBufferCreateLockFree(uRingBuffer_t *pRingBuffer,
+                               char *pLinearBuffer, size_t size);
+
+/** Create new ring buffer from linear buffer that can be read
+ * by more than one consumer, each through its own read handle;
+ * see the description at the top of this file.  The normal
+ * uRingBufferRead(), uRingBufferPeek(), uRingBufferSkip() and
+ * uRingBufferReadRegionGet() functions always return zero for
+ * such a ring buffer: use the uRingBufferHandleXxx() versions.
+ * Memory is allocated for the read handles, hence
+ * uRingBufferDelete() must be called to free it.
+ *
+ * @param pRingBuffer       pointer to ring buffer.
+ * @param pLinearBuffer     pointer to linear buffer.
+ * @param size              size of linear buffer in bytes.
+ * @param maxNumReadHandles the maximum number of read handles
+ *                          that may be taken at any one time.
+ * @return                  zero on success else negative error
+ *                          code.
+ */
+int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer,
+                                        char *pLinearBuffer, size_t size,
+                                        size_t maxNumReadHandles);
+
 /** Delete ring buffer.
  *
  * @param pRingBuffer   pointer to ring buffer.
@@ -89,7 +154,43 @@ bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length
  */
 size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length);
 
-/** Amount of data available.
+/** Read data from ringbuffer without removing it.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param pData         pointer where to put data.
+ * @param length        maximum length of data.
+ *
+ * @return              number of bytes copied to pData.
+ */
+size_t uRingBufferPeek(const uRingBuffer_t *pRingBuffer, char *pData, size_t length);
+
+/** Throw away data from ringbuffer.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param length        maximum length of data to throw away.
+ *
+ * @return              number of bytes thrown away.
+ */
+size_t uRingBufferSkip(uRingBuffer_t *pRingBuffer, size_t length);
+
+/** Get a pointer to the data at the read end of the ringbuffer
+ * without copying it; since the data may wrap around the end of
+ * the linear buffer this is only the first contiguous region of
+ * the data available, call this function again after
+ * uRingBufferSkip() to get the rest.  When done with the data,
+ * call uRingBufferSkip() to remove it.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param ppData        a place to put the pointer to the data;
+ *                      cannot be NULL.
+ *
+ * @return              number of bytes at *ppData.
+ */
+size_t uRingBufferReadRegionGet(const uRingBuffer_t *pRingBuffer, char **ppData);
+
+/** Amount of data available; for a ring buffer created with
+ * uRingBufferCreateWithReadHandle() this is the amount of data
+ * available to the slowest reader.
  *
  * @param pRingBuffer   handle to ringbuffer.
  *
@@ -105,7 +206,115 @@ size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer);
  */
 size_t uRingBufferAvailableSize(const uRingBuffer_t *pRingBuffer);
 
-/** Reset ring buffer.
+/** Take a read handle for a ring buffer created with
+ * uRingBufferCreateWithReadHandle().  The reader will see only the
+ * data added to the ring buffer from now on.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @return              the read handle, else negative error code.
+ */
+int32_t uRingBufferTakeReadHandle(uRingBuffer_t *pRingBuffer);
+
+/** Give back a read handle that was taken with
+ * uRingBufferTakeReadHandle(); any data that only this reader had
+ * yet to read becomes free space.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ */
+void uRingBufferGiveReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle);
+
+/** Set what happens when there is not room for the data passed to
+ * uRingBufferAdd() in a ring buffer created with
+ * uRingBufferCreateWithReadHandle() because one or more readers has
+ * not kept up.  If dropIfFull is false, the default, the add fails
+ * and nothing is added.  If dropIfFull is true the oldest data is
+ * dropped from the readers that are behind, enough to make room,
+ * and the add succeeds; the amount of data lost to each reader
+ * may be obtained with uRingBufferHandleDataLost().  This is
+ * useful where one slow consumer, e.g. a logger, should not be
+ * able to hold up the rest.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param dropIfFull    true to drop data for lagging readers.
+ */
+void uRingBufferSetDropIfFull(uRingBuffer_t *pRingBuffer, bool dropIfFull);
+
+/** As uRingBufferRead() but for the given read handle.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ * @param pData         pointer where to put data.
+ * @param length        maximum length of data.
+ *
+ * @return              number of bytes read.
+ */
+size_t uRingBufferHandleRead(uRingBuffer_t *pRingBuffer, int32_t handle,
+                             char *pData, size_t length);
+
+/** As uRingBufferPeek() but for the given read handle.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ * @param pData         pointer where to put data.
+ * @param length        maximum length of data.
+ *
+ * @return              number of bytes copied to pData.
+ */
+size_t uRingBufferHandlePeek(const uRingBuffer_t *pRingBuffer, int32_t handle,
+                             char *pData, size_t length);
+
+/** As uRingBufferSkip() but for the given read handle.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ * @param length        maximum length of data to throw away.
+ *
+ * @return              number of bytes thrown away.
+ */
+size_t uRingBufferHandleSkip(uRingBuffer_t *pRingBuffer, int32_t handle,
+                             size_t length);
+
+/** As uRingBufferReadRegionGet() but for the given read handle.
+ * Note that, if uRingBufferSetDropIfFull() has been set to true,
+ * the data at *ppData may be overwritten by the producer before
+ * uRingBufferHandleSkip() is called: use uRingBufferHandleRead()
+ * in that case.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ * @param ppData        a place to put the pointer to the data;
+ *                      cannot be NULL.
+ *
+ * @return              number of bytes at *ppData.
+ */
+size_t uRingBufferHandleReadRegionGet(const uRingBuffer_t *pRingBuffer,
+                                      int32_t handle, char **ppData);
+
+/** As uRingBufferDataSize() but for the given read handle.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ *
+ * @return              number of bytes available for reading.
+ */
+size_t uRingBufferHandleDataSize(const uRingBuffer_t *pRingBuffer, int32_t handle);
+
+/** Get the number of bytes that the given reader has lost because
+ * uRingBufferSetDropIfFull() was set to true and it did not keep
+ * up; the count is reset to zero by this call.
+ *
+ * @param pRingBuffer   handle to ringbuffer.
+ * @param handle        the read handle.
+ *
+ * @return              the number of bytes lost.
+ */
+size_t uRingBufferHandleDataLost(uRingBuffer_t *pRingBuffer, int32_t handle);
+
+/** Reset ring buffer, throwing away all of the data in it; any
+ * read handles that are in use are moved up to the write position
+ * so that they too see no data.  For a lock-free ring buffer this
+ * must be called by the consumer.
  *
  * @param pRingBuffer   handle to ringbuffer.
  */
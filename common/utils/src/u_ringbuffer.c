@@ -33,6 +33,8 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 
+#include "u_error_common.h"
+
 #include "u_port_os.h"
 #include "u_ringbuffer.h"
 
@@ -40,10 +42,34 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#if defined(__GNUC__) || defined(__clang__)
+/** The compiler offers atomic operations, so a ring buffer
+ * can be lock-free: the producer only writes writeIndex, the
+ * consumer only writes readIndex, and the acquire/release
+ * semantics make sure that the contents of the buffer are
+ * complete before an index that covers them is seen by the
+ * other side.
+ */
+# define U_RING_BUFFER_LOCK_FREE_SUPPORTED
+# define U_RING_BUFFER_INDEX_LOAD(x) __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+# define U_RING_BUFFER_INDEX_STORE(x, y) __atomic_store_n(&(x), (y), __ATOMIC_RELEASE)
+#else
+# define U_RING_BUFFER_INDEX_LOAD(x) (x)
+# define U_RING_BUFFER_INDEX_STORE(x, y) (x) = (y)
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The state of a read handle.
+ */
+struct uRingBufferReader_t {
+    size_t readIndex;
+    size_t dataLost;
+    bool inUse;
+};
+
 /* ----------------------------------------------------------------
  * PROTOTYPES
  * -------------------------------------------------------------- */
@@ -56,6 +82,199 @@
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Lock the ring buffer, if it has a mutex.
+static void lock(const uRingBuffer_t *pRingBuffer)
+{
+    if (pRingBuffer->mutex != NULL) {
+        uPortMutexLock(pRingBuffer->mutex);
+    }
+}
+
+// Unlock the ring buffer, if it has a mutex.
+static void unlock(const uRingBuffer_t *pRingBuffer)
+{
+    if (pRingBuffer->mutex != NULL) {
+        uPortMutexUnlock(pRingBuffer->mutex);
+    }
+}
+
+// The amount of data between readIndex and writeIndex.
+static size_t dataSize(const uRingBuffer_t *pRingBuffer,
+                       size_t readIndex, size_t writeIndex)
+{
+    if (writeIndex >= readIndex) {
+        return writeIndex - readIndex;
+    }
+
+    return writeIndex + (pRingBuffer->size * 2) - readIndex;
+}
+
+// Move an index on by length.
+static size_t indexAdvance(const uRingBuffer_t *pRingBuffer,
+                           size_t index, size_t length)
+{
+    index += length;
+    if (index >= pRingBuffer->size * 2) {
+        index -= pRingBuffer->size * 2;
+    }
+
+    return index;
+}
+
+// The position in the linear buffer of an index.
+static size_t indexOffset(const uRingBuffer_t *pRingBuffer, size_t index)
+{
+    if (index >= pRingBuffer->size) {
+        index -= pRingBuffer->size;
+    }
+
+    return index;
+}
+
+// Copy length bytes out of the buffer starting at readIndex, in
+// at most two pieces.
+static void copyOut(const uRingBuffer_t *pRingBuffer, size_t readIndex,
+                    char *pData, size_t length)
+{
+    size_t offset = indexOffset(pRingBuffer, readIndex);
+    size_t firstLength = pRingBuffer->size - offset;
+
+    if (firstLength > length) {
+        firstLength = length;
+    }
+    memcpy(pData, pRingBuffer->pBuffer + offset, firstLength);
+    memcpy(pData + firstLength, pRingBuffer->pBuffer, length - firstLength);
+}
+
+// Copy length bytes into the buffer starting at writeIndex, in
+// at most two pieces.
+static void copyIn(uRingBuffer_t *pRingBuffer, size_t writeIndex,
+                   const char *pData, size_t length)
+{
+    size_t offset = indexOffset(pRingBuffer, writeIndex);
+    size_t firstLength = pRingBuffer->size - offset;
+
+    if (firstLength > length) {
+        firstLength = length;
+    }
+    memcpy(pRingBuffer->pBuffer + offset, pData, firstLength);
+    memcpy(pRingBuffer->pBuffer, pData + firstLength, length - firstLength);
+}
+
+// Copy up to length bytes from readIndex to pData, if it is not
+// NULL, returning the number of bytes available up to length;
+// the ring buffer must be locked.
+static size_t peek(const uRingBuffer_t *pRingBuffer, size_t readIndex,
+                   char *pData, size_t length)
+{
+    size_t available = dataSize(pRingBuffer, readIndex,
+                                U_RING_BUFFER_INDEX_LOAD(pRingBuffer->writeIndex));
+
+    if (length > available) {
+        length = available;
+    }
+    if (pData != NULL) {
+        copyOut(pRingBuffer, readIndex, pData, length);
+    }
+
+    return length;
+}
+
+// Consume up to length bytes from *pReadIndex, copying them to pData
+// if it is not NULL, and return the number of bytes consumed; the
+// ring buffer must be locked.
+static size_t consume(uRingBuffer_t *pRingBuffer, volatile size_t *pReadIndex,
+                      char *pData, size_t length)
+{
+    size_t readIndex = *pReadIndex;
+
+    length = peek(pRingBuffer, readIndex, pData, length);
+    U_RING_BUFFER_INDEX_STORE(*pReadIndex,
+                              indexAdvance(pRingBuffer, readIndex, length));
+
+    return length;
+}
+
+// Get the contiguous region at readIndex; the ring buffer must be
+// locked.
+static size_t regionGet(const uRingBuffer_t *pRingBuffer, size_t readIndex,
+                        char **ppData)
+{
+    size_t length = dataSize(pRingBuffer, readIndex,
+                             U_RING_BUFFER_INDEX_LOAD(pRingBuffer->writeIndex));
+    size_t offset = indexOffset(pRingBuffer, readIndex);
+
+    if (length > pRingBuffer->size - offset) {
+        length = pRingBuffer->size - offset;
+    }
+    *ppData = pRingBuffer->pBuffer + offset;
+
+    return length;
+}
+
+// Get the reader for a read handle, NULL if there is no such reader.
+static struct uRingBufferReader_t *pGetReader(const uRingBuffer_t *pRingBuffer,
+                                              int32_t handle)
+{
+    struct uRingBufferReader_t *pReader = NULL;
+
+    if ((pRingBuffer->pReaders != NULL) && (handle >= 0) &&
+        ((size_t) handle < pRingBuffer->maxNumReadHandles) &&
+        pRingBuffer->pReaders[handle].inUse) {
+        pReader = &(pRingBuffer->pReaders[handle]);
+    }
+
+    return pReader;
+}
+
+// The amount of data held on behalf of the slowest reader, which
+// is what limits the producer; the ring buffer must be locked if
+// it has read handles.
+static size_t slowestDataSize(const uRingBuffer_t *pRingBuffer,
+                              size_t writeIndex)
+{
+    size_t length = 0;
+    size_t x;
+
+    if (pRingBuffer->pReaders != NULL) {
+        for (size_t y = 0; y < pRingBuffer->maxNumReadHandles; y++) {
+            if (pRingBuffer->pReaders[y].inUse) {
+                x = dataSize(pRingBuffer, pRingBuffer->pReaders[y].readIndex,
+                             writeIndex);
+                if (x > length) {
+                    length = x;
+                }
+            }
+        }
+    } else {
+        length = dataSize(pRingBuffer, U_RING_BUFFER_INDEX_LOAD(pRingBuffer->readIndex),
+                          writeIndex);
+    }
+
+    return length;
+}
+
+// Make room for length bytes by dropping data from the readers that
+// are behind; the ring buffer must be locked.
+static void dropForLaggingReaders(uRingBuffer_t *pRingBuffer,
+                                  size_t writeIndex, size_t length)
+{
+    struct uRingBufferReader_t *pReader;
+    size_t x;
+
+    for (size_t y = 0; y < pRingBuffer->maxNumReadHandles; y++) {
+        pReader = &(pRingBuffer->pReaders[y]);
+        if (pReader->inUse) {
+            x = dataSize(pRingBuffer, pReader->readIndex, writeIndex) + length;
+            if (x > pRingBuffer->size) {
+                x -= pRingBuffer->size;
+                pReader->readIndex = indexAdvance(pRingBuffer, pReader->readIndex, x);
+                pReader->dataLost += x;
+            }
+        }
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -68,10 +287,57 @@ void uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_t s
     uPortMutexCreate(&(pRingBuffer->mutex));
 }
 
+void uRingBufferCreateLockFree(uRingBuffer_t *pRingBuffer,
+                               char *pLinearBuffer, size_t size)
+{
+#ifdef U_RING_BUFFER_LOCK_FREE_SUPPORTED
+    memset(pRingBuffer, 0x00, sizeof (uRingBuffer_t));
+    pRingBuffer->pBuffer = pLinearBuffer;
+    pRingBuffer->size = size;
+#else
+    uRingBufferCreate(pRingBuffer, pLinearBuffer, size);
+#endif
+}
+
+int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer,
+                                        char *pLinearBuffer, size_t size,
+                                        size_t maxNumReadHandles)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pRingBuffer != NULL) && (maxNumReadHandles > 0)) {
+        memset(pRingBuffer, 0x00, sizeof (uRingBuffer_t));
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pRingBuffer->pReaders = (struct uRingBufferReader_t *) malloc(maxNumReadHandles *
+                                                                      sizeof(*(pRingBuffer->pReaders)));
+        if (pRingBuffer->pReaders != NULL) {
+            memset(pRingBuffer->pReaders, 0,
+                   maxNumReadHandles * sizeof(*(pRingBuffer->pReaders)));
+            errorCode = uPortMutexCreate(&(pRingBuffer->mutex));
+            if (errorCode == 0) {
+                pRingBuffer->pBuffer = pLinearBuffer;
+                pRingBuffer->size = size;
+                pRingBuffer->maxNumReadHandles = maxNumReadHandles;
+            } else {
+                free(pRingBuffer->pReaders);
+                pRingBuffer->pReaders = NULL;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
 void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 {
-    if ((pRingBuffer != NULL) && (pRingBuffer->mutex != NULL)) {
-        uPortMutexDelete(pRingBuffer->mutex);
+    if (pRingBuffer != NULL) {
+        if (pRingBuffer->mutex != NULL) {
+            uPortMutexDelete(pRingBuffer->mutex);
+            // Only a ring buffer with a mutex can have read handles
+            free(pRingBuffer->pReaders);
+            pRingBuffer->pReaders = NULL;
+            pRingBuffer->maxNumReadHandles = 0;
+        }
         pRingBuffer->pBuffer = NULL;
         pRingBuffer->mutex = NULL;
     }
@@ -80,23 +346,25 @@ void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length)
 {
     bool dataFitsInBuffer = true;
+    size_t writeIndex;
 
     if (pRingBuffer->pBuffer != NULL) {
-        U_PORT_MUTEX_LOCK(pRingBuffer->mutex);
-        if (pRingBuffer->dataSize + length > pRingBuffer->size) {
+        lock(pRingBuffer);
+        writeIndex = pRingBuffer->writeIndex;
+        if (slowestDataSize(pRingBuffer, writeIndex) + length > pRingBuffer->size) {
             dataFitsInBuffer = false;
+            if (pRingBuffer->dropIfFull && (length <= pRingBuffer->size)) {
+                dropForLaggingReaders(pRingBuffer, writeIndex, length);
+                dataFitsInBuffer = true;
+            }
         }
 
         if (dataFitsInBuffer) {
-            pRingBuffer->dataSize += length;
-            while (length-- > 0) {
-                pRingBuffer->pBuffer[pRingBuffer->dataIndex++] = *pData++;
-                if (pRingBuffer->dataIndex == pRingBuffer->size) {
-                    pRingBuffer->dataIndex = 0;
-                }
-            }
+            copyIn(pRingBuffer, writeIndex, pData, length);
+            U_RING_BUFFER_INDEX_STORE(pRingBuffer->writeIndex,
+                                      indexAdvance(pRingBuffer, writeIndex, length));
         }
-        U_PORT_MUTEX_UNLOCK(pRingBuffer->mutex);
+        unlock(pRingBuffer);
     }
 
     return dataFitsInBuffer;
@@ -104,49 +372,251 @@ bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length
 
 size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length)
 {
-    size_t readIndex;
     size_t bytesRead = 0;
 
-    if (pRingBuffer->pBuffer != NULL) {
-        U_PORT_MUTEX_LOCK(pRingBuffer->mutex);
-        if (pRingBuffer->dataSize < length) {
-            length = pRingBuffer->dataSize;
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders == NULL)) {
+        lock(pRingBuffer);
+        bytesRead = consume(pRingBuffer, &(pRingBuffer->readIndex), pData, length);
+        unlock(pRingBuffer);
+    }
+
+    return bytesRead;
+}
+
+size_t uRingBufferPeek(const uRingBuffer_t *pRingBuffer, char *pData, size_t length)
+{
+    size_t bytesRead = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders == NULL)) {
+        lock(pRingBuffer);
+        bytesRead = peek(pRingBuffer, pRingBuffer->readIndex, pData, length);
+        unlock(pRingBuffer);
+    }
+
+    return bytesRead;
+}
+
+size_t uRingBufferSkip(uRingBuffer_t *pRingBuffer, size_t length)
+{
+    size_t bytesSkipped = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders == NULL)) {
+        lock(pRingBuffer);
+        bytesSkipped = consume(pRingBuffer, &(pRingBuffer->readIndex), NULL, length);
+        unlock(pRingBuffer);
+    }
+
+    return bytesSkipped;
+}
+
+size_t uRingBufferReadRegionGet(const uRingBuffer_t *pRingBuffer, char **ppData)
+{
+    size_t length = 0;
+
+    *ppData = NULL;
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders == NULL)) {
+        lock(pRingBuffer);
+        length = regionGet(pRingBuffer, pRingBuffer->readIndex, ppData);
+        unlock(pRingBuffer);
+    }
+
+    return length;
+}
+
+size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
+{
+    size_t length;
+
+    if (pRingBuffer->pReaders != NULL) {
+        lock(pRingBuffer);
+        length = slowestDataSize(pRingBuffer, pRingBuffer->writeIndex);
+        unlock(pRingBuffer);
+    } else {
+        length = dataSize(pRingBuffer,
+                          U_RING_BUFFER_INDEX_LOAD(pRingBuffer->readIndex),
+                          U_RING_BUFFER_INDEX_LOAD(pRingBuffer->writeIndex));
+    }
+
+    return length;
+}
+
+size_t uRingBufferAvailableSize(const uRingBuffer_t *pRingBuffer)
+{
+    return (pRingBuffer->size - uRingBufferDataSize(pRingBuffer));
+}
+
+int32_t uRingBufferTakeReadHandle(uRingBuffer_t *pRingBuffer)
+{
+    int32_t handleOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    struct uRingBufferReader_t *pReader;
+
+    if (pRingBuffer->pReaders != NULL) {
+        handleOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        lock(pRingBuffer);
+        for (size_t x = 0; (x < pRingBuffer->maxNumReadHandles) &&
+             (handleOrErrorCode < 0); x++) {
+            pReader = &(pRingBuffer->pReaders[x]);
+            if (!pReader->inUse) {
+                pReader->readIndex = pRingBuffer->writeIndex;
+                pReader->dataLost = 0;
+                pReader->inUse = true;
+                handleOrErrorCode = (int32_t) x;
+            }
+        }
+        unlock(pRingBuffer);
+    }
+
+    return handleOrErrorCode;
+}
+
+void uRingBufferGiveReadHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
+{
+    struct uRingBufferReader_t *pReader;
+
+    if (pRingBuffer->pReaders != NULL) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            pReader->inUse = false;
         }
+        unlock(pRingBuffer);
+    }
+}
+
+void uRingBufferSetDropIfFull(uRingBuffer_t *pRingBuffer, bool dropIfFull)
+{
+    if (pRingBuffer->pReaders != NULL) {
+        lock(pRingBuffer);
+        pRingBuffer->dropIfFull = dropIfFull;
+        unlock(pRingBuffer);
+    }
+}
+
+size_t uRingBufferHandleRead(uRingBuffer_t *pRingBuffer, int32_t handle,
+                             char *pData, size_t length)
+{
+    size_t bytesRead = 0;
+    struct uRingBufferReader_t *pReader;
 
-        if (pRingBuffer->dataIndex >= pRingBuffer->dataSize) {
-            readIndex = pRingBuffer->dataIndex - pRingBuffer->dataSize;
-        } else {
-            readIndex = pRingBuffer->dataIndex + pRingBuffer->size - pRingBuffer->dataSize;
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders != NULL)) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            bytesRead = consume(pRingBuffer, &(pReader->readIndex), pData, length);
         }
+        unlock(pRingBuffer);
+    }
 
-        pRingBuffer->dataSize -= length;
-        while (bytesRead < length) {
-            *pData++ = pRingBuffer->pBuffer[readIndex++];
-            bytesRead++;
-            if (readIndex == pRingBuffer->size) {
-                readIndex = 0;
-            }
+    return bytesRead;
+}
+
+size_t uRingBufferHandlePeek(const uRingBuffer_t *pRingBuffer, int32_t handle,
+                             char *pData, size_t length)
+{
+    size_t bytesRead = 0;
+    struct uRingBufferReader_t *pReader;
+
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders != NULL)) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            bytesRead = peek(pRingBuffer, pReader->readIndex, pData, length);
         }
-        U_PORT_MUTEX_UNLOCK(pRingBuffer->mutex);
+        unlock(pRingBuffer);
     }
 
     return bytesRead;
 }
 
-size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
+size_t uRingBufferHandleSkip(uRingBuffer_t *pRingBuffer, int32_t handle,
+                             size_t length)
+{
+    size_t bytesSkipped = 0;
+    struct uRingBufferReader_t *pReader;
+
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders != NULL)) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            bytesSkipped = consume(pRingBuffer, &(pReader->readIndex), NULL, length);
+        }
+        unlock(pRingBuffer);
+    }
+
+    return bytesSkipped;
+}
+
+size_t uRingBufferHandleReadRegionGet(const uRingBuffer_t *pRingBuffer,
+                                      int32_t handle, char **ppData)
 {
-    return (pRingBuffer->dataSize);
+    size_t length = 0;
+    struct uRingBufferReader_t *pReader;
+
+    *ppData = NULL;
+    if ((pRingBuffer->pBuffer != NULL) && (pRingBuffer->pReaders != NULL)) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            length = regionGet(pRingBuffer, pReader->readIndex, ppData);
+        }
+        unlock(pRingBuffer);
+    }
+
+    return length;
 }
 
-size_t uRingBufferAvailableSize(const uRingBuffer_t *pRingBuffer)
+size_t uRingBufferHandleDataSize(const uRingBuffer_t *pRingBuffer, int32_t handle)
+{
+    size_t length = 0;
+    struct uRingBufferReader_t *pReader;
+
+    if (pRingBuffer->pReaders != NULL) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            length = dataSize(pRingBuffer, pReader->readIndex, pRingBuffer->writeIndex);
+        }
+        unlock(pRingBuffer);
+    }
+
+    return length;
+}
+
+size_t uRingBufferHandleDataLost(uRingBuffer_t *pRingBuffer, int32_t handle)
 {
-    return (pRingBuffer->size - pRingBuffer->dataSize);
+    size_t length = 0;
+    struct uRingBufferReader_t *pReader;
+
+    if (pRingBuffer->pReaders != NULL) {
+        lock(pRingBuffer);
+        pReader = pGetReader(pRingBuffer, handle);
+        if (pReader != NULL) {
+            length = pReader->dataLost;
+            pReader->dataLost = 0;
+        }
+        unlock(pRingBuffer);
+    }
+
+    return length;
 }
 
 void uRingBufferReset(uRingBuffer_t *pRingBuffer)
 {
-    pRingBuffer->dataIndex = 0;
-    pRingBuffer->dataSize = 0;
+    size_t writeIndex;
+
+    lock(pRingBuffer);
+    writeIndex = U_RING_BUFFER_INDEX_LOAD(pRingBuffer->writeIndex);
+    U_RING_BUFFER_INDEX_STORE(pRingBuffer->readIndex, writeIndex);
+    if (pRingBuffer->pReaders != NULL) {
+        // Every read handle in use must now start at the write
+        // index, else it would read the data thrown away
+        for (size_t x = 0; x < pRingBuffer->maxNumReadHandles; x++) {
+            if (pRingBuffer->pReaders[x].inUse) {
+                pRingBuffer->pReaders[x].readIndex = writeIndex;
+            }
+        }
+    }
+    unlock(pRingBuffer);
 }
 
 // End of file
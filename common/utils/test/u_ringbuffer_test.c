@@ -0,0 +1,559 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the ring buffer API: these should pass on all
+ * platforms.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp()/memset()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+
+#include "u_ringbuffer.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The size of linear buffer to use under the ring buffer; deliberately
+ * not a power of two.
+ */
+#define U_RINGBUFFER_TEST_BUFFER_SIZE 37
+
+/** The number of bytes to pass through the ring buffer in the
+ * lock-free test.
+ */
+#define U_RINGBUFFER_TEST_LOCK_FREE_BYTES 100000
+
+/** The size of the linear buffer under the ring buffer in the
+ * benchmarks.
+ */
+#define U_RINGBUFFER_TEST_BENCHMARK_BUFFER_SIZE 1024
+
+/** The number of bytes added and then read in each go around
+ * a benchmark; deliberately not a factor of
+ * U_RINGBUFFER_TEST_BENCHMARK_BUFFER_SIZE so that the wrap moves.
+ */
+#define U_RINGBUFFER_TEST_BENCHMARK_BLOCK_SIZE 300
+
+/** The number of goes around in each sample of a benchmark.
+ */
+#define U_RINGBUFFER_TEST_BENCHMARK_BLOCKS 100
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The linear buffer under the ring buffer.
+ */
+static char gLinearBuffer[U_RINGBUFFER_TEST_BUFFER_SIZE];
+
+/** The ring buffer.
+ */
+static uRingBuffer_t gRingBuffer;
+
+/** Set to true by producerTask() when it has finished.
+ */
+static volatile bool gProducerDone = false;
+
+#ifdef U_RUNNER_BENCHMARK
+/** The linear buffer under the ring buffer in the benchmarks.
+ */
+static char gBenchmarkLinearBuffer[U_RINGBUFFER_TEST_BENCHMARK_BUFFER_SIZE];
+
+/** The block of data that the benchmarks pass through the ring buffer.
+ */
+static char gBenchmarkBlock[U_RINGBUFFER_TEST_BENCHMARK_BLOCK_SIZE];
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Exercise a ring buffer from a single task, checking that the
+// data comes out as it went in, however it is read.
+static void singleTaskTest(uRingBuffer_t *pRingBuffer)
+{
+    char data[U_RINGBUFFER_TEST_BUFFER_SIZE + 1];
+    char buffer[U_RINGBUFFER_TEST_BUFFER_SIZE + 1];
+    char *pRegion;
+    char in = 0;
+    char out = 0;
+    size_t length;
+    size_t x;
+    size_t y;
+
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(pRingBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(pRingBuffer) == sizeof(gLinearBuffer));
+    U_PORT_TEST_ASSERT(uRingBufferRead(pRingBuffer, buffer, sizeof(buffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferReadRegionGet(pRingBuffer, &pRegion) == 0);
+
+    // Too much must not fit
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(pRingBuffer, data, sizeof(gLinearBuffer) + 1));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(pRingBuffer) == 0);
+
+    // Move through the buffer in steps of every length, so that
+    // every position of wrap is covered
+    for (length = 1; length <= sizeof(gLinearBuffer); length++) {
+        for (x = 0; x < length; x++) {
+            data[x] = in++;
+        }
+        U_PORT_TEST_ASSERT(uRingBufferAdd(pRingBuffer, data, length));
+        U_PORT_TEST_ASSERT(uRingBufferDataSize(pRingBuffer) == length);
+        U_PORT_TEST_ASSERT(uRingBufferAvailableSize(pRingBuffer) == sizeof(gLinearBuffer) - length);
+        if (length == sizeof(gLinearBuffer)) {
+            U_PORT_TEST_ASSERT(!uRingBufferAdd(pRingBuffer, data, 1));
+        }
+
+        // Peek must not remove anything
+        U_PORT_TEST_ASSERT(uRingBufferPeek(pRingBuffer, buffer, sizeof(buffer)) == length);
+        U_PORT_TEST_ASSERT(memcmp(buffer, data, length) == 0);
+        U_PORT_TEST_ASSERT(uRingBufferDataSize(pRingBuffer) == length);
+
+        switch (length % 3) {
+            case 0:
+                // Read it all
+                U_PORT_TEST_ASSERT(uRingBufferRead(pRingBuffer, buffer, sizeof(buffer)) == length);
+                for (x = 0; x < length; x++) {
+                    U_PORT_TEST_ASSERT(buffer[x] == out);
+                    out++;
+                }
+                break;
+            case 1:
+                // Read it through the contiguous regions
+                x = 0;
+                while ((y = uRingBufferReadRegionGet(pRingBuffer, &pRegion)) > 0) {
+                    U_PORT_TEST_ASSERT(pRegion != NULL);
+                    U_PORT_TEST_ASSERT(x + y <= length);
+                    for (size_t z = 0; z < y; z++) {
+                        U_PORT_TEST_ASSERT(pRegion[z] == out);
+                        out++;
+                    }
+                    U_PORT_TEST_ASSERT(uRingBufferSkip(pRingBuffer, y) == y);
+                    x += y;
+                }
+                U_PORT_TEST_ASSERT(x == length);
+                break;
+            default:
+                // Skip it
+                U_PORT_TEST_ASSERT(uRingBufferSkip(pRingBuffer, sizeof(buffer)) == length);
+                out = (char) (out + length);
+                break;
+        }
+        U_PORT_TEST_ASSERT(uRingBufferDataSize(pRingBuffer) == 0);
+    }
+
+    // Reset must throw everything away
+    U_PORT_TEST_ASSERT(uRingBufferAdd(pRingBuffer, data, 10));
+    uRingBufferReset(pRingBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(pRingBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(pRingBuffer) == sizeof(gLinearBuffer));
+}
+
+// Task to write a known sequence into gRingBuffer in lumps of
+// varying size.
+static void producerTask(void *pParameter)
+{
+    char data[U_RINGBUFFER_TEST_BUFFER_SIZE];
+    uint8_t next = 0;
+    size_t sent = 0;
+    size_t length = 1;
+
+    (void) pParameter;
+
+    while (sent < U_RINGBUFFER_TEST_LOCK_FREE_BYTES) {
+        if (length > U_RINGBUFFER_TEST_LOCK_FREE_BYTES - sent) {
+            length = U_RINGBUFFER_TEST_LOCK_FREE_BYTES - sent;
+        }
+        for (size_t x = 0; x < length; x++) {
+            data[x] = (char) (uint8_t) (next + x);
+        }
+        if (uRingBufferAdd(&gRingBuffer, data, length)) {
+            next = (uint8_t) (next + length);
+            sent += length;
+            length++;
+            if (length > sizeof(data)) {
+                length = 1;
+            }
+        } else {
+            uPortTaskBlock(1);
+        }
+    }
+
+    gProducerDone = true;
+
+    uPortTaskDelete(NULL);
+}
+
+#ifdef U_RUNNER_BENCHMARK
+
+// Set-up for the normal ring buffer benchmark.
+static int32_t benchmarkSetUp(void **ppContext)
+{
+    int32_t errorCode = uPortInit();
+
+    if (errorCode == 0) {
+        uRingBufferCreate(&gRingBuffer, gBenchmarkLinearBuffer,
+                          sizeof(gBenchmarkLinearBuffer));
+        *ppContext = &gRingBuffer;
+    }
+
+    return errorCode;
+}
+
+// Set-up for the lock-free ring buffer benchmark.
+static int32_t benchmarkSetUpLockFree(void **ppContext)
+{
+    int32_t errorCode = uPortInit();
+
+    if (errorCode == 0) {
+        uRingBufferCreateLockFree(&gRingBuffer, gBenchmarkLinearBuffer,
+                                  sizeof(gBenchmarkLinearBuffer));
+        *ppContext = &gRingBuffer;
+    }
+
+    return errorCode;
+}
+
+// Tear-down for the ring buffer benchmarks.
+static void benchmarkTearDown(void *pContext)
+{
+    uRingBufferDelete((uRingBuffer_t *) pContext);
+    uPortDeinit();
+}
+
+// Add blocks to and read them back from the ring buffer at pContext.
+static int32_t benchmarkAddRead(void *pContext)
+{
+    int32_t errorCode = 0;
+    uRingBuffer_t *pRingBuffer = (uRingBuffer_t *) pContext;
+    char buffer[U_RINGBUFFER_TEST_BENCHMARK_BLOCK_SIZE];
+
+    for (size_t x = 0; (x < U_RINGBUFFER_TEST_BENCHMARK_BLOCKS) &&
+         (errorCode >= 0); x++) {
+        if (uRingBufferAdd(pRingBuffer, gBenchmarkBlock, sizeof(gBenchmarkBlock)) &&
+            (uRingBufferRead(pRingBuffer, buffer, sizeof(buffer)) == sizeof(buffer))) {
+            errorCode += (int32_t) sizeof(buffer);
+        } else {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        }
+    }
+
+    return errorCode;
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Exercise the ring buffer, both the normal and lock-free kinds,
+ * from a single task.
+ */
+U_PORT_TEST_FUNCTION("[ringBuffer]", "ringBufferBasic")
+{
+    int32_t heapUsed;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    heapUsed = uPortGetHeapFree();
+
+    uPortLog("U_RINGBUFFER_TEST: testing a normal ring buffer...\n");
+    uRingBufferCreate(&gRingBuffer, gLinearBuffer, sizeof(gLinearBuffer));
+    singleTaskTest(&gRingBuffer);
+    uRingBufferDelete(&gRingBuffer);
+
+    uPortLog("U_RINGBUFFER_TEST: testing a lock-free ring buffer...\n");
+    uRingBufferCreateLockFree(&gRingBuffer, gLinearBuffer, sizeof(gLinearBuffer));
+    singleTaskTest(&gRingBuffer);
+    uRingBufferDelete(&gRingBuffer);
+
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_RINGBUFFER_TEST: we have leaked %d byte(s).\n", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Pass data through a lock-free ring buffer from a producer task
+ * to a consumer task, checking that nothing is lost or corrupted.
+ */
+U_PORT_TEST_FUNCTION("[ringBuffer]", "ringBufferLockFree")
+{
+    uPortTaskHandle_t taskHandle = NULL;
+    char buffer[U_RINGBUFFER_TEST_BUFFER_SIZE];
+    char *pRegion;
+    uint8_t next = 0;
+    size_t received = 0;
+    size_t length;
+    bool useRegion = false;
+    int64_t startTimeMs;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    uRingBufferCreateLockFree(&gRingBuffer, gLinearBuffer, sizeof(gLinearBuffer));
+    gProducerDone = false;
+
+    uPortLog("U_RINGBUFFER_TEST: passing %d byte(s) between two tasks...\n",
+             U_RINGBUFFER_TEST_LOCK_FREE_BYTES);
+    U_PORT_TEST_ASSERT(uPortTaskCreate(producerTask, "ringBufferProducer",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                       NULL, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((received < U_RINGBUFFER_TEST_LOCK_FREE_BYTES) &&
+           (uPortGetTickTimeMs() - startTimeMs < 30000)) {
+        // Alternate between copying the data out and looking
+        // at it in place
+        if (useRegion) {
+            length = uRingBufferReadRegionGet(&gRingBuffer, &pRegion);
+            for (size_t x = 0; x < length; x++) {
+                U_PORT_TEST_ASSERT((uint8_t) pRegion[x] == next);
+                next++;
+            }
+            U_PORT_TEST_ASSERT(uRingBufferSkip(&gRingBuffer, length) == length);
+        } else {
+            length = uRingBufferRead(&gRingBuffer, buffer, sizeof(buffer));
+            for (size_t x = 0; x < length; x++) {
+                U_PORT_TEST_ASSERT((uint8_t) buffer[x] == next);
+                next++;
+            }
+        }
+        received += length;
+        useRegion = !useRegion;
+        if (length == 0) {
+            uPortTaskBlock(1);
+        }
+    }
+    uPortLog("U_RINGBUFFER_TEST: %d byte(s) received.\n", received);
+    U_PORT_TEST_ASSERT(received == U_RINGBUFFER_TEST_LOCK_FREE_BYTES);
+
+    // Let the producer task exit
+    startTimeMs = uPortGetTickTimeMs();
+    while (!gProducerDone && (uPortGetTickTimeMs() - startTimeMs < 1000)) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gProducerDone);
+    // Give it time to delete itself
+    uPortTaskBlock(U_CFG_OS_YIELD_MS + 10);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&gRingBuffer) == 0);
+
+    uRingBufferDelete(&gRingBuffer);
+    uPortDeinit();
+}
+
+/** Read the same data through several read handles, checking that
+ * the producer is held back by the slowest reader or, with
+ * uRingBufferSetDropIfFull(), that the slowest reader loses data.
+ */
+U_PORT_TEST_FUNCTION("[ringBuffer]", "ringBufferReadHandles")
+{
+    char data[U_RINGBUFFER_TEST_BUFFER_SIZE];
+    char buffer[U_RINGBUFFER_TEST_BUFFER_SIZE];
+    char *pRegion;
+    int32_t handle[3];
+    int32_t heapUsed;
+    size_t x;
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    heapUsed = uPortGetHeapFree();
+
+    for (x = 0; x < sizeof(data); x++) {
+        data[x] = (char) x;
+    }
+
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&gRingBuffer, gLinearBuffer,
+                                                       sizeof(gLinearBuffer), 2) == 0);
+    // With no readers, anything goes
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data, sizeof(data)));
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data, sizeof(data)));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&gRingBuffer) == 0);
+
+    handle[0] = uRingBufferTakeReadHandle(&gRingBuffer);
+    U_PORT_TEST_ASSERT(handle[0] >= 0);
+    handle[1] = uRingBufferTakeReadHandle(&gRingBuffer);
+    U_PORT_TEST_ASSERT(handle[1] >= 0);
+    U_PORT_TEST_ASSERT(handle[1] != handle[0]);
+    U_PORT_TEST_ASSERT(uRingBufferTakeReadHandle(&gRingBuffer) < 0);
+    // A new reader only sees new data
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataSize(&gRingBuffer, handle[0]) == 0);
+
+    // The normal read functions do nothing
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data, 10));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&gRingBuffer, buffer, sizeof(buffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferReadRegionGet(&gRingBuffer, &pRegion) == 0);
+
+    // Both readers see the same data; the first reads it, the
+    // second only peeks at it so holds up the producer
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[0], buffer,
+                                             sizeof(buffer)) == 10);
+    U_PORT_TEST_ASSERT(memcmp(buffer, data, 10) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandlePeek(&gRingBuffer, handle[1], buffer,
+                                             sizeof(buffer)) == 10);
+    U_PORT_TEST_ASSERT(memcmp(buffer, data, 10) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataSize(&gRingBuffer, handle[0]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataSize(&gRingBuffer, handle[1]) == 10);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&gRingBuffer) == 10);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&gRingBuffer) == sizeof(gLinearBuffer) - 10);
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&gRingBuffer, data, sizeof(gLinearBuffer) - 9));
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data, sizeof(gLinearBuffer) - 10));
+
+    // The first reader reads through the wrap in place
+    x = 0;
+    while ((x < sizeof(gLinearBuffer) - 10) &&
+           (uRingBufferHandleReadRegionGet(&gRingBuffer, handle[0], &pRegion) > 0)) {
+        U_PORT_TEST_ASSERT(*pRegion == data[x]);
+        U_PORT_TEST_ASSERT(uRingBufferHandleSkip(&gRingBuffer, handle[0], 1) == 1);
+        x++;
+    }
+    U_PORT_TEST_ASSERT(x == sizeof(gLinearBuffer) - 10);
+
+    // Now drop data for the lagging second reader
+    uRingBufferSetDropIfFull(&gRingBuffer, true);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data + 1, 5));
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataLost(&gRingBuffer, handle[0]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataLost(&gRingBuffer, handle[1]) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataLost(&gRingBuffer, handle[1]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[1], buffer,
+                                             sizeof(buffer)) == sizeof(gLinearBuffer));
+    U_PORT_TEST_ASSERT(memcmp(buffer, data + 5, 5) == 0);
+    U_PORT_TEST_ASSERT(memcmp(buffer + sizeof(gLinearBuffer) - 5, data + 1, 5) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[0], buffer,
+                                             sizeof(buffer)) == 5);
+    U_PORT_TEST_ASSERT(memcmp(buffer, data + 1, 5) == 0);
+
+    // Reset must throw away the data for every reader
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data, 10));
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataSize(&gRingBuffer, handle[0]) == 10);
+    uRingBufferReset(&gRingBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataSize(&gRingBuffer, handle[0]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleDataSize(&gRingBuffer, handle[1]) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[0], buffer,
+                                             sizeof(buffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&gRingBuffer) == sizeof(gLinearBuffer));
+    // ...and after it only new data is read
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, data + 3, 4));
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[0], buffer,
+                                             sizeof(buffer)) == 4);
+    U_PORT_TEST_ASSERT(memcmp(buffer, data + 3, 4) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[1], buffer,
+                                             sizeof(buffer)) == 4);
+    U_PORT_TEST_ASSERT(memcmp(buffer, data + 3, 4) == 0);
+
+    // Giving back a handle frees a slot
+    uRingBufferGiveReadHandle(&gRingBuffer, handle[1]);
+    U_PORT_TEST_ASSERT(uRingBufferHandleRead(&gRingBuffer, handle[1], buffer,
+                                             sizeof(buffer)) == 0);
+    handle[2] = uRingBufferTakeReadHandle(&gRingBuffer);
+    U_PORT_TEST_ASSERT(handle[2] >= 0);
+    uRingBufferGiveReadHandle(&gRingBuffer, handle[2]);
+    uRingBufferGiveReadHandle(&gRingBuffer, handle[0]);
+
+    uRingBufferDelete(&gRingBuffer);
+    uPortDeinit();
+
+    // Check for memory leaks
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_RINGBUFFER_TEST: we have leaked %d byte(s).\n", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[ringBuffer]", "ringBufferCleanUp")
+{
+    int32_t x;
+
+    uRingBufferDelete(&gRingBuffer);
+
+    x = uPortTaskStackMinFree(NULL);
+    if (x != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        uPortLog("U_RINGBUFFER_TEST: main task stack had a minimum of %d"
+                 " byte(s) free at the end of these tests.\n", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_OS_MAIN_TASK_MIN_FREE_STACK_BYTES);
+    }
+
+    uPortDeinit();
+
+    x = uPortGetHeapMinFree();
+    if (x >= 0) {
+        uPortLog("U_RINGBUFFER_TEST: heap had a minimum of %d"
+                 " byte(s) free at the end of these tests.\n", x);
+        U_PORT_TEST_ASSERT(x >= U_CFG_TEST_HEAP_MIN_FREE_BYTES);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BENCHMARKS
+ * -------------------------------------------------------------- */
+
+#ifdef U_RUNNER_BENCHMARK
+
+/** Time adding blocks to and reading them from a normal ring buffer.
+ */
+U_RUNNER_BENCHMARK("[ringBuffer]", "ringBufferBenchmarkAddRead", 50,
+                   benchmarkSetUp, benchmarkTearDown)
+{
+    return benchmarkAddRead(pContext);
+}
+
+/** Time adding blocks to and reading them from a lock-free ring buffer.
+ */
+U_RUNNER_BENCHMARK("[ringBuffer]", "ringBufferBenchmarkAddReadLockFree", 50,
+                   benchmarkSetUpLockFree, benchmarkTearDown)
+{
+    return benchmarkAddRead(pContext);
+}
+
+#endif
+
+// End of file
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Benchmarks for the base 64 and hex conversion utilities:
+ * these should run on all platforms which use the runner.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed, which apply equally to the
+ * U_RUNNER_BENCHMARK() macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcmp()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+
+#include "u_base64.h"
+#include "u_hex_bin_convert.h"
+
+#ifdef U_RUNNER_BENCHMARK
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The amount of binary data to convert in each sample of a
+ * benchmark; a multiple of three so that there is no base 64
+ * padding.
+ */
+#define U_UTILS_BENCHMARK_BINARY_SIZE 3072
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The binary data to convert.
+ */
+static char gBinary[U_UTILS_BENCHMARK_BINARY_SIZE];
+
+/** The binary data after conversion there and back again.
+ */
+static char gBinaryOut[U_UTILS_BENCHMARK_BINARY_SIZE];
+
+/** Storage for the converted data, big enough for hex.
+ */
+static char gConverted[U_UTILS_BENCHMARK_BINARY_SIZE * 2];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Set-up for the benchmarks: fill the binary data.
+static int32_t benchmarkSetUp(void **ppContext)
+{
+    (void) ppContext;
+
+    for (size_t x = 0; x < sizeof(gBinary); x++) {
+        gBinary[x] = (char) (x * 7);
+    }
+
+    return uPortInit();
+}
+
+// Tear-down for the benchmarks.
+static void benchmarkTearDown(void *pContext)
+{
+    (void) pContext;
+
+    uPortDeinit();
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: BENCHMARKS
+ * -------------------------------------------------------------- */
+
+/** Time base 64 encoding a block of binary data and decoding it
+ * again; the bytes reported are the binary bytes.
+ */
+U_RUNNER_BENCHMARK("[utils]", "utilsBenchmarkBase64", 50,
+                   benchmarkSetUp, benchmarkTearDown)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    int32_t length;
+
+    (void) pContext;
+
+    length = uBase64Encode(gBinary, sizeof(gBinary),
+                           gConverted, sizeof(gConverted));
+    if ((uBase64Decode(gConverted, length, gBinaryOut,
+                       sizeof(gBinaryOut)) == sizeof(gBinaryOut)) &&
+        (memcmp(gBinary, gBinaryOut, sizeof(gBinary)) == 0)) {
+        errorCode = (int32_t) sizeof(gBinary);
+    }
+
+    return errorCode;
+}
+
+/** Time converting a block of binary data to hex and back again;
+ * the bytes reported are the binary bytes.
+ */
+U_RUNNER_BENCHMARK("[utils]", "utilsBenchmarkHex", 50,
+                   benchmarkSetUp, benchmarkTearDown)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+    size_t length;
+
+    (void) pContext;
+
+    length = uBinToHex(gBinary, sizeof(gBinary), gConverted);
+    if ((uHexToBin(gConverted, length, gBinaryOut) == sizeof(gBinaryOut)) &&
+        (memcmp(gBinary, gBinaryOut, sizeof(gBinary)) == 0)) {
+        errorCode = (int32_t) sizeof(gBinary);
+    }
+
+    return errorCode;
+}
+
+#endif // #ifdef U_RUNNER_BENCHMARK
+
+// End of file
@@ -76,6 +76,71 @@ int32_t uGnssCfgGetFixMode(int32_t gnssHandle);
  */
 int32_t uGnssCfgSetFixMode(int32_t gnssHandle, uGnssFixMode_t fixMode);
 
+/** Get the rate at which position is measured by the GNSS chip.
+ *
+ * @param gnssHandle           the handle of the GNSS instance.
+ * @param pMeasurementPeriodMs a place to put the period between
+ *                             measurements in milliseconds; may
+ *                             be NULL.
+ * @param pNavigationCount     a place to put the number of
+ *                             measurements per navigation solution;
+ *                             may be NULL.
+ * @return                     zero on success or negative error code.
+ */
+int32_t uGnssCfgGetRate(int32_t gnssHandle,
+                        int32_t *pMeasurementPeriodMs,
+                        int32_t *pNavigationCount);
+
+/** Set the rate at which position is measured by the GNSS chip;
+ * together with uGnssCfgSetMsgRate() this determines how often
+ * streamed navigation messages (see u_gnss_msg.h) are emitted.
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param measurementPeriodMs the period between measurements in
+ *                            milliseconds, e.g. 100 for 10 Hz;
+ *                            the minimum and maximum values
+ *                            depend upon the GNSS chip.
+ * @param navigationCount     the number of measurements per
+ *                            navigation solution, usually 1.
+ * @return                    zero on success or negative error code.
+ */
+int32_t uGnssCfgSetRate(int32_t gnssHandle,
+                        int32_t measurementPeriodMs,
+                        int32_t navigationCount);
+
+/** Get the rate at which the given ubx message is emitted by the
+ * GNSS chip on the port that this code is connected to.
+ *
+ * @param gnssHandle    the handle of the GNSS instance.
+ * @param messageClass  the ubx message class.
+ * @param messageId     the ubx message ID.
+ * @return              the rate, i.e. the message is emitted
+ *                      once every that many navigation solutions
+ *                      (zero meaning never), else negative error
+ *                      code.
+ */
+int32_t uGnssCfgGetMsgRate(int32_t gnssHandle,
+                           int32_t messageClass,
+                           int32_t messageId);
+
+/** Set the rate at which the given ubx message is emitted by the
+ * GNSS chip on the port that this code is connected to; use this
+ * to start, or stop, the messages that you receive with the
+ * streamed message API (see u_gnss_msg.h).
+ *
+ * @param gnssHandle    the handle of the GNSS instance.
+ * @param messageClass  the ubx message class.
+ * @param messageId     the ubx message ID.
+ * @param rate          the message will be emitted once every
+ *                      this many navigation solutions, e.g. 1 for
+ *                      every solution, 0 to stop it being emitted.
+ * @return              zero on success or negative error code.
+ */
+int32_t uGnssCfgSetMsgRate(int32_t gnssHandle,
+                           int32_t messageClass,
+                           int32_t messageId,
+                           int32_t rate);
+
 #ifdef __cplusplus
 }
 #endif
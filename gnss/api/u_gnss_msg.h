@@ -0,0 +1,184 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_MSG_H_
+#define _U_GNSS_MSG_H_
+
+/* No #includes allowed here */
+
+/** @file
+ * @brief This header file defines the GNSS APIs to receive the
+ * ubx messages that a GNSS chip emits periodically, e.g. UBX-NAV-PVT,
+ * UBX-NAV-SAT or UBX-RXM-xxx, as a stream, rather than polling
+ * for each one.  Set the rate at which the GNSS chip emits the
+ * messages you want with uGnssCfgSetMsgRate() (and, if required,
+ * the measurement rate of the GNSS chip with uGnssCfgSetRate())
+ * and then subscribe to them with uGnssMsgReceiveStart().
+ *
+ * While any subscription is active a reader, running in the
+ * event task of the UART, is the only consumer of data from the
+ * GNSS chip; it decodes each ubx message into a single reusable
+ * buffer and passes it to the matching subscribers.  The other
+ * GNSS APIs continue to work while the reader is running: their
+ * responses are picked out of the stream by the reader.
+ *
+ * Streamed messages are only supported on the UART transports,
+ * i.e. not where the GNSS chip is connected via an intermediate
+ * AT (e.g. cellular) module.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_MSG_TASK_STACK_SIZE_BYTES
+/** The stack size of the task in which streamed messages are
+ * decoded and the callbacks of subscribers are called.  If your
+ * callbacks do a lot you may need to increase this.
+ */
+# define U_GNSS_MSG_TASK_STACK_SIZE_BYTES (1024 * 3)
+#endif
+
+#ifndef U_GNSS_MSG_TASK_PRIORITY
+/** The priority of the task in which streamed messages are
+ * decoded and the callbacks of subscribers are called.
+ */
+# define U_GNSS_MSG_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
+#endif
+
+/** Use this as the message class or message ID passed to
+ * uGnssMsgReceiveStart() to receive all message classes or all
+ * message IDs.
+ */
+#define U_GNSS_MSG_ALL -1
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Set the largest ubx message body that will be delivered to
+ * the subscribers of this GNSS instance; a message with a longer
+ * body is dropped, since there is nowhere to put it.  The default
+ * is U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES (1024 bytes),
+ * which is too small for, e.g., UBX-RXM-RAWX or UBX-NAV-SAT when
+ * many satellites are visible: if you want those, set this to the
+ * largest body you expect (e.g. 16 + (32 * 64) for UBX-RXM-RAWX with
+ * 64 measurements).  The storage is allocated when the first
+ * subscription is made with uGnssMsgReceiveStart() and freed when
+ * the last is cancelled, hence a new value takes effect the next
+ * time there is a first subscription: call this function before
+ * uGnssMsgReceiveStart().
+ *
+ * @param gnssHandle         the handle of the GNSS instance.
+ * @param bodyLengthMaxBytes the largest message body to deliver;
+ *                           must be greater than zero and no more
+ *                           than 65535, the largest that the ubx
+ *                           protocol can carry.
+ * @return                   zero on success else negative error code.
+ */
+int32_t uGnssMsgSetBodyLengthMax(int32_t gnssHandle,
+                                 size_t bodyLengthMaxBytes);
+
+/** Get the largest ubx message body that will be delivered to
+ * the subscribers of this GNSS instance, as set by
+ * uGnssMsgSetBodyLengthMax().
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @return            the largest message body that will be
+ *                    delivered, else negative error code.
+ */
+int32_t uGnssMsgGetBodyLengthMax(int32_t gnssHandle);
+
+/** Subscribe to the ubx messages of the given class and ID
+ * emitted by the GNSS chip.  Note that this does not ask the GNSS
+ * chip to emit the messages, use uGnssCfgSetMsgRate() for that.
+ * Any number of subscriptions may be active at once and a given
+ * message will be passed to every subscriber that matches it.
+ *
+ * @param gnssHandle     the handle of the GNSS instance.
+ * @param messageClass   the ubx message class to receive, or
+ *                       U_GNSS_MSG_ALL for all classes.
+ * @param messageId      the ubx message ID to receive, or
+ *                       U_GNSS_MSG_ALL for all IDs.
+ * @param pCallback      the function to call when a matching
+ *                       message arrives; cannot be NULL.  The
+ *                       parameters are the GNSS handle, the
+ *                       message class, the message ID, a pointer
+ *                       to the message body, the length of the
+ *                       message body and pCallbackParam.  A message
+ *                       with a body longer than the value set with
+ *                       uGnssMsgSetBodyLengthMax(), by default
+ *                       U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES,
+ *                       is dropped without any callback being
+ *                       called.  The message body is
+ *                       only valid for the duration of the callback:
+ *                       copy out anything you want to keep.  The
+ *                       callback is called in the UART event task and
+ *                       so should return quickly; it must NOT call
+ *                       any of the GNSS APIs.
+ * @param pCallbackParam a parameter which will be passed to pCallback
+ *                       as its last parameter.
+ * @return               the handle of the subscription, which
+ *                       should be passed to uGnssMsgReceiveStop(),
+ *                       else negative error code.
+ */
+int32_t uGnssMsgReceiveStart(int32_t gnssHandle,
+                             int32_t messageClass,
+                             int32_t messageId,
+                             void (*pCallback) (int32_t gnssHandle,
+                                                int32_t messageClass,
+                                                int32_t messageId,
+                                                const char *pBody,
+                                                size_t bodyLengthBytes,
+                                                void *pCallbackParam),
+                             void *pCallbackParam);
+
+/** Cancel a subscription made with uGnssMsgReceiveStart(); once
+ * this function has returned the callback of the subscription will
+ * not be called again.  When the last subscription is cancelled the
+ * reader is stopped.  Note that this does not ask the GNSS chip to
+ * stop emitting the messages, use uGnssCfgSetMsgRate() with a rate
+ * of zero for that.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param handle      the handle of the subscription, as returned
+ *                    by uGnssMsgReceiveStart().
+ * @return            zero on success else negative error code.
+ */
+int32_t uGnssMsgReceiveStop(int32_t gnssHandle, int32_t handle);
+
+/** Cancel all subscriptions and stop the reader, freeing the
+ * memory it occupies.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssMsgReceiveStopAll(int32_t gnssHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_GNSS_MSG_H_
+
+// End of file
@@ -179,6 +179,56 @@ int32_t uGnssPosGetStart(int32_t gnssHandle,
  */
 void uGnssPosGetStop(int32_t gnssHandle);
 
+/** Start streamed position: the GNSS chip is configured to emit
+ * UBX-NAV-PVT with every navigation solution and pCallback is
+ * called each time one arrives, so that position is delivered at
+ * the native rate of the GNSS chip (e.g. 10 Hz or more) with no
+ * per-fix polling.  Uses the streamed message API (see u_gnss_msg.h)
+ * and hence is only supported on the UART transports.  While
+ * streamed position is active uGnssPosGet() and uGnssPosGetStart()
+ * will pick up the next streamed position rather than polling.
+ * Should you wish to change the callback or the rate you must call
+ * uGnssPosGetStreamedStop() first (otherwise U_ERROR_COMMON_NO_MEMORY
+ * will be returned).
+ *
+ * @param gnssHandle the handle of the GNSS instance to use.
+ * @param rateMs     the period between position measurements in
+ *                   milliseconds, e.g. 100 for 10 Hz; use zero or
+ *                   a negative value to leave the measurement rate
+ *                   of the GNSS chip as it is.  The minimum value
+ *                   depends upon the GNSS chip.
+ * @param pCallback  the callback that will be called for each
+ *                   UBX-NAV-PVT message, with parameters as described
+ *                   in uGnssPosGetStart(); errorCode will be
+ *                   U_ERROR_COMMON_TIMEOUT if there is not yet a
+ *                   position fix.  The callback is called in the
+ *                   UART event task (see U_GNSS_MSG_TASK_STACK_SIZE_BYTES)
+ *                   and so should return quickly; it must NOT call
+ *                   any of the GNSS APIs.
+ * @return           zero on success or negative error code on
+ *                   failure.
+ */
+int32_t uGnssPosGetStreamedStart(int32_t gnssHandle,
+                                 int32_t rateMs,
+                                 void (*pCallback) (int32_t gnssHandle,
+                                                    int32_t errorCode,
+                                                    int32_t latitudeX1e7,
+                                                    int32_t longitudeX1e7,
+                                                    int32_t altitudeMillimetres,
+                                                    int32_t radiusMillimetres,
+                                                    int32_t speedMillimetresPerSecond,
+                                                    int32_t svs,
+                                                    int64_t timeUtc));
+
+/** Stop streamed position: the GNSS chip is told to stop emitting
+ * UBX-NAV-PVT and, once this function has returned, the callback
+ * passed to uGnssPosGetStreamedStart() will not be called again.
+ * The measurement rate of the GNSS chip is left as it is.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ */
+void uGnssPosGetStreamedStop(int32_t gnssHandle);
+
 /** Get the binary RRLP information directly from the GNSS chip i.e.
  * as returned by the UBX-RXM-MEASX command of the UBX protocol.  This
  * is more efficient, both in terms of power and time, than asking
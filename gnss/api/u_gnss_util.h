@@ -59,6 +59,12 @@ extern "C" {
  * transparently to the GNSS chip in this case, you should add
  * two dummy bytes to the message.
  *
+ * Note: while streamed messages are being received (see
+ * u_gnss_msg.h) on a UART transport all received data is consumed
+ * by the streamed message reader and hence, in that case, this
+ * function will return U_ERROR_COMMON_NOT_SUPPORTED if pResponse
+ * is non-NULL.
+ *
  * @param gnssHandle             the handle of the GNSS instance.
  * @param pCommand               the command to send; may be NULL.
  * @param commandLengthBytes     the amount of data at pCommand; must
@@ -42,6 +42,8 @@
 #include "u_port_debug.h"
 #include "u_port_gpio.h"
 
+#include "u_ubx_protocol.h" // Required by u_gnss_private.h
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
@@ -139,6 +141,8 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
         if (pInstance == pCurrent) {
             // Stop any asynchronous position establishment task
             uGnssPrivateCleanUpPosTask(pInstance);
+            // Stop any streamed message reader
+            uGnssPrivateMsgReaderStop(pInstance);
             // Delete the transport mutex
             uPortMutexDelete(pInstance->transportMutex);
             // Unlink the instance from the list
@@ -149,6 +153,7 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
             }
             pCurrent = NULL;
             // Free the instance
+            free(pInstance->pUbxDecoder);
             free(pInstance);
         } else {
             pPrev = pCurrent;
@@ -247,8 +252,31 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                     pInstance->posTask = NULL;
                     pInstance->posMutex = NULL;
                     pInstance->posTaskFlags = 0;
+                    pInstance->pUbxDecoder = NULL;
+                    pInstance->pTemporaryBuffer = NULL;
+                    pInstance->pMsgReader = NULL;
+                    pInstance->msgBodyLengthMaxBytes = U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES;
+                    pInstance->posStreamedSubscription = -1;
+                    pInstance->pPosStreamedCallback = NULL;
                     pInstance->pNext = NULL;
+                    if ((transportType == U_GNSS_TRANSPORT_UBX_UART) ||
+                        (transportType == U_GNSS_TRANSPORT_NMEA_UART)) {
+                        // Allocate the buffer that received ubx messages
+                        // are decoded into once, rather than per message
+                        pInstance->pUbxDecoder = (uUbxProtocolDecoder_t *) malloc(sizeof(uUbxProtocolDecoder_t) +
+                                                                                  U_GNSS_UART_TEMPORARY_BUFFER_LENGTH_BYTES);
+                        if (pInstance->pUbxDecoder != NULL) {
+                            pInstance->pTemporaryBuffer = (char *) (pInstance->pUbxDecoder + 1);
+                            uUbxProtocolDecoderInit(pInstance->pUbxDecoder,
+                                                    pInstance->pTemporaryBuffer,
+                                                    U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES);
+                        } else {
+                            errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                        }
+                    }
+                }
 
+                if (errorCodeOrHandle == 0) {
                     // Now set up the pins
                     uPortLog("U_GNSS: initialising with ENABLE_POWER pin ");
                     if (pinGnssEnablePower >= 0) {
@@ -298,6 +326,7 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                     if (pInstance->transportMutex != NULL) {
                         uPortMutexDelete(pInstance->transportMutex);
                     }
+                    free(pInstance->pUbxDecoder);
                     free(pInstance);
                 }
             }
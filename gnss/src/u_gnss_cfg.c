@@ -182,4 +182,159 @@ int32_t uGnssCfgSetFixMode(int32_t gnssHandle, uGnssFixMode_t fixMode)
                                  1, 3 /* One byte at offset 3 */);
 }
 
+// Get the measurement rate of the GNSS chip.
+int32_t uGnssCfgGetRate(int32_t gnssHandle,
+                        int32_t *pMeasurementPeriodMs,
+                        int32_t *pNavigationCount)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // Enough room for the body of the UBX-CFG-RATE message
+    char message[6];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            // Poll with the message class and ID of the
+            // UBX-CFG-RATE message
+            if (uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                  0x06, 0x08,
+                                                  NULL, 0,
+                                                  message,
+                                                  sizeof(message)) == sizeof(message)) {
+                if (pMeasurementPeriodMs != NULL) {
+                    *pMeasurementPeriodMs = (int32_t) uUbxProtocolUint16Decode(message);
+                }
+                if (pNavigationCount != NULL) {
+                    *pNavigationCount = (int32_t) uUbxProtocolUint16Decode(message + 2);
+                }
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Set the measurement rate of the GNSS chip.
+int32_t uGnssCfgSetRate(int32_t gnssHandle,
+                        int32_t measurementPeriodMs,
+                        int32_t navigationCount)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // Enough room for the body of the UBX-CFG-RATE message
+    char message[6];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) &&
+            (measurementPeriodMs > 0) && (measurementPeriodMs <= 0xffff) &&
+            (navigationCount > 0) && (navigationCount <= 0xffff)) {
+            *((uint16_t *) message) = uUbxProtocolUint16Encode((uint16_t) measurementPeriodMs);
+            *((uint16_t *) (message + 2)) = uUbxProtocolUint16Encode((uint16_t) navigationCount);
+            // Time reference: leave this as GPS time
+            *((uint16_t *) (message + 4)) = uUbxProtocolUint16Encode(1);
+            errorCode = uGnssPrivateSendUbxMessage(pInstance,
+                                                   0x06, 0x08,
+                                                   message,
+                                                   sizeof(message));
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the rate at which a ubx message is emitted.
+int32_t uGnssCfgGetMsgRate(int32_t gnssHandle,
+                           int32_t messageClass,
+                           int32_t messageId)
+{
+    int32_t errorCodeOrRate = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // Enough room for the body of the UBX-CFG-MSG message
+    // with the rates for all six ports
+    char message[8];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrRate = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) &&
+            (messageClass >= 0) && (messageClass <= 0xff) &&
+            (messageId >= 0) && (messageId <= 0xff) &&
+            (pInstance->portNumber >= 0) && (pInstance->portNumber < 6)) {
+            errorCodeOrRate = (int32_t) U_ERROR_COMMON_PLATFORM;
+            // Poll UBX-CFG-MSG with the class and ID of the message
+            message[0] = (char) messageClass;
+            message[1] = (char) messageId;
+            if (uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                  0x06, 0x01,
+                                                  message, 2,
+                                                  message,
+                                                  sizeof(message)) == sizeof(message)) {
+                // The rates for each port follow the class and ID
+                errorCodeOrRate = (uint8_t) message[2 + pInstance->portNumber];
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrRate;
+}
+
+// Set the rate at which a ubx message is emitted.
+int32_t uGnssCfgSetMsgRate(int32_t gnssHandle,
+                           int32_t messageClass,
+                           int32_t messageId,
+                           int32_t rate)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // Enough room for the short form of the body of the
+    // UBX-CFG-MSG message, which sets the rate for the
+    // port the message arrives on
+    char message[3];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) &&
+            (messageClass >= 0) && (messageClass <= 0xff) &&
+            (messageId >= 0) && (messageId <= 0xff) &&
+            (rate >= 0) && (rate <= 0xff)) {
+            message[0] = (char) messageClass;
+            message[1] = (char) messageId;
+            message[2] = (char) rate;
+            errorCode = uGnssPrivateSendUbxMessage(pInstance,
+                                                   0x06, 0x01,
+                                                   message,
+                                                   sizeof(message));
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the GNSS APIs to receive streamed ubx
+ * messages; the reader itself lives in u_gnss_private.c since the
+ * request/response functions there depend upon it.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+
+#include "u_cfg_sw.h"
+
+#include "u_error_common.h"
+
+#include "u_port_os.h"  // Required by u_gnss_private.h
+
+#include "u_ubx_protocol.h" // Required by u_gnss_private.h
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Set the largest message body to deliver to subscribers.
+int32_t uGnssMsgSetBodyLengthMax(int32_t gnssHandle,
+                                 size_t bodyLengthMaxBytes)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (bodyLengthMaxBytes > 0) &&
+            (bodyLengthMaxBytes <= 0xffff)) {
+            pInstance->msgBodyLengthMaxBytes = bodyLengthMaxBytes;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Get the largest message body to deliver to subscribers.
+int32_t uGnssMsgGetBodyLengthMax(int32_t gnssHandle)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCodeOrLength = (int32_t) pInstance->msgBodyLengthMaxBytes;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrLength;
+}
+
+// Subscribe to streamed ubx messages.
+int32_t uGnssMsgReceiveStart(int32_t gnssHandle,
+                             int32_t messageClass,
+                             int32_t messageId,
+                             void (*pCallback) (int32_t gnssHandle,
+                                                int32_t messageClass,
+                                                int32_t messageId,
+                                                const char *pBody,
+                                                size_t bodyLengthBytes,
+                                                void *pCallbackParam),
+                             void *pCallbackParam)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pCallback != NULL) &&
+            (messageClass >= U_GNSS_MSG_ALL) && (messageClass <= 0xff) &&
+            (messageId >= U_GNSS_MSG_ALL) && (messageId <= 0xff)) {
+            errorCodeOrHandle = uGnssPrivateMsgSubscribe(pInstance,
+                                                         messageClass,
+                                                         messageId,
+                                                         pCallback,
+                                                         pCallbackParam);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrHandle;
+}
+
+// Cancel a subscription to streamed ubx messages.
+int32_t uGnssMsgReceiveStop(int32_t gnssHandle, int32_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCode = uGnssPrivateMsgUnsubscribe(pInstance, handle);
+            if ((errorCode == 0) && (handle == pInstance->posStreamedSubscription)) {
+                // That was the subscription of
+                // uGnssPosGetStreamedStart(), forget it
+                pInstance->posStreamedSubscription = -1;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Cancel all subscriptions to streamed ubx messages.
+void uGnssMsgReceiveStopAll(int32_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            uGnssPrivateMsgReaderStop(pInstance);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
+// End of file
@@ -85,6 +85,10 @@
 #define U_GNSS_POS_RRLP_HEADER_SIZE_BYTES (U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES - 2)
 #endif
 
+/** The length of the body of a UBX-NAV-PVT message.
+ */
+#define U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES 92
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -113,121 +117,171 @@ typedef struct {
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Establish position.
-static int32_t posGet(const uGnssPrivateInstance_t *pInstance,
-                      int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
-                      int32_t *pAltitudeMillimetres,
-                      int32_t *pRadiusMillimetres,
-                      int32_t *pSpeedMillimetresPerSecond,
-                      int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
+// Decode position from the body of a UBX-NAV-PVT message,
+// returning U_ERROR_COMMON_TIMEOUT if there is no fix.
+static int32_t posDecode(const char *pMessage,
+                         int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                         int32_t *pAltitudeMillimetres,
+                         int32_t *pRadiusMillimetres,
+                         int32_t *pSpeedMillimetresPerSecond,
+                         int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
-    // Enough room for the body of the UBX-NAV-PVT message
-    char message[92] = {0};
     int32_t months;
     int32_t year;
     int32_t y;
     int64_t t = -1;
 
-    y = uGnssPrivateSendReceiveUbxMessage(pInstance,
-                                          0x01, 0x07, NULL, 0,
-                                          message, sizeof(message));
-    if (y == sizeof(message)) {
-        // Got the correct message body length, process it
-        if ((message[11] & 0x03) == 0x03) {
-            // Time and date are valid; we don't indicate
-            // success based on this but we report it anyway
-            // if it is valid
-            t = 0;
-            // Year is 1999-2099, so need to adjust to get year since 1970
-            year = ((int32_t) uUbxProtocolUint16Decode(message + 4) - 1999) + 29;
-            // Month (1 to 12), so take away 1 to make it zero-based
-            months = message[6] - 1;
-            months += year * 12;
-            // Work out the number of seconds due to the year/month count
-            t += uTimeMonthsToSecondsUtc(months);
-            // Day (1 to 31)
-            t += ((int32_t) message[7] - 1) * 3600 * 24;
-            // Hour (0 to 23)
-            t += ((int32_t) message[8]) * 3600;
-            // Minute (0 to 59)
-            t += ((int32_t) message[9]) * 60;
-            // Second (0 to 60)
-            t += message[10];
-            if (printIt) {
-                uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
-            }
+    if ((pMessage[11] & 0x03) == 0x03) {
+        // Time and date are valid; we don't indicate
+        // success based on this but we report it anyway
+        // if it is valid
+        t = 0;
+        // Year is 1999-2099, so need to adjust to get year since 1970
+        year = ((int32_t) uUbxProtocolUint16Decode(pMessage + 4) - 1999) + 29;
+        // Month (1 to 12), so take away 1 to make it zero-based
+        months = pMessage[6] - 1;
+        months += year * 12;
+        // Work out the number of seconds due to the year/month count
+        t += uTimeMonthsToSecondsUtc(months);
+        // Day (1 to 31)
+        t += ((int32_t) pMessage[7] - 1) * 3600 * 24;
+        // Hour (0 to 23)
+        t += ((int32_t) pMessage[8]) * 3600;
+        // Minute (0 to 59)
+        t += ((int32_t) pMessage[9]) * 60;
+        // Second (0 to 60)
+        t += pMessage[10];
+        if (printIt) {
+            uPortLog("U_GNSS_POS: UTC time = %d.\n", (int32_t) t);
         }
-        if (pTimeUtc != NULL) {
-            *pTimeUtc = t;
+    }
+    if (pTimeUtc != NULL) {
+        *pTimeUtc = t;
+    }
+    // From here onwards Lint complains about accesses
+    // into pMessage[] and it doesn't seem to be possible
+    // to suppress those warnings with -esym(690, message)
+    // or even -e(690), hence do it the blunt way
+    //lint -save -e690
+    if (pMessage[21] & 0x01) {
+        if (printIt) {
+            uPortLog("U_GNSS_POS: %dD fix achieved.\n", pMessage[20]);
         }
-        // From here onwards Lint complains about accesses
-        // into message[] and it doesn't seem to be possible
-        // to suppress those warnings with -esym(690, message)
-        // or even -e(690), hence do it the blunt way
-        //lint -save -e690
-        if (message[21] & 0x01) {
-            if (printIt) {
-                uPortLog("U_GNSS_POS: %dD fix achieved.\n", message[20]);
-            }
-            y = (int32_t) message[23];
-            if (printIt) {
-                uPortLog("U_GNSS_POS: satellite(s) = %d.\n", y);
-            }
-            if (pSvs != NULL) {
-                *pSvs = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 24);
-            if (printIt) {
-                uPortLog("U_GNSS_POS: longitude = %d (degrees * 10^7).\n", y);
-            }
-            if (pLongitudeX1e7 != NULL) {
-                *pLongitudeX1e7 = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 28);
-            if (printIt) {
-                uPortLog("U_GNSS_POS: latitude = %d (degrees * 10^7).\n", y);
-            }
-            if (pLatitudeX1e7 != NULL) {
-                *pLatitudeX1e7 = y;
-            }
-            y = INT_MIN;
-            if (message[20] == 0x03) {
-                y = (int32_t) uUbxProtocolUint32Decode(message + 36);
-                if (printIt) {
-                    uPortLog("U_GNSS_POS: altitude = %d (mm).\n", y);
-                }
-            }
-            if (pAltitudeMillimetres != NULL) {
-                *pAltitudeMillimetres = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 40);
-            if (printIt) {
-                uPortLog("U_GNSS_POS: radius = %d (mm).\n", y);
-            }
-            if (pRadiusMillimetres != NULL) {
-                *pRadiusMillimetres = y;
-            }
-            y = (int32_t) uUbxProtocolUint32Decode(message + 60);
+        y = (int32_t) pMessage[23];
+        if (printIt) {
+            uPortLog("U_GNSS_POS: satellite(s) = %d.\n", y);
+        }
+        if (pSvs != NULL) {
+            *pSvs = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(pMessage + 24);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: longitude = %d (degrees * 10^7).\n", y);
+        }
+        if (pLongitudeX1e7 != NULL) {
+            *pLongitudeX1e7 = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(pMessage + 28);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: latitude = %d (degrees * 10^7).\n", y);
+        }
+        if (pLatitudeX1e7 != NULL) {
+            *pLatitudeX1e7 = y;
+        }
+        y = INT_MIN;
+        if (pMessage[20] == 0x03) {
+            y = (int32_t) uUbxProtocolUint32Decode(pMessage + 36);
             if (printIt) {
-                uPortLog("U_GNSS_POS: speed = %d (mm/s).\n", y);
-            }
-            if (pSpeedMillimetresPerSecond != NULL) {
-                *pSpeedMillimetresPerSecond = y;
+                uPortLog("U_GNSS_POS: altitude = %d (mm).\n", y);
             }
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            //lint -restore
         }
-    } else {
-        errorCode = y;
-        if (errorCode >= 0) {
-            errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+        if (pAltitudeMillimetres != NULL) {
+            *pAltitudeMillimetres = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(pMessage + 40);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: radius = %d (mm).\n", y);
+        }
+        if (pRadiusMillimetres != NULL) {
+            *pRadiusMillimetres = y;
+        }
+        y = (int32_t) uUbxProtocolUint32Decode(pMessage + 60);
+        if (printIt) {
+            uPortLog("U_GNSS_POS: speed = %d (mm/s).\n", y);
         }
+        if (pSpeedMillimetresPerSecond != NULL) {
+            *pSpeedMillimetresPerSecond = y;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        //lint -restore
     }
 
     return errorCode;
 }
 
+// Establish position.
+static int32_t posGet(const uGnssPrivateInstance_t *pInstance,
+                      int32_t *pLatitudeX1e7, int32_t *pLongitudeX1e7,
+                      int32_t *pAltitudeMillimetres,
+                      int32_t *pRadiusMillimetres,
+                      int32_t *pSpeedMillimetresPerSecond,
+                      int32_t *pSvs, int64_t *pTimeUtc, bool printIt)
+{
+    int32_t errorCode;
+    // Enough room for the body of the UBX-NAV-PVT message
+    char message[U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES] = {0};
+
+    // If UBX-NAV-PVT is being streamed the response to this
+    // poll will be picked out of the stream
+    errorCode = uGnssPrivateSendReceiveUbxMessage(pInstance,
+                                                  0x01, 0x07, NULL, 0,
+                                                  message, sizeof(message));
+    if (errorCode == sizeof(message)) {
+        // Got the correct message body length, process it
+        errorCode = posDecode(message, pLatitudeX1e7, pLongitudeX1e7,
+                              pAltitudeMillimetres, pRadiusMillimetres,
+                              pSpeedMillimetresPerSecond, pSvs, pTimeUtc,
+                              printIt);
+    } else if (errorCode >= 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_DEVICE_ERROR;
+    }
+
+    return errorCode;
+}
+
+// Callback for streamed UBX-NAV-PVT messages, called in the
+// UART event task with pCallbackParam pointing to the instance.
+static void posStreamedCallback(int32_t gnssHandle, int32_t messageClass,
+                                int32_t messageId, const char *pBody,
+                                size_t bodyLengthBytes, void *pCallbackParam)
+{
+    const uGnssPrivateInstance_t *pInstance = (const uGnssPrivateInstance_t *) pCallbackParam;
+    int32_t errorCode;
+    int32_t latitudeX1e7 = INT_MIN;
+    int32_t longitudeX1e7 = INT_MIN;
+    int32_t altitudeMillimetres = INT_MIN;
+    int32_t radiusMillimetres = -1;
+    int32_t speedMillimetresPerSecond = INT_MIN;
+    int32_t svs = -1;
+    int64_t timeUtc = -1;
+
+    (void) messageClass;
+    (void) messageId;
+
+    if ((pInstance->pPosStreamedCallback != NULL) &&
+        (bodyLengthBytes == U_GNSS_POS_NAV_PVT_BODY_LENGTH_BYTES)) {
+        errorCode = posDecode(pBody, &latitudeX1e7, &longitudeX1e7,
+                              &altitudeMillimetres, &radiusMillimetres,
+                              &speedMillimetresPerSecond, &svs, &timeUtc,
+                              false);
+        pInstance->pPosStreamedCallback(gnssHandle, errorCode, latitudeX1e7,
+                                        longitudeX1e7, altitudeMillimetres,
+                                        radiusMillimetres, speedMillimetresPerSecond,
+                                        svs, timeUtc);
+    }
+}
+
 // Establish position as a task.
 // IMPORTANT: this does NOT lock gUGnssPrivateMutex and hence it
 // is important that it is stopped before a pInstance is released.
@@ -266,7 +320,12 @@ static void posGetTask(void *pParameter)
                            &speedMillimetresPerSecond,
                            &svs,
                            &timeUtc, false);
-        uPortTaskBlock(U_GNSS_POS_CALLBACK_TASK_STACK_DELAY_SECONDS * 1000);
+        if ((errorCode == (int32_t) U_ERROR_COMMON_TIMEOUT) &&
+            (taskParameters.pInstance->posStreamedSubscription < 0)) {
+            // No need to wait if UBX-NAV-PVT is being streamed,
+            // posGet() is then just waiting for the next one
+            uPortTaskBlock(U_GNSS_POS_CALLBACK_TASK_STACK_DELAY_SECONDS * 1000);
+        }
     }
 
     taskParameters.pCallback(taskParameters.gnssHandle, errorCode, latitudeX1e7,
@@ -466,6 +525,105 @@ void uGnssPosGetStop(int32_t gnssHandle)
     }
 }
 
+// Start streamed position.
+int32_t uGnssPosGetStreamedStart(int32_t gnssHandle,
+                                 int32_t rateMs,
+                                 void (*pCallback) (int32_t gnssHandle,
+                                                    int32_t errorCode,
+                                                    int32_t latitudeX1e7,
+                                                    int32_t longitudeX1e7,
+                                                    int32_t altitudeMillimetres,
+                                                    int32_t radiusMillimetres,
+                                                    int32_t speedMillimetresPerSecond,
+                                                    int32_t svs,
+                                                    int64_t timeUtc))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    // Enough room for the body of the UBX-CFG-RATE message
+    // or the short form of the UBX-CFG-MSG message
+    char message[6];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pCallback != NULL) &&
+            (rateMs <= 0xffff)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            if (pInstance->posStreamedSubscription < 0) {
+                // Subscribe first, since that checks that the
+                // transport supports streaming
+                pInstance->pPosStreamedCallback = pCallback;
+                errorCode = uGnssPrivateMsgSubscribe(pInstance, 0x01, 0x07,
+                                                     posStreamedCallback,
+                                                     (void *) pInstance);
+                if (errorCode >= 0) {
+                    pInstance->posStreamedSubscription = errorCode;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    if (rateMs > 0) {
+                        // Set the measurement rate with UBX-CFG-RATE,
+                        // one navigation solution per measurement,
+                        // GPS time reference
+                        *((uint16_t *) message) = uUbxProtocolUint16Encode((uint16_t) rateMs);
+                        *((uint16_t *) (message + 2)) = uUbxProtocolUint16Encode(1);
+                        *((uint16_t *) (message + 4)) = uUbxProtocolUint16Encode(1);
+                        errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x08,
+                                                               message, 6);
+                    }
+                    if (errorCode == 0) {
+                        // Ask for UBX-NAV-PVT with every navigation solution
+                        message[0] = 0x01;
+                        message[1] = 0x07;
+                        message[2] = 1;
+                        errorCode = uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x01,
+                                                               message, 3);
+                    }
+                    if (errorCode != 0) {
+                        uGnssPrivateMsgUnsubscribe(pInstance,
+                                                   pInstance->posStreamedSubscription);
+                        pInstance->posStreamedSubscription = -1;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+// Stop streamed position.
+void uGnssPosGetStreamedStop(int32_t gnssHandle)
+{
+    uGnssPrivateInstance_t *pInstance;
+    // Enough room for the short form of the UBX-CFG-MSG message
+    char message[3];
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pInstance->posStreamedSubscription >= 0)) {
+            // Stop UBX-NAV-PVT being emitted, while the
+            // reader is still running to pick up the Ack
+            message[0] = 0x01;
+            message[1] = 0x07;
+            message[2] = 0;
+            uGnssPrivateSendUbxMessage(pInstance, 0x06, 0x01, message, 3);
+            uGnssPrivateMsgUnsubscribe(pInstance,
+                                       pInstance->posStreamedSubscription);
+            pInstance->posStreamedSubscription = -1;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+}
+
 // Get RRLP information from the GNSS chip.
 int32_t uGnssPosGetRrlp(int32_t gnssHandle, char *pBuffer,
                         size_t sizeBytes, int32_t svsThreshold,
@@ -35,6 +35,7 @@
 #include "string.h"    // memmove(), strstr()
 
 #include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
 
 #include "u_error_common.h"
 
@@ -54,39 +55,24 @@
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
+#include "u_gnss_msg.h"
 #include "u_gnss_private.h"
 
 /* ----------------------------------------------------------------
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
-#ifndef U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES
-/** The length of a temporary buffer to read the raw serial port
- * data into and then search within it for ubx messages, filtering
- * them out from NMEA stuff. Since we have no way of telling
- * how much other stuff there is in the buffer, we create one
- * of twice the expected message length so that we can cope with
- * a wanted message of maximal length starting right at the end.
- * This is also the amount we need to store a hex-encoded ubx-format
- * message when receiving responses over an AT interface.
+#ifndef U_GNSS_UART_RECEIVE_POLL_INTERVAL_MS
+/** How long to wait between checks of the UART for the response
+ * to a ubx message when the streamed message reader is not running.
  */
-# define U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES ((U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES + \
-                                                U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) * 2)
+# define U_GNSS_UART_RECEIVE_POLL_INTERVAL_MS 10
 #endif
 
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
-/** A ubx message.
- */
-typedef struct {
-    int32_t cls;
-    int32_t id;
-    char *pBody;
-    size_t bodyMaxLengthBytes;
-} uGnssPrivateUbxMessage_t;
-
 /* ----------------------------------------------------------------
  * VARIABLES THAT ARE SHARED THROUGHOUT THE GNSS IMPLEMENTATION
  * -------------------------------------------------------------- */
@@ -140,154 +126,147 @@ static int32_t sendUbxMessageUart(int32_t uartHandle, const char *pMessage,
     return errorCodeOrSentLength;
 }
 
+// Check if a decoded ubx message is the one wanted in pResponse
+// and, if so, copy it into pResponse.
+static int32_t ubxMessageMatch(uGnssPrivateUbxMessage_t *pResponse,
+                               int32_t cls, int32_t id,
+                               const char *pBody, int32_t bodyLength,
+                               bool printIt)
+{
+    int32_t errorCodeOrResponseBodyLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+
+    if (((pResponse->cls < 0) || (cls == pResponse->cls)) &&
+        ((pResponse->id < 0) || (id == pResponse->id))) {
+        errorCodeOrResponseBodyLength = bodyLength;
+        if (errorCodeOrResponseBodyLength > (int32_t) pResponse->bodyMaxLengthBytes) {
+            errorCodeOrResponseBodyLength = (int32_t) pResponse->bodyMaxLengthBytes;
+        }
+        if ((pResponse->pBody != NULL) && (pResponse->pBody != pBody) &&
+            (errorCodeOrResponseBodyLength > 0)) {
+            memcpy(pResponse->pBody, pBody, errorCodeOrResponseBodyLength);
+        }
+        if (printIt) {
+            uPortLog("U_GNSS: decoded ubx response 0x%02x 0x%02x", cls, id);
+            if (errorCodeOrResponseBodyLength > 0) {
+                uPortLog(":");
+                uGnssPrivatePrintBuffer(pResponse->pBody, errorCodeOrResponseBodyLength);
+            }
+            uPortLog(" [body %d byte(s)].\n", errorCodeOrResponseBodyLength);
+        }
+        // Let the caller know the message class/ID that came back
+        pResponse->cls = cls;
+        pResponse->id = id;
+    }
+
+    return errorCodeOrResponseBodyLength;
+}
+
 // Receive a ubx format message over UART.
 // The class and ID fields of pResponse, if present,
 // should be set to the message class and ID of the expected response,
 // so that other random ubx messages can be filtered out; set to -1
-// for "don't care"
-// Note that this message handling is good for the request-response
-// style usage of the ubx protocol employed here, where we are looking
-// for a particular response and are happy to throw away anything else
-// that happens to be read into the buffer beyond that.  Should we,
-// in the future, expect to handle asynchronous ubx messages coming from
-// the GNSS chip this would need to be revisited with some form of
-// rolling buffer mechanism in which store any residual stuff from the
-// uPortUartRead() after the wanted message.
-static int32_t receiveUbxMessageUart(int32_t uartHandle,
-                                     uGnssPrivateUbxMessage_t *pResponse,
-                                     int32_t timeoutMs, bool printIt)
+// for "don't care".
+// This is only used when the streamed message reader is not running:
+// we are looking for a particular response and are happy to throw
+// away anything else; when the reader is running it is the only
+// consumer of data from the UART and sendReceiveUbxMessageStreamed()
+// is used instead.
+static int32_t receiveUbxMessageUart(const uGnssPrivateInstance_t *pInstance,
+                                     uGnssPrivateUbxMessage_t *pResponse)
 {
-    int32_t errorCodeOrResponseBodyLength = 0;
+    int32_t errorCodeOrResponseBodyLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    int32_t uartHandle = pInstance->transportHandle.uart;
+    uUbxProtocolDecoder_t *pDecoder = pInstance->pUbxDecoder;
+    // Raw data read from the UART goes after the
+    // body storage of the decoder
+    char *pBuffer = pInstance->pTemporaryBuffer;
     int64_t startTime;
     int32_t x;
-    int32_t y;
-    int32_t cls;
-    int32_t id;
-    int32_t bytesKept = 0;
-    char *pBuffer = NULL;
-    char *pTmpStart;
-    char *pTmpEnd;
-
-    if ((pResponse->pBody != NULL) && (pResponse->bodyMaxLengthBytes > 0)) {
-        // We need a temporary buffer to read the raw serial port
-        // response into and then search within it for ubx messages,
-        // filtering them out from NMEA stuff. Since we have no way of telling
-        // how much other stuff there is in the buffer, we create one
-        // of twice the expected message length so that we can cope with
-        // a wanted message of maximal length starting right at the end
-        pBuffer = (char *) malloc(U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES);
-        if (pBuffer != NULL) {
-            errorCodeOrResponseBodyLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
-            startTime = uPortGetTickTimeMs();
-            // Wait for something to start coming back
-            while ((errorCodeOrResponseBodyLength < 0) &&
-                   (uPortGetTickTimeMs() - startTime < timeoutMs)) {
-                if (uPortUartGetReceiveSize(uartHandle) > 0) {
-                    // Got something, read what we can in and check if
-                    // it contains the ubx message we want (could also
-                    // be NMEA stuff or unwanted ubx messages)
-                    while ((uPortUartGetReceiveSize(uartHandle) > 0) &&
-                           (bytesKept < U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES) &&
-                           (errorCodeOrResponseBodyLength < 0)) {
-                        // Read the response into pBuffer
-                        x = uPortUartRead(uartHandle, pBuffer + bytesKept,
-                                          (size_t) (unsigned) (U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES - bytesKept));
-                        y = 0;
-                        pTmpStart = pBuffer;
-                        pTmpEnd = pBuffer;
-                        if (x > 0) {
-                            y = x + bytesKept;
-                        }
-                        while (y > 0) {
-                            // Try to decode the new + kept buffer contents to see if
-                            // the ubx message we want is now contained within it
-                            errorCodeOrResponseBodyLength = uUbxProtocolDecode(pTmpStart, y,
-                                                                               &cls, &id,
-                                                                               pResponse->pBody,
-                                                                               pResponse->bodyMaxLengthBytes,
-                                                                               //lint -e(1773) Suppress attempt to cast
-                                                                               // away const: I'm doing exactly the opposite...
-                                                                               (const char **) &pTmpEnd);
-                            if (errorCodeOrResponseBodyLength >= 0) {
-                                if (errorCodeOrResponseBodyLength > (int32_t) pResponse->bodyMaxLengthBytes) {
-                                    errorCodeOrResponseBodyLength = (int32_t) pResponse->bodyMaxLengthBytes;
-                                }
-                                if (printIt) {
-                                    uPortLog("U_GNSS: decoded ubx response 0x%02x 0x%02x", cls, id);
-                                    if (errorCodeOrResponseBodyLength > 0) {
-                                        uPortLog(":");
-                                        uGnssPrivatePrintBuffer(pResponse->pBody, errorCodeOrResponseBodyLength);
-                                    }
-                                    uPortLog(" [body %d byte(s)].\n", errorCodeOrResponseBodyLength);
-                                }
-                                if (((pResponse->cls >= 0) && (cls != pResponse->cls)) ||
-                                    ((pResponse->id >= 0) && (id != pResponse->id))) {
-                                    // Not what we were waiting for, try
-                                    // to decode more from this buffer-full
-                                    y -= (int32_t) (pTmpEnd - pTmpStart);
-                                    pTmpStart = pTmpEnd;
-                                    errorCodeOrResponseBodyLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
-                                } else {
-                                    // Let the caller know the message
-                                    // class/ID that came back
-                                    pResponse->cls = cls;
-                                    pResponse->id = id;
-                                    // Exit the decode loop
-                                    y = 0;
-                                }
-                            } else {
-                                // Not a ubx message, or not a complete one anyway
-                                if (errorCodeOrResponseBodyLength == (int32_t) U_ERROR_COMMON_TIMEOUT) {
-                                    // We've got back a "timeout" response
-                                    // from uUbxProtocolDecode(): a ubx format message
-                                    // has begun but we need more data to complete it.
-                                    //
-                                    // pBuffer looks like this:
-                                    //
-                                    //     ---------------------------------------------
-                                    //    |  NMEA stuff   |  partial ubx message |
-                                    //     ---------------------------------------------
-                                    //    |                         |---- x -----|
-                                    //    ^                         ^            ^
-                                    // pBuffer                  bytesKept       pTmp
-                                    //
-                                    // Keep what we've got in the buffer but if we've got
-                                    // more than the maximal length of response then get
-                                    // rid of the excess to stop the buffer clogging up
-                                    bytesKept = y;
-                                    if (bytesKept > U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
-                                        U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) {
-                                        bytesKept -= U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
-                                                     U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
-                                        memmove(pBuffer, pBuffer + U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES +
-                                                U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES,
-                                                bytesKept);
-                                    }
-                                } else {
-                                    // Any other response means we've got nothing,
-                                    // so lose anything that has been kept
-                                    bytesKept = 0;
-                                }
-
-                                // Done with this buffer-full
-                                y = 0;
-                            }
-                        }
+    size_t y;
+    const char *pTmpStart;
+    const char *pTmpEnd;
+
+    if (pBuffer != NULL) {
+        pBuffer += U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES;
+        errorCodeOrResponseBodyLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+        startTime = uPortGetTickTimeMs();
+        while ((errorCodeOrResponseBodyLength < 0) &&
+               (uPortGetTickTimeMs() - startTime < pInstance->timeoutMs)) {
+            x = 0;
+            if (uPortUartGetReceiveSize(uartHandle) > 0) {
+                x = uPortUartRead(uartHandle, pBuffer,
+                                  U_GNSS_UART_READ_CHUNK_LENGTH_BYTES);
+            }
+            if (x > 0) {
+                // Got something, feed it to the decoder and check
+                // if it completes the ubx message we want (it could
+                // also be NMEA stuff or unwanted ubx messages);
+                // anything after the wanted message is of no interest
+                y = (size_t) x;
+                pTmpStart = pBuffer;
+                while ((errorCodeOrResponseBodyLength < 0) && (y > 0)) {
+                    x = uUbxProtocolDecoderFeed(pDecoder, pTmpStart, y, &pTmpEnd);
+                    if (x >= 0) {
+                        errorCodeOrResponseBodyLength = ubxMessageMatch(pResponse,
+                                                                        pDecoder->messageClass,
+                                                                        pDecoder->messageId,
+                                                                        pDecoder->pBody, x,
+                                                                        pInstance->printUbxMessages);
                     }
-                } else {
-                    // Relax a little
-                    uPortTaskBlock(100);
+                    y -= pTmpEnd - pTmpStart;
+                    pTmpStart = pTmpEnd;
                 }
+            } else {
+                // Relax a little
+                uPortTaskBlock(U_GNSS_UART_RECEIVE_POLL_INTERVAL_MS);
             }
-
-            // Free memory
-            free(pBuffer);
         }
     }
 
     return errorCodeOrResponseBodyLength;
 }
 
+// Send a ubx format message over UART, if pSend is not NULL, and
+// receive the response via the streamed message reader.
+static int32_t sendReceiveUbxMessageStreamed(const uGnssPrivateInstance_t *pInstance,
+                                             const char *pSend,
+                                             size_t sendLengthBytes,
+                                             uGnssPrivateUbxMessage_t *pResponse)
+{
+    int32_t errorCodeOrResponseBodyLength;
+    uGnssPrivateMsgReader_t *pReader = pInstance->pMsgReader;
+
+    // Make sure that the semaphore is not left over from
+    // a response that arrived after the previous call gave up
+    uPortSemaphoreTryTake(pReader->responseSemaphore, 0);
+
+    // Register the response we want before sending so that
+    // it can't be missed
+    U_PORT_MUTEX_LOCK(pReader->mutex);
+    pReader->responseBodyLength = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    pReader->pResponse = pResponse;
+    U_PORT_MUTEX_UNLOCK(pReader->mutex);
+
+    errorCodeOrResponseBodyLength = 0;
+    if (pSend != NULL) {
+        errorCodeOrResponseBodyLength = sendUbxMessageUart(pInstance->transportHandle.uart,
+                                                           pSend, sendLengthBytes,
+                                                           pInstance->printUbxMessages);
+    }
+    if (errorCodeOrResponseBodyLength >= 0) {
+        uPortSemaphoreTryTake(pReader->responseSemaphore, pInstance->timeoutMs);
+    }
+
+    U_PORT_MUTEX_LOCK(pReader->mutex);
+    if (errorCodeOrResponseBodyLength >= 0) {
+        errorCodeOrResponseBodyLength = pReader->responseBodyLength;
+    }
+    pReader->pResponse = NULL;
+    U_PORT_MUTEX_UNLOCK(pReader->mutex);
+
+    return errorCodeOrResponseBodyLength;
+}
+
 // Send a ubx format message over an AT interface and receive
 // the response.  No matching of message ID or class for
 // the response is performed as it is not possible to get other
@@ -416,13 +395,18 @@ static int32_t sendReceiveUbxMessage(const uGnssPrivateInstance_t *pInstance,
                     case U_GNSS_TRANSPORT_UBX_UART:
                     //lint -fallthrough
                     case U_GNSS_TRANSPORT_NMEA_UART:
-                        errorCodeOrResponseBodyLength = sendUbxMessageUart(pInstance->transportHandle.uart,
-                                                                           pBuffer, bytesToSend,
-                                                                           pInstance->printUbxMessages);
-                        if (errorCodeOrResponseBodyLength >= 0) {
-                            errorCodeOrResponseBodyLength = receiveUbxMessageUart(pInstance->transportHandle.uart,
-                                                                                  pResponse, pInstance->timeoutMs,
-                                                                                  pInstance->printUbxMessages);
+                        if (pInstance->pMsgReader != NULL) {
+                            errorCodeOrResponseBodyLength = sendReceiveUbxMessageStreamed(pInstance,
+                                                                                          pBuffer, bytesToSend,
+                                                                                          pResponse);
+                        } else {
+                            errorCodeOrResponseBodyLength = sendUbxMessageUart(pInstance->transportHandle.uart,
+                                                                               pBuffer, bytesToSend,
+                                                                               pInstance->printUbxMessages);
+                            if (errorCodeOrResponseBodyLength >= 0) {
+                                errorCodeOrResponseBodyLength = receiveUbxMessageUart(pInstance,
+                                                                                      pResponse);
+                            }
                         }
                         break;
                     case U_GNSS_TRANSPORT_UBX_AT:
@@ -448,6 +432,99 @@ static int32_t sendReceiveUbxMessage(const uGnssPrivateInstance_t *pInstance,
     return errorCodeOrResponseBodyLength;
 }
 
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: STREAMED MESSAGE READER
+ * -------------------------------------------------------------- */
+
+// Pass a decoded ubx message, which is in the body buffer of
+// the reader, to a request/response exchange that is waiting
+// for it and to any matching subscribers.
+static void msgReaderDispatch(const uGnssPrivateInstance_t *pInstance,
+                              int32_t cls, int32_t id,
+                              int32_t bodyLength)
+{
+    uGnssPrivateMsgReader_t *pReader = pInstance->pMsgReader;
+    uGnssPrivateMsgSubscriber_t *pSubscriber;
+    int32_t x;
+
+    const char *pBody = pInstance->pUbxDecoder->pBody;
+
+    U_PORT_MUTEX_LOCK(pReader->mutex);
+
+    if (pReader->pResponse != NULL) {
+        x = ubxMessageMatch(pReader->pResponse, cls, id,
+                            pBody, bodyLength,
+                            pInstance->printUbxMessages);
+        if (x >= 0) {
+            pReader->responseBodyLength = x;
+            pReader->pResponse = NULL;
+            uPortSemaphoreGive(pReader->responseSemaphore);
+        }
+    }
+
+    for (pSubscriber = pReader->pSubscriberList; pSubscriber != NULL;
+         pSubscriber = pSubscriber->pNext) {
+        if (((pSubscriber->messageClass < 0) || (cls == pSubscriber->messageClass)) &&
+            ((pSubscriber->messageId < 0) || (id == pSubscriber->messageId))) {
+            pSubscriber->pCallback(pInstance->handle, cls, id,
+                                   pBody, (size_t) bodyLength,
+                                   pSubscriber->pCallbackParam);
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pReader->mutex);
+}
+
+// Point the decoder of an instance back at the body storage in
+// its temporary buffer, which the reader may have replaced.
+static void decoderRestore(const uGnssPrivateInstance_t *pInstance)
+{
+    uUbxProtocolDecoderInit(pInstance->pUbxDecoder,
+                            pInstance->pTemporaryBuffer,
+                            U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES);
+}
+
+// The streamed message reader: called in the UART event task
+// when data has arrived, it feeds everything there is to the
+// decoder of the instance and dispatches each message as it is
+// completed; a partial message stays in the decoder for next time.
+static void msgReaderCallback(int32_t uartHandle, uint32_t eventBitmask,
+                              void *pParameters)
+{
+    uGnssPrivateInstance_t *pInstance = (uGnssPrivateInstance_t *) pParameters;
+    uUbxProtocolDecoder_t *pDecoder = pInstance->pUbxDecoder;
+    char *pBuffer = pInstance->pTemporaryBuffer;
+    int32_t x;
+    size_t y;
+    const char *pTmpStart;
+    const char *pTmpEnd;
+
+    if ((eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) &&
+        (pInstance->pMsgReader != NULL) && (pBuffer != NULL)) {
+        pBuffer += U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES;
+        while (uPortUartGetReceiveSize(uartHandle) > 0) {
+            x = uPortUartRead(uartHandle, pBuffer,
+                              U_GNSS_UART_READ_CHUNK_LENGTH_BYTES);
+            if (x > 0) {
+                y = (size_t) x;
+                pTmpStart = pBuffer;
+                while (y > 0) {
+                    x = uUbxProtocolDecoderFeed(pDecoder, pTmpStart, y, &pTmpEnd);
+                    if (x >= 0) {
+                        msgReaderDispatch(pInstance, pDecoder->messageClass,
+                                          pDecoder->messageId, x);
+                    }
+                    y -= pTmpEnd - pTmpStart;
+                    pTmpStart = pTmpEnd;
+                }
+            } else {
+                // Nothing to be had, leave it for the next event
+                break;
+            }
+        }
+    }
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
  * -------------------------------------------------------------- */
@@ -563,9 +640,13 @@ int32_t uGnssPrivateReceiveOnlyUartUbxMessage(const uGnssPrivateInstance_t *pIns
 
         U_PORT_MUTEX_LOCK(pInstance->transportMutex);
 
-        errorCodeOrResponseBodyLength = receiveUbxMessageUart(pInstance->transportHandle.uart,
-                                                              &response, pInstance->timeoutMs,
-                                                              pInstance->printUbxMessages);
+        if (pInstance->pMsgReader != NULL) {
+            errorCodeOrResponseBodyLength = sendReceiveUbxMessageStreamed(pInstance,
+                                                                          NULL, 0,
+                                                                          &response);
+        } else {
+            errorCodeOrResponseBodyLength = receiveUbxMessageUart(pInstance, &response);
+        }
 
         U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
     }
@@ -651,6 +732,189 @@ void uGnssPrivateCleanUpPosTask(uGnssPrivateInstance_t *pInstance)
     }
 }
 
+// Start the reader of streamed ubx messages.
+int32_t uGnssPrivateMsgReaderStart(uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    uGnssPrivateMsgReader_t *pReader;
+    size_t bodyLengthMaxBytes = pInstance->msgBodyLengthMaxBytes;
+    size_t bodyStorageBytes = 0;
+    char *pBody;
+
+    if (((pInstance->transportType == U_GNSS_TRANSPORT_UBX_UART) ||
+         (pInstance->transportType == U_GNSS_TRANSPORT_NMEA_UART)) &&
+        (pInstance->pTemporaryBuffer != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pInstance->pMsgReader == NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            if (bodyLengthMaxBytes > U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES) {
+                // Bigger than the body storage in the temporary
+                // buffer: the reader brings its own
+                bodyStorageBytes = bodyLengthMaxBytes;
+            }
+            pReader = (uGnssPrivateMsgReader_t *) malloc(sizeof(uGnssPrivateMsgReader_t) +
+                                                         bodyStorageBytes);
+            if (pReader != NULL) {
+                memset(pReader, 0, sizeof(*pReader));
+                errorCode = uPortMutexCreate(&(pReader->mutex));
+                if (errorCode == 0) {
+                    errorCode = uPortSemaphoreCreate(&(pReader->responseSemaphore), 0, 1);
+                    if (errorCode == 0) {
+
+                        U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+                        // From here on the reader is the only
+                        // consumer of data from the UART
+                        pBody = pInstance->pTemporaryBuffer;
+                        if (bodyStorageBytes > 0) {
+                            pBody = (char *) (pReader + 1);
+                        }
+                        uUbxProtocolDecoderInit(pInstance->pUbxDecoder, pBody,
+                                                bodyLengthMaxBytes);
+                        pInstance->pMsgReader = pReader;
+                        errorCode = uPortUartEventCallbackSet(pInstance->transportHandle.uart,
+                                                              U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                              msgReaderCallback, pInstance,
+                                                              U_GNSS_MSG_TASK_STACK_SIZE_BYTES,
+                                                              U_GNSS_MSG_TASK_PRIORITY);
+                        if (errorCode != 0) {
+                            pInstance->pMsgReader = NULL;
+                            decoderRestore(pInstance);
+                        }
+
+                        U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+                        if (errorCode != 0) {
+                            uPortSemaphoreDelete(pReader->responseSemaphore);
+                        }
+                    }
+                    if (errorCode != 0) {
+                        uPortMutexDelete(pReader->mutex);
+                    }
+                }
+                if (errorCode != 0) {
+                    free(pReader);
+                }
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop the reader of streamed ubx messages.
+void uGnssPrivateMsgReaderStop(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssPrivateMsgReader_t *pReader = pInstance->pMsgReader;
+    uGnssPrivateMsgSubscriber_t *pSubscriber;
+
+    if (pReader != NULL) {
+
+        U_PORT_MUTEX_LOCK(pInstance->transportMutex);
+
+        // This waits for the event task to exit so, once
+        // it has returned, the reader is no longer in use
+        uPortUartEventCallbackRemove(pInstance->transportHandle.uart);
+        pInstance->pMsgReader = NULL;
+        decoderRestore(pInstance);
+
+        U_PORT_MUTEX_UNLOCK(pInstance->transportMutex);
+
+        while (pReader->pSubscriberList != NULL) {
+            pSubscriber = pReader->pSubscriberList;
+            pReader->pSubscriberList = pSubscriber->pNext;
+            free(pSubscriber);
+        }
+        uPortSemaphoreDelete(pReader->responseSemaphore);
+        uPortMutexDelete(pReader->mutex);
+        free(pReader);
+        pInstance->posStreamedSubscription = -1;
+    }
+}
+
+// Add a subscriber for streamed ubx messages.
+int32_t uGnssPrivateMsgSubscribe(uGnssPrivateInstance_t *pInstance,
+                                 int32_t messageClass, int32_t messageId,
+                                 void (*pCallback) (int32_t, int32_t,
+                                                    int32_t, const char *,
+                                                    size_t, void *),
+                                 void *pCallbackParam)
+{
+    int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uGnssPrivateMsgReader_t *pReader;
+    uGnssPrivateMsgSubscriber_t *pSubscriber;
+
+    pSubscriber = (uGnssPrivateMsgSubscriber_t *) malloc(sizeof(uGnssPrivateMsgSubscriber_t));
+    if (pSubscriber != NULL) {
+        errorCodeOrHandle = uGnssPrivateMsgReaderStart(pInstance);
+        if (errorCodeOrHandle == 0) {
+            pReader = pInstance->pMsgReader;
+            pSubscriber->messageClass = messageClass;
+            pSubscriber->messageId = messageId;
+            pSubscriber->pCallback = pCallback;
+            pSubscriber->pCallbackParam = pCallbackParam;
+
+            U_PORT_MUTEX_LOCK(pReader->mutex);
+
+            pSubscriber->handle = pReader->nextSubscriberHandle;
+            pReader->nextSubscriberHandle++;
+            if (pReader->nextSubscriberHandle < 0) {
+                pReader->nextSubscriberHandle = 0;
+            }
+            pSubscriber->pNext = pReader->pSubscriberList;
+            pReader->pSubscriberList = pSubscriber;
+            errorCodeOrHandle = pSubscriber->handle;
+
+            U_PORT_MUTEX_UNLOCK(pReader->mutex);
+
+        } else {
+            free(pSubscriber);
+        }
+    }
+
+    return errorCodeOrHandle;
+}
+
+// Remove a subscriber for streamed ubx messages.
+int32_t uGnssPrivateMsgUnsubscribe(uGnssPrivateInstance_t *pInstance,
+                                   int32_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+    uGnssPrivateMsgReader_t *pReader = pInstance->pMsgReader;
+    uGnssPrivateMsgSubscriber_t *pSubscriber = NULL;
+    uGnssPrivateMsgSubscriber_t *pPrevious = NULL;
+    bool stopReader = false;
+
+    if (pReader != NULL) {
+
+        U_PORT_MUTEX_LOCK(pReader->mutex);
+
+        pSubscriber = pReader->pSubscriberList;
+        while ((pSubscriber != NULL) && (pSubscriber->handle != handle)) {
+            pPrevious = pSubscriber;
+            pSubscriber = pSubscriber->pNext;
+        }
+        if (pSubscriber != NULL) {
+            if (pPrevious != NULL) {
+                pPrevious->pNext = pSubscriber->pNext;
+            } else {
+                pReader->pSubscriberList = pSubscriber->pNext;
+            }
+            free(pSubscriber);
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+        stopReader = (pReader->pSubscriberList == NULL);
+
+        U_PORT_MUTEX_UNLOCK(pReader->mutex);
+
+        if (stopReader) {
+            uGnssPrivateMsgReaderStop(pInstance);
+        }
+    }
+
+    return errorCode;
+}
+
 // Check whether the GNSS chip is on-board the cellular module.
 bool uGnssPrivateIsInsideCell(const uGnssPrivateInstance_t *pInstance)
 {
@@ -40,6 +40,32 @@ extern "C" {
 # define U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES 1024
 #endif
 
+#ifndef U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES
+/** The length of a temporary buffer in which to store a
+ * hex-encoded ubx-format message when receiving responses over
+ * an AT interface.
+ */
+# define U_GNSS_TEMPORARY_BUFFER_LENGTH_BYTES ((U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES + \
+                                                U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES) * 2)
+#endif
+
+#ifndef U_GNSS_UART_READ_CHUNK_LENGTH_BYTES
+/** The amount of raw serial port data to read at a time and feed
+ * to the incremental ubx message decoder of an instance on a UART
+ * transport.  Since the decoder keeps its state between chunks
+ * this has no bearing on the length of message that can be
+ * decoded.
+ */
+# define U_GNSS_UART_READ_CHUNK_LENGTH_BYTES 128
+#endif
+
+/** The length of the temporary buffer of an instance on a UART
+ * transport: storage for the body of the message being decoded
+ * followed by a chunk of raw serial port data.
+ */
+#define U_GNSS_UART_TEMPORARY_BUFFER_LENGTH_BYTES (U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES + \
+                                                   U_GNSS_UART_READ_CHUNK_LENGTH_BYTES)
+
 /** Determine if the given feature is supported or not
  * by the pointed-to module.
  */
@@ -92,6 +118,44 @@ typedef struct {
                                   characteristics of this module. */
 } uGnssPrivateModule_t;
 
+/** A ubx message.
+ */
+typedef struct {
+    int32_t cls;
+    int32_t id;
+    char *pBody;
+    size_t bodyMaxLengthBytes;
+} uGnssPrivateUbxMessage_t;
+
+/** A subscriber to the ubx messages streamed from a GNSS chip.
+ */
+typedef struct uGnssPrivateMsgSubscriber_t {
+    int32_t handle; /**< the handle of this subscription. */
+    int32_t messageClass; /**< the message class to receive, -1 for all. */
+    int32_t messageId; /**< the message ID to receive, -1 for all. */
+    void (*pCallback) (int32_t gnssHandle, int32_t messageClass,
+                       int32_t messageId, const char *pBody,
+                       size_t bodyLengthBytes,
+                       void *pCallbackParam); /**< the callback to call. */
+    void *pCallbackParam; /**< the parameter to pass to pCallback. */
+    struct uGnssPrivateMsgSubscriber_t *pNext;
+} uGnssPrivateMsgSubscriber_t;
+
+/** The context of the reader of streamed ubx messages; the reader
+ * runs in the UART event callback and is the only consumer of data
+ * from the UART while it is active.
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< protects pSubscriberList and pResponse. */
+    uGnssPrivateMsgSubscriber_t *pSubscriberList; /**< the subscribers. */
+    int32_t nextSubscriberHandle; /**< the handle to give the next subscriber. */
+    uGnssPrivateUbxMessage_t *pResponse; /**< where to put the response of a
+                                              request/response exchange that is
+                                              in progress, NULL if there isn't one. */
+    int32_t responseBodyLength; /**< the body length of the response. */
+    uPortSemaphoreHandle_t responseSemaphore; /**< given when the response has arrived. */
+} uGnssPrivateMsgReader_t;
+
 /** Definition of a GNSS instance.
  * Note: a pointer to this structure is passed to the asynchronous
  * "get position" function (posGetTask()) which does NOT lock the
@@ -118,6 +182,25 @@ typedef struct uGnssPrivateInstance_t {
     uPortMutexHandle_t
     posMutex; /**< handle for mutex associated with non-blocking position establishment. */
     volatile uint8_t posTaskFlags; /**< flags to synchronisation the pos task. */
+    uUbxProtocolDecoder_t *pUbxDecoder; /**< decoder for ubx messages received on a UART
+                                             transport, its state carried from one read
+                                             to the next; NULL for other transports. */
+    char *pTemporaryBuffer; /**< U_GNSS_UART_TEMPORARY_BUFFER_LENGTH_BYTES of storage for
+                                 the body decoded by pUbxDecoder and for raw data received
+                                 on a UART transport, allocated along with pUbxDecoder. */
+    uGnssPrivateMsgReader_t *pMsgReader; /**< the reader of streamed messages, NULL if not running. */
+    size_t msgBodyLengthMaxBytes; /**< the largest message body that pMsgReader can
+                                       decode, applied when the reader is started. */
+    int32_t posStreamedSubscription; /**< the subscription for streamed position, -1 if none. */
+    void (*pPosStreamedCallback) (int32_t gnssHandle,
+                                  int32_t errorCode,
+                                  int32_t latitudeX1e7,
+                                  int32_t longitudeX1e7,
+                                  int32_t altitudeMillimetres,
+                                  int32_t radiusMillimetres,
+                                  int32_t speedMillimetresPerSecond,
+                                  int32_t svs,
+                                  int64_t timeUtc); /**< the streamed position callback. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
 
@@ -276,6 +359,54 @@ int32_t uGnssPrivateSendUbxMessage(const uGnssPrivateInstance_t *pInstance,
  */
 void uGnssPrivateCleanUpPosTask(uGnssPrivateInstance_t *pInstance);
 
+/** Start the reader of streamed ubx messages for a GNSS instance,
+ * if it is not already running.  Only supported on UART transports.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the GNSS instance, cannot  be NULL.
+ * @return           zero on success else negative error code.
+ */
+int32_t uGnssPrivateMsgReaderStart(uGnssPrivateInstance_t *pInstance);
+
+/** Stop the reader of streamed ubx messages for a GNSS instance,
+ * removing all subscribers, and free its memory.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance  a pointer to the GNSS instance, cannot  be NULL.
+ */
+void uGnssPrivateMsgReaderStop(uGnssPrivateInstance_t *pInstance);
+
+/** Add a subscriber for streamed ubx messages, starting the reader
+ * if required.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance      a pointer to the GNSS instance, cannot  be NULL.
+ * @param messageClass   the message class to subscribe to, -1 for all.
+ * @param messageId      the message ID to subscribe to, -1 for all.
+ * @param pCallback      the callback, cannot be NULL.
+ * @param pCallbackParam a parameter that will be passed to pCallback.
+ * @return               the handle of the subscription else negative
+ *                       error code.
+ */
+int32_t uGnssPrivateMsgSubscribe(uGnssPrivateInstance_t *pInstance,
+                                 int32_t messageClass, int32_t messageId,
+                                 void (*pCallback) (int32_t, int32_t,
+                                                    int32_t, const char *,
+                                                    size_t, void *),
+                                 void *pCallbackParam);
+
+/** Remove a subscriber for streamed ubx messages; once this function
+ * has returned the callback of the subscriber will not be called
+ * again.  If there are no subscribers left the reader is stopped.
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param pInstance     a pointer to the GNSS instance, cannot  be NULL.
+ * @param handle        the handle of the subscription.
+ * @return              zero on success else negative error code.
+ */
+int32_t uGnssPrivateMsgUnsubscribe(uGnssPrivateInstance_t *pInstance,
+                                   int32_t handle);
+
 /** Check whether a GNSS chip that we are using via a cellular module
  * is on-board the cellular module, in which case the AT+GPIOC
  * comands are not used.
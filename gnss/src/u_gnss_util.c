@@ -45,6 +45,8 @@
 
 #include "u_hex_bin_convert.h"
 
+#include "u_ubx_protocol.h" // Required by u_gnss_private.h
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
@@ -114,6 +116,12 @@ int32_t uGnssUtilUbxTransparentSendReceive(int32_t gnssHandle,
                 case U_GNSS_TRANSPORT_UBX_UART:
                 //lint -fallthrough
                 case U_GNSS_TRANSPORT_NMEA_UART:
+                    if ((pResponse != NULL) && (pInstance->pMsgReader != NULL)) {
+                        // The streamed message reader is consuming
+                        // everything that arrives
+                        errorCodeOrResponseLength = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+                        break;
+                    }
                     errorCodeOrResponseLength = uPortUartWrite(pInstance->transportHandle.uart,
                                                                pCommand,
                                                                commandLengthBytes);
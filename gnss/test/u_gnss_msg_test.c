@@ -0,0 +1,629 @@
+/*
+ * Copyright 2020 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS streamed message API: these should pass
+ * on all platforms where two UARTs are available and are cross-wired
+ * (TXD of one to RXD of the other and vice-versa).  No GNSS module is
+ * used in this set of tests: the second UART plays the part of the
+ * GNSS chip.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+# ifdef U_CFG_OVERRIDE
+#  include "u_cfg_override.h" // For a customer's configuration override
+# endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // malloc(), free()
+#include "string.h"    // memset(), memcpy(), strlen()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_debug.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_cfg.h"
+#include "u_gnss_pos.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_GNSS_MSG_TEST_WAIT_MS
+/** How long to wait for streamed messages to arrive.
+ */
+# define U_GNSS_MSG_TEST_WAIT_MS 2000
+#endif
+
+/** The length of the body of a UBX-NAV-PVT message.
+ */
+#define U_GNSS_MSG_TEST_NAV_PVT_BODY_LENGTH_BYTES 92
+
+/** The length of the body of the UBX-RXM-RAWX message sent by the
+ * fake GNSS chip: 64 measurements, more than fits into the default
+ * body storage of the reader.
+ */
+#define U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES (16 + (32 * 64))
+
+/** The latitude that the fake GNSS chip reports.
+ */
+#define U_GNSS_MSG_TEST_LATITUDE_X1E7 521234567
+
+/** The longitude that the fake GNSS chip reports.
+ */
+#define U_GNSS_MSG_TEST_LONGITUDE_X1E7 -1234567
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+/** UART handle for the GNSS instance.
+ */
+static int32_t gUartAHandle = -1;
+
+/** UART handle for the fake GNSS chip.
+ */
+static int32_t gUartBHandle = -1;
+
+/** Buffer for the fake GNSS chip to receive into.
+ */
+static char gFakeGnssBuffer[256];
+
+/** The amount of data in gFakeGnssBuffer.
+ */
+static size_t gFakeGnssBufferLength = 0;
+
+/** The measurement period that the fake GNSS chip has been set to.
+ */
+static volatile int32_t gFakeGnssRateMs = 1000;
+
+/** The last message rate that the fake GNSS chip has been set to.
+ */
+static volatile int32_t gFakeGnssMsgRate = -1;
+
+/** Count of UBX-NAV-PVT messages received by pvtCallback().
+ */
+static volatile int32_t gPvtCount = 0;
+
+/** Count of UBX-NAV-SAT messages received by allCallback().
+ */
+static volatile int32_t gSatCount = 0;
+
+/** Count of UBX-NAV-xxx messages received by allCallback().
+ */
+static volatile int32_t gNavCount = 0;
+
+/** Count of UBX-RXM-RAWX messages received by allCallback().
+ */
+static volatile int32_t gRawxCount = 0;
+
+/** Count of calls to posCallback().
+ */
+static volatile int32_t gPosCount = 0;
+
+/** Set to a non-zero value by a callback if something is wrong.
+ */
+static volatile int32_t gCallbackError = 0;
+
+/** The latitude received by posCallback().
+ */
+static volatile int32_t gLatitudeX1e7 = 0;
+
+/** The longitude received by posCallback().
+ */
+static volatile int32_t gLongitudeX1e7 = 0;
+
+#endif
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+
+// Put a uint16_t into a message body, little-endian.
+static void bodyUint16Set(char *pBody, uint16_t value)
+{
+    uint16_t x = uUbxProtocolUint16Encode(value);
+
+    memcpy(pBody, &x, sizeof(x));
+}
+
+// Put an int32_t into a message body, little-endian.
+static void bodyInt32Set(char *pBody, int32_t value)
+{
+    uint32_t x = uUbxProtocolUint32Encode((uint32_t) value);
+
+    memcpy(pBody, &x, sizeof(x));
+}
+
+// Send a ubx message from the fake GNSS chip.
+static void fakeGnssSend(int32_t messageClass, int32_t messageId,
+                         const char *pBody, size_t bodyLengthBytes)
+{
+    char buffer[U_GNSS_MSG_TEST_NAV_PVT_BODY_LENGTH_BYTES +
+                                                          U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t x;
+
+    x = uUbxProtocolEncode(messageClass, messageId, pBody,
+                           bodyLengthBytes, buffer);
+    if (x > 0) {
+        uPortUartWrite(gUartBHandle, buffer, x);
+    }
+}
+
+// Send a UBX-RXM-RAWX from the fake GNSS chip, a chunk at a
+// time so as not to overrun the UART buffer at the other end.
+static void fakeGnssSendRawx()
+{
+    char *pBody;
+    char *pBuffer;
+    int32_t x;
+
+    // Room for the body followed by the encoded message
+    pBody = (char *) malloc((U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES * 2) +
+                            U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES);
+    if (pBody != NULL) {
+        pBuffer = pBody + U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES;
+        memset(pBody, 0x5a, U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES);
+        x = uUbxProtocolEncode(0x02, 0x15, pBody,
+                               U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES,
+                               pBuffer);
+        for (int32_t y = 0; y < x; y += U_GNSS_UART_BUFFER_LENGTH_BYTES / 2) {
+            if (x - y > U_GNSS_UART_BUFFER_LENGTH_BYTES / 2) {
+                uPortUartWrite(gUartBHandle, pBuffer + y,
+                               U_GNSS_UART_BUFFER_LENGTH_BYTES / 2);
+            } else {
+                uPortUartWrite(gUartBHandle, pBuffer + y, x - y);
+            }
+            uPortTaskBlock(10);
+        }
+        free(pBody);
+    }
+}
+
+// Send a UBX-ACK-ACK from the fake GNSS chip.
+static void fakeGnssAck(int32_t messageClass, int32_t messageId)
+{
+    char body[2];
+
+    body[0] = (char) messageClass;
+    body[1] = (char) messageId;
+    fakeGnssSend(0x05, 0x01, body, sizeof(body));
+}
+
+// The fake GNSS chip: responds to UBX-CFG-RATE and UBX-CFG-MSG,
+// called in the event task of UART B.
+static void fakeGnssCallback(int32_t uartHandle, uint32_t eventBitmask,
+                             void *pParameters)
+{
+    int32_t x;
+    int32_t cls;
+    int32_t id;
+    char body[6];
+    const char *pStart;
+    const char *pEnd;
+
+    (void) pParameters;
+
+    // Read until there is nothing left, otherwise we won't be
+    // told when more arrives
+    while ((eventBitmask & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED) &&
+           (uPortUartGetReceiveSize(uartHandle) > 0)) {
+        x = uPortUartRead(uartHandle, gFakeGnssBuffer + gFakeGnssBufferLength,
+                          sizeof(gFakeGnssBuffer) - gFakeGnssBufferLength);
+        if (x > 0) {
+            gFakeGnssBufferLength += x;
+            pStart = gFakeGnssBuffer;
+            while ((x = uUbxProtocolDecode(pStart, gFakeGnssBufferLength,
+                                           &cls, &id, body, sizeof(body),
+                                           &pEnd)) >= 0) {
+                if ((cls == 0x06) && (id == 0x08) && (x == 0)) {
+                    // Poll of UBX-CFG-RATE
+                    bodyUint16Set(body, (uint16_t) gFakeGnssRateMs);
+                    bodyUint16Set(body + 2, 1);
+                    bodyUint16Set(body + 4, 1);
+                    fakeGnssSend(0x06, 0x08, body, 6);
+                } else if ((cls == 0x06) && (id == 0x08) && (x == 6)) {
+                    // Set of UBX-CFG-RATE
+                    gFakeGnssRateMs = uUbxProtocolUint16Decode(body);
+                    fakeGnssAck(cls, id);
+                } else if ((cls == 0x06) && (id == 0x01) && (x == 3)) {
+                    // Set of UBX-CFG-MSG
+                    gFakeGnssMsgRate = (uint8_t) body[2];
+                    fakeGnssAck(cls, id);
+                }
+                gFakeGnssBufferLength -= pEnd - pStart;
+                pStart = pEnd;
+            }
+            if (x != (int32_t) U_ERROR_COMMON_TIMEOUT) {
+                // Nothing that looks like a ubx message, lose it
+                gFakeGnssBufferLength = 0;
+            } else if (pStart != gFakeGnssBuffer) {
+                memmove(gFakeGnssBuffer, pStart, gFakeGnssBufferLength);
+            }
+        } else {
+            break;
+        }
+    }
+}
+
+// Fill in the body of a UBX-NAV-PVT message with a 3D fix.
+static void navPvtFill(char *pBody)
+{
+    memset(pBody, 0, U_GNSS_MSG_TEST_NAV_PVT_BODY_LENGTH_BYTES);
+    bodyUint16Set(pBody + 4, 2021);
+    pBody[6] = 6;    // Month
+    pBody[7] = 15;   // Day
+    pBody[11] = 0x03; // Date and time valid
+    pBody[20] = 0x03; // 3D fix
+    pBody[21] = 0x01; // Fix OK
+    pBody[23] = 9;    // Satellites
+    bodyInt32Set(pBody + 24, U_GNSS_MSG_TEST_LONGITUDE_X1E7);
+    bodyInt32Set(pBody + 28, U_GNSS_MSG_TEST_LATITUDE_X1E7);
+    bodyInt32Set(pBody + 36, 12345);
+    bodyInt32Set(pBody + 40, 2500);
+}
+
+// Wait for a count to reach a value.
+static bool waitForCount(const volatile int32_t *pCount, int32_t count)
+{
+    int64_t startTimeMs = uPortGetTickTimeMs();
+
+    while ((*pCount < count) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_MSG_TEST_WAIT_MS)) {
+        uPortTaskBlock(10);
+    }
+
+    return (*pCount >= count);
+}
+
+// Subscriber callback for UBX-NAV-PVT.
+static void pvtCallback(int32_t gnssHandle, int32_t messageClass,
+                        int32_t messageId, const char *pBody,
+                        size_t bodyLengthBytes, void *pCallbackParam)
+{
+    (void) gnssHandle;
+
+    if ((messageClass != 0x01) || (messageId != 0x07) ||
+        (bodyLengthBytes != U_GNSS_MSG_TEST_NAV_PVT_BODY_LENGTH_BYTES) ||
+        (pCallbackParam != (void *) &gPvtCount) ||
+        (uUbxProtocolUint32Decode(pBody + 28) != U_GNSS_MSG_TEST_LATITUDE_X1E7)) {
+        gCallbackError = 1;
+    }
+    gPvtCount++;
+}
+
+// Subscriber callback for all messages of class UBX-NAV.
+static void allCallback(int32_t gnssHandle, int32_t messageClass,
+                        int32_t messageId, const char *pBody,
+                        size_t bodyLengthBytes, void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pCallbackParam;
+
+    if ((messageClass == 0x02) && (messageId == 0x15)) {
+        if ((bodyLengthBytes != U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES) ||
+            (pBody[bodyLengthBytes - 1] != 0x5a)) {
+            gCallbackError = 4;
+        }
+        gRawxCount++;
+    }
+    if (messageClass == 0x01) {
+        if (messageId == 0x35) {
+            if (bodyLengthBytes != 8 + 12) {
+                gCallbackError = 2;
+            }
+            gSatCount++;
+        }
+        gNavCount++;
+    }
+}
+
+// Callback for streamed position.
+static void posCallback(int32_t gnssHandle,
+                        int32_t errorCode,
+                        int32_t latitudeX1e7,
+                        int32_t longitudeX1e7,
+                        int32_t altitudeMillimetres,
+                        int32_t radiusMillimetres,
+                        int32_t speedMillimetresPerSecond,
+                        int32_t svs,
+                        int64_t timeUtc)
+{
+    (void) gnssHandle;
+    (void) speedMillimetresPerSecond;
+    (void) timeUtc;
+
+    if ((errorCode != 0) || (altitudeMillimetres != 12345) ||
+        (radiusMillimetres != 2500) || (svs != 9)) {
+        gCallbackError = 3;
+    }
+    gLatitudeX1e7 = latitudeX1e7;
+    gLongitudeX1e7 = longitudeX1e7;
+    gPosCount++;
+}
+
+#endif
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+#if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B >= 0)
+/** Stream ubx messages, mixed with NMEA and rubbish, from a fake
+ * GNSS chip on UART B to a GNSS instance on UART A and check that
+ * they are dispatched to the right subscribers, that request/response
+ * exchanges work with and without the reader running and that
+ * streamed position works.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgStream")
+{
+    int32_t gnssHandle;
+    uGnssTransportHandle_t transportHandle;
+    int32_t heapUsed;
+    int32_t pvtHandle;
+    int32_t allHandle;
+    int32_t rateMs = -1;
+    int32_t navigationCount = -1;
+    char body[U_GNSS_MSG_TEST_NAV_PVT_BODY_LENGTH_BYTES];
+    char buffer[(8 + 12) + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    const char *pNmea = "$GPGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,*5B\r\n";
+    // A ubx header with a length that can't be right
+    const char rubbish[] = {(char) 0xb5, 0x62, 0x01, 0x07, (char) 0xff, (char) 0xff, 0x00};
+    uGnssPrivateInstance_t *pInstance;
+    int32_t x;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    heapUsed = uPortGetHeapFree();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    gUartAHandle = uPortUartOpen(U_CFG_TEST_UART_A,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_A_TXD,
+                                 U_CFG_TEST_PIN_UART_A_RXD,
+                                 U_CFG_TEST_PIN_UART_A_CTS,
+                                 U_CFG_TEST_PIN_UART_A_RTS);
+    U_PORT_TEST_ASSERT(gUartAHandle >= 0);
+    transportHandle.uart = gUartAHandle;
+
+    gUartBHandle = uPortUartOpen(U_CFG_TEST_UART_B,
+                                 U_CFG_TEST_BAUD_RATE,
+                                 NULL,
+                                 U_GNSS_UART_BUFFER_LENGTH_BYTES,
+                                 U_CFG_TEST_PIN_UART_B_TXD,
+                                 U_CFG_TEST_PIN_UART_B_RXD,
+                                 U_CFG_TEST_PIN_UART_B_CTS,
+                                 U_CFG_TEST_PIN_UART_B_RTS);
+    U_PORT_TEST_ASSERT(gUartBHandle >= 0);
+    gFakeGnssBufferLength = 0;
+    gFakeGnssRateMs = 1000;
+    gFakeGnssMsgRate = -1;
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 fakeGnssCallback, NULL,
+                                                 U_GNSS_MSG_TASK_STACK_SIZE_BYTES,
+                                                 U_CFG_OS_APP_TASK_PRIORITY + 1) == 0);
+
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    uPortLog("U_GNSS_MSG_TEST: adding a GNSS instance on UART %d...\n",
+             U_CFG_TEST_UART_A);
+    gnssHandle = uGnssAdd(U_GNSS_MODULE_TYPE_M8,
+                          U_GNSS_TRANSPORT_UBX_UART,
+                          transportHandle, -1, false);
+    U_PORT_TEST_ASSERT(gnssHandle >= 0);
+    uGnssSetTimeout(gnssHandle, 2000);
+    pInstance = pUGnssPrivateGetInstance(gnssHandle);
+    U_PORT_TEST_ASSERT(pInstance != NULL);
+
+    uPortLog("U_GNSS_MSG_TEST: request/response without the reader...\n");
+    U_PORT_TEST_ASSERT(uGnssCfgGetRate(gnssHandle, &rateMs, &navigationCount) == 0);
+    U_PORT_TEST_ASSERT(rateMs == 1000);
+    U_PORT_TEST_ASSERT(navigationCount == 1);
+    U_PORT_TEST_ASSERT(uGnssCfgSetMsgRate(gnssHandle, 0x01, 0x35, 1) == 0);
+    U_PORT_TEST_ASSERT(gFakeGnssMsgRate == 1);
+    U_PORT_TEST_ASSERT(pInstance->pMsgReader == NULL);
+
+    uPortLog("U_GNSS_MSG_TEST: subscribing...\n");
+    gPvtCount = 0;
+    gSatCount = 0;
+    gNavCount = 0;
+    gRawxCount = 0;
+    gCallbackError = 0;
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStart(gnssHandle, 0x01, 0x07, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStart(gnssHandle, 0x100, 0x07, pvtCallback, NULL) < 0);
+    pvtHandle = uGnssMsgReceiveStart(gnssHandle, 0x01, 0x07, pvtCallback,
+                                     (void *) &gPvtCount);
+    U_PORT_TEST_ASSERT(pvtHandle >= 0);
+    allHandle = uGnssMsgReceiveStart(gnssHandle, U_GNSS_MSG_ALL, U_GNSS_MSG_ALL,
+                                     allCallback, NULL);
+    U_PORT_TEST_ASSERT(allHandle >= 0);
+    U_PORT_TEST_ASSERT(allHandle != pvtHandle);
+    U_PORT_TEST_ASSERT(pInstance->pMsgReader != NULL);
+
+    uPortLog("U_GNSS_MSG_TEST: streaming NAV-PVT and NAV-SAT mixed with NMEA...\n");
+    navPvtFill(body);
+    uPortUartWrite(gUartBHandle, pNmea, strlen(pNmea));
+    fakeGnssSend(0x01, 0x07, body, sizeof(body));
+    uPortUartWrite(gUartBHandle, rubbish, sizeof(rubbish));
+    uPortUartWrite(gUartBHandle, pNmea, strlen(pNmea));
+    // Send a NAV-SAT in two halves
+    memset(body, 0x5a, sizeof(body));
+    x = uUbxProtocolEncode(0x01, 0x35, body, 8 + 12, buffer);
+    U_PORT_TEST_ASSERT(x == sizeof(buffer));
+    uPortUartWrite(gUartBHandle, buffer, x / 2);
+    uPortTaskBlock(100);
+    uPortUartWrite(gUartBHandle, buffer + (x / 2), x - (x / 2));
+    // A UBX-RXM-RAWX that is too big for the reader by default
+    // should be dropped without holding up what follows it
+    fakeGnssSendRawx();
+    navPvtFill(body);
+    fakeGnssSend(0x01, 0x07, body, sizeof(body));
+    U_PORT_TEST_ASSERT(waitForCount(&gPvtCount, 2));
+    U_PORT_TEST_ASSERT(waitForCount(&gNavCount, 3));
+    U_PORT_TEST_ASSERT(gSatCount == 1);
+    U_PORT_TEST_ASSERT(gRawxCount == 0);
+    U_PORT_TEST_ASSERT(gCallbackError == 0);
+
+    uPortLog("U_GNSS_MSG_TEST: request/response with the reader...\n");
+    U_PORT_TEST_ASSERT(uGnssCfgSetRate(gnssHandle, 100, 1) == 0);
+    U_PORT_TEST_ASSERT(gFakeGnssRateMs == 100);
+    rateMs = -1;
+    U_PORT_TEST_ASSERT(uGnssCfgGetRate(gnssHandle, &rateMs, &navigationCount) == 0);
+    U_PORT_TEST_ASSERT(rateMs == 100);
+
+    uPortLog("U_GNSS_MSG_TEST: unsubscribing from NAV-PVT...\n");
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, pvtHandle) == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, pvtHandle) < 0);
+    x = gNavCount;
+    fakeGnssSend(0x01, 0x07, body, sizeof(body));
+    U_PORT_TEST_ASSERT(waitForCount(&gNavCount, x + 1));
+    U_PORT_TEST_ASSERT(gPvtCount == 2);
+
+    uPortLog("U_GNSS_MSG_TEST: streamed position...\n");
+    gPosCount = 0;
+    gFakeGnssMsgRate = -1;
+    U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle, 200, posCallback) == 0);
+    U_PORT_TEST_ASSERT(uGnssPosGetStreamedStart(gnssHandle, 200, posCallback) < 0);
+    U_PORT_TEST_ASSERT(gFakeGnssRateMs == 200);
+    U_PORT_TEST_ASSERT(gFakeGnssMsgRate == 1);
+    for (size_t y = 0; y < 5; y++) {
+        fakeGnssSend(0x01, 0x07, body, sizeof(body));
+    }
+    U_PORT_TEST_ASSERT(waitForCount(&gPosCount, 5));
+    U_PORT_TEST_ASSERT(gLatitudeX1e7 == U_GNSS_MSG_TEST_LATITUDE_X1E7);
+    U_PORT_TEST_ASSERT(gLongitudeX1e7 == U_GNSS_MSG_TEST_LONGITUDE_X1E7);
+    U_PORT_TEST_ASSERT(gCallbackError == 0);
+    uGnssPosGetStreamedStop(gnssHandle);
+    U_PORT_TEST_ASSERT(gFakeGnssMsgRate == 0);
+    U_PORT_TEST_ASSERT(pInstance->posStreamedSubscription < 0);
+
+    uPortLog("U_GNSS_MSG_TEST: unsubscribing from everything...\n");
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, allHandle) == 0);
+    U_PORT_TEST_ASSERT(pInstance->pMsgReader == NULL);
+
+    uPortLog("U_GNSS_MSG_TEST: receiving a large UBX-RXM-RAWX...\n");
+    U_PORT_TEST_ASSERT(uGnssMsgGetBodyLengthMax(gnssHandle) ==
+                       U_GNSS_MAX_UBX_PROTOCOL_MESSAGE_BODY_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(uGnssMsgSetBodyLengthMax(gnssHandle, 0) < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgSetBodyLengthMax(gnssHandle, 0x10000) < 0);
+    U_PORT_TEST_ASSERT(uGnssMsgSetBodyLengthMax(gnssHandle,
+                                                U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES) == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgGetBodyLengthMax(gnssHandle) ==
+                       U_GNSS_MSG_TEST_RXM_RAWX_BODY_LENGTH_BYTES);
+    allHandle = uGnssMsgReceiveStart(gnssHandle, U_GNSS_MSG_ALL, U_GNSS_MSG_ALL,
+                                     allCallback, NULL);
+    U_PORT_TEST_ASSERT(allHandle >= 0);
+    fakeGnssSendRawx();
+    U_PORT_TEST_ASSERT(waitForCount(&gRawxCount, 1));
+    // Messages of ordinary size are still fine
+    x = gNavCount;
+    fakeGnssSend(0x01, 0x07, body, sizeof(body));
+    U_PORT_TEST_ASSERT(waitForCount(&gNavCount, x + 1));
+    U_PORT_TEST_ASSERT(gCallbackError == 0);
+    // And request/response still works
+    U_PORT_TEST_ASSERT(uGnssCfgGetRate(gnssHandle, &rateMs, &navigationCount) == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, allHandle) == 0);
+    U_PORT_TEST_ASSERT(pInstance->pMsgReader == NULL);
+    // Without the reader the decoder is back to its own storage
+    U_PORT_TEST_ASSERT(uGnssCfgGetRate(gnssHandle, &rateMs, &navigationCount) == 0);
+
+    // Start again and then let uGnssDeinit() clear up
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStart(gnssHandle, 0x01, 0x07, pvtCallback,
+                                            (void *) &gPvtCount) >= 0);
+    uGnssDeinit();
+
+    uPortUartEventCallbackRemove(gUartBHandle);
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+#ifndef __XTENSA__
+    // Check for memory leaks
+    // TODO: this if'ed out for ESP32 (xtensa compiler) at
+    // the moment as there is an issue with ESP32 hanging
+    // on to memory in the UART drivers that can't easily be
+    // accounted for.
+    heapUsed -= uPortGetHeapFree();
+    uPortLog("U_GNSS_MSG_TEST: we have leaked %d byte(s).\n", heapUsed);
+    // heapUsed < 0 for the Zephyr case where the heap can look
+    // like it increases (negative leak)
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+#else
+    (void) heapUsed;
+#endif
+}
+
+/** Clean-up to be run at the end of this round of tests, just
+ * in case there were test failures which would have resulted
+ * in the deinitialisation being skipped.
+ */
+U_PORT_TEST_FUNCTION("[gnssMsg]", "gnssMsgCleanUp")
+{
+    uGnssDeinit();
+    if (gUartBHandle >= 0) {
+        uPortUartEventCallbackRemove(gUartBHandle);
+        uPortUartClose(gUartBHandle);
+        gUartBHandle = -1;
+    }
+    if (gUartAHandle >= 0) {
+        uPortUartClose(gUartAHandle);
+        gUartAHandle = -1;
+    }
+    uPortDeinit();
+}
+#endif
+
+// End of file
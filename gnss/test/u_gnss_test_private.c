@@ -55,6 +55,8 @@
 #endif
 #include "u_cell_loc.h"  // For uCellLocGnssInsideCell()
 
+#include "u_ubx_protocol.h" // Required by u_gnss_private.h
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss_private.h"
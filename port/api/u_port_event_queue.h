@@ -178,7 +178,9 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
 
 /** Send to an event queue.  The data at pParam will be copied
  * onto the queue.  If the queue is full this function will block
- * until room is available.  An event queue should not be closed
+ * until room is available.  No memory is allocated: the space
+ * for queueLength parameter blocks of paramMaxLengthBytes is
+ * allocated by uPortEventQueueOpen().  An event queue should not be closed
  * while this function is in progress.
  *
  * @param handle            the handle for the event queue.
@@ -197,11 +199,9 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
 /** Send to an event queue from an interrupt.  The data at
  * pParam will be copied onto the queue.  If the queue is full
  * the event will not be sent and an error will be returned.
- * Note: you must ensure that your interrupt stack is large
- * enough to hold an array of size paramLengthBytes +
- * U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES. An event
- * queue should not be closed while this function is in
- * progress.
+ * No memory is allocated and nothing of significant size is
+ * placed on the stack. An event queue should not be closed
+ * while this function is in progress.
  *
  * @param handle            the handle for the event queue.
  * @param pParam            a pointer to the parameters structure
@@ -49,6 +49,14 @@ extern "C" {
  * TYPES
  * -------------------------------------------------------------- */
 
+/** One of the buffers of data to be sent by uPortUartWritev().
+ */
+typedef struct {
+    const void *pBuffer; /**< the data to send; may be NULL only if
+                              sizeBytes is zero. */
+    size_t sizeBytes;    /**< the number of bytes at pBuffer. */
+} uPortUartIoVec_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -170,6 +178,24 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes);
 
+/** Write several buffers to the given UART interface, one after
+ * the other, as a single transmit operation: this avoids having to
+ * copy e.g. a header, a body and a trailer into one buffer in order
+ * to send them together, and no other write to the UART can get
+ * between them.  Will block until all of the data has been written
+ * or an error has occurred.
+ *
+ * @param handle    the handle of the UART instance.
+ * @param pIoVec    a pointer to an array of count buffers to send;
+ *                  cannot be NULL.
+ * @param count     the number of entries at pIoVec; must be greater
+ *                  than zero.
+ * @return          the total number of bytes sent or negative
+ *                  error code.
+ */
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count);
+
 /** Set a callback to be called when a UART event occurs.
  * pFunction will be called asynchronously in its own task,
  * for which the stack size and priority can be specified.
@@ -59,6 +59,7 @@ LINT_DIRS = [os.path.join("common","network","src"),
              os.path.join("port","platform","common","test"),
              os.path.join("port","platform","common","runner"),
              os.path.join("common","utils","src"),
+             os.path.join("common","utils","test"),
              os.path.join("wifi","src"),
              os.path.join("wifi","test"),
              os.path.join("common","assert","src")]
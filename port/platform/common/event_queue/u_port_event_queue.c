@@ -24,6 +24,16 @@
  * protection) but, most importantly, means that no loop is required
  * to find a queue, ensuring the lowest possible latency so that
  * send-to-queue can safely be called from an interrupt.
+ *
+ * Design note: the parameter blocks are not put on the OS queue,
+ * they are copied into one of a fixed set of slots, allocated
+ * along with the event queue, and only the slot index and size
+ * travel on the OS queue.  The free slot indexes are kept on a
+ * second OS queue, so a sender blocks (or, from an interrupt,
+ * fails) when all slots are in use, just as it would were the
+ * OS queue full, and the send and receive paths involve no heap
+ * operations, hence the task and interrupt versions of send can
+ * be the same.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -61,7 +71,10 @@ typedef struct uEventQueue_t {
     void (*pFunction)(void *, size_t); /** The function to be called. */
     int32_t handle;            /** Handle for this event queue. */
     uPortQueueHandle_t queue; /** Handle for the OS queue. */
-    size_t paramMaxLengthBytes; /** Max length of an item on this OS queue. */
+    uPortQueueHandle_t freeSlotQueue; /** Handle for the OS queue of free slot indexes. */
+    char *pSlots; /** queueLength slots of paramMaxLengthBytes each, allocated
+                      with this structure. */
+    size_t paramMaxLengthBytes; /** Max length of a parameter block on this queue. */
     uPortTaskHandle_t task; /** Handle for the OS task. */
     uPortMutexHandle_t taskRunningMutex; /** Mutex to determine if task has exited. */
 } uEventQueue_t;
@@ -79,6 +92,14 @@ typedef enum {
     U_EVENT_CONTROL_EXIT_NOW = -1
 } uEventQueueControlOrSize_t;
 
+/** An item on the OS queue.
+ */
+typedef struct {
+    uEventQueueControlOrSize_t controlOrSize;
+    int32_t slot; /** The slot containing the parameter block,
+                      -1 if there is none. */
+} uEventQueueItem_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -101,10 +122,8 @@ static uEventQueue_t *gpEventQueue[U_PORT_EVENT_QUEUE_MAX_NUM];
 static void eventQueueTask(void *pParam)
 {
     uEventQueue_t *pEventQueue = (uEventQueue_t *) pParam;
-    char param[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES +
-                                                               U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES];
-    uEventQueueControlOrSize_t *pControlOrSize = (uEventQueueControlOrSize_t *)
-                                                 & (param[0]);
+    char param[U_PORT_EVENT_QUEUE_MAX_PARAM_LENGTH_BYTES];
+    uEventQueueItem_t item;
 
     U_PORT_MUTEX_LOCK(pEventQueue->taskRunningMutex);
 #if defined(__NEWLIB__) && defined(_REENT_SMALL) && \
@@ -121,20 +140,27 @@ static void eventQueueTask(void *pParam)
     uPortLog("");
 #endif
 
-    *pControlOrSize = U_EVENT_CONTROL_NONE;
+    item.controlOrSize = U_EVENT_CONTROL_NONE;
     // Continue until we're told to exit
-    while (*pControlOrSize != U_EVENT_CONTROL_EXIT_NOW) {
-        if (uPortQueueReceive(pEventQueue->queue, param) == 0) {
-            // If this is not a control message, call the
-            // user function with the parameter block,
-            // skipping the "control or size" word at the
-            // start and passing it in instead as the size
-            // parameter
-            if ((int32_t) *pControlOrSize >= 0) {
-                if ((int32_t) *pControlOrSize > 0) {
-                    pEventQueue->pFunction((void *) & (param[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES]),
+    while (item.controlOrSize != U_EVENT_CONTROL_EXIT_NOW) {
+        if (uPortQueueReceive(pEventQueue->queue, &item) == 0) {
+            // If this is not a control message, copy the
+            // parameter block out of its slot, give the
+            // slot back and call the user function with the
+            // parameter block and its size
+            if ((int32_t) item.controlOrSize >= 0) {
+                if (item.slot >= 0) {
+                    // Cast in two stages to keep Lint happy
+                    memcpy(param, pEventQueue->pSlots +
+                           (pEventQueue->paramMaxLengthBytes * (size_t) item.slot),
+                           (size_t) (int32_t) item.controlOrSize);
+                    // Can't block: there's always room for our slot
+                    uPortQueueSend(pEventQueue->freeSlotQueue, &(item.slot));
+                }
+                if ((int32_t) item.controlOrSize > 0) {
+                    pEventQueue->pFunction((void *) param,
                                            // Cast in two stages to keep Lint happy
-                                           (size_t) (int32_t) *pControlOrSize);
+                                           (size_t) (int32_t) item.controlOrSize);
                 } else {
                     pEventQueue->pFunction(NULL, 0);
                 }
@@ -164,14 +190,86 @@ static int32_t nextEventHandleGet()
     return handle;
 }
 
+// Create the OS queue of free slot indexes for an event queue
+// and fill it.
+static int32_t freeSlotQueueCreate(uEventQueue_t *pEventQueue,
+                                   size_t queueLength)
+{
+    int32_t errorCode;
+
+    errorCode = uPortQueueCreate(queueLength, sizeof(int32_t),
+                                 &(pEventQueue->freeSlotQueue));
+    for (int32_t x = 0; (errorCode == 0) && (x < (int32_t) queueLength); x++) {
+        errorCode = uPortQueueSend(pEventQueue->freeSlotQueue, &x);
+    }
+    if ((errorCode != 0) && (pEventQueue->freeSlotQueue != NULL)) {
+        uPortQueueDelete(pEventQueue->freeSlotQueue);
+    }
+
+    return errorCode;
+}
+
+// Send to an event queue, from a task or from an interrupt.
+// The mutex need not be locked since this may be called
+// from an interrupt.
+static int32_t eventQueueSend(uEventQueue_t *pEventQueue,
+                              const void *pParam,
+                              size_t paramLengthBytes,
+                              bool isIrq)
+{
+    int32_t errorCode = 0;
+    uEventQueueItem_t item;
+
+    item.controlOrSize = (uEventQueueControlOrSize_t) paramLengthBytes;
+    item.slot = -1;
+    if (paramLengthBytes > 0) {
+        // Get a free slot: this blocks (or, in the interrupt
+        // case, fails) if they are all in use
+        if (isIrq) {
+            errorCode = uPortQueueReceiveIrq(pEventQueue->freeSlotQueue,
+                                             &(item.slot));
+            if (errorCode == (int32_t) U_ERROR_COMMON_NOT_IMPLEMENTED) {
+                errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            }
+        } else {
+            errorCode = uPortQueueReceive(pEventQueue->freeSlotQueue,
+                                          &(item.slot));
+        }
+        if (errorCode == 0) {
+            memcpy(pEventQueue->pSlots +
+                   (pEventQueue->paramMaxLengthBytes * (size_t) item.slot),
+                   pParam, paramLengthBytes);
+        }
+    }
+
+    if (errorCode == 0) {
+        // Send it off
+        if (isIrq) {
+            errorCode = uPortQueueSendIrq(pEventQueue->queue, &item);
+        } else {
+            errorCode = uPortQueueSend(pEventQueue->queue, &item);
+        }
+        if ((errorCode != 0) && (item.slot >= 0)) {
+            // Give the slot back; there must be room for it
+            if (isIrq) {
+                uPortQueueSendIrq(pEventQueue->freeSlotQueue, &(item.slot));
+            } else {
+                uPortQueueSend(pEventQueue->freeSlotQueue, &(item.slot));
+            }
+        }
+    }
+
+    return errorCode;
+}
+
 // Close an event queue.
 // The mutex must be locked before this is called.
 static void eventQueueClose(uEventQueue_t *pEventQueue)
 {
-    uEventQueueControlOrSize_t control = U_EVENT_CONTROL_EXIT_NOW;
+    uEventQueueItem_t item = {U_EVENT_CONTROL_EXIT_NOW, -1};
 
     // Get the task to exit, persisting until it is done
-    while (uPortQueueSend(pEventQueue->queue, (void *) &control) != 0) {
+    while (uPortQueueSend(pEventQueue->queue, (void *) &item) != 0) {
         uPortTaskBlock(10);
     }
     U_PORT_MUTEX_LOCK(pEventQueue->taskRunningMutex);
@@ -179,6 +277,7 @@ static void eventQueueClose(uEventQueue_t *pEventQueue)
 
     // Tidy up
     uPortMutexDelete(pEventQueue->taskRunningMutex);
+    uPortQueueDelete(pEventQueue->freeSlotQueue);
     uPortQueueDelete(pEventQueue->queue);
 
     // Pause here to allow the deletions
@@ -294,16 +393,26 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
             // See if there's a free handle
             handle = nextEventHandleGet();
             if (handle >= 0) {
-                // Malloc a structure to represent the event queue
-                pEventQueue = (uEventQueue_t *) malloc(sizeof(uEventQueue_t));
+                // Malloc a structure to represent the event queue,
+                // with the slots for the parameter blocks on the end
+                pEventQueue = (uEventQueue_t *) malloc(sizeof(uEventQueue_t) +
+                                                       (queueLength * paramMaxLengthBytes));
                 if (pEventQueue != NULL) {
                     pEventQueue->pFunction = pFunction;
                     pEventQueue->paramMaxLengthBytes = paramMaxLengthBytes;
-                    // Create the queue
-                    handleOrError = (uErrorCode_t) uPortQueueCreate(queueLength,
-                                                                    paramMaxLengthBytes +
-                                                                    U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
-                                                                    &(pEventQueue->queue));
+                    pEventQueue->pSlots = (char *) (pEventQueue + 1);
+                    pEventQueue->freeSlotQueue = NULL;
+                    // Create the queue of free slots and the queue itself
+                    handleOrError = (uErrorCode_t) freeSlotQueueCreate(pEventQueue,
+                                                                       queueLength);
+                    if (handleOrError == U_ERROR_COMMON_SUCCESS) {
+                        handleOrError = (uErrorCode_t) uPortQueueCreate(queueLength,
+                                                                        sizeof(uEventQueueItem_t),
+                                                                        &(pEventQueue->queue));
+                        if (handleOrError != U_ERROR_COMMON_SUCCESS) {
+                            uPortQueueDelete(pEventQueue->freeSlotQueue);
+                        }
+                    }
                     if (handleOrError == U_ERROR_COMMON_SUCCESS) {
                         // Create the mutex for task running status
                         handleOrError = (uErrorCode_t) uPortMutexCreate(&(pEventQueue->taskRunningMutex));
@@ -332,19 +441,21 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
                                 handleOrError = (uErrorCode_t) handle;
                             } else {
                                 // Couldn't create the task, delete the
-                                // mutex and queue and free the structure
+                                // mutex and queues and free the structure
                                 uPortMutexDelete(pEventQueue->taskRunningMutex);
+                                uPortQueueDelete(pEventQueue->freeSlotQueue);
                                 uPortQueueDelete(pEventQueue->queue);
                                 free(pEventQueue);
                             }
                         } else {
-                            // Couldn't create the mutex, delete the queue
+                            // Couldn't create the mutex, delete the queues
                             // and free the structure
+                            uPortQueueDelete(pEventQueue->freeSlotQueue);
                             uPortQueueDelete(pEventQueue->queue);
                             free(pEventQueue);
                         }
                     } else {
-                        // Couldn't create the queue, free the structure
+                        // Couldn't create the queues, free the structure
                         free(pEventQueue);
                     }
                 }
@@ -363,8 +474,6 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
     uEventQueue_t *pEventQueue;
-    char *pBlock = NULL;
-    uPortQueueHandle_t queue = NULL;
 
     if (gMutex != NULL) {
 
@@ -372,29 +481,10 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
 
         errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
         pEventQueue = pEventQueueGet(handle);
-        if ((pEventQueue != NULL) &&
-            (paramLengthBytes <= pEventQueue->paramMaxLengthBytes) &&
-            ((pParam != NULL) || (paramLengthBytes == 0))) {
-            queue = pEventQueue->queue;
-            errorCode = U_ERROR_COMMON_NO_MEMORY;
-            // We need to add the control word to the start, so malloc
-            // a block that is paramLengthBytes plus the control
-            // word length
-            pBlock = (char *) malloc(paramLengthBytes +
-                                     U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
-            if (pBlock != NULL) {
-                // Copy in the control word, which is actually just
-                // the size in this case
-                //lint -e(826) Suppress area too small; the size of pBlock is always
-                // at least U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES in size
-                *((uEventQueueControlOrSize_t *) pBlock) = (uEventQueueControlOrSize_t) paramLengthBytes;
-                if (pParam != NULL) {
-                    // Copy in param
-                    //lint -e{826} Suppress pointed-to area too small, we make sure it is OK above
-                    memcpy(pBlock + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
-                           pParam, paramLengthBytes);
-                }
-            }
+        if ((pEventQueue == NULL) ||
+            (paramLengthBytes > pEventQueue->paramMaxLengthBytes) ||
+            ((pParam == NULL) && (paramLengthBytes > 0))) {
+            pEventQueue = NULL;
         }
 
         // We release the mutex before sending to the
@@ -403,13 +493,9 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
         // that to block the entire API
         U_PORT_MUTEX_UNLOCK(gMutex);
 
-        if (pBlock != NULL) {
-            if (queue != NULL) {
-                // Send it off
-                errorCode = (uErrorCode_t) uPortQueueSend(queue, pBlock);
-            }
-            // Free memory again
-            free(pBlock);
+        if (pEventQueue != NULL) {
+            errorCode = (uErrorCode_t) eventQueueSend(pEventQueue, pParam,
+                                                      paramLengthBytes, false);
         }
     }
 
@@ -420,11 +506,8 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
 int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
                                size_t paramLengthBytes)
 {
-#ifndef _WIN32
     uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
     uEventQueue_t *pEventQueue;
-    char block[paramLengthBytes +
-                                U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES];
 
     if (gMutex != NULL) {
         // Can't lock the mutex, we're in an interrupt.
@@ -433,35 +516,10 @@ int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
         if ((pEventQueue != NULL) &&
             (paramLengthBytes <= pEventQueue->paramMaxLengthBytes) &&
             ((pParam != NULL) || (paramLengthBytes == 0))) {
-            // Copy in the control word, which is actually just
-            // the size in this case
-            //lint -e(826) Suppress area too small; the size of pBlock is always
-            // at least U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES in size
-			uEventQueueControlOrSize_t *pControlOrSize = (uEventQueueControlOrSize_t *) block;
-            *pControlOrSize = (uEventQueueControlOrSize_t) paramLengthBytes;
-            if (pParam != NULL) {
-                // Copy in param
-                memcpy(block + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
-                       pParam, paramLengthBytes);
-            }
-            // Send it off
-            errorCode = (uErrorCode_t) uPortQueueSendIrq(pEventQueue->queue,
-                                                         block);
+            errorCode = (uErrorCode_t) eventQueueSend(pEventQueue, pParam,
+                                                      paramLengthBytes, true);
         }
     }
-#else
-    // It would have been nice to leave this function as-is for win32
-    // and just let uPortQueueSendIrq() return an error ('cos the IRQ
-    // functions are not supported for the Windows platform), however
-    // MSVC, which we use on Windows, doesn't support dynamically sized
-    // arrays and hence we'd need to switch to using a static buffer for
-    // block, which is entirely unnecessary.  Hence this compiler switch.
-    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_SUPPORTED;
-
-    (void) handle;
-    (void) pParam;
-    (void) paramLengthBytes;
-#endif
 
     return (int32_t) errorCode;
 }
@@ -39,6 +39,9 @@
 #include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
                                               before the other port files if
                                               any print or scan function is used. */
+#include "u_compiler.h" // U_WEAK
+#include "u_error_common.h"
+
 #include "u_port.h"
 #include "u_port_os.h"
 
@@ -84,6 +87,16 @@ static uRunnerFunctionDescription_t *gpFunctionList = NULL;
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The prefix passed to the runner function that is currently
+ * running, used when printing the results of a benchmark.
+ */
+static const char *gpPrefix = "";
+
+/** The time taken by each sample of the benchmark that is running;
+ * static so as not to disturb the heap.
+ */
+static int32_t gBenchmarkSampleUs[U_RUNNER_BENCHMARK_MAX_SAMPLES];
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -100,6 +113,7 @@ static void runFunction(const uRunnerFunctionDescription_t *pFunction,
     UNITY_PRINT_EOL();
     UNITY_OUTPUT_FLUSH();
 
+    gpPrefix = pPrefix;
     Unity.TestFile = pFunction->pFile;
     Unity.CurrentDetail1 = pFunction->pGroup;
     UnityDefaultTestRun(pFunction->pFunction,
@@ -275,6 +289,48 @@ bool nameInFilter(const char *pName, const char *pFilter)
     return inFilter;
 }
 
+// Sort an array of times into ascending order; the array is
+// small so an insertion sort will do.
+static void sortTimes(int32_t *pTimes, size_t count)
+{
+    int32_t x;
+    size_t y;
+
+    for (size_t z = 1; z < count; z++) {
+        x = pTimes[z];
+        for (y = z; (y > 0) && (pTimes[y - 1] > x); y--) {
+            pTimes[y] = pTimes[y - 1];
+        }
+        pTimes[y] = x;
+    }
+}
+
+// Print a named integer as a JSON member that follows another.
+static void printJsonInt(const char *pName, int64_t value)
+{
+    char buffer[24];
+    size_t x = sizeof(buffer) - 1;
+    bool negative = (value < 0);
+    uint64_t magnitude = negative ? (uint64_t) -value : (uint64_t) value;
+
+    // Done by hand as not all platforms can print 64-bit integers
+    buffer[x] = 0;
+    do {
+        x--;
+        buffer[x] = (char) ('0' + (magnitude % 10));
+        magnitude /= 10;
+    } while ((magnitude > 0) && (x > 1));
+    if (negative) {
+        x--;
+        buffer[x] = '-';
+    }
+
+    UnityPrint(",\"");
+    UnityPrint(pName);
+    UnityPrint("\":");
+    UnityPrint(buffer + x);
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -391,4 +447,132 @@ void uRunnerRunAll(const char *pPrefix)
     }
 }
 
+// Run a benchmark.
+int32_t uRunnerBenchmarkRun(const char *pName, size_t samples,
+                            pURunnerBenchmarkSetUp_t pSetUp,
+                            pURunnerBenchmarkSample_t pSample,
+                            pURunnerBenchmarkTearDown_t pTearDown,
+                            uRunnerBenchmarkResult_t *pResult)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uRunnerBenchmarkResult_t result;
+    void *pContext = NULL;
+    int32_t heapFreeStart;
+    int32_t heapMinFreeStart;
+    int32_t heapFreeLowest;
+    int32_t heapFree;
+    int64_t startTimeUs;
+    int64_t timeUs;
+    size_t x;
+
+    memset(&result, 0, sizeof(result));
+    result.bytesPerSecond = -1;
+    result.heapPeakBytes = -1;
+    result.stackMinFreeBytes = -1;
+
+    if ((pName != NULL) && (pSample != NULL) && (samples > 0) &&
+        (samples <= U_RUNNER_BENCHMARK_MAX_SAMPLES)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pSetUp != NULL) {
+            errorCode = pSetUp(&pContext);
+        }
+        if (errorCode == 0) {
+            for (x = 0; (x < U_RUNNER_BENCHMARK_WARM_UP_SAMPLES) &&
+                 (errorCode >= 0); x++) {
+                errorCode = pSample(pContext);
+            }
+            // uPortGetHeapMinFree() is used rather than calling the
+            // heap-check module (port/platform/common/heap_check)
+            // directly since that module is only linked on some
+            // platforms: on stm32cube and nrf5sdk uPortGetHeapMinFree()
+            // is uHeapCheckGetMinFree(), elsewhere it is the
+            // platform's own low-water mark
+            heapFreeStart = uPortGetHeapFree();
+            heapMinFreeStart = uPortGetHeapMinFree();
+            heapFreeLowest = heapFreeStart;
+            for (x = 0; (x < samples) && (errorCode >= 0); x++) {
+                startTimeUs = uRunnerBenchmarkTimeUs();
+                errorCode = pSample(pContext);
+                timeUs = uRunnerBenchmarkTimeUs() - startTimeUs;
+                heapFree = uPortGetHeapFree();
+                if (heapFree < heapFreeLowest) {
+                    heapFreeLowest = heapFree;
+                }
+                if (timeUs > INT32_MAX) {
+                    timeUs = INT32_MAX;
+                }
+                gBenchmarkSampleUs[x] = (int32_t) timeUs;
+                result.totalUs += timeUs;
+                if (errorCode > 0) {
+                    result.bytes += errorCode;
+                }
+            }
+            if (errorCode >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                result.samples = samples;
+                sortTimes(gBenchmarkSampleUs, samples);
+                result.minUs = gBenchmarkSampleUs[0];
+                result.medianUs = gBenchmarkSampleUs[samples / 2];
+                // The sample at or above which 1% of samples lie
+                result.p99Us = gBenchmarkSampleUs[((samples * 99) + 99) / 100 - 1];
+                if (result.totalUs > 0) {
+                    result.bytesPerSecond = (result.bytes * 1000000) / result.totalUs;
+                }
+                // If the samples lowered the heap low-water mark then
+                // that gives the peak exactly, else all that is known
+                // is the most heap that was held between samples
+                heapFree = uPortGetHeapMinFree();
+                if ((heapFreeStart >= 0) && (heapFree >= 0)) {
+                    if (heapFree < heapMinFreeStart) {
+                        result.heapPeakBytes = heapFreeStart - heapFree;
+                    } else {
+                        result.heapPeakBytes = heapFreeStart - heapFreeLowest;
+                    }
+                    if (result.heapPeakBytes < 0) {
+                        result.heapPeakBytes = 0;
+                    }
+                }
+                result.stackMinFreeBytes = uPortTaskStackMinFree(NULL);
+                if (result.stackMinFreeBytes < 0) {
+                    result.stackMinFreeBytes = -1;
+                }
+            }
+        }
+        if (pTearDown != NULL) {
+            pTearDown(pContext);
+        }
+
+        UnityPrint(gpPrefix);
+        UnityPrint(U_RUNNER_BENCHMARK_RESULT_TAG);
+        UnityPrint("{\"name\":\"");
+        UnityPrint(pName);
+        UnityPrint("\"");
+        printJsonInt("samples", (int64_t) result.samples);
+        printJsonInt("min_us", result.minUs);
+        printJsonInt("median_us", result.medianUs);
+        printJsonInt("p99_us", result.p99Us);
+        printJsonInt("total_us", result.totalUs);
+        printJsonInt("bytes", result.bytes);
+        printJsonInt("bytes_per_second", result.bytesPerSecond);
+        printJsonInt("heap_peak_bytes", result.heapPeakBytes);
+        printJsonInt("stack_min_free_bytes", result.stackMinFreeBytes);
+        printJsonInt("result", errorCode);
+        UnityPrint("}");
+        UNITY_PRINT_EOL();
+        UNITY_OUTPUT_FLUSH();
+    }
+
+    if (pResult != NULL) {
+        *pResult = result;
+    }
+
+    return errorCode;
+}
+
+// Get the time in microseconds: default implementation.
+U_WEAK int64_t uRunnerBenchmarkTimeUs(void)
+{
+    return uPortGetTickTimeMs() * 1000;
+}
+
 // End of file
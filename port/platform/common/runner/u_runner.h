@@ -54,6 +54,28 @@ extern "C" {
  */
 #define U_RUNNER_NAME_MAX_LENGTH_BYTES 64
 
+/** The maximum number of samples a benchmark may ask for (see
+ * U_RUNNER_BENCHMARK below); the timing of each sample is kept
+ * in a static array of this size so that the heap is not disturbed.
+ */
+#ifndef U_RUNNER_BENCHMARK_MAX_SAMPLES
+# define U_RUNNER_BENCHMARK_MAX_SAMPLES 100
+#endif
+
+/** The number of samples of a benchmark which are run, and
+ * discarded, before timing starts, to warm up caches, fill
+ * pools, etc.
+ */
+#ifndef U_RUNNER_BENCHMARK_WARM_UP_SAMPLES
+# define U_RUNNER_BENCHMARK_WARM_UP_SAMPLES 2
+#endif
+
+/** The string which begins the line of results printed for each
+ * benchmark; the remainder of the line is a JSON object, see
+ * uRunnerBenchmarkRun().
+ */
+#define U_RUNNER_BENCHMARK_RESULT_TAG "BENCHMARK: "
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -73,6 +95,48 @@ typedef struct uRunnerFunctionDescription_t {
     struct uRunnerFunctionDescription_t *pNext;
 } uRunnerFunctionDescription_t;
 
+/** Optional set-up function for a benchmark, run once before the
+ * benchmark is sampled, e.g. to bring up a network.  It may
+ * populate *ppContext, which is then passed to the sample and
+ * tear-down functions.  It should return zero on success else a
+ * negative error code, in which case the benchmark is failed
+ * without running any samples.
+ */
+typedef int32_t (*pURunnerBenchmarkSetUp_t)(void **ppContext);
+
+/** The function that performs one sample of a benchmark: it should
+ * return the number of bytes it processed (zero if that is not
+ * meaningful) or a negative error code, in which case the
+ * benchmark is failed.  If the platform offers only a millisecond
+ * tick (see uRunnerBenchmarkTimeUs()) then a sample should do
+ * enough work to take at least a few milliseconds.
+ */
+typedef int32_t (*pURunnerBenchmarkSample_t)(void *pContext);
+
+/** Optional tear-down function for a benchmark, run once after
+ * the benchmark has been sampled, even if it failed.
+ */
+typedef void (*pURunnerBenchmarkTearDown_t)(void *pContext);
+
+/** The results of a benchmark.
+ */
+typedef struct {
+    size_t samples;          /**< the number of samples timed. */
+    int32_t minUs;           /**< the quickest sample. */
+    int32_t medianUs;        /**< the median sample. */
+    int32_t p99Us;           /**< the 99th percentile sample. */
+    int64_t totalUs;         /**< the time taken by all samples. */
+    int64_t bytes;           /**< the bytes processed by all samples. */
+    int64_t bytesPerSecond;  /**< bytes divided by totalUs, -1 if totalUs is zero. */
+    int32_t heapPeakBytes;   /**< the peak heap used by the samples:
+                                  exact if the samples lowered the heap
+                                  low-water mark, else the most heap
+                                  held between samples, -1 if not known. */
+    int32_t stackMinFreeBytes; /**< the minimum free stack of the
+                                    task that ran the benchmark,
+                                    -1 if not known. */
+} uRunnerBenchmarkResult_t;
+
 /* ----------------------------------------------------------------
  * FUNCTION: REGISTRATION
  * -------------------------------------------------------------- */
@@ -187,6 +251,42 @@ public:
 # endif // __cplusplus
 #endif // _MSC_VER
 
+/** The function name prefix to use for all benchmarks.
+ */
+#ifndef U_RUNNER_PREFIX_BENCHMARK
+# define U_RUNNER_PREFIX_BENCHMARK benchmark
+#endif
+
+/** Macro to wrap the definition of the sample function of a
+ * benchmark, a pURunnerBenchmarkSample_t taking the parameter
+ * pContext.  A benchmark is registered as a function like any
+ * other, hence group and name must follow the same rules as
+ * for a test, and it can be selected in the same way; when it
+ * is run uRunnerBenchmarkRun() is called with the given number
+ * of samples (no more than U_RUNNER_BENCHMARK_MAX_SAMPLES) and
+ * the given pURunnerBenchmarkSetUp_t and pURunnerBenchmarkTearDown_t
+ * functions, either of which may be NULL; the function is failed
+ * if the benchmark fails.  For example:
+ *
+ * U_RUNNER_BENCHMARK("[thing]", "thingBenchmarkEncode", 50, NULL, NULL)
+ * {
+ *     (void) pContext;
+ *     return uThingEncode(gBuffer, sizeof(gBuffer));
+ * }
+ */
+#define U_RUNNER_BENCHMARK(group, name, samples, pSetUp, pTearDown)                                       \
+    /* Sample function prototype */                                                                       \
+    static int32_t U_RUNNER_NAME_UID(benchmarkSample)(void *pContext);                                    \
+    /* The registered function, which runs the benchmark */                                               \
+    U_RUNNER_FUNCTION(U_RUNNER_PREFIX_BENCHMARK, group, name)                                             \
+    {                                                                                                     \
+        U_PORT_UNITY_TEST_ASSERT(uRunnerBenchmarkRun(name, samples, pSetUp,                               \
+                                                     U_RUNNER_NAME_UID(benchmarkSample),                  \
+                                                     pTearDown, NULL) == 0);                              \
+    }                                                                                                     \
+    /* Actual start of the sample function */                                                             \
+    static int32_t U_RUNNER_NAME_UID(benchmarkSample)(void *pContext)
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -237,6 +337,50 @@ void uRunnerRunGroup(const char *pGroup,
  */
 void uRunnerRunAll(const char *pPrefix);
 
+/** Run a benchmark: this is called by the function that the
+ * U_RUNNER_BENCHMARK macro registers and would not normally be
+ * called directly.  pSetUp is called, pSample is called
+ * U_RUNNER_BENCHMARK_WARM_UP_SAMPLES times without being timed,
+ * then samples times, each one timed with uRunnerBenchmarkTimeUs(),
+ * then pTearDown is called.  The results are printed as a single
+ * line beginning with the prefix passed to the runner function
+ * that is running the benchmark followed by
+ * U_RUNNER_BENCHMARK_RESULT_TAG and then a JSON object, e.g.:
+ *
+ * U_APP: BENCHMARK: {"name":"thingBenchmarkEncode","samples":50,
+ * "min_us":120,"median_us":130,"p99_us":410,"total_us":7020,
+ * "bytes":51200,"bytes_per_second":7293447,"heap_peak_bytes":256,
+ * "stack_min_free_bytes":-1,"result":0}
+ *
+ * ...(all on one line), which automation may compare against a
+ * baseline.
+ *
+ * @param pName      the name of the benchmark.
+ * @param samples    the number of samples to time, 1 to
+ *                   U_RUNNER_BENCHMARK_MAX_SAMPLES.
+ * @param pSetUp     the set-up function, may be NULL.
+ * @param pSample    the sample function, cannot be NULL.
+ * @param pTearDown  the tear-down function, may be NULL.
+ * @param pResult    a place to put the results, may be NULL.
+ * @return           zero on success else negative error code,
+ *                   which may be one returned by pSetUp or
+ *                   pSample.
+ */
+int32_t uRunnerBenchmarkRun(const char *pName, size_t samples,
+                            pURunnerBenchmarkSetUp_t pSetUp,
+                            pURunnerBenchmarkSample_t pSample,
+                            pURunnerBenchmarkTearDown_t pTearDown,
+                            uRunnerBenchmarkResult_t *pResult);
+
+/** Get the time in microseconds, used to time the samples of a
+ * benchmark.  The default implementation, which is weakly linked,
+ * is based on uPortGetTickTimeMs(); a platform with a
+ * higher-resolution timer may provide its own implementation.
+ *
+ * @return a monotonic time in microseconds.
+ */
+int64_t uRunnerBenchmarkTimeUs(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,1020 @@
+#!/usr/bin/env python
+
+'''Scriptable u-blox module simulator on a pseudo-terminal.
+
+Stands in for a cellular (SARA-R5/SARA-R4), short-range (EDM) or
+GNSS (UBX/NMEA) module so that the ubxlib code on a host platform
+(e.g. Linux, with U_PORT_UART_x pointing at the pseudo-terminal)
+can be exercised, and its throughput and latency measured, without
+a module on the bench.  Behaviour is described by a JSON scenario
+file, see the README.md in this directory.'''
+
+import sys
+import os
+import re
+import json
+import time
+import heapq
+import select
+import signal
+import argparse
+import threading
+import tty
+
+# Prefix to put at the start of all prints
+PROMPT = "u_module_sim: "
+
+# EDM framing, see common/short_range/src/u_short_range_edm.c
+EDM_HEAD = 0xAA
+EDM_TAIL = 0x55
+EDM_MAX_SIZE = 0x0FFC
+EDM_TYPE_CONNECT_EVENT = 0x11
+EDM_TYPE_DISCONNECT_EVENT = 0x21
+EDM_TYPE_DATA_EVENT = 0x31
+EDM_TYPE_DATA_COMMAND = 0x36
+EDM_TYPE_AT_EVENT = 0x41
+EDM_TYPE_AT_REQUEST = 0x44
+EDM_TYPE_AT_RESPONSE = 0x45
+EDM_TYPE_START_EVENT = 0x71
+
+# UBX framing, see common/ubx_protocol
+UBX_SYNC_1 = 0xB5
+UBX_SYNC_2 = 0x62
+UBX_CLASS_CFG = 0x06
+UBX_CLASS_ACK = 0x05
+UBX_ID_ACK_ACK = 0x01
+UBX_CLASS_NAV = 0x01
+UBX_ID_NAV_PVT = 0x07
+UBX_CLASS_MON = 0x0A
+UBX_ID_MON_VER = 0x04
+
+# The default link: no delay beyond that of the baud rate
+DEFAULT_LINK = {"baud": 115200, "latency_ms": 0,
+                "burst_bytes": 0, "burst_gap_ms": 0}
+
+# The largest amount of socket data a module will deal with
+# in a single AT command, reported in response to AT+USOWR=?
+# and AT+USORD=?
+SOCKET_SEGMENT_SIZE_BYTES = 1024
+
+# The silence required either side of the "+++" escape
+# sequence that ends direct link mode (AT+USODL)
+DIRECT_LINK_GUARD_TIME_S = 1.0
+
+def log(text):
+    '''Print a line of log output'''
+    print(PROMPT + text, flush=True)
+
+def ubx_frame(message_class, message_id, body):
+    '''Encode a UBX message'''
+    frame = bytes([message_class, message_id,
+                   len(body) & 0xFF, len(body) >> 8]) + body
+    ck_a = 0
+    ck_b = 0
+    for byte in frame:
+        ck_a = (ck_a + byte) & 0xFF
+        ck_b = (ck_b + ck_a) & 0xFF
+    return bytes([UBX_SYNC_1, UBX_SYNC_2]) + frame + bytes([ck_a, ck_b])
+
+def nmea_sentence(body):
+    '''Add the $ and the checksum to an NMEA sentence body'''
+    checksum = 0
+    for character in body.encode():
+        checksum ^= character
+    return f"${body}*{checksum:02X}\r\n".encode()
+
+def edm_frame(message_type, payload):
+    '''Encode an EDM frame'''
+    length = len(payload) + 2
+    return bytes([EDM_HEAD, length >> 8, length & 0xFF,
+                  0x00, message_type]) + payload + bytes([EDM_TAIL])
+
+class Link():
+    '''The transmit side of the pseudo-terminal, shaping what is
+    sent according to the baud rate, latency and burstiness of
+    the scenario.  Everything is sent from a single thread, in
+    time order, so that a delayed response can't overtake
+    an earlier one.'''
+    def __init__(self, fd, settings):
+        self._fd = fd
+        self._baud = settings.get("baud", DEFAULT_LINK["baud"])
+        self._latency = settings.get("latency_ms", DEFAULT_LINK["latency_ms"]) / 1000
+        self._burst_bytes = settings.get("burst_bytes", DEFAULT_LINK["burst_bytes"])
+        self._burst_gap = settings.get("burst_gap_ms", DEFAULT_LINK["burst_gap_ms"]) / 1000
+        self._queue = []
+        self._sequence = 0
+        self._condition = threading.Condition()
+        self._running = True
+        self.bytes_sent = 0
+        self._thread = threading.Thread(target=self._task, daemon=True)
+        self._thread.start()
+
+    def send(self, data, delay_ms=0, add_latency=True):
+        '''Queue data to be sent after delay_ms plus, if
+        add_latency is True, the latency of the link'''
+        due = time.monotonic() + delay_ms / 1000
+        if add_latency:
+            due += self._latency
+        with self._condition:
+            # Keep the order of things due at the same time
+            heapq.heappush(self._queue, (due, self._sequence, data))
+            self._sequence += 1
+            self._condition.notify()
+
+    def stop(self):
+        '''Stop the transmit thread'''
+        with self._condition:
+            self._running = False
+            self._condition.notify()
+        self._thread.join()
+
+    def _write_chunk(self, chunk):
+        '''Write a chunk to the pseudo-terminal, giving up if nothing
+        has read from the other end for a while: the data is then lost,
+        as it would be on a real UART'''
+        while chunk:
+            try:
+                chunk = chunk[os.write(self._fd, chunk):]
+            except BlockingIOError:
+                _, writable, _ = select.select([], [self._fd], [], 1)
+                if not writable:
+                    break
+            except OSError:
+                break
+
+    def _write(self, data):
+        '''Write data at the baud rate, in bursts if required'''
+        chunk_size = len(data)
+        if 0 < self._burst_bytes < chunk_size:
+            chunk_size = self._burst_bytes
+        offset = 0
+        while offset < len(data):
+            chunk = data[offset:offset + chunk_size]
+            self._write_chunk(chunk)
+            self.bytes_sent += len(chunk)
+            offset += len(chunk)
+            # Ten bits per byte on the wire
+            if self._baud > 0:
+                time.sleep(len(chunk) * 10 / self._baud)
+            if (self._burst_gap > 0) and (offset < len(data)):
+                time.sleep(self._burst_gap)
+
+    def _task(self):
+        '''The transmit thread'''
+        while True:
+            with self._condition:
+                while self._running and (not self._queue or
+                                         self._queue[0][0] > time.monotonic()):
+                    timeout = None
+                    if self._queue:
+                        timeout = self._queue[0][0] - time.monotonic()
+                    self._condition.wait(timeout)
+                if not self._running:
+                    break
+                _, _, data = heapq.heappop(self._queue)
+            self._write(data)
+
+class Sockets():
+    '''Sockets of a cellular module with, on the far side, an echo
+    server: everything sent is received back again'''
+    def __init__(self, engine):
+        self._engine = engine
+        self._sockets = {}
+        self.hex_mode = False
+        self.total_sent = 0
+        self.total_received = 0
+
+    def create(self, protocol):
+        '''AT+USOCR'''
+        for handle in range(7):
+            if handle not in self._sockets:
+                self._sockets[handle] = {"udp": protocol == 17, "rx": bytearray(),
+                                         "datagrams": [], "remote": ("0.0.0.0", 0),
+                                         "sent": 0, "received": 0, "options": {}}
+                return handle
+        return None
+
+    def close(self, handle):
+        '''AT+USOCL'''
+        return self._sockets.pop(handle, None) is not None
+
+    def connect(self, handle, address, port):
+        '''AT+USOCO'''
+        if handle in self._sockets:
+            self._sockets[handle]["remote"] = (address, port)
+            return True
+        return False
+
+    def exists(self, handle):
+        '''True if the socket exists'''
+        return handle in self._sockets
+
+    def is_udp(self, handle):
+        '''True if the socket is a UDP one'''
+        return self._sockets[handle]["udp"]
+
+    def control(self, handle, operation):
+        '''AT+USOCTL: returns the value of the given
+        operation or None if it is not supported'''
+        socket = self._sockets[handle]
+        values = {0: 17 if socket["udp"] else 6,   # Protocol
+                  1: 0,                            # Last error
+                  2: socket["sent"],               # Bytes sent
+                  3: socket["received"],           # Bytes received
+                  10: 4,                           # TCP state: established
+                  11: 0}                           # Bytes un-acknowledged
+        return values.get(operation)
+
+    def option_set(self, handle, level, option, value):
+        '''AT+USOSO'''
+        self._sockets[handle]["options"][(level, option)] = value
+
+    def option_get(self, handle, level, option):
+        '''AT+USOGO: returns the value, 0 if never set'''
+        return self._sockets[handle]["options"].get((level, option), "0")
+
+    def echo(self, handle, data, remote=None):
+        '''The echo server has received data, send it back'''
+        socket = self._sockets.get(handle)
+        if socket is not None:
+            socket["sent"] += len(data)
+            self.total_sent += len(data)
+            if socket["udp"]:
+                socket["datagrams"].append((remote or socket["remote"], bytes(data)))
+                pending = len(socket["datagrams"][0][1])
+                self._engine.urc(f"+UUSORF: {handle},{pending}")
+            else:
+                socket["rx"] += data
+                self._engine.urc(f"+UUSORD: {handle},{len(socket['rx'])}")
+
+    def direct_link(self, handle, data):
+        '''Data sent in direct link mode: the echo comes
+        straight back, returned here, with no URC'''
+        socket = self._sockets.get(handle)
+        if socket is None:
+            return b""
+        socket["sent"] += len(data)
+        socket["received"] += len(data)
+        self.total_sent += len(data)
+        self.total_received += len(data)
+        return data
+
+    def encode(self, data):
+        '''Encode data for a +USORD/+USORF response'''
+        if self.hex_mode:
+            return b'"' + data.hex().upper().encode() + b'"'
+        return b'"' + data + b'"'
+
+    def decode(self, text):
+        '''Decode a hex string from AT+USOWR/AT+USOST'''
+        return bytes.fromhex(text)
+
+    def read(self, handle, length):
+        '''AT+USORD: return the pending length if length is 0,
+        else the data'''
+        socket = self._sockets[handle]
+        if length == 0:
+            return len(socket["rx"]), None
+        data = bytes(socket["rx"][:length])
+        del socket["rx"][:length]
+        socket["received"] += len(data)
+        self.total_received += len(data)
+        return len(data), data
+
+    def read_from(self, handle, length):
+        '''AT+USORF: as read() but with the remote address of
+        the datagram'''
+        socket = self._sockets[handle]
+        if not socket["datagrams"]:
+            return 0, None, None
+        remote, datagram = socket["datagrams"][0]
+        if length == 0:
+            return len(datagram), None, remote
+        socket["datagrams"].pop(0)
+        socket["received"] += len(datagram[:length])
+        self.total_received += len(datagram[:length])
+        # Whatever doesn't fit is lost, as with a real UDP socket
+        return len(datagram[:length]), datagram[:length], remote
+
+class Mqtt():
+    '''The MQTT client of a cellular module, SARA-R5 style, talking
+    to a broker which delivers back to us anything we publish on a
+    topic we have subscribed to'''
+    def __init__(self, engine):
+        self._engine = engine
+        self._connected = False
+        self._subscriptions = {}
+        self._messages = []
+
+    def _matches(self, topic):
+        '''Return the QoS of the subscription matching topic, or None'''
+        for pattern, qos in self._subscriptions.items():
+            expression = "^" + re.escape(pattern).replace(r"\+", "[^/]+") \
+                                                 .replace(r"\#", ".*") + "$"
+            if re.match(expression, topic):
+                return qos
+        return None
+
+    def command(self, parameters):
+        '''AT+UMQTTC: returns the information response lines'''
+        operation = int(parameters[0])
+        lines = []
+        if operation == 0:
+            self._connected = False
+            lines.append("+UMQTTC: 0,1")
+            self._engine.urc("+UUMQTTC: 0,1")
+        elif operation == 1:
+            self._connected = True
+            lines.append("+UMQTTC: 1,1")
+            self._engine.urc("+UUMQTTC: 1,1")
+        elif operation in (2, 9):
+            lines.append(f"+UMQTTC: {operation},1")
+            self._engine.urc(f"+UUMQTTC: {operation},1")
+        elif operation == 4:
+            topic = parameters[2].strip('"')
+            self._subscriptions[topic] = int(parameters[1])
+            lines.append("+UMQTTC: 4,1")
+            self._engine.urc(f"+UUMQTTC: 4,1,{parameters[1]},\"{topic}\"")
+        elif operation == 5:
+            self._subscriptions.pop(parameters[1].strip('"'), None)
+            lines.append("+UMQTTC: 5,1")
+            self._engine.urc("+UUMQTTC: 5,1")
+        elif operation == 6:
+            if self._messages:
+                topic, message, qos = self._messages.pop(0)
+                lines.append(f"+UMQTTC: 6,{qos},{len(topic) + len(message)},"
+                             f"{len(topic)},\"{topic}\",{len(message)},\"".encode() +
+                             message + b'"')
+            else:
+                return None
+        return lines
+
+    def publish(self, topic, message):
+        '''Deliver a published message back if it matches a
+        subscription'''
+        qos = self._matches(topic)
+        if self._connected and qos is not None:
+            self._messages.append((topic, message, qos))
+            self._engine.urc(f"+UUMQTTC: 6,{len(self._messages)}")
+
+class AtEngine():
+    '''The AT command interpreter: scenario rules first, then the
+    built-in models of the stateful parts of a module (sockets,
+    MQTT, EDM), then a plain "OK"'''
+    def __init__(self, scenario, link, start_time):
+        self._rules = []
+        for rule in scenario.get("rules", []):
+            self._rules.append((re.compile(rule["command"]), rule))
+        self._state = dict(scenario.get("state", {}))
+        self._link = link
+        self._start_time = start_time
+        self._echo = scenario.get("echo", False)
+        self._line = bytearray()
+        self._binary_length = 0
+        self._binary_data = bytearray()
+        self._binary_done = None
+        self._edm = None
+        self._edm_enabled = scenario.get("edm", False)
+        self._peers = {}
+        self._deferred_urcs = None
+        self._direct_link = None
+        self._direct_link_last_time = 0
+        self._escape_timer = None
+        self.sockets = Sockets(self)
+        self.mqtt = Mqtt(self)
+        self.commands = 0
+
+    def _send_lines(self, lines, final, delay_ms=0):
+        '''Send the information response lines and final result code
+        of an AT command'''
+        out = b""
+        for line in lines:
+            if isinstance(line, str):
+                line = line.encode()
+            out += b"\r\n" + line + b"\r\n"
+        if final:
+            out += b"\r\n" + final.encode() + b"\r\n"
+        if self._edm is not None:
+            out = edm_frame(EDM_TYPE_AT_RESPONSE, out)
+        self._link.send(out, delay_ms)
+
+    def urc(self, text, delay_ms=0):
+        '''Send an unsolicited result code; one raised while a
+        command is being handled follows the response to it'''
+        if self._deferred_urcs is not None:
+            self._deferred_urcs.append((text, delay_ms))
+            return
+        out = b"\r\n" + text.encode() + b"\r\n"
+        if self._edm is not None:
+            out = edm_frame(EDM_TYPE_AT_EVENT, out)
+        self._link.send(out, delay_ms)
+
+    def receive(self, data):
+        '''Process data received from the host'''
+        if self._edm is not None:
+            self._edm.receive(data)
+            return
+        if self._direct_link is not None:
+            self._direct_link_receive(data)
+            return
+        index = 0
+        while index < len(data):
+            if self._binary_length > 0:
+                # Collecting the binary part of a command
+                take = min(self._binary_length, len(data) - index)
+                self._binary_data += data[index:index + take]
+                self._binary_length -= take
+                index += take
+                if self._binary_length == 0:
+                    self._handle(self._binary_done, bytes(self._binary_data))
+                continue
+            byte = data[index]
+            index += 1
+            if self._echo:
+                self._link.send(bytes([byte]), add_latency=False)
+            if byte == 0x0D:
+                line = self._line.decode(errors="replace").strip()
+                self._line = bytearray()
+                if line:
+                    self.command(line)
+                if self._direct_link is not None:
+                    # The rest is socket data
+                    self._direct_link_receive(data[index:])
+                    return
+            elif byte != 0x0A:
+                self._line.append(byte)
+
+    def _direct_link_receive(self, data):
+        '''Data received in direct link mode goes to the socket,
+        unless it is a "+++" with silence either side of it'''
+        now = time.monotonic()
+        if self._escape_timer is not None:
+            # More data too soon: not an escape sequence after all
+            self._escape_timer.cancel()
+            self._escape_timer = None
+            data = b"+++" + data
+        elif (data == b"+++") and (now - self._direct_link_last_time >=
+                                   DIRECT_LINK_GUARD_TIME_S):
+            self._escape_timer = threading.Timer(DIRECT_LINK_GUARD_TIME_S,
+                                                 self._direct_link_escape)
+            self._escape_timer.start()
+            data = b""
+        self._direct_link_last_time = now
+        if data:
+            self._link.send(self.sockets.direct_link(self._direct_link, data))
+
+    def _direct_link_escape(self):
+        '''The escape sequence has been received: back to command mode'''
+        self._escape_timer = None
+        self._direct_link = None
+        self._send_lines([], "DISCONNECT")
+
+    def _wait_binary(self, length, prompt, done):
+        '''Send the prompt for, and then collect, length bytes of
+        binary data, calling done() with them'''
+        self._binary_length = length
+        self._binary_data = bytearray()
+        self._binary_done = done
+        self._link.send(prompt.encode())
+
+    def _handle(self, handler, argument):
+        '''Call a command handler, sending any URCs it raises
+        after its response'''
+        self._deferred_urcs = []
+        try:
+            handler(argument)
+        finally:
+            urcs = self._deferred_urcs
+            self._deferred_urcs = None
+            for text, delay_ms in urcs:
+                self.urc(text, delay_ms)
+
+    def command(self, line):
+        '''Process a complete AT command line'''
+        self.commands += 1
+        self._handle(self._command, line)
+
+    def _command(self, line):
+        '''Find what should respond to an AT command line'''
+        for expression, rule in self._rules:
+            match = expression.fullmatch(line)
+            if match and all(self._state.get(key) == value
+                             for key, value in rule.get("state", {}).items()):
+                self._apply_rule(match, rule)
+                return
+        if not self._builtin(line):
+            self._send_lines([], "OK")
+
+    def _apply_rule(self, match, rule):
+        '''Respond to a command as a scenario rule says'''
+        self._state.update(rule.get("set", {}))
+        lines = [match.expand(line) for line in rule.get("response", [])]
+        self._send_lines(lines, rule.get("final", "OK"), rule.get("delay_ms", 0))
+        for urc in rule.get("urcs", []):
+            self.urc(match.expand(urc["text"]),
+                     rule.get("delay_ms", 0) + urc.get("delay_ms", 0))
+
+    def _builtin(self, line):
+        '''The built-in command models: returns True if the
+        command was handled'''
+        upper = line.upper()
+        for prefix, handler in ((r"AT\+USOCR=", self._usocr),
+                                (r"AT\+USOCO=", self._usoco),
+                                (r"AT\+USOCL=", self._usocl),
+                                (r"AT\+USOWR=\?", self._segment_size),
+                                (r"AT\+USORD=\?", self._segment_size),
+                                (r"AT\+USOWR=", self._usowr),
+                                (r"AT\+USOST=", self._usost),
+                                (r"AT\+USORD=", self._usord),
+                                (r"AT\+USORF=", self._usorf),
+                                (r"AT\+USOER", self._usoer),
+                                (r"AT\+USOCTL=", self._usoctl),
+                                (r"AT\+USOSO=", self._usoso),
+                                (r"AT\+USOGO=", self._usogo),
+                                (r"AT\+USODL=", self._usodl),
+                                (r"AT\+UDCONF=1,", self._udconf_hex),
+                                (r"AT\+UGCNTRD", self._ugcntrd),
+                                (r"AT\+UGCNTSET=", self._ugcntset),
+                                (r"AT\+UMQTTC=", self._umqttc),
+                                (r"AT\+UMQTT=", self._umqtt),
+                                (r"ATO2", self._ato2),
+                                (r"AT\+UDCP=", self._udcp),
+                                (r"AT\+UDCPC=", self._udcpc)):
+            if re.match(prefix, upper):
+                parameters = split_parameters(line[line.find("=") + 1:])
+                handler(parameters, line)
+                return True
+        return False
+
+    # pylint: disable=unused-argument
+    def _usocr(self, parameters, line):
+        handle = self.sockets.create(int(parameters[0]))
+        if handle is None:
+            self._send_lines([], "ERROR")
+        else:
+            self._send_lines([f"+USOCR: {handle}"], "OK")
+
+    def _usoco(self, parameters, line):
+        ok = self.sockets.connect(int(parameters[0]), parameters[1].strip('"'),
+                                  int(parameters[2]))
+        self._send_lines([], "OK" if ok else "ERROR")
+
+    def _usocl(self, parameters, line):
+        self._send_lines([], "OK" if self.sockets.close(int(parameters[0])) else "ERROR")
+
+    def _usoer(self, parameters, line):
+        self._send_lines(["+USOER: 0"], "OK")
+
+    def _usoctl(self, parameters, line):
+        handle = int(parameters[0])
+        value = None
+        if self.sockets.exists(handle):
+            value = self.sockets.control(handle, int(parameters[1]))
+        if value is None:
+            self._send_lines([], "ERROR")
+        else:
+            self._send_lines([f"+USOCTL: {handle},{parameters[1]},{value}"], "OK")
+
+    def _usoso(self, parameters, line):
+        handle = int(parameters[0])
+        if self.sockets.exists(handle) and len(parameters) > 3:
+            self.sockets.option_set(handle, parameters[1], parameters[2],
+                                    ",".join(parameters[3:]))
+            self._send_lines([], "OK")
+        else:
+            self._send_lines([], "ERROR")
+
+    def _usogo(self, parameters, line):
+        handle = int(parameters[0])
+        if self.sockets.exists(handle) and len(parameters) > 2:
+            value = self.sockets.option_get(handle, parameters[1], parameters[2])
+            self._send_lines([f"+USOGO: {value}"], "OK")
+        else:
+            self._send_lines([], "ERROR")
+
+    def _usodl(self, parameters, line):
+        handle = int(parameters[0])
+        if not self.sockets.exists(handle) or self.sockets.is_udp(handle):
+            self._send_lines([], "ERROR")
+            return
+        self._direct_link = handle
+        self._direct_link_last_time = time.monotonic()
+        # Anything waiting to be read follows straight away, in
+        # the same write, as if the server had sent it the moment
+        # the link was up
+        _, data = self.sockets.read(handle, SOCKET_SEGMENT_SIZE_BYTES * 64)
+        self._link.send(b"\r\nCONNECT\r\n" + (data or b""))
+
+    def _ugcntrd(self, parameters, line):
+        sent = self.sockets.total_sent
+        received = self.sockets.total_received
+        self._send_lines([f"+UGCNTRD: 1,{sent},{received},{sent},{received}"], "OK")
+
+    def _ugcntset(self, parameters, line):
+        self.sockets.total_sent = 0
+        self.sockets.total_received = 0
+        self._send_lines([], "OK")
+
+    def _segment_size(self, parameters, line):
+        self._send_lines([f"{line[2:8]}: (0-6),(1-{SOCKET_SEGMENT_SIZE_BYTES})"], "OK")
+
+    def _udconf_hex(self, parameters, line):
+        if len(parameters) > 1:
+            self.sockets.hex_mode = parameters[1] == "1"
+            self._send_lines([], "OK")
+        else:
+            self._send_lines([f"+UDCONF: 1,{int(self.sockets.hex_mode)}"], "OK")
+
+    def _usowr(self, parameters, line):
+        handle = int(parameters[0])
+        length = int(parameters[1])
+        if not self.sockets.exists(handle) or length > SOCKET_SEGMENT_SIZE_BYTES:
+            self._send_lines([], "ERROR")
+        elif len(parameters) > 2:
+            self._sent(handle, self.sockets.decode(parameters[2].strip('"')))
+        else:
+            self._wait_binary(length, "@", lambda data: self._sent(handle, data))
+
+    def _sent(self, handle, data, remote=None):
+        '''Socket data has been sent'''
+        command = "+USOST" if remote else "+USOWR"
+        self._send_lines([f"{command}: {handle},{len(data)}"], "OK")
+        self.sockets.echo(handle, data, remote)
+
+    def _usost(self, parameters, line):
+        handle = int(parameters[0])
+        remote = (parameters[1].strip('"'), int(parameters[2]))
+        length = int(parameters[3])
+        if not self.sockets.exists(handle) or length > SOCKET_SEGMENT_SIZE_BYTES:
+            self._send_lines([], "ERROR")
+        elif len(parameters) > 4:
+            self._sent(handle, self.sockets.decode(parameters[4].strip('"')), remote)
+        else:
+            self._wait_binary(length, "@", lambda data: self._sent(handle, data, remote))
+
+    def _usord(self, parameters, line):
+        handle = int(parameters[0])
+        if not self.sockets.exists(handle):
+            self._send_lines([], "ERROR")
+            return
+        length, data = self.sockets.read(handle, int(parameters[1]))
+        if data is None:
+            self._send_lines([f"+USORD: {handle},{length}"], "OK")
+        else:
+            self._send_lines([f"+USORD: {handle},{length},".encode() +
+                              self.sockets.encode(data)], "OK")
+
+    def _usorf(self, parameters, line):
+        handle = int(parameters[0])
+        if not self.sockets.exists(handle):
+            self._send_lines([], "ERROR")
+            return
+        length, data, remote = self.sockets.read_from(handle, int(parameters[1]))
+        if data is None:
+            self._send_lines([f"+USORF: {handle},{length}"], "OK")
+        else:
+            self._send_lines([f"+USORF: {handle},\"{remote[0]}\",{remote[1]},{length},".encode() +
+                              self.sockets.encode(data)], "OK")
+
+    def _umqtt(self, parameters, line):
+        self._send_lines([f"+UMQTT: {parameters[0]},1"], "OK")
+
+    def _umqttc(self, parameters, line):
+        operation = int(parameters[0])
+        if operation == 9:
+            # Binary publish: topic then length, then the prompt
+            topic = parameters[3].strip('"')
+            self._wait_binary(int(parameters[4]), ">",
+                              lambda data: self._published(parameters, topic, data))
+            return
+        lines = self.mqtt.command(parameters)
+        if lines is None:
+            self._send_lines([], "ERROR")
+            return
+        self._send_lines(lines, "OK")
+        if operation == 2:
+            # Topic then an ASCII (0) or hex (1) message
+            message = parameters[5].strip('"')
+            if parameters[3] == "1":
+                message = bytes.fromhex(message)
+            else:
+                message = message.encode()
+            self.mqtt.publish(parameters[4].strip('"'), message)
+
+    def _published(self, parameters, topic, data):
+        '''A binary MQTT publish has been received'''
+        self._send_lines(self.mqtt.command(parameters), "OK")
+        self.mqtt.publish(topic, data)
+
+    def _ato2(self, parameters, line):
+        if not self._edm_enabled:
+            self._send_lines([], "ERROR")
+            return
+        self._send_lines([], "OK")
+        # From here on everything is framed
+        self._edm = EdmEngine(self, self._link)
+        self._link.send(edm_frame(EDM_TYPE_START_EVENT, b""))
+
+    def _udcp(self, parameters, line):
+        match = re.match(r"(\w+)://([^:/]+):(\d+)", line[line.find("=") + 1:])
+        if not match:
+            self._send_lines([], "ERROR")
+            return
+        peer = len(self._peers)
+        while peer in self._peers:
+            peer += 1
+        protocol = 1 if match.group(1).lower() == "udp" else 0
+        remote = match.group(2)
+        port = int(match.group(3))
+        self._peers[peer] = (protocol, remote, port)
+        self._send_lines([f"+UDCP:{peer}"], "OK")
+        self.urc(f"+UUDPC:{peer},2,{protocol},192.168.0.40,54282,{remote},{port}")
+        if self._edm is not None:
+            payload = bytes([peer, 0x02, protocol])
+            payload += bytes(int(x) for x in remote.split(".")) + port.to_bytes(2, "big")
+            payload += bytes([192, 168, 0, 40]) + (54282).to_bytes(2, "big")
+            self._link.send(edm_frame(EDM_TYPE_CONNECT_EVENT, payload))
+
+    def _udcpc(self, parameters, line):
+        peer = int(parameters[0])
+        if self._peers.pop(peer, None) is None:
+            self._send_lines([], "ERROR")
+            return
+        self._send_lines([], "OK")
+        self.urc(f"+UUDPD:{peer}")
+        if self._edm is not None:
+            self._link.send(edm_frame(EDM_TYPE_DISCONNECT_EVENT, bytes([peer])))
+    # pylint: enable=unused-argument
+
+    def edm_data(self, channel, data):
+        '''Data has arrived in an EDM data command: the peer is an
+        echo server'''
+        if channel in self._peers:
+            self._link.send(edm_frame(EDM_TYPE_DATA_EVENT, bytes([channel]) + data))
+
+    def timed_urcs(self, urcs, stop_event):
+        '''Send the timed URCs of the scenario, e.g. for PSM'''
+        events = []
+        for urc in urcs:
+            due = self._start_time + urc.get("at_ms", 0) / 1000
+            heapq.heappush(events, (due, id(urc), urc, urc.get("count", 1)))
+        while events and not stop_event.is_set():
+            due, key, urc, count = heapq.heappop(events)
+            if stop_event.wait(max(0, due - time.monotonic())):
+                break
+            self.urc(urc["text"])
+            count -= 1
+            if (count != 0) and (urc.get("every_ms", 0) > 0):
+                heapq.heappush(events, (due + urc["every_ms"] / 1000, key, urc, count))
+
+class EdmEngine():
+    '''Extended Data Mode: AT requests, responses and events
+    and data framed'''
+    def __init__(self, at_engine, link):
+        self._at = at_engine
+        self._link = link
+        self._buffer = bytearray()
+        self.frames = 0
+
+    def receive(self, data):
+        '''Decode EDM frames from data received from the host'''
+        self._buffer += data
+        while True:
+            start = self._buffer.find(bytes([EDM_HEAD]))
+            if start < 0:
+                self._buffer.clear()
+                return
+            del self._buffer[:start]
+            if len(self._buffer) < 3:
+                return
+            length = (self._buffer[1] << 8) | self._buffer[2]
+            if (length < 2) or (length > EDM_MAX_SIZE):
+                # Not a frame, resync
+                del self._buffer[:1]
+                continue
+            if len(self._buffer) < length + 4:
+                return
+            if self._buffer[length + 3] != EDM_TAIL:
+                del self._buffer[:1]
+                continue
+            payload = bytes(self._buffer[3:length + 3])
+            del self._buffer[:length + 4]
+            self.frames += 1
+            self._frame(payload)
+
+    def _frame(self, payload):
+        '''Act on a complete EDM frame'''
+        message_type = ((payload[0] << 8) | payload[1]) & 0x0FFF
+        if message_type == EDM_TYPE_AT_REQUEST:
+            line = payload[2:].decode(errors="replace").strip()
+            if line:
+                self._at.command(line)
+        elif message_type == EDM_TYPE_DATA_COMMAND and len(payload) > 3:
+            self._at.edm_data(payload[2], payload[3:])
+
+class GnssEngine():
+    '''A GNSS receiver: a periodic NMEA and/or UBX NAV-PVT stream
+    plus responses to UBX messages from the host'''
+    def __init__(self, scenario, link):
+        settings = scenario.get("gnss", {})
+        self._link = link
+        self._rate = settings.get("rate_ms", 1000) / 1000
+        self._nmea = settings.get("nmea", True)
+        self._nav_pvt = settings.get("nav_pvt", True)
+        self._latitude = settings.get("latitude", 52.2)
+        self._longitude = settings.get("longitude", 0.13)
+        self._responses = {}
+        for response in settings.get("responses", []):
+            key = (response["class"], response["id"])
+            self._responses[key] = bytes.fromhex(response.get("body", ""))
+        self._buffer = bytearray()
+        self.messages = 0
+
+    def receive(self, data):
+        '''Decode UBX messages from data received from the host'''
+        self._buffer += data
+        while True:
+            start = self._buffer.find(bytes([UBX_SYNC_1, UBX_SYNC_2]))
+            if start < 0:
+                del self._buffer[:max(0, len(self._buffer) - 1)]
+                return
+            del self._buffer[:start]
+            if len(self._buffer) < 6:
+                return
+            length = self._buffer[4] | (self._buffer[5] << 8)
+            if len(self._buffer) < length + 8:
+                return
+            frame = bytes(self._buffer[:length + 8])
+            del self._buffer[:length + 8]
+            if ubx_frame(frame[2], frame[3], frame[6:6 + length]) == frame:
+                self.messages += 1
+                self._message(frame[2], frame[3], frame[6:6 + length])
+
+    def _message(self, message_class, message_id, body):
+        '''Act on a complete UBX message'''
+        key = (message_class, message_id)
+        if key in self._responses:
+            self._link.send(ubx_frame(message_class, message_id, self._responses[key]))
+        elif key == (UBX_CLASS_MON, UBX_ID_MON_VER) and not body:
+            version = b"ROM SPG 5.10 (7b202e)".ljust(30, b"\0") + b"00080000".ljust(10, b"\0")
+            version += b"PROTVER=34.10".ljust(30, b"\0")
+            self._link.send(ubx_frame(UBX_CLASS_MON, UBX_ID_MON_VER, version))
+        elif key == (UBX_CLASS_NAV, UBX_ID_NAV_PVT) and not body:
+            self._link.send(self._nav_pvt_frame())
+        if message_class == UBX_CLASS_CFG:
+            self._link.send(ubx_frame(UBX_CLASS_ACK, UBX_ID_ACK_ACK,
+                                      bytes([message_class, message_id])))
+
+    def _nav_pvt_frame(self):
+        '''A UBX-NAV-PVT message with a 3D fix at the scenario location'''
+        now = time.gmtime()
+        body = bytearray(92)
+        body[4:6] = now.tm_year.to_bytes(2, "little")
+        body[6:11] = bytes([now.tm_mon, now.tm_mday, now.tm_hour, now.tm_min, now.tm_sec])
+        body[11] = 0x07                    # Date, time valid and fully resolved
+        body[20] = 3                       # 3D fix
+        body[21] = 0x01                    # gnssFixOK
+        body[23] = 12                      # Number of satellites
+        body[24:28] = int(self._longitude * 1e7).to_bytes(4, "little", signed=True)
+        body[28:32] = int(self._latitude * 1e7).to_bytes(4, "little", signed=True)
+        body[32:36] = (50000).to_bytes(4, "little", signed=True)
+        body[36:40] = (4000).to_bytes(4, "little", signed=True)
+        body[40:44] = (2000).to_bytes(4, "little")
+        body[44:48] = (3000).to_bytes(4, "little")
+        return ubx_frame(UBX_CLASS_NAV, UBX_ID_NAV_PVT, bytes(body))
+
+    def _gga(self):
+        '''A GGA sentence at the scenario location'''
+        now = time.gmtime()
+        latitude = abs(self._latitude)
+        longitude = abs(self._longitude)
+        return nmea_sentence(f"GNGGA,{now.tm_hour:02d}{now.tm_min:02d}{now.tm_sec:02d}.00,"
+                             f"{int(latitude):02d}{(latitude % 1) * 60:08.5f},"
+                             f"{'N' if self._latitude >= 0 else 'S'},"
+                             f"{int(longitude):03d}{(longitude % 1) * 60:08.5f},"
+                             f"{'E' if self._longitude >= 0 else 'W'},"
+                             "1,12,0.9,50.0,M,47.0,M,,")
+
+    def stream(self, stop_event):
+        '''Send the periodic stream until stopped'''
+        while not stop_event.wait(self._rate):
+            if self._nav_pvt:
+                self._link.send(self._nav_pvt_frame(), add_latency=False)
+            if self._nmea:
+                self._link.send(self._gga(), add_latency=False)
+
+def split_parameters(text):
+    '''Split the parameters of an AT command at the commas which
+    are not inside quotes'''
+    parameters = []
+    current = ""
+    quoted = False
+    for character in text:
+        if character == '"':
+            quoted = not quoted
+        if character == "," and not quoted:
+            parameters.append(current.strip())
+            current = ""
+        else:
+            current += character
+    if current or parameters:
+        parameters.append(current.strip())
+    return parameters
+
+def open_pty(link_path):
+    '''Open a raw pseudo-terminal, optionally linking its device
+    name to link_path, and return the master file descriptor'''
+    master, slave = os.openpty()
+    tty.setraw(slave)
+    tty.setraw(master)
+    # Never block on a write that nothing is reading
+    os.set_blocking(master, False)
+    name = os.ttyname(slave)
+    if link_path:
+        if os.path.islink(link_path):
+            os.unlink(link_path)
+        os.symlink(name, link_path)
+        name = link_path
+    # Keep the slave open so that the master doesn't see EIO
+    # whenever the host application closes its end
+    return master, slave, name
+
+def main():
+    '''Main'''
+    parser = argparse.ArgumentParser(description="A scriptable u-blox module"
+                                     " simulator on a pseudo-terminal.")
+    parser.add_argument("scenario", help="the JSON scenario file.")
+    parser.add_argument("-l", "--link", help="a path at which to create a"
+                        " symbolic link to the pseudo-terminal, e.g. /tmp/ttyV0.")
+    parser.add_argument("-b", "--baud", type=int, help="override the baud"
+                        " rate of the scenario.")
+    parser.add_argument("-t", "--time", type=float, help="stop after this"
+                        " many seconds.")
+    parser.add_argument("-v", "--verbose", action="store_true", help="print"
+                        " the AT commands received.")
+    args = parser.parse_args()
+
+    with open(args.scenario, encoding="utf8") as file:
+        scenario = json.load(file)
+    settings = dict(DEFAULT_LINK)
+    settings.update(scenario.get("link", {}))
+    if args.baud:
+        settings["baud"] = args.baud
+
+    master, slave, name = open_pty(args.link)
+    device_name = os.ttyname(slave)
+    start_time = time.monotonic()
+    link = Link(master, settings)
+    stop_event = threading.Event()
+    threads = []
+    if scenario.get("protocol", "at") == "gnss":
+        engine = GnssEngine(scenario, link)
+        threads.append(threading.Thread(target=engine.stream, args=(stop_event,),
+                                        daemon=True))
+    else:
+        engine = AtEngine(scenario, link, start_time)
+        if args.verbose:
+            command = engine.command
+            def verbose_command(line):
+                log(f"<- {line}")
+                command(line)
+            engine.command = verbose_command
+        threads.append(threading.Thread(target=engine.timed_urcs,
+                                        args=(scenario.get("urcs", []), stop_event),
+                                        daemon=True))
+    log(f"{scenario.get('module', 'module')} on {name},"
+        f" {settings['baud']} baud, latency {settings['latency_ms']} ms.")
+    for thread in threads:
+        thread.start()
+
+    signal.signal(signal.SIGTERM, lambda *_: stop_event.set())
+    bytes_received = 0
+    try:
+        while not stop_event.is_set():
+            if args.time and (time.monotonic() - start_time > args.time):
+                break
+            readable, _, _ = select.select([master], [], [], 0.1)
+            if readable:
+                try:
+                    data = os.read(master, 4096)
+                except OSError:
+                    continue
+                bytes_received += len(data)
+                engine.receive(data)
+    except KeyboardInterrupt:
+        pass
+    stop_event.set()
+    link.stop()
+    duration = time.monotonic() - start_time
+    log(f"{bytes_received} byte(s) received, {link.bytes_sent} byte(s) sent"
+        f" in {duration:.1f} second(s).")
+    os.close(master)
+    os.close(slave)
+    # Only remove the link if another simulator hasn't taken it over
+    if args.link and os.path.islink(args.link) and \
+       os.readlink(args.link) == device_name:
+        os.unlink(args.link)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
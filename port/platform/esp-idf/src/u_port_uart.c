@@ -454,6 +454,53 @@ int32_t uPortUartWrite(int32_t handle,
     return sizeOrErrorCode;
 }
 
+// Write several buffers to the given UART interface; the
+// driver copies each into its transmit ring buffer so, with the
+// mutex held throughout, they go out back to back.
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    int32_t x;
+    bool paramsOk = (pIoVec != NULL) && (count > 0);
+
+    for (size_t y = 0; paramsOk && (y < count); y++) {
+        paramsOk = (pIoVec[y].pBuffer != NULL) || (pIoVec[y].sizeBytes == 0);
+    }
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (paramsOk && (handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            !gUartData[handle].markedForDeletion) {
+            sizeOrErrorCode = 0;
+            for (size_t y = 0; (y < count) && (sizeOrErrorCode >= 0); y++) {
+                if (pIoVec[y].sizeBytes > 0) {
+                    // See the hint in uPortUartWrite() if your
+                    // code stops dead here
+                    x = uart_write_bytes(handle,
+                                         (const char *) pIoVec[y].pBuffer,
+                                         pIoVec[y].sizeBytes);
+                    if (x >= 0) {
+                        sizeOrErrorCode += x;
+                    } else if (sizeOrErrorCode == 0) {
+                        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    } else {
+                        break;
+                    }
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Set an event callback.
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
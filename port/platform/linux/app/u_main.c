@@ -0,0 +1,152 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief The application entry point for the Linux platform.  Starts
+ * the platform and calls Unity to run the selected examples/tests.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "time.h"      // clock_gettime()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_debug.h"
+
+#include "u_runner.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The number of test failures, returned by main() so that
+ * the result is visible to a script or to CTest.
+ */
+static int gFailureCount = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// The task within which the examples and tests run.
+static void appTask(void *pParam)
+{
+    (void) pParam;
+
+#ifdef U_CFG_MUTEX_DEBUG
+    uMutexDebugInit();
+    uMutexDebugWatchdog(uMutexDebugPrint, NULL,
+                        U_MUTEX_DEBUG_WATCHDOG_TIMEOUT_SECONDS);
+#endif
+
+    uPortInit();
+
+    uPortLog("\n\nU_APP: application task started.\n");
+
+    UNITY_BEGIN();
+
+    uPortLog("U_APP: functions available:\n\n");
+    uRunnerPrintAll("U_APP: ");
+#ifdef U_CFG_APP_FILTER
+    uPortLog("U_APP: running functions that begin with \"%s\".\n",
+             U_PORT_STRINGIFY_QUOTED(U_CFG_APP_FILTER));
+    uRunnerRunFiltered(U_PORT_STRINGIFY_QUOTED(U_CFG_APP_FILTER),
+                       "U_APP: ");
+#else
+    uPortLog("U_APP: running all functions.\n");
+    uRunnerRunAll("U_APP: ");
+#endif
+
+    // The things that we have run may have
+    // called deinit so call init again here.
+    uPortInit();
+
+    gFailureCount = UNITY_END();
+
+    uPortLog("\n\nU_APP: application task ended.\n");
+    uPortDeinit();
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Unity setUp() function.
+void setUp(void)
+{
+    // Nothing to do
+}
+
+// Unity tearDown() function.
+void tearDown(void)
+{
+    // Nothing to do
+}
+
+void testFail(void)
+{
+    // Nothing to do
+}
+
+// Get the time in microseconds for timing benchmarks: the monotonic
+// clock has a far better resolution than the port's millisecond tick.
+int64_t uRunnerBenchmarkTimeUs(void)
+{
+    struct timespec timeNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &timeNow);
+
+    return (((int64_t) timeNow.tv_sec) * 1000000) + (timeNow.tv_nsec / 1000);
+}
+
+// Entry point
+int main(void)
+{
+    int32_t errorCode;
+
+    // Start the platform to run the tests
+    errorCode = uPortPlatformStart(appTask, NULL,
+                                   U_CFG_OS_APP_TASK_STACK_SIZE_BYTES,
+                                   U_CFG_OS_APP_TASK_PRIORITY);
+    if (errorCode == 0) {
+        errorCode = gFailureCount;
+    }
+
+    return (int) errorCode;
+}
+
+// End of file
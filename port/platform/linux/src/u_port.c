@@ -0,0 +1,329 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of generic porting functions for Linux.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "limits.h"    // CHAR_MIN
+#include "errno.h"
+#include "time.h"      // clock_gettime()
+#include "malloc.h"    // malloc_usable_size()
+#include "semaphore.h"
+
+#include "u_cfg_sw.h"
+#include "u_compiler.h" // For U_INLINE
+#include "u_cfg_hw_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+#include "u_assert.h"
+
+#include "u_port_debug.h"
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+#include "u_port_private.h"
+#include "u_port_event_queue_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#if CHAR_MIN < 0
+/** As explained in the README.md under the linux directory, GCC
+ * for x86 has signed char types, which can lead to unexpected
+ * behaviours e.g. a character value which contains 0xaa, when
+ * compared with the literal value 0xaa, will return false; the
+ * character value is interpreted as being negative because it has
+ * the top bit set, while the literal value 0xaa is positive.
+ * To avoid this problem the compiler switch -funsigned-char
+ * must be used.
+ */
+#error Please use the compilation switch -funsigned-char to ensure char types are unsigned.
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Structure to carry the entry point of the application
+ * task and to signal its end.
+ */
+typedef struct {
+    void (*pEntryPoint)(void *);
+    void *pParameter;
+    sem_t finished;
+} uPortPlatformStart_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+// The C library functions that the heap functions below interpose.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t numItems, size_t size);
+extern void *__libc_realloc(void *pMemory, size_t size);
+extern void *__libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void *pMemory);
+
+// Keep track of whether we've been initialised or not.
+static bool gInitialised = false;
+
+// The number of bytes of heap currently allocated.
+static int64_t gHeapUsed = 0;
+
+// The maximum number of bytes of heap that have been allocated.
+static int64_t gHeapUsedMax = 0;
+
+// Set while this thread is doing something that allocates heap
+// which should not be counted, see uPortPrivateHeapUncountedSet().
+static __thread bool gHeapUncounted = false;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// The application task, run by uPortPlatformStart().
+static void appTask(void *pParam)
+{
+    uPortPlatformStart_t *pStart = (uPortPlatformStart_t *) pParam;
+
+    pStart->pEntryPoint(pStart->pParameter);
+    sem_post(&(pStart->finished));
+}
+
+// Account for a change in the amount of heap allocated.
+static void heapUsedChange(int64_t changeBytes)
+{
+    int64_t heapUsed;
+    int64_t heapUsedMax;
+
+    if (!gHeapUncounted) {
+        heapUsed = __atomic_add_fetch(&gHeapUsed, changeBytes,
+                                      __ATOMIC_RELAXED);
+        heapUsedMax = __atomic_load_n(&gHeapUsedMax, __ATOMIC_RELAXED);
+        while ((heapUsed > heapUsedMax) &&
+               !__atomic_compare_exchange_n(&gHeapUsedMax, &heapUsedMax, heapUsed,
+                                            true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {}
+    }
+}
+
+// Account for a block being allocated.
+static void *pHeapAlloced(void *pMemory)
+{
+    if (pMemory != NULL) {
+        heapUsedChange((int64_t) malloc_usable_size(pMemory));
+    }
+
+    return pMemory;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Start the platform.
+int32_t uPortPlatformStart(void (*pEntryPoint)(void *),
+                           void *pParameter,
+                           size_t stackSizeBytes,
+                           int32_t priority)
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPlatformStart_t start;
+    uPortTaskHandle_t taskHandle;
+
+    if (pEntryPoint != NULL) {
+        errorCode = U_ERROR_COMMON_PLATFORM;
+        start.pEntryPoint = pEntryPoint;
+        start.pParameter = pParameter;
+        if (sem_init(&(start.finished), 0, 0) == 0) {
+            // Create the application task through the private
+            // task API so that its stack usage can be measured
+            // and it can take part in critical sections
+            if (uPortPrivateTaskCreate(appTask, stackSizeBytes, &start,
+                                       priority, &taskHandle) == 0) {
+                errorCode = U_ERROR_COMMON_SUCCESS;
+                while (sem_wait(&(start.finished)) != 0) {}
+            }
+            sem_destroy(&(start.finished));
+        }
+    }
+
+    return (int32_t) errorCode;
+}
+
+// Initialise the porting layer.
+int32_t uPortInit()
+{
+    int32_t errorCode = 0;
+
+    if (!gInitialised) {
+        errorCode = uPortPrivateInit();
+        if (errorCode == 0) {
+            errorCode = uPortEventQueuePrivateInit();
+            if (errorCode == 0) {
+                errorCode = uPortUartInit();
+            }
+        }
+        gInitialised = (errorCode == 0);
+    }
+
+    return errorCode;
+}
+
+// Deinitialise the porting layer.
+void uPortDeinit()
+{
+    if (gInitialised) {
+        uPortUartDeinit();
+        uPortEventQueuePrivateDeinit();
+        uPortPrivateDeinit();
+        gInitialised = false;
+    }
+}
+
+// Get the current tick in milliseconds.
+int64_t uPortGetTickTimeMs()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((int64_t) time.tv_sec * 1000) + (time.tv_nsec / 1000000);
+}
+
+// Get the minimum amount of heap free, ever, in bytes.
+int32_t uPortGetHeapMinFree()
+{
+    return (int32_t) (U_CFG_OS_HEAP_SIZE_BYTES -
+                      __atomic_load_n(&gHeapUsedMax, __ATOMIC_RELAXED));
+}
+
+// Get the current free heap.
+int32_t uPortGetHeapFree()
+{
+    return (int32_t) (U_CFG_OS_HEAP_SIZE_BYTES -
+                      __atomic_load_n(&gHeapUsed, __ATOMIC_RELAXED));
+}
+
+// Enter a critical section.
+int32_t uPortEnterCritical()
+{
+    return uPortPrivateEnterCritical();
+}
+
+// Leave a critical section.
+void uPortExitCritical()
+{
+    U_ASSERT(uPortPrivateExitCritical() == 0);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: C LIBRARY HEAP
+ * -------------------------------------------------------------- */
+
+// The C library heap functions are interposed, as the GNU C library
+// permits, in order to count the heap in use; the GNU C library's
+// own heap statistics, mallinfo2(), include blocks that have been
+// freed but are held in per-thread caches, so they can't be used to
+// find leaks.  The C library itself calls these functions and so
+// any heap that it uses is also counted.
+
+// malloc().
+void *malloc(size_t size)
+{
+    return pHeapAlloced(__libc_malloc(size));
+}
+
+// calloc().
+void *calloc(size_t numItems, size_t size)
+{
+    return pHeapAlloced(__libc_calloc(numItems, size));
+}
+
+// realloc().
+void *realloc(void *pMemory, size_t size)
+{
+    size_t oldSize = 0;
+    void *pNewMemory;
+
+    if (pMemory != NULL) {
+        oldSize = malloc_usable_size(pMemory);
+    }
+    pNewMemory = __libc_realloc(pMemory, size);
+    if ((pNewMemory != NULL) || (size == 0)) {
+        // Either moved/resized or, for a size of zero, freed
+        heapUsedChange(-(int64_t) oldSize);
+        pHeapAlloced(pNewMemory);
+    }
+
+    return pNewMemory;
+}
+
+// memalign().
+void *memalign(size_t alignment, size_t size)
+{
+    return pHeapAlloced(__libc_memalign(alignment, size));
+}
+
+// aligned_alloc().
+void *aligned_alloc(size_t alignment, size_t size)
+{
+    return memalign(alignment, size);
+}
+
+// posix_memalign().
+int posix_memalign(void **ppMemory, size_t alignment, size_t size)
+{
+    int errorCode = EINVAL;
+
+    // alignment must be a power of two multiple of sizeof(void *)
+    if ((alignment >= sizeof(void *)) && ((alignment & (alignment - 1)) == 0)) {
+        errorCode = ENOMEM;
+        *ppMemory = memalign(alignment, size);
+        if (*ppMemory != NULL) {
+            errorCode = 0;
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop or start counting the heap allocated and freed by this
+// thread.
+void uPortPrivateHeapUncountedSet(bool uncounted)
+{
+    gHeapUncounted = uncounted;
+}
+
+// free().
+void free(void *pMemory)
+{
+    if (pMemory != NULL) {
+        heapUsedChange(-(int64_t) malloc_usable_size(pMemory));
+        __libc_free(pMemory);
+    }
+}
+
+// End of file
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of the crypto API on Linux, using the
+ * libcrypto library of OpenSSL.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy()
+
+#include "pthread.h"   // pthread_once()
+
+#include "openssl/evp.h"
+#include "openssl/hmac.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_crypto.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Ensures that cryptoWarmUp() is called exactly once.
+ */
+static pthread_once_t gWarmUpOnce = PTHREAD_ONCE_INIT;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Get the AES CBC cipher for a given key length.
+static const EVP_CIPHER *pAesCbcCipher(size_t keyLengthBytes)
+{
+    const EVP_CIPHER *pCipher = NULL;
+
+    switch (keyLengthBytes) {
+        case 16:
+            pCipher = EVP_aes_128_cbc();
+            break;
+        case 24:
+            pCipher = EVP_aes_192_cbc();
+            break;
+        case 32:
+            pCipher = EVP_aes_256_cbc();
+            break;
+        default:
+            break;
+    }
+
+    return pCipher;
+}
+
+// OpenSSL loads its provider and caches each algorithm on
+// first use, memory it never gives back; exercise all of the
+// algorithms here so that this happens in one go, on the first
+// call to any of the functions in this file, rather than
+// looking like a leak the first time HMAC or AES is used.
+static void cryptoWarmUp()
+{
+    unsigned char block[16] = {0};
+    unsigned char output[EVP_MAX_MD_SIZE + sizeof(block)];
+    EVP_CIPHER_CTX *pContext;
+    int outputLength;
+
+    EVP_Digest(block, sizeof(block), output, NULL, EVP_sha256(), NULL);
+    HMAC(EVP_sha256(), block, sizeof(block), block, sizeof(block),
+         output, NULL);
+    for (size_t x = 16; x <= 32; x += 8) {
+        pContext = EVP_CIPHER_CTX_new();
+        if (pContext != NULL) {
+            EVP_CipherInit_ex(pContext, pAesCbcCipher(x), NULL,
+                              output, block, 1);
+            EVP_CipherUpdate(pContext, output, &outputLength,
+                             block, sizeof(block));
+            EVP_CIPHER_CTX_free(pContext);
+        }
+    }
+}
+
+// Perform AES CBC encryption or decryption, updating the
+// initialisation vector as the MCU libraries do.
+static int32_t aesCbc(const char *pKey, size_t keyLengthBytes,
+                      char *pInitVector, const char *pInput,
+                      size_t lengthBytes, char *pOutput,
+                      bool encrypt)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    const EVP_CIPHER *pCipher = pAesCbcCipher(keyLengthBytes);
+    EVP_CIPHER_CTX *pContext;
+    char nextInitVector[U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES];
+    int outputLength = 0;
+
+    pthread_once(&gWarmUpOnce, cryptoWarmUp);
+
+    if ((pKey != NULL) && (pInitVector != NULL) && (pInput != NULL) &&
+        (pOutput != NULL) && (pCipher != NULL) &&
+        ((lengthBytes % U_PORT_CRYPTO_AES128_INITIALISATION_VECTOR_LENGTH_BYTES) == 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (lengthBytes > 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            // The next initialisation vector is the last block of
+            // cipher text: when decrypting that's the input, which
+            // may be overwritten if pOutput is pInput, so copy it now
+            if (!encrypt) {
+                memcpy(nextInitVector, pInput + lengthBytes - sizeof(nextInitVector),
+                       sizeof(nextInitVector));
+            }
+            pContext = EVP_CIPHER_CTX_new();
+            if (pContext != NULL) {
+                if ((EVP_CipherInit_ex(pContext, pCipher, NULL,
+                                       (const unsigned char *) pKey,
+                                       (const unsigned char *) pInitVector,
+                                       encrypt ? 1 : 0) == 1) &&
+                    (EVP_CIPHER_CTX_set_padding(pContext, 0) == 1) &&
+                    (EVP_CipherUpdate(pContext, (unsigned char *) pOutput,
+                                      &outputLength,
+                                      (const unsigned char *) pInput,
+                                      (int) lengthBytes) == 1) &&
+                    (outputLength == (int) lengthBytes)) {
+                    if (encrypt) {
+                        memcpy(nextInitVector, pOutput + lengthBytes - sizeof(nextInitVector),
+                               sizeof(nextInitVector));
+                    }
+                    memcpy(pInitVector, nextInitVector, sizeof(nextInitVector));
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+                EVP_CIPHER_CTX_free(pContext);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Perform a SHA256 calculation on a block of data.
+int32_t uPortCryptoSha256(const char *pInput,
+                          size_t inputLengthBytes,
+                          char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    pthread_once(&gWarmUpOnce, cryptoWarmUp);
+
+    if (((pInput != NULL) || (inputLengthBytes == 0)) && (pOutput != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (EVP_Digest(pInput, inputLengthBytes, (unsigned char *) pOutput,
+                       NULL, EVP_sha256(), NULL) == 1) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Perform a HMAC SHA256 calculation on a block of data.
+int32_t uPortCryptoHmacSha256(const char *pKey,
+                              size_t keyLengthBytes,
+                              const char *pInput,
+                              size_t inputLengthBytes,
+                              char *pOutput)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    pthread_once(&gWarmUpOnce, cryptoWarmUp);
+
+    if ((pKey != NULL) && ((pInput != NULL) || (inputLengthBytes == 0)) &&
+        (pOutput != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (HMAC(EVP_sha256(), pKey, (int) keyLengthBytes,
+                 (const unsigned char *) pInput, inputLengthBytes,
+                 (unsigned char *) pOutput, NULL) != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Perform AES 128 CBC encryption of a block of data.
+int32_t uPortCryptoAes128CbcEncrypt(const char *pKey,
+                                    size_t keyLengthBytes,
+                                    char *pInitVector,
+                                    const char *pInput,
+                                    size_t lengthBytes,
+                                    char *pOutput)
+{
+    return aesCbc(pKey, keyLengthBytes, pInitVector,
+                  pInput, lengthBytes, pOutput, true);
+}
+
+// Perform AES 128 CBC decryption of a block of data.
+int32_t uPortCryptoAes128CbcDecrypt(const char *pKey,
+                                    size_t keyLengthBytes,
+                                    char *pInitVector,
+                                    const char *pInput,
+                                    size_t lengthBytes,
+                                    char *pOutput)
+{
+    return aesCbc(pKey, keyLengthBytes, pInitVector,
+                  pInput, lengthBytes, pOutput, false);
+}
+
+// End of file
@@ -0,0 +1,789 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of the port OS API for Linux.
+ *
+ * Implementation note 1: the task handle is the pthread_t of the
+ * thread; see u_port_private.c for how tasks are created.
+ * Implementation note 2: POSIX message queues are inter-process,
+ * have system-wide limits and can't be peeked, hence queues here
+ * are a home-grown ring buffer of fixed-size items protected by a
+ * pthread mutex, with condition variables for waiting.
+ * Implementation note 3: a pthread mutex may only be unlocked by
+ * the thread that locked it, which is not something ubxlib
+ * guarantees, hence a mutex is implemented in the same way as a
+ * semaphore with a limit of 1, as on Windows.
+ * Implementation note 4: there are no interrupts on Linux, hence
+ * the "Irq" variants of the functions here behave in the same
+ * way as their task equivalents, except for uPortQueueReceiveIrq()
+ * which, as on other platforms, does not block.
+ * Implementation note 5: all waits are on CLOCK_MONOTONIC so that
+ * a change to the wall-clock time does not affect them.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+/* The remaining include files come after the mutex debug macros. */
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS FOR MUTEX DEBUG
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_MUTEX_DEBUG
+/** If we're adding the mutex debug intermediate functions to
+ * the build then the implementations of the mutex functions
+ * here get an underscore before them
+ */
+# define MAKE_MTX_FN(x, ...) _ ## x ##__VA_ARGS__
+#else
+/** The normal case: a mutex function is not fiddled with.
+ */
+# define MAKE_MTX_FN(x, ...) x ##__VA_ARGS__
+#endif
+
+/** This macro, working in conjunction with the MAKE_MTX_FN()
+ * macro above, should wrap all of the uPortOsMutex* functions
+ * in this file.  The functions are then pre-fixed with an
+ * underscore if U_CFG_MUTEX_DEBUG is defined, allowing the
+ * intermediate mutex macros/functions over in u_mutex_debug.c
+ * to take their place.  Those functions subsequently call
+ * back into the "underscore versions" of the uPortOsMutex*
+ * functions here.
+ */
+#define MTX_FN(x, ...) MAKE_MTX_FN(x ##__VA_ARGS__)
+
+// Now undef U_CFG_MUTEX_DEBUG so that this file is not polluted
+// by the u_mutex_debug.h stuff brought in through u_port_os.h.
+#undef U_CFG_MUTEX_DEBUG
+
+/* ----------------------------------------------------------------
+ * INCLUDE FILES
+ * -------------------------------------------------------------- */
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // malloc(), free()
+#include "string.h"    // memcpy()
+#include "errno.h"
+#include "time.h"      // nanosleep()
+
+#include "pthread.h"
+#include "sys/mman.h"  // mmap()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A queue.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t notEmpty;
+    pthread_cond_t notFull;
+    size_t itemSizeBytes;
+    size_t length;
+    size_t count;
+    size_t readIndex;
+    char *pBuffer;
+} uPortQueue_t;
+
+/** A semaphore, also used as a mutex.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t limit;
+} uPortSemaphore_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The executable chunk, allocated on first use.
+ */
+static void *gpExecutableChunk = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Initialise a condition variable to use CLOCK_MONOTONIC.
+static bool condInit(pthread_cond_t *pCond)
+{
+    bool success = false;
+    pthread_condattr_t attr;
+
+    if (pthread_condattr_init(&attr) == 0) {
+        success = (pthread_condattr_setclock(&attr, CLOCK_MONOTONIC) == 0) &&
+                  (pthread_cond_init(pCond, &attr) == 0);
+        pthread_condattr_destroy(&attr);
+    }
+
+    return success;
+}
+
+// Wait on a condition variable with the mutex locked:
+// waitMs < 0 means forever, 0 means don't wait at all.
+static int32_t condWait(pthread_cond_t *pCond, pthread_mutex_t *pMutex,
+                        const struct timespec *pTime, int32_t waitMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+
+    if (waitMs < 0) {
+        pthread_cond_wait(pCond, pMutex);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    } else if (waitMs > 0) {
+        if (pthread_cond_clockwait(pCond, pMutex, CLOCK_MONOTONIC, pTime) == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Create a semaphore.
+static int32_t semaphoreCreate(uPortSemaphore_t **ppSemaphore,
+                               uint32_t initialCount, uint32_t limit)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uPortSemaphore_t *pSemaphore;
+
+    pSemaphore = (uPortSemaphore_t *) malloc(sizeof(uPortSemaphore_t));
+    if (pSemaphore != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        pSemaphore->count = initialCount;
+        pSemaphore->limit = limit;
+        if (pthread_mutex_init(&(pSemaphore->mutex), NULL) == 0) {
+            if (condInit(&(pSemaphore->cond))) {
+                *ppSemaphore = pSemaphore;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                pthread_mutex_destroy(&(pSemaphore->mutex));
+            }
+        }
+        if (errorCode != 0) {
+            free(pSemaphore);
+        }
+    }
+
+    return errorCode;
+}
+
+// Delete a semaphore.
+static void semaphoreDelete(uPortSemaphore_t *pSemaphore)
+{
+    pthread_cond_destroy(&(pSemaphore->cond));
+    pthread_mutex_destroy(&(pSemaphore->mutex));
+    free(pSemaphore);
+}
+
+// Take a semaphore: waitMs < 0 means wait forever.
+static int32_t semaphoreTake(uPortSemaphore_t *pSemaphore, int32_t waitMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    struct timespec time;
+
+    uPortPrivateTimeFuture(&time, waitMs);
+
+    pthread_mutex_lock(&(pSemaphore->mutex));
+    while ((pSemaphore->count == 0) && (errorCode == 0)) {
+        errorCode = condWait(&(pSemaphore->cond), &(pSemaphore->mutex),
+                             &time, waitMs);
+    }
+    if (pSemaphore->count > 0) {
+        // Check count again in case of a last-moment give
+        pSemaphore->count--;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+    pthread_mutex_unlock(&(pSemaphore->mutex));
+
+    return errorCode;
+}
+
+// Give a semaphore: if the limit has been reached
+// U_ERROR_COMMON_PLATFORM is returned.
+static int32_t semaphoreGive(uPortSemaphore_t *pSemaphore)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+
+    pthread_mutex_lock(&(pSemaphore->mutex));
+    if (pSemaphore->count < pSemaphore->limit) {
+        pSemaphore->count++;
+        pthread_cond_signal(&(pSemaphore->cond));
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+    pthread_mutex_unlock(&(pSemaphore->mutex));
+
+    return errorCode;
+}
+
+// Send to a queue: waitMs < 0 means wait forever.
+static int32_t queueSend(uPortQueue_t *pQueue, const void *pEventData,
+                         int32_t waitMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    struct timespec time;
+    size_t writeIndex;
+
+    uPortPrivateTimeFuture(&time, waitMs);
+
+    pthread_mutex_lock(&(pQueue->mutex));
+    while ((pQueue->count >= pQueue->length) && (errorCode == 0)) {
+        errorCode = condWait(&(pQueue->notFull), &(pQueue->mutex),
+                             &time, waitMs);
+    }
+    if (pQueue->count < pQueue->length) {
+        writeIndex = pQueue->readIndex + pQueue->count;
+        if (writeIndex >= pQueue->length) {
+            writeIndex -= pQueue->length;
+        }
+        memcpy(pQueue->pBuffer + (writeIndex * pQueue->itemSizeBytes),
+               pEventData, pQueue->itemSizeBytes);
+        pQueue->count++;
+        pthread_cond_signal(&(pQueue->notEmpty));
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+    pthread_mutex_unlock(&(pQueue->mutex));
+
+    return errorCode;
+}
+
+// Receive from or peek a queue: waitMs < 0 means wait forever.
+static int32_t queueReceive(uPortQueue_t *pQueue, void *pEventData,
+                            int32_t waitMs, bool peek)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    struct timespec time;
+
+    uPortPrivateTimeFuture(&time, waitMs);
+
+    pthread_mutex_lock(&(pQueue->mutex));
+    while ((pQueue->count == 0) && (errorCode == 0)) {
+        errorCode = condWait(&(pQueue->notEmpty), &(pQueue->mutex),
+                             &time, waitMs);
+    }
+    if (pQueue->count > 0) {
+        memcpy(pEventData,
+               pQueue->pBuffer + (pQueue->readIndex * pQueue->itemSizeBytes),
+               pQueue->itemSizeBytes);
+        if (!peek) {
+            pQueue->readIndex++;
+            if (pQueue->readIndex >= pQueue->length) {
+                pQueue->readIndex = 0;
+            }
+            pQueue->count--;
+            pthread_cond_signal(&(pQueue->notFull));
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+    pthread_mutex_unlock(&(pQueue->mutex));
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TASKS
+ * -------------------------------------------------------------- */
+
+// Create a task.
+int32_t uPortTaskCreate(void (*pFunction)(void *),
+                        const char *pName,
+                        size_t stackSizeBytes,
+                        void *pParameter,
+                        int32_t priority,
+                        uPortTaskHandle_t *pTaskHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pFunction != NULL) && (pTaskHandle != NULL) &&
+        (priority >= U_CFG_OS_PRIORITY_MIN) &&
+        (priority <= U_CFG_OS_PRIORITY_MAX)) {
+        errorCode = uPortPrivateTaskCreate(pFunction,
+                                           stackSizeBytes,
+                                           pParameter,
+                                           priority,
+                                           pTaskHandle);
+        if ((errorCode == 0) && (pName != NULL)) {
+            // Best effort: Linux limits names to 15 characters
+            char name[16];
+            strncpy(name, pName, sizeof(name) - 1);
+            name[sizeof(name) - 1] = 0;
+            pthread_setname_np((pthread_t) *pTaskHandle, name);
+        }
+    }
+
+    return errorCode;
+}
+
+// Delete the given task.
+int32_t uPortTaskDelete(const uPortTaskHandle_t taskHandle)
+{
+    return uPortPrivateTaskDelete(taskHandle);
+}
+
+// Check if the current task handle is equal to the given task handle.
+bool uPortTaskIsThis(const uPortTaskHandle_t taskHandle)
+{
+    return pthread_equal(pthread_self(), (pthread_t) taskHandle) != 0;
+}
+
+// Block the current task for a time.
+void uPortTaskBlock(int32_t delayMs)
+{
+    struct timespec time;
+
+    if (delayMs > 0) {
+        uPortPrivateTimeFuture(&time, delayMs);
+        // Go back to sleep if woken early by a signal
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME,
+                               &time, NULL) == EINTR) {}
+    }
+}
+
+// Get the minimum free stack for a given task.
+int32_t uPortTaskStackMinFree(const uPortTaskHandle_t taskHandle)
+{
+    int32_t sizeOrErrorCode = uPortPrivateTaskStackMinFree(taskHandle);
+
+    if ((sizeOrErrorCode < 0) && (taskHandle == NULL)) {
+        // Not a task we created, e.g. the thread of main()
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Get the current task handle.
+int32_t uPortTaskGetHandle(uPortTaskHandle_t *pTaskHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pTaskHandle != NULL) {
+        *pTaskHandle = (uPortTaskHandle_t) pthread_self();
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: QUEUES
+ * -------------------------------------------------------------- */
+
+// Create a queue.
+int32_t uPortQueueCreate(size_t queueLength,
+                         size_t itemSizeBytes,
+                         uPortQueueHandle_t *pQueueHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortQueue_t *pQueue;
+
+    if ((pQueueHandle != NULL) && (queueLength > 0) && (itemSizeBytes > 0)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        // Allocate the queue structure and its buffer in one
+        pQueue = (uPortQueue_t *) malloc(sizeof(uPortQueue_t) +
+                                         (queueLength * itemSizeBytes));
+        if (pQueue != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            memset(pQueue, 0, sizeof(*pQueue));
+            pQueue->itemSizeBytes = itemSizeBytes;
+            pQueue->length = queueLength;
+            pQueue->pBuffer = (char *) (pQueue + 1);
+            if (pthread_mutex_init(&(pQueue->mutex), NULL) == 0) {
+                if (condInit(&(pQueue->notEmpty))) {
+                    if (condInit(&(pQueue->notFull))) {
+                        *pQueueHandle = (uPortQueueHandle_t) pQueue;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    } else {
+                        pthread_cond_destroy(&(pQueue->notEmpty));
+                    }
+                }
+                if (errorCode != 0) {
+                    pthread_mutex_destroy(&(pQueue->mutex));
+                }
+            }
+            if (errorCode != 0) {
+                free(pQueue);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Delete the given queue.
+int32_t uPortQueueDelete(const uPortQueueHandle_t queueHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortQueue_t *pQueue = (uPortQueue_t *) queueHandle;
+
+    if (pQueue != NULL) {
+        pthread_cond_destroy(&(pQueue->notFull));
+        pthread_cond_destroy(&(pQueue->notEmpty));
+        pthread_mutex_destroy(&(pQueue->mutex));
+        free(pQueue);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Send to the given queue.
+int32_t uPortQueueSend(const uPortQueueHandle_t queueHandle,
+                       const void *pEventData)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((queueHandle != NULL) && (pEventData != NULL)) {
+        errorCode = queueSend((uPortQueue_t *) queueHandle, pEventData, -1);
+    }
+
+    return errorCode;
+}
+
+// Send to the given queue from an interrupt: there are no
+// interrupts on Linux so this is the same as uPortQueueSend().
+int32_t uPortQueueSendIrq(const uPortQueueHandle_t queueHandle,
+                          const void *pEventData)
+{
+    return uPortQueueSend(queueHandle, pEventData);
+}
+
+// Receive from the given queue, blocking.
+int32_t uPortQueueReceive(const uPortQueueHandle_t queueHandle,
+                          void *pEventData)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((queueHandle != NULL) && (pEventData != NULL)) {
+        errorCode = queueReceive((uPortQueue_t *) queueHandle,
+                                 pEventData, -1, false);
+    }
+
+    return errorCode;
+}
+
+// Receive from the given queue from an interrupt: this never
+// blocks, returning an error if the queue is empty, since the event
+// queue relies on it to fail uPortEventQueueSendIrq() when all of
+// its slots are in use.
+int32_t uPortQueueReceiveIrq(const uPortQueueHandle_t queueHandle,
+                             void *pEventData)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((queueHandle != NULL) && (pEventData != NULL)) {
+        errorCode = queueReceive((uPortQueue_t *) queueHandle,
+                                 pEventData, 0, false);
+    }
+
+    return errorCode;
+}
+
+// Receive from the given queue, with a wait time.
+int32_t uPortQueueTryReceive(const uPortQueueHandle_t queueHandle,
+                             int32_t waitMs, void *pEventData)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((queueHandle != NULL) && (pEventData != NULL)) {
+        if (waitMs < 0) {
+            waitMs = 0;
+        }
+        errorCode = queueReceive((uPortQueue_t *) queueHandle,
+                                 pEventData, waitMs, false);
+    }
+
+    return errorCode;
+}
+
+// Peek the given queue.
+int32_t uPortQueuePeek(const uPortQueueHandle_t queueHandle,
+                       void *pEventData)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((queueHandle != NULL) && (pEventData != NULL)) {
+        errorCode = queueReceive((uPortQueue_t *) queueHandle,
+                                 pEventData, 0, true);
+    }
+
+    return errorCode;
+}
+
+// Get the number of free spaces in the given queue.
+int32_t uPortQueueGetFree(const uPortQueueHandle_t queueHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortQueue_t *pQueue = (uPortQueue_t *) queueHandle;
+
+    if (pQueue != NULL) {
+        pthread_mutex_lock(&(pQueue->mutex));
+        sizeOrErrorCode = (int32_t) (pQueue->length - pQueue->count);
+        pthread_mutex_unlock(&(pQueue->mutex));
+    }
+
+    return sizeOrErrorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: MUTEXES
+ * -------------------------------------------------------------- */
+
+// Create a mutex.
+int32_t MTX_FN(uPortMutexCreate(uPortMutexHandle_t *pMutexHandle))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pMutexHandle != NULL) {
+        errorCode = semaphoreCreate((uPortSemaphore_t **) pMutexHandle, 1, 1);
+    }
+
+    return errorCode;
+}
+
+// Destroy a mutex.
+int32_t MTX_FN(uPortMutexDelete(const uPortMutexHandle_t mutexHandle))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (mutexHandle != NULL) {
+        semaphoreDelete((uPortSemaphore_t *) mutexHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Lock the given mutex.
+int32_t MTX_FN(uPortMutexLock(const uPortMutexHandle_t mutexHandle))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (mutexHandle != NULL) {
+        errorCode = semaphoreTake((uPortSemaphore_t *) mutexHandle, -1);
+    }
+
+    return errorCode;
+}
+
+// Try to lock the given mutex.
+int32_t MTX_FN(uPortMutexTryLock(const uPortMutexHandle_t mutexHandle,
+                                 int32_t delayMs))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (mutexHandle != NULL) {
+        if (delayMs < 0) {
+            delayMs = 0;
+        }
+        errorCode = semaphoreTake((uPortSemaphore_t *) mutexHandle, delayMs);
+    }
+
+    return errorCode;
+}
+
+// Unlock the given mutex.
+int32_t MTX_FN(uPortMutexUnlock(const uPortMutexHandle_t mutexHandle))
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (mutexHandle != NULL) {
+        // Unlocking a mutex that is not locked is an error
+        errorCode = semaphoreGive((uPortSemaphore_t *) mutexHandle);
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: SEMAPHORES
+ * -------------------------------------------------------------- */
+
+// Create a semaphore.
+int32_t uPortSemaphoreCreate(uPortSemaphoreHandle_t *pSemaphoreHandle,
+                             uint32_t initialCount,
+                             uint32_t limit)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pSemaphoreHandle != NULL) && (limit != 0) && (initialCount <= limit)) {
+        errorCode = semaphoreCreate((uPortSemaphore_t **) pSemaphoreHandle,
+                                    initialCount, limit);
+    }
+
+    return errorCode;
+}
+
+// Destroy a semaphore.
+int32_t uPortSemaphoreDelete(const uPortSemaphoreHandle_t semaphoreHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (semaphoreHandle != NULL) {
+        semaphoreDelete((uPortSemaphore_t *) semaphoreHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Take the given semaphore.
+int32_t uPortSemaphoreTake(const uPortSemaphoreHandle_t semaphoreHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (semaphoreHandle != NULL) {
+        errorCode = semaphoreTake((uPortSemaphore_t *) semaphoreHandle, -1);
+    }
+
+    return errorCode;
+}
+
+// Try to take the given semaphore.
+int32_t uPortSemaphoreTryTake(const uPortSemaphoreHandle_t semaphoreHandle,
+                              int32_t delayMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (semaphoreHandle != NULL) {
+        if (delayMs < 0) {
+            delayMs = 0;
+        }
+        errorCode = semaphoreTake((uPortSemaphore_t *) semaphoreHandle, delayMs);
+    }
+
+    return errorCode;
+}
+
+// Give the semaphore.
+int32_t uPortSemaphoreGive(const uPortSemaphoreHandle_t semaphoreHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (semaphoreHandle != NULL) {
+        // Giving too many times is not an error
+        semaphoreGive((uPortSemaphore_t *) semaphoreHandle);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Give the semaphore from interrupt: there are no interrupts
+// on Linux so this is the same as uPortSemaphoreGive().
+int32_t uPortSemaphoreGiveIrq(const uPortSemaphoreHandle_t semaphoreHandle)
+{
+    return uPortSemaphoreGive(semaphoreHandle);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TIMERS
+ * -------------------------------------------------------------- */
+
+// Create a timer.
+int32_t uPortTimerCreate(uPortTimerHandle_t *pTimerHandle,
+                         const char *pName,
+                         pTimerCallback_t *pCallback,
+                         void *pCallbackParam,
+                         uint32_t intervalMs,
+                         bool periodic)
+{
+    return uPortPrivateTimerCreate(pTimerHandle,
+                                   pName, pCallback,
+                                   pCallbackParam,
+                                   intervalMs,
+                                   periodic);
+}
+
+// Destroy a timer.
+int32_t uPortTimerDelete(const uPortTimerHandle_t timerHandle)
+{
+    return uPortPrivateTimerDelete(timerHandle);
+}
+
+// Start a timer.
+int32_t uPortTimerStart(const uPortTimerHandle_t timerHandle)
+{
+    return uPortPrivateTimerStart(timerHandle);
+}
+
+// Stop a timer.
+int32_t uPortTimerStop(const uPortTimerHandle_t timerHandle)
+{
+    return uPortPrivateTimerStop(timerHandle);
+}
+
+// Change a timer interval.
+int32_t uPortTimerChange(const uPortTimerHandle_t timerHandle,
+                         uint32_t intervalMs)
+{
+    return uPortPrivateTimerChange(timerHandle, intervalMs);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CHUNK
+ * -------------------------------------------------------------- */
+
+// Get a chunk of memory that can be executed.
+void *uPortAcquireExecutableChunk(void *pChunkToMakeExecutable,
+                                  size_t *pSize,
+                                  uPortExeChunkFlags_t flags,
+                                  uPortChunkIndex_t index)
+{
+    void *pChunk;
+
+    (void) pChunkToMakeExecutable;
+    (void) flags;
+    (void) index;
+
+    if (gpExecutableChunk == NULL) {
+        pChunk = mmap(NULL, U_CFG_OS_EXECUTABLE_CHUNK_INDEX_0_SIZE,
+                      PROT_READ | PROT_WRITE | PROT_EXEC,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pChunk != MAP_FAILED) {
+            gpExecutableChunk = pChunk;
+        }
+    }
+    if (pSize != NULL) {
+        *pSize = 0;
+        if (gpExecutableChunk != NULL) {
+            *pSize = U_CFG_OS_EXECUTABLE_CHUNK_INDEX_0_SIZE;
+        }
+    }
+
+    return gpExecutableChunk;
+}
+
+// End of file
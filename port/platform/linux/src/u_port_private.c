@@ -0,0 +1,826 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Stuff private to the Linux porting layer.
+ *
+ * Implementation note 1: task handles are the pthread_t of the
+ * thread, which is an integer type on Linux and so can simply be
+ * cast to a uPortTaskHandle_t.  Each task created through this API
+ * is also entered into a table, which allows its stack usage to
+ * be measured and allows it to be suspended for critical sections.
+ * The threads are joinable, with stacks allocated here, and a task
+ * that has exited is joined the next time a task is created or when
+ * the port is deinitialised.
+ * Implementation note 2: POSIX has no way of suspending a thread
+ * from outside, which is what a critical section requires, so
+ * uPortPrivateEnterCritical() sends a signal to each task in the
+ * table and the signal handler parks the thread on a semaphore
+ * until uPortPrivateExitCritical() releases it.  Only tasks created
+ * through this API are suspended.
+ * Implementation note 3: there is a single timer task, as the
+ * timer API requires, and the timers are kept in a linked list
+ * which the timer task searches for the next expiry; the number of
+ * timers in use by ubxlib is small.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // malloc(), free()
+#include "string.h"    // memset(), strncpy()
+#include "errno.h"
+#include "time.h"      // clock_gettime()
+#include "signal.h"    // pthread_kill(), sigaction()
+#include "semaphore.h"
+#include "unistd.h"    // sysconf()
+#include "sys/mman.h"  // mmap()
+
+#include "pthread.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_PORT_PRIVATE_CRITICAL_SECTION_SIGNAL
+/** The signal used to suspend tasks while in a critical section.
+ */
+# define U_PORT_PRIVATE_CRITICAL_SECTION_SIGNAL (SIGRTMIN + 1)
+#endif
+
+/** The value that a task's stack is filled with in order that
+ * the high watermark can be found.
+ */
+#define U_PORT_PRIVATE_STACK_FILL 0xa5
+
+/** The amount of stack, below the stack frame of the task start
+ * function, which is left unfilled in order not to overwrite
+ * the stack we are running on.
+ */
+#define U_PORT_PRIVATE_STACK_FILL_MARGIN_BYTES 256
+
+/** The maximum length of a timer name, including terminator.
+ */
+#define U_PORT_PRIVATE_TIMER_NAME_LENGTH_BYTES 16
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A task entry.
+ */
+typedef struct {
+    bool inUse;
+    bool running; /**< set by the task itself once the entry is complete. */
+    bool exited; /**< set by the task itself when it exits, awaiting taskReap(). */
+    pthread_t thread;
+    void *pStackBlock; /**< the memory mapped for the stack, including guard page. */
+    size_t stackBlockSizeBytes; /**< the size of pStackBlock. */
+    const char *pStackBottom; /**< the lowest address of the stack. */
+    const char *pStackStart; /**< the stack frame of the task start function. */
+    size_t stackSizeBytes; /**< the stack size the thread was given. */
+} uPortPrivateTask_t;
+
+/** The information passed to taskStart().
+ */
+typedef struct {
+    void (*pFunction)(void *);
+    void *pParameter;
+    uPortPrivateTask_t *pTask;
+    sem_t started;
+} uPortPrivateTaskStart_t;
+
+/** A timer entry.
+ */
+typedef struct uPortPrivateTimer_t {
+    char name[U_PORT_PRIVATE_TIMER_NAME_LENGTH_BYTES];
+    pTimerCallback_t *pCallback;
+    void *pCallbackParam;
+    uint32_t intervalMs;
+    bool periodic;
+    bool running;
+    int64_t expiryMs;
+    struct uPortPrivateTimer_t *pNext;
+} uPortPrivateTimer_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect the task table, held throughout a critical
+ * section.
+ */
+static pthread_mutex_t gMutexThread = PTHREAD_MUTEX_INITIALIZER;
+
+/** The task table.
+ */
+static uPortPrivateTask_t gTask[U_PORT_MAX_NUM_TASKS];
+
+/** Semaphore given by each task as it is suspended.
+ */
+static sem_t gCriticalSuspended;
+
+/** Semaphore which suspended tasks wait on.
+ */
+static sem_t gCriticalResume;
+
+/** Semaphore given by each task as it resumes, so that a task
+ * can't be left holding a resume meant for another when one
+ * critical section quickly follows another.
+ */
+static sem_t gCriticalResumed;
+
+/** The number of tasks suspended by the current critical section.
+ */
+static size_t gCriticalSuspendedCount = 0;
+
+/** Mutex to protect the timer list.
+ */
+static pthread_mutex_t gMutexTimer = PTHREAD_MUTEX_INITIALIZER;
+
+/** Condition signalled when anything in the timer list changes
+ * and when a timer callback has been executed.
+ */
+static pthread_cond_t gCondTimer;
+
+/** Root of the timer list.
+ */
+static uPortPrivateTimer_t *gpTimerList = NULL;
+
+/** The timer whose callback is currently being executed.
+ */
+static uPortPrivateTimer_t *gpTimerCallbackRunning = NULL;
+
+/** The timer task.
+ */
+static uPortTaskHandle_t gTimerTask = NULL;
+
+/** Flag to tell the timer task to exit, and for it to indicate
+ * that it has.
+ */
+static bool gTimerTaskExit = false;
+static bool gTimerTaskRunning = false;
+
+/** Keep track of whether we've been initialised or not.
+ */
+static bool gInitialised = false;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Get the monotonic time in milliseconds.
+static int64_t timeMs()
+{
+    struct timespec time;
+
+    clock_gettime(CLOCK_MONOTONIC, &time);
+
+    return ((int64_t) time.tv_sec * 1000) + (time.tv_nsec / 1000000);
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: TASKS
+ * -------------------------------------------------------------- */
+
+// Find a task in the table.
+// gMutexThread should be locked before this is called.
+static uPortPrivateTask_t *pTaskGet(pthread_t thread)
+{
+    uPortPrivateTask_t *pTask = NULL;
+
+    for (size_t x = 0; (pTask == NULL) &&
+         (x < sizeof(gTask) / sizeof(gTask[0])); x++) {
+        if (gTask[x].inUse && gTask[x].running &&
+            pthread_equal(gTask[x].thread, thread)) {
+            pTask = &(gTask[x]);
+        }
+    }
+
+    return pTask;
+}
+
+// Mark the current task as exited in the table; the entry
+// remains in use until taskReap() has joined the thread.
+static void taskRemoveThis()
+{
+    uPortPrivateTask_t *pTask;
+
+    pthread_mutex_lock(&gMutexThread);
+    pTask = pTaskGet(pthread_self());
+    if (pTask != NULL) {
+        pTask->running = false;
+        pTask->exited = true;
+    }
+    pthread_mutex_unlock(&gMutexThread);
+}
+
+// Join any tasks that have exited, free their stacks and give
+// their entries in the table back.  The threads are joinable and
+// have stacks that we supply, rather than stacks from the C
+// library's cache, because only then does glibc free the per-thread
+// memory it allocates for TLS when a thread has gone: otherwise
+// that memory would look like a leak to the heap checks.
+static void taskReap()
+{
+    uPortPrivateTask_t *pTask;
+
+    pthread_mutex_lock(&gMutexThread);
+    for (size_t x = 0; x < sizeof(gTask) / sizeof(gTask[0]); x++) {
+        pTask = &(gTask[x]);
+        if (pTask->inUse && pTask->exited) {
+            // The thread has called taskRemoveThis() and so
+            // there is nothing left for it to do but exit
+            uPortPrivateHeapUncountedSet(true);
+            pthread_join(pTask->thread, NULL);
+            uPortPrivateHeapUncountedSet(false);
+            munmap(pTask->pStackBlock, pTask->stackBlockSizeBytes);
+            memset(pTask, 0, sizeof(*pTask));
+        }
+    }
+    pthread_mutex_unlock(&gMutexThread);
+}
+
+// The function that every task begins in: completes the task
+// entry, fills the stack so that its usage can be measured
+// and then calls the user function.
+static void *taskStart(void *pParam)
+{
+    uPortPrivateTaskStart_t *pStart = (uPortPrivateTaskStart_t *) pParam;
+    void (*pFunction)(void *) = pStart->pFunction;
+    void *pParameter = pStart->pParameter;
+    uPortPrivateTask_t *pTask = pStart->pTask;
+    const char *pStackStart = (const char *) __builtin_frame_address(0);
+    pthread_attr_t attr;
+    void *pStackBottom = NULL;
+    size_t stackSizeBytes = 0;
+
+    if (pthread_getattr_np(pthread_self(), &attr) == 0) {
+        pthread_attr_getstack(&attr, &pStackBottom, &stackSizeBytes);
+        pthread_attr_destroy(&attr);
+    }
+    if ((pStackBottom != NULL) &&
+        (pStackStart - U_PORT_PRIVATE_STACK_FILL_MARGIN_BYTES > (char *) pStackBottom)) {
+        memset(pStackBottom, U_PORT_PRIVATE_STACK_FILL,
+               (pStackStart - U_PORT_PRIVATE_STACK_FILL_MARGIN_BYTES) - (char *) pStackBottom);
+    }
+
+    pthread_mutex_lock(&gMutexThread);
+    pTask->thread = pthread_self();
+    pTask->pStackBottom = (const char *) pStackBottom;
+    pTask->pStackStart = pStackStart;
+    pTask->running = true;
+    pthread_mutex_unlock(&gMutexThread);
+
+    // pStart is on the stack of the creator, which is
+    // waiting for this, so must not be used after here
+    sem_post(&(pStart->started));
+
+    pFunction(pParameter);
+
+    taskRemoveThis();
+
+    return NULL;
+}
+
+// The signal handler which suspends a task for a critical section.
+static void criticalSectionSignalHandler(int signal)
+{
+    int savedErrno = errno;
+
+    (void) signal;
+
+    // Both of these are async-signal-safe
+    sem_post(&gCriticalSuspended);
+    while (sem_wait(&gCriticalResume) != 0) {}
+    sem_post(&gCriticalResumed);
+
+    errno = savedErrno;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: TIMERS
+ * -------------------------------------------------------------- */
+
+// Find a timer in the list.
+// gMutexTimer should be locked before this is called.
+static uPortPrivateTimer_t *pTimerGet(const uPortTimerHandle_t handle)
+{
+    uPortPrivateTimer_t *pTimer = gpTimerList;
+
+    while ((pTimer != NULL) && (pTimer != (uPortPrivateTimer_t *) handle)) {
+        pTimer = pTimer->pNext;
+    }
+
+    return pTimer;
+}
+
+// The timer task.
+static void timerTask(void *pParam)
+{
+    uPortPrivateTimer_t *pTimer;
+    uPortPrivateTimer_t *pNext;
+    pTimerCallback_t *pCallback;
+    void *pCallbackParam;
+    struct timespec time;
+    int64_t nowMs;
+
+    (void) pParam;
+
+    pthread_mutex_lock(&gMutexTimer);
+
+    gTimerTaskRunning = true;
+    pthread_cond_broadcast(&gCondTimer);
+
+    while (!gTimerTaskExit) {
+        // Find the running timer which expires first
+        pNext = NULL;
+        for (pTimer = gpTimerList; pTimer != NULL; pTimer = pTimer->pNext) {
+            if (pTimer->running &&
+                ((pNext == NULL) || (pTimer->expiryMs < pNext->expiryMs))) {
+                pNext = pTimer;
+            }
+        }
+        nowMs = timeMs();
+        if (pNext == NULL) {
+            pthread_cond_wait(&gCondTimer, &gMutexTimer);
+        } else if (pNext->expiryMs > nowMs) {
+            uPortPrivateTimeFuture(&time, (int32_t) (pNext->expiryMs - nowMs));
+            pthread_cond_clockwait(&gCondTimer, &gMutexTimer,
+                                   CLOCK_MONOTONIC, &time);
+        } else {
+            // Expired: reschedule it if it is periodic, without
+            // trying to catch up if we've fallen behind
+            pNext->running = pNext->periodic;
+            pNext->expiryMs += pNext->intervalMs;
+            if (pNext->expiryMs <= nowMs) {
+                pNext->expiryMs = nowMs + pNext->intervalMs;
+            }
+            // Call the callback with the mutex unlocked so that
+            // it may use this API
+            pCallback = pNext->pCallback;
+            pCallbackParam = pNext->pCallbackParam;
+            gpTimerCallbackRunning = pNext;
+            pthread_mutex_unlock(&gMutexTimer);
+            if (pCallback != NULL) {
+                pCallback((uPortTimerHandle_t) pNext, pCallbackParam);
+            }
+            pthread_mutex_lock(&gMutexTimer);
+            gpTimerCallbackRunning = NULL;
+            pthread_cond_broadcast(&gCondTimer);
+        }
+    }
+
+    gTimerTaskRunning = false;
+    pthread_cond_broadcast(&gCondTimer);
+
+    pthread_mutex_unlock(&gMutexTimer);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+// Initialise the private stuff.
+int32_t uPortPrivateInit(void)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    pthread_condattr_t condAttr;
+    struct sigaction action;
+
+    if (!gInitialised) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = criticalSectionSignalHandler;
+        sigemptyset(&action.sa_mask);
+        // Restart system calls that the signal interrupts
+        action.sa_flags = SA_RESTART;
+        if ((sem_init(&gCriticalSuspended, 0, 0) == 0) &&
+            (sem_init(&gCriticalResume, 0, 0) == 0) &&
+            (sem_init(&gCriticalResumed, 0, 0) == 0) &&
+            (sigaction(U_PORT_PRIVATE_CRITICAL_SECTION_SIGNAL, &action, NULL) == 0) &&
+            (pthread_condattr_init(&condAttr) == 0)) {
+            pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+            if (pthread_cond_init(&gCondTimer, &condAttr) == 0) {
+                // Start the timer task
+                gTimerTaskExit = false;
+                errorCode = uPortPrivateTaskCreate(timerTask, 1024 * 8, NULL,
+                                                   U_CFG_OS_PRIORITY_MAX,
+                                                   &gTimerTask);
+                if (errorCode == 0) {
+                    pthread_mutex_lock(&gMutexTimer);
+                    while (!gTimerTaskRunning) {
+                        pthread_cond_wait(&gCondTimer, &gMutexTimer);
+                    }
+                    pthread_mutex_unlock(&gMutexTimer);
+                } else {
+                    pthread_cond_destroy(&gCondTimer);
+                }
+            }
+            pthread_condattr_destroy(&condAttr);
+        }
+        gInitialised = (errorCode == 0);
+    }
+
+    return errorCode;
+}
+
+// Deinitialise the private stuff.
+void uPortPrivateDeinit(void)
+{
+    uPortPrivateTimer_t *pTimer;
+
+    if (gInitialised) {
+        // Stop the timer task and free any timers the
+        // user hasn't deleted
+        pthread_mutex_lock(&gMutexTimer);
+        gTimerTaskExit = true;
+        pthread_cond_broadcast(&gCondTimer);
+        while (gTimerTaskRunning) {
+            pthread_cond_wait(&gCondTimer, &gMutexTimer);
+        }
+        while (gpTimerList != NULL) {
+            pTimer = gpTimerList->pNext;
+            free(gpTimerList);
+            gpTimerList = pTimer;
+        }
+        pthread_mutex_unlock(&gMutexTimer);
+        // Tidy up after the timer task and any others that
+        // have exited
+        taskReap();
+        pthread_cond_destroy(&gCondTimer);
+        gTimerTask = NULL;
+        gInitialised = false;
+    }
+}
+
+// Enter a critical section.
+int32_t uPortPrivateEnterCritical()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    pthread_t thisThread = pthread_self();
+    size_t count = 0;
+
+    if (gInitialised) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        // Note: the mutex remains locked until the critical
+        // section is exited, which means that no task can be
+        // added to or removed from the table in the meantime
+        pthread_mutex_lock(&gMutexThread);
+        for (size_t x = 0; x < sizeof(gTask) / sizeof(gTask[0]); x++) {
+            if (gTask[x].inUse && gTask[x].running &&
+                !pthread_equal(gTask[x].thread, thisThread) &&
+                (pthread_kill(gTask[x].thread,
+                              U_PORT_PRIVATE_CRITICAL_SECTION_SIGNAL) == 0)) {
+                count++;
+            }
+        }
+        // Wait for everyone to be suspended
+        for (size_t x = 0; x < count; x++) {
+            while (sem_wait(&gCriticalSuspended) != 0) {}
+        }
+        gCriticalSuspendedCount = count;
+    }
+
+    return errorCode;
+}
+
+// Leave a critical section.
+int32_t uPortPrivateExitCritical()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    if (gInitialised) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        for (size_t x = 0; x < gCriticalSuspendedCount; x++) {
+            sem_post(&gCriticalResume);
+        }
+        // Wait for everyone to be running again
+        for (size_t x = 0; x < gCriticalSuspendedCount; x++) {
+            while (sem_wait(&gCriticalResumed) != 0) {}
+        }
+        gCriticalSuspendedCount = 0;
+        pthread_mutex_unlock(&gMutexThread);
+    }
+
+    return errorCode;
+}
+
+// Get a time in the future.
+void uPortPrivateTimeFuture(struct timespec *pTime, int32_t delayMs)
+{
+    clock_gettime(CLOCK_MONOTONIC, pTime);
+    if (delayMs > 0) {
+        pTime->tv_sec += delayMs / 1000;
+        pTime->tv_nsec += (long) (delayMs % 1000) * 1000000;
+        if (pTime->tv_nsec >= 1000000000) {
+            pTime->tv_sec++;
+            pTime->tv_nsec -= 1000000000;
+        }
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TASKS
+ * -------------------------------------------------------------- */
+
+// Create a task.
+int32_t uPortPrivateTaskCreate(void (*pFunction)(void *),
+                               size_t stackSizeBytes,
+                               void *pParameter,
+                               int32_t priority,
+                               uPortTaskHandle_t *pTaskHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uPortPrivateTaskStart_t start;
+    uPortPrivateTask_t *pTask = NULL;
+    pthread_attr_t attr;
+    pthread_t thread;
+    size_t threadStackSizeBytes = stackSizeBytes;
+    size_t pageSizeBytes = (size_t) sysconf(_SC_PAGESIZE);
+    char *pStackBlock;
+    int result;
+
+    // Priorities cannot be applied to the threads of an
+    // unprivileged process
+    (void) priority;
+
+    // Make room in the table
+    taskReap();
+
+    // Reserve an entry in the task table
+    pthread_mutex_lock(&gMutexThread);
+    for (size_t x = 0; (pTask == NULL) &&
+         (x < sizeof(gTask) / sizeof(gTask[0])); x++) {
+        if (!gTask[x].inUse) {
+            pTask = &(gTask[x]);
+            memset(pTask, 0, sizeof(*pTask));
+            pTask->inUse = true;
+        }
+    }
+    pthread_mutex_unlock(&gMutexThread);
+
+    if (pTask != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        if (threadStackSizeBytes < U_PORT_TASK_STACK_MIN_SIZE_BYTES) {
+            threadStackSizeBytes = U_PORT_TASK_STACK_MIN_SIZE_BYTES;
+        }
+        threadStackSizeBytes = (threadStackSizeBytes + pageSizeBytes - 1) &
+                               ~(pageSizeBytes - 1);
+        pTask->stackSizeBytes = threadStackSizeBytes;
+        // Map the stack with an inaccessible guard page below it
+        pTask->stackBlockSizeBytes = threadStackSizeBytes + pageSizeBytes;
+        pStackBlock = (char *) mmap(NULL, pTask->stackBlockSizeBytes,
+                                    PROT_READ | PROT_WRITE,
+                                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK,
+                                    -1, 0);
+        if (pStackBlock != MAP_FAILED) {
+            pTask->pStackBlock = pStackBlock;
+            mprotect(pStackBlock, pageSizeBytes, PROT_NONE);
+        }
+        start.pFunction = pFunction;
+        start.pParameter = pParameter;
+        start.pTask = pTask;
+        if ((pTask->pStackBlock != NULL) &&
+            (sem_init(&(start.started), 0, 0) == 0)) {
+            if (pthread_attr_init(&attr) == 0) {
+                uPortPrivateHeapUncountedSet(true);
+                result = pthread_attr_setstack(&attr, pStackBlock + pageSizeBytes,
+                                               threadStackSizeBytes);
+                if (result == 0) {
+                    result = pthread_create(&thread, &attr, taskStart, &start);
+                }
+                uPortPrivateHeapUncountedSet(false);
+                if (result == 0) {
+                    // Wait for the task to fill in its entry
+                    while (sem_wait(&(start.started)) != 0) {}
+                    *pTaskHandle = (uPortTaskHandle_t) thread;
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                }
+                pthread_attr_destroy(&attr);
+            }
+            sem_destroy(&(start.started));
+        }
+        if (errorCode != 0) {
+            // Give the stack and the table entry back
+            if (pTask->pStackBlock != NULL) {
+                munmap(pTask->pStackBlock, pTask->stackBlockSizeBytes);
+            }
+            pthread_mutex_lock(&gMutexThread);
+            memset(pTask, 0, sizeof(*pTask));
+            pthread_mutex_unlock(&gMutexThread);
+        }
+    }
+
+    return errorCode;
+}
+
+// Delete a task.
+int32_t uPortPrivateTaskDelete(const uPortTaskHandle_t taskHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+
+    // Only self-deletion is supported: pthread_cancel() of
+    // another thread could leave any mutex it holds locked
+    if ((taskHandle == NULL) ||
+        pthread_equal((pthread_t) taskHandle, pthread_self())) {
+        taskRemoveThis();
+        pthread_exit(NULL);
+    }
+
+    return errorCode;
+}
+
+// Get the minimum free stack for a task.
+int32_t uPortPrivateTaskStackMinFree(const uPortTaskHandle_t taskHandle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPrivateTask_t *pTask;
+    pthread_t thread = pthread_self();
+    const char *pStack;
+    size_t usedBytes;
+
+    if (taskHandle != NULL) {
+        thread = (pthread_t) taskHandle;
+    }
+
+    pthread_mutex_lock(&gMutexThread);
+
+    pTask = pTaskGet(thread);
+    if ((pTask != NULL) && (pTask->pStackBottom != NULL)) {
+        // Find the first byte that has been written to
+        pStack = pTask->pStackBottom;
+        while ((pStack < pTask->pStackStart) &&
+               (*pStack == (char) U_PORT_PRIVATE_STACK_FILL)) {
+            pStack++;
+        }
+        usedBytes = pTask->pStackStart - pStack;
+        sizeOrErrorCode = 0;
+        if (usedBytes < pTask->stackSizeBytes) {
+            sizeOrErrorCode = (int32_t) (pTask->stackSizeBytes - usedBytes);
+        }
+    }
+
+    pthread_mutex_unlock(&gMutexThread);
+
+    return sizeOrErrorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TIMERS
+ * -------------------------------------------------------------- */
+
+// Add a timer entry to the list.
+int32_t uPortPrivateTimerCreate(uPortTimerHandle_t *pHandle,
+                                const char *pName,
+                                pTimerCallback_t *pCallback,
+                                void *pCallbackParam,
+                                uint32_t intervalMs,
+                                bool periodic)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPrivateTimer_t *pTimer;
+
+    if ((pHandle != NULL) && (pCallback != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pTimer = (uPortPrivateTimer_t *) malloc(sizeof(uPortPrivateTimer_t));
+        if (pTimer != NULL) {
+            memset(pTimer, 0, sizeof(*pTimer));
+            if (pName != NULL) {
+                strncpy(pTimer->name, pName, sizeof(pTimer->name) - 1);
+            }
+            pTimer->pCallback = pCallback;
+            pTimer->pCallbackParam = pCallbackParam;
+            pTimer->intervalMs = intervalMs;
+            pTimer->periodic = periodic;
+            pthread_mutex_lock(&gMutexTimer);
+            pTimer->pNext = gpTimerList;
+            gpTimerList = pTimer;
+            pthread_mutex_unlock(&gMutexTimer);
+            *pHandle = (uPortTimerHandle_t) pTimer;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Remove a timer entry from the list.
+int32_t uPortPrivateTimerDelete(const uPortTimerHandle_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPrivateTimer_t **ppTimer;
+    uPortPrivateTimer_t *pTimer;
+
+    pthread_mutex_lock(&gMutexTimer);
+
+    for (ppTimer = &gpTimerList; (*ppTimer != NULL) &&
+         (*ppTimer != (uPortPrivateTimer_t *) handle);
+         ppTimer = &((*ppTimer)->pNext)) {}
+    if (*ppTimer != NULL) {
+        pTimer = *ppTimer;
+        *ppTimer = pTimer->pNext;
+        // If the callback of this timer is running, and it
+        // is not the callback that is deleting the timer,
+        // wait for it to finish
+        while ((gpTimerCallbackRunning == pTimer) &&
+               !uPortTaskIsThis(gTimerTask)) {
+            pthread_cond_wait(&gCondTimer, &gMutexTimer);
+        }
+        free(pTimer);
+        pthread_cond_broadcast(&gCondTimer);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    pthread_mutex_unlock(&gMutexTimer);
+
+    return errorCode;
+}
+
+// Start a timer.
+int32_t uPortPrivateTimerStart(const uPortTimerHandle_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPrivateTimer_t *pTimer;
+
+    pthread_mutex_lock(&gMutexTimer);
+
+    pTimer = pTimerGet(handle);
+    if (pTimer != NULL) {
+        pTimer->expiryMs = timeMs() + pTimer->intervalMs;
+        pTimer->running = true;
+        pthread_cond_broadcast(&gCondTimer);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    pthread_mutex_unlock(&gMutexTimer);
+
+    return errorCode;
+}
+
+// Stop a timer.
+int32_t uPortPrivateTimerStop(const uPortTimerHandle_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPrivateTimer_t *pTimer;
+
+    pthread_mutex_lock(&gMutexTimer);
+
+    pTimer = pTimerGet(handle);
+    if (pTimer != NULL) {
+        pTimer->running = false;
+        pthread_cond_broadcast(&gCondTimer);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    pthread_mutex_unlock(&gMutexTimer);
+
+    return errorCode;
+}
+
+// Change a timer interval.
+int32_t uPortPrivateTimerChange(const uPortTimerHandle_t handle,
+                                uint32_t intervalMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortPrivateTimer_t *pTimer;
+
+    pthread_mutex_lock(&gMutexTimer);
+
+    pTimer = pTimerGet(handle);
+    if (pTimer != NULL) {
+        pTimer->intervalMs = intervalMs;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    pthread_mutex_unlock(&gMutexTimer);
+
+    return errorCode;
+}
+
+// End of file
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_PRIVATE_H_
+#define _U_PORT_PRIVATE_H_
+
+/** @file
+ * @brief Stuff private to the Linux porting layer.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_PORT_MAX_NUM_TASKS
+/** The maximum number of tasks that can be created.
+ */
+# define U_PORT_MAX_NUM_TASKS 64
+#endif
+
+#ifndef U_PORT_TASK_STACK_MIN_SIZE_BYTES
+/** The minimum stack size actually given to a thread: the stack
+ * sizes requested by ubxlib are sized for an MCU C library, the
+ * Linux C library needs rather more.  uPortTaskStackMinFree()
+ * reports against the stack size the thread was actually given.
+ */
+# define U_PORT_TASK_STACK_MIN_SIZE_BYTES (1024 * 64)
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: MISC
+ * -------------------------------------------------------------- */
+
+/** Initialise the private bits of the porting layer.
+ *
+ * @return: zero on success else negative error code.
+ */
+int32_t uPortPrivateInit(void);
+
+/** Deinitialise the private bits of the porting layer.
+ */
+void uPortPrivateDeinit(void);
+
+/** Enter a critical section: all of the tasks created through this
+ * porting layer, other than the calling one, are suspended until
+ * uPortPrivateExitCritical() is called.
+ *
+ * @return zero on success else negative error code.
+ */
+int32_t uPortPrivateEnterCritical();
+
+/** Leave a critical section.
+ *
+ * @return zero on success else negative error code.
+ */
+int32_t uPortPrivateExitCritical();
+
+/** Get an absolute CLOCK_MONOTONIC time that is the given number
+ * of milliseconds in the future, suitable for the "clock" variants
+ * of the pthread wait functions.  time.h must be included before
+ * this header file.
+ *
+ * @param pTime   a place to put the result; cannot be NULL.
+ * @param delayMs the number of milliseconds in the future.
+ */
+void uPortPrivateTimeFuture(struct timespec *pTime, int32_t delayMs);
+
+/** Stop or start counting, in uPortGetHeapFree(), the heap that
+ * the calling thread allocates and frees.  This is used around
+ * pthread_create() and pthread_join(), between which glibc keeps
+ * memory for the thread's TLS: whether a task has been joined yet
+ * when the heap is measured is down to timing, so that memory
+ * should not appear in the figures.  Implemented in u_port.c.
+ *
+ * @param uncounted true to stop counting, false to start again.
+ */
+void uPortPrivateHeapUncountedSet(bool uncounted);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: TASKS
+ * -------------------------------------------------------------- */
+
+/** Create and start a task.
+ *
+ * @param pFunction      the function that forms the task.
+ * @param stackSizeBytes the number of bytes of memory to dynamically
+ *                       allocate for stack; the thread will actually
+ *                       be given at least U_PORT_TASK_STACK_MIN_SIZE_BYTES.
+ * @param pParameter     a pointer that will be passed to pFunction
+ *                       when the task is started.
+ *                       The thing at the end of this pointer must be
+ *                       there for the lifetime of the task, it is
+ *                       not copied.  May be NULL.
+ * @param priority       the priority at which to run the task.
+ * @param pTaskHandle    a place to put the handle of the created
+ *                       task.
+ * @return               zero on success else negative error code.
+ */
+int32_t uPortPrivateTaskCreate(void (*pFunction)(void *),
+                               size_t stackSizeBytes,
+                               void *pParameter,
+                               int32_t priority,
+                               uPortTaskHandle_t *pTaskHandle);
+
+/** Delete the given task.
+ *
+ * @param taskHandle  the handle of the task to be deleted.
+ *                    Only NULL, the current task, is supported.
+ * @return            zero on success else negative error code.
+ */
+int32_t uPortPrivateTaskDelete(const uPortTaskHandle_t taskHandle);
+
+/** Get the minimum free stack for a task, measured against
+ * the stack size the task was actually given.
+ *
+ * @param taskHandle  the handle of the task, NULL for the
+ *                    current task.
+ * @return            the minimum amount of stack free in bytes,
+ *                    else negative error code.
+ */
+int32_t uPortPrivateTaskStackMinFree(const uPortTaskHandle_t taskHandle);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: TIMERS
+ * -------------------------------------------------------------- */
+
+/** Add a timer entry to the list.
+ *
+ * @param pHandle         a place to put the timer handle.
+ * @param pName           a name for the timer, used for debug
+ *                        purposes only; should be a null-terminated
+ *                        string, may be NULL.  The value will be
+ *                        copied.
+ * @param pCallback       the timer callback routine.
+ * @param pCallbackParam  a parameter that will be provided to the
+ *                        timer callback routine as its second parameter
+ *                        when it is called; may be NULL.
+ * @param intervalMs      the time interval in milliseconds.
+ * @param periodic        if true the timer will be restarted after it
+ *                        has expired, else the timer will be one-shot.
+ * @return                zero on success else negative error code.
+ */
+int32_t uPortPrivateTimerCreate(uPortTimerHandle_t *pHandle,
+                                const char *pName,
+                                pTimerCallback_t *pCallback,
+                                void *pCallbackParam,
+                                uint32_t intervalMs,
+                                bool periodic);
+
+/** Remove a timer entry from the list; if the callback of the timer
+ * is currently running this will wait for it to finish.
+ *
+ * @param handle  the handle of the timer to be removed.
+ * @return        zero on success else negative error code.
+ */
+int32_t uPortPrivateTimerDelete(const uPortTimerHandle_t handle);
+
+/** Start a timer.
+ *
+ * @param handle  the handle of the timer.
+ * @return        zero on success else negative error code.
+ */
+int32_t uPortPrivateTimerStart(const uPortTimerHandle_t handle);
+
+/** Stop a timer.
+ *
+ * @param handle  the handle of the timer.
+ * @return        zero on success else negative error code.
+ */
+int32_t uPortPrivateTimerStop(const uPortTimerHandle_t handle);
+
+/** Change a timer interval; takes effect the next time the
+ * timer is started or, for a periodic timer, re-started.
+ *
+ * @param handle       the handle of the timer.
+ * @param intervalMs   the new time interval in milliseconds.
+ * @return             zero on success else negative error code.
+ */
+int32_t uPortPrivateTimerChange(const uPortTimerHandle_t handle,
+                                uint32_t intervalMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_PORT_PRIVATE_H_
+
+// End of file
@@ -0,0 +1,1285 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of the port UART API on Linux.
+ *
+ * Implementation note 1: a UART is a serial device, by default
+ * /dev/ttyUSBx where x is the UART number passed to uPortUartOpen(),
+ * see U_PORT_UART_DEVICE_NAME_FORMAT.  The device to use for a given
+ * UART number can also be set at run-time with the environment
+ * variable U_PORT_UART_x, e.g. U_PORT_UART_0=/dev/pts/3, which
+ * allows a pseudo-terminal (e.g. one created by socat) to be used.
+ * Implementation note 2: there is a single receive task for all
+ * UARTs, waiting in epoll_wait() for data to arrive on any of them
+ * and moving it into the receive buffer of that UART.  Should the
+ * receive buffer of a UART become full the UART is removed from
+ * the epoll set, leaving the data in the driver, where flow control
+ * will apply if it is enabled, until uPortUartRead() makes room.
+ * Implementation note 3: writes are made from the task of the
+ * caller with only the mutex of that UART locked, so that a write
+ * which is held up by flow control does not hold up reception.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "stdlib.h"    // malloc(), free(), getenv()
+#include "stdio.h"     // snprintf()
+#include "string.h"    // memset(), strncpy()
+#include "errno.h"
+
+#include "unistd.h"    // read(), close()
+#include "sys/uio.h"   // writev()
+#include "fcntl.h"     // open()
+#include "termios.h"
+#include "poll.h"
+#include "sys/epoll.h"
+#include "sys/eventfd.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_clib_platform_specific.h" /* Integer stdio, must be included
+                                              before the other port files if
+                                              any print or scan function is used. */
+#include "u_port_debug.h"
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_uart.h"
+#include "u_port_event_queue.h"
+#include "u_port_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_PORT_UART_DEVICE_NAME_FORMAT
+/** The format of the name of the device for a UART, where the
+ * %d is replaced by the UART number; may be overridden at
+ * run-time with the environment variable U_PORT_UART_x.
+ */
+# define U_PORT_UART_DEVICE_NAME_FORMAT "/dev/ttyUSB%d"
+#endif
+
+#ifndef U_PORT_UART_MAX_DEVICE_NAME_BUFFER_LENGTH
+/** The size of buffer required to contain a device name string.
+ * This length INCLUDES the terminator.
+ */
+# define U_PORT_UART_MAX_DEVICE_NAME_BUFFER_LENGTH 64
+#endif
+
+#ifndef U_PORT_UART_RX_TASK_STACK_SIZE_BYTES
+/** The stack size of the receive task.
+ */
+# define U_PORT_UART_RX_TASK_STACK_SIZE_BYTES (1024 * 8)
+#endif
+
+#ifndef U_PORT_UART_RX_TASK_PRIORITY
+/** The priority of the receive task.
+ */
+# define U_PORT_UART_RX_TASK_PRIORITY U_CFG_OS_PRIORITY_MAX
+#endif
+
+#ifndef U_PORT_UART_RX_MAX_EVENTS
+/** The maximum number of epoll events to handle at once.
+ */
+# define U_PORT_UART_RX_MAX_EVENTS 8
+#endif
+
+#ifndef U_PORT_UART_WRITE_TIMEOUT_MS
+/** How long to wait for a UART to be able to accept more
+ * data when writing before giving up.
+ */
+# define U_PORT_UART_WRITE_TIMEOUT_MS 5000
+#endif
+
+#ifndef U_PORT_UART_WRITEV_MAX_IOVEC
+/** The maximum number of buffers to pass to writev() at once.
+ */
+# define U_PORT_UART_WRITEV_MAX_IOVEC 16
+#endif
+
+/** The epoll user data of the event that tells the receive
+ * task to exit, distinct from any UART handle.
+ */
+#define U_PORT_UART_RX_TASK_EXIT -1
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Structure of the things we need to keep track of per UART in
+ * a linked list.
+ */
+typedef struct uPortUartData_t {
+    int32_t uartHandle;
+    bool markedForDeletion;
+    char nameStr[U_PORT_UART_MAX_DEVICE_NAME_BUFFER_LENGTH];
+    int fd;
+    uPortMutexHandle_t txMutex;
+    bool rxBufferIsMalloced;
+    size_t rxBufferSizeBytes;
+    char *pRxBufferStart;
+    size_t rxBufferRead;
+    size_t rxBufferWrite;
+    bool rxPaused; /**< set when the receive buffer is full
+                    * and the UART is out of the epoll set. */
+    bool ctsFlowControlSuspended;
+    bool flowControlEnabled;
+    int32_t eventQueueHandle;
+    uint32_t eventFilter;
+    void (*pEventCallback)(int32_t, uint32_t, void *);
+    void *pEventCallbackParam;
+    bool userNeedsNotify; /**< set this when all the data has
+                           * been read and hence the user
+                           * would like a notification
+                           * when new data arrives. */
+    struct uPortUartData_t *pNext;
+} uPortUartData_t;
+
+/** Structure describing an event.
+ */
+typedef struct {
+    int32_t uartHandle;
+    uint32_t eventBitMap;
+    void (*pEventCallback)(int32_t, uint32_t, void *);
+    void *pEventCallbackParam;
+} uPortUartEvent_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Mutex to protect UART data.
+ */
+static uPortMutexHandle_t gMutex = NULL;
+
+/** Root of linked list of UART data.
+ */
+static uPortUartData_t *gpUartListRoot = NULL;
+
+/** The next UART handle to use.
+ */
+static int32_t gUartHandleNext = 0;
+
+/** The epoll instance that the receive task waits on.
+ */
+static int gEpollFd = -1;
+
+/** Event file descriptor used to tell the receive task to exit.
+ */
+static int gExitFd = -1;
+
+/** Handle of the receive task.
+ */
+static uPortTaskHandle_t gRxTaskHandle = NULL;
+
+/** Mutex held by the receive task while it is running.
+ */
+static uPortMutexHandle_t gRxTaskRunningMutex = NULL;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Find a UART in the list by handle.
+// gMutex should be locked before this is called.
+static uPortUartData_t *pUartGetByHandle(int32_t handle)
+{
+    uPortUartData_t *pTmp = gpUartListRoot;
+
+    while ((pTmp != NULL) && (pTmp->uartHandle != handle)) {
+        pTmp = pTmp->pNext;
+    }
+
+    return pTmp;
+}
+
+// Find a UART in the list by name.
+// gMutex should be locked before this is called.
+static uPortUartData_t *pUartGetByName(const char *pNameStr)
+{
+    uPortUartData_t *pTmp = gpUartListRoot;
+
+    while ((pTmp != NULL) &&
+           (strncmp(pTmp->nameStr, pNameStr, sizeof(pTmp->nameStr)) != 0)) {
+        pTmp = pTmp->pNext;
+    }
+
+    return pTmp;
+}
+
+// Add a UART to the list, populating its UART handle and returning a
+// pointer to it.
+// gMutex should be locked before this is called.
+static uPortUartData_t *pUartAdd()
+{
+    uPortUartData_t *pUartData = NULL;
+    bool success = true;
+    int32_t x;
+
+    // Get the next UART handle, one that is not
+    // already in the list
+    x = gUartHandleNext;
+    while ((pUartGetByHandle(gUartHandleNext) != NULL) && success) {
+        gUartHandleNext++;
+        if (gUartHandleNext < 0) {
+            gUartHandleNext = 0;
+        }
+        if (gUartHandleNext == x) {
+            // Looped
+            success = false;
+        }
+    }
+
+    if (success) {
+        pUartData = (uPortUartData_t *) malloc(sizeof(uPortUartData_t));
+        if (pUartData != NULL) {
+            memset(pUartData, 0, sizeof(*pUartData));
+            pUartData->eventQueueHandle = -1;
+            pUartData->uartHandle = gUartHandleNext;
+            pUartData->fd = -1;
+            pUartData->pNext = gpUartListRoot;
+            gpUartListRoot = pUartData;
+        }
+    }
+
+    return pUartData;
+}
+
+// Remove a UART from the list.
+// gMutex should be locked before this is called.
+static void uartRemove(const uPortUartData_t *pUartData)
+{
+    uPortUartData_t *pTmp = gpUartListRoot;
+    uPortUartData_t *pPrevious = NULL;
+
+    while (pTmp != NULL) {
+        if (pTmp == pUartData) {
+            if (pPrevious == NULL) {
+                // At head
+                gpUartListRoot = pTmp->pNext;
+            } else {
+                pPrevious->pNext = pTmp->pNext;
+            }
+            free(pTmp);
+            // Force exit
+            pTmp = NULL;
+        } else {
+            pPrevious = pTmp;
+            pTmp = pTmp->pNext;
+        }
+    }
+}
+
+// Add a UART to, or modify it in, the epoll set.
+static int32_t uartEpollSet(const uPortUartData_t *pUartData, int operation,
+                            uint32_t events)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    struct epoll_event event;
+
+    memset(&event, 0, sizeof(event));
+    event.events = events;
+    event.data.u64 = (uint64_t) pUartData->uartHandle;
+    if (epoll_ctl(gEpollFd, operation, pUartData->fd, &event) == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Close a UART.
+// !!! gMutex should NOT be locked when this is called !!!
+static void uartCloseRequiresMutex(uPortUartData_t *pUartData)
+{
+    // Remove the callback if there is one
+    if (pUartData->eventQueueHandle >= 0) {
+        uPortEventQueueClose(pUartData->eventQueueHandle);
+    }
+
+    // Make sure that no-one is part-way through a write
+    U_PORT_MUTEX_LOCK(pUartData->txMutex);
+    U_PORT_MUTEX_UNLOCK(pUartData->txMutex);
+
+    // Now lock the mutex for the remaining bits
+    U_PORT_MUTEX_LOCK(gMutex);
+
+    // Closing the file descriptor also removes
+    // it from the epoll set
+    close(pUartData->fd);
+    uPortMutexDelete(pUartData->txMutex);
+    if (pUartData->rxBufferIsMalloced) {
+        // Free the buffer
+        free(pUartData->pRxBufferStart);
+    }
+    // And then take it out of the list
+    uartRemove(pUartData);
+
+    U_PORT_MUTEX_UNLOCK(gMutex);
+}
+
+// Event handler, calls the user's event callback.
+static void eventHandler(void *pParam, size_t paramLength)
+{
+    uPortUartEvent_t *pEvent = (uPortUartEvent_t *) pParam;
+
+    (void) paramLength;
+
+    // Don't need to worry about locking the mutex,
+    // the close() function makes sure this event handler
+    // exits cleanly and, in any case, the user callback
+    // will want to be able to access functions in this
+    // API which will need to lock the mutex.
+
+    if (pEvent->pEventCallback != NULL) {
+        pEvent->pEventCallback(pEvent->uartHandle,
+                               pEvent->eventBitMap,
+                               pEvent->pEventCallbackParam);
+    }
+}
+
+// Move received data from the driver into the receive buffer
+// of a UART, called by rxTask().
+// gMutex should be locked before this is called.
+static void uartReceive(uPortUartData_t *pUartData, uint32_t events)
+{
+    uPortUartEvent_t event;
+    size_t rxBufferRead = pUartData->rxBufferRead;
+    size_t spaceAvailable;
+    size_t totalSize = 0;
+    ssize_t bytesRead;
+
+    do {
+        // Work out how much linear space we have free in
+        // the buffer, always leaving one byte so that the
+        // write index doesn't catch up with the read index
+        if (pUartData->rxBufferWrite >= rxBufferRead) {
+            spaceAvailable = pUartData->rxBufferSizeBytes - pUartData->rxBufferWrite;
+            if (rxBufferRead == 0) {
+                spaceAvailable--;
+            }
+        } else {
+            spaceAvailable = (rxBufferRead - pUartData->rxBufferWrite) - 1;
+        }
+        bytesRead = 0;
+        if (spaceAvailable > 0) {
+            bytesRead = read(pUartData->fd,
+                             pUartData->pRxBufferStart + pUartData->rxBufferWrite,
+                             spaceAvailable);
+            if (bytesRead > 0) {
+                totalSize += bytesRead;
+                pUartData->rxBufferWrite += bytesRead;
+                if (pUartData->rxBufferWrite >= pUartData->rxBufferSizeBytes) {
+                    pUartData->rxBufferWrite = 0;
+                }
+            }
+        } else {
+            // Buffer is full: stop listening to the UART until
+            // uPortUartRead() has made some room
+            pUartData->rxPaused = true;
+            uartEpollSet(pUartData, EPOLL_CTL_MOD, 0);
+        }
+        // Keep reading while there is stuff to read
+    } while (bytesRead > 0);
+
+    if ((bytesRead == 0) && (spaceAvailable > 0) &&
+        ((events & (EPOLLHUP | EPOLLERR)) != 0)) {
+        // The other end has gone (e.g. a pseudo-terminal that
+        // has been closed); stop listening or we'll spin
+        uPortLog("U_PORT_UART: %s has hung up.\n", pUartData->nameStr);
+        uartEpollSet(pUartData, EPOLL_CTL_MOD, 0);
+    }
+
+    if ((totalSize > 0) &&
+        (pUartData->userNeedsNotify) &&
+        (pUartData->eventQueueHandle >= 0) &&
+        (pUartData->eventFilter & U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+        // Call the user callback
+        pUartData->userNeedsNotify = false;
+        event.uartHandle = pUartData->uartHandle;
+        event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+        event.pEventCallback = pUartData->pEventCallback;
+        event.pEventCallbackParam = pUartData->pEventCallbackParam;
+        uPortEventQueueSend(pUartData->eventQueueHandle, &event, sizeof(event));
+    }
+}
+
+// The receive task, serving all UARTs.
+static void rxTask(void *pParam)
+{
+    struct epoll_event events[U_PORT_UART_RX_MAX_EVENTS];
+    uPortUartData_t *pUartData;
+    bool exitNow = false;
+    int numEvents;
+
+    (void) pParam;
+
+    U_PORT_MUTEX_LOCK(gRxTaskRunningMutex);
+
+    while (!exitNow) {
+        numEvents = epoll_wait(gEpollFd, events,
+                               sizeof(events) / sizeof(events[0]), -1);
+        if ((numEvents < 0) && (errno != EINTR)) {
+            uPortLog("U_PORT_UART: epoll_wait() failed (%d).\n", errno);
+            exitNow = true;
+        }
+        for (int x = 0; x < numEvents; x++) {
+            if ((int32_t) events[x].data.u64 == U_PORT_UART_RX_TASK_EXIT) {
+                exitNow = true;
+            } else {
+                U_PORT_MUTEX_LOCK(gMutex);
+                pUartData = pUartGetByHandle((int32_t) events[x].data.u64);
+                if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+                    uartReceive(pUartData, events[x].events);
+                }
+                U_PORT_MUTEX_UNLOCK(gMutex);
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(gRxTaskRunningMutex);
+
+    // Delete ourselves
+    uPortTaskDelete(NULL);
+}
+
+// Get the baud rate constant for termios.
+static speed_t baudRateToSpeed(int32_t baudRate)
+{
+    speed_t speed = B0;
+
+    switch (baudRate) {
+        case 9600:
+            speed = B9600;
+            break;
+        case 19200:
+            speed = B19200;
+            break;
+        case 38400:
+            speed = B38400;
+            break;
+        case 57600:
+            speed = B57600;
+            break;
+        case 115200:
+            speed = B115200;
+            break;
+        case 230400:
+            speed = B230400;
+            break;
+        case 460800:
+            speed = B460800;
+            break;
+        case 921600:
+            speed = B921600;
+            break;
+        case 1000000:
+            speed = B1000000;
+            break;
+        case 2000000:
+            speed = B2000000;
+            break;
+        case 3000000:
+            speed = B3000000;
+            break;
+        case 4000000:
+            speed = B4000000;
+            break;
+        default:
+            break;
+    }
+
+    return speed;
+}
+
+// Set or clear hardware flow control on a UART.
+static int32_t setFlowControl(int fd, bool onNotOff)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    struct termios options;
+
+    if (tcgetattr(fd, &options) == 0) {
+        if (onNotOff) {
+            options.c_cflag |= CRTSCTS;
+        } else {
+            options.c_cflag &= ~CRTSCTS;
+        }
+        if (tcsetattr(fd, TCSANOW, &options) == 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Get whether hardware flow control is on for a UART.
+static bool isFlowControl(int fd)
+{
+    struct termios options;
+
+    return (tcgetattr(fd, &options) == 0) &&
+           ((options.c_cflag & CRTSCTS) != 0);
+}
+
+// Write the given buffers to a UART: a single writev() call
+// per U_PORT_UART_WRITEV_MAX_IOVEC buffers, barring flow control.
+static int32_t uartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                          size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    uPortMutexHandle_t txMutex = NULL;
+    int fd = -1;
+    struct pollfd pollFd;
+    struct iovec iov[U_PORT_UART_WRITEV_MAX_IOVEC];
+    int iovCount;
+    size_t offset = 0;
+    ssize_t thisSize;
+    int pollResult;
+    bool paramsOk = (pIoVec != NULL) && (count > 0);
+
+    for (size_t x = 0; paramsOk && (x < count); x++) {
+        paramsOk = (pIoVec[x].pBuffer != NULL) || (pIoVec[x].sizeBytes == 0);
+    }
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if (paramsOk && (pUartData != NULL) && !pUartData->markedForDeletion) {
+            // Lock the transmit mutex before letting go of gMutex:
+            // closing the UART waits on the transmit mutex
+            txMutex = pUartData->txMutex;
+            fd = pUartData->fd;
+            U_PORT_MUTEX_LOCK(txMutex);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (txMutex != NULL) {
+            sizeOrErrorCode = 0;
+            do {
+                // Move past whatever has been sent, offset being
+                // the amount sent from the buffer at pIoVec
+                while ((count > 0) && (offset >= pIoVec->sizeBytes)) {
+                    offset -= pIoVec->sizeBytes;
+                    pIoVec++;
+                    count--;
+                }
+                if (count > 0) {
+                    iovCount = 0;
+                    for (size_t x = 0; (x < count) && (iovCount < U_PORT_UART_WRITEV_MAX_IOVEC); x++) {
+                        if (pIoVec[x].sizeBytes > 0) {
+                            iov[iovCount].iov_base = (void *) pIoVec[x].pBuffer;
+                            iov[iovCount].iov_len = pIoVec[x].sizeBytes;
+                            if (x == 0) {
+                                iov[iovCount].iov_base = (char *) iov[iovCount].iov_base + offset;
+                                iov[iovCount].iov_len -= offset;
+                            }
+                            iovCount++;
+                        }
+                    }
+                    thisSize = writev(fd, iov, iovCount);
+                    if (thisSize > 0) {
+                        offset += thisSize;
+                        sizeOrErrorCode += (int32_t) thisSize;
+                    } else if ((thisSize < 0) && (errno == EAGAIN)) {
+                        // Wait for there to be room
+                        pollFd.fd = fd;
+                        pollFd.events = POLLOUT;
+                        pollFd.revents = 0;
+                        pollResult = poll(&pollFd, 1, U_PORT_UART_WRITE_TIMEOUT_MS);
+                        if (pollResult == 0) {
+                            // Timed out: errno is not set by poll() in
+                            // this case so must not be looked at
+                            if (sizeOrErrorCode == 0) {
+                                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                            }
+                            break;
+                        } else if ((pollResult < 0) && (errno != EINTR)) {
+                            if (sizeOrErrorCode == 0) {
+                                sizeOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                            }
+                            break;
+                        }
+                        // Interrupted or room to write: try again
+                    } else if ((thisSize < 0) && (errno != EINTR)) {
+                        if (sizeOrErrorCode == 0) {
+                            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                        }
+                        break;
+                    }
+                }
+            } while (count > 0);
+
+            U_PORT_MUTEX_UNLOCK(txMutex);
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Initialise the UART driver.
+int32_t uPortUartInit()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    struct epoll_event event;
+
+    if (gMutex == NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        gEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        gExitFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if ((gEpollFd >= 0) && (gExitFd >= 0)) {
+            memset(&event, 0, sizeof(event));
+            event.events = EPOLLIN;
+            event.data.u64 = (uint64_t) (int64_t) U_PORT_UART_RX_TASK_EXIT;
+            if (epoll_ctl(gEpollFd, EPOLL_CTL_ADD, gExitFd, &event) == 0) {
+                errorCode = uPortMutexCreate(&gRxTaskRunningMutex);
+                if (errorCode == 0) {
+                    errorCode = uPortTaskCreate(rxTask, "uartRx",
+                                                U_PORT_UART_RX_TASK_STACK_SIZE_BYTES,
+                                                NULL, U_PORT_UART_RX_TASK_PRIORITY,
+                                                &gRxTaskHandle);
+                    if (errorCode == 0) {
+                        // Wait for the task to lock its running mutex
+                        while (uPortMutexTryLock(gRxTaskRunningMutex, 0) == 0) {
+                            uPortMutexUnlock(gRxTaskRunningMutex);
+                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+                        }
+                        errorCode = uPortMutexCreate(&gMutex);
+                        if (errorCode != 0) {
+                            // Tell the task to exit
+                            eventfd_write(gExitFd, 1);
+                            U_PORT_MUTEX_LOCK(gRxTaskRunningMutex);
+                            U_PORT_MUTEX_UNLOCK(gRxTaskRunningMutex);
+                        }
+                    }
+                    if (errorCode != 0) {
+                        uPortMutexDelete(gRxTaskRunningMutex);
+                        gRxTaskRunningMutex = NULL;
+                    }
+                }
+            }
+        }
+        if (errorCode != 0) {
+            if (gExitFd >= 0) {
+                close(gExitFd);
+                gExitFd = -1;
+            }
+            if (gEpollFd >= 0) {
+                close(gEpollFd);
+                gEpollFd = -1;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Deinitialise the UART driver.
+void uPortUartDeinit()
+{
+    uPortUartData_t *pTmp = gpUartListRoot;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        // First, mark all instances for deletion
+        while (pTmp != NULL) {
+            pTmp->markedForDeletion = true;
+            pTmp = pTmp->pNext;
+        }
+
+        // Release the mutex so that deletion can occur
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        // Now close all the UART instances
+        while (gpUartListRoot != NULL) {
+            uartCloseRequiresMutex(gpUartListRoot);
+        }
+
+        // Tell the receive task to exit and wait for it to do so
+        eventfd_write(gExitFd, 1);
+        U_PORT_MUTEX_LOCK(gRxTaskRunningMutex);
+        U_PORT_MUTEX_UNLOCK(gRxTaskRunningMutex);
+        uPortMutexDelete(gRxTaskRunningMutex);
+        gRxTaskRunningMutex = NULL;
+        gRxTaskHandle = NULL;
+        // Pause to allow the task to actually exit
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        close(gExitFd);
+        gExitFd = -1;
+        close(gEpollFd);
+        gEpollFd = -1;
+
+        // Delete the mutex
+        U_PORT_MUTEX_LOCK(gMutex);
+        U_PORT_MUTEX_UNLOCK(gMutex);
+        uPortMutexDelete(gMutex);
+        gMutex = NULL;
+    }
+}
+
+// Open a UART instance.
+int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
+                      void *pReceiveBuffer,
+                      size_t receiveBufferSizeBytes,
+                      int32_t pinTx, int32_t pinRx,
+                      int32_t pinCts, int32_t pinRts)
+{
+    int32_t handleOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    char nameStr[U_PORT_UART_MAX_DEVICE_NAME_BUFFER_LENGTH];
+    char envStr[24];
+    const char *pEnv;
+    speed_t speed = baudRateToSpeed(baudRate);
+    struct termios options;
+
+    // TX/RX pins are managed by Linux
+    (void) pinTx;
+    (void) pinRx;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        // Work out the name of the device
+        snprintf(envStr, sizeof(envStr), "U_PORT_UART_%d", (int) uart);
+        pEnv = getenv(envStr);
+        if (pEnv != NULL) {
+            strncpy(nameStr, pEnv, sizeof(nameStr) - 1);
+            nameStr[sizeof(nameStr) - 1] = 0;
+        } else {
+            snprintf(nameStr, sizeof(nameStr), U_PORT_UART_DEVICE_NAME_FORMAT, (int) uart);
+        }
+        handleOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((uart >= 0) && (speed != B0) && (pUartGetByName(nameStr) == NULL) &&
+            (receiveBufferSizeBytes > 1)) {
+            handleOrErrorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pUartData = pUartAdd();
+            if (pUartData != NULL) {
+                pUartData->markedForDeletion = false;
+                pUartData->userNeedsNotify = true;
+                pUartData->pRxBufferStart = (char *) pReceiveBuffer;
+                if (pUartData->pRxBufferStart == NULL) {
+                    // Malloc memory for the read buffer
+                    pUartData->pRxBufferStart = (char *) malloc(receiveBufferSizeBytes);
+                    pUartData->rxBufferIsMalloced = true;
+                }
+                if ((pUartData->pRxBufferStart != NULL) &&
+                    (uPortMutexCreate(&(pUartData->txMutex)) == 0)) {
+                    pUartData->rxBufferSizeBytes = receiveBufferSizeBytes;
+                    // Now do the platform stuff
+                    handleOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    strncpy(pUartData->nameStr, nameStr, sizeof(pUartData->nameStr));
+                    pUartData->fd = open(pUartData->nameStr,
+                                         O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+                    if ((pUartData->fd >= 0) && (tcgetattr(pUartData->fd, &options) == 0)) {
+                        // Raw, 8 bits, no parity, one stop bit
+                        cfmakeraw(&options);
+                        options.c_cflag |= CLOCAL | CREAD;
+                        options.c_cflag &= ~(CSTOPB | PARENB);
+                        // Flow control is on if either of the flow
+                        // control pins is specified: Linux does not
+                        // separate CTS and RTS flow control
+                        options.c_cflag &= ~CRTSCTS;
+                        if ((pinCts >= 0) || (pinRts >= 0)) {
+                            options.c_cflag |= CRTSCTS;
+                            pUartData->flowControlEnabled = true;
+                        }
+                        options.c_cc[VMIN] = 0;
+                        options.c_cc[VTIME] = 0;
+                        cfsetispeed(&options, speed);
+                        cfsetospeed(&options, speed);
+                        if ((tcsetattr(pUartData->fd, TCSANOW, &options) == 0) &&
+                            (tcflush(pUartData->fd, TCIOFLUSH) == 0) &&
+                            (uartEpollSet(pUartData, EPOLL_CTL_ADD, EPOLLIN) == 0)) {
+                            // Done!
+                            handleOrErrorCode = pUartData->uartHandle;
+                        }
+                    }
+                }
+
+                if (handleOrErrorCode < 0) {
+                    // Clean up
+                    if (pUartData->fd >= 0) {
+                        close(pUartData->fd);
+                    }
+                    if (pUartData->txMutex != NULL) {
+                        uPortMutexDelete(pUartData->txMutex);
+                    }
+                    if (pUartData->rxBufferIsMalloced) {
+                        free(pUartData->pRxBufferStart);
+                    }
+                    uartRemove(pUartData);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return handleOrErrorCode;
+}
+
+// Close a UART instance.
+void uPortUartClose(int32_t handle)
+{
+    uPortUartData_t *pUartData = NULL;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            // Mark the UART for deletion within the mutex
+            pUartData->markedForDeletion = true;
+        } else {
+            pUartData = NULL;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (pUartData != NULL) {
+            // Actually delete the UART outside the mutex
+            uartCloseRequiresMutex(pUartData);
+        }
+    }
+}
+
+// Get the number of bytes waiting in the receive buffer.
+int32_t uPortUartGetReceiveSize(int32_t handle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            if (pUartData->rxBufferWrite >= pUartData->rxBufferRead) {
+                sizeOrErrorCode = (int32_t) (pUartData->rxBufferWrite -
+                                             pUartData->rxBufferRead);
+            } else {
+                sizeOrErrorCode = (int32_t) (pUartData->rxBufferSizeBytes -
+                                             pUartData->rxBufferRead +
+                                             pUartData->rxBufferWrite);
+            }
+            if (sizeOrErrorCode == 0) {
+                pUartData->userNeedsNotify = true;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Read from the given UART interface.
+int32_t uPortUartRead(int32_t handle, void *pBuffer,
+                      size_t sizeBytes)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    size_t thisSize;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if ((pBuffer != NULL) && (sizeBytes > 0) &&
+            (pUartData != NULL) && !pUartData->markedForDeletion) {
+            sizeOrErrorCode = 0;
+            // At most two copies: up to the end of the buffer
+            // and then from the start of the buffer
+            for (size_t x = 0; (x < 2) && (sizeBytes > 0) &&
+                 (pUartData->rxBufferRead != pUartData->rxBufferWrite); x++) {
+                if (pUartData->rxBufferWrite > pUartData->rxBufferRead) {
+                    thisSize = pUartData->rxBufferWrite - pUartData->rxBufferRead;
+                } else {
+                    thisSize = pUartData->rxBufferSizeBytes - pUartData->rxBufferRead;
+                }
+                if (thisSize > sizeBytes) {
+                    thisSize = sizeBytes;
+                }
+                memcpy(pBuffer, pUartData->pRxBufferStart + pUartData->rxBufferRead,
+                       thisSize);
+                pBuffer = (char *) pBuffer + thisSize;
+                sizeBytes -= thisSize;
+                sizeOrErrorCode += (int32_t) thisSize;
+                pUartData->rxBufferRead += thisSize;
+                if (pUartData->rxBufferRead >= pUartData->rxBufferSizeBytes) {
+                    pUartData->rxBufferRead = 0;
+                }
+            }
+
+            if ((sizeOrErrorCode > 0) && pUartData->rxPaused) {
+                // There is room again: start listening to the UART
+                pUartData->rxPaused = false;
+                uartEpollSet(pUartData, EPOLL_CTL_MOD, EPOLLIN);
+            }
+
+            if (sizeOrErrorCode == 0) {
+                pUartData->userNeedsNotify = true;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Write to the given UART interface.
+int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
+                       size_t sizeBytes)
+{
+    uPortUartIoVec_t ioVec;
+
+    ioVec.pBuffer = pBuffer;
+    ioVec.sizeBytes = sizeBytes;
+
+    return uartWritev(handle, &ioVec,
+                      ((pBuffer != NULL) && (sizeBytes > 0)) ? 1 : 0);
+}
+
+// Write several buffers to the given UART interface.
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    return uartWritev(handle, pIoVec, count);
+}
+
+// Set an event callback.
+int32_t uPortUartEventCallbackSet(int32_t handle,
+                                  uint32_t filter,
+                                  void (*pFunction)(int32_t,
+                                                    uint32_t,
+                                                    void *),
+                                  void *pParam,
+                                  size_t stackSizeBytes,
+                                  int32_t priority)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    char name[16];
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion &&
+            (pUartData->eventQueueHandle < 0) &&
+            (filter != 0) && (pFunction != NULL)) {
+            // Open an event queue to eventHandler()
+            // which will receive uPortUartEvent_t
+            // and give it a useful name for debug purposes
+            snprintf(name, sizeof(name), "eventUart%d", (int) handle);
+            errorCode = uPortEventQueueOpen(eventHandler, name,
+                                            sizeof(uPortUartEvent_t),
+                                            stackSizeBytes,
+                                            priority,
+                                            U_PORT_UART_EVENT_QUEUE_SIZE);
+            if (errorCode >= 0) {
+                pUartData->eventQueueHandle = errorCode;
+                pUartData->eventFilter = filter;
+                pUartData->pEventCallback = pFunction;
+                pUartData->pEventCallbackParam = pParam;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Remove an event callback.
+void uPortUartEventCallbackRemove(int32_t handle)
+{
+    int32_t eventQueueHandle = -1;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            // Save the eventQueueHandle and set all
+            // the parameters to indicate that the
+            // queue is closed
+            eventQueueHandle = pUartData->eventQueueHandle;
+            pUartData->eventQueueHandle = -1;
+            pUartData->pEventCallback = NULL;
+            pUartData->eventFilter = 0;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        // Now close the event queue
+        // outside the gMutex lock.  Reason for this
+        // is that the event task could be calling
+        // back into here and we don't want it
+        // blocked by us or we'll get stuck.
+        if (eventQueueHandle >= 0) {
+            uPortEventQueueClose(eventQueueHandle);
+        }
+    }
+}
+
+// Get the callback filter bit-mask.
+uint32_t uPortUartEventCallbackFilterGet(int32_t handle)
+{
+    uint32_t filter = 0;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            filter = pUartData->eventFilter;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return filter;
+}
+
+// Change the callback filter bit-mask.
+int32_t uPortUartEventCallbackFilterSet(int32_t handle,
+                                        uint32_t filter)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if ((filter != 0) && (pUartData != NULL) &&
+            !pUartData->markedForDeletion &&
+            (pUartData->eventQueueHandle >= 0)) {
+            pUartData->eventFilter = filter;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Send an event to the callback.
+int32_t uPortUartEventSend(int32_t handle, uint32_t eventBitMap)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    uPortUartEvent_t event;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion &&
+            (pUartData->eventQueueHandle >= 0) &&
+            // The only event we support right now
+            (eventBitMap == U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED)) {
+            event.uartHandle = handle;
+            event.eventBitMap = eventBitMap;
+            event.pEventCallback = pUartData->pEventCallback;
+            event.pEventCallbackParam = pUartData->pEventCallbackParam;
+            errorCode = uPortEventQueueSend(pUartData->eventQueueHandle,
+                                            &event, sizeof(event));
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Return true if we're in an event callback.
+bool uPortUartEventIsCallback(int32_t handle)
+{
+    bool isEventCallback = false;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion &&
+            (pUartData->eventQueueHandle >= 0)) {
+            isEventCallback = uPortEventQueueIsTask(pUartData->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return isEventCallback;
+}
+
+// Get the stack high watermark for the task on the event queue.
+int32_t uPortUartEventStackMinFree(int32_t handle)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion &&
+            (pUartData->eventQueueHandle >= 0)) {
+            sizeOrErrorCode = uPortEventQueueStackMinFree(pUartData->eventQueueHandle);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
+// Determine if RTS flow control is enabled.
+bool uPortUartIsRtsFlowControlEnabled(int32_t handle)
+{
+    bool rtsFlowControlIsEnabled = false;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            // RTS flow control is not affected by CTS suspension
+            rtsFlowControlIsEnabled = pUartData->flowControlEnabled;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return rtsFlowControlIsEnabled;
+}
+
+// Determine if CTS flow control is enabled.
+bool uPortUartIsCtsFlowControlEnabled(int32_t handle)
+{
+    bool ctsFlowControlIsEnabled = false;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && !pUartData->markedForDeletion) {
+            ctsFlowControlIsEnabled = isFlowControl(pUartData->fd);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return ctsFlowControlIsEnabled;
+}
+
+// Suspend CTS flow control: since Linux does not separate CTS
+// and RTS flow control this switches both off.
+int32_t uPortUartCtsSuspend(int32_t handle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if (pUartData != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            if (!pUartData->ctsFlowControlSuspended &&
+                isFlowControl(pUartData->fd)) {
+                errorCode = setFlowControl(pUartData->fd, false);
+                if (errorCode == 0) {
+                    pUartData->ctsFlowControlSuspended = true;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCode;
+}
+
+// Resume CTS flow control.
+void uPortUartCtsResume(int32_t handle)
+{
+    uPortUartData_t *pUartData;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pUartData = pUartGetByHandle(handle);
+        if ((pUartData != NULL) && (pUartData->ctsFlowControlSuspended)) {
+            if (setFlowControl(pUartData->fd, true) == 0) {
+                pUartData->ctsFlowControlSuspended = false;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+}
+
+// End of file
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2022 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CFG_OS_PLATFORM_SPECIFIC_H_
+#define _U_CFG_OS_PLATFORM_SPECIFIC_H_
+
+/* No #includes allowed here */
+
+/** @file
+ * @brief This header file contains OS configuration information for
+ * Linux/POSIX.
+ */
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS FOR LINUX: HEAP
+ * -------------------------------------------------------------- */
+
+/** Not stricty speaking part of the OS but there's nowhere better
+ * to put this.  Set this to 1 if the C library does not free memory
+ * that it has alloced internally when a task is deleted.
+ * For instance, newlib when it is compiled in a certain way
+ * does this on some platforms.
+ */
+#define U_CFG_OS_CLIB_LEAKS 0
+
+#ifndef U_CFG_OS_HEAP_SIZE_BYTES
+/** There is no fixed heap on Linux; uPortGetHeapFree() and
+ * uPortGetHeapMinFree() report the amount of memory allocated
+ * through malloc() subtracted from this notional figure, which
+ * is large enough that the heap checks of the tests never fail
+ * for real, while leak checks (which compare before/after
+ * values) remain valid.
+ */
+# define U_CFG_OS_HEAP_SIZE_BYTES (1024 * 1024 * 64)
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS FOR LINUX: OS GENERIC
+ * -------------------------------------------------------------- */
+
+#ifndef U_CFG_OS_PRIORITY_MIN
+/** The minimum task priority.  Priorities are checked for
+ * range but are otherwise not applied on Linux since an
+ * unprivileged process cannot change the scheduling of
+ * its threads.
+ */
+# define U_CFG_OS_PRIORITY_MIN 0
+#endif
+
+#ifndef U_CFG_OS_PRIORITY_MAX
+/** The maximum task priority.
+ */
+# define U_CFG_OS_PRIORITY_MAX 15
+#endif
+
+#ifndef U_CFG_OS_YIELD_MS
+/** The amount of time to block for to ensure that a yield
+ * occurs.
+ */
+# define U_CFG_OS_YIELD_MS 1
+#endif
+
+#ifndef U_CFG_OS_EXECUTABLE_CHUNK_INDEX_0_SIZE
+/** The size of the chunk of executable RAM returned by
+ * uPortAcquireExecutableChunk().
+ */
+# define U_CFG_OS_EXECUTABLE_CHUNK_INDEX_0_SIZE (1024 * 32)
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS FOR LINUX: STACK SIZES/PRIORITIES
+ * -------------------------------------------------------------- */
+
+/** How much stack the task running all the examples and tests needs
+ * in bytes, plus slack for the users own code.
+ */
+#define U_CFG_OS_APP_TASK_STACK_SIZE_BYTES (1024 * 8)
+
+/** The priority of the task running the examples and tests: can be
+ * middling on Linux where there are few constraints.
+ */
+#define U_CFG_OS_APP_TASK_PRIORITY   7
+
+#endif // _U_CFG_OS_PLATFORM_SPECIFIC_H_
+
+// End of file
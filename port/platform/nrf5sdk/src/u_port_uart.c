@@ -794,6 +794,53 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
     return (int32_t) sizeOrErrorCode;
 }
 
+// Write several buffers to the given UART interface, with the
+// mutex held throughout so that they go out back to back.
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    NRF_UARTE_Type *pReg;
+    uartTxData_t txData;
+    uPortQueueHandle_t txQueueHandle;
+    bool paramsOk = (pIoVec != NULL) && (count > 0);
+
+    for (size_t x = 0; paramsOk && (x < count); x++) {
+        paramsOk = (pIoVec[x].pBuffer != NULL) || (pIoVec[x].sizeBytes == 0);
+    }
+
+    if (gMutex != NULL) {
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (paramsOk && (handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0]))) {
+
+            U_PORT_MUTEX_LOCK(gMutex);
+            pReg = gUartData[handle].pReg;
+            txQueueHandle = gUartData[handle].txQueueHandle;
+
+            sizeOrErrorCode = 0;
+            for (size_t x = 0; x < count; x++) {
+                if (pIoVec[x].sizeBytes > 0) {
+                    txData.handle = handle;
+                    txData.pData = (void *) pIoVec[x].pBuffer;
+                    txData.len = pIoVec[x].sizeBytes;
+                    // enqueue the buffer here and retrieve it when
+                    // the TXSTOPPED interrupt is triggered.
+                    uPortQueueSend(txQueueHandle, (void *) &txData);
+                    nrf_uarte_int_enable(pReg, NRF_UARTE_INT_TXSTOPPED_MASK);
+                    uPortSemaphoreTake(gUartData[handle].txSem);
+                    sizeOrErrorCode += (int32_t) pIoVec[x].sizeBytes;
+                }
+            }
+            U_PORT_MUTEX_UNLOCK(gMutex);
+        }
+
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Set an event callback.
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
@@ -355,6 +355,14 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
     (void) sizeBytes;
     return 0;
 }
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    (void) handle;
+    (void) pIoVec;
+    (void) count;
+    return 0;
+}
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
                                   void (*pFunction)(int32_t, uint32_t,
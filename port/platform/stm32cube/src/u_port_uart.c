@@ -1324,6 +1324,56 @@ int32_t uPortUartWrite(int32_t handle,
     return (int32_t) sizeOrErrorCode;
 }
 
+// Write several buffers to the given UART interface: they are
+// fed to the transmit register back to back, waiting for the
+// transmission to complete only at the end.
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uPortUartData_t *pUartData;
+    USART_TypeDef *pReg;
+    const char *pData;
+    size_t sizeBytes;
+    bool paramsOk = (pIoVec != NULL) && (count > 0);
+
+    for (size_t x = 0; paramsOk && (x < count); x++) {
+        paramsOk = (pIoVec[x].pBuffer != NULL) || (pIoVec[x].sizeBytes == 0);
+    }
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pGetUartDataByHandle(handle);
+        if (paramsOk && (pUartData != NULL)) {
+            pReg = gUartCfg[pUartData->uart].pReg;
+            sizeOrErrorCode = 0;
+
+            // Do the blocking send
+            for (size_t x = 0; x < count; x++) {
+                pData = (const char *) pIoVec[x].pBuffer;
+                sizeBytes = pIoVec[x].sizeBytes;
+                sizeOrErrorCode += (int32_t) sizeBytes;
+                while (sizeBytes > 0) {
+                    LL_USART_TransmitData8(pReg, (uint8_t) *pData);
+                    // See the hint in uPortUartWrite() if your
+                    // code stops dead here
+                    while (!LL_USART_IsActiveFlag_TXE(pReg)) {}
+                    pData++;
+                    sizeBytes--;
+                }
+            }
+            while (!LL_USART_IsActiveFlag_TC(pReg)) {}
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
 // Set an event callback.
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
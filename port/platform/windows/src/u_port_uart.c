@@ -493,6 +493,62 @@ static int32_t waitCommEventThread(void *pParam)
     ExitThread(0);
 }
 
+// Write the given buffers to a UART; Windows has no gather write
+// for a serial port so the buffers are written one after the
+// other with the mutex held throughout, which keeps them together.
+static int32_t uartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                          size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    OVERLAPPED overlap;
+    DWORD bytesWritten;
+    uPortUartData_t *pUartData;
+    bool paramsOk = (pIoVec != NULL) && (count > 0);
+
+    for (size_t x = 0; paramsOk && (x < count); x++) {
+        paramsOk = (pIoVec[x].pBuffer != NULL) || (pIoVec[x].sizeBytes == 0);
+    }
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pUartData = pUartGetByHandle(handle);
+        if (paramsOk && (pUartData != NULL) && !pUartData->markedForDeletion) {
+            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            memset(&overlap, 0, sizeof(overlap));
+            overlap.hEvent = CreateEvent(NULL, true, false, NULL);
+            if (overlap.hEvent != INVALID_HANDLE_VALUE) {
+                sizeOrErrorCode = 0;
+                for (size_t x = 0; (x < count) && (sizeOrErrorCode >= 0); x++) {
+                    if (pIoVec[x].sizeBytes > 0) {
+                        bytesWritten = 0;
+                        ResetEvent(overlap.hEvent);
+                        if (WriteFile(pUartData->windowsUartHandle, pIoVec[x].pBuffer,
+                                      pIoVec[x].sizeBytes, &bytesWritten, &overlap) ||
+                            ((GetLastError() == ERROR_IO_PENDING) &&
+                             GetOverlappedResult(pUartData->windowsUartHandle,
+                                                 &overlap, &bytesWritten, true))) {
+                            sizeOrErrorCode += (int32_t) bytesWritten;
+                        } else if (sizeOrErrorCode == 0) {
+                            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                        } else {
+                            break;
+                        }
+                    }
+                }
+            }
+
+            CloseHandle(overlap.hEvent);
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return sizeOrErrorCode;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -829,39 +885,20 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
 int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
                        size_t sizeBytes)
 {
-    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
-    OVERLAPPED overlap;
-    DWORD bytesWritten = 0;
-    uPortUartData_t *pUartData;
-
-    if (gMutex != NULL) {
-
-        U_PORT_MUTEX_LOCK(gMutex);
-
-        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-        pUartData = pUartGetByHandle(handle);
-        if ((pBuffer != NULL) && (sizeBytes > 0) &&
-            (pUartData != NULL) && !pUartData->markedForDeletion) {
-            sizeOrErrorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
-            memset(&overlap, 0, sizeof(overlap));
-            overlap.hEvent = CreateEvent(NULL, true, false, NULL);
-            if (overlap.hEvent != INVALID_HANDLE_VALUE) {
-                if (WriteFile(pUartData->windowsUartHandle, pBuffer,
-                              sizeBytes, &bytesWritten, &overlap) ||
-                    ((GetLastError() == ERROR_IO_PENDING) &&
-                     GetOverlappedResult(pUartData->windowsUartHandle,
-                                         &overlap, &bytesWritten, true))) {
-                    sizeOrErrorCode = (int32_t) bytesWritten;
-                }
-            }
+    uPortUartIoVec_t ioVec;
 
-            CloseHandle(overlap.hEvent);
-        }
+    ioVec.pBuffer = pBuffer;
+    ioVec.sizeBytes = sizeBytes;
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
-    }
+    return uartWritev(handle, &ioVec,
+                      ((pBuffer != NULL) && (sizeBytes > 0)) ? 1 : 0);
+}
 
-    return sizeOrErrorCode;
+// Write several buffers to the given UART interface.
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    return uartWritev(handle, pIoVec, count);
 }
 
 // Set an event callback.
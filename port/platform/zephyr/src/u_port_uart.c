@@ -521,6 +521,50 @@ int32_t uPortUartWrite(int32_t handle, const void *pBuffer,
     return (int32_t) errorCode;
 }
 
+// Write several buffers to the given UART interface, with the
+// mutex held throughout so that they go out back to back.
+int32_t uPortUartWritev(int32_t handle, const uPortUartIoVec_t *pIoVec,
+                        size_t count)
+{
+    int32_t sizeOrErrorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    struct uartData_t data;
+    bool paramsOk = (pIoVec != NULL) && (count > 0);
+
+    for (size_t x = 0; paramsOk && (x < count); x++) {
+        paramsOk = (pIoVec[x].pBuffer != NULL) || (pIoVec[x].sizeBytes == 0);
+    }
+
+    if (gMutex != NULL) {
+        sizeOrErrorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (paramsOk && (handle >= 0) &&
+            (handle < sizeof(gUartData) / sizeof(gUartData[0])) &&
+            (gUartData[handle].pDevice != NULL)) {
+
+            U_PORT_MUTEX_LOCK(gMutex);
+
+            sizeOrErrorCode = 0;
+            for (size_t x = 0; x < count; x++) {
+                if (pIoVec[x].sizeBytes > 0) {
+                    data.handle = handle;
+                    data.pData = (void *) pIoVec[x].pBuffer;
+                    data.len = pIoVec[x].sizeBytes;
+                    // See the hint in uPortUartWrite() if your
+                    // code stops dead here
+                    k_fifo_put(&gUartData[handle].fifoTxData, &data);
+                    uart_irq_tx_enable(gUartData[handle].pDevice);
+                    // data is on the stack: wait for it to be sent
+                    k_sem_take(&gUartData[handle].txSem, K_FOREVER);
+                    sizeOrErrorCode += (int32_t) pIoVec[x].sizeBytes;
+                }
+            }
+
+            U_PORT_MUTEX_UNLOCK(gMutex);
+        }
+    }
+
+    return sizeOrErrorCode;
+}
+
 int32_t uPortUartEventCallbackSet(int32_t handle,
                                   uint32_t filter,
                                   void (*pFunction)(int32_t,
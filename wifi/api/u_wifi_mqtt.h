@@ -114,6 +114,32 @@ int32_t uWifiMqttSetMessageCallback(const uMqttClientContext_t *pContext,
                                     void (*pCallback) (int32_t, void *),
                                     void *pCallbackParam);
 
+/** Set a callback to be called with each MQTT message as it is
+ * received, instead of storing it for uWifiMqttMessageRead(); see
+ * uMqttClientSetMessageReceiveCallback() for the details.  The
+ * message is handed over where it lies in the EDM stream buffer,
+ * hence pMessage is not NULL, and the callback is called from the
+ * EDM stream task.  Any messages stored before the callback was set
+ * are handed to it, from the calling task, before this function
+ * returns: since these may wrap in the session's ring buffer their
+ * pMessage is NULL and they must be read with
+ * uMqttClientMessageReceiveRead().
+ *
+ * @param pContext          client context returned by pUMqttClientOpen().
+ * @param pCallback         the callback. The first parameter to
+ *                          the callback is the received message,
+ *                          the second parameter is pCallbackParam.
+ *                          Use NULL to deregister a previous callback.
+ * @param pCallbackParam    this value will be passed to pCallback
+ *                          as the second parameter.
+ * @return                  zero on success else negative error
+ *                          code.
+ */
+int32_t uWifiMqttSetMessageReceiveCallback(const uMqttClientContext_t *pContext,
+                                           void (*pCallback) (uMqttMessage_t *,
+                                                              void *),
+                                           void *pCallbackParam);
+
 /** Set a callback to be called if the MQTT client disconnects
  * from the boker. WiFi MQTT client triggers disconnect callback
  * Error code will be set to U_ERROR_COMMON_TIMEOUT,
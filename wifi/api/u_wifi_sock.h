@@ -76,7 +76,12 @@ extern "C" {
 #endif
 
 
-/** Size of receive buffer for a connected data channel
+/** Default size of the receive buffer of a connected data
+ * channel; this may be changed per socket, before any data has
+ * been received, with the U_SOCK_OPT_RCVBUF option.  When the
+ * buffer is full further received data is held back by the EDM
+ * stream, rather than being dropped, until the application has
+ * read from the socket.
  */
 #ifndef U_WIFI_SOCK_BUFFER_SIZE
 #define U_WIFI_SOCK_BUFFER_SIZE 2048
@@ -407,6 +412,20 @@ int32_t uWifiSockRegisterCallbackClosed(int32_t wifiHandle,
                                         int32_t sockHandle,
                                         uWifiSockCallback_t pCallback);
 
+/** Get the number of bytes waiting to be read on the given
+ * socket, i.e. the fill level of its receive buffer.  For a UDP
+ * socket this includes the per-datagram headers so it should only
+ * be used as a "something to read" indication.
+ *
+ * @param wifiHandle  the handle of the wifi instance.
+ * @param sockHandle  the handle of the socket.
+ * @return            the number of bytes waiting to be read
+ *                    else negated value of U_SOCK_Exxx from
+ *                    u_sock_errno.h.
+ */
+int32_t uWifiSockGetBytesPending(int32_t wifiHandle,
+                                 int32_t sockHandle);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: TCP INCOMING (TCP SERVER) ONLY - Not implemeneted yet!
  * -------------------------------------------------------------- */
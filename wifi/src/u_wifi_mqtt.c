@@ -61,6 +61,7 @@
 #include "u_short_range_private.h"
 #include "u_short_range_edm_stream.h"
 #include "u_ringbuffer.h"
+#include "u_hash.h"
 #include "u_short_range_sec_tls.h"
 
 /* ----------------------------------------------------------------
@@ -69,15 +70,35 @@
 #define U_WIFI_MQTT_DATA_EVENT_STACK_SIZE 1536
 #define U_WIFI_MQTT_DATA_EVENT_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
 
+#ifndef U_WIFI_MQTT_TOPIC_HASH_NUM_BUCKETS
+/** The number of hash buckets used to look up the topics of
+ * an MQTT session by name; must be a power of two.
+ */
+# define U_WIFI_MQTT_TOPIC_HASH_NUM_BUCKETS 16
+#endif
+
+#ifndef U_WIFI_MQTT_EDM_CHANNEL_MAX_NUM
+/** The number of EDM channels which can be mapped directly
+ * to their topic; a topic on an EDM channel at or beyond
+ * this number is still found, just by searching.
+ */
+# define U_WIFI_MQTT_EDM_CHANNEL_MAX_NUM 32
+#endif
+
+struct uWifiMqttSession_t;
+
 typedef struct uWifiMqttTopic_t {
     char *pTopicStr;
+    uint32_t hash;
     int32_t edmChannel;
     int32_t peerHandle;
     bool isTopicUnsubscribed;
     bool isPublish;
     uMqttQos_t qos;
     bool retain;
+    struct uWifiMqttSession_t *pMqttSession;
     struct uWifiMqttTopic_t *pNext;
+    struct uWifiMqttTopic_t *pHashNext;
 } uWifiMqttTopic_t;
 
 typedef struct uWifiMqttTopicList_t {
@@ -95,6 +116,7 @@ typedef struct uWifiMqttSession_t {
     bool keepAlive;
     uRingBuffer_t rxRingBuffer;
     uWifiMqttTopicList_t topicList;
+    uWifiMqttTopic_t *pTopicHash[U_WIFI_MQTT_TOPIC_HASH_NUM_BUCKETS];
     int32_t sessionHandle;
     uAtClientHandle_t atHandle;
     int32_t localPort;
@@ -103,6 +125,8 @@ typedef struct uWifiMqttSession_t {
     void *pCbParam;
     void (*pDataCb)(int32_t unreadMsgsCount, void *pCbParam);
     void (*pDisconnectCb)(int32_t status, void *pCbParam);
+    void *pReceiveCbParam;
+    void (*pReceiveCb)(uMqttMessage_t *pMessage, void *pReceiveCbParam);
 } uWifiMqttSession_t;
 
 typedef struct {
@@ -117,24 +141,72 @@ static uWifiMqttSession_t gMqttSessions[U_WIFI_MQTT_MAX_NUM_CONNECTIONS];
 static uPortMutexHandle_t gMqttSessionMutex = NULL;
 static int32_t gCallbackQueue = (int32_t)U_ERROR_COMMON_NOT_INITIALISED;
 static int32_t gEdmChannel = -1;
+static uWifiMqttTopic_t *gpEdmChannelTopic[U_WIFI_MQTT_EDM_CHANNEL_MAX_NUM] = {NULL};
 
 /**
- * Fetch the topic string in a given MQTT session associated to particular EDM channel
+ * Hash a topic string.
  */
-static char *getTopicStrForEdmChannel(uWifiMqttSession_t *pMqttSession, int32_t edmChannel)
+static uint32_t topicHash(const char *pTopicStr)
 {
-    uWifiMqttTopic_t *pTopic;
-    char *pTopicNameStr = NULL;
+    return uFnv1a32(pTopicStr, strlen(pTopicStr), U_FNV1A32_INITIAL_VALUE);
+}
+
+/**
+ * Fetch the topic object associated to a particular EDM channel
+ */
+static uWifiMqttTopic_t *getTopicForEdmChannel(int32_t edmChannel)
+{
+    uWifiMqttTopic_t *pTopic = NULL;
 
-    for (pTopic = pMqttSession->topicList.pHead; pTopic != NULL; pTopic = pTopic->pNext) {
+    if ((edmChannel >= 0) && (edmChannel < U_WIFI_MQTT_EDM_CHANNEL_MAX_NUM)) {
 
-        if (pTopic->edmChannel == edmChannel) {
+        pTopic = gpEdmChannelTopic[edmChannel];
 
-            pTopicNameStr = pTopic->pTopicStr;
+    } else if (edmChannel >= 0) {
 
+        for (size_t i = 0; (i < U_WIFI_MQTT_MAX_NUM_CONNECTIONS) && (pTopic == NULL); i++) {
+            for (pTopic = gMqttSessions[i].topicList.pHead;
+                 (pTopic != NULL) && (pTopic->edmChannel != edmChannel);
+                 pTopic = pTopic->pNext) {
+            }
         }
     }
 
+    return pTopic;
+}
+
+/**
+ * Set the EDM channel of a topic object, keeping the EDM channel map
+ * up to date; use -1 to remove the topic from the map
+ */
+static void setTopicEdmChannel(uWifiMqttTopic_t *pTopic, int32_t edmChannel)
+{
+    if ((pTopic->edmChannel >= 0) &&
+        (pTopic->edmChannel < U_WIFI_MQTT_EDM_CHANNEL_MAX_NUM) &&
+        (gpEdmChannelTopic[pTopic->edmChannel] == pTopic)) {
+        gpEdmChannelTopic[pTopic->edmChannel] = NULL;
+    }
+
+    pTopic->edmChannel = edmChannel;
+
+    if ((edmChannel >= 0) && (edmChannel < U_WIFI_MQTT_EDM_CHANNEL_MAX_NUM)) {
+        gpEdmChannelTopic[edmChannel] = pTopic;
+    }
+}
+
+/**
+ * Fetch the topic string in a given MQTT session associated to particular EDM channel
+ */
+static char *getTopicStrForEdmChannel(const uWifiMqttSession_t *pMqttSession, int32_t edmChannel)
+{
+    uWifiMqttTopic_t *pTopic;
+    char *pTopicNameStr = NULL;
+
+    pTopic = getTopicForEdmChannel(edmChannel);
+    if ((pTopic != NULL) && (pTopic->pMqttSession == pMqttSession)) {
+        pTopicNameStr = pTopic->pTopicStr;
+    }
+
     return pTopicNameStr;
 }
 
@@ -145,32 +217,44 @@ static uWifiMqttTopic_t *findTopic (uWifiMqttSession_t *pMqttSession, const char
                                     bool isPublish)
 {
     uWifiMqttTopic_t *pTemp;
-    uWifiMqttTopic_t *pFoundTopic = NULL;
+    uint32_t hash = topicHash(pTopicStr);
 
-    for (pTemp = pMqttSession->topicList.pHead; pTemp != NULL; pTemp = pTemp->pNext) {
+    for (pTemp = pMqttSession->pTopicHash[hash & (U_WIFI_MQTT_TOPIC_HASH_NUM_BUCKETS - 1)];
+         pTemp != NULL; pTemp = pTemp->pHashNext) {
         //lint -save -e731
-        if ((strcmp(pTemp->pTopicStr, pTopicStr) == 0) && (isPublish == pTemp->isPublish)) {
-            pFoundTopic = pTemp;
+        if ((pTemp->hash == hash) && (isPublish == pTemp->isPublish) &&
+            (strcmp(pTemp->pTopicStr, pTopicStr) == 0)) {
+            break;
         }
         //lint -restore
     }
 
-    return pFoundTopic;
+    return pTemp;
 }
 
 /**
- * Allocate topic object and associate it to a given MQTT session
+ * Allocate topic object, with a copy of the topic string,
+ * and associate it to a given MQTT session
  */
-static uWifiMqttTopic_t *pAllocateMqttTopic (uWifiMqttSession_t *pMqttSession, bool isPublish)
+static uWifiMqttTopic_t *pAllocateMqttTopic (uWifiMqttSession_t *pMqttSession,
+                                             const char *pTopicStr, bool isPublish)
 {
     uWifiMqttTopic_t *pTopic = NULL;
+    uWifiMqttTopic_t **ppBucket;
+    size_t len;
 
-    if (pMqttSession != NULL) {
+    if ((pMqttSession != NULL) && (pTopicStr != NULL)) {
 
-        pTopic = (uWifiMqttTopic_t *)malloc(sizeof(uWifiMqttTopic_t));
+        len = strlen(pTopicStr);
+        // The topic string goes in the same allocation, after the topic
+        pTopic = (uWifiMqttTopic_t *)malloc(sizeof(uWifiMqttTopic_t) + len + 1);
 
         if (pTopic != NULL) {
 
+            pTopic->pTopicStr = (char *) (pTopic + 1);
+            memcpy(pTopic->pTopicStr, pTopicStr, len + 1);
+            pTopic->hash = topicHash(pTopicStr);
+            pTopic->pMqttSession = pMqttSession;
             pTopic->pNext = NULL;
 
             if (pMqttSession->topicList.pHead == NULL) {
@@ -184,6 +268,10 @@ static uWifiMqttTopic_t *pAllocateMqttTopic (uWifiMqttSession_t *pMqttSession, b
 
             pMqttSession->topicList.pTail = pTopic;
 
+            ppBucket = &pMqttSession->pTopicHash[pTopic->hash & (U_WIFI_MQTT_TOPIC_HASH_NUM_BUCKETS - 1)];
+            pTopic->pHashNext = *ppBucket;
+            *ppBucket = pTopic;
+
             pTopic->peerHandle = -1;
             pTopic->edmChannel = -1;
             pTopic->isTopicUnsubscribed = false;
@@ -200,11 +288,21 @@ static void freeMqttTopic(uWifiMqttSession_t *pMqttSession, uWifiMqttTopic_t *pT
 {
     uWifiMqttTopic_t *pPrev;
     uWifiMqttTopic_t *pCurr;
+    uWifiMqttTopic_t **ppHash;
+
+    for (ppHash = &pMqttSession->pTopicHash[pTopic->hash & (U_WIFI_MQTT_TOPIC_HASH_NUM_BUCKETS - 1)];
+         *ppHash != NULL; ppHash = &(*ppHash)->pHashNext) {
+
+        if (*ppHash == pTopic) {
+            *ppHash = pTopic->pHashNext;
+            break;
+        }
+    }
 
     for (pPrev = NULL, pCurr = pMqttSession->topicList.pHead; pCurr != NULL;
          pPrev = pCurr, pCurr = pCurr->pNext) {
 
-        if (strcmp(pCurr->pTopicStr, pTopic->pTopicStr) == 0) {
+        if (pCurr == pTopic) {
 
             if (pPrev == NULL) {
 
@@ -215,7 +313,10 @@ static void freeMqttTopic(uWifiMqttSession_t *pMqttSession, uWifiMqttTopic_t *pT
                 pPrev->pNext = pCurr->pNext;
 
             }
-            free(pCurr->pTopicStr);
+            if (pMqttSession->topicList.pTail == pCurr) {
+                pMqttSession->topicList.pTail = pPrev;
+            }
+            setTopicEdmChannel(pCurr, -1);
             free(pCurr);
             break;
         }
@@ -233,12 +334,13 @@ static void freeAllMqttTopics(uWifiMqttSession_t *pMqttSession)
     for (pTemp = pMqttSession->topicList.pHead; pTemp != NULL; pTemp = pNext) {
 
         pNext = pTemp->pNext;
-        free(pTemp->pTopicStr);
+        setTopicEdmChannel(pTemp, -1);
         free(pTemp);
     }
 
     pMqttSession->topicList.pHead = NULL;
     pMqttSession->topicList.pTail = NULL;
+    memset(pMqttSession->pTopicHash, 0, sizeof(pMqttSession->pTopicHash));
 }
 
 static int32_t copyConnectionParams(char **ppMqttSessionParams,
@@ -493,18 +595,75 @@ static void onCallbackEvent(void *pParam, size_t eventSize)
         pCbEvent->pDisconnectCb(pCbEvent->disconnStatus, pCbEvent->pCbParam);
     }
 }
+/**
+ * Read the next chunk of a stored message handed to a message
+ * receive callback: pReadContext is the session's ring buffer.
+ */
+static int32_t storedMessageRead(uMqttMessage_t *pMessage, char *pBuffer,
+                                 size_t bufferSizeBytes)
+{
+    uRingBuffer_t *pRingBuffer = (uRingBuffer_t *) pMessage->pReadContext;
+
+    if (pBuffer == NULL) {
+        return (int32_t)uRingBufferSkip(pRingBuffer, bufferSizeBytes);
+    }
+
+    return (int32_t)uRingBufferRead(pRingBuffer, pBuffer, bufferSizeBytes);
+}
+
+/**
+ * Hand any messages stored in the ringbuffer over to the message
+ * receive callback; gMqttSessionMutex must be locked.
+ */
+static void storedMessagesDeliver(uWifiMqttSession_t *pMqttSession)
+{
+    uWifiMqttTopic_t *pTopic;
+    uint16_t msgLen;
+    uint8_t edmChannel;
+
+    while ((pMqttSession->unreadMsgsCount > 0) && (pMqttSession->pReceiveCb != NULL)) {
+        msgLen = 0;
+        edmChannel = 0;
+        // Same format as uWifiMqttMessageRead() reads
+        uRingBufferRead(&pMqttSession->rxRingBuffer, (char *)&msgLen, 2);
+        uRingBufferRead(&pMqttSession->rxRingBuffer, (char *)&edmChannel, 1);
+        pTopic = getTopicForEdmChannel((int32_t)edmChannel);
+        if ((pTopic != NULL) && (pTopic->pMqttSession == pMqttSession)) {
+            // The message may wrap in the ringbuffer so it is
+            // read out by the callback rather than pointed at
+            //lint -save -e785
+            uMqttMessage_t message = {
+                .pTopicNameStr = pTopic->pTopicStr,
+                .pMessage = NULL,
+                .messageSizeBytes = (size_t)msgLen,
+                .qos = pTopic->qos,
+                .readOffset = 0,
+                .pReadFunction = storedMessageRead,
+                .pReadContext = &pMqttSession->rxRingBuffer
+            };
+            //lint -restore
+            pMqttSession->pReceiveCb(&message, pMqttSession->pReceiveCbParam);
+            // Discard whatever the callback did not read
+            uRingBufferSkip(&pMqttSession->rxRingBuffer, message.messageSizeBytes - message.readOffset);
+        } else {
+            // As uWifiMqttMessageRead(), drop a message that has no topic
+            uRingBufferSkip(&pMqttSession->rxRingBuffer, msgLen);
+        }
+        pMqttSession->unreadMsgsCount--;
+    }
+}
+
 /**
  * EDM data callback to store the data in ringbuffer.
  * Data will be stored in the following format
  * (length of message(2 bytes) + edm channel id (1 byte) + original message)
  */
 
-static void edmMqttDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t length,
-                                char *pData, void *pCallbackParameter)
+static int32_t edmMqttDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t length,
+                                   char *pData, void *pCallbackParameter)
 {
     uWifiMqttSession_t *pMqttSession = NULL;
     uWifiMqttTopic_t *pTopic;
-    int32_t i;
     uint16_t len;
     uint8_t edmChan;
     (void) edmHandle;
@@ -512,53 +671,63 @@ static void edmMqttDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t l
 
     U_PORT_MUTEX_LOCK(gMqttSessionMutex);
 
-    for (i = 0; i < U_WIFI_MQTT_MAX_NUM_CONNECTIONS; i++) {
-
-        pMqttSession = &gMqttSessions[i];
+    pTopic = getTopicForEdmChannel(edmChannel);
 
-        for (pTopic = pMqttSession->topicList.pHead; pTopic != NULL; pTopic = pTopic->pNext) {
+    if ((pTopic != NULL) && (!pTopic->isTopicUnsubscribed)) {
 
-            if ((pTopic->edmChannel == edmChannel) && (!pTopic->isTopicUnsubscribed)) {
+        pMqttSession = pTopic->pMqttSession;
+        uPortLog("U_WIFI_MQTT: EDM data event for channel %d\n", edmChannel);
 
-                uPortLog("U_WIFI_MQTT: EDM data event for channel %d\n", edmChannel);
+        if (pMqttSession->pReceiveCb != NULL) {
+            // Hand the message straight over from where it lies
+            //lint -save -e785
+            uMqttMessage_t message = {
+                .pTopicNameStr = pTopic->pTopicStr,
+                .pMessage = pData,
+                .messageSizeBytes = (size_t)length,
+                .qos = pTopic->qos
+            };
+            //lint -restore
+            pMqttSession->pReceiveCb(&message, pMqttSession->pReceiveCbParam);
+        } else {
+            len = (uint16_t)length;
+            edmChan = (uint8_t)edmChannel;
 
-                len = (uint16_t)length;
-                edmChan = (uint8_t)edmChannel;
+            // We store the message in ringbuffer in a format (length of message(2 bytes) + edm channel id (1 byte) + original message)
+            // Check if we have enough room size to fit all of these.
+            //lint -save -e571
+            //lint -save -e776
+            if (uRingBufferAvailableSize(&pMqttSession->rxRingBuffer) > (size_t)(3 + length)) {
 
-                // We store the message in ringbuffer in a format (length of message(2 bytes) + edm channel id (1 byte) + original message)
-                // Check if we have enough room size to fit all of these.
-                //lint -save -e571
-                //lint -save -e776
-                if (uRingBufferAvailableSize(&pMqttSession->rxRingBuffer) > (size_t)(3 + length)) {
+                uRingBufferAdd(&pMqttSession->rxRingBuffer, (const char *)&len, 2);
+                uRingBufferAdd(&pMqttSession->rxRingBuffer, (const char *)&edmChan, 1);
+                uRingBufferAdd(&pMqttSession->rxRingBuffer, pData, length);
 
-                    uRingBufferAdd(&pMqttSession->rxRingBuffer, (const char *)&len, 2);
-                    uRingBufferAdd(&pMqttSession->rxRingBuffer, (const char *)&edmChan, 1);
-                    uRingBufferAdd(&pMqttSession->rxRingBuffer, pData, length);
+                pMqttSession->unreadMsgsCount++;
+            } else {
+                uPortLog("U_WIFI_MQTT: RX FIFO full, dropping %d bytes!\n", length);
+            }
+            //lint -restore
+            //lint -restore
 
-                    pMqttSession->unreadMsgsCount++;
-                } else {
-                    uPortLog("U_WIFI_MQTT: RX FIFO full, dropping %d bytes!\n", length);
-                }
-                //lint -restore
+            // Schedule user data pDataCb
+            if (pMqttSession->pDataCb) {
+                //lint -save -e785
+                uCallbackEvent_t event = {
+                    .pDataCb = pMqttSession->pDataCb,
+                    .pDisconnectCb = NULL,
+                    .pCbParam = pMqttSession->pCbParam,
+                    .pMqttSession = pMqttSession
+                };
                 //lint -restore
-
-                // Schedule user data pDataCb
-                if (pMqttSession->pDataCb) {
-                    //lint -save -e785
-                    uCallbackEvent_t event = {
-                        .pDataCb = pMqttSession->pDataCb,
-                        .pDisconnectCb = NULL,
-                        .pCbParam = pMqttSession->pCbParam,
-                        .pMqttSession = pMqttSession
-                    };
-                    //lint -restore
-                    uPortEventQueueSend(gCallbackQueue, &event, sizeof(event));
-                }
+                uPortEventQueueSend(gCallbackQueue, &event, sizeof(event));
             }
         }
     }
 
     U_PORT_MUTEX_UNLOCK(gMqttSessionMutex);
+
+    return length;
 }
 
 
@@ -612,14 +781,14 @@ static void atMqttConnectionCallback(int32_t shortRangeHandle,
                 switch (eventType) {
                     case U_SHORT_RANGE_EVENT_CONNECTED:
                         uPortLog("U_WIFI_MQTT: AT+UUDCPC connect event for connHandle %d\n", connHandle);
-                        pTopic->edmChannel = gEdmChannel;
+                        setTopicEdmChannel(pTopic, gEdmChannel);
                         pTopic->peerHandle = connHandle;
                         topicFound = true;
                         break;
                     case U_SHORT_RANGE_EVENT_DISCONNECTED:
                         uPortLog("U_WIFI_MQTT: AT+UUDCPC disconnect event for connHandle %d\n", connHandle);
                         pTopic->peerHandle = -1;
-                        pTopic->edmChannel = -1;
+                        setTopicEdmChannel(pTopic, -1);
                         topicFound = true;
                         pMqttSession->isConnected = false;
                         // Report to user that we are disconnected
@@ -843,7 +1012,8 @@ static int32_t configureMqttSessionConnection(uWifiMqttSession_t *pMqttSession,
             }
         }
         if (err == 0) {
-            uRingBufferCreate(&pMqttSession->rxRingBuffer, pMqttSession->pRxBuffer, U_WIFI_MQTT_BUFFER_SIZE);
+            uRingBufferCreateLockFree(&pMqttSession->rxRingBuffer, pMqttSession->pRxBuffer,
+                                      U_WIFI_MQTT_BUFFER_SIZE);
         }
     }
 
@@ -990,6 +1160,30 @@ int32_t uWifiMqttSetMessageCallback(const uMqttClientContext_t *pContext,
     return err;
 }
 
+int32_t uWifiMqttSetMessageReceiveCallback(const uMqttClientContext_t *pContext,
+                                           void (*pCallback) (uMqttMessage_t *,
+                                                              void *),
+                                           void *pCallbackParam)
+{
+    uWifiMqttSession_t *pMqttSession;
+    uShortRangePrivateInstance_t *pInstance;
+    int32_t err = (int32_t)U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (uShortRangeLock() == (int32_t)U_ERROR_COMMON_SUCCESS) {
+        err = getMqttInstance(pContext, &pInstance, &pMqttSession);
+        if (err == (int32_t)U_ERROR_COMMON_SUCCESS) {
+            U_PORT_MUTEX_LOCK(gMqttSessionMutex);
+            pMqttSession->pReceiveCb = pCallback;
+            pMqttSession->pReceiveCbParam = pCallbackParam;
+            // Hand over anything that arrived before the callback was set
+            storedMessagesDeliver(pMqttSession);
+            U_PORT_MUTEX_UNLOCK(gMqttSessionMutex);
+        }
+        uShortRangeUnlock();
+    }
+    return err;
+}
+
 int32_t uWifiMqttSetDisconnectCallback(const uMqttClientContext_t *pContext,
                                        void (*pCallback) (int32_t, void *),
                                        void *pCallbackParam)
@@ -1046,19 +1240,14 @@ int32_t uWifiMqttPublish(const uMqttClientContext_t *pContext,
             if (pTopic == NULL) {
 
                 // Create a new pTopic and insert it to this session
-                pTopic = pAllocateMqttTopic(pMqttSession, true);
+                pTopic = pAllocateMqttTopic(pMqttSession, pTopicNameStr, true);
 
                 if (pTopic != NULL) {
 
                     pTopic->retain = retain;
                     pTopic->qos = qos;
 
-                    err = copyConnectionParams(&pTopic->pTopicStr,
-                                               pTopicNameStr);
-
-                    if (err == (int32_t)U_ERROR_COMMON_SUCCESS) {
-                        err = establishMqttConnectionToBroker(pContext, pMqttSession, pTopic, true);
-                    }
+                    err = establishMqttConnectionToBroker(pContext, pMqttSession, pTopic, true);
 
                 }
 
@@ -1108,18 +1297,13 @@ int32_t uWifiMqttSubscribe(const uMqttClientContext_t *pContext,
 
             if (pTopic == NULL) {
 
-                pTopic = pAllocateMqttTopic(pMqttSession, false);
+                pTopic = pAllocateMqttTopic(pMqttSession, pTopicFilterStr, false);
 
                 if (pTopic != NULL) {
 
                     pTopic->qos = maxQos;
 
-                    err = copyConnectionParams(&pTopic->pTopicStr,
-                                               pTopicFilterStr);
-
-                    if (err == (int32_t)U_ERROR_COMMON_SUCCESS) {
-                        err = establishMqttConnectionToBroker(pContext, pMqttSession, pTopic, false);
-                    }
+                    err = establishMqttConnectionToBroker(pContext, pMqttSession, pTopic, false);
 
                     if (err == (int32_t)U_ERROR_COMMON_SUCCESS) {
                         err = (int32_t)pTopic->qos;
@@ -1265,8 +1449,6 @@ int32_t uWifiMqttMessageRead(const uMqttClientContext_t *pContext,
     uint16_t msgLen = 0;
     uint8_t edmChannel;
     char *pFoundTopicStr;
-    size_t foundTopicLen;
-    char ignoreMsg;
     (void) pQos;
 
     if (uShortRangeLock() == (int32_t)U_ERROR_COMMON_SUCCESS) {
@@ -1288,13 +1470,11 @@ int32_t uWifiMqttMessageRead(const uMqttClientContext_t *pContext,
                 // Next 1 byte represents edm channel used for the topic
                 uRingBufferRead(&pMqttSession->rxRingBuffer, (char *)&edmChannel, 1);
                 pFoundTopicStr = getTopicStrForEdmChannel(pMqttSession, (int32_t)edmChannel);
-                foundTopicLen = strlen(pFoundTopicStr);
 
                 // check if the message can be accomodated in the given buffer size
-                //lint -save -e774
                 if ((pFoundTopicStr != NULL) &&
                     (msgLen <= *pMessageSizeBytes) &&
-                    ((foundTopicLen + 1) <= topicNameSizeBytes)) {
+                    ((strlen(pFoundTopicStr) + 1) <= topicNameSizeBytes)) {
                     strcpy(pTopicNameStr, pFoundTopicStr);
                     uRingBufferRead(&pMqttSession->rxRingBuffer, pMessage, msgLen);
                     *pMessageSizeBytes = msgLen;
@@ -1303,14 +1483,10 @@ int32_t uWifiMqttMessageRead(const uMqttClientContext_t *pContext,
                 } else {
 
                     // Drop the message if application provides buffer with lesser size
-
-                    for (uint16_t i = 0; i < msgLen; i++) {
-                        uRingBufferRead(&pMqttSession->rxRingBuffer, &ignoreMsg, 1);
-                    }
+                    uRingBufferSkip(&pMqttSession->rxRingBuffer, msgLen);
 
                     err = (int32_t)U_ERROR_COMMON_NO_MEMORY;
                 }
-                //lint -restore
                 pMqttSession->unreadMsgsCount--;
             }
             U_PORT_MUTEX_UNLOCK(gMqttSessionMutex);
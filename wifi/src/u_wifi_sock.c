@@ -114,7 +114,10 @@ typedef struct {
     uSockAddress_t remoteAddress;
     uint16_t localPort;
     char *pRxBuffer;
+    size_t rxBufferSize;
     uRingBuffer_t rxRingBuffer;
+    bool rxPaused; /**< true if received data is being held in the
+                        EDM stream because rxRingBuffer is full. */
     int32_t intOpts[WIFI_INT_OPT_MAX];
     uWifiSockCallback_t pAsyncClosedCallback; /**< Set to NULL if socket is not in use. */
     uWifiSockCallback_t pDataCallback; /**< Set to NULL if socket is not in use. */
@@ -194,12 +197,14 @@ static uWifiSockSocket_t *pAllocateSocket(int32_t wifiHandle)
                 outOfMemory = true;
                 break;
             }
-            pSock->pRxBuffer = (char *)malloc(U_WIFI_SOCK_BUFFER_SIZE);
+            pSock->rxPaused = false;
+            pSock->rxBufferSize = U_WIFI_SOCK_BUFFER_SIZE;
+            pSock->pRxBuffer = (char *)malloc(pSock->rxBufferSize);
             if (pSock->pRxBuffer == NULL) {
                 outOfMemory = true;
                 break;
             }
-            uRingBufferCreate(&pSock->rxRingBuffer, pSock->pRxBuffer, U_WIFI_SOCK_BUFFER_SIZE);
+            uRingBufferCreateLockFree(&pSock->rxRingBuffer, pSock->pRxBuffer, pSock->rxBufferSize);
             break;
         }
     }
@@ -219,6 +224,55 @@ static void freeAllSockets(void)
     }
 }
 
+// If the EDM stream is holding received data for the socket
+// because its receive buffer was full, return the EDM channel,
+// which the caller must pass to uShortRangeEdmStreamDataResume()
+// once it has called uShortRangeUnlock(), else return -1.
+static int32_t rxResumeChannelGet(uWifiSockSocket_t *pSock)
+{
+    int32_t edmChannel = -1;
+
+    if (pSock->rxPaused) {
+        pSock->rxPaused = false;
+        edmChannel = pSock->edmChannel;
+    }
+
+    return edmChannel;
+}
+
+// Set the size of the receive buffer of a socket, which must
+// be empty.
+static int32_t setRxBufferSize(uWifiSockSocket_t *pSock,
+                               const void *pOptionValue,
+                               size_t optionValueLength)
+{
+    int32_t errnoLocal = -U_SOCK_EINVAL;
+    int32_t size;
+    char *pRxBuffer;
+
+    if ((pOptionValue != NULL) && (optionValueLength >= sizeof(int32_t))) {
+        size = *((const int32_t *)pOptionValue);
+        if (size > U_DATAGRAM_HDR_SIZE) {
+            errnoLocal = -U_SOCK_EBUSY;
+            if ((uRingBufferDataSize(&pSock->rxRingBuffer) == 0) && !pSock->rxPaused) {
+                errnoLocal = -U_SOCK_ENOMEM;
+                pRxBuffer = (char *)malloc(size);
+                if (pRxBuffer != NULL) {
+                    uRingBufferDelete(&pSock->rxRingBuffer);
+                    free(pSock->pRxBuffer);
+                    pSock->pRxBuffer = pRxBuffer;
+                    pSock->rxBufferSize = size;
+                    uRingBufferCreateLockFree(&pSock->rxRingBuffer, pSock->pRxBuffer,
+                                              pSock->rxBufferSize);
+                    errnoLocal = U_SOCK_ENONE;
+                }
+            }
+        }
+    }
+
+    return errnoLocal;
+}
+
 static inline WifiIntOptId_t getIntOptionId(int32_t level, uint32_t option)
 {
     if (level == U_SOCK_OPT_LEVEL_TCP) {
@@ -455,6 +509,7 @@ static void edmIpConnectionCallback(int32_t edmHandle,
     volatile int32_t sockHandle = -1;
     volatile uWifiSockCallback_t pUserClosedCb = NULL;
     volatile uWifiSockCallback_t pUserAsyncClosedCb = NULL;
+    int32_t resumeChannel = -1;
     uWifiSockSocket_t *pSock = NULL;
     uShortRangePrivateInstance_t *pInstance = (uShortRangePrivateInstance_t *) pCallbackParameter;
     // Basic validation
@@ -492,7 +547,9 @@ static void edmIpConnectionCallback(int32_t edmHandle,
                 pUserClosedCb = pSock->pClosedCallback;
                 pUserAsyncClosedCb = pSock->pAsyncClosedCallback;
                 if (pSock->closing) {
-                    // User has called close()
+                    // User has called close(), anything held
+                    // for the socket can be thrown away
+                    resumeChannel = rxResumeChannelGet(pSock);
                     freeSocket(pSock);
                 }
             }
@@ -509,6 +566,10 @@ static void edmIpConnectionCallback(int32_t edmHandle,
 
     uShortRangeUnlock();
 
+    if (resumeChannel >= 0) {
+        uShortRangeEdmStreamDataResume(edmHandle, resumeChannel);
+    }
+
     // Call the user callbacka after the mutex has been unlocked
     if (pUserClosedCb) {
         pUserClosedCb(wifiHandle, sockHandle);
@@ -518,24 +579,29 @@ static void edmIpConnectionCallback(int32_t edmHandle,
     }
 }
 
-static void edmIpDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t length,
-                              char *pData, void *pCallbackParameter)
+// Take data from the EDM stream into the receive buffer of a socket:
+// whatever doesn't fit is left with the EDM stream, which will hold
+// it, pausing the channel, until uShortRangeEdmStreamDataResume() is
+// called when the application has read some data.
+static int32_t edmIpDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t length,
+                                 char *pData, void *pCallbackParameter)
 {
     (void)edmHandle;
     volatile int32_t wifiHandle;
     volatile int32_t sockHandle = -1;
     volatile uWifiSockCallback_t pUserDataCb = NULL;
+    int32_t taken = length;
     uShortRangePrivateInstance_t *pInstance = (uShortRangePrivateInstance_t *) pCallbackParameter;
     // Basic validation
     if (pInstance == NULL || pInstance->atHandle == NULL) {
-        return;
+        return taken;
     }
 
     U_ASSERT( uShortRangeLock() == (int32_t) U_ERROR_COMMON_SUCCESS );
 
     wifiHandle = uShoToWifiHandle(pInstance->handle);
     uWifiSockSocket_t *pSock = pFindSocketByEdmChannel(wifiHandle, edmChannel);
-    if (pSock) {
+    if (pSock && !pSock->closing) {
         sockHandle = pSock->sockHandle;
         if (pSock->protocol == U_SOCK_PROTOCOL_UDP) {
             // UDP is packet based so we need to add a header in the ring buffer
@@ -548,19 +614,30 @@ static void edmIpDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t len
                 U_ASSERT(uRingBufferAdd(&pSock->rxRingBuffer, (const char *)&magic, sizeof(magic)));
                 U_ASSERT(uRingBufferAdd(&pSock->rxRingBuffer, (const char *)&shortLength, sizeof(shortLength)));
                 U_ASSERT(uRingBufferAdd(&pSock->rxRingBuffer, pData, length));
+            } else if ((size_t)length + U_DATAGRAM_HDR_SIZE > pSock->rxBufferSize) {
+                // This datagram is never going to fit
+                uPortLog("U_WIFI_SOCK: datagram too big for RX buffer, dropping %d bytes!\n", length);
             } else {
-                // If the buffer can't fit the data we will just drop it for now
-                uPortLog("U_WIFI_SOCK: RX FIFO full, dropping %d bytes!\n", length);
+                // Wait for the application to make room
+                taken = 0;
             }
         } else {
-            // If the buffer can't fit the data we will just drop it for now
-            if (!uRingBufferAdd(&pSock->rxRingBuffer, pData, length)) {
-                uPortLog("U_WIFI_SOCK: RX FIFO full, dropping %d bytes!\n", length);
+            // Take as much of the stream as will fit
+            if ((int32_t)uRingBufferAvailableSize(&pSock->rxRingBuffer) < length) {
+                taken = (int32_t)uRingBufferAvailableSize(&pSock->rxRingBuffer);
+            }
+            if (taken > 0) {
+                U_ASSERT(uRingBufferAdd(&pSock->rxRingBuffer, pData, taken));
             }
         }
+        if (taken < length) {
+            pSock->rxPaused = true;
+        }
 
         // Schedule user data callback
-        pUserDataCb = pSock->pDataCallback;
+        if (taken > 0) {
+            pUserDataCb = pSock->pDataCallback;
+        }
     }
 
     uShortRangeUnlock();
@@ -569,6 +646,8 @@ static void edmIpDataCallback(int32_t edmHandle, int32_t edmChannel, int32_t len
     if (pUserDataCb) {
         pUserDataCb(wifiHandle, sockHandle);
     }
+
+    return taken;
 }
 
 static void UUPING_urc(uAtClientHandle_t atHandle,
@@ -976,6 +1055,8 @@ int32_t uWifiSockClose(int32_t wifiHandle,
                        uWifiSockCallback_t pCallback)
 {
     int32_t errnoLocal;
+    int32_t resumeChannel = -1;
+    int32_t streamHandle = -1;
     uWifiSockSocket_t *pSock = NULL;
     uShortRangePrivateInstance_t *pInstance = NULL;
 
@@ -988,6 +1069,11 @@ int32_t uWifiSockClose(int32_t wifiHandle,
         pSock->pAsyncClosedCallback = pCallback;
         if (!pSock->closing) {
             pSock->closing = true;
+            // Anything the EDM stream is holding for the socket can
+            // now be thrown away; this is important since it may
+            // be holding up the response to the close
+            resumeChannel = rxResumeChannelGet(pSock);
+            streamHandle = pInstance->streamHandle;
             if (pSock->connected) {
                 volatile uAtClientHandle_t atHandle = pInstance->atHandle;
                 volatile int32_t connHandle = pSock->connHandle;
@@ -995,6 +1081,11 @@ int32_t uWifiSockClose(int32_t wifiHandle,
                 // We need to release the lock during disconnection phase
                 uShortRangeUnlock();
 
+                if (resumeChannel >= 0) {
+                    uShortRangeEdmStreamDataResume(streamHandle, resumeChannel);
+                    resumeChannel = -1;
+                }
+
                 errnoLocal = closePeer(atHandle, connHandle);
 
                 // Reclaim the lock so we can continue working with the socket
@@ -1010,6 +1101,10 @@ int32_t uWifiSockClose(int32_t wifiHandle,
 
     uShortRangeUnlock();
 
+    if (resumeChannel >= 0) {
+        uShortRangeEdmStreamDataResume(streamHandle, resumeChannel);
+    }
+
     return errnoLocal;
 }
 
@@ -1060,6 +1155,8 @@ int32_t uWifiSockOptionSet(int32_t wifiHandle,
         errnoLocal = -U_SOCK_EINVAL;
         if (wifiOpt != WIFI_INT_OPT_INVALID) {
             errnoLocal = setOptionInt(pSock, wifiOpt, pOptionValue, optionValueLength);
+        } else if ((level == U_SOCK_OPT_LEVEL_SOCK) && (option == U_SOCK_OPT_RCVBUF)) {
+            errnoLocal = setRxBufferSize(pSock, pOptionValue, optionValueLength);
         }
     }
 
@@ -1090,6 +1187,15 @@ int32_t uWifiSockOptionGet(int32_t wifiHandle,
         errnoLocal = -U_SOCK_EINVAL;
         if (wifiOpt != WIFI_INT_OPT_INVALID) {
             errnoLocal = getOptionInt(pSock, wifiOpt, pOptionValue, pOptionValueLength);
+        } else if ((level == U_SOCK_OPT_LEVEL_SOCK) && (option == U_SOCK_OPT_RCVBUF)) {
+            if ((pOptionValueLength != NULL) && (pOptionValue == NULL)) {
+                *pOptionValueLength = sizeof(int32_t);
+                errnoLocal = U_SOCK_ENONE;
+            } else if ((pOptionValueLength != NULL) &&
+                       (*pOptionValueLength >= sizeof(int32_t))) {
+                *((int32_t *)pOptionValue) = (int32_t)pSock->rxBufferSize;
+                errnoLocal = U_SOCK_ENONE;
+            }
         }
     }
 
@@ -1149,6 +1255,8 @@ int32_t uWifiSockRead(int32_t wifiHandle,
                       void *pData, size_t dataSizeBytes)
 {
     int32_t errnoLocal;
+    int32_t resumeChannel = -1;
+    int32_t streamHandle = -1;
     uWifiSockSocket_t *pSock = NULL;
     uShortRangePrivateInstance_t *pInstance = NULL;
 
@@ -1168,11 +1276,19 @@ int32_t uWifiSockRead(int32_t wifiHandle,
         if (errnoLocal == 0) {
             // If there are no data available we must return U_SOCK_EWOULDBLOCK
             errnoLocal = -U_SOCK_EWOULDBLOCK;
+        } else {
+            // There is now room for anything the EDM stream is holding
+            resumeChannel = rxResumeChannelGet(pSock);
+            streamHandle = pInstance->streamHandle;
         }
     }
 
     uShortRangeUnlock();
 
+    if (resumeChannel >= 0) {
+        uShortRangeEdmStreamDataResume(streamHandle, resumeChannel);
+    }
+
     return errnoLocal;
 }
 
@@ -1277,6 +1393,8 @@ int32_t uWifiSockReceiveFrom(int32_t wifiHandle,
                              void *pData, size_t dataSizeBytes)
 {
     int32_t errnoLocal;
+    int32_t resumeChannel = -1;
+    int32_t streamHandle = -1;
     uShortRangePrivateInstance_t *pInstance = NULL;
     uWifiSockSocket_t *pSock = NULL;
 
@@ -1320,22 +1438,20 @@ int32_t uWifiSockReceiveFrom(int32_t wifiHandle,
             U_ASSERT(errnoLocal == dataSizeBytes);
             remainingDatagramBytes -= errnoLocal;
 
-            while (remainingDatagramBytes) {
-                // If the datagram couldn't be fitted in the callers buffer we need to flush
-                // the remaining datagram data
-                char dummy[32];
-                size_t readLength = remainingDatagramBytes;
-                if (readLength > sizeof(dummy)) {
-                    readLength = sizeof(dummy);
-                }
-                remainingDatagramBytes -= uRingBufferRead(&pSock->rxRingBuffer, dummy, readLength);
-            }
+            // If the datagram couldn't be fitted in the callers buffer we need to flush
+            // the remaining datagram data
+            remainingDatagramBytes -= uRingBufferSkip(&pSock->rxRingBuffer, remainingDatagramBytes);
+            U_ASSERT(remainingDatagramBytes == 0);
 
             if (pRemoteAddress) {
                 // At the moment we only receive packets from the address from first
                 // call to uWifiSockSendTo()
                 *pRemoteAddress = pSock->remoteAddress;
             }
+
+            // There is now room for anything the EDM stream is holding
+            resumeChannel = rxResumeChannelGet(pSock);
+            streamHandle = pInstance->streamHandle;
         } else {
             // If there are no data available we must return U_SOCK_EWOULDBLOCK
             errnoLocal = -U_SOCK_EWOULDBLOCK;
@@ -1344,6 +1460,10 @@ int32_t uWifiSockReceiveFrom(int32_t wifiHandle,
 
     uShortRangeUnlock();
 
+    if (resumeChannel >= 0) {
+        uShortRangeEdmStreamDataResume(streamHandle, resumeChannel);
+    }
+
     return errnoLocal;
 }
 
@@ -1394,6 +1514,27 @@ int32_t uWifiSockRegisterCallbackClosed(int32_t wifiHandle,
     return errnoLocal;
 }
 
+int32_t uWifiSockGetBytesPending(int32_t wifiHandle,
+                                 int32_t sockHandle)
+{
+    int32_t errnoLocal;
+    uWifiSockSocket_t *pSock = NULL;
+    uShortRangePrivateInstance_t *pInstance = NULL;
+
+    if (uShortRangeLock() != (int32_t) U_ERROR_COMMON_SUCCESS) {
+        return -U_SOCK_EIO;
+    }
+
+    errnoLocal = getInstanceAndSocket(wifiHandle, sockHandle, &pInstance, &pSock);
+    if (errnoLocal == U_SOCK_ENONE) {
+        errnoLocal = (int32_t)uRingBufferDataSize(&pSock->rxRingBuffer);
+    }
+
+    uShortRangeUnlock();
+
+    return errnoLocal;
+}
+
 int32_t uWifiSockGetHostByName(int32_t wifiHandle,
                                const char *pHostName,
                                uSockIpAddress_t *pHostIpAddress)
@@ -57,6 +57,7 @@
 #include "u_port_uart.h"
 
 #include "u_sock.h"
+#include "u_sock_errno.h"
 
 #include "u_at_client.h"
 
@@ -798,6 +799,144 @@ U_PORT_TEST_FUNCTION("[wifiSock]", "wifiSockUDPTest")
 }
 
 
+/** Check that, with a small receive buffer, TCP data echoed back
+ * while the application is not reading is held by the EDM stream
+ * rather than lost and is delivered, in order, as the application
+ * reads, i.e. that the channel is resumed each time.
+ */
+U_PORT_TEST_FUNCTION("[wifiSock]", "wifiSockTCPRxBufferFull")
+{
+    int32_t heapUsed;
+    char *pBuffer;
+    int32_t returnCode;
+    int32_t rxBufferSize = 32;
+    size_t bytesWritten = 0;
+    size_t bytesRead = 0;
+    int64_t startTimeMs;
+    uSockAddress_t remoteAddress;
+
+    TEST_CLEAR_ERROR();
+
+    // Obtain the initial heap size
+    heapUsed = uPortGetHeapFree();
+
+    gNetStatusMask = 0;
+    gWifiConnected = 0;
+
+    pBuffer = (char *) malloc(sizeof(gAllChars));
+    U_PORT_TEST_ASSERT(pBuffer != NULL);
+
+    // Do the standard preamble
+    returnCode = uWifiTestPrivatePreamble((uWifiModuleType_t) U_CFG_TEST_SHORT_RANGE_MODULE_TYPE,
+                                          &gHandles);
+    TEST_CHECK_TRUE(returnCode == 0);
+
+    if (!TEST_HAS_ERROR()) {
+        connectWifi();
+    }
+    if (!TEST_HAS_ERROR()) {
+        TEST_CHECK_TRUE(uWifiSockInit() == 0);
+        TEST_CHECK_TRUE(uWifiSockInitInstance(gHandles.wifiHandle) == 0);
+    }
+
+    if (!TEST_HAS_ERROR()) {
+        gSockHandleTcp = uWifiSockCreate(gHandles.wifiHandle, U_SOCK_TYPE_STREAM,
+                                         U_SOCK_PROTOCOL_TCP);
+        TEST_CHECK_TRUE(gSockHandleTcp >= 0);
+    }
+    if (!TEST_HAS_ERROR()) {
+        // Make the receive buffer a lot smaller than the echoed data
+        returnCode = uWifiSockOptionSet(gHandles.wifiHandle, gSockHandleTcp,
+                                        U_SOCK_OPT_LEVEL_SOCK, U_SOCK_OPT_RCVBUF,
+                                        &rxBufferSize, sizeof(rxBufferSize));
+        TEST_CHECK_TRUE(returnCode == 0);
+    }
+    if (!TEST_HAS_ERROR()) {
+        returnCode = uWifiSockGetHostByName(gHandles.wifiHandle,
+                                            U_SOCK_TEST_ECHO_TCP_SERVER_DOMAIN_NAME,
+                                            &remoteAddress.ipAddress);
+        remoteAddress.port = U_SOCK_TEST_ECHO_TCP_SERVER_PORT;
+        TEST_CHECK_TRUE(returnCode == 0);
+    }
+    if (!TEST_HAS_ERROR()) {
+        returnCode = uWifiSockConnect(gHandles.wifiHandle, gSockHandleTcp, &remoteAddress);
+        TEST_CHECK_TRUE(returnCode == 0);
+    }
+
+    if (!TEST_HAS_ERROR()) {
+        uPortLog(LOG_TAG "sending %d byte(s) with a %d byte receive buffer...\n",
+                 sizeof(gAllChars), rxBufferSize);
+        startTimeMs = uPortGetTickTimeMs();
+        while ((bytesWritten < sizeof(gAllChars)) && !TEST_HAS_ERROR() &&
+               (uPortGetTickTimeMs() - startTimeMs < 10000)) {
+            returnCode = uWifiSockWrite(gHandles.wifiHandle, gSockHandleTcp,
+                                        gAllChars + bytesWritten,
+                                        sizeof(gAllChars) - bytesWritten);
+            if (returnCode >= 0) {
+                bytesWritten += returnCode;
+            } else {
+                TEST_CHECK_TRUE(false);
+            }
+        }
+        TEST_CHECK_TRUE(bytesWritten == sizeof(gAllChars));
+    }
+
+    if (!TEST_HAS_ERROR()) {
+        // Don't read for a while so that the receive buffer fills
+        // up and the EDM stream has to hold on to the rest
+        uPortTaskBlock(5000);
+        uPortLog(LOG_TAG "receiving the echo in small chunks...\n");
+        memset(pBuffer, 0, sizeof(gAllChars));
+        startTimeMs = uPortGetTickTimeMs();
+        while ((bytesRead < sizeof(gAllChars)) && !TEST_HAS_ERROR() &&
+               (uPortGetTickTimeMs() - startTimeMs < 20000)) {
+            returnCode = uWifiSockRead(gHandles.wifiHandle, gSockHandleTcp,
+                                       pBuffer + bytesRead, 10);
+            if (returnCode > 0) {
+                bytesRead += returnCode;
+            } else if (returnCode == -U_SOCK_EWOULDBLOCK) {
+                uPortTaskBlock(100);
+            } else {
+                TEST_CHECK_TRUE(false);
+            }
+        }
+        uPortLog(LOG_TAG "%d byte(s) received.\n", bytesRead);
+        TEST_CHECK_TRUE(bytesRead == sizeof(gAllChars));
+        TEST_CHECK_TRUE(memcmp(pBuffer, gAllChars, sizeof(gAllChars)) == 0);
+    }
+
+    returnCode = uWifiSockClose(gHandles.wifiHandle, gSockHandleTcp, NULL);
+    if (!TEST_HAS_ERROR()) {
+        TEST_CHECK_TRUE(returnCode == 0);
+    }
+
+    if (uWifiSockDeinitInstance(gHandles.wifiHandle) != 0) {
+        TEST_CHECK_TRUE(false);
+    }
+    uWifiSockDeinit();
+
+    // Cleanup
+    disconnectWifi();
+    uWifiTestPrivatePostamble(&gHandles);
+
+    free(pBuffer);
+
+    if (TEST_HAS_ERROR()) {
+        uPortLog(__FILE__ ":%d:FAIL\n", TEST_GET_ERROR_LINE());
+        U_PORT_TEST_ASSERT(false);
+    }
+
+#ifndef __XTENSA__
+    // Check for memory leaks, see wifiSockTCPTest
+    heapUsed -= uPortGetHeapFree();
+    uPortLog(LOG_TAG "we have leaked %d byte(s).\n", heapUsed);
+    U_PORT_TEST_ASSERT(heapUsed <= 0);
+#else
+    (void) heapUsed;
+#endif
+}
+
+
 #endif // U_SHORT_RANGE_TEST_WIFI()
 
 